@@ -44,6 +44,7 @@ ROCM_MODE="auto"      # auto|yes|no
 REQUIRE_ROCM=0
 ONEAPI_MODE="auto"    # auto|yes|no
 REQUIRE_ONEAPI=0
+HOST_MODE="auto"      # auto|yes|no
 MODEL_MODE="auto"     # auto|yes|no
 INSTALL_LAUNCHER=1
 INSTALL_DESKTOP=1
@@ -130,6 +131,14 @@ while [[ $# -gt 0 ]]; do
       ONEAPI_MODE="no"
       shift
       ;;
+    --host)
+      HOST_MODE="yes"
+      shift
+      ;;
+    --no-host)
+      HOST_MODE="no"
+      shift
+      ;;
     --no-launcher)
       INSTALL_LAUNCHER=0
       shift
@@ -155,12 +164,12 @@ while [[ $# -gt 0 ]]; do
       shift
       ;;
     -h|--help)
-      echo "Usage: ./install.sh [--cuda|--require-cuda|--no-cuda] [--rocm|--require-rocm|--no-rocm] [--oneapi|--require-oneapi|--no-oneapi] [--models|--no-models] [--no-launcher|--force-launcher] [--no-desktop] [--no-launch]"
+      echo "Usage: ./install.sh [--cuda|--require-cuda|--no-cuda] [--rocm|--require-rocm|--no-rocm] [--oneapi|--require-oneapi|--no-oneapi] [--host|--no-host] [--models|--no-models] [--no-launcher|--force-launcher] [--no-desktop] [--no-launch]"
       exit 0
       ;;
     *)
       err "Unknown argument: $1"
-      echo "Usage: ./install.sh [--cuda|--require-cuda|--no-cuda] [--rocm|--require-rocm|--no-rocm] [--oneapi|--require-oneapi|--no-oneapi] [--models|--no-models] [--no-launcher|--force-launcher] [--no-desktop] [--no-launch]" >&2
+      echo "Usage: ./install.sh [--cuda|--require-cuda|--no-cuda] [--rocm|--require-rocm|--no-rocm] [--oneapi|--require-oneapi|--no-oneapi] [--host|--no-host] [--models|--no-models] [--no-launcher|--force-launcher] [--no-desktop] [--no-launch]" >&2
       exit 2
       ;;
   esac
@@ -777,6 +786,10 @@ ONEAPI_LIB_SO="$ONEAPI_BUILD_DIR/liblc0_oneapi.so"
 ONEAPI_T5_LIB_SO="$ONEAPI_BUILD_DIR/libt5_oneapi.so"
 ONEAPI_PERFT_LIB_SO="$ONEAPI_BUILD_DIR/libperft_oneapi.so"
 
+HOST_RESULT="skipped" # built|skipped|failed
+HOST_BUILD_DIR="$APP_HOME/native/host/build"
+HOST_PERFT_LIB_SO="$HOST_BUILD_DIR/libperft_host.so"
+
 manual_build_cuda_backend() {
   if ! command -v nvcc >/dev/null 2>&1; then
     echo "nvcc not found."
@@ -1193,6 +1206,82 @@ try_build_oneapi_backend() {
   return 0
 }
 
+manual_build_host_backend() {
+  if ! command -v g++ >/dev/null 2>&1; then
+    echo "g++ not found."
+    return 1
+  fi
+
+  maybe_export_java_home
+  if [[ -z "${JAVA_HOME:-}" || ! -d "${JAVA_HOME}/include" ]]; then
+    echo "JAVA_HOME is not set to a valid JDK (needed for JNI headers)."
+    return 1
+  fi
+  if [[ ! -d "${JAVA_HOME}/include/linux" ]]; then
+    echo "Missing JNI platform headers at: ${JAVA_HOME}/include/linux"
+    return 1
+  fi
+
+  mkdir -p "$HOST_BUILD_DIR"
+  echo
+  step "Building host CPU perft backend (native/host) via g++ (CMake fallback)..."
+  g++ -shared -fPIC -O3 --std=c++17 -pthread \
+      -I"${JAVA_HOME}/include" -I"${JAVA_HOME}/include/linux" \
+      -o "$HOST_PERFT_LIB_SO" "$APP_HOME/native/host/perft_host_jni.cpp"
+}
+
+try_build_host_backend() {
+  if [[ "$HOST_MODE" == "no" || ! -d "$APP_HOME/native/host" ]]; then
+    HOST_RESULT="skipped"
+    return 0
+  fi
+  if [[ "$HOST_MODE" == "auto" ]] && \
+     ! confirm "Build optional host CPU perft backend (native/host JNI)? (multi-threaded, no GPU needed)" "Y"; then
+    HOST_RESULT="skipped"
+    return 0
+  fi
+
+  if ! command -v g++ >/dev/null 2>&1 || ! command -v make >/dev/null 2>&1; then
+    echo "Compiler toolchain not found; installing build-essential..."
+    if ! apt_install build-essential; then
+      echo "Failed to install build-essential."
+      HOST_RESULT="failed"
+      return 0
+    fi
+  fi
+
+  if ! command -v cmake >/dev/null 2>&1; then
+    echo "CMake not found; trying a manual host build as a fallback..."
+    if manual_build_host_backend; then
+      step "Host perft backend built: $HOST_PERFT_LIB_SO"
+      HOST_RESULT="built"
+      return 0
+    fi
+    HOST_RESULT="failed"
+    return 0
+  fi
+
+  echo
+  step "Building host CPU perft backend (native/host)..."
+  maybe_export_java_home
+
+  prepare_cmake_build_dir "$APP_HOME/native/host" "$HOST_BUILD_DIR"
+  if cmake -S "$APP_HOME/native/host" -B "$HOST_BUILD_DIR" -DCMAKE_BUILD_TYPE=Release && \
+     cmake --build "$HOST_BUILD_DIR" -j "$JOBS"; then
+    step "Host perft backend built: $HOST_PERFT_LIB_SO"
+    HOST_RESULT="built"
+    return 0
+  fi
+
+  echo
+  warn "Host perft backend build failed. Continuing with the Java perft."
+  echo "To retry later:"
+  echo "  cmake -S native/host -B native/host/build -DCMAKE_BUILD_TYPE=Release"
+  echo "  cmake --build native/host/build -j"
+  HOST_RESULT="failed"
+  return 0
+}
+
 detect_reusable_launcher
 
 title "ChessRTK installer"
@@ -1280,6 +1369,8 @@ if [[ $REQUIRE_ONEAPI -eq 1 && "$ONEAPI_RESULT" != "built" ]]; then
   exit 1
 fi
 
+try_build_host_backend
+
 section "Launcher"
 if [[ $INSTALL_LAUNCHER -eq 1 ]]; then
   if [[ $REUSE_EXISTING_LAUNCHER -eq 1 ]]; then
@@ -1322,6 +1413,9 @@ fi
 if [[ -f "\$APP_HOME/native/oneapi/build/liblc0_oneapi.so" || -f "\$APP_HOME/native/oneapi/build/libt5_oneapi.so" ]]; then
   LIB_DIRS+=("\$APP_HOME/native/oneapi/build")
 fi
+if [[ -f "\$APP_HOME/native/host/build/libperft_host.so" ]]; then
+  LIB_DIRS+=("\$APP_HOME/native/host/build")
+fi
 LIB_OPT=""
 if [[ \${#LIB_DIRS[@]} -gt 0 && "\$JAVA_OPTS" != *"-Djava.library.path="* ]]; then
   LIB_PATH="\$(IFS=:; echo "\${LIB_DIRS[*]}")"
@@ -1412,6 +1506,11 @@ if [[ "$ONEAPI_RESULT" == "built" ]]; then
 elif [[ "$ONEAPI_RESULT" == "failed" ]]; then
   warn "oneAPI backend: not built (CPU fallback)"
 fi
+if [[ "$HOST_RESULT" == "built" ]]; then
+  step "Host perft backend: built ($HOST_PERFT_LIB_SO)"
+elif [[ "$HOST_RESULT" == "failed" ]]; then
+  warn "Host perft backend: not built (Java perft fallback)"
+fi
 if [[ "$MODEL_RESULT" == "downloaded" ]]; then
   step "Model weights: downloaded into $MODEL_DIR"
 elif [[ "$MODEL_RESULT" == "present" ]]; then
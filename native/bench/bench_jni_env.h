@@ -0,0 +1,217 @@
+/*
+ * native/bench/bench_jni_env.h
+ *
+ * A JVM-free JNIEnv for the native benchmark (native_bench.cpp). The bench calls the exported
+ * Java_* entry points of the backend libraries exactly as the Java bindings do, so it measures
+ * the same argument checks, array copies and chunking a search thread pays for. This header
+ * supplies the handful of JNI functions those entry points use (array length/region/elements,
+ * UTF strings, new arrays, object arrays, direct buffers) on plain heap objects.
+ *
+ * Every object the backend creates (NewLongArray, NewStringUTF, ...) is a local reference that
+ * lives until drop_locals(), the bench's equivalent of returning to Java; objects the bench
+ * creates itself live as long as the BenchJni. JNI functions the backends never call stay null.
+ * One BenchJni serves one thread.
+ */
+
+#ifndef CRTK_BENCH_JNI_ENV_H
+#define CRTK_BENCH_JNI_ENV_H
+
+#include <jni.h>
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace crtk_bench {
+
+class BenchJni {
+public:
+    BenchJni() {
+        table_ = JNINativeInterface_{};
+        table_.GetArrayLength = &get_array_length;
+        table_.GetStringUTFChars = &get_string_utf_chars;
+        table_.ReleaseStringUTFChars = &release_string_utf_chars;
+        table_.NewStringUTF = &new_string_utf;
+        table_.GetFloatArrayRegion = &get_region<jfloatArray, jfloat>;
+        table_.SetFloatArrayRegion = &set_region<jfloatArray, jfloat>;
+        table_.GetIntArrayRegion = &get_region<jintArray, jint>;
+        table_.SetIntArrayRegion = &set_region<jintArray, jint>;
+        table_.GetLongArrayRegion = &get_region<jlongArray, jlong>;
+        table_.SetLongArrayRegion = &set_region<jlongArray, jlong>;
+        table_.GetFloatArrayElements = &get_elements<jfloatArray, jfloat>;
+        table_.ReleaseFloatArrayElements = &release_elements<jfloatArray, jfloat>;
+        table_.GetLongArrayElements = &get_elements<jlongArray, jlong>;
+        table_.ReleaseLongArrayElements = &release_elements<jlongArray, jlong>;
+        table_.NewFloatArray = &new_array<jfloatArray, jfloat>;
+        table_.NewIntArray = &new_array<jintArray, jint>;
+        table_.NewLongArray = &new_array<jlongArray, jlong>;
+        table_.NewObjectArray = &new_object_array;
+        table_.SetObjectArrayElement = &set_object_array_element;
+        table_.DeleteLocalRef = &delete_local_ref;
+        table_.FindClass = &find_class;
+        table_.NewDirectByteBuffer = &new_direct_byte_buffer;
+        table_.ExceptionCheck = &exception_check;
+        env_.functions = &table_;
+        env_.owner = this;
+    }
+
+    BenchJni(const BenchJni&) = delete;
+    BenchJni& operator=(const BenchJni&) = delete;
+
+    JNIEnv* env() { return &env_; }
+
+    jstring string(const std::string& text) {
+        Object* o = make(false);
+        o->text = text;
+        return reinterpret_cast<jstring>(o);
+    }
+
+    jfloatArray floats(const std::vector<jfloat>& v) { return make_array<jfloatArray>(v.data(), v.size()); }
+    jfloatArray floats(size_t length) { return make_array<jfloatArray, jfloat>(nullptr, length); }
+    jintArray ints(const std::vector<jint>& v) { return make_array<jintArray>(v.data(), v.size()); }
+    jlongArray longs(const std::vector<jlong>& v) { return make_array<jlongArray>(v.data(), v.size()); }
+
+    // Copy of a primitive array's contents; empty for a null reference.
+    template <typename T>
+    static std::vector<T> values(jobject ref) {
+        const Object* o = cast(ref);
+        if (!o) return {};
+        std::vector<T> out(static_cast<size_t>(o->length));
+        if (!out.empty()) std::memcpy(out.data(), o->bytes.data(), out.size() * sizeof(T));
+        return out;
+    }
+
+    // Frees every object the backend created since the last call.
+    void drop_locals() { locals_.clear(); }
+
+private:
+    struct Object {
+        std::vector<unsigned char> bytes;
+        jsize length = 0;
+        std::string text;
+        std::vector<jobject> elements;
+    };
+
+    struct Env : JNIEnv_ {
+        BenchJni* owner;
+    };
+
+    static BenchJni& self(JNIEnv* env) { return *static_cast<Env*>(env)->owner; }
+    static Object* cast(jobject ref) { return reinterpret_cast<Object*>(ref); }
+
+    Object* make(bool local) {
+        auto& list = local ? locals_ : globals_;
+        list.push_back(std::make_unique<Object>());
+        return list.back().get();
+    }
+
+    template <typename Ref, typename T>
+    Ref make_array(const T* data, size_t length) {
+        Object* o = make(false);
+        fill(*o, data, length);
+        return reinterpret_cast<Ref>(o);
+    }
+
+    template <typename T>
+    static void fill(Object& o, const T* data, size_t length) {
+        o.length = static_cast<jsize>(length);
+        o.bytes.assign(length * sizeof(T), 0);
+        if (data && length) std::memcpy(o.bytes.data(), data, length * sizeof(T));
+    }
+
+    static jsize JNICALL get_array_length(JNIEnv*, jarray ref) {
+        const Object* o = cast(ref);
+        return o ? o->length : 0;
+    }
+
+    static const char* JNICALL get_string_utf_chars(JNIEnv*, jstring ref, jboolean* isCopy) {
+        if (isCopy) *isCopy = JNI_FALSE;
+        const Object* o = cast(ref);
+        return o ? o->text.c_str() : nullptr;
+    }
+
+    static void JNICALL release_string_utf_chars(JNIEnv*, jstring, const char*) {}
+
+    static jstring JNICALL new_string_utf(JNIEnv* env, const char* text) {
+        Object* o = self(env).make(true);
+        o->text = text ? text : "";
+        return reinterpret_cast<jstring>(o);
+    }
+
+    // Region copies clamp to the array instead of raising ArrayIndexOutOfBoundsException.
+    template <typename Ref, typename T>
+    static void JNICALL get_region(JNIEnv*, Ref ref, jsize start, jsize len, T* buf) {
+        const Object* o = cast(ref);
+        if (!o || start < 0 || len <= 0 || start > o->length - len) return;
+        std::memcpy(buf, o->bytes.data() + static_cast<size_t>(start) * sizeof(T), static_cast<size_t>(len) * sizeof(T));
+    }
+
+    template <typename Ref, typename T>
+    static void JNICALL set_region(JNIEnv*, Ref ref, jsize start, jsize len, const T* buf) {
+        Object* o = cast(ref);
+        if (!o || start < 0 || len <= 0 || start > o->length - len) return;
+        std::memcpy(o->bytes.data() + static_cast<size_t>(start) * sizeof(T), buf, static_cast<size_t>(len) * sizeof(T));
+    }
+
+    // Elements alias the array storage, so release has nothing to copy back.
+    template <typename Ref, typename T>
+    static T* JNICALL get_elements(JNIEnv*, Ref ref, jboolean* isCopy) {
+        if (isCopy) *isCopy = JNI_FALSE;
+        Object* o = cast(ref);
+        return o ? reinterpret_cast<T*>(o->bytes.data()) : nullptr;
+    }
+
+    template <typename Ref, typename T>
+    static void JNICALL release_elements(JNIEnv*, Ref, T*, jint) {}
+
+    template <typename Ref, typename T>
+    static Ref JNICALL new_array(JNIEnv* env, jsize length) {
+        if (length < 0) return nullptr;
+        Object* o = self(env).make(true);
+        fill<T>(*o, nullptr, static_cast<size_t>(length));
+        return reinterpret_cast<Ref>(o);
+    }
+
+    static jobjectArray JNICALL new_object_array(JNIEnv* env, jsize length, jclass, jobject init) {
+        if (length < 0) return nullptr;
+        Object* o = self(env).make(true);
+        o->length = length;
+        o->elements.assign(static_cast<size_t>(length), init);
+        return reinterpret_cast<jobjectArray>(o);
+    }
+
+    static void JNICALL set_object_array_element(JNIEnv*, jobjectArray ref, jsize index, jobject value) {
+        Object* o = cast(ref);
+        if (o && index >= 0 && index < o->length) o->elements[static_cast<size_t>(index)] = value;
+    }
+
+    static void JNICALL delete_local_ref(JNIEnv*, jobject) {}
+
+    static jclass JNICALL find_class(JNIEnv* env, const char* name) {
+        Object* o = self(env).make(true);
+        o->text = name ? name : "";
+        return reinterpret_cast<jclass>(o);
+    }
+
+    // The buffer's address and capacity are kept in `bytes` (nothing in the bench reads them back).
+    static jobject JNICALL new_direct_byte_buffer(JNIEnv* env, void* address, jlong capacity) {
+        Object* o = self(env).make(true);
+        o->bytes.resize(sizeof(void*) + sizeof(jlong));
+        std::memcpy(o->bytes.data(), &address, sizeof(void*));
+        std::memcpy(o->bytes.data() + sizeof(void*), &capacity, sizeof(jlong));
+        return reinterpret_cast<jobject>(o);
+    }
+
+    static jboolean JNICALL exception_check(JNIEnv*) { return JNI_FALSE; }
+
+    JNINativeInterface_ table_;
+    Env env_;
+    std::vector<std::unique_ptr<Object>> globals_;
+    std::vector<std::unique_ptr<Object>> locals_;
+};
+
+} // namespace crtk_bench
+
+#endif // CRTK_BENCH_JNI_ENV_H
@@ -0,0 +1,902 @@
+/*
+ * native/bench/native_bench.cpp
+ *
+ * crtk native bench: throughput and latency of one vendor's native backends, measured through
+ * the same exported Java_* entry points the Java bindings call (see bench_jni_env.h), so numbers
+ * include the JNI-side copies and chunking but no JVM. One executable per vendor CMake project
+ * (crtk_bench_cuda, crtk_bench_rocm, crtk_bench_oneapi, crtk_bench_host, built with
+ * -DCRTK_NATIVE_BENCH=ON) loads that vendor's libraries from its own directory and runs:
+ *
+ *  - perft: startpos expanded and folded to --split plies on the host (perft_frontier.h), then
+ *    nativeSessionBulkPerft over the unique frontier for every --depths remaining depth and every
+ *    --chunks session capacity (the largest chunk one launch takes). Each total is checked
+ *    against the published startpos counts;
+ *  - lc0 / bt4 / otis: nativePredictBatch (nativePredict per position where a vendor has no
+ *    batched entry point) for every --batches size on synthetic planes;
+ *  - t5: nativeGenerateIdsBatch for every --dtypes entry, set through the vendor's
+ *    CRTK_T5_<VENDOR>_DTYPE before the handle is created (backends without that variable run
+ *    their only precision), on synthetic ids or on the --t5-prompts file. Each dtype records
+ *    the device memory its handle took and, when fp32 is in the sweep, how closely its ids
+ *    match the fp32 ids.
+ *
+ * Network families run only when their weights are given (--lc0, --bt4, --otis, --t5); a family
+ * whose library or entry point is missing is listed under "skipped". Every case runs --warmup
+ * untimed calls, then --iters timed calls; the report keeps p50/p99/mean/min wall time per call
+ * and a rate derived from p50. The JSON report (default reports/native-bench-<vendor>-<UTC
+ * stamp>.json, relative to the working directory) also records the device, the build flags the
+ * CMake project passed in and every CRTK_* variable in the environment, so two reports say
+ * whether they are comparable. Exit status: 0 when every case passed, 2 when a call failed or a
+ * perft total was wrong, 1 on bad arguments or an unwritable report.
+ */
+
+#include "bench_jni_env.h"
+
+#include "../common/perft_core.h"
+#include "../common/perft_frontier.h"
+
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(CRTK_BENCH_CUDA_RUNTIME)
+#include <cuda_runtime_api.h>
+#elif defined(CRTK_BENCH_HIP_RUNTIME)
+#include <hip/hip_runtime_api.h>
+#elif defined(CRTK_BENCH_SYCL_RUNTIME)
+#include <sycl/sycl.hpp>
+#endif
+
+#ifndef CRTK_BENCH_VENDOR
+#error "CRTK_BENCH_VENDOR must name the backend vendor (cuda, rocm, oneapi or host)"
+#endif
+
+#ifndef CRTK_BENCH_BUILD_FLAGS
+#define CRTK_BENCH_BUILD_FLAGS ""
+#endif
+
+extern char** environ;
+
+namespace {
+
+using crtk_bench::BenchJni;
+
+const std::string VENDOR = CRTK_BENCH_VENDOR;
+
+// perft(startpos, depth) for depth 0..8 (Chess Programming Wiki).
+constexpr int64_t START_PERFT[] = {1, 20, 400, 8902, 197281, 4865609, 119060324, 3195901860LL, 84998978956LL};
+constexpr int START_PERFT_MAX = 8;
+
+using DeviceCountFn = jint (JNICALL*)(JNIEnv*, jclass);
+using CreateFn = jlong (JNICALL*)(JNIEnv*, jclass, jstring);
+using CreateOnDeviceFn = jlong (JNICALL*)(JNIEnv*, jclass, jstring, jint);
+using DestroyFn = void (JNICALL*)(JNIEnv*, jclass, jlong);
+using InfoFn = jlongArray (JNICALL*)(JNIEnv*, jclass, jlong);
+using PredictFn = jfloat (JNICALL*)(JNIEnv*, jclass, jlong, jfloatArray, jfloatArray, jfloatArray);
+using PredictBatchFn = jint (JNICALL*)(JNIEnv*, jclass, jlong, jfloatArray, jint, jfloatArray, jfloatArray,
+        jfloatArray);
+using GenerateBatchFn = jintArray (JNICALL*)(JNIEnv*, jclass, jlong, jintArray, jintArray, jint);
+using CreateSessionFn = jlong (JNICALL*)(JNIEnv*, jclass, jint);
+using SessionBulkFn = jlongArray (JNICALL*)(JNIEnv*, jclass, jlong, jlongArray, jint, jint);
+
+struct Options {
+    std::string libDir;
+    std::map<std::string, std::string> libs; // library base name -> path override
+    std::string out;
+    std::vector<std::string> families{"perft", "lc0", "bt4", "otis", "t5"};
+    std::map<std::string, std::string> weights; // family -> weights path
+    int device = 0;
+    int warmup = 3;
+    int iters = 20;
+    std::vector<int> batches{1, 8, 32, 128};
+    int split = 4;
+    std::vector<int> depths{1, 2, 3};
+    std::vector<int> chunks{1024, 16384, 131072};
+    std::vector<std::string> dtypes{"fp32", "fp16", "bf16", "int8"};
+    int t5Batch = 8;
+    int t5Input = 32;
+    int t5Tokens = 32;
+    std::string t5Prompts; // one prompt per line as token ids; synthetic ids when empty
+};
+
+// ---- report ----------------------------------------------------------------------------------
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    return out + "\"";
+}
+
+std::string json_number(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", v);
+    return buf;
+}
+
+// One flat JSON object; values are stored already encoded, in insertion order.
+class Record {
+public:
+    Record& str(const std::string& key, const std::string& v) { return put(key, json_string(v)); }
+    Record& num(const std::string& key, int64_t v) { return put(key, std::to_string(v)); }
+    Record& real(const std::string& key, double v) { return put(key, json_number(v)); }
+    Record& flag(const std::string& key, bool v) { return put(key, v ? "true" : "false"); }
+
+    std::string json() const {
+        std::string out = "{";
+        for (size_t i = 0; i < fields_.size(); ++i) {
+            if (i) out += ", ";
+            out += json_string(fields_[i].first) + ": " + fields_[i].second;
+        }
+        return out + "}";
+    }
+
+private:
+    Record& put(const std::string& key, std::string v) {
+        fields_.emplace_back(key, std::move(v));
+        return *this;
+    }
+
+    std::vector<std::pair<std::string, std::string>> fields_;
+};
+
+struct Report {
+    std::vector<Record> results;
+    std::vector<Record> skipped;
+    int deviceCount = -1;
+    bool failed = false;
+
+    void skip(const std::string& family, const std::string& reason) {
+        std::fprintf(stderr, "%-6s skipped: %s\n", family.c_str(), reason.c_str());
+        skipped.push_back(Record().str("family", family).str("reason", reason));
+    }
+
+    void fail(const std::string& family, const std::string& reason) {
+        std::fprintf(stderr, "%-6s FAILED: %s\n", family.c_str(), reason.c_str());
+        results.push_back(Record().str("family", family).flag("ok", false).str("error", reason));
+        failed = true;
+    }
+};
+
+// ---- timing ----------------------------------------------------------------------------------
+
+struct Stats {
+    bool ok = true;
+    std::vector<int64_t> nanos; // sorted
+    int64_t sum = 0;
+
+    // Nearest-rank percentile.
+    int64_t percentile(double p) const {
+        if (nanos.empty()) return 0;
+        size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(nanos.size()) + 0.999999);
+        rank = std::min(std::max<size_t>(rank, 1), nanos.size());
+        return nanos[rank - 1];
+    }
+
+    double mean() const { return nanos.empty() ? 0.0 : static_cast<double>(sum) / static_cast<double>(nanos.size()); }
+
+    // Events per second at the median call time.
+    double rate(double events) const {
+        const int64_t p50 = percentile(50);
+        return p50 > 0 ? events * 1e9 / static_cast<double>(p50) : 0.0;
+    }
+
+    void add_to(Record& r) const {
+        r.real("p50_ms", static_cast<double>(percentile(50)) / 1e6)
+                .real("p99_ms", static_cast<double>(percentile(99)) / 1e6)
+                .real("mean_ms", mean() / 1e6)
+                .real("min_ms", nanos.empty() ? 0.0 : static_cast<double>(nanos.front()) / 1e6);
+    }
+};
+
+// Runs call() `warmup` times untimed and `iters` times timed; call() -> bool (false = failure,
+// which stops the case).
+template <typename Call>
+Stats measure(const Options& o, Call&& call) {
+    Stats s;
+    for (int i = 0; i < o.warmup; ++i) {
+        if (!call()) {
+            s.ok = false;
+            return s;
+        }
+    }
+    for (int i = 0; i < o.iters; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool ok = call();
+        const auto t1 = std::chrono::steady_clock::now();
+        if (!ok) {
+            s.ok = false;
+            break;
+        }
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        s.nanos.push_back(ns);
+        s.sum += ns;
+    }
+    std::sort(s.nanos.begin(), s.nanos.end());
+    return s;
+}
+
+void print_case(const std::string& family, const std::string& label, const Stats& s, double rate, const char* unit) {
+    std::printf("%-6s %-30s p50 %10.3f ms  p99 %10.3f ms  %14.1f %s\n", family.c_str(), label.c_str(),
+            static_cast<double>(s.percentile(50)) / 1e6, static_cast<double>(s.percentile(99)) / 1e6, rate, unit);
+    std::fflush(stdout);
+}
+
+// ---- libraries -------------------------------------------------------------------------------
+
+// A vendor backend library opened with dlopen; entry points resolve as <prefix><name>. The
+// handle is never closed: device runtimes do not expect to be unloaded before process exit.
+class Library {
+public:
+    Library(const std::string& path, std::string prefix) : prefix_(std::move(prefix)) {
+        handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle_) {
+            const char* err = dlerror();
+            error_ = err ? err : ("cannot open " + path);
+        }
+    }
+
+    bool loaded() const { return handle_ != nullptr; }
+    const std::string& error() const { return error_; }
+
+    template <typename Fn>
+    Fn fn(const std::string& name) const {
+        return handle_ ? reinterpret_cast<Fn>(dlsym(handle_, (prefix_ + name).c_str())) : nullptr;
+    }
+
+private:
+    void* handle_ = nullptr;
+    std::string prefix_;
+    std::string error_;
+};
+
+// Directory holding this executable; the vendor libraries are built next to it.
+std::string exe_dir() {
+    char buf[4096];
+    const ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (n <= 0) return ".";
+    std::string path(buf, static_cast<size_t>(n));
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+// lib<base>_<vendor>.so, e.g. liblc0_cuda.so (holds both lc0_cnn and lc0_bt4).
+Library open_library(const Options& o, const std::string& base, const std::string& jniFamily) {
+    auto it = o.libs.find(base);
+    const std::string path = it != o.libs.end() ? it->second : o.libDir + "/lib" + base + "_" + VENDOR + ".so";
+    return Library(path, "Java_chess_nn_" + jniFamily + "_" + VENDOR + "_");
+}
+
+void note_devices(const Library& lib, BenchJni& jni, Report& report) {
+    if (auto count = lib.fn<DeviceCountFn>("Support_nativeDeviceCount")) {
+        report.deviceCount = std::max(report.deviceCount, static_cast<int>(count(jni.env(), nullptr)));
+    }
+}
+
+// nativeCreateOnDevice where the vendor has it; nativeCreate serves device 0 otherwise.
+jlong open_handle(const Library& lib, BenchJni& jni, const std::string& path, int device) {
+    jstring jpath = jni.string(path);
+    if (auto onDevice = lib.fn<CreateOnDeviceFn>("Backend_nativeCreateOnDevice")) {
+        return onDevice(jni.env(), nullptr, jpath, device);
+    }
+    auto create = lib.fn<CreateFn>("Backend_nativeCreate");
+    return create && device == 0 ? create(jni.env(), nullptr, jpath) : 0;
+}
+
+// ---- perft -----------------------------------------------------------------------------------
+
+crtk_perft::Position start_position() {
+    using namespace crtk_perft;
+    Position p;
+    std::memset(&p, 0, sizeof(p));
+    static const int back[8] = {WR, WN, WB, WQ, WK, WB, WN, WR};
+    for (int sq = 0; sq < 64; ++sq) p.board[sq] = -1;
+    for (int file = 0; file < 8; ++file) {
+        const int pieces[4][2] = {{file, back[file] + BR - WR}, {8 + file, BP}, {48 + file, WP}, {56 + file, back[file]}};
+        for (const auto& [sq, piece] : pieces) {
+            p.pieces[piece] |= 1ULL << sq;
+            p.board[sq] = static_cast<signed char>(piece);
+        }
+    }
+    for (int i = 0; i < 6; ++i) p.whiteOcc |= p.pieces[i];
+    for (int i = 6; i < 12; ++i) p.blackOcc |= p.pieces[i];
+    p.occ = p.whiteOcc | p.blackOcc;
+    p.wk = 60;
+    p.bk = 4;
+    p.whiteToMove = true;
+    p.castling = CASTLE_WK | CASTLE_WQ | CASTLE_BK | CASTLE_BQ;
+    p.ep = NO_SQUARE;
+    p.wkRook = 63;
+    p.wqRook = 56;
+    p.bkRook = 7;
+    p.bqRook = 0;
+    p.key = compute_key(host_tables(), p);
+    return p;
+}
+
+void bench_perft(const Options& o, Report& report) {
+    using namespace crtk_perft;
+    Library lib = open_library(o, "perft", "perft");
+    if (!lib.loaded()) return report.skip("perft", lib.error());
+    auto create = lib.fn<CreateSessionFn>("Backend_nativeCreateSession");
+    auto bulk = lib.fn<SessionBulkFn>("Backend_nativeSessionBulkPerft");
+    auto destroy = lib.fn<DestroyFn>("Backend_nativeDestroySession");
+    if (!create || !bulk || !destroy) return report.skip("perft", "no session entry points");
+
+    BenchJni jni;
+    note_devices(lib, jni, report);
+    Position root = start_position();
+    FoldedFrontier frontier;
+    expand_folded(host_tables(), root, o.split, frontier);
+    const int count = frontier.count();
+    jlongArray packed = jni.longs(std::vector<jlong>(frontier.packed.begin(), frontier.packed.end()));
+
+    for (int chunk : o.chunks) {
+        const jlong session = create(jni.env(), nullptr, chunk);
+        if (!session) {
+            report.fail("perft", "nativeCreateSession(" + std::to_string(chunk) + ") failed");
+            continue;
+        }
+        for (int depth : o.depths) {
+            int64_t nodes = 0;
+            int64_t total = 0;
+            Stats s = measure(o, [&] {
+                std::vector<jlong> counts = BenchJni::values<jlong>(bulk(jni.env(), nullptr, session, packed, count, depth));
+                jni.drop_locals();
+                if (counts.size() != static_cast<size_t>(count)) return false;
+                nodes = total = 0;
+                for (int i = 0; i < count; ++i) {
+                    nodes += counts[static_cast<size_t>(i)];
+                    total += counts[static_cast<size_t>(i)] * frontier.weight[static_cast<size_t>(i)];
+                }
+                return true;
+            });
+            const std::string label = "startpos split " + std::to_string(o.split) + " +" + std::to_string(depth)
+                    + " chunk " + std::to_string(chunk);
+            if (!s.ok) {
+                report.fail("perft", label + ": nativeSessionBulkPerft failed");
+                continue;
+            }
+            const int totalDepth = o.split + depth;
+            const bool known = totalDepth <= START_PERFT_MAX;
+            const bool ok = !known || total == START_PERFT[totalDepth];
+            Record r;
+            r.str("family", "perft").str("position", "startpos").num("split", o.split)
+                    .num("frontier", frontier.reached).num("unique", count).num("depth", depth)
+                    .num("chunk", chunk).num("nodes", nodes).num("perft", total);
+            if (known) r.num("expected", START_PERFT[totalDepth]);
+            r.flag("ok", ok);
+            s.add_to(r);
+            r.real("nodes_per_s", s.rate(static_cast<double>(nodes)));
+            report.results.push_back(r);
+            if (!ok) {
+                report.failed = true;
+                std::fprintf(stderr, "perft  %s: perft(%d) = %lld, expected %lld\n", label.c_str(), totalDepth,
+                        static_cast<long long>(total), static_cast<long long>(START_PERFT[totalDepth]));
+            }
+            print_case("perft", label, s, s.rate(static_cast<double>(nodes)), "nodes/s");
+        }
+        destroy(jni.env(), nullptr, session);
+    }
+}
+
+// ---- lc0 / bt4 / otis ------------------------------------------------------------------------
+
+struct NetFamily {
+    const char* name;    // report family and weights option
+    const char* library; // lib<library>_<vendor>.so
+    const char* jni;     // Java_chess_nn_<jni>_<vendor>_...
+    int inputIndex;      // nativeGetInfo entry holding input planes
+    int tokensIndex;     // entry holding tokens per plane, -1 for 64 squares
+    int policyIndex;     // entry holding the policy size
+};
+
+// nativeGetInfo leads with the same entries on every vendor (see each family's JNI surface).
+const NetFamily NET_FAMILIES[] = {
+        {"lc0", "lc0", "lc0_cnn", 0, -1, 5},
+        {"bt4", "lc0", "lc0_bt4", 0, 1, 5},
+        {"otis", "otis", "otis", 0, -1, 3},
+};
+
+// Deterministic sparse 0/1 planes; timing does not depend on the values.
+std::vector<jfloat> synthetic_planes(size_t n, uint32_t seed) {
+    std::vector<jfloat> v(n);
+    uint32_t x = seed * 2654435761u + 1;
+    for (size_t i = 0; i < n; ++i) {
+        x = x * 1664525u + 1013904223u;
+        v[i] = (x >> 28) == 0 ? 1.0f : 0.0f;
+    }
+    return v;
+}
+
+void bench_net(const NetFamily& fam, const std::string& weights, const Options& o, Report& report) {
+    Library lib = open_library(o, fam.library, fam.jni);
+    if (!lib.loaded()) return report.skip(fam.name, lib.error());
+    auto info = lib.fn<InfoFn>("Backend_nativeGetInfo");
+    auto destroy = lib.fn<DestroyFn>("Backend_nativeDestroy");
+    auto predict = lib.fn<PredictFn>("Backend_nativePredict");
+    auto predictBatch = lib.fn<PredictBatchFn>("Backend_nativePredictBatch");
+    if (!info || !destroy || !predict) return report.skip(fam.name, "no predict entry points");
+
+    BenchJni jni;
+    note_devices(lib, jni, report);
+    const jlong handle = open_handle(lib, jni, weights, o.device);
+    if (!handle) return report.fail(fam.name, "nativeCreate failed for " + weights);
+    const std::vector<jlong> shape = BenchJni::values<jlong>(info(jni.env(), nullptr, handle));
+    jni.drop_locals();
+    if (static_cast<int>(shape.size()) <= std::max({fam.inputIndex, fam.tokensIndex, fam.policyIndex})) {
+        destroy(jni.env(), nullptr, handle);
+        return report.fail(fam.name, "nativeGetInfo returned no shape");
+    }
+    const size_t inputSize = static_cast<size_t>(shape[fam.inputIndex])
+            * static_cast<size_t>(fam.tokensIndex < 0 ? 64 : shape[fam.tokensIndex]);
+    const size_t policySize = static_cast<size_t>(shape[fam.policyIndex]);
+
+    for (int batch : o.batches) {
+        if (batch <= 0) continue;
+        const size_t n = static_cast<size_t>(batch);
+        // Batched calls take all positions at once; per-position calls reuse one set of outputs.
+        const size_t outputs = predictBatch ? n : 1;
+        jfloatArray policy = jni.floats(outputs * policySize);
+        jfloatArray wdl = jni.floats(outputs * 3);
+        jfloatArray value = jni.floats(outputs);
+        jfloatArray encoded = nullptr;
+        std::vector<jfloatArray> singles;
+        if (predictBatch) {
+            encoded = jni.floats(synthetic_planes(n * inputSize, 1));
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                singles.push_back(jni.floats(synthetic_planes(inputSize, static_cast<uint32_t>(i + 1))));
+            }
+        }
+        Stats s = measure(o, [&] {
+            if (predictBatch) return predictBatch(jni.env(), nullptr, handle, encoded, batch, policy, wdl, value) == batch;
+            for (jfloatArray position : singles) predict(jni.env(), nullptr, handle, position, policy, wdl);
+            return true;
+        });
+        // A failed single predict returns 0 like a drawn one; an all-zero WDL gives it away.
+        const std::vector<jfloat> probs = BenchJni::values<jfloat>(wdl);
+        const bool ok = s.ok && probs.size() >= 3 && probs[0] + probs[1] + probs[2] > 0.5f;
+        const std::string label = "batch " + std::to_string(batch) + (predictBatch ? "" : " (single)");
+        if (!ok) {
+            report.fail(fam.name, label + ": predict failed");
+            continue;
+        }
+        Record r;
+        r.str("family", fam.name).num("batch", batch).str("mode", predictBatch ? "batch" : "single").flag("ok", true);
+        s.add_to(r);
+        r.real("positions_per_s", s.rate(static_cast<double>(batch)));
+        report.results.push_back(r);
+        print_case(fam.name, label, s, s.rate(static_cast<double>(batch)), "pos/s");
+    }
+    destroy(jni.env(), nullptr, handle);
+}
+
+// ---- t5 --------------------------------------------------------------------------------------
+
+// Free memory on device `ordinal` in bytes, or -1 without a device runtime. The first query
+// also creates the context, so taking it before a handle is opened keeps the context out of
+// the handle's share.
+int64_t device_free_bytes(int ordinal) {
+#if defined(CRTK_BENCH_CUDA_RUNTIME)
+    size_t free = 0;
+    size_t total = 0;
+    if (cudaSetDevice(ordinal) == cudaSuccess && cudaMemGetInfo(&free, &total) == cudaSuccess) {
+        return static_cast<int64_t>(free);
+    }
+#elif defined(CRTK_BENCH_HIP_RUNTIME)
+    size_t free = 0;
+    size_t total = 0;
+    if (hipSetDevice(ordinal) == hipSuccess && hipMemGetInfo(&free, &total) == hipSuccess) {
+        return static_cast<int64_t>(free);
+    }
+#else
+    (void) ordinal;
+#endif
+    return -1;
+}
+
+bool parse_int(const std::string& s, int& out); // with the argument parsing below
+
+// One prompt per line as whitespace-separated token ids; blank lines and lines starting with
+// '#' are skipped. src/testing/T5PromptIdsTool.java writes such a file from the tagging
+// fixtures.
+bool read_prompts(const std::string& path, std::vector<std::vector<jint>>& prompts) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        std::istringstream fields(line);
+        std::vector<jint> ids;
+        std::string field;
+        while (fields >> field) {
+            int id = 0;
+            if (!parse_int(field, id)) return false;
+            ids.push_back(static_cast<jint>(id));
+        }
+        prompts.push_back(std::move(ids));
+    }
+    return !prompts.empty();
+}
+
+// nativeGenerateIdsBatch packs the per-sequence lengths first, then every sequence's ids.
+bool unpack_generated(const std::vector<jint>& packed, size_t count, std::vector<std::vector<jint>>& out) {
+    if (packed.size() < count) return false;
+    out.assign(count, {});
+    size_t pos = count;
+    for (size_t b = 0; b < count; ++b) {
+        const size_t n = static_cast<size_t>(packed[b]);
+        if (packed[b] < 0 || n > packed.size() - pos) return false;
+        out[b].assign(packed.begin() + static_cast<std::ptrdiff_t>(pos), packed.begin() + static_cast<std::ptrdiff_t>(pos + n));
+        pos += n;
+    }
+    return true;
+}
+
+// Share of sequences identical to the reference, and share of positions (over the longer of
+// each pair) holding the same id.
+std::pair<double, double> agreement(const std::vector<std::vector<jint>>& got, const std::vector<std::vector<jint>>& ref) {
+    size_t exact = 0;
+    size_t same = 0;
+    size_t positions = 0;
+    for (size_t b = 0; b < got.size() && b < ref.size(); ++b) {
+        if (got[b] == ref[b]) exact++;
+        const size_t common = std::min(got[b].size(), ref[b].size());
+        for (size_t i = 0; i < common; ++i) same += got[b][i] == ref[b][i] ? 1 : 0;
+        positions += std::max(got[b].size(), ref[b].size());
+    }
+    const double sequences = static_cast<double>(std::max<size_t>(ref.size(), 1));
+    return {static_cast<double>(exact) / sequences,
+            positions ? static_cast<double>(same) / static_cast<double>(positions) : 1.0};
+}
+
+void bench_t5(const std::string& weights, const Options& o, Report& report) {
+    Library lib = open_library(o, "t5", "t5");
+    if (!lib.loaded()) return report.skip("t5", lib.error());
+    auto generate = lib.fn<GenerateBatchFn>("Backend_nativeGenerateIdsBatch");
+    auto destroy = lib.fn<DestroyFn>("Backend_nativeDestroy");
+    if (!generate || !destroy) return report.skip("t5", "no nativeGenerateIdsBatch");
+
+    std::vector<std::vector<jint>> prompts;
+    if (!o.t5Prompts.empty()) {
+        if (!read_prompts(o.t5Prompts, prompts)) return report.fail("t5", "cannot read prompts from " + o.t5Prompts);
+    } else {
+        // Ids stay below 32 so any vocabulary takes them; the backend appends EOS.
+        for (int b = 0; b < o.t5Batch; ++b) {
+            std::vector<jint> prompt;
+            for (int i = 0; i < o.t5Input; ++i) prompt.push_back(3 + (b * 7 + i * 5) % 29);
+            prompts.push_back(std::move(prompt));
+        }
+    }
+    const int batch = static_cast<int>(prompts.size());
+    const std::string inputs = o.t5Prompts.empty() ? "synthetic" : o.t5Prompts;
+
+    BenchJni jni;
+    note_devices(lib, jni, report);
+    std::vector<jint> ids;
+    std::vector<jint> offsets{0};
+    for (const auto& prompt : prompts) {
+        ids.insert(ids.end(), prompt.begin(), prompt.end());
+        offsets.push_back(static_cast<jint>(ids.size()));
+    }
+    jintArray jids = jni.ints(ids);
+    jintArray joffsets = jni.ints(offsets);
+
+    struct Run {
+        size_t record;
+        std::vector<std::vector<jint>> ids;
+        int64_t deviceBytes;
+        double tokensPerSecond;
+    };
+    std::map<std::string, Run> runs;
+    std::string var = "CRTK_T5_" + VENDOR + "_DTYPE";
+    std::transform(var.begin(), var.end(), var.begin(), [](unsigned char c) { return std::toupper(c); });
+    const char* prior = std::getenv(var.c_str());
+    const std::string saved = prior ? prior : "";
+    for (const std::string& dtype : o.dtypes) {
+        if (dtype == "default") unsetenv(var.c_str());
+        else setenv(var.c_str(), dtype.c_str(), 1);
+        const int64_t freeBefore = device_free_bytes(o.device);
+        const jlong handle = open_handle(lib, jni, weights, o.device);
+        if (!handle) {
+            report.fail("t5", dtype + ": nativeCreate failed for " + weights);
+            continue;
+        }
+        const int64_t freeAfter = device_free_bytes(o.device);
+        const int64_t deviceBytes = freeBefore >= 0 && freeAfter >= 0 ? freeBefore - freeAfter : -1;
+        int64_t generated = 0;
+        std::vector<std::vector<jint>> outputs;
+        Stats s = measure(o, [&] {
+            std::vector<jint> out = BenchJni::values<jint>(generate(jni.env(), nullptr, handle, jids, joffsets, o.t5Tokens));
+            jni.drop_locals();
+            if (!unpack_generated(out, prompts.size(), outputs)) return false;
+            generated = 0;
+            for (int b = 0; b < batch; ++b) generated += out[static_cast<size_t>(b)];
+            return true;
+        });
+        destroy(jni.env(), nullptr, handle);
+        const std::string label = dtype + " batch " + std::to_string(batch) + " x" + std::to_string(o.t5Tokens);
+        if (!s.ok) {
+            report.fail("t5", label + ": nativeGenerateIdsBatch failed");
+            continue;
+        }
+        Record r;
+        r.str("family", "t5").str("dtype", dtype).str("inputs", inputs).num("batch", batch)
+                .num("input_tokens", static_cast<int64_t>(ids.size()))
+                .num("max_new_tokens", o.t5Tokens).num("generated_tokens", generated).flag("ok", true);
+        if (deviceBytes >= 0) r.num("device_bytes", deviceBytes);
+        s.add_to(r);
+        const double rate = s.rate(static_cast<double>(generated));
+        r.real("tokens_per_s", rate);
+        runs[dtype] = Run{report.results.size(), std::move(outputs), deviceBytes, rate};
+        report.results.push_back(r);
+        print_case("t5", label, s, rate, "tok/s");
+    }
+    if (prior) setenv(var.c_str(), saved.c_str(), 1);
+    else unsetenv(var.c_str());
+
+    auto ref = runs.find("fp32");
+    if (ref == runs.end()) return;
+    for (const auto& [dtype, run] : runs) {
+        if (dtype == "fp32") continue;
+        const auto [exact, tokens] = agreement(run.ids, ref->second.ids);
+        Record& r = report.results[run.record];
+        r.real("exact_match_vs_fp32", exact).real("token_agreement_vs_fp32", tokens);
+        if (ref->second.tokensPerSecond > 0.0) r.real("speedup_vs_fp32", run.tokensPerSecond / ref->second.tokensPerSecond);
+        if (run.deviceBytes > 0 && ref->second.deviceBytes > 0) {
+            r.real("device_bytes_vs_fp32", static_cast<double>(run.deviceBytes) / static_cast<double>(ref->second.deviceBytes));
+        }
+        std::printf("%-6s %-30s exact %6.1f%%  tokens %6.1f%%  vs fp32\n", "t5", dtype.c_str(), exact * 100.0,
+                tokens * 100.0);
+    }
+    std::fflush(stdout);
+}
+
+// ---- environment -----------------------------------------------------------------------------
+
+std::string device_name(int ordinal) {
+#if defined(CRTK_BENCH_CUDA_RUNTIME)
+    cudaDeviceProp prop;
+    if (cudaGetDeviceProperties(&prop, ordinal) == cudaSuccess) return prop.name;
+#elif defined(CRTK_BENCH_HIP_RUNTIME)
+    hipDeviceProp_t prop;
+    if (hipGetDeviceProperties(&prop, ordinal) == hipSuccess) return std::string(prop.name) + " " + prop.gcnArchName;
+#elif defined(CRTK_BENCH_SYCL_RUNTIME)
+    try {
+        auto devices = sycl::device::get_devices(sycl::info::device_type::gpu);
+        if (ordinal >= 0 && static_cast<size_t>(ordinal) < devices.size()) {
+            return devices[static_cast<size_t>(ordinal)].get_info<sycl::info::device::name>();
+        }
+    } catch (...) {
+    }
+#else
+    (void) ordinal;
+#endif
+    return "";
+}
+
+std::string host_cpu() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+    }
+    return "";
+}
+
+std::string utc_time(const char* format) {
+    const std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    gmtime_r(&now, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), format, &tm);
+    return buf;
+}
+
+bool write_report(const Options& o, const Report& report, std::string path) {
+    if (path.empty()) {
+        if (mkdir("reports", 0755) != 0 && errno != EEXIST) return false;
+        path = "reports/native-bench-" + VENDOR + "-" + utc_time("%Y%m%d-%H%M%S") + ".json";
+    }
+    std::map<std::string, std::string> env;
+    for (char** e = environ; *e; ++e) {
+        const std::string entry = *e;
+        const size_t eq = entry.find('=');
+        if (entry.rfind("CRTK_", 0) == 0 && eq != std::string::npos) env[entry.substr(0, eq)] = entry.substr(eq + 1);
+    }
+#if defined(__clang__)
+    const std::string compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    const std::string compiler = std::string("gcc ") + __VERSION__;
+#else
+    const std::string compiler;
+#endif
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"tool\": \"crtk-native-bench\",\n";
+    json << "  \"schema\": 1,\n";
+    json << "  \"vendor\": " << json_string(VENDOR) << ",\n";
+    json << "  \"timestamp\": " << json_string(utc_time("%Y-%m-%dT%H:%M:%SZ")) << ",\n";
+    json << "  \"build\": " << Record().str("flags", CRTK_BENCH_BUILD_FLAGS).str("compiler", compiler).json() << ",\n";
+    json << "  \"device\": " << Record().num("ordinal", o.device).num("count", report.deviceCount)
+            .str("name", device_name(o.device)).json() << ",\n";
+    json << "  \"host\": " << Record().str("cpu", host_cpu()).json() << ",\n";
+    json << "  \"warmup\": " << o.warmup << ",\n";
+    json << "  \"iterations\": " << o.iters << ",\n";
+    json << "  \"env\": {";
+    bool first = true;
+    for (const auto& [key, value] : env) {
+        json << (first ? "" : ", ") << json_string(key) << ": " << json_string(value);
+        first = false;
+    }
+    json << "},\n";
+    json << "  \"results\": [";
+    for (size_t i = 0; i < report.results.size(); ++i) json << (i ? ",\n    " : "\n    ") << report.results[i].json();
+    json << (report.results.empty() ? "],\n" : "\n  ],\n");
+    json << "  \"skipped\": [";
+    for (size_t i = 0; i < report.skipped.size(); ++i) json << (i ? ",\n    " : "\n    ") << report.skipped[i].json();
+    json << (report.skipped.empty() ? "]\n" : "\n  ]\n");
+    json << "}\n";
+
+    std::ofstream out(path);
+    out << json.str();
+    out.close();
+    if (!out) return false;
+    std::printf("report: %s\n", path.c_str());
+    return true;
+}
+
+// ---- arguments -------------------------------------------------------------------------------
+
+void usage() {
+    std::fprintf(stderr,
+            "usage: crtk_bench_%s [options]\n"
+            "  --lc0 PATH | --bt4 PATH | --otis PATH | --t5 PATH   weights per network family\n"
+            "  --families LIST   perft,lc0,bt4,otis,t5 (default: all)\n"
+            "  --device N        device ordinal for network handles (default 0)\n"
+            "  --warmup N        untimed calls per case (default 3)\n"
+            "  --iters N         timed calls per case (default 20)\n"
+            "  --batches LIST    lc0/bt4/otis batch sizes (default 1,8,32,128)\n"
+            "  --split N         perft plies expanded on the host (default 4)\n"
+            "  --depths LIST     perft depths below the split (default 1,2,3)\n"
+            "  --chunks LIST     perft session capacities (default 1024,16384,131072)\n"
+            "  --dtypes LIST     t5 precisions, or default (default fp32,fp16,bf16,int8)\n"
+            "  --t5-batch N --t5-input N --t5-tokens N   t5 sequences, ids each, new tokens (8, 32, 32)\n"
+            "  --t5-prompts FILE t5 prompts, one line of token ids each, instead of synthetic ids\n"
+            "  --lib-dir DIR     backend libraries (default: this executable's directory)\n"
+            "  --lib NAME=PATH   one library by base name (lc0, otis, t5, perft)\n"
+            "  --out PATH        report path (default reports/native-bench-%s-<stamp>.json)\n",
+            VENDOR.c_str(), VENDOR.c_str());
+}
+
+std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+bool parse_int(const std::string& s, int& out) {
+    char* end = nullptr;
+    const long v = std::strtol(s.c_str(), &end, 10);
+    if (s.empty() || *end != '\0' || v < 0 || v > (1L << 30)) return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+bool parse_ints(const std::string& s, std::vector<int>& out) {
+    out.clear();
+    for (const std::string& item : split_list(s)) {
+        int v = 0;
+        if (!parse_int(item, v)) return false;
+        out.push_back(v);
+    }
+    return !out.empty();
+}
+
+bool parse_args(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help" || i + 1 >= argc) return false;
+        const std::string v = argv[++i];
+        bool ok = true;
+        if (arg == "--lc0" || arg == "--bt4" || arg == "--otis" || arg == "--t5") o.weights[arg.substr(2)] = v;
+        else if (arg == "--families") o.families = split_list(v);
+        else if (arg == "--device") ok = parse_int(v, o.device);
+        else if (arg == "--warmup") ok = parse_int(v, o.warmup);
+        else if (arg == "--iters") ok = parse_int(v, o.iters) && o.iters > 0;
+        else if (arg == "--batches") ok = parse_ints(v, o.batches);
+        else if (arg == "--split") ok = parse_int(v, o.split);
+        else if (arg == "--depths") ok = parse_ints(v, o.depths);
+        else if (arg == "--chunks") ok = parse_ints(v, o.chunks);
+        else if (arg == "--dtypes") ok = !(o.dtypes = split_list(v)).empty();
+        else if (arg == "--t5-batch") ok = parse_int(v, o.t5Batch) && o.t5Batch > 0;
+        else if (arg == "--t5-input") ok = parse_int(v, o.t5Input) && o.t5Input > 0;
+        else if (arg == "--t5-tokens") ok = parse_int(v, o.t5Tokens);
+        else if (arg == "--t5-prompts") o.t5Prompts = v;
+        else if (arg == "--lib-dir") o.libDir = v;
+        else if (arg == "--lib") {
+            const size_t eq = v.find('=');
+            ok = eq != std::string::npos && eq > 0;
+            if (ok) o.libs[v.substr(0, eq)] = v.substr(eq + 1);
+        } else if (arg == "--out") o.out = v;
+        else ok = false;
+        if (!ok) {
+            std::fprintf(stderr, "bad option: %s %s\n", arg.c_str(), v.c_str());
+            return false;
+        }
+    }
+    if (o.libDir.empty()) o.libDir = exe_dir();
+    return true;
+}
+
+bool wants(const Options& o, const std::string& family) {
+    return std::find(o.families.begin(), o.families.end(), family) != o.families.end();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parse_args(argc, argv, o)) {
+        usage();
+        return 1;
+    }
+    Report report;
+    if (wants(o, "perft")) bench_perft(o, report);
+    for (const NetFamily& fam : NET_FAMILIES) {
+        if (!wants(o, fam.name)) continue;
+        auto w = o.weights.find(fam.name);
+        if (w == o.weights.end()) report.skip(fam.name, std::string("no weights (--") + fam.name + ")");
+        else bench_net(fam, w->second, o, report);
+    }
+    if (wants(o, "t5")) {
+        auto w = o.weights.find("t5");
+        if (w == o.weights.end()) report.skip("t5", "no weights (--t5)");
+        else bench_t5(w->second, o, report);
+    }
+    if (!write_report(o, report, o.out)) {
+        std::fprintf(stderr, "cannot write report %s\n", o.out.empty() ? "under reports/" : o.out.c_str());
+        return 1;
+    }
+    return report.failed ? 2 : 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * native/common/eval_queue_impl.inl
+ *
+ * Coalescing evaluation queue shared by the batched GPU backends (LC0 CNN, BT4, OTIS on CUDA and
+ * ROCm). Each backend wraps its own batched forward pass in an EvalQueue::Evaluate callback and
+ * exposes the queue through nativeQueue* JNI entry points.
+ *
+ * Search threads submit single encoded positions without blocking and receive a ticket. One native
+ * dispatcher thread per queue gathers pending positions into a batch and runs the forward pass
+ * when either maxBatch positions are waiting or the oldest one has waited deadlineMicros. Finished
+ * results are handed out in completion order through take(), which Java drains from one
+ * completion thread that completes the matching futures.
+ *
+ * Tickets are positive and increase monotonically. take() returns the ticket on success, the
+ * negated ticket when the batch containing that position failed, and 0 once the queue is closed
+ * and fully drained. close() evaluates everything already submitted before the dispatcher exits,
+ * so no ticket is left without an answer; destroy() must only run after the last take() returned 0.
+ *
+ * The dispatcher is the only thread that calls Evaluate, so the backend handle still sees one
+ * predict at a time as long as the caller does not also run direct predicts on it meanwhile.
+ */
+
+#ifndef CRTK_EVAL_QUEUE_IMPL_INL
+#define CRTK_EVAL_QUEUE_IMPL_INL
+
+#include <jni.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Deadline used when the caller passes a negative value.
+constexpr long long EVAL_QUEUE_DEFAULT_DEADLINE_MICROS = 250;
+
+class EvalQueue {
+public:
+    // Evaluates `count` positions stored back to back, writing [count][policyStride] policy and
+    // [count][3] WDL. Returns false on failure.
+    using Evaluate = std::function<bool(const float* encoded, int count, float* policy, float* wdl)>;
+
+    EvalQueue(int encStride, int policyStride, int maxBatch, long long deadlineMicros, Evaluate evaluate)
+            : encStride_(encStride), policyStride_(policyStride), maxBatch_(std::max(1, maxBatch)),
+              deadline_(std::chrono::microseconds(deadlineMicros < 0 ? EVAL_QUEUE_DEFAULT_DEADLINE_MICROS
+                                                                    : deadlineMicros)),
+              evaluate_(std::move(evaluate)) {
+        encoded_.resize(static_cast<size_t>(maxBatch_) * encStride_);
+        policy_.resize(static_cast<size_t>(maxBatch_) * policyStride_);
+        wdl_.resize(static_cast<size_t>(maxBatch_) * 3);
+        dispatcher_ = std::thread([this] { run(); });
+    }
+
+    EvalQueue(const EvalQueue&) = delete;
+    EvalQueue& operator=(const EvalQueue&) = delete;
+
+    ~EvalQueue() { close(); }
+
+    int encStride() const { return encStride_; }
+    int policyStride() const { return policyStride_; }
+
+    // Copies one encoded position into the queue. Returns its ticket, or 0 once the queue is closed.
+    long long submit(const float* encoded) {
+        Pending entry;
+        entry.encoded.assign(encoded, encoded + encStride_);
+        entry.queued = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_) return 0;
+        entry.ticket = nextTicket_++;
+        const long long ticket = entry.ticket;
+        pending_.push_back(std::move(entry));
+        if (pending_.size() == 1 || pending_.size() >= static_cast<size_t>(maxBatch_)) submitted_.notify_one();
+        return ticket;
+    }
+
+    // Blocks until a result is ready and copies it out; see the file comment for the return value.
+    long long take(float* policy, float* wdl) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        completed_.wait(lock, [this] { return !done_.empty() || (closing_ && drained_); });
+        if (done_.empty()) return 0;
+        Done entry = std::move(done_.front());
+        done_.pop_front();
+        lock.unlock();
+        if (!entry.ok) return -entry.ticket;
+        std::memcpy(policy, entry.policy.data(), sizeof(float) * policyStride_);
+        std::memcpy(wdl, entry.wdl, sizeof(entry.wdl));
+        return entry.ticket;
+    }
+
+    // Stops accepting submissions, evaluates what is still pending, and joins the dispatcher.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        submitted_.notify_all();
+        if (dispatcher_.joinable()) dispatcher_.join();
+        completed_.notify_all();
+    }
+
+private:
+    struct Pending {
+        long long ticket = 0;
+        std::vector<float> encoded;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    struct Done {
+        long long ticket = 0;
+        bool ok = false;
+        std::vector<float> policy;
+        float wdl[3] = {0.0f, 0.0f, 0.0f};
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            submitted_.wait(lock, [this] { return closing_ || !pending_.empty(); });
+            if (pending_.empty()) break;
+            // Hold the batch open until it is full or the oldest position hits its deadline.
+            const auto due = pending_.front().queued + deadline_;
+            submitted_.wait_until(lock, due, [this] {
+                return closing_ || pending_.size() >= static_cast<size_t>(maxBatch_);
+            });
+            const int count = static_cast<int>(std::min(pending_.size(), static_cast<size_t>(maxBatch_)));
+            std::vector<long long> tickets(static_cast<size_t>(count));
+            for (int i = 0; i < count; ++i) {
+                Pending& entry = pending_.front();
+                tickets[static_cast<size_t>(i)] = entry.ticket;
+                std::copy(entry.encoded.begin(), entry.encoded.end(),
+                          encoded_.begin() + static_cast<size_t>(i) * encStride_);
+                pending_.pop_front();
+            }
+            lock.unlock();
+            const bool ok = evaluate_(encoded_.data(), count, policy_.data(), wdl_.data());
+            lock.lock();
+            for (int i = 0; i < count; ++i) {
+                Done entry;
+                entry.ticket = tickets[static_cast<size_t>(i)];
+                entry.ok = ok;
+                if (ok) {
+                    const float* p = policy_.data() + static_cast<size_t>(i) * policyStride_;
+                    entry.policy.assign(p, p + policyStride_);
+                    std::copy(wdl_.begin() + i * 3, wdl_.begin() + i * 3 + 3, entry.wdl);
+                }
+                done_.push_back(std::move(entry));
+            }
+            completed_.notify_all();
+        }
+        drained_ = true;
+        completed_.notify_all();
+    }
+
+    const int encStride_;
+    const int policyStride_;
+    const int maxBatch_;
+    const std::chrono::microseconds deadline_;
+    const Evaluate evaluate_;
+
+    // Dispatcher-owned staging for one batch.
+    std::vector<float> encoded_;
+    std::vector<float> policy_;
+    std::vector<float> wdl_;
+
+    std::mutex mutex_;
+    std::condition_variable submitted_;
+    std::condition_variable completed_;
+    std::deque<Pending> pending_;
+    std::deque<Done> done_;
+    long long nextTicket_ = 1;
+    bool closing_ = false;
+    bool drained_ = false;
+    std::thread dispatcher_;
+};
+
+// JNI glue shared by every backend's nativeQueue* entry points.
+
+static jlong eval_queue_submit(JNIEnv* env, jlong queue, jfloatArray encoded) {
+    auto* q = reinterpret_cast<EvalQueue*>(queue);
+    if (!q || !encoded || env->GetArrayLength(encoded) != q->encStride()) return 0;
+    std::vector<float> host(static_cast<size_t>(q->encStride()));
+    env->GetFloatArrayRegion(encoded, 0, q->encStride(), host.data());
+    return static_cast<jlong>(q->submit(host.data()));
+}
+
+static jlong eval_queue_take(JNIEnv* env, jlong queue, jfloatArray outPolicy, jfloatArray outWdl) {
+    auto* q = reinterpret_cast<EvalQueue*>(queue);
+    if (!q || !outPolicy || !outWdl) return 0;
+    if (env->GetArrayLength(outPolicy) < q->policyStride() || env->GetArrayLength(outWdl) < 3) return 0;
+    std::vector<float> policy(static_cast<size_t>(q->policyStride()));
+    float wdl[3];
+    const long long ticket = q->take(policy.data(), wdl);
+    if (ticket > 0) {
+        env->SetFloatArrayRegion(outPolicy, 0, q->policyStride(), policy.data());
+        env->SetFloatArrayRegion(outWdl, 0, 3, wdl);
+    }
+    return static_cast<jlong>(ticket);
+}
+
+static void eval_queue_close(jlong queue) {
+    auto* q = reinterpret_cast<EvalQueue*>(queue);
+    if (q) q->close();
+}
+
+static void eval_queue_destroy(jlong queue) {
+    delete reinterpret_cast<EvalQueue*>(queue);
+}
+
+} // namespace
+
+#endif // CRTK_EVAL_QUEUE_IMPL_INL
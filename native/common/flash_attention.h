@@ -0,0 +1,188 @@
+/*
+ * native/common/flash_attention.h
+ *
+ * Fused multi-head attention for the CUDA and ROCm backends (T5 encoder and
+ * decoder passes, BT4 encoder blocks). One block owns a tile of query rows of
+ * one head of one sequence: it stages the query tile and successive key/value
+ * tiles in shared memory and folds each key tile into the output with an
+ * online softmax (running max, running denominator, rescaled accumulators),
+ * so the [queries x keys] score matrix never reaches global memory and every
+ * q.k product is computed once.
+ *
+ * Layout contract: row r of a sequence starts at r * stride floats, head h
+ * occupies floats [h * depth, (h + 1) * depth) of the row, and sequence
+ * blockIdx.z starts at z * batchStride. Keys at or past lens[z] (when lens is
+ * set), and keys after the query when causal, get zero weight. Score bias is
+ * a functor `float operator()(int head, int query, int key)`, so backends
+ * keep their own position schemes (T5 relative buckets) out of this header.
+ *
+ * Device-compiler only (nvcc / hipcc). flash_attention() returns false
+ * without launching when depth exceeds FLASH_MAX_DEPTH; callers keep their
+ * unfused kernels for that case. Launch errors are left for the caller's
+ * usual check.
+ */
+#ifndef CRTK_FLASH_ATTENTION_H
+#define CRTK_FLASH_ATTENTION_H
+
+#include <cmath>
+#include <cstddef>
+
+static constexpr int FLASH_THREADS = 128;
+static constexpr int FLASH_MAX_DEPTH = 128;
+static constexpr float FLASH_MASKED = -1e30f;
+
+struct FlashAttentionShape {
+    int qLen = 0;
+    int kLen = 0;
+    int heads = 0;
+    int depth = 0;
+    int qStride = 0;
+    int kStride = 0;
+    int vStride = 0;
+    int outStride = 0;
+    size_t qBatchStride = 0;
+    size_t kBatchStride = 0;
+    size_t vBatchStride = 0;
+    size_t outBatchStride = 0;
+    const int* lens = nullptr;
+    float scale = 1.0f;
+    bool causal = false;
+};
+
+struct FlashNoBias {
+    __device__ float operator()(int, int, int) const { return 0.0f; }
+};
+
+// FLASH_THREADS / TILE_Q threads share each query row: they split the key
+// tile for the scores and the depth for the output accumulators.
+template <int TILE_Q, int TILE_K, int MAX_DEPTH, class Bias>
+__global__ void __launch_bounds__(FLASH_THREADS) flash_attention_kernel(
+        const float* q, const float* k, const float* v, float* out, FlashAttentionShape s, Bias bias) {
+    constexpr int ROW_THREADS = FLASH_THREADS / TILE_Q;
+    constexpr int PER_THREAD = MAX_DEPTH / ROW_THREADS;
+    __shared__ float sq[TILE_Q][MAX_DEPTH];
+    __shared__ float sk[TILE_K][MAX_DEPTH + 1];
+    __shared__ float sv[TILE_K][MAX_DEPTH];
+    __shared__ float ss[TILE_Q][TILE_K + 1];
+
+    int h = blockIdx.y;
+    int z = blockIdx.z;
+    int q0 = blockIdx.x * TILE_Q;
+    int row = threadIdx.x / ROW_THREADS;
+    int lane = threadIdx.x % ROW_THREADS;
+    int qi = q0 + row;
+    int depth = s.depth;
+    int kLen = s.lens != nullptr ? s.lens[z] : s.kLen;
+    const float* qBase = q + z * s.qBatchStride + h * depth;
+    const float* kBase = k + z * s.kBatchStride + h * depth;
+    const float* vBase = v + z * s.vBatchStride + h * depth;
+    float* outBase = out + z * s.outBatchStride + h * depth;
+
+    for (int idx = threadIdx.x; idx < TILE_Q * depth; idx += FLASH_THREADS) {
+        int r = idx / depth;
+        int d = idx % depth;
+        sq[r][d] = q0 + r < s.qLen ? qBase[static_cast<size_t>(q0 + r) * s.qStride + d] : 0.0f;
+    }
+
+    float runMax = FLASH_MASKED;
+    float runSum = 0.0f;
+    float acc[PER_THREAD];
+    for (int t = 0; t < PER_THREAD; t++) {
+        acc[t] = 0.0f;
+    }
+    int kEnd = s.causal && q0 + TILE_Q < kLen ? q0 + TILE_Q : kLen;
+    for (int k0 = 0; k0 < kEnd; k0 += TILE_K) {
+        __syncthreads();
+        for (int idx = threadIdx.x; idx < TILE_K * depth; idx += FLASH_THREADS) {
+            int r = idx / depth;
+            int d = idx % depth;
+            bool valid = k0 + r < kLen;
+            sk[r][d] = valid ? kBase[static_cast<size_t>(k0 + r) * s.kStride + d] : 0.0f;
+            sv[r][d] = valid ? vBase[static_cast<size_t>(k0 + r) * s.vStride + d] : 0.0f;
+        }
+        __syncthreads();
+
+        for (int j = lane; j < TILE_K; j += ROW_THREADS) {
+            int kj = k0 + j;
+            float score = FLASH_MASKED;
+            if (qi < s.qLen && kj < kLen && !(s.causal && kj > qi)) {
+                float dot = 0.0f;
+                for (int d = 0; d < depth; d++) {
+                    dot += sq[row][d] * sk[j][d];
+                }
+                score = dot * s.scale + bias(h, qi, kj);
+            }
+            ss[row][j] = score;
+        }
+        __syncthreads();
+
+        float tileMax = FLASH_MASKED;
+        for (int j = 0; j < TILE_K; j++) {
+            tileMax = fmaxf(tileMax, ss[row][j]);
+        }
+        float newMax = fmaxf(runMax, tileMax);
+        if (newMax > FLASH_MASKED) {
+            float correction = expf(runMax - newMax);
+            runSum *= correction;
+            for (int t = 0; t < PER_THREAD; t++) {
+                acc[t] *= correction;
+            }
+            for (int j = 0; j < TILE_K; j++) {
+                float score = ss[row][j];
+                if (score == FLASH_MASKED) continue;
+                float p = expf(score - newMax);
+                runSum += p;
+                for (int t = 0; t < PER_THREAD; t++) {
+                    int d = lane + t * ROW_THREADS;
+                    if (d < depth) acc[t] += p * sv[j][d];
+                }
+            }
+            runMax = newMax;
+        }
+    }
+
+    if (qi >= s.qLen) return;
+    float inv = runSum > 0.0f ? 1.0f / runSum : 0.0f;
+    for (int t = 0; t < PER_THREAD; t++) {
+        int d = lane + t * ROW_THREADS;
+        if (d < depth) outBase[static_cast<size_t>(qi) * s.outStride + d] = acc[t] * inv;
+    }
+}
+
+template <int TILE_Q, int TILE_K, int MAX_DEPTH, class Bias, class Stream>
+static void flash_attention_launch(const float* q, const float* k, const float* v, float* out,
+                                   const FlashAttentionShape& s, int batch, Bias bias, Stream stream) {
+    dim3 grid((s.qLen + TILE_Q - 1) / TILE_Q, s.heads, batch);
+    flash_attention_kernel<TILE_Q, TILE_K, MAX_DEPTH, Bias><<<grid, FLASH_THREADS, 0, stream>>>(q, k, v, out, s, bias);
+}
+
+// General entry point: 32-query tiles up to depth 64, 16-query tiles up to
+// FLASH_MAX_DEPTH (both stay under 48 KiB of static shared memory).
+template <class Bias, class Stream>
+static bool flash_attention(const float* q, const float* k, const float* v, float* out,
+                            const FlashAttentionShape& s, int batch, Bias bias, Stream stream) {
+    if (s.depth <= 0 || s.qLen <= 0 || batch <= 0) return true;
+    if (s.depth <= 64) {
+        flash_attention_launch<32, 32, 64>(q, k, v, out, s, batch, bias, stream);
+        return true;
+    }
+    if (s.depth <= FLASH_MAX_DEPTH) {
+        flash_attention_launch<16, 16, FLASH_MAX_DEPTH>(q, k, v, out, s, batch, bias, stream);
+        return true;
+    }
+    return false;
+}
+
+// Board attention (BT4): all 64 keys fit in one tile, so each block makes a
+// single pass over K/V with no rescaling, four 16-query blocks per head.
+template <class Bias, class Stream>
+static bool flash_attention_board(const float* q, const float* k, const float* v, float* out,
+                                  const FlashAttentionShape& s, int batch, Bias bias, Stream stream) {
+    if (s.kLen == 64 && s.lens == nullptr && s.depth > 0 && s.depth <= 64) {
+        flash_attention_launch<16, 64, 64>(q, k, v, out, s, batch, bias, stream);
+        return true;
+    }
+    return flash_attention(q, k, v, out, s, batch, bias, stream);
+}
+
+#endif
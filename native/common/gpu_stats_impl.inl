@@ -0,0 +1,204 @@
+/*
+ * native/common/gpu_stats_impl.inl
+ *
+ * Per-stage counters shared by the LC0 CNN, BT4, OTIS and T5 GPU backends, read from Java through
+ * nativeGetStats. A backend names its stages once (uploads, the kernel groups of its forward pass,
+ * downloads, host-side work) and brackets each occurrence with begin()/end() on the stream that
+ * runs it; end() adds the bytes the stage moved. Host-side stages report a measured duration
+ * through host() instead. The includer maps CRTK_GPU_STATS_EVENT*, CRTK_GPU_STATS_STREAM and
+ * CRTK_GPU_STATS_SUCCESS onto the vendor runtime first; the names are its own, so backends that do
+ * not share the BT4_GPU_* shims (LC0 CNN, T5) define only these.
+ *
+ * Stats are off unless the backend's *_STATS environment variable is 1/on/true when a handle is
+ * created. Off, every call is a branch on one bool. On, each bracket records a pair of timer events
+ * drawn from a per-handle pool that grows to the longest pass seen, and collect(), called once the
+ * stream has been synchronized, folds their elapsed times into the totals. Events recorded during
+ * stream capture would not time the replays, so a handle with stats on launches directly.
+ *
+ * Configured with -DCRTK_GPU_RANGES=ON, the includers also map CRTK_GPU_STATS_RANGE_PUSH/POP onto
+ * NVTX (CUDA) or roctx (ROCm), and every bracket opens a named profiler range whether stats are on
+ * or not, so Nsight Systems and rocprof timelines show the same stage names. With graphs on, only
+ * the captured pass carries ranges.
+ *
+ * Layout of nativeGetStats(handle, reset) -> long[1 + 4 * stages]:
+ *   [enabled, then per stage: calls, bytes, deviceNanos, hostNanos]
+ * nativeGetStatNames(handle) returns the stage names, comma-separated, in the same order. reset
+ * zeroes the totals after reading them. Counters are updated by the thread driving the handle and
+ * may be read from any thread.
+ */
+
+#ifndef CRTK_GPU_STATS_IMPL_INL
+#define CRTK_GPU_STATS_IMPL_INL
+
+#include <jni.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef CRTK_GPU_STATS_RANGE_PUSH
+#define CRTK_GPU_STATS_RANGE_PUSH(name) ((void) 0)
+#define CRTK_GPU_STATS_RANGE_POP() ((void) 0)
+#endif
+
+namespace {
+
+static bool gpu_stats_from_env(const char* name) {
+    const char* env = std::getenv(name);
+    if (!env) return false;
+    std::string value(env);
+    return value == "1" || value == "on" || value == "true";
+}
+
+class GpuStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    GpuStats() = default;
+    GpuStats(const GpuStats&) = delete;
+    GpuStats& operator=(const GpuStats&) = delete;
+
+    ~GpuStats() {
+        for (CRTK_GPU_STATS_EVENT event : events_) CRTK_GPU_STATS_EVENT_DESTROY(event);
+    }
+
+    // Names the stages (the array must outlive the handle) and turns timing on or off.
+    void configure(const char* const* names, int count, bool enabled) {
+        names_ = names;
+        totals_.assign(static_cast<size_t>(count), Counters{});
+        open_.assign(static_cast<size_t>(count), NONE);
+        enabled_ = enabled;
+    }
+
+    bool enabled() const { return enabled_; }
+    int stages() const { return static_cast<int>(totals_.size()); }
+    const char* name(int stage) const { return names_[stage]; }
+
+    void begin(int stage, CRTK_GPU_STATS_STREAM stream) {
+        CRTK_GPU_STATS_RANGE_PUSH(names_[stage]);
+        if (!enabled_) return;
+        open_[static_cast<size_t>(stage)] = record(stream);
+    }
+
+    void end(int stage, CRTK_GPU_STATS_STREAM stream, long long bytes = 0) {
+        CRTK_GPU_STATS_RANGE_POP();
+        if (!enabled_) return;
+        size_t& start = open_[static_cast<size_t>(stage)];
+        pending_.push_back(Pending{stage, start, start == NONE ? NONE : record(stream), bytes});
+        start = NONE;
+    }
+
+    // Start time for host(); the epoch when stats are off, so the clock is not read.
+    Clock::time_point now() const { return enabled_ ? Clock::now() : Clock::time_point(); }
+
+    void host(int stage, Clock::time_point started, long long bytes = 0) {
+        if (!enabled_) return;
+        const long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        Counters& c = totals_[static_cast<size_t>(stage)];
+        c.calls++;
+        c.bytes += bytes;
+        c.hostNanos += nanos;
+    }
+
+    // Adds the brackets recorded since the last collect. Every stream they were recorded on must
+    // have been synchronized; a pair whose events failed still counts its call and bytes.
+    void collect() {
+        if (!enabled_ || pending_.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Pending& p : pending_) {
+            Counters& c = totals_[static_cast<size_t>(p.stage)];
+            c.calls++;
+            c.bytes += p.bytes;
+            float ms = 0.0f;
+            if (p.start != NONE && p.stop != NONE
+                    && CRTK_GPU_STATS_EVENT_ELAPSED(&ms, events_[p.start], events_[p.stop]) == CRTK_GPU_STATS_SUCCESS) {
+                c.deviceNanos += static_cast<long long>(ms * 1.0e6f);
+            }
+        }
+        pending_.clear();
+        used_ = 0;
+    }
+
+    // Calls and summed device nanos of one stage.
+    void totals(int stage, long long& calls, long long& deviceNanos) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Counters& c = totals_[static_cast<size_t>(stage)];
+        calls = c.calls;
+        deviceNanos = c.deviceNanos;
+    }
+
+    // nativeGetStats result (layout in the file comment); zeroes the totals when `reset` is set.
+    jlongArray to_array(JNIEnv* env, bool reset) {
+        std::vector<jlong> values(1 + 4 * totals_.size());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            values[0] = enabled_ ? 1 : 0;
+            for (size_t i = 0; i < totals_.size(); ++i) {
+                values[1 + 4 * i] = static_cast<jlong>(totals_[i].calls);
+                values[2 + 4 * i] = static_cast<jlong>(totals_[i].bytes);
+                values[3 + 4 * i] = static_cast<jlong>(totals_[i].deviceNanos);
+                values[4 + 4 * i] = static_cast<jlong>(totals_[i].hostNanos);
+            }
+            if (reset) totals_.assign(totals_.size(), Counters{});
+        }
+        jlongArray out = env->NewLongArray(static_cast<jsize>(values.size()));
+        if (!out) return nullptr;
+        env->SetLongArrayRegion(out, 0, static_cast<jsize>(values.size()), values.data());
+        return out;
+    }
+
+    // nativeGetStatNames result.
+    jstring names_string(JNIEnv* env) const {
+        std::string joined;
+        for (int stage = 0; stage < stages(); ++stage) {
+            if (stage > 0) joined += ',';
+            joined += names_[stage];
+        }
+        return env->NewStringUTF(joined.c_str());
+    }
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    struct Counters {
+        long long calls = 0;
+        long long bytes = 0;
+        long long deviceNanos = 0;
+        long long hostNanos = 0;
+    };
+
+    struct Pending {
+        int stage;
+        size_t start;
+        size_t stop;
+        long long bytes;
+    };
+
+    // Records the next pooled event on `stream`, creating it on first use; NONE on failure.
+    size_t record(CRTK_GPU_STATS_STREAM stream) {
+        if (used_ == events_.size()) {
+            CRTK_GPU_STATS_EVENT event = nullptr;
+            if (CRTK_GPU_STATS_EVENT_CREATE(&event) != CRTK_GPU_STATS_SUCCESS) return NONE;
+            events_.push_back(event);
+        }
+        if (CRTK_GPU_STATS_EVENT_RECORD(events_[used_], stream) != CRTK_GPU_STATS_SUCCESS) return NONE;
+        return used_++;
+    }
+
+    bool enabled_ = false;
+    const char* const* names_ = nullptr;
+    std::vector<Counters> totals_;
+    std::vector<size_t> open_;
+    std::vector<Pending> pending_;
+    std::vector<CRTK_GPU_STATS_EVENT> events_;
+    size_t used_ = 0;
+    mutable std::mutex mutex_;
+};
+
+} // namespace
+
+#endif // CRTK_GPU_STATS_IMPL_INL
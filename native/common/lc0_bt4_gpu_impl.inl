@@ -1,11 +1,15 @@
 #include <jni.h>
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <limits>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -15,6 +19,49 @@
 #define BT4_CAT(a, b) BT4_CAT2(a, b)
 #define BT4_JNI(name) BT4_CAT(BT4_JNI_PREFIX, name)
 
+#include "gpu_graph_impl.inl"
+#include "gpu_stats_impl.inl"
+#include "eval_queue_impl.inl"
+#include "pinned_io_impl.inl"
+#include "packed_planes_impl.inl"
+#include "replica_pool_impl.inl"
+#include "weight_cache_impl.inl"
+#include "weight_image_impl.inl"
+#include "flash_attention.h"
+
+/*
+ * Dense weight matrices can be kept in reduced precision on the device. The shim picks the storage
+ * types and conversions (BT4_GPU_HALF, BT4_GPU_BF16, BT4_GPU_*_TO_*) and the environment variable
+ * (BT4_DTYPE_ENV) read when a handle is created; accepted values are fp32 (default), fp16 and bf16.
+ * Kernels convert on load and accumulate in fp32. Biases, layer-norm and promotion weights stay fp32.
+ *
+ * Every forward kernel takes a batch of positions laid out back to back ([batch][tokens][dim]):
+ * token-wise dense layers run as one tiled GEMM over tokens * batch rows, per-position kernels take
+ * the position from blockIdx.y, and attention uses the flash kernel's batch dimension, so a
+ * predict of N positions costs the same number of launches as one. The arena and the input/output
+ * buffers are sized once per handle for maxBatch positions (BT4_MAX_BATCH_ENV, default 16); larger
+ * requests run in maxBatch-sized chunks, and one graph is captured per batch size seen.
+ *
+ * A handle is bound to the device ordinal it was created on (BT4_GPU_SET_DEVICE): the current
+ * device is per host thread, so every entry point that touches device memory selects it first.
+ * nativePool* loads one handle per listed device and spreads predicts over them (see
+ * replica_pool_impl.inl).
+ *
+ * The parsed, uploaded weights (Bt4Model) are shared by every handle that opens the same file on
+ * the same device with the same dtype (see weight_cache_impl.inl); a handle (Bt4Net) owns only its
+ * arena, I/O buffers, stream and graphs.
+ *
+ * When BT4_IMAGE_ENV is set, a model is first looked up as a weight image next to the source file
+ * (see weight_image_impl.inl): every tensor already converted to the storage dtype, uploaded into
+ * one device allocation in 64 MiB pinned chunks. A missing or stale image is rebuilt from the
+ * first source load. visit_model() is the single description of what an image holds.
+ *
+ * With BT4_STATS_ENV=1 a handle launches directly and times its stages with events (see
+ * gpu_stats_impl.inl and Bt4Stage): the uploads, the input embedding, attention and FFN of every
+ * encoder block, the two heads and the download. The policy stage spans the policy head's own
+ * encoder blocks, whose attention and FFN are also counted under those stages.
+ */
+
 namespace {
 
 constexpr int BT4_MAGIC = 0x4A345442;
@@ -24,6 +71,15 @@ constexpr int BT4_INPUT_CHANNELS = 112;
 constexpr int BT4_POLICY_SIZE = 1858;
 constexpr int BT4_INTERNAL_POLICY_SIZE = 67 * 64;
 constexpr int BT4_FROM_TO_POLICY_SIZE = 64 * 64;
+constexpr int BT4_DEFAULT_MAX_BATCH = 16;
+constexpr int BT4_GEMM_TILE = 16;
+constexpr int BT4_LN_THREADS = 64;
+
+enum class Bt4DType {
+    F32 = 0,
+    F16 = 1,
+    BF16 = 2
+};
 
 enum Bt4Activation {
     BT4_ACT_NONE = 0,
@@ -31,12 +87,31 @@ enum Bt4Activation {
     BT4_ACT_MISH = 2
 };
 
+// Timed stages, in nativeGetStats order.
+enum Bt4Stage : int {
+    BT4_STAGE_UPLOAD = 0,    // planes or packed words, host to device
+    BT4_STAGE_EXPAND = 1,    // packed words to planes
+    BT4_STAGE_EMBED = 2,     // planes to tokens + input embedding
+    BT4_STAGE_ATTENTION = 3, // Q/K/V, attention, output dense, per encoder block
+    BT4_STAGE_FFN = 4,       // residual + layer norms + FFN, per encoder block
+    BT4_STAGE_POLICY = 5,
+    BT4_STAGE_VALUE = 6,
+    BT4_STAGE_DOWNLOAD = 7,  // policy logits and WDL, device to host
+    BT4_STAGES = 8
+};
+
+static const char* const BT4_STAGE_NAMES[BT4_STAGES] = {
+    "upload", "expand", "embed", "attention", "ffn", "policy", "value", "download"
+};
+
 struct Bt4Dense {
     int inDim = 0;
     int outDim = 0;
     std::vector<float> weights;
     std::vector<float> bias;
     float* dWeights = nullptr;
+    BT4_GPU_HALF* dWeights16 = nullptr;
+    BT4_GPU_BF16* dWeightsBf = nullptr;
     float* dBias = nullptr;
 };
 
@@ -81,8 +156,23 @@ struct Bt4ValueHead {
     int activation = BT4_ACT_MISH;
 };
 
-struct Bt4Net {
+// Per-handle forward-pass memory. Intermediates are carved from one device arena in the same
+// order on every predict (`used` is reset first), so their addresses never change and the whole
+// launch sequence can be captured once and replayed as a graph.
+struct Bt4Workspace {
+    float* arena = nullptr;
+    size_t capacity = 0; // floats
+    size_t used = 0;
+    BT4_GPU_STREAM stream = nullptr;
+    GpuStats* stats = nullptr; // the owning handle's counters
+};
+
+// Immutable weights of one file on one device, shared by every handle that opens it (see
+// weight_cache_impl.inl). Kernels only read it, so handles on the same device can predict
+// concurrently.
+struct Bt4Model {
     std::string name;
+    int device = 0;
     bool peMap = true;
     int inputChannels = BT4_INPUT_CHANNELS;
     int tokens = BT4_TOKENS;
@@ -92,12 +182,39 @@ struct Bt4Net {
     int policySize = BT4_POLICY_SIZE;
     float eps = 1.0e-6f;
     long long parameterCount = 0;
+    Bt4DType dtype = Bt4DType::F32;
     Bt4Dense inputEmbedding;
     std::vector<Bt4EncoderBlock> encoders;
     Bt4PolicyHead policy;
     Bt4ValueHead value;
     std::vector<int> policyMap;
     int* dPolicyMap = nullptr;
+    unsigned char* dArena = nullptr; // set when loaded from a weight image; owns every tensor
+};
+
+struct Bt4Net {
+    std::shared_ptr<const Bt4Model> model;
+    int device = 0;
+
+    // Forward-pass state: fixed input/output buffers sized for maxBatch positions, the arena, and
+    // one captured graph per batch size. Like the OTIS and LC0 CNN handles, one handle serves one
+    // predict at a time.
+    int maxBatch = 1;
+    Bt4Workspace workspace;
+    float* dEncoded = nullptr;
+    unsigned long long* dPacked = nullptr; // [maxBatch][inputChannels + 1], null until first packed predict
+    float* dPolicyOut = nullptr;
+    float* dWdlOut = nullptr;
+    std::vector<BT4_GPU_GRAPH_EXEC> graphs; // [maxBatch + 1], null until captured
+    // Pinned host buffers handed to Java as direct ByteBuffers; null until first requested.
+    float* hEncoded = nullptr;
+    float* hPolicy = nullptr;
+    float* hWdl = nullptr;
+    bool useGraphs = true;
+    long long evalCount = 0;
+    long long evalNanos = 0;
+    // Per-stage counters (BT4_STATS_ENV); when enabled, forward passes launch directly.
+    GpuStats stats;
 };
 
 class Reader {
@@ -167,6 +284,11 @@ static bool gpu_ok(decltype(BT4_GPU_LAST_ERROR()) err) {
     return err == BT4_GPU_SUCCESS;
 }
 
+// Makes the handle's device current on the calling thread.
+static bool bind_device(const Bt4Net& net) {
+    return gpu_ok(BT4_GPU_SET_DEVICE(net.device));
+}
+
 static bool upload_floats(const std::vector<float>& host, float** device) {
     *device = nullptr;
     if (host.empty()) return true;
@@ -176,6 +298,37 @@ static bool upload_floats(const std::vector<float>& host, float** device) {
     return true;
 }
 
+static int max_batch_from_env() {
+    const char* env = std::getenv(BT4_MAX_BATCH_ENV);
+    if (!env || !*env) return BT4_DEFAULT_MAX_BATCH;
+    long v = std::strtol(env, nullptr, 10);
+    if (v < 1) return 1;
+    if (v > 1024) return 1024;
+    return static_cast<int>(v);
+}
+
+static Bt4DType parse_dtype() {
+    const char* env = std::getenv(BT4_DTYPE_ENV);
+    if (!env) return Bt4DType::F32;
+    std::string value(env);
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (value == "fp16" || value == "f16" || value == "half") return Bt4DType::F16;
+    if (value == "bf16" || value == "bfloat16") return BT4_GPU_SUPPORTS_BF16() ? Bt4DType::BF16 : Bt4DType::F16;
+    return Bt4DType::F32;
+}
+
+template <typename T, typename Convert>
+static bool upload_converted(const std::vector<float>& host, T** device, Convert convert) {
+    *device = nullptr;
+    if (host.empty()) return true;
+    std::vector<T> converted(host.size());
+    for (size_t i = 0; i < host.size(); ++i) converted[i] = convert(host[i]);
+    size_t bytes = converted.size() * sizeof(T);
+    if (!gpu_ok(BT4_GPU_MALLOC(device, bytes))) return false;
+    if (!gpu_ok(BT4_GPU_MEMCPY(*device, converted.data(), bytes, BT4_GPU_MEMCPY_H2D))) return false;
+    return true;
+}
+
 static bool upload_ints(const std::vector<int>& host, int** device) {
     *device = nullptr;
     if (host.empty()) return true;
@@ -187,20 +340,32 @@ static bool upload_ints(const std::vector<int>& host, int** device) {
 
 static void release_dense(Bt4Dense& dense) {
     if (dense.dWeights) BT4_GPU_FREE(dense.dWeights);
+    if (dense.dWeights16) BT4_GPU_FREE(dense.dWeights16);
+    if (dense.dWeightsBf) BT4_GPU_FREE(dense.dWeightsBf);
     if (dense.dBias) BT4_GPU_FREE(dense.dBias);
     dense.dWeights = nullptr;
+    dense.dWeights16 = nullptr;
+    dense.dWeightsBf = nullptr;
     dense.dBias = nullptr;
 }
 
 static void release_block(Bt4EncoderBlock& block);
 
-static bool upload_dense(Bt4Dense& dense) {
-    return upload_floats(dense.weights, &dense.dWeights) && upload_floats(dense.bias, &dense.dBias);
+static bool upload_dense(Bt4Dense& dense, Bt4DType dtype) {
+    bool weightsOk;
+    if (dtype == Bt4DType::F16) {
+        weightsOk = upload_converted(dense.weights, &dense.dWeights16, [](float v) { return BT4_GPU_FLOAT_TO_HALF(v); });
+    } else if (dtype == Bt4DType::BF16) {
+        weightsOk = upload_converted(dense.weights, &dense.dWeightsBf, [](float v) { return BT4_GPU_FLOAT_TO_BF16(v); });
+    } else {
+        weightsOk = upload_floats(dense.weights, &dense.dWeights);
+    }
+    return weightsOk && upload_floats(dense.bias, &dense.dBias);
 }
 
-static bool upload_attention(Bt4Attention& attention) {
-    return upload_dense(attention.query) && upload_dense(attention.key)
-            && upload_dense(attention.value) && upload_dense(attention.out);
+static bool upload_attention(Bt4Attention& attention, Bt4DType dtype) {
+    return upload_dense(attention.query, dtype) && upload_dense(attention.key, dtype)
+            && upload_dense(attention.value, dtype) && upload_dense(attention.out, dtype);
 }
 
 static void release_attention(Bt4Attention& attention) {
@@ -210,10 +375,10 @@ static void release_attention(Bt4Attention& attention) {
     release_dense(attention.out);
 }
 
-static bool upload_block(Bt4EncoderBlock& block) {
-    return upload_attention(block.attention)
-            && upload_dense(block.ffnIn)
-            && upload_dense(block.ffnOut)
+static bool upload_block(Bt4EncoderBlock& block, Bt4DType dtype) {
+    return upload_attention(block.attention, dtype)
+            && upload_dense(block.ffnIn, dtype)
+            && upload_dense(block.ffnOut, dtype)
             && upload_floats(block.ln1Gamma, &block.dLn1Gamma)
             && upload_floats(block.ln1Beta, &block.dLn1Beta)
             && upload_floats(block.ln2Gamma, &block.dLn2Gamma)
@@ -234,19 +399,52 @@ static void release_block(Bt4EncoderBlock& block) {
     block.dLn2Beta = nullptr;
 }
 
+// Frees every buffer of `model` and the model itself; the caller has made its device current.
+static void release_model_buffers(Bt4Model* model) {
+    if (model->dArena) {
+        BT4_GPU_FREE(model->dArena);
+        delete model;
+        return;
+    }
+    release_dense(model->inputEmbedding);
+    for (auto& block : model->encoders) release_block(block);
+    release_dense(model->policy.embedding);
+    for (auto& block : model->policy.encoders) release_block(block);
+    release_dense(model->policy.query);
+    release_dense(model->policy.key);
+    if (model->policy.dPromotionWeights) BT4_GPU_FREE(model->policy.dPromotionWeights);
+    release_dense(model->value.embedding);
+    release_dense(model->value.fc1);
+    release_dense(model->value.fc2);
+    if (model->dPolicyMap) BT4_GPU_FREE(model->dPolicyMap);
+    delete model;
+}
+
+// Releases `model` on the device it was uploaded to, then restores the calling thread's
+// current device so a handle destroyed from a Java thread does not rebind that thread.
+static void release_model(Bt4Model* model) {
+    if (!model) return;
+    int previous = 0;
+    const bool restore = gpu_ok(BT4_GPU_GET_DEVICE(&previous));
+    (void) gpu_ok(BT4_GPU_SET_DEVICE(model->device));
+    release_model_buffers(model);
+    if (restore) (void) gpu_ok(BT4_GPU_SET_DEVICE(previous));
+}
+
+// Frees the handle's workspace; the model goes when its last handle does.
 static void release_net(Bt4Net* net) {
     if (!net) return;
-    release_dense(net->inputEmbedding);
-    for (auto& block : net->encoders) release_block(block);
-    release_dense(net->policy.embedding);
-    for (auto& block : net->policy.encoders) release_block(block);
-    release_dense(net->policy.query);
-    release_dense(net->policy.key);
-    if (net->policy.dPromotionWeights) BT4_GPU_FREE(net->policy.dPromotionWeights);
-    release_dense(net->value.embedding);
-    release_dense(net->value.fc1);
-    release_dense(net->value.fc2);
-    if (net->dPolicyMap) BT4_GPU_FREE(net->dPolicyMap);
+    (void) bind_device(*net);
+    if (net->workspace.arena) BT4_GPU_FREE(net->workspace.arena);
+    if (net->dEncoded) BT4_GPU_FREE(net->dEncoded);
+    if (net->dPacked) BT4_GPU_FREE(net->dPacked);
+    if (net->dPolicyOut) BT4_GPU_FREE(net->dPolicyOut);
+    if (net->dWdlOut) BT4_GPU_FREE(net->dWdlOut);
+    if (net->hEncoded) BT4_GPU_HOST_FREE(net->hEncoded);
+    if (net->hPolicy) BT4_GPU_HOST_FREE(net->hPolicy);
+    if (net->hWdl) BT4_GPU_HOST_FREE(net->hWdl);
+    for (auto exec : net->graphs) if (exec) BT4_GPU_GRAPH_EXEC_DESTROY(exec);
+    if (net->workspace.stream) BT4_GPU_STREAM_DESTROY(net->workspace.stream);
     delete net;
 }
 
@@ -344,66 +542,207 @@ static long long block_params(const Bt4EncoderBlock& block) {
                     + block.ln2Gamma.size() + block.ln2Beta.size());
 }
 
-static long long compute_params(const Bt4Net& net) {
-    long long total = dense_params(net.inputEmbedding);
-    for (const auto& block : net.encoders) total += block_params(block);
-    total += dense_params(net.policy.embedding) + dense_params(net.policy.query) + dense_params(net.policy.key)
-            + static_cast<long long>(net.policy.promotionWeights.size());
-    for (const auto& block : net.policy.encoders) total += block_params(block);
-    total += dense_params(net.value.embedding) + dense_params(net.value.fc1) + dense_params(net.value.fc2);
+static long long compute_params(const Bt4Model& model) {
+    long long total = dense_params(model.inputEmbedding);
+    for (const auto& block : model.encoders) total += block_params(block);
+    total += dense_params(model.policy.embedding) + dense_params(model.policy.query) + dense_params(model.policy.key)
+            + static_cast<long long>(model.policy.promotionWeights.size());
+    for (const auto& block : model.policy.encoders) total += block_params(block);
+    total += dense_params(model.value.embedding) + dense_params(model.value.fc1) + dense_params(model.value.fc2);
     return total;
 }
 
-static bool upload_net(Bt4Net& net) {
-    if (!upload_dense(net.inputEmbedding)) return false;
-    for (auto& block : net.encoders) if (!upload_block(block)) return false;
-    if (!upload_dense(net.policy.embedding)) return false;
-    for (auto& block : net.policy.encoders) if (!upload_block(block)) return false;
-    if (!upload_dense(net.policy.query) || !upload_dense(net.policy.key)) return false;
-    if (!upload_floats(net.policy.promotionWeights, &net.policy.dPromotionWeights)) return false;
-    if (!upload_dense(net.value.embedding) || !upload_dense(net.value.fc1) || !upload_dense(net.value.fc2)) return false;
-    if (!upload_ints(net.policyMap, &net.dPolicyMap)) return false;
+static bool upload_model(Bt4Model& model) {
+    const Bt4DType dt = model.dtype;
+    if (!upload_dense(model.inputEmbedding, dt)) return false;
+    for (auto& block : model.encoders) if (!upload_block(block, dt)) return false;
+    if (!upload_dense(model.policy.embedding, dt)) return false;
+    for (auto& block : model.policy.encoders) if (!upload_block(block, dt)) return false;
+    if (!upload_dense(model.policy.query, dt) || !upload_dense(model.policy.key, dt)) return false;
+    if (!upload_floats(model.policy.promotionWeights, &model.policy.dPromotionWeights)) return false;
+    if (!upload_dense(model.value.embedding, dt) || !upload_dense(model.value.fc1, dt) || !upload_dense(model.value.fc2, dt)) return false;
+    if (!upload_ints(model.policyMap, &model.dPolicyMap)) return false;
     return true;
 }
 
-static Bt4Net* load_net(const std::string& path) {
-    auto* net = new Bt4Net();
+static bool supported_shape(const Bt4Model& model) {
+    return model.tokens == BT4_TOKENS && model.inputChannels == BT4_INPUT_CHANNELS
+            && model.policySize == BT4_POLICY_SIZE && model.value.fc2.outDim == 3
+            && model.value.fc1.inDim == model.tokens * model.value.embedding.outDim;
+}
+
+static const char* dtype_name(Bt4DType dtype) {
+    if (dtype == Bt4DType::F16) return "fp16";
+    if (dtype == Bt4DType::BF16) return "bf16";
+    return "fp32";
+}
+
+// Weight-image traversal (see weight_image_impl.inl). Host vectors supply element counts when an
+// image is written; a model read from an image keeps them empty.
+template <typename V>
+static void visit_dense(V& v, Bt4Dense& dense, Bt4DType dtype) {
+    v.value(dense.inDim);
+    v.value(dense.outDim);
+    if (dtype == Bt4DType::F16) v.tensor(dense.dWeights16, dense.weights.size());
+    else if (dtype == Bt4DType::BF16) v.tensor(dense.dWeightsBf, dense.weights.size());
+    else v.tensor(dense.dWeights, dense.weights.size());
+    v.tensor(dense.dBias, dense.bias.size());
+}
+
+template <typename V>
+static void visit_block(V& v, Bt4EncoderBlock& block, Bt4DType dtype) {
+    v.value(block.attention.heads);
+    visit_dense(v, block.attention.query, dtype);
+    visit_dense(v, block.attention.key, dtype);
+    visit_dense(v, block.attention.value, dtype);
+    visit_dense(v, block.attention.out, dtype);
+    visit_dense(v, block.ffnIn, dtype);
+    visit_dense(v, block.ffnOut, dtype);
+    v.tensor(block.dLn1Gamma, block.ln1Gamma.size());
+    v.tensor(block.dLn1Beta, block.ln1Beta.size());
+    v.tensor(block.dLn2Gamma, block.ln2Gamma.size());
+    v.tensor(block.dLn2Beta, block.ln2Beta.size());
+    v.value(block.activation);
+    v.value(block.alpha);
+}
+
+template <typename V>
+static void visit_blocks(V& v, std::vector<Bt4EncoderBlock>& blocks, Bt4DType dtype) {
+    v.size(blocks);
+    for (auto& block : blocks) visit_block(v, block, dtype);
+}
+
+template <typename V>
+static void visit_model(V& v, Bt4Model& model) {
+    const Bt4DType dt = model.dtype;
+    v.text(model.name);
+    v.value(model.peMap);
+    v.value(model.inputChannels);
+    v.value(model.tokens);
+    v.value(model.embedding);
+    v.value(model.encoderLayers);
+    v.value(model.heads);
+    v.value(model.policySize);
+    v.value(model.eps);
+    v.value(model.parameterCount);
+    visit_dense(v, model.inputEmbedding, dt);
+    visit_blocks(v, model.encoders, dt);
+    visit_dense(v, model.policy.embedding, dt);
+    visit_blocks(v, model.policy.encoders, dt);
+    visit_dense(v, model.policy.query, dt);
+    visit_dense(v, model.policy.key, dt);
+    v.tensor(model.policy.dPromotionWeights, model.policy.promotionWeights.size());
+    v.value(model.policy.activation);
+    visit_dense(v, model.value.embedding, dt);
+    visit_dense(v, model.value.fc1, dt);
+    visit_dense(v, model.value.fc2, dt);
+    v.value(model.value.activation);
+    v.tensor(model.dPolicyMap, model.policyMap.size());
+}
+
+// Loads the image written for this source file and dtype, or returns null when there is none or
+// it does not match the source.
+static Bt4Model* load_image(const std::string& path, int device, Bt4DType dtype, const MappedFile& source,
+                            uint64_t sourceHash) {
+    WeightImageReader image;
+    if (!image.open(weight_image_path(path, BT4_IMAGE_TAG, dtype_name(dtype)), BT4_IMAGE_TAG,
+            static_cast<uint32_t>(dtype), source.size(), sourceHash) || image.payload_bytes() == 0) {
+        return nullptr;
+    }
+    auto* model = new Bt4Model();
+    model->device = device;
+    model->dtype = dtype;
+    if (!gpu_ok(BT4_GPU_MALLOC(&model->dArena, image.payload_bytes()))) {
+        model->dArena = nullptr;
+        release_model(model);
+        return nullptr;
+    }
+    unsigned char* stage = nullptr;
+    if (!gpu_ok(BT4_GPU_HOST_ALLOC(&stage, std::min(image.payload_bytes(), WEIGHT_IMAGE_STAGE_BYTES)))) {
+        stage = nullptr; // copy from the pageable mapping instead
+    }
+    const bool uploaded = weight_image_upload(image, stage, [&](size_t offset, const void* src, size_t bytes) {
+        return gpu_ok(BT4_GPU_MEMCPY(model->dArena + offset, src, bytes, BT4_GPU_MEMCPY_H2D));
+    });
+    if (stage) BT4_GPU_HOST_FREE(stage);
+    bool ok = uploaded;
+    try {
+        WeightImageLoad load(image, model->dArena);
+        if (ok) visit_model(load, *model);
+        ok = ok && load.ok() && supported_shape(*model);
+    } catch (...) {
+        ok = false;
+    }
+    if (!ok) {
+        release_model(model);
+        return nullptr;
+    }
+    return model;
+}
+
+// Writes the image for a freshly uploaded model. Best effort: a failed write only costs the next
+// load its fast path.
+static void save_image(const std::string& path, Bt4Model& model, const MappedFile& source, uint64_t sourceHash) {
+    try {
+        WeightImageWriter writer;
+        auto fetch = [](void* host, const void* device, size_t bytes) {
+            return gpu_ok(BT4_GPU_MEMCPY(host, device, bytes, BT4_GPU_MEMCPY_D2H));
+        };
+        WeightImageSave<decltype(fetch)> save(writer, fetch);
+        visit_model(save, model);
+        if (save.ok()) {
+            (void) writer.write(weight_image_path(path, BT4_IMAGE_TAG, dtype_name(model.dtype)), BT4_IMAGE_TAG,
+                    static_cast<uint32_t>(model.dtype), source.size(), sourceHash);
+        }
+    } catch (...) {
+    }
+}
+
+static Bt4Model* load_model(const std::string& path, int device, Bt4DType dtype) {
+    MappedFile source;
+    uint64_t sourceHash = 0;
+    const bool imaged = weight_image_enabled(BT4_IMAGE_ENV) && source.open(path);
+    if (imaged) {
+        sourceHash = weight_image_hash(source);
+        if (Bt4Model* model = load_image(path, device, dtype, source, sourceHash)) return model;
+    }
+    auto* model = new Bt4Model();
+    model->device = device;
+    model->dtype = dtype;
     try {
         Reader in(path);
         if (in.i32() != BT4_MAGIC || in.i32() != BT4_VERSION) throw std::runtime_error("bad header");
-        net->name = in.str();
+        model->name = in.str();
         (void) in.str(); // input format
-        net->peMap = in.str() == "PE_MAP";
-        net->inputChannels = in.i32();
-        net->tokens = in.i32();
-        net->embedding = in.i32();
-        net->encoderLayers = in.i32();
-        net->heads = in.i32();
-        net->policySize = in.i32();
-        net->eps = in.f32();
-        net->inputEmbedding = read_dense(in);
-        net->encoders = read_blocks(in);
-        net->policy.embedding = read_dense(in);
-        net->policy.encoders = read_blocks(in);
-        net->policy.query = read_dense(in);
-        net->policy.key = read_dense(in);
-        net->policy.promotionWeights = in.floats();
-        net->policy.activation = parse_activation(in.str());
-        net->value.embedding = read_dense(in);
-        net->value.fc1 = read_dense(in);
-        net->value.fc2 = read_dense(in);
-        net->value.activation = parse_activation(in.str());
+        model->peMap = in.str() == "PE_MAP";
+        model->inputChannels = in.i32();
+        model->tokens = in.i32();
+        model->embedding = in.i32();
+        model->encoderLayers = in.i32();
+        model->heads = in.i32();
+        model->policySize = in.i32();
+        model->eps = in.f32();
+        model->inputEmbedding = read_dense(in);
+        model->encoders = read_blocks(in);
+        model->policy.embedding = read_dense(in);
+        model->policy.encoders = read_blocks(in);
+        model->policy.query = read_dense(in);
+        model->policy.key = read_dense(in);
+        model->policy.promotionWeights = in.floats();
+        model->policy.activation = parse_activation(in.str());
+        model->value.embedding = read_dense(in);
+        model->value.fc1 = read_dense(in);
+        model->value.fc2 = read_dense(in);
+        model->value.activation = parse_activation(in.str());
         if (!in.done()) throw std::runtime_error("trailing bytes");
-        if (net->tokens != BT4_TOKENS || net->inputChannels != BT4_INPUT_CHANNELS
-                || net->policySize != BT4_POLICY_SIZE) {
-            throw std::runtime_error("unsupported BT4 shape");
-        }
-        net->policyMap = build_policy_map();
-        net->parameterCount = compute_params(*net);
-        if (!upload_net(*net)) throw std::runtime_error("upload failed");
-        return net;
+        if (!supported_shape(*model)) throw std::runtime_error("unsupported BT4 shape");
+        model->policyMap = build_policy_map();
+        model->parameterCount = compute_params(*model);
+        if (!upload_model(*model)) throw std::runtime_error("upload failed");
+        if (imaged) save_image(path, *model, source, sourceHash);
+        return model;
     } catch (...) {
-        release_net(net);
+        release_model(model);
         return nullptr;
     }
 }
@@ -420,41 +759,52 @@ __device__ float bt4_activate(float x, int activation) {
     return x;
 }
 
-__global__ void planes_to_tokens_kernel(const float* planes, float* out, int channels, int tokens, int width, int peMap) {
+__device__ __forceinline__ float bt4_load(const float* w, int i) { return w[i]; }
+__device__ __forceinline__ float bt4_load(const BT4_GPU_HALF* w, int i) { return BT4_GPU_HALF_TO_FLOAT(w[i]); }
+__device__ __forceinline__ float bt4_load(const BT4_GPU_BF16* w, int i) { return BT4_GPU_BF16_TO_FLOAT(w[i]); }
+
+__global__ void planes_to_tokens_kernel(
+        const float* planes, float* out, int channels, int tokens, int width, int peMap, int batch) {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
-    int total = tokens * width;
-    if (i >= total) return;
-    int token = i / width;
-    int feature = i - token * width;
+    int perPosition = tokens * width;
+    if (i >= batch * perPosition) return;
+    int position = i / perPosition;
+    int local = i - position * perPosition;
+    int token = local / width;
+    int feature = local - token * width;
     if (feature < channels) {
-        out[i] = planes[feature * tokens + token];
+        out[i] = planes[(position * channels + feature) * tokens + token];
     } else {
         out[i] = (peMap && feature - channels == token) ? 1.0f : 0.0f;
     }
 }
 
+// out[rows][outDim] = input[rows][inDim] * W[outDim][inDim]^T + bias. Each 16x16 block stages a
+// tile of input rows and a tile of weight rows per 16-wide k step, so every weight is read from
+// global memory once per 16 rows instead of once per row.
+template <typename W>
 __global__ void dense_tokens_kernel(
-        const float* input, int rows, int inDim, const float* weights, const float* bias, int outDim, float* out) {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-    int total = rows * outDim;
-    if (i >= total) return;
-    int row = i / outDim;
-    int col = i - row * outDim;
-    float sum = bias[col];
-    const float* in = input + row * inDim;
-    const float* w = weights + col * inDim;
-    for (int k = 0; k < inDim; ++k) sum += w[k] * in[k];
-    out[i] = sum;
-}
-
-__global__ void dense_vector_kernel(
-        const float* input, int inDim, const float* weights, const float* bias, int outDim, float* out) {
-    int col = blockIdx.x * blockDim.x + threadIdx.x;
-    if (col >= outDim) return;
-    float sum = bias[col];
-    const float* w = weights + col * inDim;
-    for (int k = 0; k < inDim; ++k) sum += w[k] * input[k];
-    out[col] = sum;
+        const float* input, int rows, int inDim, const W* weights, const float* bias, int outDim, float* out) {
+    __shared__ float tileIn[BT4_GEMM_TILE][BT4_GEMM_TILE + 1];
+    __shared__ float tileW[BT4_GEMM_TILE][BT4_GEMM_TILE + 1];
+    int tx = threadIdx.x;
+    int ty = threadIdx.y;
+    int row = blockIdx.y * BT4_GEMM_TILE + ty;
+    int col = blockIdx.x * BT4_GEMM_TILE + tx;
+    int loadRow = blockIdx.y * BT4_GEMM_TILE + ty;
+    int loadCol = blockIdx.x * BT4_GEMM_TILE + ty;
+    float sum = (row < rows && col < outDim) ? bias[col] : 0.0f;
+    for (int k0 = 0; k0 < inDim; k0 += BT4_GEMM_TILE) {
+        int k = k0 + tx;
+        tileIn[ty][tx] = (loadRow < rows && k < inDim) ? input[static_cast<size_t>(loadRow) * inDim + k] : 0.0f;
+        tileW[ty][tx] = (loadCol < outDim && k < inDim)
+                ? bt4_load(weights, loadCol * inDim + k) : 0.0f;
+        __syncthreads();
+        int steps = inDim - k0 < BT4_GEMM_TILE ? inDim - k0 : BT4_GEMM_TILE;
+        for (int kk = 0; kk < steps; ++kk) sum += tileW[tx][kk] * tileIn[ty][kk];
+        __syncthreads();
+    }
+    if (row < rows && col < outDim) out[static_cast<size_t>(row) * outDim + col] = sum;
 }
 
 __global__ void activate_kernel(float* values, int n, int activation) {
@@ -462,13 +812,20 @@ __global__ void activate_kernel(float* values, int n, int activation) {
     if (i < n) values[i] = bt4_activate(values[i], activation);
 }
 
+// Unfused reference path, used when the head depth exceeds FLASH_MAX_DEPTH.
 __global__ void attention_kernel(
         const float* q, const float* k, const float* v, float* out,
-        int tokens, int dModel, int heads) {
+        int tokens, int dModel, int heads, int batch) {
     int depth = dModel / heads;
     int i = blockIdx.x * blockDim.x + threadIdx.x;
-    int total = tokens * heads * depth;
-    if (i >= total) return;
+    int perPosition = tokens * heads * depth;
+    if (i >= batch * perPosition) return;
+    size_t positionOffset = static_cast<size_t>(i / perPosition) * tokens * dModel;
+    q += positionOffset;
+    k += positionOffset;
+    v += positionOffset;
+    out += positionOffset;
+    i %= perPosition;
     int d = i % depth;
     int head = (i / depth) % heads;
     int queryToken = i / (depth * heads);
@@ -502,25 +859,45 @@ __global__ void add_residual_kernel(float* dest, const float* residual, int n, f
     if (i < n) dest[i] = dest[i] * scale + residual[i];
 }
 
+__device__ float bt4_block_sum(float v, float* scratch) {
+    int tid = threadIdx.x;
+    scratch[tid] = v;
+    __syncthreads();
+    for (int stride = BT4_LN_THREADS / 2; stride > 0; stride >>= 1) {
+        if (tid < stride) scratch[tid] += scratch[tid + stride];
+        __syncthreads();
+    }
+    float total = scratch[0];
+    __syncthreads();
+    return total;
+}
+
+// One block of BT4_LN_THREADS per token row; rows spans every token of every position in the batch.
 __global__ void layernorm_kernel(float* values, int rows, int dim, const float* gamma, const float* beta, float eps) {
-    int row = blockIdx.x * blockDim.x + threadIdx.x;
+    __shared__ float scratch[BT4_LN_THREADS];
+    int row = blockIdx.x;
     if (row >= rows) return;
-    float* base = values + row * dim;
-    float mean = 0.0f;
-    for (int i = 0; i < dim; ++i) mean += base[i];
-    mean /= static_cast<float>(dim);
-    float variance = 0.0f;
-    for (int i = 0; i < dim; ++i) {
+    float* base = values + static_cast<size_t>(row) * dim;
+    float partial = 0.0f;
+    for (int i = threadIdx.x; i < dim; i += BT4_LN_THREADS) partial += base[i];
+    float mean = bt4_block_sum(partial, scratch) / static_cast<float>(dim);
+    partial = 0.0f;
+    for (int i = threadIdx.x; i < dim; i += BT4_LN_THREADS) {
         float centered = base[i] - mean;
-        variance += centered * centered;
+        partial += centered * centered;
     }
-    float invStd = rsqrtf(variance / static_cast<float>(dim) + eps);
-    for (int i = 0; i < dim; ++i) base[i] = (base[i] - mean) * invStd * gamma[i] + beta[i];
+    float invStd = rsqrtf(bt4_block_sum(partial, scratch) / static_cast<float>(dim) + eps);
+    for (int i = threadIdx.x; i < dim; i += BT4_LN_THREADS) base[i] = (base[i] - mean) * invStd * gamma[i] + beta[i];
 }
 
+// Per-position policy kernels take the position from blockIdx.y.
 __global__ void policy_from_to_kernel(const float* q, const float* k, float* internal, int dModel) {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     if (i >= 64 * 64) return;
+    size_t tokenOffset = static_cast<size_t>(blockIdx.y) * 64 * dModel;
+    q += tokenOffset;
+    k += tokenOffset;
+    internal += static_cast<size_t>(blockIdx.y) * BT4_INTERNAL_POLICY_SIZE;
     int from = i / 64;
     int to = i - from * 64;
     float sum = 0.0f;
@@ -539,6 +916,8 @@ __global__ void underpromotion_kernel(float* internal, const float* key, int dMo
     if (toFile < fromFile - 1 || toFile > fromFile + 1) return;
     int from = 48 + fromFile;
     int to = 56 + toFile;
+    internal += static_cast<size_t>(blockIdx.y) * BT4_INTERNAL_POLICY_SIZE;
+    key += static_cast<size_t>(blockIdx.y) * 64 * dModel;
     float base = internal[from * 64 + to];
     float queen = 0.0f;
     float projected = 0.0f;
@@ -553,14 +932,20 @@ __global__ void underpromotion_kernel(float* internal, const float* key, int dMo
     internal[internalIndex] = base + queen + projected;
 }
 
-__global__ void gather_policy_kernel(const float* internal, const int* map, float* policy) {
+__global__ void gather_policy_kernel(const float* internal, const int* map, float* policy, int policySize) {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     if (i >= BT4_INTERNAL_POLICY_SIZE) return;
     int mapped = map[i];
-    if (mapped >= 0) policy[mapped] = internal[i];
+    if (mapped >= 0) {
+        policy[static_cast<size_t>(blockIdx.y) * policySize + mapped]
+                = internal[static_cast<size_t>(blockIdx.y) * BT4_INTERNAL_POLICY_SIZE + i];
+    }
 }
 
-__global__ void softmax3_kernel(float* logits) {
+__global__ void softmax3_kernel(float* logits, int batch) {
+    int position = blockIdx.x * blockDim.x + threadIdx.x;
+    if (position >= batch) return;
+    logits += position * 3;
     float maxValue = fmaxf(logits[0], fmaxf(logits[1], logits[2]));
     float a = expf(logits[0] - maxValue);
     float b = expf(logits[1] - maxValue);
@@ -575,223 +960,355 @@ static bool check_launch() {
     return gpu_ok(BT4_GPU_LAST_ERROR());
 }
 
-static bool alloc_float(float** ptr, int count) {
+constexpr size_t BT4_ARENA_ALIGN = 64; // floats (256 bytes)
+
+static size_t arena_span(size_t count) {
+    return (count + BT4_ARENA_ALIGN - 1) / BT4_ARENA_ALIGN * BT4_ARENA_ALIGN;
+}
+
+static bool alloc_float(Bt4Workspace& ws, float** ptr, int count) {
     *ptr = nullptr;
-    return count >= 0 && gpu_ok(BT4_GPU_MALLOC(ptr, static_cast<size_t>(count) * sizeof(float)));
+    if (count < 0) return false;
+    size_t span = arena_span(static_cast<size_t>(count));
+    if (ws.used + span > ws.capacity) return false;
+    *ptr = ws.arena + ws.used;
+    ws.used += span;
+    return true;
+}
+
+// Arena size of one forward pass over `batch` positions; mirrors the alloc_float calls made by the
+// run_* functions. `rows` is tokens * batch.
+static size_t encoder_block_floats(const Bt4EncoderBlock& block, size_t rows) {
+    const Bt4Attention& a = block.attention;
+    return arena_span(rows * a.query.outDim)
+            + arena_span(rows * a.key.outDim)
+            + arena_span(rows * a.value.outDim)
+            + arena_span(rows * a.query.outDim)
+            + arena_span(rows * a.out.outDim)
+            + arena_span(rows * block.ffnIn.outDim)
+            + arena_span(rows * block.ffnOut.outDim);
 }
 
-static bool run_activate(float* data, int n, int activation) {
+static size_t forward_floats(const Bt4Model& model, int batch) {
+    const size_t b = static_cast<size_t>(batch);
+    const size_t rows = static_cast<size_t>(model.tokens) * b;
+    size_t total = arena_span(rows * model.inputEmbedding.inDim)
+            + arena_span(rows * model.inputEmbedding.outDim);
+    for (const auto& block : model.encoders) total += encoder_block_floats(block, rows);
+    total += arena_span(rows * model.policy.embedding.outDim);
+    for (const auto& block : model.policy.encoders) total += encoder_block_floats(block, rows);
+    total += arena_span(rows * model.policy.query.outDim)
+            + arena_span(rows * model.policy.key.outDim)
+            + arena_span(b * BT4_INTERNAL_POLICY_SIZE);
+    total += arena_span(rows * model.value.embedding.outDim)
+            + arena_span(b * model.value.fc1.outDim);
+    return total;
+}
+
+static bool run_activate(Bt4Workspace& ws, float* data, int n, int activation) {
     if (activation == BT4_ACT_NONE) return true;
     int block = 256;
     int grid = (n + block - 1) / block;
-    activate_kernel<<<grid, block>>>(data, n, activation);
+    activate_kernel<<<grid, block, 0, ws.stream>>>(data, n, activation);
     return check_launch();
 }
 
-static bool run_dense_tokens(const float* input, int rows, const Bt4Dense& dense, float** out) {
-    int total = rows * dense.outDim;
-    if (!alloc_float(out, total)) return false;
-    int block = 256;
-    int grid = (total + block - 1) / block;
-    dense_tokens_kernel<<<grid, block>>>(input, rows, dense.inDim, dense.dWeights, dense.dBias, dense.outDim, *out);
+// Token-wise dense layer over `rows` rows (tokens * batch for per-token layers, batch for the
+// flattened value layers), written to `out`.
+static bool launch_dense_tokens(Bt4Workspace& ws, const float* input, int rows, const Bt4Dense& dense, float* out) {
+    dim3 block(BT4_GEMM_TILE, BT4_GEMM_TILE);
+    dim3 grid((dense.outDim + BT4_GEMM_TILE - 1) / BT4_GEMM_TILE, (rows + BT4_GEMM_TILE - 1) / BT4_GEMM_TILE);
+    if (dense.dWeights16) {
+        dense_tokens_kernel<<<grid, block, 0, ws.stream>>>(input, rows, dense.inDim, dense.dWeights16, dense.dBias, dense.outDim, out);
+    } else if (dense.dWeightsBf) {
+        dense_tokens_kernel<<<grid, block, 0, ws.stream>>>(input, rows, dense.inDim, dense.dWeightsBf, dense.dBias, dense.outDim, out);
+    } else {
+        dense_tokens_kernel<<<grid, block, 0, ws.stream>>>(input, rows, dense.inDim, dense.dWeights, dense.dBias, dense.outDim, out);
+    }
     return check_launch();
 }
 
-static bool run_dense_vector(const float* input, const Bt4Dense& dense, float** out) {
-    if (!alloc_float(out, dense.outDim)) return false;
-    int block = 256;
-    int grid = (dense.outDim + block - 1) / block;
-    dense_vector_kernel<<<grid, block>>>(input, dense.inDim, dense.dWeights, dense.dBias, dense.outDim, *out);
+static bool run_dense_tokens(Bt4Workspace& ws, const float* input, int rows, const Bt4Dense& dense, float** out) {
+    return alloc_float(ws, out, rows * dense.outDim) && launch_dense_tokens(ws, input, rows, dense, *out);
+}
+
+static bool run_layernorm(Bt4Workspace& ws, float* values, int rows, int dim, const float* gamma, const float* beta,
+        float eps) {
+    layernorm_kernel<<<rows, BT4_LN_THREADS, 0, ws.stream>>>(values, rows, dim, gamma, beta, eps);
     return check_launch();
 }
 
-static bool run_attention(const float* input, const Bt4EncoderBlock& block, int tokens, float** out) {
+static bool run_attention(Bt4Workspace& ws, const float* input, const Bt4EncoderBlock& block, int tokens, int batch,
+        float** out) {
     float* q = nullptr;
     float* k = nullptr;
     float* v = nullptr;
     float* combined = nullptr;
-    bool ok = run_dense_tokens(input, tokens, block.attention.query, &q)
-            && run_dense_tokens(input, tokens, block.attention.key, &k)
-            && run_dense_tokens(input, tokens, block.attention.value, &v)
-            && alloc_float(&combined, tokens * block.attention.query.outDim);
+    int rows = tokens * batch;
+    bool ok = run_dense_tokens(ws, input, rows, block.attention.query, &q)
+            && run_dense_tokens(ws, input, rows, block.attention.key, &k)
+            && run_dense_tokens(ws, input, rows, block.attention.value, &v)
+            && alloc_float(ws, &combined, rows * block.attention.query.outDim);
     if (ok) {
-        int total = tokens * block.attention.query.outDim;
-        int blockSize = 256;
-        int grid = (total + blockSize - 1) / blockSize;
-        attention_kernel<<<grid, blockSize>>>(q, k, v, combined, tokens, block.attention.query.outDim,
-                block.attention.heads);
-        ok = check_launch() && run_dense_tokens(combined, tokens, block.attention.out, out);
-    }
-    if (q) BT4_GPU_FREE(q);
-    if (k) BT4_GPU_FREE(k);
-    if (v) BT4_GPU_FREE(v);
-    if (combined) BT4_GPU_FREE(combined);
+        int dModel = block.attention.query.outDim;
+        FlashAttentionShape shape;
+        shape.qLen = tokens;
+        shape.kLen = tokens;
+        shape.heads = block.attention.heads;
+        shape.depth = dModel / block.attention.heads;
+        shape.qStride = shape.kStride = shape.vStride = shape.outStride = dModel;
+        shape.qBatchStride = shape.kBatchStride = shape.vBatchStride = shape.outBatchStride
+                = static_cast<size_t>(tokens) * dModel;
+        shape.scale = 1.0f / std::sqrt(static_cast<float>(shape.depth));
+        if (!flash_attention_board(q, k, v, combined, shape, batch, FlashNoBias(), ws.stream)) {
+            int total = rows * dModel;
+            int blockSize = 256;
+            int grid = (total + blockSize - 1) / blockSize;
+            attention_kernel<<<grid, blockSize, 0, ws.stream>>>(q, k, v, combined, tokens, dModel,
+                    block.attention.heads, batch);
+        }
+        ok = check_launch() && run_dense_tokens(ws, combined, rows, block.attention.out, out);
+    }
     return ok;
 }
 
-static bool run_encoder_block(float* input, const Bt4EncoderBlock& block, int tokens, float eps, float** out) {
+static bool run_encoder_block(Bt4Workspace& ws, float* input, const Bt4EncoderBlock& block, int tokens, int batch,
+        float eps, float** out) {
     int embedding = block.attention.out.outDim;
-    int elements = tokens * embedding;
+    int rows = tokens * batch;
+    int elements = rows * embedding;
     float* attended = nullptr;
     float* hidden = nullptr;
     float* ffnOut = nullptr;
-    bool ok = run_attention(input, block, tokens, &attended);
+    ws.stats->begin(BT4_STAGE_ATTENTION, ws.stream);
+    bool ok = run_attention(ws, input, block, tokens, batch, &attended);
+    ws.stats->end(BT4_STAGE_ATTENTION, ws.stream);
+    ws.stats->begin(BT4_STAGE_FFN, ws.stream);
     if (ok) {
         int grid = (elements + 255) / 256;
-        add_residual_kernel<<<grid, 256>>>(attended, input, elements, block.alpha);
+        add_residual_kernel<<<grid, 256, 0, ws.stream>>>(attended, input, elements, block.alpha);
         ok = check_launch();
     }
-    if (ok) {
-        int grid = (tokens + 127) / 128;
-        layernorm_kernel<<<grid, 128>>>(attended, tokens, embedding, block.dLn1Gamma, block.dLn1Beta, eps);
-        ok = check_launch();
-    }
-    if (ok) ok = run_dense_tokens(attended, tokens, block.ffnIn, &hidden);
-    if (ok) ok = run_activate(hidden, tokens * block.ffnIn.outDim, block.activation);
-    if (ok) ok = run_dense_tokens(hidden, tokens, block.ffnOut, &ffnOut);
+    if (ok) ok = run_layernorm(ws, attended, rows, embedding, block.dLn1Gamma, block.dLn1Beta, eps);
+    if (ok) ok = run_dense_tokens(ws, attended, rows, block.ffnIn, &hidden);
+    if (ok) ok = run_activate(ws, hidden, rows * block.ffnIn.outDim, block.activation);
+    if (ok) ok = run_dense_tokens(ws, hidden, rows, block.ffnOut, &ffnOut);
     if (ok) {
         int grid = (elements + 255) / 256;
-        add_residual_kernel<<<grid, 256>>>(ffnOut, attended, elements, block.alpha);
-        ok = check_launch();
-    }
-    if (ok) {
-        int grid = (tokens + 127) / 128;
-        layernorm_kernel<<<grid, 128>>>(ffnOut, tokens, embedding, block.dLn2Gamma, block.dLn2Beta, eps);
+        add_residual_kernel<<<grid, 256, 0, ws.stream>>>(ffnOut, attended, elements, block.alpha);
         ok = check_launch();
     }
-    if (attended) BT4_GPU_FREE(attended);
-    if (hidden) BT4_GPU_FREE(hidden);
-    if (ok) {
-        *out = ffnOut;
-    } else if (ffnOut) {
-        BT4_GPU_FREE(ffnOut);
-    }
+    if (ok) ok = run_layernorm(ws, ffnOut, rows, embedding, block.dLn2Gamma, block.dLn2Beta, eps);
+    ws.stats->end(BT4_STAGE_FFN, ws.stream);
+    if (ok) *out = ffnOut;
     return ok;
 }
 
-static bool run_body(const Bt4Net& net, const float* encoded, float** out) {
-    int width = net.inputEmbedding.inDim;
+static bool run_body(Bt4Workspace& ws, const Bt4Model& model, const float* encoded, int batch, float** out) {
+    int width = model.inputEmbedding.inDim;
+    int rows = model.tokens * batch;
     float* tokens = nullptr;
     float* flow = nullptr;
-    if (!alloc_float(&tokens, net.tokens * width)) return false;
+    if (!alloc_float(ws, &tokens, rows * width)) return false;
     int block = 256;
-    int total = net.tokens * width;
+    int total = rows * width;
     int grid = (total + block - 1) / block;
-    planes_to_tokens_kernel<<<grid, block>>>(encoded, tokens, net.inputChannels, net.tokens, width, net.peMap ? 1 : 0);
-    bool ok = check_launch() && run_dense_tokens(tokens, net.tokens, net.inputEmbedding, &flow);
-    if (ok) ok = run_activate(flow, net.tokens * net.embedding, BT4_ACT_MISH);
-    if (tokens) BT4_GPU_FREE(tokens);
-    for (const auto& blockWeights : net.encoders) {
+    ws.stats->begin(BT4_STAGE_EMBED, ws.stream);
+    planes_to_tokens_kernel<<<grid, block, 0, ws.stream>>>(encoded, tokens, model.inputChannels, model.tokens, width,
+            model.peMap ? 1 : 0, batch);
+    bool ok = check_launch() && run_dense_tokens(ws, tokens, rows, model.inputEmbedding, &flow);
+    if (ok) ok = run_activate(ws, flow, rows * model.embedding, BT4_ACT_MISH);
+    ws.stats->end(BT4_STAGE_EMBED, ws.stream);
+    for (const auto& blockWeights : model.encoders) {
         if (!ok) break;
         float* next = nullptr;
-        ok = run_encoder_block(flow, blockWeights, net.tokens, net.eps, &next);
-        BT4_GPU_FREE(flow);
+        ok = run_encoder_block(ws, flow, blockWeights, model.tokens, batch, model.eps, &next);
         flow = next;
     }
-    if (ok) {
-        *out = flow;
-    } else if (flow) {
-        BT4_GPU_FREE(flow);
-    }
+    if (ok) *out = flow;
     return ok;
 }
 
-static bool run_policy(const Bt4Net& net, const float* body, float** policyOut) {
+static bool run_policy(Bt4Workspace& ws, const Bt4Model& model, const float* body, int batch, float* policy) {
+    int rows = model.tokens * batch;
     float* flow = nullptr;
-    bool ok = run_dense_tokens(body, net.tokens, net.policy.embedding, &flow);
-    if (ok) ok = run_activate(flow, net.tokens * net.policy.embedding.outDim, net.policy.activation);
-    for (const auto& blockWeights : net.policy.encoders) {
+    bool ok = run_dense_tokens(ws, body, rows, model.policy.embedding, &flow);
+    if (ok) ok = run_activate(ws, flow, rows * model.policy.embedding.outDim, model.policy.activation);
+    for (const auto& blockWeights : model.policy.encoders) {
         if (!ok) break;
         float* next = nullptr;
-        ok = run_encoder_block(flow, blockWeights, net.tokens, net.eps, &next);
-        BT4_GPU_FREE(flow);
+        ok = run_encoder_block(ws, flow, blockWeights, model.tokens, batch, model.eps, &next);
         flow = next;
     }
     float* q = nullptr;
     float* k = nullptr;
     float* internal = nullptr;
-    float* policy = nullptr;
-    if (ok) ok = run_dense_tokens(flow, net.tokens, net.policy.query, &q)
-            && run_dense_tokens(flow, net.tokens, net.policy.key, &k)
-            && alloc_float(&internal, BT4_INTERNAL_POLICY_SIZE)
-            && alloc_float(&policy, net.policySize);
+    if (ok) ok = run_dense_tokens(ws, flow, rows, model.policy.query, &q)
+            && run_dense_tokens(ws, flow, rows, model.policy.key, &k)
+            && alloc_float(ws, &internal, batch * BT4_INTERNAL_POLICY_SIZE);
     if (ok) {
-        BT4_GPU_MEMSET(internal, 0, BT4_INTERNAL_POLICY_SIZE * sizeof(float));
-        BT4_GPU_MEMSET(policy, 0, static_cast<size_t>(net.policySize) * sizeof(float));
-        int grid = (64 * 64 + 255) / 256;
-        policy_from_to_kernel<<<grid, 256>>>(q, k, internal, net.policy.query.outDim);
-        ok = check_launch();
+        const size_t b = static_cast<size_t>(batch);
+        ok = gpu_ok(BT4_GPU_MEMSET_ASYNC(internal, 0, b * BT4_INTERNAL_POLICY_SIZE * sizeof(float), ws.stream))
+                && gpu_ok(BT4_GPU_MEMSET_ASYNC(policy, 0, b * model.policySize * sizeof(float), ws.stream));
     }
     if (ok) {
-        underpromotion_kernel<<<1, 256>>>(internal, k, net.policy.query.outDim, net.policy.dPromotionWeights);
+        dim3 grid((64 * 64 + 255) / 256, batch);
+        policy_from_to_kernel<<<grid, 256, 0, ws.stream>>>(q, k, internal, model.policy.query.outDim);
         ok = check_launch();
     }
     if (ok) {
-        int grid = (BT4_INTERNAL_POLICY_SIZE + 255) / 256;
-        gather_policy_kernel<<<grid, 256>>>(internal, net.dPolicyMap, policy);
+        underpromotion_kernel<<<dim3(1, batch), 256, 0, ws.stream>>>(internal, k, model.policy.query.outDim,
+                model.policy.dPromotionWeights);
         ok = check_launch();
     }
-    if (flow) BT4_GPU_FREE(flow);
-    if (q) BT4_GPU_FREE(q);
-    if (k) BT4_GPU_FREE(k);
-    if (internal) BT4_GPU_FREE(internal);
     if (ok) {
-        *policyOut = policy;
-    } else if (policy) {
-        BT4_GPU_FREE(policy);
+        dim3 grid((BT4_INTERNAL_POLICY_SIZE + 255) / 256, batch);
+        gather_policy_kernel<<<grid, 256, 0, ws.stream>>>(internal, model.dPolicyMap, policy, model.policySize);
+        ok = check_launch();
     }
     return ok;
 }
 
-static bool run_value(const Bt4Net& net, const float* body, float** wdlOut) {
+// The value embedding output of one position is contiguous, so fc1/fc2 run as the same GEMM with
+// one row per position.
+static bool run_value(Bt4Workspace& ws, const Bt4Model& model, const float* body, int batch, float* wdl) {
     float* flow = nullptr;
     float* hidden = nullptr;
-    float* logits = nullptr;
-    bool ok = run_dense_tokens(body, net.tokens, net.value.embedding, &flow);
-    if (ok) ok = run_activate(flow, net.tokens * net.value.embedding.outDim, net.value.activation);
-    if (ok) ok = run_dense_vector(flow, net.value.fc1, &hidden);
-    if (ok) ok = run_activate(hidden, net.value.fc1.outDim, net.value.activation);
-    if (ok) ok = run_dense_vector(hidden, net.value.fc2, &logits);
+    int rows = model.tokens * batch;
+    bool ok = run_dense_tokens(ws, body, rows, model.value.embedding, &flow);
+    if (ok) ok = run_activate(ws, flow, rows * model.value.embedding.outDim, model.value.activation);
+    if (ok) ok = run_dense_tokens(ws, flow, batch, model.value.fc1, &hidden);
+    if (ok) ok = run_activate(ws, hidden, batch * model.value.fc1.outDim, model.value.activation);
+    if (ok) ok = launch_dense_tokens(ws, hidden, batch, model.value.fc2, wdl);
     if (ok) {
-        softmax3_kernel<<<1, 1>>>(logits);
+        softmax3_kernel<<<(batch + 127) / 128, 128, 0, ws.stream>>>(wdl, batch);
         ok = check_launch();
     }
-    if (flow) BT4_GPU_FREE(flow);
-    if (hidden) BT4_GPU_FREE(hidden);
-    if (ok) {
-        *wdlOut = logits;
-    } else if (logits) {
-        BT4_GPU_FREE(logits);
-    }
     return ok;
 }
 
-static bool predict_gpu(const Bt4Net& net, const std::vector<float>& encoded, std::vector<float>& policy,
-        std::vector<float>& wdl) {
-    float* dEncoded = nullptr;
+// Enqueues the full forward pass for `batch` positions on net.workspace.stream, reading
+// net.dEncoded and writing net.dPolicyOut / net.dWdlOut. The outputs live outside the arena, so
+// their addresses are the same for every batch size and graph.
+static bool record_forward(Bt4Net& net, int batch) {
+    Bt4Workspace& ws = net.workspace;
+    ws.used = 0;
     float* body = nullptr;
-    float* dPolicy = nullptr;
-    float* dWdl = nullptr;
-    bool ok = upload_floats(encoded, &dEncoded)
-            && run_body(net, dEncoded, &body)
-            && run_policy(net, body, &dPolicy)
-            && run_value(net, body, &dWdl);
+    const Bt4Model& model = *net.model;
+    if (!run_body(ws, model, net.dEncoded, batch, &body)) return false;
+    ws.stats->begin(BT4_STAGE_POLICY, ws.stream);
+    bool ok = run_policy(ws, model, body, batch, net.dPolicyOut);
+    ws.stats->end(BT4_STAGE_POLICY, ws.stream);
+    if (!ok) return false;
+    ws.stats->begin(BT4_STAGE_VALUE, ws.stream);
+    ok = run_value(ws, model, body, batch, net.dWdlOut);
+    ws.stats->end(BT4_STAGE_VALUE, ws.stream);
+    return ok;
+}
+
+// Allocates the input/output buffers, the forward arena and the launch stream once per handle, all
+// sized for maxBatch positions.
+static bool init_workspace(Bt4Net& net) {
+    Bt4Workspace& ws = net.workspace;
+    const Bt4Model& model = *net.model;
+    net.maxBatch = max_batch_from_env();
+    ws.capacity = forward_floats(model, net.maxBatch);
+    if (!gpu_ok(BT4_GPU_MALLOC(&ws.arena, ws.capacity * sizeof(float)))) return false;
+    size_t encodedBytes = static_cast<size_t>(net.maxBatch) * model.inputChannels * model.tokens * sizeof(float);
+    if (!gpu_ok(BT4_GPU_MALLOC(&net.dEncoded, encodedBytes))) return false;
+    size_t policyBytes = static_cast<size_t>(net.maxBatch) * model.policySize * sizeof(float);
+    if (!gpu_ok(BT4_GPU_MALLOC(&net.dPolicyOut, policyBytes))) return false;
+    if (!gpu_ok(BT4_GPU_MALLOC(&net.dWdlOut, static_cast<size_t>(net.maxBatch) * 3 * sizeof(float)))) return false;
+    if (!gpu_ok(BT4_GPU_STREAM_CREATE(&ws.stream))) return false;
+    net.graphs.assign(static_cast<size_t>(net.maxBatch) + 1, nullptr);
+    net.useGraphs = gpu_graphs_from_env(BT4_GRAPHS_ENV);
+    net.stats.configure(BT4_STAGE_NAMES, BT4_STAGES, gpu_stats_from_env(BT4_STATS_ENV));
+    if (net.stats.enabled()) net.useGraphs = false;
+    ws.stats = &net.stats;
+    return true;
+}
+
+// Runs the forward pass over the `batch` positions already in net.dEncoded and downloads policy
+// logits [batch][policySize] and WDL probabilities [batch][3].
+static bool forward_uploaded(Bt4Net& net, int batch, std::chrono::steady_clock::time_point started,
+                             float* policy, float* wdl) {
+    BT4_GPU_STREAM stream = net.workspace.stream;
+    const size_t b = static_cast<size_t>(batch);
+    bool ok = gpu_graph_launch(net.graphs[b], net.useGraphs, stream,
+            [&net, batch]() { return record_forward(net, batch); });
     if (ok) {
-        ok = gpu_ok(BT4_GPU_DEVICE_SYNCHRONIZE());
+        const size_t policyBytes = b * net.model->policySize * sizeof(float);
+        net.stats.begin(BT4_STAGE_DOWNLOAD, stream);
+        ok = gpu_ok(BT4_GPU_MEMCPY_ASYNC(policy, net.dPolicyOut, policyBytes, BT4_GPU_MEMCPY_D2H, stream))
+                && gpu_ok(BT4_GPU_MEMCPY_ASYNC(wdl, net.dWdlOut, b * 3 * sizeof(float), BT4_GPU_MEMCPY_D2H, stream));
+        net.stats.end(BT4_STAGE_DOWNLOAD, stream, static_cast<long long>(policyBytes + b * 3 * sizeof(float)));
+        ok = ok && gpu_ok(BT4_GPU_STREAM_SYNCHRONIZE(stream));
     }
     if (ok) {
-        policy.assign(static_cast<size_t>(net.policySize), 0.0f);
-        wdl.assign(3, 0.0f);
-        ok = gpu_ok(BT4_GPU_MEMCPY(policy.data(), dPolicy, policy.size() * sizeof(float), BT4_GPU_MEMCPY_D2H))
-                && gpu_ok(BT4_GPU_MEMCPY(wdl.data(), dWdl, wdl.size() * sizeof(float), BT4_GPU_MEMCPY_D2H));
-    }
-    if (dEncoded) BT4_GPU_FREE(dEncoded);
-    if (body) BT4_GPU_FREE(body);
-    if (dPolicy) BT4_GPU_FREE(dPolicy);
-    if (dWdl) BT4_GPU_FREE(dWdl);
+        net.stats.collect();
+        net.evalCount++;
+        net.evalNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - started).count();
+    }
     return ok;
 }
 
+// Evaluates 1..maxBatch positions stored back to back in `encoded` ([batch][inputChannels][64]),
+// writing policy logits [batch][policySize] and WDL probabilities [batch][3].
+static bool predict_gpu(Bt4Net& net, const float* encoded, int batch, float* policy, float* wdl) {
+    if (batch <= 0 || batch > net.maxBatch || !bind_device(net)) return false;
+    const auto started = std::chrono::steady_clock::now();
+    const Bt4Model& model = *net.model;
+    const size_t bytes = static_cast<size_t>(batch) * model.inputChannels * model.tokens * sizeof(float);
+    BT4_GPU_STREAM stream = net.workspace.stream;
+    net.stats.begin(BT4_STAGE_UPLOAD, stream);
+    bool ok = gpu_ok(BT4_GPU_MEMCPY_ASYNC(net.dEncoded, encoded, bytes, BT4_GPU_MEMCPY_H2D, stream));
+    net.stats.end(BT4_STAGE_UPLOAD, stream, static_cast<long long>(bytes));
+    return ok && forward_uploaded(net, batch, started, policy, wdl);
+}
+
+// Same as predict_gpu for packed positions ([batch][inputChannels + 1] words, see
+// packed_planes_impl.inl): uploads the words and expands them into net.dEncoded on the device.
+static bool predict_packed_gpu(Bt4Net& net, const unsigned long long* packed, int batch, float* policy, float* wdl) {
+    const Bt4Model& model = *net.model;
+    if (batch <= 0 || batch > net.maxBatch || model.tokens != 64 || !bind_device(net)) return false;
+    const size_t words = static_cast<size_t>(packed_words(model.inputChannels));
+    if (!net.dPacked && !gpu_ok(BT4_GPU_MALLOC(&net.dPacked, net.maxBatch * words * sizeof(unsigned long long)))) {
+        net.dPacked = nullptr;
+        return false;
+    }
+    const auto started = std::chrono::steady_clock::now();
+    BT4_GPU_STREAM stream = net.workspace.stream;
+    const size_t bytes = batch * words * sizeof(unsigned long long);
+    net.stats.begin(BT4_STAGE_UPLOAD, stream);
+    bool ok = gpu_ok(BT4_GPU_MEMCPY_ASYNC(net.dPacked, packed, bytes, BT4_GPU_MEMCPY_H2D, stream));
+    net.stats.end(BT4_STAGE_UPLOAD, stream, static_cast<long long>(bytes));
+    if (!ok) return false;
+    net.stats.begin(BT4_STAGE_EXPAND, stream);
+    k_expand_packed_planes<<<dim3(model.inputChannels, batch), 64, 0, stream>>>(net.dPacked, model.inputChannels,
+            net.dEncoded);
+    net.stats.end(BT4_STAGE_EXPAND, stream);
+    return check_launch() && forward_uploaded(net, batch, started, policy, wdl);
+}
+
+// Allocates the pinned input/output buffers on first use (see pinned_io_impl.inl).
+static bool alloc_pinned(Bt4Net& net) {
+    if (net.hEncoded) return true;
+    if (!bind_device(net)) return false;
+    const size_t b = static_cast<size_t>(net.maxBatch);
+    const Bt4Model& model = *net.model;
+    if (gpu_ok(BT4_GPU_HOST_ALLOC(&net.hEncoded, b * model.inputChannels * model.tokens * sizeof(float)))
+            && gpu_ok(BT4_GPU_HOST_ALLOC(&net.hPolicy, b * model.policySize * sizeof(float)))
+            && gpu_ok(BT4_GPU_HOST_ALLOC(&net.hWdl, b * 3 * sizeof(float)))) {
+        return true;
+    }
+    if (net.hEncoded) BT4_GPU_HOST_FREE(net.hEncoded);
+    if (net.hPolicy) BT4_GPU_HOST_FREE(net.hPolicy);
+    if (net.hWdl) BT4_GPU_HOST_FREE(net.hWdl);
+    net.hEncoded = net.hPolicy = net.hWdl = nullptr;
+    return false;
+}
+
 static std::string jstring_to_string(JNIEnv* env, jstring value) {
     if (!value) return {};
     const char* chars = env->GetStringUTFChars(value, nullptr);
@@ -801,6 +1318,59 @@ static std::string jstring_to_string(JNIEnv* env, jstring value) {
     return out;
 }
 
+// Models currently held by live handles, one per (path, device, dtype).
+static WeightCache<Bt4Model>& weight_cache() {
+    static WeightCache<Bt4Model> cache(release_model);
+    return cache;
+}
+
+// Opens a handle on one device ordinal, or returns null when the ordinal is not visible. The
+// weights come from the shared cache; the handle allocates only its own workspace.
+static Bt4Net* create_on_device(const std::string& path, int device) {
+    int count = 0;
+    if (path.empty() || device < 0 || !gpu_ok(BT4_GPU_GET_DEVICE_COUNT(&count)) || device >= count
+            || !gpu_ok(BT4_GPU_SET_DEVICE(device))) {
+        return nullptr;
+    }
+    const Bt4DType dtype = parse_dtype();
+    std::shared_ptr<const Bt4Model> model = weight_cache().acquire(path, device, static_cast<int>(dtype),
+            [&]() { return load_model(path, device, dtype); });
+    if (!model) return nullptr;
+    auto* net = new Bt4Net();
+    net->model = std::move(model);
+    net->device = device;
+    if (!init_workspace(*net)) {
+        release_net(net);
+        return nullptr;
+    }
+    return net;
+}
+
+// nativeGetInfo result for one handle (layout documented on Backend.nativeGetInfo).
+static jlongArray info_array(JNIEnv* env, const Bt4Net& net) {
+    const Bt4Model& model = *net.model;
+    jlong values[12] = {
+            static_cast<jlong>(model.inputChannels),
+            static_cast<jlong>(model.tokens),
+            static_cast<jlong>(model.embedding),
+            static_cast<jlong>(model.encoderLayers),
+            static_cast<jlong>(model.heads),
+            static_cast<jlong>(model.policySize),
+            static_cast<jlong>(model.parameterCount),
+            static_cast<jlong>(model.dtype),
+            static_cast<jlong>(net.useGraphs ? 1 : 0),
+            static_cast<jlong>(net.evalCount),
+            static_cast<jlong>(net.evalCount > 0 ? net.evalNanos / net.evalCount : 0),
+            static_cast<jlong>(net.maxBatch)
+    };
+    jlongArray out = env->NewLongArray(12);
+    if (!out) return nullptr;
+    env->SetLongArrayRegion(out, 0, 12, values);
+    return out;
+}
+
+using Bt4Pool = ReplicaPool<Bt4Net>;
+
 } // namespace
 
 extern "C" JNIEXPORT jint JNICALL BT4_JNI(Support_nativeDeviceCount)(JNIEnv*, jclass) {
@@ -810,9 +1380,12 @@ extern "C" JNIEXPORT jint JNICALL BT4_JNI(Support_nativeDeviceCount)(JNIEnv*, jc
 }
 
 extern "C" JNIEXPORT jlong JNICALL BT4_JNI(Backend_nativeCreate)(JNIEnv* env, jclass, jstring path) {
-    std::string nativePath = jstring_to_string(env, path);
-    if (nativePath.empty()) return 0L;
-    return reinterpret_cast<jlong>(load_net(nativePath));
+    return reinterpret_cast<jlong>(create_on_device(jstring_to_string(env, path), 0));
+}
+
+extern "C" JNIEXPORT jlong JNICALL BT4_JNI(Backend_nativeCreateOnDevice)(
+        JNIEnv* env, jclass, jstring path, jint device) {
+    return reinterpret_cast<jlong>(create_on_device(jstring_to_string(env, path), device));
 }
 
 extern "C" JNIEXPORT void JNICALL BT4_JNI(Backend_nativeDestroy)(JNIEnv*, jclass, jlong handle) {
@@ -822,49 +1395,225 @@ extern "C" JNIEXPORT void JNICALL BT4_JNI(Backend_nativeDestroy)(JNIEnv*, jclass
 extern "C" JNIEXPORT jstring JNICALL BT4_JNI(Backend_nativeGetName)(JNIEnv* env, jclass, jlong handle) {
     auto* net = reinterpret_cast<Bt4Net*>(handle);
     if (!net) return nullptr;
-    return env->NewStringUTF(net->name.c_str());
+    return env->NewStringUTF(net->model->name.c_str());
 }
 
 extern "C" JNIEXPORT jlongArray JNICALL BT4_JNI(Backend_nativeGetInfo)(JNIEnv* env, jclass, jlong handle) {
     auto* net = reinterpret_cast<Bt4Net*>(handle);
     if (!net) return nullptr;
-    jlong values[7] = {
-            static_cast<jlong>(net->inputChannels),
-            static_cast<jlong>(net->tokens),
-            static_cast<jlong>(net->embedding),
-            static_cast<jlong>(net->encoderLayers),
-            static_cast<jlong>(net->heads),
-            static_cast<jlong>(net->policySize),
-            static_cast<jlong>(net->parameterCount)
-    };
-    jlongArray out = env->NewLongArray(7);
-    if (!out) return nullptr;
-    env->SetLongArrayRegion(out, 0, 7, values);
-    return out;
+    return info_array(env, *net);
+}
+
+extern "C" JNIEXPORT jstring JNICALL BT4_JNI(Backend_nativeGetStatNames)(JNIEnv* env, jclass, jlong handle) {
+    auto* net = reinterpret_cast<Bt4Net*>(handle);
+    if (!net) return nullptr;
+    return net->stats.names_string(env);
+}
+
+// Per-stage counters (layout in gpu_stats_impl.inl), zeroed after reading when `reset` is set.
+extern "C" JNIEXPORT jlongArray JNICALL BT4_JNI(Backend_nativeGetStats)(
+        JNIEnv* env, jclass, jlong handle, jboolean reset) {
+    auto* net = reinterpret_cast<Bt4Net*>(handle);
+    if (!net) return nullptr;
+    return net->stats.to_array(env, reset == JNI_TRUE);
 }
 
 extern "C" JNIEXPORT jfloat JNICALL BT4_JNI(Backend_nativePredict)(
         JNIEnv* env, jclass, jlong handle, jfloatArray encodedPlanes, jfloatArray outPolicy, jfloatArray outWdl) {
     auto* net = reinterpret_cast<Bt4Net*>(handle);
     if (!net || !encodedPlanes || !outPolicy || !outWdl) return 0.0f;
+    const Bt4Model& model = *net->model;
     jsize encodedLength = env->GetArrayLength(encodedPlanes);
-    if (encodedLength != net->inputChannels * net->tokens
-            || env->GetArrayLength(outPolicy) != net->policySize
+    if (encodedLength != model.inputChannels * model.tokens
+            || env->GetArrayLength(outPolicy) != model.policySize
             || env->GetArrayLength(outWdl) != 3) {
         return 0.0f;
     }
     std::vector<float> encoded(static_cast<size_t>(encodedLength));
     env->GetFloatArrayRegion(encodedPlanes, 0, encodedLength, encoded.data());
-    std::vector<float> policy;
-    std::vector<float> wdl;
-    if (!predict_gpu(*net, encoded, policy, wdl)) {
+    std::vector<float> policy(static_cast<size_t>(model.policySize));
+    std::vector<float> wdl(3);
+    if (!predict_gpu(*net, encoded.data(), 1, policy.data(), wdl.data())) {
         return 0.0f;
     }
-    env->SetFloatArrayRegion(outPolicy, 0, net->policySize, policy.data());
+    env->SetFloatArrayRegion(outPolicy, 0, model.policySize, policy.data());
     env->SetFloatArrayRegion(outWdl, 0, 3, wdl.data());
     return wdl[0] - wdl[2];
 }
 
+// Batched predict: evaluates `count` positions packed back to back in `encodedBatch` and writes
+// policy/WDL/value in the same order. Requests larger than maxBatch run in maxBatch-sized chunks.
+// Returns the number of positions evaluated (count on success, 0 on failure).
+extern "C" JNIEXPORT jint JNICALL BT4_JNI(Backend_nativePredictBatch)(
+        JNIEnv* env, jclass, jlong handle, jfloatArray encodedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* net = reinterpret_cast<Bt4Net*>(handle);
+    if (!net || !encodedBatch || !outPolicy || !outWdl || !outValue || count <= 0) return 0;
+    const Bt4Model& model = *net->model;
+    const size_t n = static_cast<size_t>(count);
+    const size_t encStride = static_cast<size_t>(model.inputChannels) * model.tokens;
+    const size_t polStride = static_cast<size_t>(model.policySize);
+    if (static_cast<size_t>(env->GetArrayLength(encodedBatch)) < n * encStride
+            || static_cast<size_t>(env->GetArrayLength(outPolicy)) < n * polStride
+            || static_cast<size_t>(env->GetArrayLength(outWdl)) < n * 3
+            || static_cast<size_t>(env->GetArrayLength(outValue)) < n) {
+        return 0;
+    }
+    std::vector<float> encoded(n * encStride);
+    env->GetFloatArrayRegion(encodedBatch, 0, static_cast<jsize>(encoded.size()), encoded.data());
+    std::vector<float> policy(n * polStride);
+    std::vector<float> wdl(n * 3);
+    std::vector<float> values(n);
+    for (size_t off = 0; off < n; off += static_cast<size_t>(net->maxBatch)) {
+        const int chunk = static_cast<int>(std::min(n - off, static_cast<size_t>(net->maxBatch)));
+        if (!predict_gpu(*net, encoded.data() + off * encStride, chunk, policy.data() + off * polStride,
+                wdl.data() + off * 3)) {
+            return 0;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) values[i] = wdl[i * 3] - wdl[i * 3 + 2];
+    env->SetFloatArrayRegion(outPolicy, 0, static_cast<jsize>(policy.size()), policy.data());
+    env->SetFloatArrayRegion(outWdl, 0, static_cast<jsize>(wdl.size()), wdl.data());
+    env->SetFloatArrayRegion(outValue, 0, static_cast<jsize>(values.size()), values.data());
+    return count;
+}
+
+// Batched predict from packed positions ([count][inputChannels + 1] longs, see
+// packed_planes_impl.inl); outputs and chunking as nativePredictBatch. Returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL BT4_JNI(Backend_nativePredictPacked)(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* net = reinterpret_cast<Bt4Net*>(handle);
+    if (!net) return 0;
+    const Bt4Model& model = *net->model;
+    return packed_predict_batch(env, packedBatch, count, model.inputChannels, net->maxBatch, model.policySize,
+            outPolicy, outWdl, outValue,
+            [net](const unsigned long long* packed, int chunk, float* policy, float* wdl) {
+                return predict_packed_gpu(*net, packed, chunk, policy, wdl);
+            });
+}
+
+extern "C" JNIEXPORT jobjectArray JNICALL BT4_JNI(Backend_nativePinnedBuffers)(JNIEnv* env, jclass, jlong handle) {
+    auto* net = reinterpret_cast<Bt4Net*>(handle);
+    if (!net || !alloc_pinned(*net)) return nullptr;
+    const Bt4Model& model = *net->model;
+    const size_t b = static_cast<size_t>(net->maxBatch);
+    return pinned_buffer_array(env, net->hEncoded, b * model.inputChannels * model.tokens,
+            net->hPolicy, b * model.policySize, net->hWdl, b * 3);
+}
+
+// Evaluates the first `count` positions of the pinned input buffer into the pinned outputs.
+extern "C" JNIEXPORT jint JNICALL BT4_JNI(Backend_nativePredictPinned)(JNIEnv*, jclass, jlong handle, jint count) {
+    auto* net = reinterpret_cast<Bt4Net*>(handle);
+    if (!net || !net->hEncoded || count <= 0 || count > net->maxBatch) return 0;
+    return predict_gpu(*net, net->hEncoded, count, net->hPolicy, net->hWdl) ? count : 0;
+}
+
+// Coalescing evaluation queue over this handle (see eval_queue_impl.inl). maxBatch <= 0, or
+// above the handle's own maxBatch, uses the handle's maxBatch; a negative deadline uses the default.
+extern "C" JNIEXPORT jlong JNICALL BT4_JNI(Backend_nativeQueueCreate)(
+        JNIEnv*, jclass, jlong handle, jint maxBatch, jlong deadlineMicros) {
+    auto* net = reinterpret_cast<Bt4Net*>(handle);
+    if (!net) return 0;
+    const Bt4Model& model = *net->model;
+    const int batch = (maxBatch <= 0 || maxBatch > net->maxBatch) ? net->maxBatch : maxBatch;
+    try {
+        auto* queue = new EvalQueue(model.inputChannels * model.tokens, model.policySize, batch, deadlineMicros,
+                [net](const float* encoded, int count, float* policy, float* wdl) {
+                    return predict_gpu(*net, encoded, count, policy, wdl);
+                });
+        return reinterpret_cast<jlong>(queue);
+    } catch (...) {
+        return 0;
+    }
+}
+
+extern "C" JNIEXPORT jlong JNICALL BT4_JNI(Backend_nativeQueueSubmit)(
+        JNIEnv* env, jclass, jlong queue, jfloatArray encodedPlanes) {
+    return eval_queue_submit(env, queue, encodedPlanes);
+}
+
+extern "C" JNIEXPORT jlong JNICALL BT4_JNI(Backend_nativeQueueTake)(
+        JNIEnv* env, jclass, jlong queue, jfloatArray outPolicy, jfloatArray outWdl) {
+    return eval_queue_take(env, queue, outPolicy, outWdl);
+}
+
+extern "C" JNIEXPORT void JNICALL BT4_JNI(Backend_nativeQueueClose)(JNIEnv*, jclass, jlong queue) {
+    eval_queue_close(queue);
+}
+
+extern "C" JNIEXPORT void JNICALL BT4_JNI(Backend_nativeQueueDestroy)(JNIEnv*, jclass, jlong queue) {
+    eval_queue_destroy(queue);
+}
+
+// Replica pool over one handle per device ordinal in `devices` (see replica_pool_impl.inl).
+extern "C" JNIEXPORT jlong JNICALL BT4_JNI(Backend_nativePoolCreate)(
+        JNIEnv* env, jclass, jstring path, jintArray devices) {
+    const std::string nativePath = jstring_to_string(env, path);
+    return reinterpret_cast<jlong>(replica_pool_create<Bt4Net>(env, devices, release_net,
+            [&nativePath](int device) { return create_on_device(nativePath, device); }));
+}
+
+extern "C" JNIEXPORT void JNICALL BT4_JNI(Backend_nativePoolDestroy)(JNIEnv*, jclass, jlong pool) {
+    delete reinterpret_cast<Bt4Pool*>(pool);
+}
+
+extern "C" JNIEXPORT jstring JNICALL BT4_JNI(Backend_nativePoolGetName)(JNIEnv* env, jclass, jlong pool) {
+    auto* replicas = reinterpret_cast<Bt4Pool*>(pool);
+    if (!replicas) return nullptr;
+    return env->NewStringUTF(replicas->front().model->name.c_str());
+}
+
+// nativeGetInfo of the first replica.
+extern "C" JNIEXPORT jlongArray JNICALL BT4_JNI(Backend_nativePoolGetInfo)(JNIEnv* env, jclass, jlong pool) {
+    auto* replicas = reinterpret_cast<Bt4Pool*>(pool);
+    if (!replicas) return nullptr;
+    return info_array(env, replicas->front());
+}
+
+// nativePredictBatch across the pool; returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL BT4_JNI(Backend_nativePoolPredictBatch)(
+        JNIEnv* env, jclass, jlong pool, jfloatArray encodedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* replicas = reinterpret_cast<Bt4Pool*>(pool);
+    if (!replicas) return 0;
+    const Bt4Net& net = replicas->front();
+    const Bt4Model& model = *net.model;
+    return replica_pool_predict_batch(env, *replicas, encodedBatch, count, model.inputChannels * model.tokens,
+            net.maxBatch, model.policySize, outPolicy, outWdl, outValue,
+            [](Bt4Net& replica, const float* encoded, int chunk, float* policy, float* wdl) {
+                return predict_gpu(replica, encoded, chunk, policy, wdl);
+            });
+}
+
+// nativePredictPacked across the pool; returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL BT4_JNI(Backend_nativePoolPredictPacked)(
+        JNIEnv* env, jclass, jlong pool, jlongArray packedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* replicas = reinterpret_cast<Bt4Pool*>(pool);
+    if (!replicas || count <= 0) return 0;
+    const Bt4Net& net = replicas->front();
+    const Bt4Model& model = *net.model;
+    const size_t words = static_cast<size_t>(packed_words(model.inputChannels));
+    const size_t polStride = static_cast<size_t>(model.policySize);
+    return packed_predict_batch(env, packedBatch, count, model.inputChannels, count, model.policySize,
+            outPolicy, outWdl, outValue,
+            [&](const unsigned long long* packed, int n, float* policy, float* wdl) {
+                return replicas->run(static_cast<size_t>(n), net.maxBatch,
+                        [&](Bt4Net& replica, size_t first, int chunk) {
+                            return predict_packed_gpu(replica, packed + first * words, chunk,
+                                    policy + first * polStride, wdl + first * 3);
+                        });
+            });
+}
+
+// {device, calls, positions} per replica.
+extern "C" JNIEXPORT jlongArray JNICALL BT4_JNI(Backend_nativePoolStats)(JNIEnv* env, jclass, jlong pool) {
+    auto* replicas = reinterpret_cast<Bt4Pool*>(pool);
+    if (!replicas) return nullptr;
+    return replica_pool_stats(env, *replicas);
+}
+
 #undef BT4_JNI
 #undef BT4_CAT
 #undef BT4_CAT2
@@ -0,0 +1,220 @@
+/*
+ * native/common/lc0_cnn_loader_impl.inl
+ *
+ * Host-side parser for the ChessRTK LC0 CNN ".bin" weights shared by the CUDA, ROCm and host CPU
+ * backends. lc0_read_net() reads the whole file into plain float vectors (Lc0Net); each backend
+ * then turns the layers into its own storage: device buffers in the chosen precision for the GPU
+ * backends, packed GEMM panels for the host backend. The checks follow the Java loader
+ * (src/chess/nn/lc0/cnn/Weights.java): magic "LC0J", version 1, three WDL outputs, SE units sized
+ * for their block, a policy map as long as the header says and no trailing bytes. On top of that
+ * every array must hold exactly as many floats as its declared shape and every layer must read
+ * the channels its producer writes, since the native kernels index by shape rather than by array
+ * length.
+ *
+ * Layout (little-endian):
+ *   "LC0J" version:i32
+ *   inputC trunkC blocks policyC valueC valueHidden policyMapLen wdlOutputs : i32
+ *   conv input, blocks x { conv conv se }, conv policyStem, conv policyOut, conv valueConv,
+ *   dense valueFc1, dense valueFc2, policyMap (count:i32, int32[count])
+ * where
+ *   conv  = outC inC k : i32, floats w [outC][inC][k][k], floats b [outC]   (k is 1 or 3)
+ *   dense = outD inD : i32, floats w [outD][inD], floats b [outD]
+ *   se    = present:u8, then hidden channels : i32, floats w1 [hidden][channels], b1 [hidden],
+ *           w2 [2*channels][hidden], b2 [2*channels]
+ *   floats = count:i32 float[count]
+ */
+
+#ifndef CRTK_LC0_CNN_LOADER_IMPL_INL
+#define CRTK_LC0_CNN_LOADER_IMPL_INL
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Lc0Conv {
+    int inC = 0;
+    int outC = 0;
+    int k = 0;
+    std::vector<float> w; // [outC][inC][k][k]
+    std::vector<float> b; // [outC]
+
+    int64_t params() const { return static_cast<int64_t>(w.size() + b.size()); }
+};
+
+struct Lc0Dense {
+    int inD = 0;
+    int outD = 0;
+    std::vector<float> w; // [outD][inD]
+    std::vector<float> b; // [outD]
+
+    int64_t params() const { return static_cast<int64_t>(w.size() + b.size()); }
+};
+
+struct Lc0Se {
+    int channels = 0;
+    int hidden = 0;
+    std::vector<float> w1; // [hidden][channels]
+    std::vector<float> b1; // [hidden]
+    std::vector<float> w2; // [2*channels][hidden]
+    std::vector<float> b2; // [2*channels]
+
+    int64_t params() const { return static_cast<int64_t>(w1.size() + b1.size() + w2.size() + b2.size()); }
+};
+
+struct Lc0Block {
+    Lc0Conv conv1;
+    Lc0Conv conv2;
+    bool hasSe = false;
+    Lc0Se se;
+};
+
+struct Lc0Net {
+    int inputC = 0;
+    int trunkC = 0;
+    int blocks = 0;
+    int policyC = 0;
+    int valueC = 0;
+    int valueHidden = 0;
+    int policySize = 0;
+    int seMaxHidden = 0;   // widest SE hidden layer in the tower
+    int64_t paramCount = 0; // weights and biases, as counted by the Java loader
+
+    Lc0Conv input;
+    std::vector<Lc0Block> tower;
+    Lc0Conv policyStem;
+    Lc0Conv policyOut;
+    Lc0Conv valueConv;
+    Lc0Dense valueFc1;
+    Lc0Dense valueFc2;
+    std::vector<int32_t> policyMap; // [policySize] indices into the [policyC][64] policy planes
+};
+
+static bool lc0_read_u8(std::ifstream& f, uint8_t& out) {
+    f.read(reinterpret_cast<char*>(&out), 1);
+    return bool(f);
+}
+
+static bool lc0_read_i32(std::ifstream& f, int32_t& out) {
+    f.read(reinterpret_cast<char*>(&out), 4);
+    return bool(f);
+}
+
+static bool lc0_read_bytes(std::ifstream& f, void* dst, size_t n) {
+    f.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n));
+    return bool(f);
+}
+
+// Reads a float array that must hold exactly `expected` values.
+static bool lc0_read_floats(std::ifstream& f, std::vector<float>& out, int64_t expected) {
+    int32_t size = 0;
+    if (!lc0_read_i32(f, size)) return false;
+    if (size < 0 || static_cast<int64_t>(size) != expected) return false;
+    out.resize(static_cast<size_t>(size));
+    return lc0_read_bytes(f, out.data(), sizeof(float) * out.size());
+}
+
+// Reads a conv layer that consumes `inC` channels.
+static bool lc0_read_conv(std::ifstream& f, Lc0Conv& out, int inC) {
+    int32_t oc, ic, k;
+    if (!lc0_read_i32(f, oc) || !lc0_read_i32(f, ic) || !lc0_read_i32(f, k)) return false;
+    if (oc <= 0 || ic != inC || (k != 1 && k != 3)) return false;
+    out.inC = ic;
+    out.outC = oc;
+    out.k = k;
+    return lc0_read_floats(f, out.w, static_cast<int64_t>(oc) * ic * k * k)
+            && lc0_read_floats(f, out.b, oc);
+}
+
+static bool lc0_read_dense(std::ifstream& f, Lc0Dense& out, int inD, int expectedOut) {
+    int32_t od, id;
+    if (!lc0_read_i32(f, od) || !lc0_read_i32(f, id)) return false;
+    if (od != expectedOut || id != inD) return false;
+    out.inD = id;
+    out.outD = od;
+    return lc0_read_floats(f, out.w, static_cast<int64_t>(od) * id) && lc0_read_floats(f, out.b, od);
+}
+
+static bool lc0_read_se(std::ifstream& f, Lc0Se& out, bool& present, int channels) {
+    uint8_t p = 0;
+    if (!lc0_read_u8(f, p)) return false;
+    present = (p != 0);
+    if (!present) return true;
+    int32_t hidden = 0;
+    int32_t expectedChannels = 0;
+    if (!lc0_read_i32(f, hidden) || !lc0_read_i32(f, expectedChannels)) return false;
+    if (hidden <= 0 || expectedChannels != channels) return false;
+    out.channels = channels;
+    out.hidden = hidden;
+    const int64_t c = channels;
+    return lc0_read_floats(f, out.w1, hidden * c) && lc0_read_floats(f, out.b1, hidden)
+            && lc0_read_floats(f, out.w2, 2 * c * hidden) && lc0_read_floats(f, out.b2, 2 * c);
+}
+
+// Parses `path` into `net`. Returns false on any I/O or format error; `net` is then unspecified.
+static bool lc0_read_net(const std::string& path, Lc0Net& net) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    char magic[4];
+    if (!lc0_read_bytes(f, magic, 4)) return false;
+    if (magic[0] != 'L' || magic[1] != 'C' || magic[2] != '0' || magic[3] != 'J') return false;
+    int32_t version = 0;
+    if (!lc0_read_i32(f, version) || version != 1) return false;
+
+    int32_t inputC, trunkC, blocks, policyC, valueC, valueHidden, policyMapLen, wdlOutputs;
+    if (!lc0_read_i32(f, inputC) || !lc0_read_i32(f, trunkC) || !lc0_read_i32(f, blocks) || !lc0_read_i32(f, policyC) ||
+        !lc0_read_i32(f, valueC) || !lc0_read_i32(f, valueHidden) || !lc0_read_i32(f, policyMapLen) || !lc0_read_i32(f, wdlOutputs)) {
+        return false;
+    }
+    if (wdlOutputs != 3) return false;
+    if (inputC <= 0 || trunkC <= 0 || blocks < 0 || policyMapLen < 0) return false;
+    net.inputC = inputC;
+    net.trunkC = trunkC;
+    net.blocks = blocks;
+    net.policyC = policyC;
+    net.valueC = valueC;
+    net.valueHidden = valueHidden;
+    net.policySize = policyMapLen;
+
+    if (!lc0_read_conv(f, net.input, inputC) || net.input.outC != trunkC) return false;
+    net.paramCount = net.input.params();
+
+    net.tower.resize(static_cast<size_t>(blocks));
+    for (Lc0Block& b : net.tower) {
+        if (!lc0_read_conv(f, b.conv1, trunkC)) return false;
+        if (!lc0_read_conv(f, b.conv2, b.conv1.outC) || b.conv2.outC != trunkC) return false;
+        if (!lc0_read_se(f, b.se, b.hasSe, trunkC)) return false;
+        net.paramCount += b.conv1.params() + b.conv2.params();
+        if (b.hasSe) {
+            net.paramCount += b.se.params();
+            net.seMaxHidden = std::max(net.seMaxHidden, b.se.hidden);
+        }
+    }
+
+    if (!lc0_read_conv(f, net.policyStem, trunkC)) return false;
+    if (!lc0_read_conv(f, net.policyOut, net.policyStem.outC) || net.policyOut.outC != policyC) return false;
+    if (!lc0_read_conv(f, net.valueConv, trunkC) || net.valueConv.outC != valueC) return false;
+    net.paramCount += net.policyStem.params() + net.policyOut.params() + net.valueConv.params();
+
+    if (!lc0_read_dense(f, net.valueFc1, valueC * 64, valueHidden)) return false;
+    if (!lc0_read_dense(f, net.valueFc2, valueHidden, 3)) return false;
+    net.paramCount += net.valueFc1.params() + net.valueFc2.params();
+
+    int32_t mapEntries = 0;
+    if (!lc0_read_i32(f, mapEntries) || mapEntries != policyMapLen) return false;
+    net.policyMap.resize(static_cast<size_t>(mapEntries));
+    if (!lc0_read_bytes(f, net.policyMap.data(), sizeof(int32_t) * net.policyMap.size())) return false;
+
+    // Trailing bytes are an error, as in the Java loader.
+    f.peek();
+    return f.eof();
+}
+
+} // namespace
+
+#endif // CRTK_LC0_CNN_LOADER_IMPL_INL
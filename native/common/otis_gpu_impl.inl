@@ -10,10 +10,36 @@
  * --------
  * This reproduces the OTIS i249-style forward pass implemented in Java
  * (src/chess/nn/otis/Model.java): square tokens -> typed tactical sheaf trunk ->
- * readout -> policy-head logits + WDL value. The board is reconstructed from the
- * encoded simple_18 input planes so the typed relation masks (attacks, defends,
- * rays, pins, ...) can be rebuilt on the host and uploaded; the tensor math runs
- * in device kernels.
+ * readout -> policy-head logits + WDL value. Only the encoded simple_18 input
+ * planes are uploaded: the first kernel reconstructs the board from them and
+ * derives the typed relation masks (attacks, defends, rays, pins, ...) as
+ * bit-packed rows with the perft_core.h attack primitives; the tensor math
+ * runs in the kernels that follow.
+ *
+ * Every kernel takes a batch of positions: scratch buffers are allocated once per handle for
+ * maxBatch positions laid out back to back (OTIS_MAX_BATCH_ENV, default 64), each kernel picks its
+ * position from blockIdx.y and offsets the OtisDev pointers with dev_position, and the side to move
+ * is read per position from input plane 12. A predict of N positions therefore costs the same
+ * launches as one; larger requests run in maxBatch-sized chunks.
+ *
+ * Launches run on a per-handle non-blocking stream. The kernel sequence only depends on fixed
+ * scratch pointers and the batch size, so it is captured into one graph per batch size on first
+ * use and replayed afterwards (gpu_graph_impl.inl; OTIS_GRAPHS_ENV=0 disables).
+ * Every stage runs block-wide (relation x square tiles for the sheaf transport, shared-memory
+ * tree reductions for the layer norms and the readout/WDL dot products), so no kernel walks the
+ * board from a single thread.
+ *
+ * Setting OTIS_STATS_ENV=1 (or the older OTIS_PROFILE_ENV=1) launches directly and brackets the
+ * upload, the five forward stages and the download with events (gpu_stats_impl.inl);
+ * nativeGetStats returns the totals and nativeGetInfo the mean time per forward stage.
+ *
+ * A handle is bound to the device ordinal it was created on (BT4_GPU_SET_DEVICE): the current
+ * device is per host thread, so every entry point that touches device memory selects it first.
+ * The pool entry points load one handle per listed device and spread predicts over them
+ * (replica_pool_impl.inl).
+ *
+ * The uploaded weights (OtisModel) are shared by every handle that opens the same file on the same
+ * device (weight_cache_impl.inl); a handle (OtisNet) owns only its scratch, stream and graphs.
  *
  * Faithfulness note
  * -----------------
@@ -26,19 +52,44 @@
  * JNI surface (names parameterized by OTIS_JNI_PREFIX):
  *   Support.nativeDeviceCount() -> int
  *   Backend.nativeCreate(String) -> long
+ *   Backend.nativeCreateOnDevice(String, int) -> long  (nativeCreate is device 0)
  *   Backend.nativeDestroy(long) -> void
- *   Backend.nativeGetInfo(long) -> long[5]
+ *   Backend.nativeGetInfo(long) -> long[14]
+ *     [inputPlanes, channels, blocks, policySize, paramCount, graphs, evalCount, meanEvalNanos,
+ *      mean stage nanos: embed, sheaf, finalize, readout, heads (0 unless stats are on), maxBatch]
  *   Backend.nativeGetName(long) -> String
+ *   Backend.nativeGetStatNames(long) -> String
+ *   Backend.nativeGetStats(long, boolean reset) -> long[1 + 4 * stages] (see gpu_stats_impl.inl)
  *   Backend.nativePredict(long, float[], float[], float[]) -> float
+ *   Backend.nativePredictBatch(long, float[], int, float[], float[], float[]) -> int
+ *     (count positions back to back; returns count, or 0 on failure)
+ *   Backend.nativePinnedBuffers(long) -> ByteBuffer[3] {input, policy, wdl}
+ *   Backend.nativePredictPinned(long, int) -> int
+ *     (pinned host buffers sized for maxBatch, see pinned_io_impl.inl; returns count, or 0)
+ *   Backend.nativePredictPacked(long, long[], int, float[], float[], float[]) -> int
+ *     (count packed positions of 19 longs, expanded on the device, see packed_planes_impl.inl)
+ *   Backend.nativeQueueCreate(long, int, long) -> long
+ *   Backend.nativeQueueSubmit(long, float[]) -> long
+ *   Backend.nativeQueueTake(long, float[], float[]) -> long
+ *   Backend.nativeQueueClose(long) / nativeQueueDestroy(long) -> void
+ *     (coalescing evaluation queue over one handle, see eval_queue_impl.inl)
+ *   Backend.nativePoolCreate(String, int[]) -> long / nativePoolDestroy(long) -> void
+ *   Backend.nativePoolGetName(long) -> String / nativePoolGetInfo(long) -> long[14]
+ *   Backend.nativePoolPredictBatch / nativePoolPredictPacked: as the single-handle forms
+ *   Backend.nativePoolStats(long) -> long[3 * replicas] {device, calls, positions}
+ *     (one replica per device ordinal, see replica_pool_impl.inl)
  */
 
 #include <jni.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -49,9 +100,24 @@
 
 // Kernel launch indirection so a host build can emulate kernels for testing.
 #ifndef OTIS_LAUNCH
-#define OTIS_LAUNCH(kernel, grid, block, ...) kernel<<<grid, block>>>(__VA_ARGS__)
+#define OTIS_LAUNCH(kernel, grid, block, stream, ...) kernel<<<grid, block, 0, stream>>>(__VA_ARGS__)
 #endif
 
+#include "gpu_graph_impl.inl"
+#include "gpu_stats_impl.inl"
+#include "eval_queue_impl.inl"
+#include "pinned_io_impl.inl"
+#include "packed_planes_impl.inl"
+#include "replica_pool_impl.inl"
+#include "weight_cache_impl.inl"
+
+// The relation masks need only a few slider queries per square, so this unit
+// uses the table-free hyperbola backend of the shared perft primitives.
+#ifndef PERFT_SLIDERS
+#define PERFT_SLIDERS PERFT_SLIDERS_HYPERBOLA
+#endif
+#include "perft_core.h"
+
 namespace {
 
 constexpr int OTIS_MAGIC = 0x5349544F;
@@ -72,6 +138,10 @@ constexpr int STALK_DIM = 8;
 constexpr int WDL_OUTPUTS = 3;
 constexpr int MAX_CHANNELS = 512;
 constexpr float SHEAF_ETA = 0.125f;
+constexpr int MAX_READOUT_DIM = MAX_CHANNELS * 4 + RELATION_COUNT * 4 + TRIAD_DIM + BOARD_STATS_DIM;
+constexpr int OTIS_READOUT_THREADS = 256;
+constexpr int OTIS_GEMV_THREADS = 128;
+constexpr int OTIS_DEFAULT_MAX_BATCH = 64;
 
 // Piece codes mirror chess.core.Piece (white positive, black negative).
 constexpr int P_EMPTY = 0;
@@ -87,6 +157,38 @@ __device__ __constant__ float DEV_RELATION_SIGNS[RELATION_COUNT] = {
     -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f
 };
 
+// Timed stages, in launch order (nativeGetStats order; EMBED..HEADS are nativeGetInfo's stage fields).
+enum OtisStage : int {
+    OTIS_STAGE_UPLOAD = 0,   // input planes or packed words, host to device
+    OTIS_STAGE_EXPAND = 1,   // packed words to planes
+    OTIS_STAGE_EMBED = 2,    // resets, relation masks, square tokens, salience
+    OTIS_STAGE_SHEAF = 3,    // all trunk blocks
+    OTIS_STAGE_FINALIZE = 4,
+    OTIS_STAGE_READOUT = 5,  // features + hidden layer
+    OTIS_STAGE_HEADS = 6,    // policy + WDL
+    OTIS_STAGE_DOWNLOAD = 7, // policy logits and WDL, device to host
+    OTIS_STAGES = 8
+};
+
+constexpr int OTIS_INFO_STAGES = OTIS_STAGE_HEADS - OTIS_STAGE_EMBED + 1;
+
+static const char* const OTIS_STAGE_NAMES[OTIS_STAGES] = {
+    "upload", "expand", "embed", "sheaf", "finalize", "readout", "heads", "download"
+};
+
+static bool otis_stats_from_env() {
+    return gpu_stats_from_env(OTIS_STATS_ENV) || gpu_stats_from_env(OTIS_PROFILE_ENV);
+}
+
+static int max_batch_from_env() {
+    const char* env = std::getenv(OTIS_MAX_BATCH_ENV);
+    if (!env || !*env) return OTIS_DEFAULT_MAX_BATCH;
+    long v = std::strtol(env, nullptr, 10);
+    if (v < 1) return 1;
+    if (v > 4096) return 4096;
+    return static_cast<int>(v);
+}
+
 static int readout_dim(int channels) {
     return channels * 4 + RELATION_COUNT * 4 + TRIAD_DIM + BOARD_STATS_DIM;
 }
@@ -99,8 +201,12 @@ static bool gpu_ok(decltype(BT4_GPU_LAST_ERROR()) err) {
 // Weight storage
 // ---------------------------------------------------------------------------
 
-struct OtisNet {
+// Immutable weights of one file on one device, shared by every handle that opens it (see
+// weight_cache_impl.inl). Kernels only read it, so handles on the same device can predict
+// concurrently.
+struct OtisModel {
     std::string name;
+    int device = 0;
     int inputPlanes = INPUT_PLANES;
     int channels = 0;
     int blocks = 0;
@@ -154,11 +260,19 @@ struct OtisNet {
     float* squareAtlas = nullptr;
     float* policyAtlas = nullptr;
     float* valueAtlas = nullptr;
+    crtk_perft::Tables* dTables = nullptr; // step and line-mask tables of the relation-mask kernel
+};
 
-    // Per-predict device scratch.
+struct OtisNet {
+    std::shared_ptr<const OtisModel> model;
+    int device = 0;
+
+    // Per-predict device scratch, each buffer holding maxBatch positions back to back.
+    int maxBatch = 1;
     float* dInput = nullptr;
+    unsigned long long* dPacked = nullptr; // [maxBatch][INPUT_PLANES + 1], null until first packed predict
     int* dBoard = nullptr;
-    float* dMasks = nullptr;
+    uint64_t* dMasks = nullptr;
     float* tokens = nullptr;
     float* tokTmp = nullptr;
     float* salience = nullptr;
@@ -176,12 +290,35 @@ struct OtisNet {
     float* dstPressure = nullptr;
     float* scalars = nullptr;
     float* trunk = nullptr;
+    float* features = nullptr;
     float* hidden = nullptr;
     float* policy = nullptr;
     float* wdlLogits = nullptr;
+
+    // Launch state: graphs[batch] replays the forward pass over `batch` positions captured on
+    // `stream`.
+    BT4_GPU_STREAM stream = nullptr;
+    std::vector<BT4_GPU_GRAPH_EXEC> graphs; // [maxBatch + 1], null until captured
+    bool useGraphs = true;
+    long long evalCount = 0;
+    long long evalNanos = 0;
+
+    // Pinned host buffers handed to Java as direct ByteBuffers; null until first requested.
+    float* hInput = nullptr;
+    float* hPolicy = nullptr;
+    float* hWdl = nullptr;
+
+    // Per-stage counters (OTIS_STATS_ENV); when enabled, forward passes launch directly.
+    GpuStats stats;
 };
 
-// Flat device-pointer bundle passed by value into kernels.
+// Makes the handle's device current on the calling thread.
+static bool bind_device(const OtisNet& net) {
+    return gpu_ok(BT4_GPU_SET_DEVICE(net.device));
+}
+
+// Flat device-pointer bundle passed by value into kernels. Scratch pointers address position 0
+// until a kernel rebases them with dev_position.
 struct OtisDev {
     int channels;
     int blocks;
@@ -235,8 +372,9 @@ struct OtisDev {
     const float* policyAtlas;
     const float* valueAtlas;
     const float* input;
-    const int* board;
-    const float* masks;
+    const crtk_perft::Tables* tables;
+    int* board;
+    uint64_t* masks;
     float* tokens;
     float* tokTmp;
     float* salience;
@@ -254,65 +392,68 @@ struct OtisDev {
     float* dstPressure;
     float* scalars;
     float* trunk;
+    float* features;
     float* hidden;
     float* policy;
     float* wdlLogits;
 };
 
 static OtisDev make_dev(const OtisNet& net) {
+    const OtisModel& model = *net.model;
     OtisDev d;
-    d.channels = net.channels;
-    d.blocks = net.blocks;
-    d.policySize = net.policySize;
-    d.readoutDim = readout_dim(net.channels);
-    d.whiteToMove = 0;
-    d.rawProjW = net.rawProjW;
-    d.rawProjB = net.rawProjB;
-    d.pieceProjW = net.pieceProjW;
-    d.pieceProjB = net.pieceProjB;
-    d.coordProjW = net.coordProjW;
-    d.coordProjB = net.coordProjB;
-    d.fuseInW = net.fuseInW;
-    d.fuseInB = net.fuseInB;
-    d.fuseNormW = net.fuseNormW;
-    d.fuseNormB = net.fuseNormB;
-    d.fuseOutW = net.fuseOutW;
-    d.fuseOutB = net.fuseOutB;
-    d.encNormW = net.encNormW;
-    d.encNormB = net.encNormB;
-    d.rhoSrc = net.rhoSrc;
-    d.rhoDst = net.rhoDst;
-    d.relGate = net.relGate;
-    d.etaLogits = net.etaLogits;
-    d.n2sW = net.n2sW;
-    d.n2sB = net.n2sB;
-    d.s2nW = net.s2nW;
-    d.s2nB = net.s2nB;
-    d.mlpNormW = net.mlpNormW;
-    d.mlpNormB = net.mlpNormB;
-    d.mlpUpW = net.mlpUpW;
-    d.mlpUpB = net.mlpUpB;
-    d.mlpDownW = net.mlpDownW;
-    d.mlpDownB = net.mlpDownB;
-    d.blockNormW = net.blockNormW;
-    d.blockNormB = net.blockNormB;
-    d.triadAW = net.triadAW;
-    d.triadTW = net.triadTW;
-    d.triadDW = net.triadDW;
-    d.triadNormW = net.triadNormW;
-    d.triadNormB = net.triadNormB;
-    d.readNormW = net.readNormW;
-    d.readNormB = net.readNormB;
-    d.readHidW = net.readHidW;
-    d.readHidB = net.readHidB;
-    d.policyW = net.policyW;
-    d.policyB = net.policyB;
-    d.wdlW = net.wdlW;
-    d.wdlB = net.wdlB;
-    d.squareAtlas = net.squareAtlas;
-    d.policyAtlas = net.policyAtlas;
-    d.valueAtlas = net.valueAtlas;
+    d.channels = model.channels;
+    d.blocks = model.blocks;
+    d.policySize = model.policySize;
+    d.readoutDim = readout_dim(model.channels);
+    d.whiteToMove = 0; // set per position by dev_position
+    d.rawProjW = model.rawProjW;
+    d.rawProjB = model.rawProjB;
+    d.pieceProjW = model.pieceProjW;
+    d.pieceProjB = model.pieceProjB;
+    d.coordProjW = model.coordProjW;
+    d.coordProjB = model.coordProjB;
+    d.fuseInW = model.fuseInW;
+    d.fuseInB = model.fuseInB;
+    d.fuseNormW = model.fuseNormW;
+    d.fuseNormB = model.fuseNormB;
+    d.fuseOutW = model.fuseOutW;
+    d.fuseOutB = model.fuseOutB;
+    d.encNormW = model.encNormW;
+    d.encNormB = model.encNormB;
+    d.rhoSrc = model.rhoSrc;
+    d.rhoDst = model.rhoDst;
+    d.relGate = model.relGate;
+    d.etaLogits = model.etaLogits;
+    d.n2sW = model.n2sW;
+    d.n2sB = model.n2sB;
+    d.s2nW = model.s2nW;
+    d.s2nB = model.s2nB;
+    d.mlpNormW = model.mlpNormW;
+    d.mlpNormB = model.mlpNormB;
+    d.mlpUpW = model.mlpUpW;
+    d.mlpUpB = model.mlpUpB;
+    d.mlpDownW = model.mlpDownW;
+    d.mlpDownB = model.mlpDownB;
+    d.blockNormW = model.blockNormW;
+    d.blockNormB = model.blockNormB;
+    d.triadAW = model.triadAW;
+    d.triadTW = model.triadTW;
+    d.triadDW = model.triadDW;
+    d.triadNormW = model.triadNormW;
+    d.triadNormB = model.triadNormB;
+    d.readNormW = model.readNormW;
+    d.readNormB = model.readNormB;
+    d.readHidW = model.readHidW;
+    d.readHidB = model.readHidB;
+    d.policyW = model.policyW;
+    d.policyB = model.policyB;
+    d.wdlW = model.wdlW;
+    d.wdlB = model.wdlB;
+    d.squareAtlas = model.squareAtlas;
+    d.policyAtlas = model.policyAtlas;
+    d.valueAtlas = model.valueAtlas;
     d.input = net.dInput;
+    d.tables = model.dTables;
     d.board = net.dBoard;
     d.masks = net.dMasks;
     d.tokens = net.tokens;
@@ -332,6 +473,7 @@ static OtisDev make_dev(const OtisNet& net) {
     d.dstPressure = net.dstPressure;
     d.scalars = net.scalars;
     d.trunk = net.trunk;
+    d.features = net.features;
     d.hidden = net.hidden;
     d.policy = net.policy;
     d.wdlLogits = net.wdlLogits;
@@ -406,45 +548,79 @@ static bool upload(const std::vector<float>& host, float** device, long long& pa
     return gpu_ok(BT4_GPU_MEMCPY(*device, host.data(), bytes, BT4_GPU_MEMCPY_H2D));
 }
 
+// Frees every buffer of `model` and the model itself; the caller has made its device current.
+static void free_model_buffers(OtisModel* model) {
+    float* buffers[] = {
+        model->rawProjW, model->rawProjB, model->pieceProjW, model->pieceProjB, model->coordProjW, model->coordProjB,
+        model->fuseInW, model->fuseInB, model->fuseNormW, model->fuseNormB, model->fuseOutW, model->fuseOutB,
+        model->encNormW, model->encNormB, model->rhoSrc, model->rhoDst, model->relGate, model->etaLogits,
+        model->n2sW, model->n2sB, model->s2nW, model->s2nB, model->mlpNormW, model->mlpNormB,
+        model->mlpUpW, model->mlpUpB, model->mlpDownW, model->mlpDownB, model->blockNormW, model->blockNormB,
+        model->triadAW, model->triadTW, model->triadDW, model->triadNormW, model->triadNormB,
+        model->readNormW, model->readNormB, model->readHidW, model->readHidB, model->policyW, model->policyB,
+        model->wdlW, model->wdlB, model->squareAtlas, model->policyAtlas, model->valueAtlas
+    };
+    for (float* p : buffers) {
+        if (p) BT4_GPU_FREE(p);
+    }
+    if (model->dTables) BT4_GPU_FREE(model->dTables);
+    delete model;
+}
+
+// Releases `model` on the device it was uploaded to, then restores the calling thread's
+// current device so a handle destroyed from a Java thread does not rebind that thread.
+static void free_model(OtisModel* model) {
+    if (!model) return;
+    int previous = 0;
+    const bool restore = gpu_ok(BT4_GPU_GET_DEVICE(&previous));
+    (void) gpu_ok(BT4_GPU_SET_DEVICE(model->device));
+    free_model_buffers(model);
+    if (restore) (void) gpu_ok(BT4_GPU_SET_DEVICE(previous));
+}
+
+// Frees the handle's scratch and launch state; the model goes when its last handle does.
 static void free_net(OtisNet* net) {
     if (!net) return;
+    (void) bind_device(*net);
     float* buffers[] = {
-        net->rawProjW, net->rawProjB, net->pieceProjW, net->pieceProjB, net->coordProjW, net->coordProjB,
-        net->fuseInW, net->fuseInB, net->fuseNormW, net->fuseNormB, net->fuseOutW, net->fuseOutB,
-        net->encNormW, net->encNormB, net->rhoSrc, net->rhoDst, net->relGate, net->etaLogits,
-        net->n2sW, net->n2sB, net->s2nW, net->s2nB, net->mlpNormW, net->mlpNormB,
-        net->mlpUpW, net->mlpUpB, net->mlpDownW, net->mlpDownB, net->blockNormW, net->blockNormB,
-        net->triadAW, net->triadTW, net->triadDW, net->triadNormW, net->triadNormB,
-        net->readNormW, net->readNormB, net->readHidW, net->readHidB, net->policyW, net->policyB,
-        net->wdlW, net->wdlB, net->squareAtlas, net->policyAtlas, net->valueAtlas,
-        net->dInput, net->dMasks, net->tokens, net->tokTmp, net->salience, net->h, net->stalks,
+        net->dInput, net->tokens, net->tokTmp, net->salience, net->h, net->stalks,
         net->stalkDelta, net->update, net->degree, net->node, net->laplacian, net->energy, net->gates,
-        net->density, net->srcPressure, net->dstPressure, net->scalars, net->trunk, net->hidden,
+        net->density, net->srcPressure, net->dstPressure, net->scalars, net->trunk, net->features, net->hidden,
         net->policy, net->wdlLogits
     };
     for (float* p : buffers) {
         if (p) BT4_GPU_FREE(p);
     }
     if (net->dBoard) BT4_GPU_FREE(net->dBoard);
+    if (net->dPacked) BT4_GPU_FREE(net->dPacked);
+    if (net->dMasks) BT4_GPU_FREE(net->dMasks);
+    if (net->hInput) BT4_GPU_HOST_FREE(net->hInput);
+    if (net->hPolicy) BT4_GPU_HOST_FREE(net->hPolicy);
+    if (net->hWdl) BT4_GPU_HOST_FREE(net->hWdl);
+    for (BT4_GPU_GRAPH_EXEC exec : net->graphs) {
+        if (exec) BT4_GPU_GRAPH_EXEC_DESTROY(exec);
+    }
+    if (net->stream) BT4_GPU_STREAM_DESTROY(net->stream);
     delete net;
 }
 
 static bool alloc_scratch(OtisNet& net) {
-    int c = net.channels;
-    auto allocf = [](float** ptr, size_t count) -> bool {
-        return gpu_ok(BT4_GPU_MALLOC(ptr, count * sizeof(float)));
+    const OtisModel& model = *net.model;
+    int c = model.channels;
+    const size_t b = static_cast<size_t>(net.maxBatch);
+    auto allocf = [b](float** ptr, size_t count) -> bool {
+        return gpu_ok(BT4_GPU_MALLOC(ptr, b * count * sizeof(float)));
     };
     bool ok =
         allocf(&net.dInput, static_cast<size_t>(INPUT_PLANES) * SQUARES)
-        && allocf(&net.dMasks, static_cast<size_t>(RELATION_COUNT) * SQUARES * SQUARES)
         && allocf(&net.tokens, static_cast<size_t>(SQUARES) * c)
         && allocf(&net.tokTmp, static_cast<size_t>(SQUARES) * c)
         && allocf(&net.salience, SQUARES)
         && allocf(&net.h, static_cast<size_t>(SQUARES) * c)
         && allocf(&net.stalks, static_cast<size_t>(SQUARES) * STALK_DIM)
         && allocf(&net.stalkDelta, static_cast<size_t>(SQUARES) * STALK_DIM)
-        && allocf(&net.update, static_cast<size_t>(SQUARES) * STALK_DIM)
-        && allocf(&net.degree, SQUARES)
+        && allocf(&net.update, static_cast<size_t>(RELATION_COUNT) * SQUARES * STALK_DIM)
+        && allocf(&net.degree, static_cast<size_t>(RELATION_COUNT) * SQUARES)
         && allocf(&net.node, SQUARES)
         && allocf(&net.laplacian, SQUARES)
         && allocf(&net.energy, RELATION_COUNT)
@@ -454,385 +630,307 @@ static bool alloc_scratch(OtisNet& net) {
         && allocf(&net.dstPressure, static_cast<size_t>(RELATION_COUNT) * SQUARES)
         && allocf(&net.scalars, 4)
         && allocf(&net.trunk, static_cast<size_t>(c) * SQUARES)
+        && allocf(&net.features, static_cast<size_t>(readout_dim(c)))
         && allocf(&net.hidden, HIDDEN_DIM)
-        && allocf(&net.policy, static_cast<size_t>(net.policySize))
+        && allocf(&net.policy, static_cast<size_t>(model.policySize))
         && allocf(&net.wdlLogits, WDL_OUTPUTS);
     if (!ok) return false;
-    return gpu_ok(BT4_GPU_MALLOC(&net.dBoard, static_cast<size_t>(SQUARES) * sizeof(int)));
+    if (!gpu_ok(BT4_GPU_MALLOC(&net.dBoard, b * SQUARES * sizeof(int)))) return false;
+    return gpu_ok(BT4_GPU_MALLOC(&net.dMasks, b * RELATION_COUNT * SQUARES * sizeof(uint64_t)));
 }
 
-static OtisNet* load_net(const std::string& path) {
-    auto* net = new OtisNet();
+static OtisModel* load_model(const std::string& path, int device) {
+    auto* model = new OtisModel();
+    model->device = device;
     try {
         Reader in(path);
         if (in.i32() != OTIS_MAGIC) throw std::runtime_error("bad magic");
         if (in.i32() != OTIS_VERSION) throw std::runtime_error("bad version");
-        net->name = in.str();
-        net->inputPlanes = in.i32();
-        net->channels = in.i32();
-        net->blocks = in.i32();
-        net->policySize = in.i32();
-        if (net->inputPlanes != INPUT_PLANES || net->channels <= 0 || net->channels > MAX_CHANNELS
-                || net->blocks <= 0 || net->policySize <= 0) {
+        model->name = in.str();
+        model->inputPlanes = in.i32();
+        model->channels = in.i32();
+        model->blocks = in.i32();
+        model->policySize = in.i32();
+        if (model->inputPlanes != INPUT_PLANES || model->channels <= 0 || model->channels > MAX_CHANNELS
+                || model->blocks <= 0 || model->policySize <= 0) {
             throw std::runtime_error("unsupported OTIS shape");
         }
-        int c = net->channels;
-        int blocks = net->blocks;
+        int c = model->channels;
+        int blocks = model->blocks;
         int rd = readout_dim(c);
         long long params = 0;
         bool ok =
-            upload(in.floats(RAW_DIM * INPUT_PLANES), &net->rawProjW, params)
-            && upload(in.floats(RAW_DIM), &net->rawProjB, params)
-            && upload(in.floats(PIECE_DIM * PIECE_STATE_PLANES), &net->pieceProjW, params)
-            && upload(in.floats(PIECE_DIM), &net->pieceProjB, params)
-            && upload(in.floats(COORD_DIM * COORD_IN), &net->coordProjW, params)
-            && upload(in.floats(COORD_DIM), &net->coordProjB, params)
-            && upload(in.floats(c * FUSE_DIM), &net->fuseInW, params)
-            && upload(in.floats(c), &net->fuseInB, params)
-            && upload(in.floats(c), &net->fuseNormW, params)
-            && upload(in.floats(c), &net->fuseNormB, params)
-            && upload(in.floats(c * c), &net->fuseOutW, params)
-            && upload(in.floats(c), &net->fuseOutB, params)
-            && upload(in.floats(c), &net->encNormW, params)
-            && upload(in.floats(c), &net->encNormB, params)
-            && upload(in.floats(blocks * RELATION_COUNT * STALK_DIM * STALK_DIM), &net->rhoSrc, params)
-            && upload(in.floats(blocks * RELATION_COUNT * STALK_DIM * STALK_DIM), &net->rhoDst, params)
-            && upload(in.floats(blocks * RELATION_COUNT), &net->relGate, params)
-            && upload(in.floats(blocks), &net->etaLogits, params)
-            && upload(in.floats(blocks * STALK_DIM * c), &net->n2sW, params)
-            && upload(in.floats(blocks * STALK_DIM), &net->n2sB, params)
-            && upload(in.floats(blocks * c * STALK_DIM), &net->s2nW, params)
-            && upload(in.floats(blocks * c), &net->s2nB, params)
-            && upload(in.floats(blocks * c), &net->mlpNormW, params)
-            && upload(in.floats(blocks * c), &net->mlpNormB, params)
-            && upload(in.floats(blocks * c * (c * 2)), &net->mlpUpW, params)
-            && upload(in.floats(blocks * (c * 2)), &net->mlpUpB, params)
-            && upload(in.floats(blocks * (c * 2) * c), &net->mlpDownW, params)
-            && upload(in.floats(blocks * c), &net->mlpDownB, params)
-            && upload(in.floats(blocks * c), &net->blockNormW, params)
-            && upload(in.floats(blocks * c), &net->blockNormB, params)
-            && upload(in.floats(c * c), &net->triadAW, params)
-            && upload(in.floats(c * c), &net->triadTW, params)
-            && upload(in.floats(c * c), &net->triadDW, params)
-            && upload(in.floats(TRIAD_DIM), &net->triadNormW, params)
-            && upload(in.floats(TRIAD_DIM), &net->triadNormB, params)
-            && upload(in.floats(rd), &net->readNormW, params)
-            && upload(in.floats(rd), &net->readNormB, params)
-            && upload(in.floats(HIDDEN_DIM * rd), &net->readHidW, params)
-            && upload(in.floats(HIDDEN_DIM), &net->readHidB, params)
-            && upload(in.floats(net->policySize * HIDDEN_DIM), &net->policyW, params)
-            && upload(in.floats(net->policySize), &net->policyB, params)
-            && upload(in.floats(WDL_OUTPUTS * HIDDEN_DIM), &net->wdlW, params)
-            && upload(in.floats(WDL_OUTPUTS), &net->wdlB, params)
-            && upload(in.floats(SQUARES), &net->squareAtlas, params)
-            && upload(in.floats(SQUARES), &net->policyAtlas, params)
-            && upload(in.floats(SQUARES), &net->valueAtlas, params);
+            upload(in.floats(RAW_DIM * INPUT_PLANES), &model->rawProjW, params)
+            && upload(in.floats(RAW_DIM), &model->rawProjB, params)
+            && upload(in.floats(PIECE_DIM * PIECE_STATE_PLANES), &model->pieceProjW, params)
+            && upload(in.floats(PIECE_DIM), &model->pieceProjB, params)
+            && upload(in.floats(COORD_DIM * COORD_IN), &model->coordProjW, params)
+            && upload(in.floats(COORD_DIM), &model->coordProjB, params)
+            && upload(in.floats(c * FUSE_DIM), &model->fuseInW, params)
+            && upload(in.floats(c), &model->fuseInB, params)
+            && upload(in.floats(c), &model->fuseNormW, params)
+            && upload(in.floats(c), &model->fuseNormB, params)
+            && upload(in.floats(c * c), &model->fuseOutW, params)
+            && upload(in.floats(c), &model->fuseOutB, params)
+            && upload(in.floats(c), &model->encNormW, params)
+            && upload(in.floats(c), &model->encNormB, params)
+            && upload(in.floats(blocks * RELATION_COUNT * STALK_DIM * STALK_DIM), &model->rhoSrc, params)
+            && upload(in.floats(blocks * RELATION_COUNT * STALK_DIM * STALK_DIM), &model->rhoDst, params)
+            && upload(in.floats(blocks * RELATION_COUNT), &model->relGate, params)
+            && upload(in.floats(blocks), &model->etaLogits, params)
+            && upload(in.floats(blocks * STALK_DIM * c), &model->n2sW, params)
+            && upload(in.floats(blocks * STALK_DIM), &model->n2sB, params)
+            && upload(in.floats(blocks * c * STALK_DIM), &model->s2nW, params)
+            && upload(in.floats(blocks * c), &model->s2nB, params)
+            && upload(in.floats(blocks * c), &model->mlpNormW, params)
+            && upload(in.floats(blocks * c), &model->mlpNormB, params)
+            && upload(in.floats(blocks * c * (c * 2)), &model->mlpUpW, params)
+            && upload(in.floats(blocks * (c * 2)), &model->mlpUpB, params)
+            && upload(in.floats(blocks * (c * 2) * c), &model->mlpDownW, params)
+            && upload(in.floats(blocks * c), &model->mlpDownB, params)
+            && upload(in.floats(blocks * c), &model->blockNormW, params)
+            && upload(in.floats(blocks * c), &model->blockNormB, params)
+            && upload(in.floats(c * c), &model->triadAW, params)
+            && upload(in.floats(c * c), &model->triadTW, params)
+            && upload(in.floats(c * c), &model->triadDW, params)
+            && upload(in.floats(TRIAD_DIM), &model->triadNormW, params)
+            && upload(in.floats(TRIAD_DIM), &model->triadNormB, params)
+            && upload(in.floats(rd), &model->readNormW, params)
+            && upload(in.floats(rd), &model->readNormB, params)
+            && upload(in.floats(HIDDEN_DIM * rd), &model->readHidW, params)
+            && upload(in.floats(HIDDEN_DIM), &model->readHidB, params)
+            && upload(in.floats(model->policySize * HIDDEN_DIM), &model->policyW, params)
+            && upload(in.floats(model->policySize), &model->policyB, params)
+            && upload(in.floats(WDL_OUTPUTS * HIDDEN_DIM), &model->wdlW, params)
+            && upload(in.floats(WDL_OUTPUTS), &model->wdlB, params)
+            && upload(in.floats(SQUARES), &model->squareAtlas, params)
+            && upload(in.floats(SQUARES), &model->policyAtlas, params)
+            && upload(in.floats(SQUARES), &model->valueAtlas, params);
         if (!ok) throw std::runtime_error("upload failed");
         if (!in.done()) throw std::runtime_error("trailing bytes");
-        net->parameterCount = params;
-        if (!alloc_scratch(*net)) throw std::runtime_error("scratch alloc failed");
-        return net;
+        model->parameterCount = params;
+        // Step and line-mask tables for the relation-mask kernel (a few KB; the
+        // hyperbola slider backend needs no attack array).
+        crtk_perft::Tables tables;
+        crtk_perft::build_tables(tables);
+        if (!gpu_ok(BT4_GPU_MALLOC(&model->dTables, sizeof(tables)))
+                || !gpu_ok(BT4_GPU_MEMCPY(model->dTables, &tables, sizeof(tables), BT4_GPU_MEMCPY_H2D))) {
+            throw std::runtime_error("table upload failed");
+        }
+        return model;
     } catch (...) {
-        free_net(net);
+        free_model(model);
         return nullptr;
     }
 }
 
 // ---------------------------------------------------------------------------
-// Host-side board reconstruction and typed relation masks (mirror Model.java)
+// Device math helpers
 // ---------------------------------------------------------------------------
 
-static int piece_from_planes(const std::vector<float>& input, int sq) {
-    for (int plane = 0; plane < 12; ++plane) {
-        if (input[static_cast<size_t>(plane) * SQUARES + sq] > 0.5f) {
-            int type = plane % 6 + 1;
-            return plane < 6 ? type : -type;
-        }
-    }
-    return P_EMPTY;
-}
-
-static bool is_white(int piece) {
-    return piece > 0;
-}
-
-static bool is_own(int piece, bool whiteToMove) {
-    return piece != P_EMPTY && is_white(piece) == whiteToMove;
-}
-
-static int square_of(int rank, int file) {
-    return rank >= 0 && rank < 8 && file >= 0 && file < 8 ? (rank << 3) + file : -1;
-}
-
-__host__ __device__ static inline int mask_index(int relation, int from, int to) {
-    return (relation * SQUARES + from) * SQUARES + to;
+__device__ __forceinline__ float dev_gelu(float x) {
+    return 0.5f * x * (1.0f + tanhf(0.7978845608028654f * (x + 0.044715f * x * x * x)));
 }
 
-static void set_relation(std::vector<float>& masks, int relation, int from, int to) {
-    if (from != to && from >= 0 && from < SQUARES && to >= 0 && to < SQUARES) {
-        masks[static_cast<size_t>(mask_index(relation, from, to))] = 1.0f;
-    }
+__device__ __forceinline__ float dev_sigmoid(float x) {
+    return 1.0f / (1.0f + expf(-x));
 }
 
-static int find_king(const int* board, bool white) {
-    int target = white ? P_KING : -P_KING;
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        if (board[sq] == target) return sq;
+__device__ void dev_layernorm(float* values, const float* scale, int scaleOff,
+        const float* bias, int biasOff, int length) {
+    float mean = 0.0f;
+    for (int i = 0; i < length; ++i) mean += values[i];
+    mean /= static_cast<float>(length);
+    float variance = 0.0f;
+    for (int i = 0; i < length; ++i) {
+        float centered = values[i] - mean;
+        variance += centered * centered;
     }
-    return -1;
-}
-
-static void king_zone(int kingSquare, bool* out) {
-    for (int sq = 0; sq < SQUARES; ++sq) out[sq] = false;
-    if (kingSquare < 0) return;
-    int kr = kingSquare >> 3;
-    int kf = kingSquare & 7;
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        int r = sq >> 3;
-        int f = sq & 7;
-        out[sq] = sq != kingSquare && std::max(std::abs(r - kr), std::abs(f - kf)) <= 2;
+    float invStd = rsqrtf(variance / static_cast<float>(length) + 1.0e-5f);
+    for (int i = 0; i < length; ++i) {
+        values[i] = (values[i] - mean) * invStd * scale[scaleOff + i] + bias[biasOff + i];
     }
 }
 
-static void ray_directions(bool diagonals, bool orthogonals, int dirs[8][2], int& count) {
-    count = 0;
-    if (diagonals && orthogonals) {
-        const int d[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
-        for (int i = 0; i < 8; ++i) { dirs[i][0] = d[i][0]; dirs[i][1] = d[i][1]; }
-        count = 8;
-    } else if (diagonals) {
-        const int d[4][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
-        for (int i = 0; i < 4; ++i) { dirs[i][0] = d[i][0]; dirs[i][1] = d[i][1]; }
-        count = 4;
-    } else {
-        const int d[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
-        for (int i = 0; i < 4; ++i) { dirs[i][0] = d[i][0]; dirs[i][1] = d[i][1]; }
-        count = 4;
-    }
+// Rebases the scratch pointers of `p` onto position `pos` of the batch and reads its side to move
+// from input plane 12. Every forward kernel starts with p = dev_position(p, blockIdx.y).
+__device__ static OtisDev dev_position(OtisDev p, int pos) {
+    const size_t b = static_cast<size_t>(pos);
+    const size_t c = static_cast<size_t>(p.channels);
+    p.input += b * INPUT_PLANES * SQUARES;
+    p.whiteToMove = p.input[12 * SQUARES] > 0.5f ? 1 : 0;
+    p.board += b * SQUARES;
+    p.masks += b * RELATION_COUNT * SQUARES;
+    p.tokens += b * SQUARES * c;
+    p.tokTmp += b * SQUARES * c;
+    p.salience += b * SQUARES;
+    p.h += b * SQUARES * c;
+    p.stalks += b * SQUARES * STALK_DIM;
+    p.stalkDelta += b * SQUARES * STALK_DIM;
+    p.update += b * RELATION_COUNT * SQUARES * STALK_DIM;
+    p.degree += b * RELATION_COUNT * SQUARES;
+    p.node += b * SQUARES;
+    p.laplacian += b * SQUARES;
+    p.energy += b * RELATION_COUNT;
+    p.gates += b * RELATION_COUNT;
+    p.density += b * RELATION_COUNT;
+    p.srcPressure += b * RELATION_COUNT * SQUARES;
+    p.dstPressure += b * RELATION_COUNT * SQUARES;
+    p.scalars += b * 4;
+    p.trunk += b * SQUARES * c;
+    p.features += b * static_cast<size_t>(p.readoutDim);
+    p.hidden += b * HIDDEN_DIM;
+    p.policy += b * static_cast<size_t>(p.policySize);
+    p.wdlLogits += b * WDL_OUTPUTS;
+    return p;
 }
 
-static bool slider_matches(int piece, int dr, int df) {
-    int type = std::abs(piece);
-    bool diagonal = dr != 0 && df != 0;
-    return type == P_QUEEN || (diagonal && type == P_BISHOP) || (!diagonal && type == P_ROOK);
-}
+// ---------------------------------------------------------------------------
+// Device board reconstruction and typed relation masks (mirror Model.java)
+// ---------------------------------------------------------------------------
+//
+// Row (relation, from) of p.masks is a bitboard of the `to` squares that
+// relation links to `from`. OTIS squares use the perft_core order (a8 = 0,
+// White advancing toward lower indices), so the perft attack tables and
+// slider primitives apply to the decoded board unchanged.
 
-static void add_tactical_edge(std::vector<float>& masks, const int* board, bool own,
-        const bool* nearOwnKing, const bool* nearThemKing, int from, int to) {
-    int target = board[to];
-    if (own) {
-        if (target == P_EMPTY) {
-            if (nearThemKing[to]) set_relation(masks, 4, from, to);
-        } else if (is_white(target) == is_white(board[from])) {
-            set_relation(masks, 2, from, to);
-        } else {
-            set_relation(masks, 0, from, to);
-        }
-    } else {
-        if (target == P_EMPTY) {
-            if (nearOwnKing[to]) set_relation(masks, 5, from, to);
-        } else if (is_white(target) == is_white(board[from])) {
-            set_relation(masks, 3, from, to);
-        } else {
-            set_relation(masks, 1, from, to);
+__device__ static int dev_piece_from_planes(const float* input, int sq) {
+    for (int plane = 0; plane < 12; ++plane) {
+        if (input[plane * SQUARES + sq] > 0.5f) {
+            int type = plane % 6 + 1;
+            return plane < 6 ? type : -type;
         }
     }
+    return P_EMPTY;
 }
 
-static void add_step_relations(std::vector<float>& masks, const int* board, const bool* nearOwnKing,
-        const bool* nearThemKing, int from, bool own, const int deltas[][2], int deltaCount,
-        bool knight, bool pawn) {
-    int rank = from >> 3;
-    int file = from & 7;
-    for (int i = 0; i < deltaCount; ++i) {
-        int to = square_of(rank + deltas[i][0], file + deltas[i][1]);
-        if (to < 0) continue;
-        add_tactical_edge(masks, board, own, nearOwnKing, nearThemKing, from, to);
-        if (knight) set_relation(masks, 9, from, to);
-        if (pawn) set_relation(masks, 10, from, to);
-    }
-}
-
-static void add_ray_relations(std::vector<float>& masks, const int* board, const bool* nearOwnKing,
-        const bool* nearThemKing, int from, bool own, bool diagonals, bool orthogonals) {
-    int dirs[8][2];
-    int count = 0;
-    ray_directions(diagonals, orthogonals, dirs, count);
-    int rank = from >> 3;
-    int file = from & 7;
-    for (int i = 0; i < count; ++i) {
-        int r = rank + dirs[i][0];
-        int f = file + dirs[i][1];
-        while (true) {
-            int to = square_of(r, f);
-            if (to < 0) break;
-            add_tactical_edge(masks, board, own, nearOwnKing, nearThemKing, from, to);
-            if (board[to] != P_EMPTY) break;
-            r += dirs[i][0];
-            f += dirs[i][1];
-        }
+// Squares within Chebyshev distance 2 of the king, excluding the king itself.
+__device__ static uint64_t dev_king_zone(const crtk_perft::Tables& t, int king) {
+    if (king < 0) return 0;
+    uint64_t ring = t.king[king];
+    uint64_t zone = ring;
+    while (ring) {
+        int sq = crtk_perft::ctz64(ring);
+        ring &= ring - 1;
+        zone |= t.king[sq];
     }
+    return zone & ~(1ULL << king);
 }
 
-static void add_pawn_relations(std::vector<float>& masks, const int* board, const bool* nearOwnKing,
-        const bool* nearThemKing, int from, int piece, bool own) {
-    // Forward advance DECREASES the internal rank for White (rank 0 = the 8th
-    // rank), matching Model.java addPawnRelations for CPU/GPU parity.
-    int direction = is_white(piece) ? -1 : 1;
-    int rank = from >> 3;
-    int file = from & 7;
-    const int offsets[2] = {-1, 1};
-    for (int o = 0; o < 2; ++o) {
-        int to = square_of(rank + direction, file + offsets[o]);
-        if (to >= 0) {
-            add_tactical_edge(masks, board, own, nearOwnKing, nearThemKing, from, to);
-            set_relation(masks, 10, from, to);
+// One block of SQUARES threads, one per from-square. Decodes p.board from the
+// input planes, then writes every relation row of its square.
+__global__ void k_relation_masks(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
+    __shared__ int board[SQUARES];
+    __shared__ uint64_t colour[2]; // white, black occupancy
+    __shared__ int kings[2];       // first white / black king square, -1 if none
+    int from = threadIdx.x;
+    int piece = dev_piece_from_planes(p.input, from);
+    board[from] = piece;
+    p.board[from] = piece;
+    __syncthreads();
+    if (from == 0) {
+        uint64_t white = 0;
+        uint64_t black = 0;
+        kings[0] = -1;
+        kings[1] = -1;
+        for (int sq = 0; sq < SQUARES; ++sq) {
+            int code = board[sq];
+            if (code > 0) white |= 1ULL << sq;
+            if (code < 0) black |= 1ULL << sq;
+            if (code == P_KING && kings[0] < 0) kings[0] = sq;
+            if (code == -P_KING && kings[1] < 0) kings[1] = sq;
         }
+        colour[0] = white;
+        colour[1] = black;
     }
-}
-
-static void add_visible_ray_mask(std::vector<float>& masks, const int* board, int from, int relation,
-        bool diagonals, bool orthogonals) {
-    int dirs[8][2];
-    int count = 0;
-    ray_directions(diagonals, orthogonals, dirs, count);
-    int rank = from >> 3;
-    int file = from & 7;
-    for (int i = 0; i < count; ++i) {
-        int r = rank + dirs[i][0];
-        int f = file + dirs[i][1];
-        while (true) {
-            int to = square_of(r, f);
-            if (to < 0) break;
-            set_relation(masks, relation, from, to);
-            if (board[to] != P_EMPTY) break;
-            r += dirs[i][0];
-            f += dirs[i][1];
+    __syncthreads();
+
+    uint64_t rows[RELATION_COUNT];
+    for (int r = 0; r < RELATION_COUNT; ++r) rows[r] = 0;
+    if (piece != P_EMPTY) {
+        const crtk_perft::Tables& t = *p.tables;
+        bool white = piece > 0;
+        int type = white ? piece : -piece;
+        uint64_t same = colour[white ? 0 : 1];
+        uint64_t enemy = colour[white ? 1 : 0];
+        uint64_t occ = same | enemy;
+        uint64_t diag = type == P_BISHOP || type == P_QUEEN ? crtk_perft::bishop_attacks(t, from, occ) : 0;
+        uint64_t orth = type == P_ROOK || type == P_QUEEN ? crtk_perft::rook_attacks(t, from, occ) : 0;
+        uint64_t reach = diag | orth;
+        if (type == P_PAWN) {
+            reach = white ? t.wPawn[from] : t.bPawn[from];
+            rows[10] = reach;
+        } else if (type == P_KNIGHT) {
+            reach = t.knight[from];
+            rows[9] = reach;
+        } else if (type == P_KING) {
+            reach = t.king[from];
         }
-    }
-}
-
-static void add_slider_relation_masks(std::vector<float>& masks, const int* board, int from, int piece) {
-    int type = std::abs(piece);
-    if (type == P_BISHOP || type == P_QUEEN) {
-        add_visible_ray_mask(masks, board, from, type == P_BISHOP ? 6 : 8, true, false);
-    }
-    if (type == P_ROOK || type == P_QUEEN) {
-        add_visible_ray_mask(masks, board, from, type == P_ROOK ? 7 : 8, false, true);
-    }
-}
-
-static void add_pin_relations(std::vector<float>& masks, const int* board, bool whiteKing) {
-    int king = find_king(board, whiteKing);
-    if (king < 0) return;
-    int rank = king >> 3;
-    int file = king & 7;
-    int dirs[8][2];
-    int count = 0;
-    ray_directions(true, true, dirs, count);
-    for (int i = 0; i < count; ++i) {
-        int blocker = -1;
-        int r = rank + dirs[i][0];
-        int f = file + dirs[i][1];
-        while (true) {
-            int sq = square_of(r, f);
-            if (sq < 0) break;
-            int piece = board[sq];
-            if (piece != P_EMPTY) {
-                if (blocker < 0) {
-                    if (is_white(piece) == whiteKing) {
-                        blocker = sq;
-                    } else {
-                        break;
-                    }
-                } else {
-                    if (is_white(piece) != whiteKing && slider_matches(piece, dirs[i][0], dirs[i][1])) {
-                        set_relation(masks, 11, sq, blocker);
-                    }
-                    break;
+        rows[6] = type == P_BISHOP ? diag : 0;
+        rows[7] = type == P_ROOK ? orth : 0;
+        rows[8] = type == P_QUEEN ? reach : 0;
+
+        // Both "near king" zones (own pieces near theirs, their pieces near
+        // ours) are the zone of the king opposite this piece.
+        int king = kings[white ? 1 : 0];
+        bool own = white == (p.whiteToMove != 0);
+        rows[own ? 0 : 1] = reach & enemy;
+        rows[own ? 2 : 3] = reach & same;
+        rows[own ? 4 : 5] = reach & ~occ & dev_king_zone(t, king);
+
+        // Pin: exactly one piece, of the king's colour, between the opposing
+        // king and a slider that moves along that line.
+        if (king >= 0 && type >= P_BISHOP && type <= P_QUEEN) {
+            uint64_t bit = 1ULL << from;
+            bool onOrth = (crtk_perft::rook_attacks(t, king, 0) & bit) != 0;
+            bool onDiag = (crtk_perft::bishop_attacks(t, king, 0) & bit) != 0;
+            if ((onOrth && type != P_BISHOP) || (onDiag && type != P_ROOK)) {
+                uint64_t blockers = crtk_perft::squares_between(t, king, from) & occ;
+                if (blockers != 0 && (blockers & (blockers - 1)) == 0 && (blockers & enemy) != 0) {
+                    rows[11] = blockers;
                 }
             }
-            r += dirs[i][0];
-            f += dirs[i][1];
-        }
-    }
-}
-
-static void add_piece_relations(std::vector<float>& masks, const int* board, bool whiteToMove,
-        const bool* nearOwnKing, const bool* nearThemKing, int from, int piece) {
-    int type = std::abs(piece);
-    bool own = is_own(piece, whiteToMove);
-    switch (type) {
-        case P_PAWN:
-            add_pawn_relations(masks, board, nearOwnKing, nearThemKing, from, piece, own);
-            break;
-        case P_KNIGHT: {
-            const int deltas[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
-            add_step_relations(masks, board, nearOwnKing, nearThemKing, from, own, deltas, 8, true, false);
-            break;
-        }
-        case P_BISHOP:
-            add_ray_relations(masks, board, nearOwnKing, nearThemKing, from, own, true, false);
-            break;
-        case P_ROOK:
-            add_ray_relations(masks, board, nearOwnKing, nearThemKing, from, own, false, true);
-            break;
-        case P_QUEEN:
-            add_ray_relations(masks, board, nearOwnKing, nearThemKing, from, own, true, true);
-            break;
-        case P_KING: {
-            const int deltas[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
-            add_step_relations(masks, board, nearOwnKing, nearThemKing, from, own, deltas, 8, false, false);
-            break;
         }
-        default:
-            break;
     }
+    for (int r = 0; r < RELATION_COUNT; ++r) p.masks[r * SQUARES + from] = rows[r];
 }
 
-static std::vector<float> build_relation_masks(const int* board, bool whiteToMove) {
-    std::vector<float> masks(static_cast<size_t>(RELATION_COUNT) * SQUARES * SQUARES, 0.0f);
-    bool nearOwnKing[SQUARES];
-    bool nearThemKing[SQUARES];
-    king_zone(find_king(board, whiteToMove), nearOwnKing);
-    king_zone(find_king(board, !whiteToMove), nearThemKing);
-    for (int from = 0; from < SQUARES; ++from) {
-        int piece = board[from];
-        if (piece == P_EMPTY) continue;
-        add_piece_relations(masks, board, whiteToMove, nearOwnKing, nearThemKing, from, piece);
-        add_slider_relation_masks(masks, board, from, piece);
+// Block-wide sum over a fixed shared-memory tree, so every launch adds in the
+// same order. THREADS is the (power-of-two) block size; every thread of the
+// block must call it and receives the total. `scratch` holds THREADS floats.
+template <int THREADS>
+__device__ float dev_block_sum(float value, float* scratch) {
+    int tid = threadIdx.x;
+    scratch[tid] = value;
+    __syncthreads();
+    for (int stride = THREADS / 2; stride > 0; stride >>= 1) {
+        if (tid < stride) scratch[tid] += scratch[tid + stride];
+        __syncthreads();
     }
-    add_pin_relations(masks, board, true);
-    add_pin_relations(masks, board, false);
-    return masks;
-}
-
-// ---------------------------------------------------------------------------
-// Device math helpers
-// ---------------------------------------------------------------------------
-
-__device__ __forceinline__ float dev_gelu(float x) {
-    return 0.5f * x * (1.0f + tanhf(0.7978845608028654f * (x + 0.044715f * x * x * x)));
-}
-
-__device__ __forceinline__ float dev_sigmoid(float x) {
-    return 1.0f / (1.0f + expf(-x));
+    float total = scratch[0];
+    __syncthreads();
+    return total;
 }
 
-__device__ void dev_layernorm(float* values, const float* scale, int scaleOff,
-        const float* bias, int biasOff, int length) {
-    float mean = 0.0f;
-    for (int i = 0; i < length; ++i) mean += values[i];
-    mean /= static_cast<float>(length);
-    float variance = 0.0f;
-    for (int i = 0; i < length; ++i) {
+// Block-wide dev_layernorm over `values` (shared memory, `length` entries).
+template <int THREADS>
+__device__ void dev_block_layernorm(float* values, const float* scale, const float* bias, int length,
+        float* scratch) {
+    int tid = threadIdx.x;
+    float partial = 0.0f;
+    for (int i = tid; i < length; i += THREADS) partial += values[i];
+    float mean = dev_block_sum<THREADS>(partial, scratch) / static_cast<float>(length);
+    partial = 0.0f;
+    for (int i = tid; i < length; i += THREADS) {
         float centered = values[i] - mean;
-        variance += centered * centered;
+        partial += centered * centered;
     }
-    float invStd = rsqrtf(variance / static_cast<float>(length) + 1.0e-5f);
-    for (int i = 0; i < length; ++i) {
-        values[i] = (values[i] - mean) * invStd * scale[scaleOff + i] + bias[biasOff + i];
+    float invStd = rsqrtf(dev_block_sum<THREADS>(partial, scratch) / static_cast<float>(length) + 1.0e-5f);
+    for (int i = tid; i < length; i += THREADS) {
+        values[i] = (values[i] - mean) * invStd * scale[i] + bias[i];
     }
+    __syncthreads();
 }
 
 // ---------------------------------------------------------------------------
@@ -840,6 +938,7 @@ __device__ void dev_layernorm(float* values, const float* scale, int scaleOff,
 // ---------------------------------------------------------------------------
 
 __global__ void k_square_tokens(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
     int sq = blockIdx.x * blockDim.x + threadIdx.x;
     if (sq >= SQUARES) return;
     int c = p.channels;
@@ -913,6 +1012,7 @@ __global__ void k_square_tokens(OtisDev p) {
 }
 
 __global__ void k_salience(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
     int sq = blockIdx.x * blockDim.x + threadIdx.x;
     if (sq >= SQUARES) return;
     int c = p.channels;
@@ -933,6 +1033,7 @@ __global__ void k_salience(OtisDev p) {
 }
 
 __global__ void k_node_to_stalk(OtisDev p, int block) {
+    p = dev_position(p, blockIdx.y);
     int sq = blockIdx.x * blockDim.x + threadIdx.x;
     if (sq >= SQUARES) return;
     int c = p.channels;
@@ -948,104 +1049,124 @@ __global__ void k_node_to_stalk(OtisDev p, int block) {
     }
 }
 
-// Single-thread sheaf transport for one block (mirrors Model.sheafState body).
-__global__ void k_sheaf_transport(OtisDev p, int block) {
-    if (blockIdx.x != 0 || threadIdx.x != 0) return;
-    const float* stalks = p.stalks;
-    float* update = p.update;
-    float* degree = p.degree;
-    for (int i = 0; i < SQUARES * STALK_DIM; ++i) update[i] = 0.0f;
-    for (int sq = 0; sq < SQUARES; ++sq) degree[sq] = 0.0f;
-
-    float eta = SHEAF_ETA * 2.0f * dev_sigmoid(p.etaLogits[block]);
-    float src[STALK_DIM];
-    float dst[STALK_DIM];
-    float residual[STALK_DIM];
-    float srcBack[STALK_DIM];
-    float dstBack[STALK_DIM];
-
-    for (int relation = 0; relation < RELATION_COUNT; ++relation) {
-        float gate = 2.0f * dev_sigmoid(p.relGate[block * RELATION_COUNT + relation]);
-        p.gates[relation] += gate;
-        float sign = DEV_RELATION_SIGNS[relation];
-        int rhoBase = ((block * RELATION_COUNT) + relation) * STALK_DIM * STALK_DIM;
-        int edgeCount = 0;
-        float energySum = 0.0f;
-        for (int from = 0; from < SQUARES; ++from) {
-            for (int to = 0; to < SQUARES; ++to) {
-                float edge = p.masks[mask_index(relation, from, to)];
-                if (edge <= 0.0f) continue;
-                edgeCount++;
-                if (block == 0) {
-                    p.srcPressure[relation * SQUARES + from] += edge;
-                    p.dstPressure[relation * SQUARES + to] += edge;
-                }
-                const float* sStalk = stalks + static_cast<size_t>(from) * STALK_DIM;
-                const float* dStalk = stalks + static_cast<size_t>(to) * STALK_DIM;
-                for (int j = 0; j < STALK_DIM; ++j) {
-                    float sSum = 0.0f;
-                    float dSum = 0.0f;
-                    for (int i = 0; i < STALK_DIM; ++i) {
-                        sSum += sStalk[i] * p.rhoSrc[rhoBase + i * STALK_DIM + j];
-                        dSum += dStalk[i] * p.rhoDst[rhoBase + i * STALK_DIM + j];
-                    }
-                    src[j] = sSum;
-                    dst[j] = dSum;
-                }
-                float norm = 0.0f;
-                for (int dim = 0; dim < STALK_DIM; ++dim) {
-                    float value = dst[dim] - sign * src[dim];
-                    residual[dim] = value;
-                    norm += value * value;
-                }
-                energySum += edge * norm;
-                for (int j = 0; j < STALK_DIM; ++j) {
-                    float sb = 0.0f;
-                    float db = 0.0f;
-                    for (int i = 0; i < STALK_DIM; ++i) {
-                        sb += residual[i] * p.rhoSrc[rhoBase + j * STALK_DIM + i];
-                        db += residual[i] * p.rhoDst[rhoBase + j * STALK_DIM + i];
-                    }
-                    srcBack[j] = sb;
-                    dstBack[j] = db;
-                }
-                float scaled = gate * edge;
-                for (int dim = 0; dim < STALK_DIM; ++dim) {
-                    update[from * STALK_DIM + dim] += scaled * sign * srcBack[dim];
-                    update[to * STALK_DIM + dim] -= scaled * dstBack[dim];
-                }
-                degree[from] += scaled;
-                degree[to] += scaled;
-            }
-        }
-        if (block == 0) {
-            p.density[relation] = edgeCount / static_cast<float>(SQUARES * SQUARES);
-        }
-        if (edgeCount > 0) {
-            p.energy[relation] += gate * energySum / edgeCount;
+// Sheaf transport, edge pass (mirrors the Model.sheafState edge loop): one
+// block per relation, one thread per square. The rho back-projection is
+// linear, so each thread sums the residuals of the edges leaving and entering
+// its square and projects the two sums once, leaving a per-relation partial
+// update and degree for k_sheaf_reduce. No atomics, so results are
+// deterministic.
+__global__ void __launch_bounds__(SQUARES) k_sheaf_edges(OtisDev p, int block) {
+    p = dev_position(p, blockIdx.y);
+    __shared__ float srcProj[SQUARES][STALK_DIM];
+    __shared__ float dstProj[SQUARES][STALK_DIM];
+    __shared__ float scratch[SQUARES];
+    int relation = blockIdx.x;
+    int sq = threadIdx.x;
+    int rhoBase = ((block * RELATION_COUNT) + relation) * STALK_DIM * STALK_DIM;
+    float gate = 2.0f * dev_sigmoid(p.relGate[block * RELATION_COUNT + relation]);
+    float sign = DEV_RELATION_SIGNS[relation];
+
+    const float* stalk = p.stalks + static_cast<size_t>(sq) * STALK_DIM;
+    for (int j = 0; j < STALK_DIM; ++j) {
+        float sSum = 0.0f;
+        float dSum = 0.0f;
+        for (int i = 0; i < STALK_DIM; ++i) {
+            sSum += stalk[i] * p.rhoSrc[rhoBase + i * STALK_DIM + j];
+            dSum += stalk[i] * p.rhoDst[rhoBase + i * STALK_DIM + j];
         }
+        srcProj[sq][j] = sSum;
+        dstProj[sq][j] = dSum;
     }
+    __syncthreads();
 
-    float* stalkDelta = p.stalkDelta;
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        float invDegree = 1.0f / fmaxf(1.0f, degree[sq]);
-        float signed_ = 0.0f;
+    const uint64_t* rows = p.masks + relation * SQUARES;
+    float outSum[STALK_DIM];
+    float inSum[STALK_DIM];
+    for (int dim = 0; dim < STALK_DIM; ++dim) {
+        outSum[dim] = 0.0f;
+        inSum[dim] = 0.0f;
+    }
+    float energySum = 0.0f;
+    int outCount = 0;
+    int inCount = 0;
+    uint64_t row = rows[sq];
+    while (row) {
+        int to = crtk_perft::ctz64(row);
+        row &= row - 1;
+        outCount++;
         float norm = 0.0f;
         for (int dim = 0; dim < STALK_DIM; ++dim) {
-            float delta = update[sq * STALK_DIM + dim] * invDegree;
-            stalkDelta[sq * STALK_DIM + dim] = eta * delta;
-            signed_ += delta;
-            norm += delta * delta;
+            float value = dstProj[to][dim] - sign * srcProj[sq][dim];
+            outSum[dim] += value;
+            norm += value * value;
+        }
+        energySum += norm;
+    }
+    uint64_t bit = 1ULL << sq;
+    for (int from = 0; from < SQUARES; ++from) {
+        if ((rows[from] & bit) == 0) continue;
+        inCount++;
+        for (int dim = 0; dim < STALK_DIM; ++dim) inSum[dim] += dstProj[sq][dim] - sign * srcProj[from][dim];
+    }
+
+    float* update = p.update + (static_cast<size_t>(relation) * SQUARES + sq) * STALK_DIM;
+    for (int j = 0; j < STALK_DIM; ++j) {
+        float sb = 0.0f;
+        float db = 0.0f;
+        for (int i = 0; i < STALK_DIM; ++i) {
+            sb += outSum[i] * p.rhoSrc[rhoBase + j * STALK_DIM + i];
+            db += inSum[i] * p.rhoDst[rhoBase + j * STALK_DIM + i];
         }
-        p.laplacian[sq] = -signed_ / STALK_DIM;
-        p.node[sq] = tanhf(p.salience[sq]
-                + 0.45f * signed_ / STALK_DIM
-                - 0.08f * sqrtf(norm)
-                + 0.05f * p.input[17 * SQUARES + sq]);
+        update[j] = gate * (sign * sb - db);
+    }
+    p.degree[relation * SQUARES + sq] = gate * static_cast<float>(outCount + inCount);
+    if (block == 0) {
+        p.srcPressure[relation * SQUARES + sq] += static_cast<float>(outCount);
+        p.dstPressure[relation * SQUARES + sq] += static_cast<float>(inCount);
+    }
+
+    float edges = dev_block_sum<SQUARES>(static_cast<float>(outCount), scratch);
+    float energy = dev_block_sum<SQUARES>(energySum, scratch);
+    if (sq == 0) {
+        p.gates[relation] += gate;
+        if (block == 0) p.density[relation] = edges / static_cast<float>(SQUARES * SQUARES);
+        if (edges > 0.0f) p.energy[relation] += gate * energy / edges;
     }
 }
 
+// Sheaf transport, square pass: folds the per-relation partials (in relation
+// order) into the stalk delta and node state of each square.
+__global__ void k_sheaf_reduce(OtisDev p, int block) {
+    p = dev_position(p, blockIdx.y);
+    int sq = blockIdx.x * blockDim.x + threadIdx.x;
+    if (sq >= SQUARES) return;
+    float eta = SHEAF_ETA * 2.0f * dev_sigmoid(p.etaLogits[block]);
+    float update[STALK_DIM];
+    for (int dim = 0; dim < STALK_DIM; ++dim) update[dim] = 0.0f;
+    float degree = 0.0f;
+    for (int relation = 0; relation < RELATION_COUNT; ++relation) {
+        const float* partial = p.update + (static_cast<size_t>(relation) * SQUARES + sq) * STALK_DIM;
+        for (int dim = 0; dim < STALK_DIM; ++dim) update[dim] += partial[dim];
+        degree += p.degree[relation * SQUARES + sq];
+    }
+    float invDegree = 1.0f / fmaxf(1.0f, degree);
+    float signed_ = 0.0f;
+    float norm = 0.0f;
+    for (int dim = 0; dim < STALK_DIM; ++dim) {
+        float delta = update[dim] * invDegree;
+        p.stalkDelta[sq * STALK_DIM + dim] = eta * delta;
+        signed_ += delta;
+        norm += delta * delta;
+    }
+    p.laplacian[sq] = -signed_ / STALK_DIM;
+    p.node[sq] = tanhf(p.salience[sq]
+            + 0.45f * signed_ / STALK_DIM
+            - 0.08f * sqrtf(norm)
+            + 0.05f * p.input[17 * SQUARES + sq]);
+}
+
 __global__ void k_apply_stalk_update(OtisDev p, int block) {
+    p = dev_position(p, blockIdx.y);
     int sq = blockIdx.x * blockDim.x + threadIdx.x;
     if (sq >= SQUARES) return;
     int c = p.channels;
@@ -1062,6 +1183,7 @@ __global__ void k_apply_stalk_update(OtisDev p, int block) {
 }
 
 __global__ void k_apply_node_mlp(OtisDev p, int block) {
+    p = dev_position(p, blockIdx.y);
     int sq = blockIdx.x * blockDim.x + threadIdx.x;
     if (sq >= SQUARES) return;
     int c = p.channels;
@@ -1093,24 +1215,25 @@ __global__ void k_apply_node_mlp(OtisDev p, int block) {
     for (int ch = 0; ch < c; ++ch) h[ch] = down[ch];
 }
 
-// Single-thread finalize: node blend, trunk channel-major, scalars, energy/gates averaging.
-__global__ void k_finalize_sheaf(OtisDev p) {
-    if (blockIdx.x != 0 || threadIdx.x != 0) return;
+// Finalize: node blend and channel-major trunk (one thread per square), then
+// energy/gates averaging and the board scalars.
+__global__ void __launch_bounds__(SQUARES) k_finalize_sheaf(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
+    int sq = threadIdx.x;
     int c = p.channels;
-    for (int relation = 0; relation < RELATION_COUNT; ++relation) {
-        p.energy[relation] /= static_cast<float>(p.blocks);
-        p.gates[relation] /= static_cast<float>(p.blocks);
-    }
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        float mean = 0.0f;
-        const float* h = p.h + static_cast<size_t>(sq) * c;
-        for (int ch = 0; ch < c; ++ch) mean += h[ch];
-        p.node[sq] = tanhf(0.5f * p.node[sq] + 0.5f * mean / c);
+    if (sq < RELATION_COUNT) {
+        p.energy[sq] /= static_cast<float>(p.blocks);
+        p.gates[sq] /= static_cast<float>(p.blocks);
     }
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        const float* h = p.h + static_cast<size_t>(sq) * c;
-        for (int ch = 0; ch < c; ++ch) p.trunk[ch * SQUARES + sq] = h[ch];
+    const float* h = p.h + static_cast<size_t>(sq) * c;
+    float mean = 0.0f;
+    for (int ch = 0; ch < c; ++ch) {
+        mean += h[ch];
+        p.trunk[ch * SQUARES + sq] = h[ch];
     }
+    p.node[sq] = tanhf(0.5f * p.node[sq] + 0.5f * mean / c);
+    __syncthreads();
+    if (sq != 0) return;
     float tension = 0.0f;
     for (int relation = 0; relation < RELATION_COUNT; ++relation) tension += p.energy[relation];
     tension /= static_cast<float>(RELATION_COUNT);
@@ -1128,120 +1251,135 @@ __global__ void k_finalize_sheaf(OtisDev p) {
     p.scalars[3] = p.density[11];
 }
 
-__device__ float dev_matrix_response(const float* matrix, const float* values, int channels) {
-    float sum = 0.0f;
-    for (int row = 0; row < channels; ++row) {
+// Triad response: mean tanh of the matrix rows applied to `values`, rows split
+// across the block.
+template <int THREADS>
+__device__ float dev_block_matrix_response(const float* matrix, const float* values, int channels,
+        float* scratch) {
+    float partial = 0.0f;
+    for (int row = threadIdx.x; row < channels; row += THREADS) {
         float rowSum = 0.0f;
         const float* r = matrix + row * channels;
         for (int col = 0; col < channels; ++col) rowSum += r[col] * values[col];
-        sum += tanhf(rowSum);
+        partial += tanhf(rowSum);
     }
-    return sum / static_cast<float>(channels);
+    return dev_block_sum<THREADS>(partial, scratch) / static_cast<float>(channels);
 }
 
-// Single-thread readout: builds features and computes the hidden vector.
-__global__ void k_readout(OtisDev p) {
-    if (blockIdx.x != 0 || threadIdx.x != 0) return;
+// Readout features (one block; channels and relations split across threads),
+// layer-normed into p.features for k_readout_hidden.
+__global__ void __launch_bounds__(OTIS_READOUT_THREADS) k_readout(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
+    __shared__ float features[MAX_READOUT_DIM];
+    __shared__ float scratch[OTIS_READOUT_THREADS];
+    int tid = threadIdx.x;
     int c = p.channels;
     int rd = p.readoutDim;
-    float features[MAX_CHANNELS * 4 + RELATION_COUNT * 4 + TRIAD_DIM + BOARD_STATS_DIM];
-    float means[MAX_CHANNELS];
-    int cursor = 0;
-    for (int ch = 0; ch < c; ++ch) {
-        float sum = 0.0f;
-        const float* col = p.trunk + ch * SQUARES;
-        for (int sq = 0; sq < SQUARES; ++sq) sum += col[sq];
-        means[ch] = sum / static_cast<float>(SQUARES);
-        features[cursor++] = means[ch];
+    bool whiteToMove = p.whiteToMove != 0;
+    int ownCount = 0;
+    int themCount = 0;
+    for (int sq = 0; sq < SQUARES; ++sq) {
+        int piece = p.board[sq];
+        if (piece == P_EMPTY) continue;
+        if ((piece > 0) == whiteToMove) ownCount++; else themCount++;
     }
-    for (int ch = 0; ch < c; ++ch) {
-        float maxv = -3.402823466e+38F;
+    // [means | max | own-piece means | their-piece means] per channel.
+    for (int ch = tid; ch < c; ch += OTIS_READOUT_THREADS) {
         const float* col = p.trunk + ch * SQUARES;
-        for (int sq = 0; sq < SQUARES; ++sq) maxv = fmaxf(maxv, col[sq]);
-        features[cursor++] = maxv;
-    }
-    bool whiteToMove = p.whiteToMove != 0;
-    for (int side = 0; side < 2; ++side) {
-        bool ownSide = side == 0;
-        float acc[MAX_CHANNELS];
-        for (int ch = 0; ch < c; ++ch) acc[ch] = 0.0f;
-        int count = 0;
+        float sum = 0.0f;
+        float maxv = -3.402823466e+38F;
+        float own = 0.0f;
+        float them = 0.0f;
         for (int sq = 0; sq < SQUARES; ++sq) {
+            float v = col[sq];
+            sum += v;
+            maxv = fmaxf(maxv, v);
             int piece = p.board[sq];
             if (piece == P_EMPTY) continue;
-            bool own = (piece > 0) == whiteToMove;
-            if (own != ownSide) continue;
-            count++;
-            for (int ch = 0; ch < c; ++ch) acc[ch] += p.trunk[ch * SQUARES + sq];
-        }
-        if (count > 0) {
-            float inv = 1.0f / static_cast<float>(count);
-            for (int ch = 0; ch < c; ++ch) acc[ch] *= inv;
+            if ((piece > 0) == whiteToMove) own += v; else them += v;
         }
-        for (int ch = 0; ch < c; ++ch) features[cursor++] = acc[ch];
+        features[ch] = sum / static_cast<float>(SQUARES);
+        features[c + ch] = maxv;
+        features[2 * c + ch] = ownCount > 0 ? own * (1.0f / static_cast<float>(ownCount)) : 0.0f;
+        features[3 * c + ch] = themCount > 0 ? them * (1.0f / static_cast<float>(themCount)) : 0.0f;
     }
-    for (int relation = 0; relation < RELATION_COUNT; ++relation) features[cursor++] = p.energy[relation];
-    for (int relation = 0; relation < RELATION_COUNT; ++relation) features[cursor++] = p.density[relation];
-    for (int relation = 0; relation < RELATION_COUNT; ++relation) features[cursor++] = p.gates[relation];
-    for (int relation = 0; relation < RELATION_COUNT; ++relation) {
+    int base = 4 * c;
+    if (tid < RELATION_COUNT) {
+        int relation = tid;
+        features[base + relation] = p.energy[relation];
+        features[base + RELATION_COUNT + relation] = p.density[relation];
+        features[base + 2 * RELATION_COUNT + relation] = p.gates[relation];
         float sum = 0.0f;
         for (int sq = 0; sq < SQUARES; ++sq) {
             sum += p.srcPressure[relation * SQUARES + sq] + p.dstPressure[relation * SQUARES + sq];
         }
-        features[cursor++] = sum / (2.0f * SQUARES);
+        features[base + 3 * RELATION_COUNT + relation] = sum / (2.0f * SQUARES);
     }
-    float tension = p.scalars[0];
-    float transport = p.scalars[1];
-    float topology = p.scalars[2];
-    float pin = p.scalars[3];
-    float triad[TRIAD_DIM];
-    triad[0] = dev_matrix_response(p.triadAW, means, c);
-    triad[1] = dev_matrix_response(p.triadTW, means, c);
-    triad[2] = dev_matrix_response(p.triadDW, means, c);
-    triad[3] = tension - pin + 0.25f * transport;
-    dev_layernorm(triad, p.triadNormW, 0, p.triadNormB, 0, TRIAD_DIM);
-    for (int i = 0; i < TRIAD_DIM; ++i) features[cursor++] = triad[i];
-
-    int ownCount = 0;
-    int themCount = 0;
-    float material = 0.0f;
-    float atlas = 0.0f;
-    int occupied = 0;
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        int piece = p.board[sq];
-        if (piece == P_EMPTY) continue;
-        occupied++;
-        atlas += p.valueAtlas[sq];
-        int type = piece < 0 ? -piece : piece;
-        float value = 0.0f;
-        if (type == P_PAWN) value = 0.10f;
-        else if (type == P_KNIGHT || type == P_BISHOP) value = 0.30f;
-        else if (type == P_ROOK) value = 0.50f;
-        else if (type == P_QUEEN) value = 0.90f;
-        else if (type == P_KING) value = 0.20f;
-        bool own = (piece > 0) == whiteToMove;
-        material += own ? value : -value;
-        if (own) ownCount++; else themCount++;
-    }
-    features[cursor++] = occupied / static_cast<float>(SQUARES);
-    features[cursor++] = ownCount / 16.0f;
-    features[cursor++] = themCount / 16.0f;
-    features[cursor++] = material / 4.0f;
-    features[cursor++] = occupied == 0 ? 0.0f : atlas / occupied;
-    features[cursor++] = tension;
-    features[cursor++] = transport;
-    features[cursor++] = topology + pin;
-
-    dev_layernorm(features, p.readNormW, 0, p.readNormB, 0, rd);
-    for (int o = 0; o < HIDDEN_DIM; ++o) {
-        float sum = p.readHidB[o];
-        const float* row = p.readHidW + o * rd;
-        for (int i = 0; i < rd; ++i) sum += row[i] * features[i];
-        p.hidden[o] = dev_gelu(sum);
+    __syncthreads();
+
+    const float* means = features;
+    float triadA = dev_block_matrix_response<OTIS_READOUT_THREADS>(p.triadAW, means, c, scratch);
+    float triadT = dev_block_matrix_response<OTIS_READOUT_THREADS>(p.triadTW, means, c, scratch);
+    float triadD = dev_block_matrix_response<OTIS_READOUT_THREADS>(p.triadDW, means, c, scratch);
+    if (tid == 0) {
+        float tension = p.scalars[0];
+        float transport = p.scalars[1];
+        float topology = p.scalars[2];
+        float pin = p.scalars[3];
+        float triad[TRIAD_DIM] = {triadA, triadT, triadD, tension - pin + 0.25f * transport};
+        dev_layernorm(triad, p.triadNormW, 0, p.triadNormB, 0, TRIAD_DIM);
+        int cursor = base + 4 * RELATION_COUNT;
+        for (int i = 0; i < TRIAD_DIM; ++i) features[cursor++] = triad[i];
+
+        float material = 0.0f;
+        float atlas = 0.0f;
+        int occupied = 0;
+        for (int sq = 0; sq < SQUARES; ++sq) {
+            int piece = p.board[sq];
+            if (piece == P_EMPTY) continue;
+            occupied++;
+            atlas += p.valueAtlas[sq];
+            int type = piece < 0 ? -piece : piece;
+            float value = 0.0f;
+            if (type == P_PAWN) value = 0.10f;
+            else if (type == P_KNIGHT || type == P_BISHOP) value = 0.30f;
+            else if (type == P_ROOK) value = 0.50f;
+            else if (type == P_QUEEN) value = 0.90f;
+            else if (type == P_KING) value = 0.20f;
+            bool own = (piece > 0) == whiteToMove;
+            material += own ? value : -value;
+        }
+        features[cursor++] = occupied / static_cast<float>(SQUARES);
+        features[cursor++] = ownCount / 16.0f;
+        features[cursor++] = themCount / 16.0f;
+        features[cursor++] = material / 4.0f;
+        features[cursor++] = occupied == 0 ? 0.0f : atlas / occupied;
+        features[cursor++] = tension;
+        features[cursor++] = transport;
+        features[cursor++] = topology + pin;
     }
+    __syncthreads();
+
+    dev_block_layernorm<OTIS_READOUT_THREADS>(features, p.readNormW, p.readNormB, rd, scratch);
+    for (int i = tid; i < rd; i += OTIS_READOUT_THREADS) p.features[i] = features[i];
+}
+
+// Readout hidden layer: one block per hidden unit, the dot product split
+// across the block.
+__global__ void __launch_bounds__(OTIS_GEMV_THREADS) k_readout_hidden(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
+    __shared__ float scratch[OTIS_GEMV_THREADS];
+    int o = blockIdx.x;
+    int rd = p.readoutDim;
+    const float* row = p.readHidW + static_cast<size_t>(o) * rd;
+    float partial = 0.0f;
+    for (int i = threadIdx.x; i < rd; i += OTIS_GEMV_THREADS) partial += row[i] * p.features[i];
+    float sum = dev_block_sum<OTIS_GEMV_THREADS>(partial, scratch);
+    if (threadIdx.x == 0) p.hidden[o] = dev_gelu(p.readHidB[o] + sum);
 }
 
 __global__ void k_policy_head(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
     int idx = blockIdx.x * blockDim.x + threadIdx.x;
     if (idx >= p.policySize) return;
     float sum = p.policyB[idx];
@@ -1250,15 +1388,18 @@ __global__ void k_policy_head(OtisDev p) {
     p.policy[idx] = sum;
 }
 
-__global__ void k_value_head(OtisDev p) {
-    if (blockIdx.x != 0 || threadIdx.x != 0) return;
+// WDL head: the three dot products split across one block, softmax on thread 0.
+__global__ void __launch_bounds__(OTIS_GEMV_THREADS) k_value_head(OtisDev p) {
+    p = dev_position(p, blockIdx.y);
+    __shared__ float scratch[OTIS_GEMV_THREADS];
     float logits[WDL_OUTPUTS];
     for (int b = 0; b < WDL_OUTPUTS; ++b) {
-        float sum = p.wdlB[b];
         const float* row = p.wdlW + b * HIDDEN_DIM;
-        for (int h = 0; h < HIDDEN_DIM; ++h) sum += row[h] * p.hidden[h];
-        logits[b] = sum;
+        float partial = 0.0f;
+        for (int h = threadIdx.x; h < HIDDEN_DIM; h += OTIS_GEMV_THREADS) partial += row[h] * p.hidden[h];
+        logits[b] = p.wdlB[b] + dev_block_sum<OTIS_GEMV_THREADS>(partial, scratch);
     }
+    if (threadIdx.x != 0) return;
     float maxValue = fmaxf(logits[0], fmaxf(logits[1], logits[2]));
     float a = expf(logits[0] - maxValue);
     float bb = expf(logits[1] - maxValue);
@@ -1274,52 +1415,126 @@ static bool launched_ok() {
     return gpu_ok(BT4_GPU_LAST_ERROR());
 }
 
-static bool predict_gpu(OtisNet& net, const std::vector<float>& encoded,
-        std::vector<float>& policy, std::vector<float>& wdl) {
-    int board[SQUARES];
-    bool whiteToMove = encoded[12 * SQUARES] > 0.5f;
-    for (int sq = 0; sq < SQUARES; ++sq) board[sq] = piece_from_planes(encoded, sq);
-    std::vector<float> masks = build_relation_masks(board, whiteToMove);
-
-    if (!gpu_ok(BT4_GPU_MEMCPY(net.dInput, encoded.data(),
-            encoded.size() * sizeof(float), BT4_GPU_MEMCPY_H2D))) return false;
-    if (!gpu_ok(BT4_GPU_MEMCPY(net.dBoard, board, sizeof(board), BT4_GPU_MEMCPY_H2D))) return false;
-    if (!gpu_ok(BT4_GPU_MEMCPY(net.dMasks, masks.data(),
-            masks.size() * sizeof(float), BT4_GPU_MEMCPY_H2D))) return false;
-    if (!gpu_ok(BT4_GPU_MEMSET(net.energy, 0, RELATION_COUNT * sizeof(float)))) return false;
-    if (!gpu_ok(BT4_GPU_MEMSET(net.gates, 0, RELATION_COUNT * sizeof(float)))) return false;
-    if (!gpu_ok(BT4_GPU_MEMSET(net.density, 0, RELATION_COUNT * sizeof(float)))) return false;
-    if (!gpu_ok(BT4_GPU_MEMSET(net.srcPressure, 0, RELATION_COUNT * SQUARES * sizeof(float)))) return false;
-    if (!gpu_ok(BT4_GPU_MEMSET(net.dstPressure, 0, RELATION_COUNT * SQUARES * sizeof(float)))) return false;
+// Enqueues the scratch resets and the kernel sequence for `batch` positions on net.stream; every
+// launch carries the batch in grid.y. The stages are bracketed in net.stats.
+static bool record_forward(OtisNet& net, int batch) {
+    BT4_GPU_STREAM stream = net.stream;
+    GpuStats& stats = net.stats;
+    const size_t b = static_cast<size_t>(batch);
+    stats.begin(OTIS_STAGE_EMBED, stream);
+    if (!gpu_ok(BT4_GPU_MEMSET_ASYNC(net.energy, 0, b * RELATION_COUNT * sizeof(float), stream))) return false;
+    if (!gpu_ok(BT4_GPU_MEMSET_ASYNC(net.gates, 0, b * RELATION_COUNT * sizeof(float), stream))) return false;
+    if (!gpu_ok(BT4_GPU_MEMSET_ASYNC(net.density, 0, b * RELATION_COUNT * sizeof(float), stream))) return false;
+    if (!gpu_ok(BT4_GPU_MEMSET_ASYNC(net.srcPressure, 0, b * RELATION_COUNT * SQUARES * sizeof(float), stream))) return false;
+    if (!gpu_ok(BT4_GPU_MEMSET_ASYNC(net.dstPressure, 0, b * RELATION_COUNT * SQUARES * sizeof(float), stream))) return false;
 
     OtisDev dev = make_dev(net);
-    dev.whiteToMove = whiteToMove ? 1 : 0;
-
-    const int sqGrid = (SQUARES + 63) / 64;
-    OTIS_LAUNCH(k_square_tokens, sqGrid, 64, dev);
-    OTIS_LAUNCH(k_salience, sqGrid, 64, dev);
-    for (int block = 0; block < net.blocks; ++block) {
-        OTIS_LAUNCH(k_node_to_stalk, sqGrid, 64, dev, block);
-        OTIS_LAUNCH(k_sheaf_transport, 1, 1, dev, block);
-        OTIS_LAUNCH(k_apply_stalk_update, sqGrid, 64, dev, block);
-        OTIS_LAUNCH(k_apply_node_mlp, sqGrid, 64, dev, block);
+
+    const dim3 sqGrid((SQUARES + 63) / 64, batch);
+    const dim3 one(1, batch);
+    OTIS_LAUNCH(k_relation_masks, one, SQUARES, stream, dev);
+    OTIS_LAUNCH(k_square_tokens, sqGrid, 64, stream, dev);
+    OTIS_LAUNCH(k_salience, sqGrid, 64, stream, dev);
+    stats.end(OTIS_STAGE_EMBED, stream);
+    stats.begin(OTIS_STAGE_SHEAF, stream);
+    for (int block = 0; block < net.model->blocks; ++block) {
+        OTIS_LAUNCH(k_node_to_stalk, sqGrid, 64, stream, dev, block);
+        OTIS_LAUNCH(k_sheaf_edges, dim3(RELATION_COUNT, batch), SQUARES, stream, dev, block);
+        OTIS_LAUNCH(k_sheaf_reduce, sqGrid, 64, stream, dev, block);
+        OTIS_LAUNCH(k_apply_stalk_update, sqGrid, 64, stream, dev, block);
+        OTIS_LAUNCH(k_apply_node_mlp, sqGrid, 64, stream, dev, block);
+    }
+    stats.end(OTIS_STAGE_SHEAF, stream);
+    stats.begin(OTIS_STAGE_FINALIZE, stream);
+    OTIS_LAUNCH(k_finalize_sheaf, one, SQUARES, stream, dev);
+    stats.end(OTIS_STAGE_FINALIZE, stream);
+    stats.begin(OTIS_STAGE_READOUT, stream);
+    OTIS_LAUNCH(k_readout, one, OTIS_READOUT_THREADS, stream, dev);
+    OTIS_LAUNCH(k_readout_hidden, dim3(HIDDEN_DIM, batch), OTIS_GEMV_THREADS, stream, dev);
+    stats.end(OTIS_STAGE_READOUT, stream);
+    stats.begin(OTIS_STAGE_HEADS, stream);
+    OTIS_LAUNCH(k_policy_head, dim3((net.model->policySize + 127) / 128, batch), 128, stream, dev);
+    OTIS_LAUNCH(k_value_head, one, OTIS_GEMV_THREADS, stream, dev);
+    stats.end(OTIS_STAGE_HEADS, stream);
+    return launched_ok();
+}
+
+// Runs the forward pass over the `batch` positions already in net.dInput and downloads policy logits
+// [batch][policySize] and WDL probabilities [batch][3].
+static bool forward_uploaded(OtisNet& net, int batch, std::chrono::steady_clock::time_point started,
+                             float* policy, float* wdl) {
+    const size_t b = static_cast<size_t>(batch);
+    BT4_GPU_STREAM stream = net.stream;
+    if (!gpu_graph_launch(net.graphs[b], net.useGraphs, stream,
+            [&net, batch]() { return record_forward(net, batch); })) {
+        return false;
     }
-    OTIS_LAUNCH(k_finalize_sheaf, 1, 1, dev);
-    OTIS_LAUNCH(k_readout, 1, 1, dev);
-    OTIS_LAUNCH(k_policy_head, (net.policySize + 127) / 128, 128, dev);
-    OTIS_LAUNCH(k_value_head, 1, 1, dev);
-    if (!launched_ok()) return false;
-    if (!gpu_ok(BT4_GPU_DEVICE_SYNCHRONIZE())) return false;
-
-    policy.assign(static_cast<size_t>(net.policySize), 0.0f);
-    wdl.assign(WDL_OUTPUTS, 0.0f);
-    if (!gpu_ok(BT4_GPU_MEMCPY(policy.data(), net.policy,
-            policy.size() * sizeof(float), BT4_GPU_MEMCPY_D2H))) return false;
-    if (!gpu_ok(BT4_GPU_MEMCPY(wdl.data(), net.wdlLogits,
-            wdl.size() * sizeof(float), BT4_GPU_MEMCPY_D2H))) return false;
+
+    const size_t policyBytes = b * net.model->policySize * sizeof(float);
+    const size_t wdlBytes = b * WDL_OUTPUTS * sizeof(float);
+    net.stats.begin(OTIS_STAGE_DOWNLOAD, stream);
+    if (!gpu_ok(BT4_GPU_MEMCPY_ASYNC(policy, net.policy, policyBytes, BT4_GPU_MEMCPY_D2H, stream))) return false;
+    if (!gpu_ok(BT4_GPU_MEMCPY_ASYNC(wdl, net.wdlLogits, wdlBytes, BT4_GPU_MEMCPY_D2H, stream))) return false;
+    net.stats.end(OTIS_STAGE_DOWNLOAD, stream, static_cast<long long>(policyBytes + wdlBytes));
+    if (!gpu_ok(BT4_GPU_STREAM_SYNCHRONIZE(stream))) return false;
+    net.stats.collect();
+    net.evalCount++;
+    net.evalNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count();
     return true;
 }
 
+// Evaluates 1..maxBatch positions stored back to back in `encoded` ([batch][18][64]), writing
+// policy logits [batch][policySize] and WDL probabilities [batch][3].
+static bool predict_gpu(OtisNet& net, const float* encoded, int batch, float* policy, float* wdl) {
+    if (batch <= 0 || batch > net.maxBatch || !bind_device(net)) return false;
+    const auto started = std::chrono::steady_clock::now();
+    const size_t bytes = static_cast<size_t>(batch) * INPUT_PLANES * SQUARES * sizeof(float);
+    net.stats.begin(OTIS_STAGE_UPLOAD, net.stream);
+    if (!gpu_ok(BT4_GPU_MEMCPY_ASYNC(net.dInput, encoded, bytes, BT4_GPU_MEMCPY_H2D, net.stream))) return false;
+    net.stats.end(OTIS_STAGE_UPLOAD, net.stream, static_cast<long long>(bytes));
+    return forward_uploaded(net, batch, started, policy, wdl);
+}
+
+// Same as predict_gpu for packed positions ([batch][19] words, see packed_planes_impl.inl): uploads
+// the words and expands them into net.dInput on the device.
+static bool predict_packed_gpu(OtisNet& net, const unsigned long long* packed, int batch, float* policy,
+                               float* wdl) {
+    if (batch <= 0 || batch > net.maxBatch || !bind_device(net)) return false;
+    const size_t words = static_cast<size_t>(packed_words(INPUT_PLANES));
+    if (!net.dPacked && !gpu_ok(BT4_GPU_MALLOC(&net.dPacked, net.maxBatch * words * sizeof(unsigned long long)))) {
+        net.dPacked = nullptr;
+        return false;
+    }
+    const auto started = std::chrono::steady_clock::now();
+    const size_t bytes = batch * words * sizeof(unsigned long long);
+    net.stats.begin(OTIS_STAGE_UPLOAD, net.stream);
+    if (!gpu_ok(BT4_GPU_MEMCPY_ASYNC(net.dPacked, packed, bytes, BT4_GPU_MEMCPY_H2D, net.stream))) return false;
+    net.stats.end(OTIS_STAGE_UPLOAD, net.stream, static_cast<long long>(bytes));
+    net.stats.begin(OTIS_STAGE_EXPAND, net.stream);
+    OTIS_LAUNCH(k_expand_packed_planes, dim3(INPUT_PLANES, batch), SQUARES, net.stream, net.dPacked, INPUT_PLANES,
+            net.dInput);
+    net.stats.end(OTIS_STAGE_EXPAND, net.stream);
+    return launched_ok() && forward_uploaded(net, batch, started, policy, wdl);
+}
+
+// Allocates the pinned input/output buffers on first use (see pinned_io_impl.inl).
+static bool alloc_pinned(OtisNet& net) {
+    if (net.hInput) return true;
+    if (!bind_device(net)) return false;
+    const size_t b = static_cast<size_t>(net.maxBatch);
+    if (gpu_ok(BT4_GPU_HOST_ALLOC(&net.hInput, b * INPUT_PLANES * SQUARES * sizeof(float)))
+            && gpu_ok(BT4_GPU_HOST_ALLOC(&net.hPolicy, b * net.model->policySize * sizeof(float)))
+            && gpu_ok(BT4_GPU_HOST_ALLOC(&net.hWdl, b * WDL_OUTPUTS * sizeof(float)))) {
+        return true;
+    }
+    if (net.hInput) BT4_GPU_HOST_FREE(net.hInput);
+    if (net.hPolicy) BT4_GPU_HOST_FREE(net.hPolicy);
+    if (net.hWdl) BT4_GPU_HOST_FREE(net.hWdl);
+    net.hInput = net.hPolicy = net.hWdl = nullptr;
+    return false;
+}
+
 static std::string jstring_to_string(JNIEnv* env, jstring value) {
     if (!value) return {};
     const char* chars = env->GetStringUTFChars(value, nullptr);
@@ -1329,6 +1544,72 @@ static std::string jstring_to_string(JNIEnv* env, jstring value) {
     return out;
 }
 
+// Models currently held by live handles, one per (path, device).
+static WeightCache<OtisModel>& weight_cache() {
+    static WeightCache<OtisModel> cache(free_model);
+    return cache;
+}
+
+// Allocates the handle's scratch and stream for net.model and sets up its stage counters.
+static bool init_handle(OtisNet& net) {
+    net.maxBatch = max_batch_from_env();
+    net.graphs.assign(static_cast<size_t>(net.maxBatch) + 1, nullptr);
+    if (!alloc_scratch(net) || !gpu_ok(BT4_GPU_STREAM_CREATE(&net.stream))) return false;
+    net.useGraphs = gpu_graphs_from_env(OTIS_GRAPHS_ENV);
+    net.stats.configure(OTIS_STAGE_NAMES, OTIS_STAGES, otis_stats_from_env());
+    if (net.stats.enabled()) net.useGraphs = false;
+    return true;
+}
+
+// Opens a handle on one device ordinal, or returns null when the ordinal is not visible. The
+// weights come from the shared cache; the handle allocates only its own scratch.
+static OtisNet* create_on_device(const std::string& path, int device) {
+    int count = 0;
+    if (path.empty() || device < 0 || !gpu_ok(BT4_GPU_GET_DEVICE_COUNT(&count)) || device >= count
+            || !gpu_ok(BT4_GPU_SET_DEVICE(device))) {
+        return nullptr;
+    }
+    std::shared_ptr<const OtisModel> model = weight_cache().acquire(path, device, 0,
+            [&]() { return load_model(path, device); });
+    if (!model) return nullptr;
+    auto* net = new OtisNet();
+    net->model = std::move(model);
+    net->device = device;
+    if (!init_handle(*net)) {
+        free_net(net);
+        return nullptr;
+    }
+    return net;
+}
+
+// nativeGetInfo result for one handle (layout in the file comment).
+static jlongArray info_array(JNIEnv* env, const OtisNet& net) {
+    const OtisModel& model = *net.model;
+    jlong values[9 + OTIS_INFO_STAGES] = {
+        static_cast<jlong>(model.inputPlanes),
+        static_cast<jlong>(model.channels),
+        static_cast<jlong>(model.blocks),
+        static_cast<jlong>(model.policySize),
+        static_cast<jlong>(model.parameterCount),
+        static_cast<jlong>(net.useGraphs ? 1 : 0),
+        static_cast<jlong>(net.evalCount),
+        static_cast<jlong>(net.evalCount > 0 ? net.evalNanos / net.evalCount : 0)
+    };
+    for (int i = 0; i < OTIS_INFO_STAGES; ++i) {
+        long long calls = 0;
+        long long nanos = 0;
+        net.stats.totals(OTIS_STAGE_EMBED + i, calls, nanos);
+        values[8 + i] = calls > 0 ? nanos / calls : 0;
+    }
+    values[8 + OTIS_INFO_STAGES] = static_cast<jlong>(net.maxBatch);
+    jlongArray out = env->NewLongArray(9 + OTIS_INFO_STAGES);
+    if (!out) return nullptr;
+    env->SetLongArrayRegion(out, 0, 9 + OTIS_INFO_STAGES, values);
+    return out;
+}
+
+using OtisPool = ReplicaPool<OtisNet>;
+
 } // namespace
 
 extern "C" JNIEXPORT jint JNICALL OTIS_JNI(Support_nativeDeviceCount)(JNIEnv*, jclass) {
@@ -1338,9 +1619,12 @@ extern "C" JNIEXPORT jint JNICALL OTIS_JNI(Support_nativeDeviceCount)(JNIEnv*, j
 }
 
 extern "C" JNIEXPORT jlong JNICALL OTIS_JNI(Backend_nativeCreate)(JNIEnv* env, jclass, jstring path) {
-    std::string nativePath = jstring_to_string(env, path);
-    if (nativePath.empty()) return 0L;
-    return reinterpret_cast<jlong>(load_net(nativePath));
+    return reinterpret_cast<jlong>(create_on_device(jstring_to_string(env, path), 0));
+}
+
+extern "C" JNIEXPORT jlong JNICALL OTIS_JNI(Backend_nativeCreateOnDevice)(
+        JNIEnv* env, jclass, jstring path, jint device) {
+    return reinterpret_cast<jlong>(create_on_device(jstring_to_string(env, path), device));
 }
 
 extern "C" JNIEXPORT void JNICALL OTIS_JNI(Backend_nativeDestroy)(JNIEnv*, jclass, jlong handle) {
@@ -1350,45 +1634,221 @@ extern "C" JNIEXPORT void JNICALL OTIS_JNI(Backend_nativeDestroy)(JNIEnv*, jclas
 extern "C" JNIEXPORT jstring JNICALL OTIS_JNI(Backend_nativeGetName)(JNIEnv* env, jclass, jlong handle) {
     auto* net = reinterpret_cast<OtisNet*>(handle);
     if (!net) return nullptr;
-    return env->NewStringUTF(net->name.c_str());
+    return env->NewStringUTF(net->model->name.c_str());
 }
 
 extern "C" JNIEXPORT jlongArray JNICALL OTIS_JNI(Backend_nativeGetInfo)(JNIEnv* env, jclass, jlong handle) {
     auto* net = reinterpret_cast<OtisNet*>(handle);
     if (!net) return nullptr;
-    jlong values[5] = {
-        static_cast<jlong>(net->inputPlanes),
-        static_cast<jlong>(net->channels),
-        static_cast<jlong>(net->blocks),
-        static_cast<jlong>(net->policySize),
-        static_cast<jlong>(net->parameterCount)
-    };
-    jlongArray out = env->NewLongArray(5);
-    if (!out) return nullptr;
-    env->SetLongArrayRegion(out, 0, 5, values);
-    return out;
+    return info_array(env, *net);
+}
+
+extern "C" JNIEXPORT jstring JNICALL OTIS_JNI(Backend_nativeGetStatNames)(JNIEnv* env, jclass, jlong handle) {
+    auto* net = reinterpret_cast<OtisNet*>(handle);
+    if (!net) return nullptr;
+    return net->stats.names_string(env);
+}
+
+// Per-stage counters (layout in gpu_stats_impl.inl), zeroed after reading when `reset` is set.
+extern "C" JNIEXPORT jlongArray JNICALL OTIS_JNI(Backend_nativeGetStats)(
+        JNIEnv* env, jclass, jlong handle, jboolean reset) {
+    auto* net = reinterpret_cast<OtisNet*>(handle);
+    if (!net) return nullptr;
+    return net->stats.to_array(env, reset == JNI_TRUE);
 }
 
 extern "C" JNIEXPORT jfloat JNICALL OTIS_JNI(Backend_nativePredict)(
         JNIEnv* env, jclass, jlong handle, jfloatArray encodedPlanes, jfloatArray outPolicy, jfloatArray outWdl) {
     auto* net = reinterpret_cast<OtisNet*>(handle);
     if (!net || !encodedPlanes || !outPolicy || !outWdl) return 0.0f;
+    const OtisModel& model = *net->model;
     jsize encodedLength = env->GetArrayLength(encodedPlanes);
-    if (encodedLength != net->inputPlanes * SQUARES
-            || env->GetArrayLength(outPolicy) != net->policySize
+    if (encodedLength != model.inputPlanes * SQUARES
+            || env->GetArrayLength(outPolicy) != model.policySize
             || env->GetArrayLength(outWdl) != WDL_OUTPUTS) {
         return 0.0f;
     }
     std::vector<float> encoded(static_cast<size_t>(encodedLength));
     env->GetFloatArrayRegion(encodedPlanes, 0, encodedLength, encoded.data());
-    std::vector<float> policy;
-    std::vector<float> wdl;
-    if (!predict_gpu(*net, encoded, policy, wdl)) return 0.0f;
-    env->SetFloatArrayRegion(outPolicy, 0, net->policySize, policy.data());
+    std::vector<float> policy(static_cast<size_t>(model.policySize));
+    std::vector<float> wdl(WDL_OUTPUTS);
+    if (!predict_gpu(*net, encoded.data(), 1, policy.data(), wdl.data())) return 0.0f;
+    env->SetFloatArrayRegion(outPolicy, 0, model.policySize, policy.data());
     env->SetFloatArrayRegion(outWdl, 0, WDL_OUTPUTS, wdl.data());
     return wdl[0] - wdl[2];
 }
 
+// Batched predict: evaluates `count` positions packed back to back in `encodedBatch` and writes
+// policy/WDL/value in the same order. Requests larger than maxBatch run in maxBatch-sized chunks.
+// Returns the number of positions evaluated (count on success, 0 on failure).
+extern "C" JNIEXPORT jint JNICALL OTIS_JNI(Backend_nativePredictBatch)(
+        JNIEnv* env, jclass, jlong handle, jfloatArray encodedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* net = reinterpret_cast<OtisNet*>(handle);
+    if (!net || !encodedBatch || !outPolicy || !outWdl || !outValue || count <= 0) return 0;
+    const OtisModel& model = *net->model;
+    const size_t n = static_cast<size_t>(count);
+    const size_t encStride = static_cast<size_t>(model.inputPlanes) * SQUARES;
+    const size_t polStride = static_cast<size_t>(model.policySize);
+    if (static_cast<size_t>(env->GetArrayLength(encodedBatch)) < n * encStride
+            || static_cast<size_t>(env->GetArrayLength(outPolicy)) < n * polStride
+            || static_cast<size_t>(env->GetArrayLength(outWdl)) < n * WDL_OUTPUTS
+            || static_cast<size_t>(env->GetArrayLength(outValue)) < n) {
+        return 0;
+    }
+    std::vector<float> encoded(n * encStride);
+    env->GetFloatArrayRegion(encodedBatch, 0, static_cast<jsize>(encoded.size()), encoded.data());
+    std::vector<float> policy(n * polStride);
+    std::vector<float> wdl(n * WDL_OUTPUTS);
+    std::vector<float> values(n);
+    for (size_t off = 0; off < n; off += static_cast<size_t>(net->maxBatch)) {
+        const int chunk = static_cast<int>(std::min(n - off, static_cast<size_t>(net->maxBatch)));
+        if (!predict_gpu(*net, encoded.data() + off * encStride, chunk, policy.data() + off * polStride,
+                wdl.data() + off * WDL_OUTPUTS)) {
+            return 0;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) values[i] = wdl[i * WDL_OUTPUTS] - wdl[i * WDL_OUTPUTS + 2];
+    env->SetFloatArrayRegion(outPolicy, 0, static_cast<jsize>(policy.size()), policy.data());
+    env->SetFloatArrayRegion(outWdl, 0, static_cast<jsize>(wdl.size()), wdl.data());
+    env->SetFloatArrayRegion(outValue, 0, static_cast<jsize>(values.size()), values.data());
+    return count;
+}
+
+// Batched predict from packed positions ([count][19] longs, see packed_planes_impl.inl); outputs and
+// chunking as nativePredictBatch. Returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL OTIS_JNI(Backend_nativePredictPacked)(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* net = reinterpret_cast<OtisNet*>(handle);
+    if (!net) return 0;
+    return packed_predict_batch(env, packedBatch, count, INPUT_PLANES, net->maxBatch, net->model->policySize,
+            outPolicy, outWdl, outValue,
+            [net](const unsigned long long* packed, int chunk, float* policy, float* wdl) {
+                return predict_packed_gpu(*net, packed, chunk, policy, wdl);
+            });
+}
+
+extern "C" JNIEXPORT jobjectArray JNICALL OTIS_JNI(Backend_nativePinnedBuffers)(JNIEnv* env, jclass, jlong handle) {
+    auto* net = reinterpret_cast<OtisNet*>(handle);
+    if (!net || !alloc_pinned(*net)) return nullptr;
+    const size_t b = static_cast<size_t>(net->maxBatch);
+    return pinned_buffer_array(env, net->hInput, b * INPUT_PLANES * SQUARES,
+            net->hPolicy, b * net->model->policySize, net->hWdl, b * WDL_OUTPUTS);
+}
+
+// Evaluates the first `count` positions of the pinned input buffer into the pinned outputs.
+extern "C" JNIEXPORT jint JNICALL OTIS_JNI(Backend_nativePredictPinned)(JNIEnv*, jclass, jlong handle, jint count) {
+    auto* net = reinterpret_cast<OtisNet*>(handle);
+    if (!net || !net->hInput || count <= 0 || count > net->maxBatch) return 0;
+    return predict_gpu(*net, net->hInput, count, net->hPolicy, net->hWdl) ? count : 0;
+}
+
+// Coalescing evaluation queue over this handle (see eval_queue_impl.inl). maxBatch <= 0, or
+// above the handle's own maxBatch, uses the handle's maxBatch; a negative deadline uses the default.
+extern "C" JNIEXPORT jlong JNICALL OTIS_JNI(Backend_nativeQueueCreate)(
+        JNIEnv*, jclass, jlong handle, jint maxBatch, jlong deadlineMicros) {
+    auto* net = reinterpret_cast<OtisNet*>(handle);
+    if (!net) return 0;
+    const OtisModel& model = *net->model;
+    const int batch = (maxBatch <= 0 || maxBatch > net->maxBatch) ? net->maxBatch : maxBatch;
+    try {
+        auto* queue = new EvalQueue(model.inputPlanes * SQUARES, model.policySize, batch, deadlineMicros,
+                [net](const float* encoded, int count, float* policy, float* wdl) {
+                    return predict_gpu(*net, encoded, count, policy, wdl);
+                });
+        return reinterpret_cast<jlong>(queue);
+    } catch (...) {
+        return 0;
+    }
+}
+
+extern "C" JNIEXPORT jlong JNICALL OTIS_JNI(Backend_nativeQueueSubmit)(
+        JNIEnv* env, jclass, jlong queue, jfloatArray encodedPlanes) {
+    return eval_queue_submit(env, queue, encodedPlanes);
+}
+
+extern "C" JNIEXPORT jlong JNICALL OTIS_JNI(Backend_nativeQueueTake)(
+        JNIEnv* env, jclass, jlong queue, jfloatArray outPolicy, jfloatArray outWdl) {
+    return eval_queue_take(env, queue, outPolicy, outWdl);
+}
+
+extern "C" JNIEXPORT void JNICALL OTIS_JNI(Backend_nativeQueueClose)(JNIEnv*, jclass, jlong queue) {
+    eval_queue_close(queue);
+}
+
+extern "C" JNIEXPORT void JNICALL OTIS_JNI(Backend_nativeQueueDestroy)(JNIEnv*, jclass, jlong queue) {
+    eval_queue_destroy(queue);
+}
+
+// Replica pool over one handle per device ordinal in `devices` (see replica_pool_impl.inl).
+extern "C" JNIEXPORT jlong JNICALL OTIS_JNI(Backend_nativePoolCreate)(
+        JNIEnv* env, jclass, jstring path, jintArray devices) {
+    const std::string nativePath = jstring_to_string(env, path);
+    return reinterpret_cast<jlong>(replica_pool_create<OtisNet>(env, devices, free_net,
+            [&nativePath](int device) { return create_on_device(nativePath, device); }));
+}
+
+extern "C" JNIEXPORT void JNICALL OTIS_JNI(Backend_nativePoolDestroy)(JNIEnv*, jclass, jlong pool) {
+    delete reinterpret_cast<OtisPool*>(pool);
+}
+
+extern "C" JNIEXPORT jstring JNICALL OTIS_JNI(Backend_nativePoolGetName)(JNIEnv* env, jclass, jlong pool) {
+    auto* replicas = reinterpret_cast<OtisPool*>(pool);
+    if (!replicas) return nullptr;
+    return env->NewStringUTF(replicas->front().model->name.c_str());
+}
+
+// nativeGetInfo of the first replica.
+extern "C" JNIEXPORT jlongArray JNICALL OTIS_JNI(Backend_nativePoolGetInfo)(JNIEnv* env, jclass, jlong pool) {
+    auto* replicas = reinterpret_cast<OtisPool*>(pool);
+    if (!replicas) return nullptr;
+    return info_array(env, replicas->front());
+}
+
+// nativePredictBatch across the pool; returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL OTIS_JNI(Backend_nativePoolPredictBatch)(
+        JNIEnv* env, jclass, jlong pool, jfloatArray encodedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* replicas = reinterpret_cast<OtisPool*>(pool);
+    if (!replicas) return 0;
+    const OtisNet& net = replicas->front();
+    const OtisModel& model = *net.model;
+    return replica_pool_predict_batch(env, *replicas, encodedBatch, count, model.inputPlanes * SQUARES,
+            net.maxBatch, model.policySize, outPolicy, outWdl, outValue,
+            [](OtisNet& replica, const float* encoded, int chunk, float* policy, float* wdl) {
+                return predict_gpu(replica, encoded, chunk, policy, wdl);
+            });
+}
+
+// nativePredictPacked across the pool; returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL OTIS_JNI(Backend_nativePoolPredictPacked)(
+        JNIEnv* env, jclass, jlong pool, jlongArray packedBatch, jint count,
+        jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue) {
+    auto* replicas = reinterpret_cast<OtisPool*>(pool);
+    if (!replicas || count <= 0) return 0;
+    const OtisNet& net = replicas->front();
+    const OtisModel& model = *net.model;
+    const size_t words = static_cast<size_t>(packed_words(INPUT_PLANES));
+    const size_t polStride = static_cast<size_t>(model.policySize);
+    return packed_predict_batch(env, packedBatch, count, INPUT_PLANES, count, model.policySize,
+            outPolicy, outWdl, outValue,
+            [&](const unsigned long long* packed, int n, float* policy, float* wdl) {
+                return replicas->run(static_cast<size_t>(n), net.maxBatch,
+                        [&](OtisNet& replica, size_t first, int chunk) {
+                            return predict_packed_gpu(replica, packed + first * words, chunk,
+                                    policy + first * polStride, wdl + first * WDL_OUTPUTS);
+                        });
+            });
+}
+
+// {device, calls, positions} per replica.
+extern "C" JNIEXPORT jlongArray JNICALL OTIS_JNI(Backend_nativePoolStats)(JNIEnv* env, jclass, jlong pool) {
+    auto* replicas = reinterpret_cast<OtisPool*>(pool);
+    if (!replicas) return nullptr;
+    return replica_pool_stats(env, *replicas);
+}
+
 #undef OTIS_JNI
 #undef OTIS_CAT
 #undef OTIS_CAT2
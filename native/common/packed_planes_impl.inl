@@ -0,0 +1,86 @@
+/*
+ * native/common/packed_planes_impl.inl
+ *
+ * Packed input planes shared by the LC0 CNN, BT4 and OTIS GPU backends (see
+ * src/chess/gpu/PackedPlanes.java). Every plane of the LC0 112-plane and OTIS simple_18 encodings
+ * is a set of squares holding 1.0 or one constant fill, so Java ships one 64-bit square mask per
+ * plane plus a trailing scalar word ([planes + 1] longs, 904 bytes for 112 planes instead of
+ * 28 KiB of floats). nativePredictPacked uploads that form and k_expand_packed_planes writes the
+ * float input tensor on the device right before the forward pass; the Java encoders expand the
+ * same words on the host for the float entry points, so both paths see identical planes.
+ *
+ * Scalar word: low 32 bits are the float bits of the value written to the set squares of one
+ * plane, high 32 bits that plane's index (0xFFFFFFFF when every set square is 1.0).
+ */
+
+#ifndef CRTK_PACKED_PLANES_IMPL_INL
+#define CRTK_PACKED_PLANES_IMPL_INL
+
+#include <jni.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+static_assert(sizeof(jlong) == sizeof(unsigned long long), "packed planes are 64-bit words");
+
+// Longs per packed position.
+static inline int packed_words(int planes) { return planes + 1; }
+
+// Expands [batch][planes + 1] packed words into [batch][planes][64] floats.
+// grid (planes, batch), block 64: thread s writes square s of plane blockIdx.x.
+__global__ void k_expand_packed_planes(const unsigned long long* __restrict__ packed, int planes,
+                                       float* __restrict__ out) {
+    const int plane = blockIdx.x;
+    const int sq = threadIdx.x;
+    const unsigned long long* words = packed + static_cast<size_t>(blockIdx.y) * (planes + 1);
+    const unsigned long long scalar = words[planes];
+    const float value = static_cast<int>(scalar >> 32) == plane
+            ? __uint_as_float(static_cast<unsigned int>(scalar)) : 1.0f;
+    out[(static_cast<size_t>(blockIdx.y) * planes + plane) * 64 + sq] = ((words[plane] >> sq) & 1ULL) ? value : 0.0f;
+}
+
+/*
+ * Shared body of the nativePredictPacked entry points: validates the arrays, copies `count` packed
+ * positions out of Java once, and evaluates them in maxBatch-sized chunks through
+ *   eval(const unsigned long long* packed, int chunk, float* policy, float* wdl) -> bool
+ * before writing policy/WDL/value back. Returns count, or 0 on failure.
+ */
+template <typename Eval>
+static jint packed_predict_batch(JNIEnv* env, jlongArray packedBatch, jint count, int planes, int maxBatch,
+                                 int policySize, jfloatArray outPolicy, jfloatArray outWdl, jfloatArray outValue,
+                                 Eval&& eval) {
+    if (!packedBatch || !outPolicy || !outWdl || !outValue || count <= 0 || maxBatch <= 0) return 0;
+    const size_t n = static_cast<size_t>(count);
+    const size_t words = static_cast<size_t>(packed_words(planes));
+    const size_t polStride = static_cast<size_t>(policySize);
+    if (static_cast<size_t>(env->GetArrayLength(packedBatch)) < n * words
+            || static_cast<size_t>(env->GetArrayLength(outPolicy)) < n * polStride
+            || static_cast<size_t>(env->GetArrayLength(outWdl)) < n * 3
+            || static_cast<size_t>(env->GetArrayLength(outValue)) < n) {
+        return 0;
+    }
+    std::vector<unsigned long long> packed(n * words);
+    env->GetLongArrayRegion(packedBatch, 0, static_cast<jsize>(packed.size()),
+            reinterpret_cast<jlong*>(packed.data()));
+    std::vector<float> policy(n * polStride);
+    std::vector<float> wdl(n * 3);
+    std::vector<float> values(n);
+    for (size_t off = 0; off < n; off += static_cast<size_t>(maxBatch)) {
+        const int chunk = static_cast<int>(std::min(n - off, static_cast<size_t>(maxBatch)));
+        if (!eval(packed.data() + off * words, chunk, policy.data() + off * polStride, wdl.data() + off * 3)) {
+            return 0;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) values[i] = wdl[i * 3] - wdl[i * 3 + 2];
+    env->SetFloatArrayRegion(outPolicy, 0, static_cast<jsize>(policy.size()), policy.data());
+    env->SetFloatArrayRegion(outWdl, 0, static_cast<jsize>(wdl.size()), wdl.data());
+    env->SetFloatArrayRegion(outValue, 0, static_cast<jsize>(values.size()), values.data());
+    return count;
+}
+
+} // namespace
+
+#endif // CRTK_PACKED_PLANES_IMPL_INL
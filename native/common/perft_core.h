@@ -16,11 +16,19 @@
  *     Chess960 encodes the king move's target as the rook's source square.
  *   - Castling-rights keep-mask is applied to both move endpoints (captured
  *     rook on its home square loses the right).
- *   - Slider attacks use hyperbola quintessence with full 64-bit bit reversal.
+ *   - Slider attacks come from one of three interchangeable backends picked at
+ *     compile time by PERFT_SLIDERS (see "Slider attacks" below); hyperbola
+ *     quintessence with full 64-bit bit reversal is the reference the others
+ *     are checked against.
+ *   - Zobrist keys (Position::key) are native-only: they feed the optional
+ *     transposition-table walkers and never leave the process, so they need
+ *     not match any Java hash.
  *
  * A correct perft needs only: pseudo-move generation + make + "is the mover's
- * king attacked?" + undo. The Java fast-legality shortcuts are performance-only
- * and intentionally omitted here.
+ * king attacked?" + undo, which the recursive perft() keeps as the reference.
+ * The iterative walkers use the strictly legal generator (checkers, pins and
+ * evasion masks up front) and count the last ply by popcount without making
+ * the moves; perft_host_test holds them to the reference.
  */
 #ifndef CRTK_PERFT_CORE_H
 #define CRTK_PERFT_CORE_H
@@ -33,6 +41,37 @@
 #define PERFT_HD
 #endif
 
+// Slider attack backends. GPU and SYCL builds default to fancy magics (the
+// host and device passes must agree on the table order, and neither device
+// has PEXT); host builds with BMI2 default to PEXT; anything else gets magics.
+// Pass -DPERFT_SLIDERS=PERFT_SLIDERS_HYPERBOLA for the table-free reference,
+// or pick MAGIC explicitly on x86 parts where PEXT is microcoded (AMD before
+// Zen 3).
+#define PERFT_SLIDERS_HYPERBOLA 0
+#define PERFT_SLIDERS_MAGIC 1
+#define PERFT_SLIDERS_PEXT 2
+
+#if defined(__CUDACC__) || defined(__HIPCC__) || defined(SYCL_LANGUAGE_VERSION)
+#define PERFT_GPU_COMPILER 1
+#else
+#define PERFT_GPU_COMPILER 0
+#endif
+
+#if defined(__BMI2__) && !PERFT_GPU_COMPILER
+#define PERFT_HAVE_PEXT 1
+#include <immintrin.h>
+#else
+#define PERFT_HAVE_PEXT 0
+#endif
+
+#ifndef PERFT_SLIDERS
+#if PERFT_HAVE_PEXT
+#define PERFT_SLIDERS PERFT_SLIDERS_PEXT
+#else
+#define PERFT_SLIDERS PERFT_SLIDERS_MAGIC
+#endif
+#endif
+
 namespace crtk_perft {
 
 // ---------------------------------------------------------------------------
@@ -79,6 +118,11 @@ PERFT_HD inline int ctz64(uint64_t b) {
 }
 
 PERFT_HD inline uint64_t reverse_bits64(uint64_t v) {
+#if defined(__CUDA_ARCH__) || defined(__HIP_DEVICE_COMPILE__)
+    return (uint64_t) __brevll((unsigned long long) v);
+#elif defined(__clang__)
+    return __builtin_bitreverse64(v);
+#else
     v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
     v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
     v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
@@ -86,6 +130,26 @@ PERFT_HD inline uint64_t reverse_bits64(uint64_t v) {
     v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
     v = (v >> 32) | (v << 32);
     return v;
+#endif
+}
+
+// Parallel bit extract: BMI2 where available, a portable loop otherwise (the
+// loop only serves table construction and tests; PEXT lookups are selected
+// by default only when the instruction exists).
+PERFT_HD inline uint64_t pext64(uint64_t x, uint64_t mask) {
+#if PERFT_HAVE_PEXT
+    return (uint64_t) _pext_u64(x, mask);
+#else
+    uint64_t out = 0;
+    for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+        uint64_t low = mask & (0 - mask);
+        if (x & low) {
+            out |= bit;
+        }
+        mask &= mask - 1;
+    }
+    return out;
+#endif
 }
 
 // Mirror Java "x << 1": shifting the top bit out yields 0 (well-defined for
@@ -110,6 +174,29 @@ PERFT_HD inline bool on_6th_rank(int sq) { return sq >= 16 && sq <= 23; }
 // ---------------------------------------------------------------------------
 // Precomputed attack tables (built once on host, uploaded to device verbatim)
 // ---------------------------------------------------------------------------
+enum class SliderKind : int {
+    Hyperbola = PERFT_SLIDERS_HYPERBOLA,
+    Magic = PERFT_SLIDERS_MAGIC,
+    Pext = PERFT_SLIDERS_PEXT
+};
+
+constexpr SliderKind SLIDERS = (SliderKind) PERFT_SLIDERS;
+
+// Per-square slider lookup: relevant-occupancy mask, magic multiplier, and the
+// square's block within the shared attack array (2^bits entries).
+struct SliderSquare {
+    uint64_t mask;
+    uint64_t magic;
+    uint32_t offset;
+    uint32_t shift; // 64 - bits
+};
+
+// Sum of 2^bits over all squares: 102400 rook + 5248 bishop entries (~840 KB),
+// too big for constant memory, so the array lives in global memory and Tables
+// only carries a pointer to it.
+constexpr int ROOK_ATTACK_WORDS = 102400;
+constexpr int SLIDER_ATTACK_WORDS = ROOK_ATTACK_WORDS + 5248;
+
 struct Tables {
     uint64_t knight[64];
     uint64_t king[64];
@@ -119,8 +206,26 @@ struct Tables {
     uint64_t fileMask[64];
     uint64_t diagMask[64];
     uint64_t antiMask[64];
+    uint64_t zPiece[12][64]; // Zobrist keys, see compute_key
+    uint64_t zCastle[16];
+    uint64_t zEp[64];
+    uint64_t zSide;
+    SliderSquare rookSlider[64];
+    SliderSquare bishopSlider[64];
+    // SLIDER_ATTACK_WORDS entries ordered for SLIDERS; null for HYPERBOLA.
+    // Host pointer after build_tables; device loaders upload the array and
+    // patch this field in the copy they install.
+    const uint64_t* sliderAttacks;
 };
 
+// SplitMix64 step, the fixed-seed generator behind the Zobrist keys.
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
 // Line mask in RAW layout coordinates (row = sq >> 3), mirroring SlidingAttacks.lineMask.
 inline uint64_t line_mask_raw(int sq, int df, int dr) {
     uint64_t out = 0;
@@ -136,6 +241,8 @@ inline uint64_t line_mask_raw(int sq, int df, int dr) {
     return out;
 }
 
+inline void init_sliders(Tables& t);
+
 inline void build_tables(Tables& t) {
     const int knightDeltas[8][2] = {
         {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}
@@ -185,10 +292,27 @@ inline void build_tables(Tables& t) {
         t.diagMask[sq] = line_mask_raw(sq, 1, 1) | line_mask_raw(sq, -1, -1) | self;
         t.antiMask[sq] = line_mask_raw(sq, 1, -1) | line_mask_raw(sq, -1, 1) | self;
     }
+
+    uint64_t seed = 0x43524B5450455246ULL; // fixed, so keys are identical on every device
+    for (int piece = 0; piece < 12; ++piece) {
+        for (int sq = 0; sq < 64; ++sq) {
+            t.zPiece[piece][sq] = splitmix64(seed);
+        }
+    }
+    for (int c = 0; c < 16; ++c) {
+        t.zCastle[c] = splitmix64(seed);
+    }
+    for (int sq = 0; sq < 64; ++sq) {
+        t.zEp[sq] = splitmix64(seed);
+    }
+    t.zSide = splitmix64(seed);
+    init_sliders(t);
 }
 
 // ---------------------------------------------------------------------------
-// Slider attacks (hyperbola quintessence)
+// Slider attacks. hyperbola_* is the table-free reference; the magic and PEXT
+// backends index Tables::sliderAttacks. bishop_attacks / rook_attacks use the
+// compile-time SLIDERS backend; the *_as<K> forms let tests compare them.
 // ---------------------------------------------------------------------------
 PERFT_HD inline uint64_t line_attacks(int sq, uint64_t occ, uint64_t mask) {
     uint64_t bit = 1ULL << sq;
@@ -200,14 +324,171 @@ PERFT_HD inline uint64_t line_attacks(int sq, uint64_t occ, uint64_t mask) {
     return (fwd ^ reverse_bits64(rev)) & mask;
 }
 
-PERFT_HD inline uint64_t bishop_attacks(const Tables& t, int sq, uint64_t occ) {
+PERFT_HD inline uint64_t hyperbola_bishop(const Tables& t, int sq, uint64_t occ) {
     return line_attacks(sq, occ, t.diagMask[sq]) | line_attacks(sq, occ, t.antiMask[sq]);
 }
 
-PERFT_HD inline uint64_t rook_attacks(const Tables& t, int sq, uint64_t occ) {
+PERFT_HD inline uint64_t hyperbola_rook(const Tables& t, int sq, uint64_t occ) {
     return line_attacks(sq, occ, t.rankMask[sq]) | line_attacks(sq, occ, t.fileMask[sq]);
 }
 
+template <SliderKind K>
+PERFT_HD inline uint64_t slider_index(const SliderSquare& s, uint64_t occ) {
+    if (K == SliderKind::Pext) {
+        return pext64(occ, s.mask);
+    }
+    return ((occ & s.mask) * s.magic) >> s.shift;
+}
+
+template <SliderKind K>
+PERFT_HD inline uint64_t bishop_attacks_as(const Tables& t, int sq, uint64_t occ) {
+    if (K == SliderKind::Hyperbola) {
+        return hyperbola_bishop(t, sq, occ);
+    }
+    const SliderSquare& s = t.bishopSlider[sq];
+    return t.sliderAttacks[s.offset + slider_index<K>(s, occ)];
+}
+
+template <SliderKind K>
+PERFT_HD inline uint64_t rook_attacks_as(const Tables& t, int sq, uint64_t occ) {
+    if (K == SliderKind::Hyperbola) {
+        return hyperbola_rook(t, sq, occ);
+    }
+    const SliderSquare& s = t.rookSlider[sq];
+    return t.sliderAttacks[s.offset + slider_index<K>(s, occ)];
+}
+
+PERFT_HD inline uint64_t bishop_attacks(const Tables& t, int sq, uint64_t occ) {
+    return bishop_attacks_as<SLIDERS>(t, sq, occ);
+}
+
+PERFT_HD inline uint64_t rook_attacks(const Tables& t, int sq, uint64_t occ) {
+    return rook_attacks_as<SLIDERS>(t, sq, occ);
+}
+
+// ---------------------------------------------------------------------------
+// Slider table construction (host only). Masks drop the board edge, as usual
+// for magic bitboards; magics come from a fixed-seed sparse random search, so
+// every build and every device sees the same numbers. The reference attack
+// sets are computed with the hyperbola code, which ties the tables to it.
+// ---------------------------------------------------------------------------
+inline uint64_t relevant_mask(uint64_t ray, int sq, uint64_t edges) {
+    return ray & ~edges & ~(1ULL << sq);
+}
+
+inline uint64_t rook_relevant(const Tables& t, int sq) {
+    return relevant_mask(t.rankMask[sq], sq, FILE_A | FILE_H) | relevant_mask(t.fileMask[sq], sq, RANK_1 | RANK_8);
+}
+
+inline uint64_t bishop_relevant(const Tables& t, int sq) {
+    return relevant_mask(t.diagMask[sq] | t.antiMask[sq], sq, FILE_A | FILE_H | RANK_1 | RANK_8);
+}
+
+// Finds a collision-free multiplier for one square (constructive collisions,
+// where two occupancies share an attack set, are allowed).
+inline uint64_t find_magic(const Tables& t, int sq, bool rook, uint64_t mask, int bits, uint64_t& seed) {
+    static uint64_t occs[4096];
+    static uint64_t refs[4096];
+    static uint64_t used[4096];
+    static int epoch[4096];
+    int n = 0;
+    uint64_t sub = 0;
+    do {
+        occs[n] = sub;
+        refs[n] = rook ? hyperbola_rook(t, sq, sub) : hyperbola_bishop(t, sq, sub);
+        ++n;
+        sub = (sub - mask) & mask;
+    } while (sub != 0);
+    for (int i = 0; i < (1 << bits); ++i) {
+        epoch[i] = 0;
+    }
+    for (int attempt = 1;; ++attempt) {
+        uint64_t magic = splitmix64(seed) & splitmix64(seed) & splitmix64(seed);
+        if (__builtin_popcountll((mask * magic) & 0xFF00000000000000ULL) < 6) {
+            continue;
+        }
+        bool ok = true;
+        for (int i = 0; i < n && ok; ++i) {
+            uint64_t idx = (occs[i] * magic) >> (64 - bits);
+            if (epoch[idx] != attempt) {
+                epoch[idx] = attempt;
+                used[idx] = refs[i];
+            } else if (used[idx] != refs[i]) {
+                ok = false;
+            }
+        }
+        if (ok) {
+            return magic;
+        }
+    }
+}
+
+// Fills masks, magics and offsets for both piece types. Needs the line masks.
+inline void build_slider_squares(Tables& t) {
+    uint64_t seed = 0x4D41474943534C44ULL;
+    uint32_t offset = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        bool rook = pass == 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            SliderSquare& s = rook ? t.rookSlider[sq] : t.bishopSlider[sq];
+            s.mask = rook ? rook_relevant(t, sq) : bishop_relevant(t, sq);
+            int bits = __builtin_popcountll(s.mask);
+            s.shift = (uint32_t) (64 - bits);
+            s.offset = offset;
+            s.magic = find_magic(t, sq, rook, s.mask, bits, seed);
+            offset += 1u << bits;
+        }
+    }
+}
+
+// Writes the SLIDER_ATTACK_WORDS attack sets for backend `kind` (MAGIC or
+// PEXT; the two index the same blocks in different orders).
+inline void build_slider_attacks(const Tables& t, SliderKind kind, uint64_t* out) {
+    for (int pass = 0; pass < 2; ++pass) {
+        bool rook = pass == 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            const SliderSquare& s = rook ? t.rookSlider[sq] : t.bishopSlider[sq];
+            uint64_t sub = 0;
+            do {
+                uint64_t idx = kind == SliderKind::Pext ? pext64(sub, s.mask)
+                        : slider_index<SliderKind::Magic>(s, sub);
+                out[s.offset + idx] = rook ? hyperbola_rook(t, sq, sub) : hyperbola_bishop(t, sq, sub);
+                sub = (sub - s.mask) & s.mask;
+            } while (sub != 0);
+        }
+    }
+}
+
+// Process-wide slider layout for SLIDERS, built on first use (the magic search
+// takes a few milliseconds) and shared by every Tables instance.
+struct SliderLayout {
+    SliderSquare rook[64];
+    SliderSquare bishop[64];
+    uint64_t attacks[SLIDER_ATTACK_WORDS];
+};
+
+inline void init_sliders(Tables& t) {
+    t.sliderAttacks = nullptr;
+    if (SLIDERS == SliderKind::Hyperbola) {
+        return;
+    }
+    static const SliderLayout* layout = [&t] {
+        SliderLayout* l = new SliderLayout();
+        build_slider_squares(t);
+        build_slider_attacks(t, SLIDERS, l->attacks);
+        for (int sq = 0; sq < 64; ++sq) {
+            l->rook[sq] = t.rookSlider[sq];
+            l->bishop[sq] = t.bishopSlider[sq];
+        }
+        return l;
+    }();
+    for (int sq = 0; sq < 64; ++sq) {
+        t.rookSlider[sq] = layout->rook[sq];
+        t.bishopSlider[sq] = layout->bishop[sq];
+    }
+    t.sliderAttacks = layout->attacks;
+}
+
 // ---------------------------------------------------------------------------
 // Position + undo state
 // ---------------------------------------------------------------------------
@@ -227,6 +508,7 @@ struct Position {
     int wqRook;
     int bkRook;
     int bqRook;
+    uint64_t key; // Zobrist key; maintained only by make_move<true>, see compute_key
 };
 
 struct Undo {
@@ -242,6 +524,7 @@ struct Undo {
     int rookTo;
     bool castle;
     bool enPassant; // true iff this move was an en-passant capture
+    uint64_t key;
 };
 
 // Detailed leaf-ply counters, mirroring chess.debug.Perft.Stats.
@@ -533,25 +816,34 @@ PERFT_HD inline bool safe_king_castle_path(const Tables& t, const Position& p, i
     return true;
 }
 
-PERFT_HD inline void add_castle(const Tables& t, const Position& p, MoveList& ml, bool white, int right) {
-    if (!(p.castling & right)) return;
+// Encoded target of the castling move for `right`, or NO_SQUARE when the
+// pseudo-legal castling conditions fail.
+PERFT_HD inline int castle_target(const Tables& t, const Position& p, bool white, int right) {
+    if (!(p.castling & right)) return NO_SQUARE;
     int kingFrom = white ? p.wk : p.bk;
     int rookFrom = castling_rook_square(p, right);
     int kingTo = castling_king_target(right);
     int rookTo = castling_rook_target(right);
-    if (kingFrom == NO_SQUARE || rookFrom == NO_SQUARE) return;
-    if (p.board[kingFrom] != (white ? WK : BK)) return;
-    if (p.board[rookFrom] != (white ? WR : BR)) return;
-    if (!valid_castle_geometry(white, right, kingFrom, rookFrom)) return;
-    if (square_attacked(t, p, kingFrom, !white, p.occ, 0ULL)) return;
+    if (kingFrom == NO_SQUARE || rookFrom == NO_SQUARE) return NO_SQUARE;
+    if (p.board[kingFrom] != (white ? WK : BK)) return NO_SQUARE;
+    if (p.board[rookFrom] != (white ? WR : BR)) return NO_SQUARE;
+    if (!valid_castle_geometry(white, right, kingFrom, rookFrom)) return NO_SQUARE;
+    if (square_attacked(t, p, kingFrom, !white, p.occ, 0ULL)) return NO_SQUARE;
 
     uint64_t emptyMask = (between_inclusive(kingFrom, kingTo)
             | between_inclusive(kingFrom, rookFrom)
             | between_inclusive(rookFrom, rookTo))
             & ~(1ULL << kingFrom) & ~(1ULL << rookFrom);
-    if (p.occ & emptyMask) return;
-    if (!safe_king_castle_path(t, p, kingFrom, kingTo, !white)) return;
-    push_move(ml, kingFrom, castling_move_target(p, right), PROMO_NONE);
+    if (p.occ & emptyMask) return NO_SQUARE;
+    if (!safe_king_castle_path(t, p, kingFrom, kingTo, !white)) return NO_SQUARE;
+    return castling_move_target(p, right);
+}
+
+PERFT_HD inline void add_castle(const Tables& t, const Position& p, MoveList& ml, bool white, int right) {
+    int to = castle_target(t, p, white, right);
+    if (to != NO_SQUARE) {
+        push_move(ml, white ? p.wk : p.bk, to, PROMO_NONE);
+    }
 }
 
 PERFT_HD inline void generate_pseudo_moves(const Tables& t, const Position& p, MoveList& ml) {
@@ -590,6 +882,9 @@ PERFT_HD inline int next_en_passant_square(const Tables& t, const Position& p, b
     return (attackers & enemyPawns) == 0ULL ? NO_SQUARE : target;
 }
 
+// HASH = true also updates p.key incrementally; the plain counters skip the
+// Zobrist lookups entirely. undo_move restores the key either way.
+template <bool HASH = false>
 PERFT_HD inline void make_move(const Tables& t, Position& p, uint16_t move, Undo& u) {
     int from = move & 0x3F;
     int to = (move >> 6) & 0x3F;
@@ -616,6 +911,17 @@ PERFT_HD inline void make_move(const Tables& t, Position& p, uint16_t move, Undo
     u.rookTo = NO_SQUARE;
     u.castle = false;
     u.enPassant = false;
+    u.key = p.key;
+    uint64_t key = p.key;
+    if (HASH) {
+        key ^= t.zPiece[moving][from] ^ t.zCastle[p.castling] ^ t.zSide;
+        if (p.ep != NO_SQUARE) {
+            key ^= t.zEp[p.ep];
+        }
+        if (captured >= 0) {
+            key ^= t.zPiece[captured][actualTo];
+        }
+    }
 
     if (p.castling != 0) {
         p.castling &= castling_keep_for_square(p, from) & castling_keep_for_square(p, to);
@@ -633,6 +939,9 @@ PERFT_HD inline void make_move(const Tables& t, Position& p, uint16_t move, Undo
         u.capturedSquare = capSq;
         u.enPassant = true;
         clear_piece(p, capPiece, capSq);
+        if (HASH) {
+            key ^= t.zPiece[capPiece][capSq];
+        }
     }
 
     int delta = actualTo - from;
@@ -646,6 +955,9 @@ PERFT_HD inline void make_move(const Tables& t, Position& p, uint16_t move, Undo
         u.rookTo = rookTo;
         u.castle = true;
         move_piece(p, rook, rookFrom, rookTo);
+        if (HASH) {
+            key ^= t.zPiece[rook][rookFrom] ^ t.zPiece[rook][rookTo];
+        }
     }
 
     int placed = (promo == 0) ? moving : promotion_piece_index(moving, promo);
@@ -653,6 +965,13 @@ PERFT_HD inline void make_move(const Tables& t, Position& p, uint16_t move, Undo
 
     p.ep = next_en_passant_square(t, p, pawnMove, delta, from, actualTo, white);
     p.whiteToMove = !p.whiteToMove;
+    if (HASH) {
+        key ^= t.zPiece[placed][actualTo] ^ t.zCastle[p.castling];
+        if (p.ep != NO_SQUARE) {
+            key ^= t.zEp[p.ep];
+        }
+        p.key = key;
+    }
 }
 
 PERFT_HD inline void undo_move(Position& p, uint16_t move, const Undo& u) {
@@ -716,10 +1035,241 @@ PERFT_HD inline void undo_move(Position& p, uint16_t move, const Undo& u) {
     p.castling = u.castling;
     p.ep = u.ep;
     p.whiteToMove = u.whiteToMove;
+    p.key = u.key;
+}
+
+// ---------------------------------------------------------------------------
+// Strictly legal generation. Checkers, pins and the check-evasion mask are
+// computed up front, so every emitted move is legal without make/undo; only
+// en passant (the two-pawn rank discovery) and castling (the Chess960 rook
+// leaving its square) are still verified by make + king_attacked + undo, which
+// keeps them exactly equal to the pseudo-legal reference. The generator feeds
+// a sink, so the same code either fills a MoveList or just counts (popcount of
+// target sets), which is what bulk leaf counting at depth 1 uses. A side
+// without a king gets every pseudo-legal move, as the reference does.
+// ---------------------------------------------------------------------------
+PERFT_HD inline int popcount64(uint64_t b) {
+#if defined(__CUDA_ARCH__) || defined(__HIP_DEVICE_COMPILE__)
+    return __popcll((unsigned long long) b);
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Pieces of side `byWhite` attacking `sq` under occupancy `occ`.
+PERFT_HD inline uint64_t attackers_to(const Tables& t, const Position& p, int sq, bool byWhite, uint64_t occ) {
+    int base = byWhite ? WP : BP;
+    uint64_t queens = p.pieces[base + 4];
+    return ((byWhite ? t.bPawn[sq] : t.wPawn[sq]) & p.pieces[base])
+            | (t.knight[sq] & p.pieces[base + 1])
+            | (t.king[sq] & p.pieces[base + 5])
+            | (bishop_attacks(t, sq, occ) & (p.pieces[base + 2] | queens))
+            | (rook_attacks(t, sq, occ) & (p.pieces[base + 3] | queens));
+}
+
+// Squares strictly between two aligned squares (0 when not aligned).
+PERFT_HD inline uint64_t squares_between(const Tables& t, int a, int b) {
+    uint64_t aBit = 1ULL << a;
+    uint64_t bBit = 1ULL << b;
+    uint64_t r = rook_attacks(t, a, bBit);
+    if (r & bBit) {
+        return r & rook_attacks(t, b, aBit);
+    }
+    uint64_t d = bishop_attacks(t, a, bBit);
+    if (d & bBit) {
+        return d & bishop_attacks(t, b, aBit);
+    }
+    return 0ULL;
+}
+
+// Full line through the king and a piece pinned to it (the pinned piece may
+// move anywhere on it that its own attacks reach).
+PERFT_HD inline uint64_t pin_line(const Tables& t, int king, int sq) {
+    uint64_t bit = 1ULL << sq;
+    uint64_t r = rook_attacks(t, king, 0ULL);
+    if (r & bit) {
+        return (r & rook_attacks(t, sq, 0ULL)) | bit;
+    }
+    return (bishop_attacks(t, king, 0ULL) & bishop_attacks(t, sq, 0ULL)) | bit;
+}
+
+// Our pieces pinned against `king` by enemy sliders.
+PERFT_HD inline uint64_t pinned_pieces(const Tables& t, const Position& p, int king, bool white) {
+    uint64_t own = white ? p.whiteOcc : p.blackOcc;
+    uint64_t enemy = white ? p.blackOcc : p.whiteOcc;
+    int base = white ? BP : WP;
+    uint64_t queens = p.pieces[base + 4];
+    uint64_t snipers = (rook_attacks(t, king, enemy) & (p.pieces[base + 3] | queens))
+            | (bishop_attacks(t, king, enemy) & (p.pieces[base + 2] | queens));
+    uint64_t pinned = 0;
+    while (snipers) {
+        int s = ctz64(snipers);
+        snipers &= snipers - 1;
+        uint64_t blockers = squares_between(t, king, s) & p.occ;
+        if (blockers != 0 && (blockers & (blockers - 1)) == 0 && (blockers & own)) {
+            pinned |= blockers;
+        }
+    }
+    return pinned;
+}
+
+// Sink that fills a MoveList (same encoding and promotion order as the
+// pseudo-legal generator).
+struct MoveListSink {
+    MoveList& ml;
+
+    PERFT_HD void move(int from, int to) { push_move(ml, from, to, PROMO_NONE); }
+    PERFT_HD void targets(int from, uint64_t bb) { add_targets(ml, from, bb); }
+    PERFT_HD void pawns(uint64_t bb, int fromOffset, bool white) { add_pawn_targets(ml, bb, fromOffset, white); }
+};
+
+// Sink that only counts; a promotion target counts four moves.
+struct CountSink {
+    uint64_t n;
+
+    PERFT_HD void move(int, int) { ++n; }
+    PERFT_HD void targets(int, uint64_t bb) { n += (uint64_t) popcount64(bb); }
+    PERFT_HD void pawns(uint64_t bb, int, bool white) {
+        uint64_t promo = white ? RANK_8 : RANK_1;
+        n += (uint64_t) popcount64(bb & ~promo) + 4ULL * (uint64_t) popcount64(bb & promo);
+    }
+};
+
+// Pushes and captures (no en passant) for `pawns`, restricted to `allowed`.
+template <class Sink>
+PERFT_HD inline void legal_pawn_moves(const Position& p, uint64_t pawns, uint64_t allowed, bool white,
+        Sink& out) {
+    uint64_t empty = ~p.occ;
+    if (white) {
+        uint64_t enemies = p.blackOcc & ~p.pieces[BK] & allowed;
+        uint64_t single = (pawns >> 8) & empty;
+        out.pawns(single & allowed, 8, true);
+        out.pawns(((single & RANK_3) >> 8) & empty & allowed, 16, true);
+        out.pawns(((pawns & ~FILE_A) >> 9) & enemies, 9, true);
+        out.pawns(((pawns & ~FILE_H) >> 7) & enemies, 7, true);
+    } else {
+        uint64_t enemies = p.whiteOcc & ~p.pieces[WK] & allowed;
+        uint64_t single = (pawns << 8) & empty;
+        out.pawns(single & allowed, -8, false);
+        out.pawns(((single & RANK_6) << 8) & empty & allowed, -16, false);
+        out.pawns(((pawns & ~FILE_A) << 7) & enemies, -7, false);
+        out.pawns(((pawns & ~FILE_H) << 9) & enemies, -9, false);
+    }
+}
+
+// Emits `move` when making it leaves the mover's king safe (p is restored).
+template <class Sink>
+PERFT_HD inline void verified_move(const Tables& t, Position& p, int from, int to, bool white, Sink& out) {
+    uint16_t move = encode_move(from, to, PROMO_NONE);
+    Undo u;
+    make_move(t, p, move, u);
+    bool legal = !king_attacked(t, p, white);
+    undo_move(p, move, u);
+    if (legal) {
+        out.move(from, to);
+    }
+}
+
+template <class Sink>
+PERFT_HD inline void generate_legal(const Tables& t, Position& p, Sink& out) {
+    bool white = p.whiteToMove;
+    int base = white ? WP : BP;
+    uint64_t own = white ? p.whiteOcc : p.blackOcc;
+    uint64_t open = ~own & ~p.pieces[white ? BK : WK];
+    int king = white ? p.wk : p.bk;
+    uint64_t evasion = ~0ULL;
+    uint64_t pinned = 0;
+
+    if (king != NO_SQUARE) {
+        uint64_t occNoKing = p.occ & ~(1ULL << king);
+        uint64_t kt = t.king[king] & open;
+        while (kt) {
+            int to = ctz64(kt);
+            kt &= kt - 1;
+            if (!square_attacked(t, p, to, !white, occNoKing, 0ULL)) {
+                out.move(king, to);
+            }
+        }
+        uint64_t checkers = attackers_to(t, p, king, !white, p.occ);
+        if (checkers & (checkers - 1)) {
+            return; // double check: king moves only
+        }
+        if (checkers) {
+            evasion = squares_between(t, king, ctz64(checkers)) | checkers;
+        }
+        pinned = pinned_pieces(t, p, king, white);
+    }
+    uint64_t allowed = open & evasion;
+
+    uint64_t pawns = p.pieces[base];
+    legal_pawn_moves(p, pawns & ~pinned, allowed, white, out);
+    uint64_t pinnedPawns = pawns & pinned;
+    while (pinnedPawns) {
+        int from = ctz64(pinnedPawns);
+        pinnedPawns &= pinnedPawns - 1;
+        legal_pawn_moves(p, 1ULL << from, allowed & pin_line(t, king, from), white, out);
+    }
+
+    uint64_t knights = p.pieces[base + 1] & ~pinned; // a pinned knight never moves
+    while (knights) {
+        int from = ctz64(knights);
+        knights &= knights - 1;
+        out.targets(from, t.knight[from] & allowed);
+    }
+    for (int piece = base + 2; piece <= base + 4; ++piece) {
+        uint64_t sliders = p.pieces[piece];
+        while (sliders) {
+            int from = ctz64(sliders);
+            sliders &= sliders - 1;
+            uint64_t targets = 0;
+            if (piece != base + 3) targets |= bishop_attacks(t, from, p.occ);
+            if (piece != base + 2) targets |= rook_attacks(t, from, p.occ);
+            targets &= allowed;
+            if (pinned & (1ULL << from)) {
+                targets &= pin_line(t, king, from);
+            }
+            out.targets(from, targets);
+        }
+    }
+
+    uint64_t ep = en_passant_mask(p, white);
+    if (ep) {
+        int epSq = ctz64(ep);
+        uint64_t takers = (white ? t.bPawn[epSq] : t.wPawn[epSq]) & pawns;
+        while (takers) {
+            int from = ctz64(takers);
+            takers &= takers - 1;
+            verified_move(t, p, from, epSq, white, out);
+        }
+    }
+
+    int rights = p.castling & (white ? (CASTLE_WK | CASTLE_WQ) : (CASTLE_BK | CASTLE_BQ));
+    if (rights && evasion == ~0ULL) {
+        int first = white ? CASTLE_WK : CASTLE_BK;
+        for (int right = first; right <= first * 2; right *= 2) {
+            int to = castle_target(t, p, white, right);
+            if (to != NO_SQUARE) {
+                verified_move(t, p, king, to, white, out);
+            }
+        }
+    }
+}
+
+PERFT_HD inline void generate_legal_moves(const Tables& t, Position& p, MoveList& ml) {
+    ml.count = 0;
+    MoveListSink sink{ml};
+    generate_legal(t, p, sink);
+}
+
+PERFT_HD inline uint64_t count_legal_moves(const Tables& t, Position& p) {
+    CountSink sink{0};
+    generate_legal(t, p, sink);
+    return sink.n;
 }
 
 // ---------------------------------------------------------------------------
-// Perft (recursive; host + small-depth device use)
+// Perft (recursive reference: pseudo-legal generation + make + king_attacked
+// + undo, the contract every faster walker below is checked against)
 // ---------------------------------------------------------------------------
 PERFT_HD inline uint64_t perft(const Tables& t, Position& p, int depth) {
     if (depth == 0) return 1ULL;
@@ -744,20 +1294,23 @@ PERFT_HD inline uint64_t perft(const Tables& t, Position& p, int depth) {
 // ---------------------------------------------------------------------------
 constexpr int MAX_PERFT_DEPTH = 16;
 
-PERFT_HD inline uint64_t perft_iter(const Tables& t, Position& p, int depth) {
+// FRAMES bounds the explicit stack (one MoveList + Undo per ply, ~0.5 KB each),
+// so kernels that only count shallow remainders can instantiate a small frame
+// count and keep per-thread local memory low. Depths above FRAMES return 0.
+template <int FRAMES>
+PERFT_HD inline uint64_t perft_iter_frames(const Tables& t, Position& p, int depth) {
     if (depth <= 0) return 1ULL;
-    if (depth > MAX_PERFT_DEPTH) return 0ULL; // guard; perft this deep is infeasible per thread
+    if (depth > FRAMES) return 0ULL; // guard; perft this deep is infeasible per thread
+    if (depth == 1) return count_legal_moves(t, p);
 
-    MoveList ml[MAX_PERFT_DEPTH];
-    Undo undo[MAX_PERFT_DEPTH];
-    int idx[MAX_PERFT_DEPTH];
-    bool white[MAX_PERFT_DEPTH];
+    MoveList ml[FRAMES];
+    Undo undo[FRAMES];
+    int idx[FRAMES];
 
     uint64_t nodes = 0;
     int sp = 0;
-    generate_pseudo_moves(t, p, ml[0]);
+    generate_legal_moves(t, p, ml[0]);
     idx[0] = 0;
-    white[0] = p.whiteToMove;
 
     for (;;) {
         if (idx[sp] >= ml[sp].count) {
@@ -769,44 +1322,30 @@ PERFT_HD inline uint64_t perft_iter(const Tables& t, Position& p, int depth) {
         }
         uint16_t move = ml[sp].moves[idx[sp]];
         make_move(t, p, move, undo[sp]);
-        if (king_attacked(t, p, white[sp])) {
-            undo_move(p, move, undo[sp]);
-            ++idx[sp];
-            continue;
-        }
-        if (sp == depth - 1) {
-            ++nodes;
+        if (sp == depth - 2) {
+            // Bulk leaf count: the last ply is counted, never made.
+            nodes += count_legal_moves(t, p);
             undo_move(p, move, undo[sp]);
             ++idx[sp];
             continue;
         }
         ++sp;
-        generate_pseudo_moves(t, p, ml[sp]);
+        generate_legal_moves(t, p, ml[sp]);
         idx[sp] = 0;
-        white[sp] = p.whiteToMove;
     }
     return nodes;
 }
 
+PERFT_HD inline uint64_t perft_iter(const Tables& t, Position& p, int depth) {
+    return perft_iter_frames<MAX_PERFT_DEPTH>(t, p, depth);
+}
+
 // ---------------------------------------------------------------------------
 // Detailed perft (per-leaf classification: captures, ep, castles, promotions,
 // checks, checkmates) mirroring chess.debug.Perft
 // ---------------------------------------------------------------------------
 PERFT_HD inline bool has_legal_move(const Tables& t, Position& p) {
-    MoveList ml;
-    generate_pseudo_moves(t, p, ml);
-    bool white = p.whiteToMove;
-    for (int i = 0; i < ml.count; ++i) {
-        uint16_t move = ml.moves[i];
-        Undo u;
-        make_move(t, p, move, u);
-        bool legal = !king_attacked(t, p, white);
-        undo_move(p, move, u);
-        if (legal) {
-            return true;
-        }
-    }
-    return false;
+    return count_legal_moves(t, p) != 0;
 }
 
 PERFT_HD inline void classify_leaf(const Tables& t, Position& p, uint16_t move, const Undo& u,
@@ -833,7 +1372,8 @@ PERFT_HD inline void classify_leaf(const Tables& t, Position& p, uint16_t move,
     }
 }
 
-PERFT_HD inline void perft_detailed_iter(const Tables& t, Position& p, int depth, PerftCounts& out) {
+template <int FRAMES>
+PERFT_HD inline void perft_detailed_iter_frames(const Tables& t, Position& p, int depth, PerftCounts& out) {
     out.nodes = 0;
     out.captures = 0;
     out.enPassant = 0;
@@ -845,19 +1385,17 @@ PERFT_HD inline void perft_detailed_iter(const Tables& t, Position& p, int depth
         out.nodes = 1;
         return;
     }
-    if (depth > MAX_PERFT_DEPTH) {
+    if (depth > FRAMES) {
         return;
     }
 
-    MoveList ml[MAX_PERFT_DEPTH];
-    Undo undo[MAX_PERFT_DEPTH];
-    int idx[MAX_PERFT_DEPTH];
-    bool white[MAX_PERFT_DEPTH];
+    MoveList ml[FRAMES];
+    Undo undo[FRAMES];
+    int idx[FRAMES];
 
     int sp = 0;
-    generate_pseudo_moves(t, p, ml[0]);
+    generate_legal_moves(t, p, ml[0]);
     idx[0] = 0;
-    white[0] = p.whiteToMove;
 
     for (;;) {
         if (idx[sp] >= ml[sp].count) {
@@ -871,22 +1409,221 @@ PERFT_HD inline void perft_detailed_iter(const Tables& t, Position& p, int depth
         }
         uint16_t move = ml[sp].moves[idx[sp]];
         make_move(t, p, move, undo[sp]);
-        if (king_attacked(t, p, white[sp])) {
+        if (sp == depth - 1) {
+            classify_leaf(t, p, move, undo[sp], out);
             undo_move(p, move, undo[sp]);
             ++idx[sp];
             continue;
         }
-        if (sp == depth - 1) {
-            classify_leaf(t, p, move, undo[sp], out);
+        ++sp;
+        generate_legal_moves(t, p, ml[sp]);
+        idx[sp] = 0;
+    }
+}
+
+PERFT_HD inline void perft_detailed_iter(const Tables& t, Position& p, int depth, PerftCounts& out) {
+    perft_detailed_iter_frames<MAX_PERFT_DEPTH>(t, p, depth, out);
+}
+
+// ---------------------------------------------------------------------------
+// Root-split perft: `lanes` cooperating threads share one position. Lane l
+// takes legal root moves l, l + lanes, ... and counts the subtree below each
+// with a FRAMES-deep stack, so summing every lane's share gives exactly
+// perft(depth). No lane waits on another (each regenerates the root list),
+// which keeps the split barrier-free and identical under host emulation.
+// Requires depth >= 1.
+// ---------------------------------------------------------------------------
+template <int FRAMES>
+PERFT_HD inline uint64_t perft_root_share(const Tables& t, Position& p, int depth, int lane, int lanes) {
+    MoveList ml;
+    generate_legal_moves(t, p, ml);
+    if (depth == 1) {
+        return lane < ml.count ? (uint64_t) ((ml.count - lane + lanes - 1) / lanes) : 0ULL;
+    }
+    uint64_t nodes = 0;
+    for (int i = lane; i < ml.count; i += lanes) {
+        uint16_t move = ml.moves[i];
+        Undo u;
+        make_move(t, p, move, u);
+        nodes += perft_iter_frames<FRAMES>(t, p, depth - 1);
+        undo_move(p, move, u);
+    }
+    return nodes;
+}
+
+// Detailed counterpart of perft_root_share; adds this lane's share into `out`.
+template <int FRAMES>
+PERFT_HD inline void perft_detailed_root_share(const Tables& t, Position& p, int depth, int lane, int lanes,
+        PerftCounts& out) {
+    MoveList ml;
+    generate_legal_moves(t, p, ml);
+    for (int i = lane; i < ml.count; i += lanes) {
+        uint16_t move = ml.moves[i];
+        Undo u;
+        make_move(t, p, move, u);
+        if (depth == 1) {
+            classify_leaf(t, p, move, u, out);
+        } else {
+            PerftCounts c;
+            perft_detailed_iter_frames<FRAMES>(t, p, depth - 1, c);
+            out.nodes += c.nodes;
+            out.captures += c.captures;
+            out.enPassant += c.enPassant;
+            out.castles += c.castles;
+            out.promotions += c.promotions;
+            out.checks += c.checks;
+            out.checkmates += c.checkmates;
+        }
+        undo_move(p, move, u);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Transposition-table perft. compute_key derives the Zobrist key from scratch;
+// make_move<true> keeps it current. The Chess960 rook squares never change
+// during a game but do change castling semantics, so they are folded into
+// the key here rather than updated per move.
+// ---------------------------------------------------------------------------
+PERFT_HD inline uint64_t compute_key(const Tables& t, const Position& p) {
+    uint64_t key = 0;
+    for (int piece = 0; piece < 12; ++piece) {
+        uint64_t bb = p.pieces[piece];
+        while (bb) {
+            key ^= t.zPiece[piece][ctz64(bb)];
+            bb &= bb - 1;
+        }
+    }
+    key ^= t.zCastle[p.castling & 0xF];
+    if (p.ep != NO_SQUARE) {
+        key ^= t.zEp[p.ep];
+    }
+    if (!p.whiteToMove) {
+        key ^= t.zSide;
+    }
+    if (p.chess960) {
+        uint64_t rooks = ((uint64_t) (p.wkRook & 0xFF) | (uint64_t) (p.wqRook & 0xFF) << 8
+                | (uint64_t) (p.bkRook & 0xFF) << 16 | (uint64_t) (p.bqRook & 0xFF) << 24) + 1;
+        key ^= rooks * 0x9E3779B97F4A7C15ULL;
+    }
+    return key;
+}
+
+// One table slot. `data` packs (nodes << 8) | depth and `check` holds
+// key ^ data, so a slot torn by two racing writers fails verification and
+// reads as a miss instead of returning a foreign count. Depth 0 never occurs
+// in a stored slot, so an all-zero slot is empty.
+struct PerftTTEntry {
+    uint64_t check;
+    uint64_t data;
+};
+
+PERFT_HD inline uint64_t tt_pack(uint64_t nodes, int depth) {
+    return (nodes << 8) | (uint64_t) (depth & 0xFF);
+}
+
+PERFT_HD inline int tt_depth(uint64_t data) {
+    return (int) (data & 0xFF);
+}
+
+PERFT_HD inline uint64_t tt_nodes(uint64_t data) {
+    return data >> 8;
+}
+
+// Whether a slot read as (check, data) holds `key` at exactly `depth`.
+PERFT_HD inline bool tt_match(uint64_t check, uint64_t data, uint64_t key, int depth) {
+    return data != 0 && (check ^ data) == key && tt_depth(data) == depth;
+}
+
+// Replacement policy shared by every table: take empty or foreign slots, and
+// keep a same-position entry unless the new one is at least as deep.
+PERFT_HD inline bool tt_replace(uint64_t check, uint64_t data, uint64_t key, int depth) {
+    return data == 0 || (check ^ data) != key || tt_depth(data) <= depth;
+}
+
+// Subtrees shallower than this are recounted rather than cached: a depth-1
+// entry costs a global-memory round trip to save one bulk legal count.
+constexpr int TT_MIN_DEPTH = 2;
+
+// perft_iter_frames with a transposition table. TT supplies
+//   bool probe(uint64_t key, int depth, uint64_t& nodes);
+//   void store(uint64_t key, int depth, uint64_t nodes);
+// (atomics and statistics are the caller's business). Every position with at
+// least TT_MIN_DEPTH plies left is probed before it is expanded and stored
+// once its subtree is counted. p.key must be current (compute_key).
+template <int FRAMES, class TT>
+PERFT_HD inline uint64_t perft_tt_iter_frames(const Tables& t, Position& p, int depth, TT& tt) {
+    if (depth <= 0) return 1ULL;
+    if (depth > FRAMES) return 0ULL;
+    if (depth == 1) return count_legal_moves(t, p);
+    uint64_t hit = 0;
+    if (depth >= TT_MIN_DEPTH && tt.probe(p.key, depth, hit)) {
+        return hit;
+    }
+
+    MoveList ml[FRAMES];
+    Undo undo[FRAMES];
+    int idx[FRAMES];
+    uint64_t nodes[FRAMES];
+
+    int sp = 0;
+    generate_legal_moves(t, p, ml[0]);
+    idx[0] = 0;
+    nodes[0] = 0;
+
+    for (;;) {
+        if (idx[sp] >= ml[sp].count) {
+            // p is the frame's own position again: cache its finished subtree.
+            if (depth - sp >= TT_MIN_DEPTH) {
+                tt.store(p.key, depth - sp, nodes[sp]);
+            }
+            if (sp == 0) break;
+            --sp;
+            nodes[sp] += nodes[sp + 1];
+            undo_move(p, ml[sp].moves[idx[sp]], undo[sp]);
+            ++idx[sp];
+            continue;
+        }
+        uint16_t move = ml[sp].moves[idx[sp]];
+        make_move<true>(t, p, move, undo[sp]);
+        int left = depth - sp - 1;
+        if (left == 1) {
+            nodes[sp] += count_legal_moves(t, p);
+            undo_move(p, move, undo[sp]);
+            ++idx[sp];
+            continue;
+        }
+        if (left >= TT_MIN_DEPTH && tt.probe(p.key, left, hit)) {
+            nodes[sp] += hit;
             undo_move(p, move, undo[sp]);
             ++idx[sp];
             continue;
         }
         ++sp;
-        generate_pseudo_moves(t, p, ml[sp]);
+        generate_legal_moves(t, p, ml[sp]);
         idx[sp] = 0;
-        white[sp] = p.whiteToMove;
+        nodes[sp] = 0;
     }
+    return nodes[0];
+}
+
+// perft_root_share with a transposition table below the root moves.
+template <int FRAMES, class TT>
+PERFT_HD inline uint64_t perft_tt_root_share(const Tables& t, Position& p, int depth, int lane, int lanes,
+        TT& tt) {
+    MoveList ml;
+    generate_legal_moves(t, p, ml);
+    if (depth == 1) {
+        return lane < ml.count ? (uint64_t) ((ml.count - lane + lanes - 1) / lanes) : 0ULL;
+    }
+    uint64_t nodes = 0;
+    for (int i = lane; i < ml.count; i += lanes) {
+        uint16_t move = ml.moves[i];
+        Undo u;
+        make_move<true>(t, p, move, u);
+        nodes += perft_tt_iter_frames<FRAMES>(t, p, depth - 1, tt);
+        undo_move(p, move, u);
+    }
+    return nodes;
 }
 
 // ---------------------------------------------------------------------------
@@ -953,6 +1690,7 @@ PERFT_HD inline void unpack_position(const uint64_t* words, Position& p) {
         }
     }
     p.occ = p.whiteOcc | p.blackOcc;
+    p.key = 0;
     p.wk = p.pieces[WK] ? ctz64(p.pieces[WK]) : NO_SQUARE;
     p.bk = p.pieces[BK] ? ctz64(p.pieces[BK]) : NO_SQUARE;
 
@@ -0,0 +1,168 @@
+/*
+ * native/common/perft_frontier.h
+ *
+ * Host-side split-depth frontier expansion with duplicate folding, shared by
+ * every native perft backend (CUDA, ROCm, oneAPI and host).
+ *
+ * The Java driver used to expand the tree to the split depth and ship every
+ * frontier node, including the many identical positions that transposed move
+ * orders reach (1.e4 e5 2.Nf3 and 1.Nf3 e5 2.e4 meet at ply 3). folded_perft
+ * takes the packed root instead, walks the split plies with the perft_core.h
+ * generator (leaving at least one ply below them), and folds equal frontier positions into (position, multiplicity)
+ * pairs in an open-addressing table keyed by the packed words. Only the unique
+ * positions go to the backend's bulk counter; each count is then weighted by
+ * its multiplicity. Two frontier nodes fold only when all PACK_WORDS words
+ * match, so the result is exact: perft below a position depends on nothing
+ * the packed form leaves out. Detailed counters are leaf classifications, so
+ * they fold the same way as long as at least one ply remains below the split.
+ *
+ * Expansion runs on the host for every backend; it is JNI-free and owns no
+ * device state.
+ */
+
+#ifndef CRTK_PERFT_FRONTIER_H
+#define CRTK_PERFT_FRONTIER_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "perft_core.h"
+
+namespace crtk_perft {
+
+// Trailing entries folded_perft appends after the counters.
+constexpr int FOLD_STATS = 2; // {frontier positions reached, unique positions}
+
+// Host copy of the attack tables for frontier expansion, built on first use
+// and shared by every caller in the process.
+inline const Tables& host_tables() {
+    static const Tables* tables = [] {
+        Tables* t = new Tables;
+        build_tables(*t);
+        return t;
+    }();
+    return *tables;
+}
+
+// Unique frontier positions in first-reached order with their multiplicities.
+struct FoldedFrontier {
+    std::vector<uint64_t> packed; // PACK_WORDS per unique position
+    std::vector<int64_t> weight;  // times each unique position was reached
+    std::vector<int32_t> slots;   // index into weight, -1 = empty
+    int64_t reached = 0;          // frontier size before folding
+
+    int count() const { return (int) weight.size(); }
+};
+
+inline uint64_t frontier_hash(const uint64_t* words) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < PACK_WORDS; ++i) {
+        h = (h ^ words[i]) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+// Doubles the slot table and reinserts every unique position.
+inline void fold_grow(FoldedFrontier& f) {
+    size_t size = f.slots.empty() ? 1024 : f.slots.size() * 2;
+    f.slots.assign(size, -1);
+    const size_t mask = size - 1;
+    for (int i = 0; i < f.count(); ++i) {
+        size_t s = (size_t) frontier_hash(&f.packed[(size_t) i * PACK_WORDS]) & mask;
+        while (f.slots[s] >= 0) {
+            s = (s + 1) & mask;
+        }
+        f.slots[s] = i;
+    }
+}
+
+// Adds one frontier position, folding it into an equal one already present.
+inline void fold_insert(FoldedFrontier& f, const uint64_t* words) {
+    ++f.reached;
+    if ((f.weight.size() + 1) * 2 > f.slots.size()) {
+        fold_grow(f);
+    }
+    const size_t mask = f.slots.size() - 1;
+    size_t s = (size_t) frontier_hash(words) & mask;
+    for (; f.slots[s] >= 0; s = (s + 1) & mask) {
+        const uint64_t* seen = &f.packed[(size_t) f.slots[s] * PACK_WORDS];
+        if (std::memcmp(seen, words, PACK_WORDS * sizeof(uint64_t)) == 0) {
+            ++f.weight[(size_t) f.slots[s]];
+            return;
+        }
+    }
+    f.slots[s] = f.count();
+    f.packed.insert(f.packed.end(), words, words + PACK_WORDS);
+    f.weight.push_back(1);
+}
+
+// Walks `depth` legal plies below p and folds every position reached.
+inline void expand_folded(const Tables& t, Position& p, int depth, FoldedFrontier& f) {
+    if (depth == 0) {
+        uint64_t words[PACK_WORDS];
+        pack_position(p, words);
+        fold_insert(f, words);
+        return;
+    }
+    MoveList ml;
+    generate_legal_moves(t, p, ml);
+    for (int i = 0; i < ml.count; ++i) {
+        Undo u;
+        make_move(t, p, ml.moves[i], u);
+        expand_folded(t, p, depth - 1, f);
+        undo_move(p, ml.moves[i], u);
+    }
+}
+
+// Plies left below the frontier for folded_perft: the split is clamped to
+// [0, depth - 1] so at least one ply is counted per unique position.
+inline int folded_remaining(int depth, int split) {
+    if (depth <= 0) return 0;
+    if (split > depth - 1) split = depth - 1;
+    if (split < 0) split = 0;
+    return depth - split;
+}
+
+// Counts perft(depth) below the packed root: expands depth - folded_remaining
+// plies, folds duplicates, and calls
+//   bulk(const uint64_t* packed, int count, int remaining, int64_t* counts) -> bool
+// once on the unique positions (counts receives `fields` entries per position).
+// Writes fields weighted totals (1 for nodes, 7 for detailed) followed by the
+// FOLD_STATS entries to out. Returns false when bulk fails.
+template <class Bulk>
+inline bool folded_perft(const uint64_t* rootWords, int depth, int split, int fields, Bulk&& bulk, int64_t* out) {
+    std::memset(out, 0, (size_t) (fields + FOLD_STATS) * sizeof(int64_t));
+    if (depth <= 0) {
+        out[0] = 1;
+        out[fields] = out[fields + 1] = 1;
+        return true;
+    }
+    const int remaining = folded_remaining(depth, split);
+
+    Position root;
+    unpack_position(rootWords, root);
+    FoldedFrontier f;
+    expand_folded(host_tables(), root, depth - remaining, f);
+    out[fields] = f.reached;
+    out[fields + 1] = f.count();
+    if (f.count() == 0) {
+        return true;
+    }
+    std::vector<int64_t> counts((size_t) f.count() * fields);
+    if (!bulk(f.packed.data(), f.count(), remaining, counts.data())) {
+        return false;
+    }
+    for (int i = 0; i < f.count(); ++i) {
+        const int64_t w = f.weight[(size_t) i];
+        for (int k = 0; k < fields; ++k) {
+            out[k] += w * counts[(size_t) i * fields + k];
+        }
+    }
+    return true;
+}
+
+} // namespace crtk_perft
+
+#endif // CRTK_PERFT_FRONTIER_H
@@ -15,16 +15,70 @@
  * exact same source compiles and runs on the CPU under g++ for testing — see
  * native/test/perft_host_jni_shim.cpp.
  *
+ * The attack tables are built once per process and uploaded once per device
+ * into constant memory (perftTables), so no call re-uploads them; the magic
+ * slider attack array (perft_core.h, PERFT_SLIDERS) is too large for constant
+ * memory and gets one global-memory copy per device that perftTables points
+ * at. A session handle spans every visible device and keeps, per device, two
+ * chunk slots (stream, pinned staging buffers, device buffers) alive across
+ * calls.
+ * nativeSessionBulkPerft splits the frontier into chunks; one host thread per
+ * device claims chunks from a shared counter (dynamic assignment, since subtree
+ * sizes vary widely) and alternates its two slots, so the upload of one chunk
+ * overlaps the kernel for the previous one. nativeSessionDeviceNodes reports
+ * the per-device node totals of the last call for load-balance diagnostics.
+ * A session serves one call at a time; the Java side serializes access.
+ *
+ * Two kernel modes count a chunk. "thread" gives each thread one frontier
+ * position. "split" gives each position PERFT_GROUP lanes that share its legal
+ * root moves (perft_root_share in perft_core.h) and add their subtree counts
+ * atomically, which spreads deep or uneven subtrees across a warp. Both modes instantiate a 4-frame stack for
+ * shallow remainders. PERFT_KERNEL_ENV selects thread|split|auto (default auto:
+ * split for frontiers up to SPLIT_AUTO_MAX positions). Counts are identical in
+ * every mode.
+ *
+ * PERFT_TT_ENV (MiB, default 0) gives every session device a Zobrist-keyed
+ * transposition table in global memory, shared by all threads of its launches
+ * and kept across calls. Node-count kernels probe it before expanding any
+ * subtree of two or more plies and store each finished one (perft_tt_iter_frames
+ * in perft_core.h); nativeSessionTableStats reports the last call's probes,
+ * hits and stores. A table hit reuses a count keyed by 64 bits of Zobrist
+ * hash, the usual perft-with-hashing trade-off.
+ *
+ * nativeSessionFoldedPerft(Detailed) takes the packed root instead of a
+ * frontier: the host expands the split plies itself, folds identical frontier
+ * positions into weighted unique ones (perft_frontier.h) and sends only those
+ * through the session, so transpositions are neither copied nor counted twice.
+ *
  * JNI surface (names parameterized by PERFT_JNI_PREFIX):
  *   Support.nativeDeviceCount() -> int
  *   Backend.nativeBulkPerft(long[] packed, int count, int remainingDepth) -> long[]
+ *   Backend.nativeBulkPerftDetailed(long[] packed, int count, int remainingDepth) -> long[]
+ *   Backend.nativeCreateSession(int capacity) -> long (0 on failure)
+ *   Backend.nativeSessionBulkPerft(long session, long[] packed, int count, int remainingDepth) -> long[]
+ *   Backend.nativeSessionBulkPerftDetailed(long session, long[] packed, int count, int remainingDepth) -> long[]
+ *   Backend.nativeSessionDeviceNodes(long session) -> long[] (one entry per device)
+ *   Backend.nativeSessionTableStats(long session) -> long[] {probes, hits, stores, slots}
+ *   Backend.nativeSessionFoldedPerft(long session, long[] root, int depth, int splitDepth) -> long[]
+ *       {nodes, frontier positions, unique positions}
+ *   Backend.nativeSessionFoldedPerftDetailed(long session, long[] root, int depth, int splitDepth) -> long[]
+ *       {7 counters, frontier positions, unique positions}
+ *   Backend.nativeDestroySession(long session)
  */
 #include <jni.h>
 
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
 #include <vector>
 
 #include "perft_core.h"
+#include "perft_frontier.h"
 
 #ifndef PERFT_GLOBAL
 #define PERFT_GLOBAL __global__
@@ -32,7 +86,15 @@
 
 // Kernel launch indirection so a host build can emulate the grid on the CPU.
 #ifndef PERFT_LAUNCH
-#define PERFT_LAUNCH(kernel, grid, block, ...) kernel<<<grid, block>>>(__VA_ARGS__)
+#define PERFT_LAUNCH(kernel, grid, block, stream, ...) kernel<<<grid, block, 0, stream>>>(__VA_ARGS__)
+#endif
+
+#ifndef PERFT_CONSTANT
+#define PERFT_CONSTANT __constant__
+#endif
+
+#ifndef PERFT_DEVICE
+#define PERFT_DEVICE __device__
 #endif
 
 #define PERFT_CAT2(a, b) a##b
@@ -43,21 +105,48 @@ namespace {
 
 using namespace crtk_perft;
 
+// Attack tables, resident in constant memory for the lifetime of the library.
+PERFT_CONSTANT Tables perftTables;
+
+// Detailed counters per position (nodes, captures, ep, castles, promotions,
+// checks, checkmates).
+constexpr int DETAIL_FIELDS = 7;
+
+// Threads per block for every bulk kernel.
+constexpr int PERFT_BLOCK = 64;
+
+// Lanes that share one frontier position in the root-split kernel mode: a
+// CUDA warp (half a wavefront on wave64 AMD parts).
+constexpr int PERFT_GROUP = 32;
+
+// Stack depth of the shallow kernel instantiations. Remainders up to this many
+// plies (the common case at GPU split depths) run with a 4-frame stack instead
+// of MAX_PERFT_DEPTH frames, cutting per-thread local memory about fourfold.
+constexpr int SHALLOW_FRAMES = 4;
+
+// Frontier size below which "auto" picks the root-split kernel: small frontiers
+// cannot fill the device one thread per position.
+constexpr int SPLIT_AUTO_MAX = 8192;
+
+enum class PerftKernel { Auto, Thread, Split };
+
 // One thread per frontier position: unpack and count perft(depth).
+template <int FRAMES>
 PERFT_GLOBAL void perft_bulk_kernel(const uint64_t* packed, int count, int depth,
-        const Tables* tables, unsigned long long* counts) {
+        unsigned long long* counts) {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     if (i >= count) {
         return;
     }
     Position p;
     unpack_position(packed + (long) i * PACK_WORDS, p);
-    counts[i] = (unsigned long long) perft_iter(*tables, p, depth);
+    counts[i] = (unsigned long long) perft_iter_frames<FRAMES>(perftTables, p, depth);
 }
 
 // One thread per frontier position: detailed counters (7 per position).
+template <int FRAMES>
 PERFT_GLOBAL void perft_detailed_kernel(const uint64_t* packed, int count, int depth,
-        const Tables* tables, unsigned long long* counts) {
+        unsigned long long* counts) {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     if (i >= count) {
         return;
@@ -65,8 +154,8 @@ PERFT_GLOBAL void perft_detailed_kernel(const uint64_t* packed, int count, int d
     Position p;
     unpack_position(packed + (long) i * PACK_WORDS, p);
     PerftCounts c;
-    perft_detailed_iter(*tables, p, depth, c);
-    unsigned long long* o = counts + (long) i * 7;
+    perft_detailed_iter_frames<FRAMES>(perftTables, p, depth, c);
+    unsigned long long* o = counts + (long) i * DETAIL_FIELDS;
     o[0] = c.nodes;
     o[1] = c.captures;
     o[2] = c.enPassant;
@@ -76,60 +165,324 @@ PERFT_GLOBAL void perft_detailed_kernel(const uint64_t* packed, int count, int d
     o[6] = c.checkmates;
 }
 
-} // namespace
+// PERFT_GROUP lanes per frontier position: each lane counts its share of the
+// legal root moves (perft_root_share) and adds it atomically into the
+// pre-zeroed count, so one deep subtree is spread over a whole warp instead of
+// stalling a single thread while its neighbours idle. Requires depth >= 1.
+template <int FRAMES>
+PERFT_GLOBAL void perft_split_kernel(const uint64_t* packed, int count, int depth,
+        unsigned long long* counts) {
+    long tid = (long) blockIdx.x * blockDim.x + threadIdx.x;
+    int i = (int) (tid / PERFT_GROUP);
+    int lane = (int) (tid % PERFT_GROUP);
+    if (i >= count) {
+        return;
+    }
+    Position p;
+    unpack_position(packed + (long) i * PACK_WORDS, p);
+    unsigned long long n = (unsigned long long) perft_root_share<FRAMES>(perftTables, p, depth, lane, PERFT_GROUP);
+    if (n != 0) {
+        PERFT_ATOMIC_ADD(&counts[i], n);
+    }
+}
 
-extern "C" JNIEXPORT jint JNICALL PERFT_JNI(Support_nativeDeviceCount)(JNIEnv*, jclass) {
-    int count = 0;
-    if (PERFT_GPU_GET_DEVICE_COUNT(&count) != PERFT_GPU_SUCCESS) {
-        return 0;
+// Detailed counterpart of perft_split_kernel.
+template <int FRAMES>
+PERFT_GLOBAL void perft_detailed_split_kernel(const uint64_t* packed, int count, int depth,
+        unsigned long long* counts) {
+    long tid = (long) blockIdx.x * blockDim.x + threadIdx.x;
+    int i = (int) (tid / PERFT_GROUP);
+    int lane = (int) (tid % PERFT_GROUP);
+    if (i >= count) {
+        return;
     }
-    return (jint) count;
+    Position p;
+    unpack_position(packed + (long) i * PACK_WORDS, p);
+    PerftCounts c = {};
+    perft_detailed_root_share<FRAMES>(perftTables, p, depth, lane, PERFT_GROUP, c);
+    if (c.nodes == 0) {
+        return;
+    }
+    unsigned long long* o = counts + (long) i * DETAIL_FIELDS;
+    PERFT_ATOMIC_ADD(&o[0], c.nodes);
+    PERFT_ATOMIC_ADD(&o[1], c.captures);
+    PERFT_ATOMIC_ADD(&o[2], c.enPassant);
+    PERFT_ATOMIC_ADD(&o[3], c.castles);
+    PERFT_ATOMIC_ADD(&o[4], c.promotions);
+    PERFT_ATOMIC_ADD(&o[5], c.checks);
+    PERFT_ATOMIC_ADD(&o[6], c.checkmates);
 }
 
-extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeBulkPerft)(
-        JNIEnv* env, jclass, jlongArray packedArray, jint count, jint depth) {
+// Device transposition table shared by every thread of a launch (one per
+// device, kept for the life of the session). Slots are claimed with a 64-bit
+// compare-exchange on `data` followed by an exchange on `check`; a reader
+// that catches a slot mid-update sees check ^ data != key and treats it as a
+// miss, so a race costs a recount, never a wrong count.
+struct PerftTable {
+    PerftTTEntry* slots = nullptr;
+    unsigned long long mask = 0;        // slot count - 1 (power of two)
+    unsigned long long* stats = nullptr; // TT_STATS counters, see DeviceTT::flush
+};
+
+// probes, hits, stores
+constexpr int TT_STATS = 3;
+
+// Per-thread view of a PerftTable: the TT policy of perft_tt_iter_frames, with
+// statistics kept in registers and flushed once per thread.
+struct DeviceTT {
+    PerftTTEntry* slots;
+    unsigned long long mask;
+    unsigned long long probes;
+    unsigned long long hits;
+    unsigned long long stores;
+
+    PERFT_DEVICE bool probe(uint64_t key, int depth, uint64_t& nodes) {
+        const volatile PerftTTEntry* e = slots + (key & mask);
+        uint64_t check = e->check;
+        uint64_t data = e->data;
+        ++probes;
+        if (!tt_match(check, data, key, depth)) {
+            return false;
+        }
+        ++hits;
+        nodes = tt_nodes(data);
+        return true;
+    }
+
+    PERFT_DEVICE void store(uint64_t key, int depth, uint64_t nodes) {
+        PerftTTEntry* e = slots + (key & mask);
+        uint64_t check = ((const volatile PerftTTEntry*) e)->check;
+        uint64_t data = ((const volatile PerftTTEntry*) e)->data;
+        if (!tt_replace(check, data, key, depth)) {
+            return;
+        }
+        uint64_t next = tt_pack(nodes, depth);
+        if (PERFT_ATOMIC_CAS(&e->data, data, next) == data) {
+            PERFT_ATOMIC_EXCH(&e->check, key ^ next);
+            ++stores;
+        }
+    }
+
+    PERFT_DEVICE void flush(unsigned long long* stats) {
+        if (probes != 0) {
+            PERFT_ATOMIC_ADD(&stats[0], probes);
+            PERFT_ATOMIC_ADD(&stats[1], hits);
+        }
+        if (stores != 0) {
+            PERFT_ATOMIC_ADD(&stats[2], stores);
+        }
+    }
+};
+
+// perft_bulk_kernel through the transposition table.
+template <int FRAMES>
+PERFT_GLOBAL void perft_tt_kernel(const uint64_t* packed, int count, int depth, unsigned long long* counts,
+        PerftTTEntry* slots, unsigned long long mask, unsigned long long* stats) {
+    int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= count) {
+        return;
+    }
+    Position p;
+    unpack_position(packed + (long) i * PACK_WORDS, p);
+    p.key = compute_key(perftTables, p);
+    DeviceTT tt = {slots, mask, 0, 0, 0};
+    counts[i] = (unsigned long long) perft_tt_iter_frames<FRAMES>(perftTables, p, depth, tt);
+    tt.flush(stats);
+}
+
+// perft_split_kernel through the transposition table.
+template <int FRAMES>
+PERFT_GLOBAL void perft_tt_split_kernel(const uint64_t* packed, int count, int depth, unsigned long long* counts,
+        PerftTTEntry* slots, unsigned long long mask, unsigned long long* stats) {
+    long tid = (long) blockIdx.x * blockDim.x + threadIdx.x;
+    int i = (int) (tid / PERFT_GROUP);
+    int lane = (int) (tid % PERFT_GROUP);
+    if (i >= count) {
+        return;
+    }
+    Position p;
+    unpack_position(packed + (long) i * PACK_WORDS, p);
+    p.key = compute_key(perftTables, p);
+    DeviceTT tt = {slots, mask, 0, 0, 0};
+    unsigned long long n = (unsigned long long) perft_tt_root_share<FRAMES>(perftTables, p, depth, lane,
+            PERFT_GROUP, tt);
+    if (n != 0) {
+        PERFT_ATOMIC_ADD(&counts[i], n);
+    }
+    tt.flush(stats);
+}
+
+// Builds the tables on the host once and uploads them to the current device the
+// first time that device is used. Returns false when the upload fails.
+bool ensure_tables() {
+    static std::mutex lock;
+    static bool built = false;
+    static Tables host;
+    static uint64_t uploaded = 0; // bit per device ordinal
+    std::lock_guard<std::mutex> guard(lock);
+    if (!built) {
+        build_tables(host);
+        built = true;
+    }
+    int device = 0;
+    if (PERFT_GPU_GET_DEVICE(&device) != PERFT_GPU_SUCCESS || device < 0 || device >= 64) {
+        return false;
+    }
+    uint64_t bit = 1ULL << device;
+    if ((uploaded & bit) != 0) {
+        return true;
+    }
+    // The slider attack array is too large for constant memory: give the
+    // device its own global copy (kept for the life of the process, like the
+    // constant tables) and point the uploaded Tables at it.
+    Tables installed = host;
+    if (host.sliderAttacks != nullptr) {
+        uint64_t* dAttacks = nullptr;
+        size_t bytes = SLIDER_ATTACK_WORDS * sizeof(uint64_t);
+        if (PERFT_GPU_MALLOC(&dAttacks, bytes) != PERFT_GPU_SUCCESS) {
+            return false;
+        }
+        if (PERFT_GPU_MEMCPY(dAttacks, host.sliderAttacks, bytes, PERFT_GPU_MEMCPY_H2D) != PERFT_GPU_SUCCESS) {
+            PERFT_GPU_FREE(dAttacks);
+            return false;
+        }
+        installed.sliderAttacks = dAttacks;
+    }
+    if (PERFT_GPU_MEMCPY_TO_SYMBOL(perftTables, &installed, sizeof(Tables)) != PERFT_GPU_SUCCESS) {
+        return false;
+    }
+    uploaded |= bit;
+    return true;
+}
+
+// Kernel mode from PERFT_KERNEL_ENV (thread|split|auto, default auto), read once.
+PerftKernel kernel_mode() {
+    static const PerftKernel mode = [] {
+#ifdef PERFT_KERNEL_ENV
+        const char* v = std::getenv(PERFT_KERNEL_ENV);
+        if (v != nullptr && std::strcmp(v, "thread") == 0) {
+            return PerftKernel::Thread;
+        }
+        if (v != nullptr && (std::strcmp(v, "split") == 0 || std::strcmp(v, "warp") == 0)) {
+            return PerftKernel::Split;
+        }
+#endif
+        return PerftKernel::Auto;
+    }();
+    return mode;
+}
+
+bool use_split(int count, int depth) {
+    if (depth < 1) {
+        return false;
+    }
+    switch (kernel_mode()) {
+        case PerftKernel::Thread:
+            return false;
+        case PerftKernel::Split:
+            return true;
+        default:
+            return count <= SPLIT_AUTO_MAX;
+    }
+}
+
+// Transposition-table size in MiB from PERFT_TT_ENV (default 0 = no table), read once.
+long tt_megabytes() {
+    static const long mb = [] {
+#ifdef PERFT_TT_ENV
+        const char* v = std::getenv(PERFT_TT_ENV);
+        if (v != nullptr) {
+            long parsed = std::strtol(v, nullptr, 10);
+            return parsed > 0 ? parsed : 0L;
+        }
+#endif
+        return 0L;
+    }();
+    return mb;
+}
+
+// Launches the kernel for one mode with a FRAMES-deep stack. The table only
+// serves node counts; detailed counters always walk the full tree.
+template <int FRAMES>
+void launch_frames(bool detailed, bool split, const PerftTable* tt, const uint64_t* dPacked, int count,
+        int depth, unsigned long long* dCounts, PERFT_GPU_STREAM stream) {
+    int grid = split ? (int) (((long) count * PERFT_GROUP + PERFT_BLOCK - 1) / PERFT_BLOCK)
+            : (count + PERFT_BLOCK - 1) / PERFT_BLOCK;
+    if (split && detailed) {
+        PERFT_LAUNCH(perft_detailed_split_kernel<FRAMES>, grid, PERFT_BLOCK, stream, dPacked, count, depth, dCounts);
+    } else if (split && tt != nullptr) {
+        PERFT_LAUNCH(perft_tt_split_kernel<FRAMES>, grid, PERFT_BLOCK, stream, dPacked, count, depth, dCounts,
+                tt->slots, tt->mask, tt->stats);
+    } else if (split) {
+        PERFT_LAUNCH(perft_split_kernel<FRAMES>, grid, PERFT_BLOCK, stream, dPacked, count, depth, dCounts);
+    } else if (detailed) {
+        PERFT_LAUNCH(perft_detailed_kernel<FRAMES>, grid, PERFT_BLOCK, stream, dPacked, count, depth, dCounts);
+    } else if (tt != nullptr) {
+        PERFT_LAUNCH(perft_tt_kernel<FRAMES>, grid, PERFT_BLOCK, stream, dPacked, count, depth, dCounts,
+                tt->slots, tt->mask, tt->stats);
+    } else {
+        PERFT_LAUNCH(perft_bulk_kernel<FRAMES>, grid, PERFT_BLOCK, stream, dPacked, count, depth, dCounts);
+    }
+}
+
+// Queues one bulk launch on `stream`, picking the kernel mode and the smallest
+// stack instantiation that covers `depth`. `tt` may be null.
+void launch_bulk(bool detailed, const uint64_t* dPacked, int count, int depth,
+        unsigned long long* dCounts, const PerftTable* tt, PERFT_GPU_STREAM stream) {
+    bool split = use_split(count, depth);
+    if (split) {
+        const int fields = detailed ? DETAIL_FIELDS : 1;
+        PERFT_GPU_MEMSET_ASYNC(dCounts, 0, (size_t) count * fields * sizeof(unsigned long long), stream);
+    }
+    int frames = split ? depth - 1 : depth;
+    if (frames <= SHALLOW_FRAMES) {
+        launch_frames<SHALLOW_FRAMES>(detailed, split, tt, dPacked, count, depth, dCounts, stream);
+    } else {
+        launch_frames<MAX_PERFT_DEPTH>(detailed, split, tt, dPacked, count, depth, dCounts, stream);
+    }
+}
+
+// One-shot path: allocate, copy, count, free. Kept for callers without a session.
+jlongArray bulk_once(JNIEnv* env, jlongArray packedArray, jint count, jint depth, bool detailed) {
     if (packedArray == nullptr || count <= 0 || depth < 0) {
         return nullptr;
     }
     jsize words = env->GetArrayLength(packedArray);
-    if ((jlong) words < (jlong) count * crtk_perft::PACK_WORDS) {
+    if ((jlong) words < (jlong) count * PACK_WORDS) {
+        return nullptr;
+    }
+    if (!ensure_tables()) {
         return nullptr;
     }
-
-    crtk_perft::Tables tables;
-    crtk_perft::build_tables(tables);
 
     jlong* packed = env->GetLongArrayElements(packedArray, nullptr);
     if (packed == nullptr) {
         return nullptr;
     }
 
-    size_t packedBytes = (size_t) count * crtk_perft::PACK_WORDS * sizeof(uint64_t);
-    size_t countBytes = (size_t) count * sizeof(unsigned long long);
+    const int fields = detailed ? DETAIL_FIELDS : 1;
+    size_t packedBytes = (size_t) count * PACK_WORDS * sizeof(uint64_t);
+    size_t countBytes = (size_t) count * fields * sizeof(unsigned long long);
 
     uint64_t* dPacked = nullptr;
-    crtk_perft::Tables* dTables = nullptr;
     unsigned long long* dCounts = nullptr;
     jlongArray result = nullptr;
 
     bool allocated = PERFT_GPU_MALLOC(&dPacked, packedBytes) == PERFT_GPU_SUCCESS
-            && PERFT_GPU_MALLOC(&dTables, sizeof(crtk_perft::Tables)) == PERFT_GPU_SUCCESS
             && PERFT_GPU_MALLOC(&dCounts, countBytes) == PERFT_GPU_SUCCESS;
 
     if (allocated
-            && PERFT_GPU_MEMCPY(dPacked, packed, packedBytes, PERFT_GPU_MEMCPY_H2D) == PERFT_GPU_SUCCESS
-            && PERFT_GPU_MEMCPY(dTables, &tables, sizeof(crtk_perft::Tables), PERFT_GPU_MEMCPY_H2D)
-                    == PERFT_GPU_SUCCESS) {
-        int block = 64;
-        int grid = (count + block - 1) / block;
-        PERFT_LAUNCH(perft_bulk_kernel, grid, block, dPacked, (int) count, (int) depth, dTables, dCounts);
+            && PERFT_GPU_MEMCPY(dPacked, packed, packedBytes, PERFT_GPU_MEMCPY_H2D) == PERFT_GPU_SUCCESS) {
+        launch_bulk(detailed, dPacked, (int) count, (int) depth, dCounts, nullptr, 0);
         PERFT_GPU_DEVICE_SYNCHRONIZE();
 
-        std::vector<unsigned long long> host((size_t) count);
-        if (PERFT_GPU_MEMCPY(host.data(), dCounts, countBytes, PERFT_GPU_MEMCPY_D2H) == PERFT_GPU_SUCCESS) {
-            result = env->NewLongArray(count);
+        std::vector<unsigned long long> host((size_t) count * fields);
+        if (PERFT_GPU_LAST_ERROR() == PERFT_GPU_SUCCESS
+                && PERFT_GPU_MEMCPY(host.data(), dCounts, countBytes, PERFT_GPU_MEMCPY_D2H) == PERFT_GPU_SUCCESS) {
+            result = env->NewLongArray(count * fields);
             if (result != nullptr) {
-                env->SetLongArrayRegion(result, 0, count, reinterpret_cast<const jlong*>(host.data()));
+                env->SetLongArrayRegion(result, 0, count * fields,
+                        reinterpret_cast<const jlong*>(host.data()));
             }
         }
     }
@@ -137,9 +490,6 @@ extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeBulkPerft)(
     if (dPacked != nullptr) {
         PERFT_GPU_FREE(dPacked);
     }
-    if (dTables != nullptr) {
-        PERFT_GPU_FREE(dTables);
-    }
     if (dCounts != nullptr) {
         PERFT_GPU_FREE(dCounts);
     }
@@ -147,69 +497,406 @@ extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeBulkPerft)(
     return result;
 }
 
-extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeBulkPerftDetailed)(
-        JNIEnv* env, jclass, jlongArray packedArray, jint count, jint depth) {
-    if (packedArray == nullptr || count <= 0 || depth < 0) {
+// One chunk slot: a non-blocking stream plus pinned staging and device buffers
+// sized for `capacity` positions (counts sized for the detailed layout so both
+// entry points share a slot).
+struct PerftSlot {
+    PERFT_GPU_STREAM stream = {};
+    uint64_t* hPacked = nullptr;
+    unsigned long long* hCounts = nullptr;
+    uint64_t* dPacked = nullptr;
+    unsigned long long* dCounts = nullptr;
+};
+
+// Per-device session state: two slots, the optional transposition table, and
+// the node total and table statistics of the last call.
+struct PerftDevice {
+    int ordinal = 0;
+    PerftSlot slot[2];
+    PerftTable tt;
+    unsigned long long nodes = 0;
+    unsigned long long ttStats[TT_STATS] = {0, 0, 0};
+};
+
+// Persistent session spanning every visible device.
+struct PerftSession {
+    int capacity = 0;
+    std::vector<PerftDevice> devices;
+};
+
+// Dynamic scheduling granularity: aim for this many chunks per device so a
+// device that drew cheap subtrees keeps pulling work from the shared counter.
+constexpr int CHUNKS_PER_DEVICE = 8;
+
+// Smallest chunk worth a launch when the frontier is split across devices.
+constexpr int MIN_CHUNK = 1024;
+
+void destroy_session(PerftSession* s) {
+    if (s == nullptr) {
+        return;
+    }
+    int previous = 0;
+    PERFT_GPU_GET_DEVICE(&previous);
+    for (PerftDevice& d : s->devices) {
+        (void) PERFT_GPU_SET_DEVICE(d.ordinal);
+        for (PerftSlot& slot : d.slot) {
+            if (slot.stream != nullptr) {
+                // Teardown is best effort: there is nothing to do about a failure here.
+                (void) PERFT_GPU_STREAM_SYNCHRONIZE(slot.stream);
+                (void) PERFT_GPU_STREAM_DESTROY(slot.stream);
+            }
+            if (slot.hPacked != nullptr) PERFT_GPU_HOST_FREE(slot.hPacked);
+            if (slot.hCounts != nullptr) PERFT_GPU_HOST_FREE(slot.hCounts);
+            if (slot.dPacked != nullptr) PERFT_GPU_FREE(slot.dPacked);
+            if (slot.dCounts != nullptr) PERFT_GPU_FREE(slot.dCounts);
+        }
+        if (d.tt.slots != nullptr) PERFT_GPU_FREE(d.tt.slots);
+        if (d.tt.stats != nullptr) PERFT_GPU_FREE(d.tt.stats);
+    }
+    (void) PERFT_GPU_SET_DEVICE(previous);
+    delete s;
+}
+
+// Allocates a zeroed table of the largest power-of-two slot count that fits
+// tt_megabytes(). The table is optional: on any failure the device simply
+// counts without one.
+void create_table(PerftTable& tt) {
+    unsigned long long bytes = (unsigned long long) tt_megabytes() << 20;
+    unsigned long long slots = 1;
+    while (slots * 2 * sizeof(PerftTTEntry) <= bytes) {
+        slots *= 2;
+    }
+    if (slots * sizeof(PerftTTEntry) > bytes) {
+        return;
+    }
+    size_t tableBytes = (size_t) slots * sizeof(PerftTTEntry);
+    size_t statsBytes = TT_STATS * sizeof(unsigned long long);
+    if (PERFT_GPU_MALLOC(&tt.slots, tableBytes) == PERFT_GPU_SUCCESS
+            && PERFT_GPU_MALLOC(&tt.stats, statsBytes) == PERFT_GPU_SUCCESS
+            && PERFT_GPU_MEMSET(tt.slots, 0, tableBytes) == PERFT_GPU_SUCCESS) {
+        tt.mask = slots - 1;
+        return;
+    }
+    if (tt.slots != nullptr) PERFT_GPU_FREE(tt.slots);
+    if (tt.stats != nullptr) PERFT_GPU_FREE(tt.stats);
+    tt = PerftTable();
+}
+
+PerftSession* create_session(int capacity) {
+    int deviceCount = 0;
+    if (capacity <= 0 || PERFT_GPU_GET_DEVICE_COUNT(&deviceCount) != PERFT_GPU_SUCCESS || deviceCount <= 0) {
         return nullptr;
     }
-    jsize words = env->GetArrayLength(packedArray);
-    if ((jlong) words < (jlong) count * crtk_perft::PACK_WORDS) {
+    int previous = 0;
+    PERFT_GPU_GET_DEVICE(&previous);
+    PerftSession* s = new PerftSession();
+    s->capacity = capacity;
+    s->devices.resize((size_t) deviceCount);
+    size_t packedBytes = (size_t) capacity * PACK_WORDS * sizeof(uint64_t);
+    size_t countBytes = (size_t) capacity * DETAIL_FIELDS * sizeof(unsigned long long);
+    bool ok = true;
+    for (int i = 0; i < deviceCount && ok; ++i) {
+        PerftDevice& d = s->devices[(size_t) i];
+        d.ordinal = i;
+        ok = PERFT_GPU_SET_DEVICE(i) == PERFT_GPU_SUCCESS && ensure_tables();
+        for (int b = 0; b < 2 && ok; ++b) {
+            PerftSlot& slot = d.slot[b];
+            ok = PERFT_GPU_STREAM_CREATE(&slot.stream) == PERFT_GPU_SUCCESS
+                    && PERFT_GPU_HOST_ALLOC(&slot.hPacked, packedBytes) == PERFT_GPU_SUCCESS
+                    && PERFT_GPU_HOST_ALLOC(&slot.hCounts, countBytes) == PERFT_GPU_SUCCESS
+                    && PERFT_GPU_MALLOC(&slot.dPacked, packedBytes) == PERFT_GPU_SUCCESS
+                    && PERFT_GPU_MALLOC(&slot.dCounts, countBytes) == PERFT_GPU_SUCCESS;
+        }
+        if (ok) {
+            create_table(d.tt);
+        }
+    }
+    (void) PERFT_GPU_SET_DEVICE(previous);
+    if (!ok) {
+        destroy_session(s);
         return nullptr;
     }
+    return s;
+}
+
+// Shared work queue for one session call: devices claim chunk indices from
+// `next` until the frontier is exhausted or any device fails.
+struct PerftWork {
+    const jlong* packed;
+    jlong* out;
+    int count;
+    int depth;
+    int chunk;
+    int chunks;
+    bool detailed;
+    std::atomic<int> next{0};
+    std::atomic<bool> failed{false};
+};
+
+// Double-buffered chunk loop for one device. Slot use alternates per claimed
+// chunk: before a slot is reused its previous chunk is drained into `out`,
+// then the next claimed chunk is staged into pinned memory and queued (H2D,
+// kernel, D2H) on the slot's stream, so the upload of one chunk overlaps the
+// kernel for the previous one.
+void device_bulk(PerftDevice& d, PerftWork& w) {
+    const int fields = w.detailed ? DETAIL_FIELDS : 1;
+    d.nodes = 0;
+    std::memset(d.ttStats, 0, sizeof(d.ttStats));
+    if (PERFT_GPU_SET_DEVICE(d.ordinal) != PERFT_GPU_SUCCESS) {
+        w.failed = true;
+        return;
+    }
+    const PerftTable* tt = w.detailed || d.tt.slots == nullptr ? nullptr : &d.tt;
+    if (tt != nullptr && PERFT_GPU_MEMSET(tt->stats, 0, sizeof(d.ttStats)) != PERFT_GPU_SUCCESS) {
+        w.failed = true;
+        return;
+    }
+    int first[2] = {0, 0};
+    int size[2] = {0, 0};
+    bool ok = true;
+
+    auto drain = [&](int b) {
+        if (size[b] == 0) {
+            return;
+        }
+        if (PERFT_GPU_STREAM_SYNCHRONIZE(d.slot[b].stream) != PERFT_GPU_SUCCESS) {
+            ok = false;
+        } else {
+            const unsigned long long* counts = d.slot[b].hCounts;
+            std::memcpy(w.out + (size_t) first[b] * fields, counts,
+                    (size_t) size[b] * fields * sizeof(unsigned long long));
+            for (int i = 0; i < size[b]; ++i) {
+                d.nodes += counts[(size_t) i * fields];
+            }
+        }
+        size[b] = 0;
+    };
+
+    for (int b = 0; ok && !w.failed; b ^= 1) {
+        int k = w.next.fetch_add(1);
+        if (k >= w.chunks) {
+            break;
+        }
+        drain(b);
+        PerftSlot& slot = d.slot[b];
+        int start = k * w.chunk;
+        int n = w.count - start < w.chunk ? w.count - start : w.chunk;
+        size_t packedBytes = (size_t) n * PACK_WORDS * sizeof(uint64_t);
+        std::memcpy(slot.hPacked, w.packed + (size_t) start * PACK_WORDS, packedBytes);
+        ok = PERFT_GPU_MEMCPY_ASYNC(slot.dPacked, slot.hPacked, packedBytes, PERFT_GPU_MEMCPY_H2D, slot.stream)
+                == PERFT_GPU_SUCCESS;
+        if (!ok) {
+            break;
+        }
+        launch_bulk(w.detailed, slot.dPacked, n, w.depth, slot.dCounts, tt, slot.stream);
+        ok = PERFT_GPU_MEMCPY_ASYNC(slot.hCounts, slot.dCounts, (size_t) n * fields * sizeof(unsigned long long),
+                PERFT_GPU_MEMCPY_D2H, slot.stream) == PERFT_GPU_SUCCESS;
+        first[b] = start;
+        size[b] = n;
+    }
+    drain(0);
+    drain(1);
+    if (ok && tt != nullptr) {
+        ok = PERFT_GPU_MEMCPY(d.ttStats, tt->stats, sizeof(d.ttStats), PERFT_GPU_MEMCPY_D2H) == PERFT_GPU_SUCCESS;
+    }
+    if (!ok || PERFT_GPU_LAST_ERROR() != PERFT_GPU_SUCCESS) {
+        w.failed = true;
+    }
+}
 
-    crtk_perft::Tables tables;
-    crtk_perft::build_tables(tables);
+// Spreads one frontier across every session device. Each device runs on its
+// own host thread and pulls chunks from a shared counter, so a device that
+// drew cheap subtrees simply claims more chunks; results land at their
+// frontier offsets, so the output order never depends on the schedule.
+bool session_bulk(PerftSession& s, const jlong* packed, int count, int depth, bool detailed, jlong* out) {
+    int devices = (int) s.devices.size();
+    long target = ((long) count + (long) devices * CHUNKS_PER_DEVICE - 1) / ((long) devices * CHUNKS_PER_DEVICE);
+    int chunk = (int) (target < MIN_CHUNK ? MIN_CHUNK : target);
+    if (chunk > s.capacity) {
+        chunk = s.capacity;
+    }
+    PerftWork w;
+    w.packed = packed;
+    w.out = out;
+    w.count = count;
+    w.depth = depth;
+    w.chunk = chunk;
+    w.chunks = (count + chunk - 1) / chunk;
+    w.detailed = detailed;
 
+    int previous = 0;
+    PERFT_GPU_GET_DEVICE(&previous);
+    int active = devices < w.chunks ? devices : w.chunks;
+    for (int i = active; i < devices; ++i) {
+        s.devices[(size_t) i].nodes = 0;
+        std::memset(s.devices[(size_t) i].ttStats, 0, sizeof(s.devices[(size_t) i].ttStats));
+    }
+    if (active == 1) {
+        device_bulk(s.devices.front(), w);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve((size_t) active);
+        for (int i = 0; i < active; ++i) {
+            workers.emplace_back(device_bulk, std::ref(s.devices[(size_t) i]), std::ref(w));
+        }
+        for (std::thread& t : workers) {
+            t.join();
+        }
+    }
+    (void) PERFT_GPU_SET_DEVICE(previous);
+    return !w.failed;
+}
+
+jlongArray bulk_session(JNIEnv* env, jlong handle, jlongArray packedArray, jint count, jint depth,
+        bool detailed) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr || packedArray == nullptr || count <= 0 || depth < 0) {
+        return nullptr;
+    }
+    jsize words = env->GetArrayLength(packedArray);
+    if ((jlong) words < (jlong) count * PACK_WORDS) {
+        return nullptr;
+    }
     jlong* packed = env->GetLongArrayElements(packedArray, nullptr);
     if (packed == nullptr) {
         return nullptr;
     }
+    const int fields = detailed ? DETAIL_FIELDS : 1;
+    std::vector<jlong> host((size_t) count * fields);
+    bool ok = session_bulk(*s, packed, (int) count, (int) depth, detailed, host.data());
+    env->ReleaseLongArrayElements(packedArray, packed, JNI_ABORT);
+    if (!ok) {
+        return nullptr;
+    }
+    jlongArray result = env->NewLongArray(count * fields);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, count * fields, host.data());
+    }
+    return result;
+}
 
-    const int fields = 7;
-    size_t packedBytes = (size_t) count * crtk_perft::PACK_WORDS * sizeof(uint64_t);
-    size_t countBytes = (size_t) count * fields * sizeof(unsigned long long);
+// Expands the split plies below one packed root on the host, folds duplicate
+// frontier positions (perft_frontier.h) and counts each unique one once across
+// the session's devices; returns the weighted counters followed by
+// {frontier positions, unique positions}.
+jlongArray folded_session(JNIEnv* env, jlong handle, jlongArray rootArray, jint depth, jint split, bool detailed) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr || rootArray == nullptr || depth < 0 || folded_remaining(depth, split) > MAX_PERFT_DEPTH
+            || env->GetArrayLength(rootArray) < PACK_WORDS) {
+        return nullptr;
+    }
+    jlong root[PACK_WORDS];
+    env->GetLongArrayRegion(rootArray, 0, PACK_WORDS, root);
+    const int fields = detailed ? DETAIL_FIELDS : 1;
+    jlong out[DETAIL_FIELDS + FOLD_STATS];
+    bool ok = false;
+    try {
+        ok = folded_perft(reinterpret_cast<const uint64_t*>(root), depth, split, fields,
+                [&](const uint64_t* packed, int count, int remaining, int64_t* counts) {
+                    return session_bulk(*s, reinterpret_cast<const jlong*>(packed), count, remaining, detailed,
+                            reinterpret_cast<jlong*>(counts));
+                },
+                reinterpret_cast<int64_t*>(out));
+    } catch (const std::bad_alloc&) {
+        ok = false;
+    }
+    if (!ok) {
+        return nullptr;
+    }
+    jlongArray result = env->NewLongArray(fields + FOLD_STATS);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, fields + FOLD_STATS, out);
+    }
+    return result;
+}
 
-    uint64_t* dPacked = nullptr;
-    crtk_perft::Tables* dTables = nullptr;
-    unsigned long long* dCounts = nullptr;
-    jlongArray result = nullptr;
+} // namespace
 
-    bool allocated = PERFT_GPU_MALLOC(&dPacked, packedBytes) == PERFT_GPU_SUCCESS
-            && PERFT_GPU_MALLOC(&dTables, sizeof(crtk_perft::Tables)) == PERFT_GPU_SUCCESS
-            && PERFT_GPU_MALLOC(&dCounts, countBytes) == PERFT_GPU_SUCCESS;
+extern "C" JNIEXPORT jint JNICALL PERFT_JNI(Support_nativeDeviceCount)(JNIEnv*, jclass) {
+    int count = 0;
+    if (PERFT_GPU_GET_DEVICE_COUNT(&count) != PERFT_GPU_SUCCESS) {
+        return 0;
+    }
+    return (jint) count;
+}
 
-    if (allocated
-            && PERFT_GPU_MEMCPY(dPacked, packed, packedBytes, PERFT_GPU_MEMCPY_H2D) == PERFT_GPU_SUCCESS
-            && PERFT_GPU_MEMCPY(dTables, &tables, sizeof(crtk_perft::Tables), PERFT_GPU_MEMCPY_H2D)
-                    == PERFT_GPU_SUCCESS) {
-        int block = 64;
-        int grid = (count + block - 1) / block;
-        PERFT_LAUNCH(perft_detailed_kernel, grid, block, dPacked, (int) count, (int) depth, dTables, dCounts);
-        PERFT_GPU_DEVICE_SYNCHRONIZE();
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeBulkPerft)(
+        JNIEnv* env, jclass, jlongArray packedArray, jint count, jint depth) {
+    return bulk_once(env, packedArray, count, depth, false);
+}
 
-        std::vector<unsigned long long> host((size_t) count * fields);
-        if (PERFT_GPU_MEMCPY(host.data(), dCounts, countBytes, PERFT_GPU_MEMCPY_D2H) == PERFT_GPU_SUCCESS) {
-            result = env->NewLongArray(count * fields);
-            if (result != nullptr) {
-                env->SetLongArrayRegion(result, 0, count * fields,
-                        reinterpret_cast<const jlong*>(host.data()));
-            }
-        }
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeBulkPerftDetailed)(
+        JNIEnv* env, jclass, jlongArray packedArray, jint count, jint depth) {
+    return bulk_once(env, packedArray, count, depth, true);
+}
+
+extern "C" JNIEXPORT jlong JNICALL PERFT_JNI(Backend_nativeCreateSession)(JNIEnv*, jclass, jint capacity) {
+    return reinterpret_cast<jlong>(create_session((int) capacity));
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeSessionBulkPerft)(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedArray, jint count, jint depth) {
+    return bulk_session(env, handle, packedArray, count, depth, false);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeSessionBulkPerftDetailed)(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedArray, jint count, jint depth) {
+    return bulk_session(env, handle, packedArray, count, depth, true);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeSessionDeviceNodes)(
+        JNIEnv* env, jclass, jlong handle) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr) {
+        return nullptr;
+    }
+    std::vector<jlong> nodes;
+    for (const PerftDevice& d : s->devices) {
+        nodes.push_back((jlong) d.nodes);
     }
+    jlongArray result = env->NewLongArray((jsize) nodes.size());
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, (jsize) nodes.size(), nodes.data());
+    }
+    return result;
+}
 
-    if (dPacked != nullptr) {
-        PERFT_GPU_FREE(dPacked);
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeSessionTableStats)(
+        JNIEnv* env, jclass, jlong handle) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr) {
+        return nullptr;
     }
-    if (dTables != nullptr) {
-        PERFT_GPU_FREE(dTables);
+    jlong stats[TT_STATS + 1] = {0, 0, 0, 0};
+    for (const PerftDevice& d : s->devices) {
+        for (int i = 0; i < TT_STATS; ++i) {
+            stats[i] += (jlong) d.ttStats[i];
+        }
+        if (d.tt.slots != nullptr) {
+            stats[TT_STATS] += (jlong) (d.tt.mask + 1);
+        }
     }
-    if (dCounts != nullptr) {
-        PERFT_GPU_FREE(dCounts);
+    jlongArray result = env->NewLongArray(TT_STATS + 1);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, TT_STATS + 1, stats);
     }
-    env->ReleaseLongArrayElements(packedArray, packed, JNI_ABORT);
     return result;
 }
 
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeSessionFoldedPerft)(
+        JNIEnv* env, jclass, jlong handle, jlongArray rootArray, jint depth, jint splitDepth) {
+    return folded_session(env, handle, rootArray, depth, splitDepth, false);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL PERFT_JNI(Backend_nativeSessionFoldedPerftDetailed)(
+        JNIEnv* env, jclass, jlong handle, jlongArray rootArray, jint depth, jint splitDepth) {
+    return folded_session(env, handle, rootArray, depth, splitDepth, true);
+}
+
+extern "C" JNIEXPORT void JNICALL PERFT_JNI(Backend_nativeDestroySession)(JNIEnv*, jclass, jlong handle) {
+    destroy_session(reinterpret_cast<PerftSession*>(handle));
+}
+
 #undef PERFT_JNI
 #undef PERFT_CAT
 #undef PERFT_CAT2
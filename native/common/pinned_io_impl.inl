@@ -0,0 +1,43 @@
+/*
+ * native/common/pinned_io_impl.inl
+ *
+ * Direct-buffer glue shared by the LC0 CNN, BT4 and OTIS GPU backends. Each handle can own one set
+ * of page-locked host buffers (input planes, policy, WDL) sized for maxBatch positions, allocated on
+ * first use with the vendor's pinned allocator. nativePinnedBuffers hands them to Java as direct
+ * ByteBuffers in native byte order, so callers write encoded planes and read results in place, and
+ * nativePredictPinned runs the forward pass with async copies straight from and into that memory:
+ * no JNI array copies, no per-call heap allocation, and no pageable staging on the DMA path.
+ *
+ * The buffers live as long as the handle and, like the handle, serve one predict at a time.
+ */
+
+#ifndef CRTK_PINNED_IO_IMPL_INL
+#define CRTK_PINNED_IO_IMPL_INL
+
+#include <jni.h>
+
+#include <cstddef>
+
+namespace {
+
+// Returns ByteBuffer[3] {input, policy, wdl} wrapping the given host memory, or null on failure.
+static jobjectArray pinned_buffer_array(JNIEnv* env, float* input, size_t inputFloats, float* policy,
+                                        size_t policyFloats, float* wdl, size_t wdlFloats) {
+    jclass byteBuffer = env->FindClass("java/nio/ByteBuffer");
+    if (!byteBuffer) return nullptr;
+    jobjectArray out = env->NewObjectArray(3, byteBuffer, nullptr);
+    if (!out) return nullptr;
+    float* data[3] = {input, policy, wdl};
+    const size_t floats[3] = {inputFloats, policyFloats, wdlFloats};
+    for (jsize i = 0; i < 3; ++i) {
+        jobject buffer = env->NewDirectByteBuffer(data[i], static_cast<jlong>(floats[i] * sizeof(float)));
+        if (!buffer) return nullptr;
+        env->SetObjectArrayElement(out, i, buffer);
+        env->DeleteLocalRef(buffer);
+    }
+    return out;
+}
+
+} // namespace
+
+#endif // CRTK_PINNED_IO_IMPL_INL
@@ -0,0 +1,253 @@
+/*
+ * native/common/replica_pool_impl.inl
+ *
+ * Multi-device replica pool shared by the LC0 CNN, BT4 and OTIS GPU backends. A pool loads one net
+ * per listed device ordinal through the backend's device-bound create (see nativeCreateOnDevice)
+ * and spreads predicts over them, so throughput scales with the number of cards instead of
+ * stopping at device 0:
+ *
+ *  - a call that fits in one maxBatch chunk goes to the least-loaded replica (fewest calls in
+ *    flight, ties broken round-robin), so concurrent Java threads land on different devices;
+ *  - a larger call is cut into contiguous runs of whole chunks, at most one run per replica, and
+ *    the runs are evaluated in parallel on host threads (the calling thread takes the first).
+ *
+ * Every replica keeps its own mutex, so each handle still serves one predict at a time. Results
+ * are written by position index and no kernel mixes positions, so the output of a call does not
+ * depend on how it was split; replicas on different GPU models may differ in the last bits.
+ */
+
+#ifndef CRTK_REPLICA_POOL_IMPL_INL
+#define CRTK_REPLICA_POOL_IMPL_INL
+
+#include <jni.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Longs per replica in the nativePoolStats result: {device, calls, positions}.
+constexpr int REPLICA_POOL_STATS = 3;
+
+template <typename Net>
+class ReplicaPool {
+public:
+    using Release = void (*)(Net*);
+
+    ReplicaPool(Release release) : release_(release) {}
+
+    ReplicaPool(const ReplicaPool&) = delete;
+    ReplicaPool& operator=(const ReplicaPool&) = delete;
+
+    ~ReplicaPool() {
+        for (auto& replica : replicas_) release_(replica->net);
+    }
+
+    // Takes ownership of one loaded net.
+    void add(Net* net, int device) {
+        auto replica = std::make_unique<Replica>();
+        replica->net = net;
+        replica->device = device;
+        replicas_.push_back(std::move(replica));
+    }
+
+    int size() const { return static_cast<int>(replicas_.size()); }
+
+    // First replica; every replica loads the same file, so it stands in for the pool's metadata.
+    Net& front() { return *replicas_.front()->net; }
+
+    /*
+     * Evaluates positions [0, count) through
+     *   eval(Net& net, size_t first, int n) -> bool
+     * where n never exceeds chunk. Each run of chunks holds its replica's mutex for the whole run.
+     */
+    template <typename Eval>
+    bool run(size_t count, int chunk, Eval&& eval) {
+        if (count == 0 || chunk <= 0 || replicas_.empty()) return false;
+        const size_t step = static_cast<size_t>(chunk);
+        const size_t chunks = (count + step - 1) / step;
+        const size_t runs = std::min(chunks, replicas_.size());
+        std::vector<Replica*> picked(runs);
+        acquire(picked);
+
+        auto evaluate = [&](size_t r) {
+            Replica& replica = *picked[r];
+            const size_t first = chunks * r / runs * step;
+            const size_t last = std::min(count, chunks * (r + 1) / runs * step);
+            bool ok = true;
+            {
+                std::lock_guard<std::mutex> lock(replica.mutex);
+                for (size_t off = first; ok && off < last; off += step) {
+                    ok = eval(*replica.net, off, static_cast<int>(std::min(last - off, step)));
+                }
+            }
+            replica.inflight.fetch_sub(1);
+            if (ok) {
+                replica.calls.fetch_add(1);
+                replica.positions.fetch_add(static_cast<long long>(last - first));
+            }
+            return ok;
+        };
+
+        std::vector<char> ok(runs, 0);
+        std::vector<std::thread> workers;
+        size_t started = 1;
+        try {
+            workers.reserve(runs - 1);
+            for (; started < runs; ++started) {
+                workers.emplace_back([&evaluate, &ok, started] { ok[started] = evaluate(started) ? 1 : 0; });
+            }
+        } catch (...) {
+            // Runs that got no thread are evaluated inline below.
+        }
+        ok[0] = evaluate(0) ? 1 : 0;
+        for (size_t r = started; r < runs; ++r) ok[r] = evaluate(r) ? 1 : 0;
+        for (auto& worker : workers) worker.join();
+        return std::all_of(ok.begin(), ok.end(), [](char v) { return v != 0; });
+    }
+
+    // Appends {device, calls, positions} per replica.
+    void stats(std::vector<long long>& out) const {
+        for (const auto& replica : replicas_) {
+            out.push_back(replica->device);
+            out.push_back(replica->calls.load());
+            out.push_back(replica->positions.load());
+        }
+    }
+
+private:
+    struct Replica {
+        Net* net = nullptr;
+        int device = 0;
+        std::mutex mutex;
+        std::atomic<int> inflight{0};
+        std::atomic<long long> calls{0};
+        std::atomic<long long> positions{0};
+    };
+
+    // Fills `picked` with replicas, each the one with the fewest calls in flight at that point,
+    // scanning from a rotating start so ties rotate, and counts the caller in before it waits for
+    // the replica's mutex. Choosing and counting happen under pickMutex_, so concurrent callers
+    // that see the same loads still land on different replicas. Finished runs count themselves
+    // out without the lock; a scan that misses such a decrement only picks a busier replica.
+    void acquire(std::vector<Replica*>& picked) {
+        std::lock_guard<std::mutex> lock(pickMutex_);
+        const size_t n = replicas_.size();
+        for (Replica*& slot : picked) {
+            const size_t start = cursor_++ % n;
+            Replica* best = replicas_[start].get();
+            int bestLoad = best->inflight.load();
+            for (size_t i = 1; i < n && bestLoad > 0; ++i) {
+                Replica* candidate = replicas_[(start + i) % n].get();
+                const int load = candidate->inflight.load();
+                if (load < bestLoad) {
+                    best = candidate;
+                    bestLoad = load;
+                }
+            }
+            best->inflight.fetch_add(1);
+            slot = best;
+        }
+    }
+
+    Release release_;
+    std::vector<std::unique_ptr<Replica>> replicas_;
+    std::mutex pickMutex_;
+    size_t cursor_ = 0; // guarded by pickMutex_
+};
+
+/*
+ * Shared body of the nativePoolCreate entry points: loads one replica per ordinal in `devices`
+ * through create(int device) -> Net*. Returns null (after releasing what was loaded) when the
+ * list is empty, names an ordinal twice, or any replica fails to load.
+ */
+template <typename Net, typename Create>
+static ReplicaPool<Net>* replica_pool_create(JNIEnv* env, jintArray devices, void (*release)(Net*),
+                                             Create&& create) {
+    if (!devices) return nullptr;
+    const jsize n = env->GetArrayLength(devices);
+    if (n <= 0) return nullptr;
+    std::vector<jint> ordinals(static_cast<size_t>(n));
+    env->GetIntArrayRegion(devices, 0, n, ordinals.data());
+    std::vector<jint> sorted(ordinals);
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) return nullptr;
+    std::unique_ptr<ReplicaPool<Net>> pool;
+    try {
+        pool = std::make_unique<ReplicaPool<Net>>(release);
+    } catch (...) {
+        return nullptr;
+    }
+    for (jint device : ordinals) {
+        Net* net = create(static_cast<int>(device));
+        if (!net) return nullptr;
+        try {
+            pool->add(net, static_cast<int>(device));
+        } catch (...) {
+            release(net);
+            return nullptr;
+        }
+    }
+    return pool.release();
+}
+
+/*
+ * Shared body of the nativePoolPredictBatch entry points: validates the arrays, copies `count`
+ * encoded positions out of Java once, evaluates them across the pool in maxBatch-sized chunks
+ * through
+ *   eval(Net& net, const float* encoded, int chunk, float* policy, float* wdl) -> bool
+ * and writes policy/WDL/value back. Returns count, or 0 on failure.
+ */
+template <typename Net, typename Eval>
+static jint replica_pool_predict_batch(JNIEnv* env, ReplicaPool<Net>& pool, jfloatArray encodedBatch, jint count,
+                                       int encStride, int maxBatch, int policySize, jfloatArray outPolicy,
+                                       jfloatArray outWdl, jfloatArray outValue, Eval&& eval) {
+    if (!encodedBatch || !outPolicy || !outWdl || !outValue || count <= 0) return 0;
+    const size_t n = static_cast<size_t>(count);
+    const size_t stride = static_cast<size_t>(encStride);
+    const size_t polStride = static_cast<size_t>(policySize);
+    if (static_cast<size_t>(env->GetArrayLength(encodedBatch)) < n * stride
+            || static_cast<size_t>(env->GetArrayLength(outPolicy)) < n * polStride
+            || static_cast<size_t>(env->GetArrayLength(outWdl)) < n * 3
+            || static_cast<size_t>(env->GetArrayLength(outValue)) < n) {
+        return 0;
+    }
+    std::vector<float> encoded(n * stride);
+    env->GetFloatArrayRegion(encodedBatch, 0, static_cast<jsize>(encoded.size()), encoded.data());
+    std::vector<float> policy(n * polStride);
+    std::vector<float> wdl(n * 3);
+    std::vector<float> values(n);
+    if (!pool.run(n, maxBatch, [&](Net& net, size_t first, int chunk) {
+            return eval(net, encoded.data() + first * stride, chunk, policy.data() + first * polStride,
+                    wdl.data() + first * 3);
+        })) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; ++i) values[i] = wdl[i * 3] - wdl[i * 3 + 2];
+    env->SetFloatArrayRegion(outPolicy, 0, static_cast<jsize>(policy.size()), policy.data());
+    env->SetFloatArrayRegion(outWdl, 0, static_cast<jsize>(wdl.size()), wdl.data());
+    env->SetFloatArrayRegion(outValue, 0, static_cast<jsize>(values.size()), values.data());
+    return count;
+}
+
+// Per-replica {device, calls, positions} as a Java long[], or null on failure.
+template <typename Net>
+static jlongArray replica_pool_stats(JNIEnv* env, const ReplicaPool<Net>& pool) {
+    std::vector<long long> stats;
+    pool.stats(stats);
+    jlongArray out = env->NewLongArray(static_cast<jsize>(stats.size()));
+    if (!out) return nullptr;
+    std::vector<jlong> values(stats.begin(), stats.end());
+    env->SetLongArrayRegion(out, 0, static_cast<jsize>(values.size()), values.data());
+    return out;
+}
+
+} // namespace
+
+#endif // CRTK_REPLICA_POOL_IMPL_INL
@@ -0,0 +1,111 @@
+/*
+ * native/common/weight_cache_impl.inl
+ *
+ * Process-wide weight registry shared by the LC0 CNN, BT4, OTIS and T5 GPU backends. A backend
+ * splits its net into an immutable, device-resident model (parsed, transposed and uploaded once)
+ * and a per-handle workspace (activations, I/O buffers, stream, graphs). Handles created for the
+ * same weights file, device and storage precision share one model through a std::shared_ptr, so
+ * sixteen search threads that each open the same network pay for its weights once:
+ *
+ *  - the registry holds weak references only, so a model is freed as soon as its last handle is
+ *    destroyed, and reopening the path afterwards parses the file again;
+ *  - each key has its own entry with its own mutex, and a load holds only that mutex: threads
+ *    racing to open the same path wait for the first load instead of each uploading a private
+ *    copy, while lookups and loads of other keys go ahead. The registry lock only guards the
+ *    key -> entry map and is never held across a file read or upload;
+ *  - the key is the path string as passed from Java (absolute), so a file rewritten while handles
+ *    are still open keeps serving the copy those handles loaded.
+ *
+ * Kernels only read model memory, so handles on the same device can run predicts concurrently.
+ */
+
+#ifndef CRTK_WEIGHT_CACHE_IMPL_INL
+#define CRTK_WEIGHT_CACHE_IMPL_INL
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+template <typename Model>
+class WeightCache {
+public:
+    using Release = void (*)(Model*);
+
+    explicit WeightCache(Release release) : release_(release) {}
+
+    WeightCache(const WeightCache&) = delete;
+    WeightCache& operator=(const WeightCache&) = delete;
+
+    /*
+     * Returns the live model for (path, device, variant), or loads one through
+     *   load() -> Model*
+     * and registers it. `variant` distinguishes load-time options that change the uploaded
+     * tensors (storage precision). Returns null when the load fails; failures are not cached.
+     */
+    template <typename Load>
+    std::shared_ptr<const Model> acquire(const std::string& path, int device, int variant, Load&& load) {
+        std::shared_ptr<Entry> entry;
+        try {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::shared_ptr<Entry>& slot = entries_[Key(path, device, variant)];
+            if (!slot) {
+                prune();
+                slot = std::make_shared<Entry>();
+            }
+            entry = slot;
+        } catch (...) {
+            entry = std::make_shared<Entry>(); // no room to register: load a private copy
+        }
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        if (auto live = entry->model.lock()) return live;
+        Model* raw = load();
+        if (!raw) return nullptr;
+        std::shared_ptr<const Model> model;
+        try {
+            model = std::shared_ptr<const Model>(raw, [release = release_](const Model* m) {
+                release(const_cast<Model*>(m));
+            });
+        } catch (...) {
+            return nullptr; // the shared_ptr constructor already released raw
+        }
+        entry->model = model;
+        return model;
+    }
+
+private:
+    using Key = std::tuple<std::string, int, int>;
+
+    // One registry slot. `mutex` serializes loads of this key and guards `model`.
+    struct Entry {
+        std::mutex mutex;
+        std::weak_ptr<const Model> model;
+    };
+
+    // Drops entries whose model has already been freed and that no acquire() is using; called
+    // with the registry lock held. An entry only the map references cannot gain a new user
+    // while that lock is held, so taking its mutex here never waits on a load.
+    void prune() {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            bool idle = false;
+            if (it->second && it->second.use_count() == 1) {
+                std::lock_guard<std::mutex> lock(it->second->mutex);
+                idle = it->second->model.expired();
+            }
+            if (idle) it = entries_.erase(it);
+            else ++it;
+        }
+    }
+
+    Release release_;
+    std::mutex mutex_;
+    std::map<Key, std::shared_ptr<Entry>> entries_;
+};
+
+} // namespace
+
+#endif // CRTK_WEIGHT_CACHE_IMPL_INL
@@ -0,0 +1,371 @@
+/*
+ * native/common/weight_image_impl.inl
+ *
+ * Device-ready weight images for the BT4 and T5 GPU backends. Loading a source weights file means
+ * field-by-field decoding, host transposes and dtype conversions, then one small copy per tensor,
+ * which costs seconds per worker start on large nets. A weight image is an uploaded model written
+ * back once: every tensor already in its device layout and storage dtype, packed into one payload
+ * at 256-byte aligned offsets, plus the scalar metadata the backend needs to rebuild its model
+ * struct. Opening an image maps the file, checks it against its source, allocates one device arena
+ * and copies the payload in a few large transfers through a pinned staging buffer.
+ *
+ * File layout (little-endian):
+ *   WeightImageHeader | metadata | zero padding to a 4 KiB boundary | payload
+ * The header names the backend (tag), the storage dtype and the size and content hash of the
+ * source file; an image whose source has changed is ignored and rewritten by the next load.
+ *
+ * Images live next to their source as <source>.<tag>-<dtype>.wimg and are switched on per backend
+ * by an environment variable (see the backend READMEs). A backend describes its model once as a
+ * traversal over a visitor (value / text / size / tensor); WeightImageSave records that traversal
+ * and WeightImageLoad replays it, so the two directions cannot drift apart. Writes go to a
+ * temporary file renamed into place, so concurrent workers never read a partial image.
+ */
+
+#ifndef CRTK_WEIGHT_IMAGE_IMPL_INL
+#define CRTK_WEIGHT_IMAGE_IMPL_INL
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr char WEIGHT_IMAGE_MAGIC[8] = {'C', 'R', 'T', 'K', 'W', 'I', 'M', 'G'};
+// Raised whenever a backend changes what its visitor records; older images are
+// then rejected and rebuilt from the source file.
+constexpr uint32_t WEIGHT_IMAGE_VERSION = 2;
+constexpr size_t WEIGHT_IMAGE_ALIGN = 256;
+constexpr size_t WEIGHT_IMAGE_PAGE = 4096;
+constexpr size_t WEIGHT_IMAGE_STAGE_BYTES = static_cast<size_t>(64) << 20;
+
+struct WeightImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    char tag[16];
+    uint64_t sourceBytes;
+    uint64_t sourceHash;
+    uint64_t metaBytes;
+    uint64_t payloadOffset;
+    uint64_t payloadBytes;
+};
+
+static_assert(sizeof(WeightImageHeader) == 72, "packed image header");
+
+// Read-only mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data_) munmap(data_, size_);
+    }
+
+    bool open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) return false;
+        data_ = data;
+        size_ = static_cast<size_t>(st.st_size);
+        return true;
+    }
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(data_); }
+    size_t size() const { return size_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Content hash of a whole file: FNV-1a over 8-byte words with a shift mix, then the tail bytes.
+static uint64_t weight_image_hash(const MappedFile& file) {
+    const unsigned char* p = file.data();
+    const size_t words = file.size() / 8;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t w;
+        std::memcpy(&w, p + i * 8, 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    for (size_t i = words * 8; i < file.size(); ++i) h = (h ^ p[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+// True when `env` is set to anything but "0", "off" or "false".
+static bool weight_image_enabled(const char* env) {
+    const char* value = std::getenv(env);
+    if (!value || !*value) return false;
+    return std::strcmp(value, "0") != 0 && std::strcmp(value, "off") != 0 && std::strcmp(value, "false") != 0;
+}
+
+static std::string weight_image_path(const std::string& source, const char* tag, const char* dtype) {
+    return source + "." + tag + "-" + dtype + ".wimg";
+}
+
+static size_t weight_image_align(size_t n, size_t to) {
+    return (n + to - 1) / to * to;
+}
+
+static void weight_image_fill_header(WeightImageHeader& header, const char* tag, uint32_t dtype) {
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, WEIGHT_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = WEIGHT_IMAGE_VERSION;
+    header.dtype = dtype;
+    std::strncpy(header.tag, tag, sizeof(header.tag) - 1);
+}
+
+// Builds an image in host memory and writes it in one go.
+class WeightImageWriter {
+public:
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "metadata values are plain bytes");
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+        meta_.insert(meta_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void put_text(const std::string& text) {
+        put(static_cast<uint64_t>(text.size()));
+        meta_.insert(meta_.end(), text.begin(), text.end());
+    }
+
+    // Reserves `bytes` of payload at the next aligned offset and returns that offset.
+    size_t reserve(size_t bytes) {
+        const size_t offset = weight_image_align(payload_.size(), WEIGHT_IMAGE_ALIGN);
+        payload_.resize(offset + bytes);
+        return offset;
+    }
+
+    unsigned char* at(size_t offset) { return payload_.data() + offset; }
+
+    bool write(const std::string& path, const char* tag, uint32_t dtype, uint64_t sourceBytes,
+               uint64_t sourceHash) const {
+        WeightImageHeader header;
+        weight_image_fill_header(header, tag, dtype);
+        header.sourceBytes = sourceBytes;
+        header.sourceHash = sourceHash;
+        header.metaBytes = meta_.size();
+        header.payloadOffset = weight_image_align(sizeof(header) + meta_.size(), WEIGHT_IMAGE_PAGE);
+        header.payloadBytes = payload_.size();
+
+        const std::string tmp = path + ".tmp." + std::to_string(static_cast<long long>(getpid()));
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        const std::vector<unsigned char> pad(header.payloadOffset - sizeof(header) - meta_.size(), 0);
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+                && (meta_.empty() || std::fwrite(meta_.data(), meta_.size(), 1, f) == 1)
+                && (pad.empty() || std::fwrite(pad.data(), pad.size(), 1, f) == 1)
+                && (payload_.empty() || std::fwrite(payload_.data(), payload_.size(), 1, f) == 1);
+        ok = (std::fclose(f) == 0) && ok;
+        if (ok && std::rename(tmp.c_str(), path.c_str()) == 0) return true;
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+private:
+    std::vector<unsigned char> meta_;
+    std::vector<unsigned char> payload_;
+};
+
+// A mapped image checked against its source. Metadata reads are sticky on failure: once a read
+// runs past the metadata, every later read returns zero and ok() stays false.
+class WeightImageReader {
+public:
+    bool open(const std::string& path, const char* tag, uint32_t dtype, uint64_t sourceBytes, uint64_t sourceHash) {
+        if (!file_.open(path) || file_.size() < sizeof(WeightImageHeader)) return false;
+        WeightImageHeader header;
+        std::memcpy(&header, file_.data(), sizeof(header));
+        WeightImageHeader expected;
+        weight_image_fill_header(expected, tag, dtype);
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+                || header.version != expected.version || header.dtype != dtype
+                || std::memcmp(header.tag, expected.tag, sizeof(header.tag)) != 0
+                || header.sourceBytes != sourceBytes || header.sourceHash != sourceHash) {
+            return false;
+        }
+        if (header.metaBytes > file_.size() - sizeof(header)
+                || header.payloadOffset < sizeof(header) + header.metaBytes
+                || header.payloadOffset % WEIGHT_IMAGE_PAGE != 0
+                || header.payloadOffset > file_.size()
+                || header.payloadBytes != file_.size() - header.payloadOffset) {
+            return false;
+        }
+        meta_ = file_.data() + sizeof(header);
+        metaBytes_ = static_cast<size_t>(header.metaBytes);
+        payload_ = file_.data() + header.payloadOffset;
+        payloadBytes_ = static_cast<size_t>(header.payloadBytes);
+        pos_ = 0;
+        ok_ = true;
+        return true;
+    }
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "metadata values are plain bytes");
+        T value{};
+        if (!take(sizeof(T))) return value;
+        std::memcpy(&value, meta_ + pos_ - sizeof(T), sizeof(T));
+        return value;
+    }
+
+    std::string get_text() {
+        const uint64_t n = get<uint64_t>();
+        if (n > remaining() || !take(static_cast<size_t>(n))) return std::string();
+        return std::string(reinterpret_cast<const char*>(meta_ + pos_ - n), static_cast<size_t>(n));
+    }
+
+    size_t remaining() const { return ok_ ? metaBytes_ - pos_ : 0; }
+    bool done() const { return ok_ && pos_ == metaBytes_; }
+    bool ok() const { return ok_; }
+    void fail() { ok_ = false; }
+
+    const unsigned char* payload() const { return payload_; }
+    size_t payload_bytes() const { return payloadBytes_; }
+
+private:
+    MappedFile file_;
+    const unsigned char* meta_ = nullptr;
+    size_t metaBytes_ = 0;
+    const unsigned char* payload_ = nullptr;
+    size_t payloadBytes_ = 0;
+    size_t pos_ = 0;
+    bool ok_ = false;
+
+    bool take(size_t n) {
+        if (!ok_ || n > metaBytes_ - pos_) {
+            ok_ = false;
+            return false;
+        }
+        pos_ += n;
+        return true;
+    }
+};
+
+/*
+ * Copies the payload to the device, WEIGHT_IMAGE_STAGE_BYTES at a time, through
+ *   copy(size_t offset, const void* src, size_t bytes) -> bool (blocking host-to-device copy)
+ * `stage` is a pinned host buffer of at least min(payload, WEIGHT_IMAGE_STAGE_BYTES) bytes, or
+ * null to copy straight from the (pageable) mapping.
+ */
+template <typename Copy>
+static bool weight_image_upload(const WeightImageReader& image, unsigned char* stage, Copy&& copy) {
+    const size_t bytes = image.payload_bytes();
+    for (size_t off = 0; off < bytes; off += WEIGHT_IMAGE_STAGE_BYTES) {
+        const size_t n = std::min(WEIGHT_IMAGE_STAGE_BYTES, bytes - off);
+        const unsigned char* src = image.payload() + off;
+        if (stage) {
+            std::memcpy(stage, src, n);
+            src = stage;
+        }
+        if (!copy(off, src, n)) return false;
+    }
+    return true;
+}
+
+/*
+ * Visitor that records a model: values and texts go to the metadata, and every device tensor is
+ * downloaded into the payload through
+ *   fetch(void* host, const void* device, size_t bytes) -> bool
+ * `count` is the tensor's element count; 0 records a null pointer.
+ */
+template <typename Fetch>
+class WeightImageSave {
+public:
+    WeightImageSave(WeightImageWriter& writer, Fetch fetch) : writer_(writer), fetch_(std::move(fetch)) {}
+
+    template <typename T>
+    void value(T& v) { writer_.put(v); }
+
+    void text(std::string& s) { writer_.put_text(s); }
+
+    template <typename Vec>
+    void size(Vec& items) { writer_.put(static_cast<uint64_t>(items.size())); }
+
+    template <typename T>
+    void tensor(T*& device, size_t count) {
+        if (!device) count = 0;
+        writer_.put(static_cast<uint64_t>(count));
+        if (count == 0) return;
+        const size_t bytes = count * sizeof(T);
+        const size_t offset = writer_.reserve(bytes);
+        writer_.put(static_cast<uint64_t>(offset));
+        ok_ = ok_ && fetch_(writer_.at(offset), device, bytes);
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    WeightImageWriter& writer_;
+    Fetch fetch_;
+    bool ok_ = true;
+};
+
+// Visitor that rebuilds a model from an image whose payload already sits at `arena` on the device.
+// Tensor pointers point into the arena; element counts come from the image.
+class WeightImageLoad {
+public:
+    WeightImageLoad(WeightImageReader& image, unsigned char* arena) : image_(image), arena_(arena) {}
+
+    template <typename T>
+    void value(T& v) { v = image_.get<T>(); }
+
+    void text(std::string& s) { s = image_.get_text(); }
+
+    // Every element records at least one metadata byte, which bounds the count.
+    template <typename Vec>
+    void size(Vec& items) {
+        const uint64_t n = image_.get<uint64_t>();
+        if (n > image_.remaining()) {
+            image_.fail();
+            return;
+        }
+        items.resize(static_cast<size_t>(n));
+    }
+
+    template <typename T>
+    void tensor(T*& device, size_t) {
+        device = nullptr;
+        const uint64_t count = image_.get<uint64_t>();
+        if (count == 0) return;
+        const uint64_t offset = image_.get<uint64_t>();
+        const size_t payload = image_.payload_bytes();
+        if (offset % WEIGHT_IMAGE_ALIGN != 0 || offset > payload || count > (payload - offset) / sizeof(T)) {
+            image_.fail();
+            return;
+        }
+        device = reinterpret_cast<T*>(arena_ + offset);
+    }
+
+    bool ok() const { return image_.done(); }
+
+private:
+    WeightImageReader& image_;
+    unsigned char* arena_;
+};
+
+} // namespace
+
+#endif // CRTK_WEIGHT_IMAGE_IMPL_INL
@@ -8,7 +8,7 @@
  *
  * It builds into a shared library (lc0_cuda) that is loaded via JNI and provides:
  *   - a lightweight CUDA availability check (device count)
- *   - a minimal, batch-size-1 LC0 CNN ".bin" evaluator that runs a single forward pass:
+ *   - a minimal LC0 CNN ".bin" evaluator that runs batched forward passes:
  *       input planes -> trunk -> policy logits + value(WDL)
  *
  * JNI surface
@@ -16,23 +16,86 @@
  * Exported native methods (names must match their Java declarations):
  *   - chess.nn.lc0.cnn.cuda.Support.nativeDeviceCount() -> int
  *   - chess.nn.lc0.cnn.cuda.Backend.nativeCreate(String weightsPath) -> long (opaque handle)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeCreateOnDevice(String weightsPath, int device) -> long
+ *       (nativeCreate is device 0)
  *   - chess.nn.lc0.cnn.cuda.Backend.nativeDestroy(long handle) -> void
- *   - chess.nn.lc0.cnn.cuda.Backend.nativeGetInfo(long handle) -> long[7]
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeGetInfo(long handle) -> long[13]
+ *       [inputC, trunkC, blocks, policyC, valueC, policySize, paramCount, maxBatch, dtype, weightBytes,
+ *        graphs, evalCount, meanEvalNanos]
+ *       (dtype: 0 = fp32, 1 = fp16, 2 = bf16; weightBytes approximates device weight storage;
+ *        graphs is 1 while graph replay is active; meanEvalNanos is host wall time per eval_batch)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeGetStatNames(long handle) -> String (comma-separated)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeGetStats(long handle, boolean reset) -> long[1 + 4 * stages]
+ *       [enabled, then per stage: calls, bytes, deviceNanos, hostNanos] (../common/gpu_stats_impl.inl)
  *   - chess.nn.lc0.cnn.cuda.Backend.nativePredict(long handle, float[] encoded, float[] policyOut, float[] wdlOut) -> float
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePredictBatch(long handle, float[] encoded, int count,
+ *       float[] policyOut, float[] wdlOut, float[] valueOut) -> int (positions evaluated)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePinnedBuffers(long handle) -> ByteBuffer[3] {input, policy, wdl}
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePredictPinned(long handle, int count) -> int (positions evaluated)
+ *       (pinned host buffers sized for maxBatch, see ../common/pinned_io_impl.inl)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePredictPacked(long handle, long[] packed, int count,
+ *       float[] policyOut, float[] wdlOut, float[] valueOut) -> int (positions evaluated)
+ *       (count positions of inputC + 1 longs, expanded on the device, see ../common/packed_planes_impl.inl)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeQueueCreate(long handle, int maxBatch, long deadlineMicros) -> long
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeQueueSubmit(long queue, float[] encoded) -> long (ticket)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeQueueTake(long queue, float[] policyOut, float[] wdlOut) -> long
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativeQueueClose(long queue) / nativeQueueDestroy(long queue) -> void
+ *       (coalescing evaluation queue, see ../common/eval_queue_impl.inl)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePoolCreate(String weightsPath, int[] devices) -> long
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePoolDestroy(long pool) -> void
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePoolGetInfo(long pool) -> long[13] (first replica)
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePoolPredictBatch / nativePoolPredictPacked: as the
+ *       single-handle forms, spread over the replicas
+ *   - chess.nn.lc0.cnn.cuda.Backend.nativePoolStats(long pool) -> long[3 * replicas]
+ *       {device, calls, positions} (one replica per device, see ../common/replica_pool_impl.inl)
  *
  * Data / shapes
  * -------------
  * This backend expects the LC0 "classical" input encoding used by this repo:
  *   - encoded input: float[inputC * 64], where squares are ordered 0..63 (8x8).
- *   - weights format: ChessRTK LC0 CNN ".bin", matching the Java CPU loader.
+ *   - batched input: float[count * inputC * 64], positions back to back; outputs are laid out the
+ *     same way (policy float[count * policySize], WDL float[count * 3], value float[count]).
+ *   - weights format: ChessRTK LC0 CNN ".bin", matching the Java CPU loader, parsed on the host by
+ *     ../common/lc0_cnn_loader_impl.inl (shared with the host CPU backend) and then uploaded.
  *
  * Internals
  * ---------
  * The evaluator stores all weights and intermediate work buffers on the GPU:
- *   - Convolution weights: float[outC][inC][k][k] (k is 1 or 3)
+ *   - Convolution weights: W[outC][inC][k][k] (k is 1 or 3)
  *   - Bias vectors: float[outC]
- *   - Dense weights: float[outD][inD], biases float[outD]
- * It uses simple CUDA kernels on the default stream. There is no batching.
+ *   - Dense weights: W[outD][inD], biases float[outD]
+ *   (W is float, half or bfloat16, see below)
+ * Activation buffers hold up to maxBatch positions ([maxBatch][C][64]); every kernel takes the batch
+ * index from blockIdx.y (per-channel kernels) or folds it into the flat element index (elementwise
+ * kernels), so one launch per layer covers the whole batch. maxBatch defaults to 64 and can be set
+ * with CRTK_LC0_CUDA_MAX_BATCH; larger requests are evaluated in maxBatch-sized chunks.
+ *
+ * 3x3 convolutions run through one of two engines, chosen once in create_net from
+ * CRTK_LC0_CUDA_CONV:
+ *   - "igemm" (default): implicit GEMM, one block per 16 output channels x 64 squares; input
+ *     channels are staged 16 at a time into shared memory as zero-padded 10x10 planes together
+ *     with the matching weight slice, and bias/ReLU/residual are applied in the epilogue.
+ *   - "direct": the original one-thread-per-output scalar loop plus separate bias/residual kernels.
+ * 1x1 convolutions always use the direct kernel.
+ * Kernels run on a per-handle non-blocking stream. Unless CRTK_LC0_CUDA_GRAPHS=0, the kernel
+ * sequence of a forward pass is captured into a CUDA graph the first time each batch size is
+ * evaluated and replayed on later calls, so a predict costs one graph launch instead of one launch
+ * per layer. Capture relies on every workspace pointer staying fixed across calls; a failed capture
+ * disables graphs for the handle and falls back to direct launches.
+ *
+ * With CRTK_LC0_CUDA_STATS=1 a handle launches directly and times its stages with events
+ * (../common/gpu_stats_impl.inl): upload, packed expansion, input conv, the residual convs and the
+ * SE units of the tower, the two heads, the download and the host-side WDL softmax. The totals are
+ * read with nativeGetStats.
+ *
+ * Weight matrices (conv, SE and dense) can be stored in reduced precision, chosen once in
+ * create_net from CRTK_LC0_CUDA_DTYPE=fp32|fp16|bf16 (default fp32, matching the T5 backend's
+ * DType switch). Kernels convert each weight to float on load and accumulate in fp32; biases stay
+ * fp32. fp16/bf16 halve the device memory of a loaded net and the weight bandwidth per predict.
+ *
+ * The uploaded weights (GpuModel) are shared by every handle that opens the same file on the same
+ * device with the same dtype (../common/weight_cache_impl.inl); a handle (GpuNet) owns only its
+ * workspace, stream and graphs, so opening one handle per search thread costs one copy of the net.
  *
  * Error handling / limitations
  * ----------------------------
@@ -40,23 +103,51 @@
  * - Many failures return 0/false and let Java fall back to CPU (unless CUDA is forced).
  * - Kernel launches are not exhaustively checked for async errors; hard failures typically surface
  *   on the next cudaMemcpy/cuda API call.
- * - Device selection is currently fixed to device 0.
+ * - A handle lives on the device it was created on (nativeCreate uses device 0). The current CUDA
+ *   device is per host thread, so every entry point that touches the handle selects it first.
  * - Treat a GpuNet instance as single-threaded; callers should not share one handle across threads.
+ *   Concurrent callers should go through the evaluation queue, whose dispatcher thread is the only
+ *   one that touches the handle.
  */
 
 #include <jni.h>
 
 #include <cuda_runtime.h>
+#include <cuda_fp16.h>
+#include <cuda_bf16.h>
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
-#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
 
+// Event and stream types for ../common/gpu_stats_impl.inl.
+#define CRTK_GPU_STATS_SUCCESS cudaSuccess
+#define CRTK_GPU_STATS_STREAM cudaStream_t
+#define CRTK_GPU_STATS_EVENT cudaEvent_t
+#define CRTK_GPU_STATS_EVENT_CREATE(ptr) cudaEventCreate(ptr)
+#define CRTK_GPU_STATS_EVENT_DESTROY(event) cudaEventDestroy(event)
+#define CRTK_GPU_STATS_EVENT_RECORD(event, stream) cudaEventRecord(event, stream)
+#define CRTK_GPU_STATS_EVENT_ELAPSED(ms, start, stop) cudaEventElapsedTime(ms, start, stop)
+#ifdef CRTK_GPU_RANGES
+#include <nvtx3/nvToolsExt.h>
+#define CRTK_GPU_STATS_RANGE_PUSH(name) nvtxRangePushA(name)
+#define CRTK_GPU_STATS_RANGE_POP() nvtxRangePop()
+#endif
+#include "../common/eval_queue_impl.inl"
+#include "../common/gpu_stats_impl.inl"
+#include "../common/lc0_cnn_loader_impl.inl"
+#include "../common/pinned_io_impl.inl"
+#include "../common/packed_planes_impl.inl"
+#include "../common/replica_pool_impl.inl"
+#include "../common/weight_cache_impl.inl"
+
 static inline int device_count() {
     int count = 0;
     cudaError_t err = cudaGetDeviceCount(&count);
@@ -77,11 +168,43 @@ extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_cuda_Support_nativeDevic
 // Minimal LC0 CNN GPU evaluator
 // -------------------------
 
+enum class DType {
+    F32,
+    F16,
+    BF16
+};
+
+typedef half WeightF16;
+typedef __nv_bfloat16 WeightBF16;
+
+static inline __host__ __device__ WeightF16 to_half(float v) { return __float2half_rn(v); }
+static inline __host__ __device__ WeightBF16 to_bf16(float v) { return __float2bfloat16(v); }
+
+// Device weight matrix stored in the net's DType; exactly one pointer is set.
+struct DeviceWeights {
+    float* f32 = nullptr;
+    WeightF16* f16 = nullptr;
+    WeightBF16* bf16 = nullptr;
+};
+
+enum class ConvEngine {
+    Direct,
+    ImplicitGemm,
+};
+
+// Fused epilogue applied after a convolution (igemm path) or by a follow-up kernel (direct path).
+enum ConvEpilogue {
+    EPI_NONE = 0,              // raw conv output
+    EPI_BIAS = 1,              // + bias
+    EPI_BIAS_RELU = 2,         // relu(+ bias)
+    EPI_BIAS_RESIDUAL_RELU = 3 // relu(+ bias + residual)
+};
+
 struct ConvLayer {
     int inC = 0;
     int outC = 0;
     int k = 0;
-    float* d_w = nullptr;   // [outC][inC][k][k]
+    DeviceWeights w;        // [outC][inC][k][k]
     float* d_b = nullptr;   // [outC]
     int64_t params = 0;
 };
@@ -89,7 +212,7 @@ struct ConvLayer {
 struct DenseLayer {
     int inD = 0;
     int outD = 0;
-    float* d_w = nullptr;  // [outD][inD]
+    DeviceWeights w;       // [outD][inD]
     float* d_b = nullptr;  // [outD]
     int64_t params = 0;
 };
@@ -97,9 +220,9 @@ struct DenseLayer {
 struct SeUnit {
     int channels = 0;
     int hidden = 0;
-    float* d_w1 = nullptr; // [hidden][channels]
+    DeviceWeights w1;      // [hidden][channels]
     float* d_b1 = nullptr; // [hidden]
-    float* d_w2 = nullptr; // [2*channels][hidden]
+    DeviceWeights w2;      // [2*channels][hidden]
     float* d_b2 = nullptr; // [2*channels]
     int64_t params = 0;
 };
@@ -111,7 +234,10 @@ struct ResidualBlock {
     SeUnit se;
 };
 
-struct GpuNet {
+// Immutable weights of one loaded net, resident on `device` and shared by every handle opened on
+// the same file, device and dtype (see ../common/weight_cache_impl.inl).
+struct GpuModel {
+    int device = 0;
     int inputC = 0;
     int trunkC = 0;
     int blocks = 0;
@@ -119,6 +245,8 @@ struct GpuNet {
     int valueC = 0;
     int valueHidden = 0;
     int policySize = 0;
+    DType dtype = DType::F32;
+    int64_t weightBytes = 0;
     int64_t paramCount = 0;
 
     ConvLayer inputLayer;
@@ -131,27 +259,79 @@ struct GpuNet {
 
     int* d_policyMap = nullptr;
     int policyMapLen = 0;
-    float* d_policyMapped = nullptr; // [policySize]
-
-    // Workspace (device).
-    float* d_in = nullptr;        // [inputC*64]
-    float* d_cur = nullptr;       // [trunkC*64]
-    float* d_next = nullptr;      // [trunkC*64]
-    float* d_tmp = nullptr;       // [trunkC*64]
-    float* d_scratch = nullptr;   // [trunkC*64]
-    float* d_policyHidden = nullptr; // [trunkC*64]
-    float* d_policyPlanes = nullptr; // [policyC*64]
-    float* d_valueInput = nullptr;   // [valueC*64]
-    float* d_fc1 = nullptr;          // [valueHidden]
-    float* d_logits = nullptr;       // [3]
+    int seMaxHidden = 0; // widest SE hidden layer in the tower
+};
+
+// Timed stages, in nativeGetStats order.
+enum Lc0Stage : int {
+    LC0_STAGE_UPLOAD = 0,   // planes or packed words, host to device
+    LC0_STAGE_EXPAND = 1,   // packed words to planes
+    LC0_STAGE_INPUT = 2,    // input conv
+    LC0_STAGE_TOWER = 3,    // the two convs of every residual block
+    LC0_STAGE_SE = 4,       // pool, FC1, FC2 and gating of every SE unit
+    LC0_STAGE_POLICY = 5,
+    LC0_STAGE_VALUE = 6,
+    LC0_STAGE_DOWNLOAD = 7, // policy and WDL logits, device to host
+    LC0_STAGE_WDL = 8,      // host softmax of the WDL logits
+    LC0_STAGES = 9
+};
+
+static const char* const LC0_STAGE_NAMES[LC0_STAGES] = {
+    "upload", "expand", "input", "tower", "se", "policy", "value", "download", "wdl"
+};
+
+struct GpuNet {
+    std::shared_ptr<const GpuModel> model;
+    int device = 0;
+    int maxBatch = 1;
+    ConvEngine convEngine = ConvEngine::ImplicitGemm;
+
+    // Workspace (device), every buffer has a leading [maxBatch] dimension.
+    float* d_in = nullptr;        // [B][inputC*64]
+    unsigned long long* d_packed = nullptr; // [B][inputC+1], null until the first packed predict
+    float* d_cur = nullptr;       // [B][trunkC*64]
+    float* d_next = nullptr;      // [B][trunkC*64]
+    float* d_tmp = nullptr;       // [B][trunkC*64]
+    float* d_scratch = nullptr;   // [B][trunkC*64]
+    float* d_policyHidden = nullptr; // [B][trunkC*64]
+    float* d_policyPlanes = nullptr; // [B][policyC*64]
+    float* d_valueInput = nullptr;   // [B][valueC*64]
+    float* d_fc1 = nullptr;          // [B][valueHidden]
+    float* d_logits = nullptr;       // [B][3]
+    float* d_policyMapped = nullptr; // [B][policySize]
 
     // SE workspace (max sizes: trunkC, 2*trunkC).
-    float* d_sePooled = nullptr;  // [trunkC]
-    float* d_seHidden = nullptr;  // [maxHidden] (we assume constant across blocks; allocate max found)
-    float* d_seGates = nullptr;   // [2*trunkC]
-    int seMaxHidden = 0;
+    float* d_sePooled = nullptr;  // [B][trunkC]
+    float* d_seHidden = nullptr;  // [B][maxHidden] (we assume constant across blocks; allocate max found)
+    float* d_seGates = nullptr;   // [B][2*trunkC]
+
+    // Host staging for batched predict (sized to maxBatch once, reused across calls).
+    std::vector<float> h_logits;  // [B][3]
+
+    // Pinned host buffers handed to Java as direct ByteBuffers; null until first requested.
+    float* h_pinnedIn = nullptr;      // [B][inputC][64]
+    float* h_pinnedPolicy = nullptr;  // [B][policySize]
+    float* h_pinnedWdl = nullptr;     // [B][3]
+    std::vector<float> h_pinnedValues; // [B]
+
+    // Launch state: every kernel runs on `stream`; graphs[b] replays the forward pass for batch b.
+    cudaStream_t stream = nullptr;
+    bool useGraphs = true;
+    std::vector<cudaGraphExec_t> graphs; // [maxBatch + 1], null until captured
+
+    // Per-eval wall time (host view: upload, forward, download), reported by nativeGetInfo.
+    int64_t evalCount = 0;
+    int64_t evalNanos = 0;
+
+    // Per-stage counters (CRTK_LC0_CUDA_STATS); when enabled, forward passes launch directly.
+    GpuStats stats;
 };
 
+// Makes the handle's device current on the calling thread.
+static bool bind_device(const GpuNet* net) {
+    return cudaSetDevice(net->device) == cudaSuccess;
+}
+
 static void cuda_free(void* p) {
     if (p) cudaFree(p);
 }
@@ -163,6 +343,17 @@ static bool cuda_alloc(T** out, size_t count) {
     return err == cudaSuccess;
 }
 
+static void cuda_free_host(void* p) {
+    if (p) cudaFreeHost(p);
+}
+
+template <typename T>
+static bool cuda_alloc_host(T** out, size_t count) {
+    *out = nullptr;
+    cudaError_t err = cudaMallocHost(reinterpret_cast<void**>(out), sizeof(T) * count);
+    return err == cudaSuccess;
+}
+
 template <typename T>
 static bool cuda_copy_to_device(T* dst, const std::vector<T>& src) {
     cudaError_t err = cudaMemcpy(dst, src.data(), sizeof(T) * src.size(), cudaMemcpyHostToDevice);
@@ -175,102 +366,138 @@ static bool cuda_copy_to_device(T* dst, const T* src, size_t count) {
     return err == cudaSuccess;
 }
 
-// ---- file parsing helpers (LC0 CNN .bin) ----
+static ConvEngine conv_engine_from_env() {
+    const char* env = std::getenv("CRTK_LC0_CUDA_CONV");
+    if (env && std::strcmp(env, "direct") == 0) return ConvEngine::Direct;
+    return ConvEngine::ImplicitGemm;
+}
 
-static bool read_u8(std::ifstream& f, uint8_t& out) {
-    f.read(reinterpret_cast<char*>(&out), 1);
-    return bool(f);
+// Asked of the current device, which create_net has just selected.
+static bool supports_bf16() {
+    int device = 0;
+    int major = 0;
+    if (cudaGetDevice(&device) != cudaSuccess) return false;
+    if (cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor, device) != cudaSuccess) return false;
+    return major >= 8; // Ampere+ supports BF16
 }
 
-static bool read_i32(std::ifstream& f, int32_t& out) {
-    f.read(reinterpret_cast<char*>(&out), 4);
-    return bool(f);
+static DType parse_dtype() {
+    const char* env = std::getenv("CRTK_LC0_CUDA_DTYPE");
+    if (!env) return DType::F32;
+    std::string value(env);
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (value == "fp16" || value == "f16" || value == "half") return DType::F16;
+    if (value == "bf16" || value == "bfloat16") return supports_bf16() ? DType::BF16 : DType::F16;
+    return DType::F32;
 }
 
-static bool read_bytes(std::ifstream& f, void* dst, size_t n) {
-    f.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n));
-    return bool(f);
+static size_t dtype_size(DType dtype) {
+    return dtype == DType::F32 ? sizeof(float) : sizeof(WeightF16);
 }
 
-static bool read_float_array(std::ifstream& f, std::vector<float>& out) {
-    int32_t size = 0;
-    if (!read_i32(f, size)) return false;
-    if (size < 0) return false;
-    out.resize(static_cast<size_t>(size));
-    return read_bytes(f, out.data(), sizeof(float) * out.size());
+static bool upload_weights(const std::vector<float>& w, DType dtype, DeviceWeights& out) {
+    if (dtype == DType::F32) {
+        return cuda_alloc(&out.f32, w.size()) && cuda_copy_to_device(out.f32, w);
+    }
+    if (dtype == DType::F16) {
+        std::vector<WeightF16> h(w.size());
+        for (size_t i = 0; i < w.size(); i++) h[i] = to_half(w[i]);
+        return cuda_alloc(&out.f16, h.size()) && cuda_copy_to_device(out.f16, h);
+    }
+    std::vector<WeightBF16> b(w.size());
+    for (size_t i = 0; i < w.size(); i++) b[i] = to_bf16(w[i]);
+    return cuda_alloc(&out.bf16, b.size()) && cuda_copy_to_device(out.bf16, b);
 }
 
-static bool load_conv(std::ifstream& f, ConvLayer& out) {
-    int32_t oc, ic, k;
-    if (!read_i32(f, oc) || !read_i32(f, ic) || !read_i32(f, k)) return false;
-    std::vector<float> w;
-    std::vector<float> b;
-    if (!read_float_array(f, w) || !read_float_array(f, b)) return false;
-    out.inC = ic;
-    out.outC = oc;
-    out.k = k;
-    out.params = static_cast<int64_t>(w.size()) + static_cast<int64_t>(b.size());
-    if (!cuda_alloc(&out.d_w, w.size())) return false;
-    if (!cuda_alloc(&out.d_b, b.size())) return false;
-    if (!cuda_copy_to_device(out.d_w, w)) return false;
-    if (!cuda_copy_to_device(out.d_b, b)) return false;
-    return true;
+static void free_weights(DeviceWeights& w) {
+    cuda_free(w.f32);
+    cuda_free(w.f16);
+    cuda_free(w.bf16);
+    w = DeviceWeights();
 }
 
-static bool load_dense(std::ifstream& f, DenseLayer& out, int expectedOut) {
-    int32_t od, id;
-    if (!read_i32(f, od) || !read_i32(f, id)) return false;
-    if (od != expectedOut) return false;
-    std::vector<float> w;
-    std::vector<float> b;
-    if (!read_float_array(f, w) || !read_float_array(f, b)) return false;
-    out.inD = id;
-    out.outD = od;
-    out.params = static_cast<int64_t>(w.size()) + static_cast<int64_t>(b.size());
-    if (!cuda_alloc(&out.d_w, w.size())) return false;
-    if (!cuda_alloc(&out.d_b, b.size())) return false;
-    if (!cuda_copy_to_device(out.d_w, w)) return false;
-    if (!cuda_copy_to_device(out.d_b, b)) return false;
-    return true;
+// Calls launch(ptr) with whichever typed weight pointer is populated.
+template <typename Launch>
+static void with_weights(const DeviceWeights& w, Launch&& launch) {
+    if (w.f16) {
+        launch(static_cast<const WeightF16*>(w.f16));
+    } else if (w.bf16) {
+        launch(static_cast<const WeightBF16*>(w.bf16));
+    } else {
+        launch(static_cast<const float*>(w.f32));
+    }
 }
 
-static bool load_se(std::ifstream& f, SeUnit& out, bool& present, int channels, int& maxHidden) {
-    uint8_t p = 0;
-    if (!read_u8(f, p)) return false;
-    present = (p != 0);
-    if (!present) return true;
-    int32_t hidden = 0;
-    int32_t expectedChannels = 0;
-    if (!read_i32(f, hidden) || !read_i32(f, expectedChannels)) return false;
-    if (expectedChannels != channels) return false;
-    std::vector<float> w1, b1, w2, b2;
-    if (!read_float_array(f, w1) || !read_float_array(f, b1) || !read_float_array(f, w2) || !read_float_array(f, b2)) return false;
-    out.channels = channels;
-    out.hidden = hidden;
-    out.params = static_cast<int64_t>(w1.size() + b1.size() + w2.size() + b2.size());
-    maxHidden = std::max(maxHidden, hidden);
-
-    if (!cuda_alloc(&out.d_w1, w1.size())) return false;
-    if (!cuda_alloc(&out.d_b1, b1.size())) return false;
-    if (!cuda_alloc(&out.d_w2, w2.size())) return false;
-    if (!cuda_alloc(&out.d_b2, b2.size())) return false;
-    if (!cuda_copy_to_device(out.d_w1, w1)) return false;
-    if (!cuda_copy_to_device(out.d_b1, b1)) return false;
-    if (!cuda_copy_to_device(out.d_w2, w2)) return false;
-    if (!cuda_copy_to_device(out.d_b2, b2)) return false;
-    return true;
+static bool stats_from_env() {
+    return gpu_stats_from_env("CRTK_LC0_CUDA_STATS");
+}
+
+static bool graphs_from_env() {
+    const char* env = std::getenv("CRTK_LC0_CUDA_GRAPHS");
+    if (!env) return true;
+    std::string value(env);
+    return !(value == "0" || value == "off" || value == "false");
+}
+
+static int max_batch_from_env() {
+    const char* env = std::getenv("CRTK_LC0_CUDA_MAX_BATCH");
+    if (!env || !*env) return 64;
+    long v = std::strtol(env, nullptr, 10);
+    if (v < 1) return 1;
+    if (v > 4096) return 4096;
+    return static_cast<int>(v);
+}
+
+// ---- weight upload (layers parsed by ../common/lc0_cnn_loader_impl.inl) ----
+
+static bool upload_conv(const Lc0Conv& src, ConvLayer& out, DType dtype) {
+    out.inC = src.inC;
+    out.outC = src.outC;
+    out.k = src.k;
+    out.params = src.params();
+    if (!upload_weights(src.w, dtype, out.w)) return false;
+    return cuda_alloc(&out.d_b, src.b.size()) && cuda_copy_to_device(out.d_b, src.b);
+}
+
+static bool upload_dense(const Lc0Dense& src, DenseLayer& out, DType dtype) {
+    out.inD = src.inD;
+    out.outD = src.outD;
+    out.params = src.params();
+    if (!upload_weights(src.w, dtype, out.w)) return false;
+    return cuda_alloc(&out.d_b, src.b.size()) && cuda_copy_to_device(out.d_b, src.b);
+}
+
+static bool upload_se(const Lc0Se& src, SeUnit& out, DType dtype) {
+    out.channels = src.channels;
+    out.hidden = src.hidden;
+    out.params = src.params();
+    if (!upload_weights(src.w1, dtype, out.w1)) return false;
+    if (!upload_weights(src.w2, dtype, out.w2)) return false;
+    if (!cuda_alloc(&out.d_b1, src.b1.size()) || !cuda_copy_to_device(out.d_b1, src.b1)) return false;
+    return cuda_alloc(&out.d_b2, src.b2.size()) && cuda_copy_to_device(out.d_b2, src.b2);
 }
 
 // ---- CUDA kernels ----
+//
+// Batched layout: activations are [batch][channels][64]. Per-channel kernels launch with
+// grid (channels, batch) and read the batch index from blockIdx.y; elementwise kernels cover
+// batch * channels * 64 elements and recover the channel with (idx >> 6) % channels.
 
 __device__ __forceinline__ float relu(float x) { return x > 0.0f ? x : 0.0f; }
 __device__ __forceinline__ float sigmoid(float x) { return 1.0f / (1.0f + expf(-x)); }
 
-__global__ void k_conv3x3_no_bias(const float* __restrict__ input, const float* __restrict__ w,
+__device__ __forceinline__ float load_w(const float* w, size_t i) { return w[i]; }
+__device__ __forceinline__ float load_w(const WeightF16* w, size_t i) { return __half2float(w[i]); }
+__device__ __forceinline__ float load_w(const WeightBF16* w, size_t i) { return __bfloat162float(w[i]); }
+
+template <typename W>
+__global__ void k_conv3x3_no_bias(const float* __restrict__ input, const W* __restrict__ w,
                                  int inC, int outC, float* __restrict__ out) {
     int oc = blockIdx.x;
     int s = threadIdx.x;
     if (oc >= outC || s >= 64) return;
+    input += static_cast<size_t>(blockIdx.y) * inC * 64;
+    out += static_cast<size_t>(blockIdx.y) * outC * 64;
     int row = s >> 3;
     int col = s & 7;
     float acc = 0.0f;
@@ -291,48 +518,52 @@ __global__ void k_conv3x3_no_bias(const float* __restrict__ input, const float*
             for (int kx = -1; kx <= 1; kx++, idx++) {
                 int c = col + kx;
                 if (c < 0 || c >= 8) continue;
-                acc += input[inRowBase + c] * w[wBase + idx];
+                acc += input[inRowBase + c] * load_w(w, wBase + idx);
             }
         }
     }
     out[oc * 64 + s] = acc;
 }
 
-__global__ void k_conv1x1_no_bias(const float* __restrict__ input, const float* __restrict__ w,
+template <typename W>
+__global__ void k_conv1x1_no_bias(const float* __restrict__ input, const W* __restrict__ w,
                                  int inC, int outC, float* __restrict__ out) {
     int oc = blockIdx.x;
     int s = threadIdx.x;
     if (oc >= outC || s >= 64) return;
+    input += static_cast<size_t>(blockIdx.y) * inC * 64;
+    out += static_cast<size_t>(blockIdx.y) * outC * 64;
     float acc = 0.0f;
     const int ocBase = oc * inC;
     for (int ic = 0; ic < inC; ic++) {
-        acc += input[ic * 64 + s] * w[ocBase + ic];
+        acc += input[ic * 64 + s] * load_w(w, ocBase + ic);
     }
     out[oc * 64 + s] = acc;
 }
 
-__global__ void k_add_bias_relu(float* x, const float* __restrict__ b, int channels) {
+__global__ void k_add_bias_relu(float* x, const float* __restrict__ b, int channels, int batch) {
     int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    int total = channels * 64;
+    int total = batch * channels * 64;
     if (idx >= total) return;
-    int ch = idx >> 6;
+    int ch = (idx >> 6) % channels;
     x[idx] = relu(x[idx] + b[ch]);
 }
 
-__global__ void k_add_bias(float* x, const float* __restrict__ b, int channels) {
+__global__ void k_add_bias(float* x, const float* __restrict__ b, int channels, int batch) {
     int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    int total = channels * 64;
+    int total = batch * channels * 64;
     if (idx >= total) return;
-    int ch = idx >> 6;
+    int ch = (idx >> 6) % channels;
     x[idx] = x[idx] + b[ch];
 }
 
 __global__ void k_add_residual_relu(const float* __restrict__ convOut, const float* __restrict__ bias,
-                                   const float* __restrict__ residual, int channels, float* __restrict__ dest) {
+                                   const float* __restrict__ residual, int channels, int batch,
+                                   float* __restrict__ dest) {
     int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    int total = channels * 64;
+    int total = batch * channels * 64;
     if (idx >= total) return;
-    int ch = idx >> 6;
+    int ch = (idx >> 6) % channels;
     float v = convOut[idx] + bias[ch] + residual[idx];
     dest[idx] = relu(v);
 }
@@ -342,40 +573,45 @@ __global__ void k_se_pool(const float* __restrict__ convOut, const float* __rest
     int ch = blockIdx.x;
     int t = threadIdx.x;
     if (ch >= channels || t >= 64) return;
+    const size_t plane = static_cast<size_t>(blockIdx.y) * channels + ch;
     __shared__ float buf[64];
-    buf[t] = convOut[ch * 64 + t];
+    buf[t] = convOut[plane * 64 + t];
     __syncthreads();
     for (int stride = 32; stride > 0; stride >>= 1) {
         if (t < stride) buf[t] += buf[t + stride];
         __syncthreads();
     }
     if (t == 0) {
-        pooled[ch] = (buf[0] * (1.0f / 64.0f)) + bias[ch];
+        pooled[plane] = (buf[0] * (1.0f / 64.0f)) + bias[ch];
     }
 }
 
-__global__ void k_se_fc1(const float* __restrict__ pooled, const float* __restrict__ w1, const float* __restrict__ b1,
-                         int channels, int hidden, float* __restrict__ outHidden) {
+template <typename W>
+__global__ void k_se_fc1(const float* __restrict__ pooled, const W* __restrict__ w1, const float* __restrict__ b1,
+                         int channels, int hidden, int hiddenStride, float* __restrict__ outHidden) {
     int h = blockIdx.x * blockDim.x + threadIdx.x;
     if (h >= hidden) return;
+    pooled += static_cast<size_t>(blockIdx.y) * channels;
     float acc = b1[h];
-    const float* row = w1 + (static_cast<size_t>(h) * channels);
+    const W* row = w1 + (static_cast<size_t>(h) * channels);
     for (int ch = 0; ch < channels; ch++) {
-        acc += row[ch] * pooled[ch];
+        acc += load_w(row, ch) * pooled[ch];
     }
-    outHidden[h] = relu(acc);
+    outHidden[static_cast<size_t>(blockIdx.y) * hiddenStride + h] = relu(acc);
 }
 
-__global__ void k_se_fc2(const float* __restrict__ hiddenVec, const float* __restrict__ w2, const float* __restrict__ b2,
-                         int hidden, int outDim, float* __restrict__ gates) {
+template <typename W>
+__global__ void k_se_fc2(const float* __restrict__ hiddenVec, const W* __restrict__ w2, const float* __restrict__ b2,
+                         int hidden, int hiddenStride, int outDim, float* __restrict__ gates) {
     int o = blockIdx.x * blockDim.x + threadIdx.x;
     if (o >= outDim) return;
+    hiddenVec += static_cast<size_t>(blockIdx.y) * hiddenStride;
     float acc = b2[o];
-    const float* row = w2 + (static_cast<size_t>(o) * hidden);
+    const W* row = w2 + (static_cast<size_t>(o) * hidden);
     for (int h = 0; h < hidden; h++) {
-        acc += row[h] * hiddenVec[h];
+        acc += load_w(row, h) * hiddenVec[h];
     }
-    gates[o] = acc;
+    gates[static_cast<size_t>(blockIdx.y) * outDim + o] = acc;
 }
 
 __global__ void k_se_apply(const float* __restrict__ convOut, const float* __restrict__ bias,
@@ -384,9 +620,10 @@ __global__ void k_se_apply(const float* __restrict__ convOut, const float* __res
     int ch = blockIdx.x;
     int s = threadIdx.x;
     if (ch >= channels || s >= 64) return;
+    gates += static_cast<size_t>(blockIdx.y) * 2 * channels;
     float gamma = sigmoid(gates[ch]);
     float betaExtra = gates[ch + channels];
-    int idx = ch * 64 + s;
+    size_t idx = (static_cast<size_t>(blockIdx.y) * channels + ch) * 64 + s;
     float z = convOut[idx] + bias[ch];
     float v = gamma * z + residual[idx] + betaExtra;
     dest[idx] = relu(v);
@@ -397,6 +634,8 @@ __global__ void k_policy_map(const float* __restrict__ planes, int planesLen,
                              float* __restrict__ outPolicy) {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     if (i >= outLen) return;
+    planes += static_cast<size_t>(blockIdx.y) * planesLen;
+    outPolicy += static_cast<size_t>(blockIdx.y) * outLen;
     int idx = policyMap[i];
     if (idx >= 0 && idx < planesLen) {
         outPolicy[i] = planes[idx];
@@ -405,131 +644,403 @@ __global__ void k_policy_map(const float* __restrict__ planes, int planesLen,
     }
 }
 
-__global__ void k_dense(const float* __restrict__ x, const float* __restrict__ w, const float* __restrict__ b,
+template <typename W>
+__global__ void k_dense(const float* __restrict__ x, const W* __restrict__ w, const float* __restrict__ b,
                         int inD, int outD, int reluAct, float* __restrict__ y) {
     int o = blockIdx.x * blockDim.x + threadIdx.x;
     if (o >= outD) return;
+    x += static_cast<size_t>(blockIdx.y) * inD;
     float acc = b[o];
-    const float* row = w + (static_cast<size_t>(o) * inD);
-    for (int i = 0; i < inD; i++) acc += row[i] * x[i];
-    y[o] = reluAct ? relu(acc) : acc;
+    const W* row = w + (static_cast<size_t>(o) * inD);
+    for (int i = 0; i < inD; i++) acc += load_w(row, i) * x[i];
+    y[static_cast<size_t>(blockIdx.y) * outD + o] = reluAct ? relu(acc) : acc;
 }
 
-static inline void launch_conv_no_bias(const ConvLayer& layer, const float* input, float* out) {
-    if (layer.k == 3) {
-        k_conv3x3_no_bias<<<layer.outC, 64>>>(input, layer.d_w, layer.inC, layer.outC, out);
-    } else if (layer.k == 1) {
-        k_conv1x1_no_bias<<<layer.outC, 64>>>(input, layer.d_w, layer.inC, layer.outC, out);
+// Implicit-GEMM 3x3 convolution: [outC x 64] = W[outC x inC*9] * im2col(input)[inC*9 x 64], with
+// the im2col gather done from a zero-padded shared-memory tile instead of materialised.
+// grid (ceil(outC / IG_OC_TILE), batch), block IG_THREADS. Thread t owns square (t & 63) for the
+// IG_OC_PER_THREAD consecutive output channels starting at (t >> 6) * IG_OC_PER_THREAD.
+constexpr int IG_OC_TILE = 16;
+constexpr int IG_IC_TILE = 16;
+constexpr int IG_OC_PER_THREAD = 4;
+constexpr int IG_THREADS = 64 * (IG_OC_TILE / IG_OC_PER_THREAD);
+constexpr int IG_PAD = 10; // 8x8 plane plus a one-square zero border
+
+template <int EPI, typename W>
+__global__ void __launch_bounds__(IG_THREADS) k_conv3x3_igemm(const float* __restrict__ input, const W* __restrict__ w,
+                                                              const float* __restrict__ bias, const float* __restrict__ residual,
+                                                              int inC, int outC, float* __restrict__ out) {
+    __shared__ float sIn[IG_IC_TILE][IG_PAD * IG_PAD];
+    __shared__ float sW[IG_OC_TILE][IG_IC_TILE * 9];
+
+    const int tid = threadIdx.x;
+    const int s = tid & 63;
+    const int row = s >> 3;
+    const int col = s & 7;
+    const int ocLocal = (tid >> 6) * IG_OC_PER_THREAD;
+    const int ocBase = blockIdx.x * IG_OC_TILE;
+    input += static_cast<size_t>(blockIdx.y) * inC * 64;
+
+    float acc[IG_OC_PER_THREAD];
+#pragma unroll
+    for (int j = 0; j < IG_OC_PER_THREAD; j++) acc[j] = 0.0f;
+
+    for (int ic0 = 0; ic0 < inC; ic0 += IG_IC_TILE) {
+        for (int i = tid; i < IG_IC_TILE * IG_PAD * IG_PAD; i += IG_THREADS) {
+            const int c = i / (IG_PAD * IG_PAD);
+            const int p = i - c * (IG_PAD * IG_PAD);
+            const int r = p / IG_PAD - 1;
+            const int f = p % IG_PAD - 1;
+            const int ic = ic0 + c;
+            float v = 0.0f;
+            if (ic < inC && r >= 0 && r < 8 && f >= 0 && f < 8) v = input[ic * 64 + (r << 3) + f];
+            sIn[c][p] = v;
+        }
+        for (int i = tid; i < IG_OC_TILE * IG_IC_TILE * 9; i += IG_THREADS) {
+            const int o = i / (IG_IC_TILE * 9);
+            const int k = i - o * (IG_IC_TILE * 9);
+            const int c = k / 9;
+            const int oc = ocBase + o;
+            const int ic = ic0 + c;
+            sW[o][k] = (oc < outC && ic < inC) ? load_w(w, (static_cast<size_t>(oc) * inC + ic) * 9 + (k - c * 9)) : 0.0f;
+        }
+        __syncthreads();
+
+#pragma unroll 4
+        for (int c = 0; c < IG_IC_TILE; c++) {
+            const float* win = &sIn[c][row * IG_PAD + col];
+            float v[9];
+#pragma unroll
+            for (int t = 0; t < 9; t++) v[t] = win[(t / 3) * IG_PAD + (t % 3)];
+#pragma unroll
+            for (int j = 0; j < IG_OC_PER_THREAD; j++) {
+                const float* wr = &sW[ocLocal + j][c * 9];
+#pragma unroll
+                for (int t = 0; t < 9; t++) acc[j] += v[t] * wr[t];
+            }
+        }
+        __syncthreads();
+    }
+
+    const size_t outBase = static_cast<size_t>(blockIdx.y) * outC * 64;
+#pragma unroll
+    for (int j = 0; j < IG_OC_PER_THREAD; j++) {
+        const int oc = ocBase + ocLocal + j;
+        if (oc >= outC) continue;
+        const size_t idx = outBase + static_cast<size_t>(oc) * 64 + s;
+        float v = acc[j];
+        if (EPI != EPI_NONE) v += bias[oc];
+        if (EPI == EPI_BIAS_RESIDUAL_RELU) v += residual[idx];
+        if (EPI == EPI_BIAS_RELU || EPI == EPI_BIAS_RESIDUAL_RELU) v = relu(v);
+        out[idx] = v;
     }
 }
 
-// Evaluate one position. Writes:
-// - outPolicyDev: [policySize]
-// - outWdlHost: [3]
-// Returns scalar value (W-L).
-static bool eval_one(GpuNet* net, const float* encodedHost, float* outPolicyHost, float* outWdlHost, float& outValue) {
-    if (!net) return false;
-    if (net->inputC != 112) return false;
-    if (cudaMemcpy(net->d_in, encodedHost, sizeof(float) * net->inputC * 64, cudaMemcpyHostToDevice) != cudaSuccess) return false;
+static inline void launch_conv_no_bias(const ConvLayer& layer, const float* input, float* out, int batch,
+                                       cudaStream_t stream) {
+    dim3 grid(layer.outC, batch);
+    with_weights(layer.w, [&](auto w) {
+        if (layer.k == 3) {
+            k_conv3x3_no_bias<<<grid, 64, 0, stream>>>(input, w, layer.inC, layer.outC, out);
+        } else if (layer.k == 1) {
+            k_conv1x1_no_bias<<<grid, 64, 0, stream>>>(input, w, layer.inC, layer.outC, out);
+        }
+    });
+}
+
+static inline int elementwise_blocks(int channels, int batch) {
+    return (batch * channels * 64 + 255) / 256;
+}
+
+// Runs `layer` on `input` and applies `epi`. `residual` is only read for EPI_BIAS_RESIDUAL_RELU;
+// that epilogue must not write `out` in place over `input` or `residual`. The direct path stages
+// the raw residual-block conv output in net->d_scratch.
+static void launch_conv(const GpuNet* net, const ConvLayer& layer, const float* input, float* out, int batch,
+                        ConvEpilogue epi, const float* residual = nullptr) {
+    cudaStream_t stream = net->stream;
+    if (layer.k == 3 && net->convEngine == ConvEngine::ImplicitGemm) {
+        dim3 grid((layer.outC + IG_OC_TILE - 1) / IG_OC_TILE, batch);
+        with_weights(layer.w, [&](auto w) {
+            switch (epi) {
+                case EPI_NONE:
+                    k_conv3x3_igemm<EPI_NONE><<<grid, IG_THREADS, 0, stream>>>(input, w, layer.d_b, residual, layer.inC, layer.outC, out);
+                    break;
+                case EPI_BIAS:
+                    k_conv3x3_igemm<EPI_BIAS><<<grid, IG_THREADS, 0, stream>>>(input, w, layer.d_b, residual, layer.inC, layer.outC, out);
+                    break;
+                case EPI_BIAS_RELU:
+                    k_conv3x3_igemm<EPI_BIAS_RELU><<<grid, IG_THREADS, 0, stream>>>(input, w, layer.d_b, residual, layer.inC, layer.outC, out);
+                    break;
+                case EPI_BIAS_RESIDUAL_RELU:
+                    k_conv3x3_igemm<EPI_BIAS_RESIDUAL_RELU><<<grid, IG_THREADS, 0, stream>>>(input, w, layer.d_b, residual, layer.inC, layer.outC, out);
+                    break;
+            }
+        });
+        return;
+    }
+
+    const int blocks = elementwise_blocks(layer.outC, batch);
+    if (epi == EPI_BIAS_RESIDUAL_RELU) {
+        launch_conv_no_bias(layer, input, net->d_scratch, batch, stream);
+        k_add_residual_relu<<<blocks, 256, 0, stream>>>(net->d_scratch, layer.d_b, residual, layer.outC, batch, out);
+        return;
+    }
+    launch_conv_no_bias(layer, input, out, batch, stream);
+    if (epi == EPI_BIAS) {
+        k_add_bias<<<blocks, 256, 0, stream>>>(out, layer.d_b, layer.outC, batch);
+    } else if (epi == EPI_BIAS_RELU) {
+        k_add_bias_relu<<<blocks, 256, 0, stream>>>(out, layer.d_b, layer.outC, batch);
+    }
+}
+
+// Enqueues the forward pass for `batch` positions already in net->d_in on net->stream. Reads and
+// writes only fixed workspace pointers (the tower ping-pongs between locals, not the net fields),
+// so the same launch sequence can be captured once and replayed. The stages are bracketed in
+// net->stats.
+static void record_forward(GpuNet* net, int batch) {
+    const GpuModel& model = *net->model;
+    cudaStream_t stream = net->stream;
+    GpuStats& stats = net->stats;
+    float* cur = net->d_cur;
+    float* next = net->d_next;
 
     // input conv
-    launch_conv_no_bias(net->inputLayer, net->d_in, net->d_cur);
-    k_add_bias_relu<<<(net->inputLayer.outC * 64 + 255) / 256, 256>>>(net->d_cur, net->inputLayer.d_b, net->inputLayer.outC);
+    stats.begin(LC0_STAGE_INPUT, stream);
+    launch_conv(net, model.inputLayer, net->d_in, cur, batch, EPI_BIAS_RELU);
+    stats.end(LC0_STAGE_INPUT, stream);
 
     // residual tower
-    for (int bi = 0; bi < net->blocks; bi++) {
-        ResidualBlock& b = net->tower[bi];
-        launch_conv_no_bias(b.conv1, net->d_cur, net->d_tmp);
-        k_add_bias_relu<<<(b.conv1.outC * 64 + 255) / 256, 256>>>(net->d_tmp, b.conv1.d_b, b.conv1.outC);
+    const int seHiddenStride = std::max(model.seMaxHidden, 1);
+    for (int bi = 0; bi < model.blocks; bi++) {
+        const ResidualBlock& b = model.tower[bi];
+        stats.begin(LC0_STAGE_TOWER, stream);
+        launch_conv(net, b.conv1, cur, net->d_tmp, batch, EPI_BIAS_RELU);
 
-        launch_conv_no_bias(b.conv2, net->d_tmp, net->d_scratch);
         if (!b.hasSe) {
-            k_add_residual_relu<<<(b.conv2.outC * 64 + 255) / 256, 256>>>(net->d_scratch, b.conv2.d_b, net->d_cur, b.conv2.outC, net->d_next);
+            launch_conv(net, b.conv2, net->d_tmp, next, batch, EPI_BIAS_RESIDUAL_RELU, cur);
+            stats.end(LC0_STAGE_TOWER, stream);
         } else {
-            k_se_pool<<<b.conv2.outC, 64>>>(net->d_scratch, b.conv2.d_b, b.conv2.outC, net->d_sePooled);
-            k_se_fc1<<<(b.se.hidden + 255) / 256, 256>>>(net->d_sePooled, b.se.d_w1, b.se.d_b1, b.conv2.outC, b.se.hidden, net->d_seHidden);
-            k_se_fc2<<<((2 * b.conv2.outC) + 255) / 256, 256>>>(net->d_seHidden, b.se.d_w2, b.se.d_b2, b.se.hidden, 2 * b.conv2.outC, net->d_seGates);
-            k_se_apply<<<b.conv2.outC, 64>>>(net->d_scratch, b.conv2.d_b, net->d_cur, net->d_seGates, b.conv2.outC, net->d_next);
+            // SE needs the pre-bias conv output: pooling and gating add the bias themselves.
+            launch_conv(net, b.conv2, net->d_tmp, net->d_scratch, batch, EPI_NONE);
+            stats.end(LC0_STAGE_TOWER, stream);
+            stats.begin(LC0_STAGE_SE, stream);
+            const int c = b.conv2.outC;
+            k_se_pool<<<dim3(c, batch), 64, 0, stream>>>(net->d_scratch, b.conv2.d_b, c, net->d_sePooled);
+            with_weights(b.se.w1, [&](auto w1) {
+                k_se_fc1<<<dim3((b.se.hidden + 255) / 256, batch), 256, 0, stream>>>(net->d_sePooled, w1, b.se.d_b1, c, b.se.hidden, seHiddenStride, net->d_seHidden);
+            });
+            with_weights(b.se.w2, [&](auto w2) {
+                k_se_fc2<<<dim3(((2 * c) + 255) / 256, batch), 256, 0, stream>>>(net->d_seHidden, w2, b.se.d_b2, b.se.hidden, seHiddenStride, 2 * c, net->d_seGates);
+            });
+            k_se_apply<<<dim3(c, batch), 64, 0, stream>>>(net->d_scratch, b.conv2.d_b, cur, net->d_seGates, c, next);
+            stats.end(LC0_STAGE_SE, stream);
         }
-        std::swap(net->d_cur, net->d_next);
+        std::swap(cur, next);
     }
 
     // policy head
-    launch_conv_no_bias(net->policyStem, net->d_cur, net->d_policyHidden);
-    k_add_bias_relu<<<(net->policyStem.outC * 64 + 255) / 256, 256>>>(net->d_policyHidden, net->policyStem.d_b, net->policyStem.outC);
-    launch_conv_no_bias(net->policyOut, net->d_policyHidden, net->d_policyPlanes);
-    k_add_bias<<<(net->policyOut.outC * 64 + 255) / 256, 256>>>(net->d_policyPlanes, net->policyOut.d_b, net->policyOut.outC);
+    stats.begin(LC0_STAGE_POLICY, stream);
+    launch_conv(net, model.policyStem, cur, net->d_policyHidden, batch, EPI_BIAS_RELU);
+    launch_conv(net, model.policyOut, net->d_policyHidden, net->d_policyPlanes, batch, EPI_BIAS);
 
     // map policy planes -> policy vector
-    k_policy_map<<<(net->policySize + 255) / 256, 256>>>(net->d_policyPlanes, net->policyOut.outC * 64, net->d_policyMap, net->policySize, net->d_policyMapped);
-    if (cudaMemcpy(outPolicyHost, net->d_policyMapped, sizeof(float) * net->policySize, cudaMemcpyDeviceToHost) != cudaSuccess) {
-        return false;
-    }
+    k_policy_map<<<dim3((model.policySize + 255) / 256, batch), 256, 0, stream>>>(net->d_policyPlanes, model.policyOut.outC * 64, model.d_policyMap, model.policySize, net->d_policyMapped);
+    stats.end(LC0_STAGE_POLICY, stream);
 
     // value head
-    launch_conv_no_bias(net->valueConv, net->d_cur, net->d_valueInput);
-    k_add_bias_relu<<<(net->valueConv.outC * 64 + 255) / 256, 256>>>(net->d_valueInput, net->valueConv.d_b, net->valueConv.outC);
+    stats.begin(LC0_STAGE_VALUE, stream);
+    launch_conv(net, model.valueConv, cur, net->d_valueInput, batch, EPI_BIAS_RELU);
     // fc1: input is valueC*64 vector
-    k_dense<<<(net->valueHidden + 255) / 256, 256>>>(net->d_valueInput, net->valueFc1.d_w, net->valueFc1.d_b, net->valueFc1.inD, net->valueFc1.outD, 1, net->d_fc1);
+    with_weights(model.valueFc1.w, [&](auto w) {
+        k_dense<<<dim3((model.valueHidden + 255) / 256, batch), 256, 0, stream>>>(net->d_valueInput, w, model.valueFc1.d_b, model.valueFc1.inD, model.valueFc1.outD, 1, net->d_fc1);
+    });
     // fc2 -> logits[3]
-    k_dense<<<1, 32>>>(net->d_fc1, net->valueFc2.d_w, net->valueFc2.d_b, net->valueFc2.inD, net->valueFc2.outD, 0, net->d_logits);
+    with_weights(model.valueFc2.w, [&](auto w) {
+        k_dense<<<dim3(1, batch), 32, 0, stream>>>(net->d_fc1, w, model.valueFc2.d_b, model.valueFc2.inD, model.valueFc2.outD, 0, net->d_logits);
+    });
+    stats.end(LC0_STAGE_VALUE, stream);
+}
+
+// Captures record_forward(batch) into an executable graph. Returns null (and clears the launch
+// error) when capture or instantiation fails.
+static cudaGraphExec_t capture_forward(GpuNet* net, int batch) {
+    if (cudaStreamBeginCapture(net->stream, cudaStreamCaptureModeThreadLocal) != cudaSuccess) {
+        cudaGetLastError();
+        return nullptr;
+    }
+    record_forward(net, batch);
+    cudaGraph_t graph = nullptr;
+    cudaError_t err = cudaStreamEndCapture(net->stream, &graph);
+    cudaGraphExec_t exec = nullptr;
+    if (err == cudaSuccess && graph) {
+        if (cudaGraphInstantiateWithFlags(&exec, graph, 0) != cudaSuccess) exec = nullptr;
+    }
+    if (graph) cudaGraphDestroy(graph);
+    cudaGetLastError();
+    return exec;
+}
+
+// Enqueues the forward pass, through the cached graph for `batch` when graphs are enabled.
+static bool launch_forward(GpuNet* net, int batch) {
+    if (net->useGraphs) {
+        cudaGraphExec_t& exec = net->graphs[static_cast<size_t>(batch)];
+        if (!exec) exec = capture_forward(net, batch);
+        if (exec) return cudaGraphLaunch(exec, net->stream) == cudaSuccess;
+        net->useGraphs = false;
+    }
+    record_forward(net, batch);
+    return cudaGetLastError() == cudaSuccess;
+}
 
-    float logitsHost[3];
-    if (cudaMemcpy(logitsHost, net->d_logits, sizeof(float) * 3, cudaMemcpyDeviceToHost) != cudaSuccess) return false;
+// Runs the forward pass over the `batch` positions already in net->d_in. Writes:
+// - outPolicyHost: [batch][policySize]
+// - outWdlHost: [batch][3]
+// - outValues: [batch] scalar value (W-L)
+static bool eval_uploaded(GpuNet* net, int batch, std::chrono::steady_clock::time_point started,
+                          float* outPolicyHost, float* outWdlHost, float* outValues) {
+    const GpuModel& model = *net->model;
+    if (!launch_forward(net, batch)) return false;
+    float* logitsHost = net->h_logits.data();
+    const size_t policyBytes = sizeof(float) * batch * model.policySize;
+    net->stats.begin(LC0_STAGE_DOWNLOAD, net->stream);
+    if (cudaMemcpyAsync(outPolicyHost, net->d_policyMapped, policyBytes,
+                        cudaMemcpyDeviceToHost, net->stream) != cudaSuccess) {
+        return false;
+    }
+    if (cudaMemcpyAsync(logitsHost, net->d_logits, sizeof(float) * batch * 3, cudaMemcpyDeviceToHost,
+                        net->stream) != cudaSuccess) {
+        return false;
+    }
+    net->stats.end(LC0_STAGE_DOWNLOAD, net->stream, static_cast<long long>(policyBytes + sizeof(float) * batch * 3));
+    if (cudaStreamSynchronize(net->stream) != cudaSuccess) return false;
+    net->stats.collect();
 
     // softmax on host
-    float m = std::max(logitsHost[0], std::max(logitsHost[1], logitsHost[2]));
-    float e0 = std::exp(logitsHost[0] - m);
-    float e1 = std::exp(logitsHost[1] - m);
-    float e2 = std::exp(logitsHost[2] - m);
-    float s = e0 + e1 + e2;
-    float w = (s > 0.0f) ? (e0 / s) : 0.0f;
-    float d = (s > 0.0f) ? (e1 / s) : 0.0f;
-    float l = (s > 0.0f) ? (e2 / s) : 0.0f;
-    outWdlHost[0] = w;
-    outWdlHost[1] = d;
-    outWdlHost[2] = l;
-    outValue = w - l;
+    const auto softmaxStarted = net->stats.now();
+    for (int i = 0; i < batch; i++) {
+        const float* lg = logitsHost + i * 3;
+        float m = std::max(lg[0], std::max(lg[1], lg[2]));
+        float e0 = std::exp(lg[0] - m);
+        float e1 = std::exp(lg[1] - m);
+        float e2 = std::exp(lg[2] - m);
+        float s = e0 + e1 + e2;
+        float w = (s > 0.0f) ? (e0 / s) : 0.0f;
+        float d = (s > 0.0f) ? (e1 / s) : 0.0f;
+        float l = (s > 0.0f) ? (e2 / s) : 0.0f;
+        outWdlHost[i * 3 + 0] = w;
+        outWdlHost[i * 3 + 1] = d;
+        outWdlHost[i * 3 + 2] = l;
+        outValues[i] = w - l;
+    }
+    net->stats.host(LC0_STAGE_WDL, softmaxStarted);
+    net->evalCount++;
+    net->evalNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count();
     return true;
 }
 
-static void destroy_net(GpuNet* net) {
-    if (!net) return;
+// Evaluate up to net->maxBatch positions in one pass; outputs as eval_uploaded.
+static bool eval_batch(GpuNet* net, const float* encodedHost, int batch,
+                       float* outPolicyHost, float* outWdlHost, float* outValues) {
+    if (!net) return false;
+    const GpuModel& model = *net->model;
+    if (model.inputC != 112) return false;
+    if (batch <= 0 || batch > net->maxBatch || !bind_device(net)) return false;
+    const auto started = std::chrono::steady_clock::now();
+    const size_t bytes = sizeof(float) * batch * model.inputC * 64;
+    net->stats.begin(LC0_STAGE_UPLOAD, net->stream);
+    if (cudaMemcpyAsync(net->d_in, encodedHost, bytes, cudaMemcpyHostToDevice, net->stream) != cudaSuccess) {
+        return false;
+    }
+    net->stats.end(LC0_STAGE_UPLOAD, net->stream, static_cast<long long>(bytes));
+    return eval_uploaded(net, batch, started, outPolicyHost, outWdlHost, outValues);
+}
+
+// Evaluate up to net->maxBatch packed positions ([batch][inputC+1] words, see
+// ../common/packed_planes_impl.inl): uploads the words and expands them into d_in on the device.
+static bool eval_packed(GpuNet* net, const unsigned long long* packedHost, int batch,
+                        float* outPolicyHost, float* outWdlHost, float* outValues) {
+    if (!net) return false;
+    const GpuModel& model = *net->model;
+    if (model.inputC != 112) return false;
+    if (batch <= 0 || batch > net->maxBatch || !bind_device(net)) return false;
+    const size_t words = static_cast<size_t>(packed_words(model.inputC));
+    if (!net->d_packed && !cuda_alloc(&net->d_packed, static_cast<size_t>(net->maxBatch) * words)) return false;
+    const auto started = std::chrono::steady_clock::now();
+    const size_t bytes = sizeof(unsigned long long) * batch * words;
+    net->stats.begin(LC0_STAGE_UPLOAD, net->stream);
+    if (cudaMemcpyAsync(net->d_packed, packedHost, bytes, cudaMemcpyHostToDevice, net->stream) != cudaSuccess) {
+        return false;
+    }
+    net->stats.end(LC0_STAGE_UPLOAD, net->stream, static_cast<long long>(bytes));
+    net->stats.begin(LC0_STAGE_EXPAND, net->stream);
+    k_expand_packed_planes<<<dim3(model.inputC, batch), 64, 0, net->stream>>>(net->d_packed, model.inputC, net->d_in);
+    net->stats.end(LC0_STAGE_EXPAND, net->stream);
+    if (cudaGetLastError() != cudaSuccess) return false;
+    return eval_uploaded(net, batch, started, outPolicyHost, outWdlHost, outValues);
+}
+
+// Evaluate one position. Writes:
+// - outPolicyHost: [policySize]
+// - outWdlHost: [3]
+// Returns scalar value (W-L).
+static bool eval_one(GpuNet* net, const float* encodedHost, float* outPolicyHost, float* outWdlHost, float& outValue) {
+    return eval_batch(net, encodedHost, 1, outPolicyHost, outWdlHost, &outValue);
+}
+
+// Frees every buffer of `model` and the model itself; the caller has made its device current.
+static void release_model_buffers(GpuModel* model) {
     auto freeConv = [&](ConvLayer& c) {
-        cuda_free(c.d_w);
+        free_weights(c.w);
         cuda_free(c.d_b);
-        c.d_w = nullptr;
         c.d_b = nullptr;
     };
     auto freeDense = [&](DenseLayer& d) {
-        cuda_free(d.d_w);
+        free_weights(d.w);
         cuda_free(d.d_b);
-        d.d_w = nullptr;
         d.d_b = nullptr;
     };
     auto freeSe = [&](SeUnit& s) {
-        cuda_free(s.d_w1);
+        free_weights(s.w1);
         cuda_free(s.d_b1);
-        cuda_free(s.d_w2);
+        free_weights(s.w2);
         cuda_free(s.d_b2);
-        s.d_w1 = s.d_b1 = s.d_w2 = s.d_b2 = nullptr;
+        s.d_b1 = s.d_b2 = nullptr;
     };
 
-    freeConv(net->inputLayer);
-    for (auto& b : net->tower) {
+    freeConv(model->inputLayer);
+    for (auto& b : model->tower) {
         freeConv(b.conv1);
         freeConv(b.conv2);
         if (b.hasSe) freeSe(b.se);
     }
-    freeConv(net->policyStem);
-    freeConv(net->policyOut);
-    freeConv(net->valueConv);
-    freeDense(net->valueFc1);
-    freeDense(net->valueFc2);
-    cuda_free(net->d_policyMap);
-    cuda_free(net->d_policyMapped);
+    freeConv(model->policyStem);
+    freeConv(model->policyOut);
+    freeConv(model->valueConv);
+    freeDense(model->valueFc1);
+    freeDense(model->valueFc2);
+    cuda_free(model->d_policyMap);
+
+    delete model;
+}
+
+// Releases `model` on the device it was uploaded to, then restores the calling thread's
+// current device so a handle destroyed from a Java thread does not rebind that thread.
+static void release_model(GpuModel* model) {
+    if (!model) return;
+    int previous = 0;
+    const bool restore = cudaGetDevice(&previous) == cudaSuccess;
+    (void) cudaSetDevice(model->device);
+    release_model_buffers(model);
+    if (restore) (void) cudaSetDevice(previous);
+}
 
+// Frees the handle's workspace; the model goes when its last handle does.
+static void destroy_net(GpuNet* net) {
+    if (!net) return;
+    (void) bind_device(net);
     cuda_free(net->d_in);
+    cuda_free(net->d_packed);
     cuda_free(net->d_cur);
     cuda_free(net->d_next);
     cuda_free(net->d_tmp);
@@ -539,135 +1050,155 @@ static void destroy_net(GpuNet* net) {
     cuda_free(net->d_valueInput);
     cuda_free(net->d_fc1);
     cuda_free(net->d_logits);
+    cuda_free(net->d_policyMapped);
     cuda_free(net->d_sePooled);
     cuda_free(net->d_seHidden);
     cuda_free(net->d_seGates);
+    cuda_free_host(net->h_pinnedIn);
+    cuda_free_host(net->h_pinnedPolicy);
+    cuda_free_host(net->h_pinnedWdl);
+
+    for (cudaGraphExec_t exec : net->graphs) {
+        if (exec) cudaGraphExecDestroy(exec);
+    }
+    if (net->stream) cudaStreamDestroy(net->stream);
 
     delete net;
 }
 
-static GpuNet* create_net(const std::string& path) {
-    if (device_count() <= 0) return nullptr;
-    // pick device 0
-    if (cudaSetDevice(0) != cudaSuccess) return nullptr;
+// Parses `path` and uploads its weights in `dtype` to `device`, which must be current. Returns null
+// on any format or allocation failure.
+static GpuModel* load_model(const std::string& path, int device, DType dtype) {
+    Lc0Net net;
+    if (!lc0_read_net(path, net)) return nullptr;
 
-    std::ifstream f(path, std::ios::binary);
-    if (!f) return nullptr;
+    auto model = std::make_unique<GpuModel>();
+    model->device = device;
+    auto fail = [&]() -> GpuModel* {
+        release_model(model.release());
+        return nullptr;
+    };
+    model->inputC = net.inputC;
+    model->trunkC = net.trunkC;
+    model->blocks = net.blocks;
+    model->policyC = net.policyC;
+    model->valueC = net.valueC;
+    model->valueHidden = net.valueHidden;
+    model->policyMapLen = net.policySize;
+    model->policySize = net.policySize;
+    model->dtype = dtype;
+    model->paramCount = net.paramCount;
+    model->weightBytes = net.paramCount * static_cast<int64_t>(dtype_size(dtype));
+    model->seMaxHidden = net.seMaxHidden;
+
+    if (!upload_conv(net.input, model->inputLayer, dtype)) return fail();
+    model->tower.resize(net.tower.size());
+    for (size_t i = 0; i < net.tower.size(); i++) {
+        const Lc0Block& src = net.tower[i];
+        ResidualBlock& b = model->tower[i];
+        if (!upload_conv(src.conv1, b.conv1, dtype)) return fail();
+        if (!upload_conv(src.conv2, b.conv2, dtype)) return fail();
+        b.hasSe = src.hasSe;
+        if (b.hasSe && !upload_se(src.se, b.se, dtype)) return fail();
+    }
+    if (!upload_conv(net.policyStem, model->policyStem, dtype)) return fail();
+    if (!upload_conv(net.policyOut, model->policyOut, dtype)) return fail();
+    if (!upload_conv(net.valueConv, model->valueConv, dtype)) return fail();
+    if (!upload_dense(net.valueFc1, model->valueFc1, dtype)) return fail();
+    if (!upload_dense(net.valueFc2, model->valueFc2, dtype)) return fail();
+
+    const std::vector<int32_t>& policyMap = net.policyMap;
+    if (!cuda_alloc(&model->d_policyMap, policyMap.size())) return fail();
+    if (cudaMemcpy(model->d_policyMap, policyMap.data(), sizeof(int32_t) * policyMap.size(), cudaMemcpyHostToDevice) != cudaSuccess) return fail();
+    return model.release();
+}
+
+// Models currently held by live handles, one per (path, device, dtype).
+static WeightCache<GpuModel>& weight_cache() {
+    static WeightCache<GpuModel> cache(release_model);
+    return cache;
+}
 
-    char magic[4];
-    if (!read_bytes(f, magic, 4)) return nullptr;
-    if (magic[0] != 'L' || magic[1] != 'C' || magic[2] != '0' || magic[3] != 'J') return nullptr;
-    int32_t version = 0;
-    if (!read_i32(f, version) || version != 1) return nullptr;
+static GpuNet* create_net(const std::string& path, int device) {
+    if (device < 0 || device >= device_count()) return nullptr;
+    if (cudaSetDevice(device) != cudaSuccess) return nullptr;
+
+    const DType dtype = parse_dtype();
+    std::shared_ptr<const GpuModel> shared = weight_cache().acquire(path, device, static_cast<int>(dtype),
+            [&] { return load_model(path, device, dtype); });
+    if (!shared) return nullptr;
+    const GpuModel& model = *shared;
 
     auto net = std::make_unique<GpuNet>();
+    net->model = std::move(shared);
+    net->device = device;
     auto fail = [&]() -> GpuNet* {
         destroy_net(net.release());
         return nullptr;
     };
-    int32_t inputC, trunkC, blocks, policyC, valueC, valueHidden, policyMapLen, wdlOutputs;
-    if (!read_i32(f, inputC) || !read_i32(f, trunkC) || !read_i32(f, blocks) || !read_i32(f, policyC) ||
-        !read_i32(f, valueC) || !read_i32(f, valueHidden) || !read_i32(f, policyMapLen) || !read_i32(f, wdlOutputs)) {
-        return nullptr;
-    }
-    if (wdlOutputs != 3) return nullptr;
-
-    net->inputC = inputC;
-    net->trunkC = trunkC;
-    net->blocks = blocks;
-    net->policyC = policyC;
-    net->valueC = valueC;
-    net->valueHidden = valueHidden;
-    net->policyMapLen = policyMapLen;
-    net->policySize = policyMapLen;
-
-    if (!load_conv(f, net->inputLayer)) return fail();
-    net->paramCount += net->inputLayer.params;
-
-    net->tower.resize(static_cast<size_t>(blocks));
-    int maxHidden = 0;
-    for (int i = 0; i < blocks; i++) {
-        ResidualBlock& b = net->tower[i];
-        if (!load_conv(f, b.conv1)) return fail();
-        if (!load_conv(f, b.conv2)) return fail();
-        net->paramCount += b.conv1.params + b.conv2.params;
-        bool present = false;
-        if (!load_se(f, b.se, present, b.conv2.outC, maxHidden)) return fail();
-        b.hasSe = present;
-        if (b.hasSe) net->paramCount += b.se.params;
-    }
-    net->seMaxHidden = maxHidden;
-
-    if (!load_conv(f, net->policyStem)) return fail();
-    if (!load_conv(f, net->policyOut)) return fail();
-    if (!load_conv(f, net->valueConv)) return fail();
-    if (net->policyOut.outC != policyC) return fail();
-    if (net->valueConv.outC != valueC) return fail();
-    net->paramCount += net->policyStem.params + net->policyOut.params + net->valueConv.params;
-
-    if (!load_dense(f, net->valueFc1, valueHidden)) return fail();
-    if (!load_dense(f, net->valueFc2, 3)) return fail();
-    net->paramCount += net->valueFc1.params + net->valueFc2.params;
-
-    // policy map
-    int32_t mapEntries = 0;
-    if (!read_i32(f, mapEntries)) return fail();
-    if (mapEntries != policyMapLen) return fail();
-    std::vector<int32_t> policyMap(static_cast<size_t>(mapEntries));
-    if (!read_bytes(f, policyMap.data(), sizeof(int32_t) * policyMap.size())) return fail();
-    if (!cuda_alloc(&net->d_policyMap, policyMap.size())) return fail();
-    if (cudaMemcpy(net->d_policyMap, policyMap.data(), sizeof(int32_t) * policyMap.size(), cudaMemcpyHostToDevice) != cudaSuccess) return fail();
-
-    // ensure EOF
-    f.peek();
-    if (!f.eof()) {
-        // trailing bytes are treated as error (matches Java loader).
-        return fail();
-    }
 
-    // workspace allocations
-    if (!cuda_alloc(&net->d_in, static_cast<size_t>(inputC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_cur, static_cast<size_t>(trunkC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_next, static_cast<size_t>(trunkC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_tmp, static_cast<size_t>(trunkC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_scratch, static_cast<size_t>(trunkC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_policyHidden, static_cast<size_t>(trunkC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_policyPlanes, static_cast<size_t>(policyC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_valueInput, static_cast<size_t>(valueC) * 64)) return fail();
-    if (!cuda_alloc(&net->d_fc1, static_cast<size_t>(valueHidden))) return fail();
-    if (!cuda_alloc(&net->d_logits, 3)) return fail();
-
-    if (!cuda_alloc(&net->d_sePooled, static_cast<size_t>(trunkC))) return fail();
-    if (net->seMaxHidden > 0) {
-        if (!cuda_alloc(&net->d_seHidden, static_cast<size_t>(net->seMaxHidden))) return fail();
-    } else {
-        if (!cuda_alloc(&net->d_seHidden, 1)) return fail();
-    }
-    if (!cuda_alloc(&net->d_seGates, static_cast<size_t>(2 * trunkC))) return fail();
-    if (!cuda_alloc(&net->d_policyMapped, static_cast<size_t>(net->policySize))) return fail();
+    // workspace allocations (leading [maxBatch] dimension)
+    net->maxBatch = max_batch_from_env();
+    net->convEngine = conv_engine_from_env();
+    const size_t B = static_cast<size_t>(net->maxBatch);
+    const size_t trunkC = static_cast<size_t>(model.trunkC);
+    if (!cuda_alloc(&net->d_in, B * model.inputC * 64)) return fail();
+    if (!cuda_alloc(&net->d_cur, B * trunkC * 64)) return fail();
+    if (!cuda_alloc(&net->d_next, B * trunkC * 64)) return fail();
+    if (!cuda_alloc(&net->d_tmp, B * trunkC * 64)) return fail();
+    if (!cuda_alloc(&net->d_scratch, B * trunkC * 64)) return fail();
+    if (!cuda_alloc(&net->d_policyHidden, B * trunkC * 64)) return fail();
+    if (!cuda_alloc(&net->d_policyPlanes, B * model.policyC * 64)) return fail();
+    if (!cuda_alloc(&net->d_valueInput, B * model.valueC * 64)) return fail();
+    if (!cuda_alloc(&net->d_fc1, B * model.valueHidden)) return fail();
+    if (!cuda_alloc(&net->d_logits, B * 3)) return fail();
+
+    if (!cuda_alloc(&net->d_sePooled, B * trunkC)) return fail();
+    if (!cuda_alloc(&net->d_seHidden, B * std::max(model.seMaxHidden, 1))) return fail();
+    if (!cuda_alloc(&net->d_seGates, B * 2 * trunkC)) return fail();
+    if (!cuda_alloc(&net->d_policyMapped, B * model.policySize)) return fail();
+    net->h_logits.assign(B * 3, 0.0f);
+
+    if (cudaStreamCreateWithFlags(&net->stream, cudaStreamNonBlocking) != cudaSuccess) return fail();
+    net->useGraphs = graphs_from_env();
+    net->graphs.assign(B + 1, nullptr);
+    net->stats.configure(LC0_STAGE_NAMES, LC0_STAGES, stats_from_env());
+    if (net->stats.enabled()) net->useGraphs = false;
 
     return net.release();
 }
 
+
 // ---- JNI for CudaLc0 ----
 
-static jlong backend_nativeCreate(JNIEnv* env, jstring jpath) {
-    if (!jpath) return 0;
+static bool jstring_to_path(JNIEnv* env, jstring jpath, std::string& path) {
+    if (!jpath) return false;
     const char* cpath = env->GetStringUTFChars(jpath, nullptr);
-    if (!cpath) return 0;
-    std::string path(cpath);
+    if (!cpath) return false;
+    path.assign(cpath);
     env->ReleaseStringUTFChars(jpath, cpath);
+    return true;
+}
+
+static jlong backend_nativeCreate(JNIEnv* env, jstring jpath, int device) {
+    std::string path;
+    if (!jstring_to_path(env, jpath, path)) return 0;
 
-    GpuNet* net = create_net(path);
+    GpuNet* net = create_net(path, device);
     return reinterpret_cast<jlong>(net);
 }
 
 extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_CudaBackend_nativeCreate(JNIEnv* env, jclass, jstring jpath) {
-    return backend_nativeCreate(env, jpath);
+    return backend_nativeCreate(env, jpath, 0);
 }
 
 extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeCreate(JNIEnv* env, jclass, jstring jpath) {
-    return backend_nativeCreate(env, jpath);
+    return backend_nativeCreate(env, jpath, 0);
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeCreateOnDevice(
+        JNIEnv* env, jclass, jstring jpath, jint device) {
+    return backend_nativeCreate(env, jpath, device);
 }
 
 extern "C" JNIEXPORT void JNICALL Java_chess_nn_lc0_CudaBackend_nativeDestroy(JNIEnv*, jclass, jlong handle) {
@@ -681,17 +1212,24 @@ extern "C" JNIEXPORT void JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeDestr
 extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_lc0_CudaBackend_nativeGetInfo(JNIEnv* env, jclass, jlong handle) {
     GpuNet* net = reinterpret_cast<GpuNet*>(handle);
     if (!net) return nullptr;
-    jlong vals[7];
-    vals[0] = net->inputC;
-    vals[1] = net->trunkC;
-    vals[2] = net->blocks;
-    vals[3] = net->policyC;
-    vals[4] = net->valueC;
-    vals[5] = net->policySize;
-    vals[6] = net->paramCount;
-    jlongArray arr = env->NewLongArray(7);
+    const GpuModel& model = *net->model;
+    jlong vals[13];
+    vals[0] = model.inputC;
+    vals[1] = model.trunkC;
+    vals[2] = model.blocks;
+    vals[3] = model.policyC;
+    vals[4] = model.valueC;
+    vals[5] = model.policySize;
+    vals[6] = model.paramCount;
+    vals[7] = net->maxBatch;
+    vals[8] = static_cast<jlong>(model.dtype);
+    vals[9] = model.weightBytes;
+    vals[10] = net->useGraphs ? 1 : 0;
+    vals[11] = net->evalCount;
+    vals[12] = net->evalCount > 0 ? net->evalNanos / net->evalCount : 0;
+    jlongArray arr = env->NewLongArray(13);
     if (!arr) return nullptr;
-    env->SetLongArrayRegion(arr, 0, 7, vals);
+    env->SetLongArrayRegion(arr, 0, 13, vals);
     return arr;
 }
 
@@ -703,13 +1241,14 @@ extern "C" JNIEXPORT jfloat JNICALL Java_chess_nn_lc0_CudaBackend_nativePredict(
         JNIEnv* env, jclass, jlong handle, jfloatArray jencoded, jfloatArray joutPolicy, jfloatArray joutWdl) {
     GpuNet* net = reinterpret_cast<GpuNet*>(handle);
     if (!net) return 0.0f;
+    const GpuModel& model = *net->model;
     if (!jencoded || !joutPolicy || !joutWdl) return 0.0f;
 
     const jsize encLen = env->GetArrayLength(jencoded);
     const jsize polLen = env->GetArrayLength(joutPolicy);
     const jsize wdlLen = env->GetArrayLength(joutWdl);
-    if (encLen != net->inputC * 64) return 0.0f;
-    if (polLen != net->policySize) return 0.0f;
+    if (encLen != model.inputC * 64) return 0.0f;
+    if (polLen != model.policySize) return 0.0f;
     if (wdlLen != 3) return 0.0f;
 
     std::vector<float> encoded(static_cast<size_t>(encLen));
@@ -731,3 +1270,215 @@ extern "C" JNIEXPORT jfloat JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePre
         JNIEnv* env, jclass, jlong handle, jfloatArray jencoded, jfloatArray joutPolicy, jfloatArray joutWdl) {
     return Java_chess_nn_lc0_CudaBackend_nativePredict(env, nullptr, handle, jencoded, joutPolicy, joutWdl);
 }
+
+extern "C" JNIEXPORT jstring JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeGetStatNames(JNIEnv* env, jclass, jlong handle) {
+    GpuNet* net = reinterpret_cast<GpuNet*>(handle);
+    if (!net) return nullptr;
+    return net->stats.names_string(env);
+}
+
+// Per-stage counters (layout in ../common/gpu_stats_impl.inl), zeroed after reading when `reset` is set.
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeGetStats(
+        JNIEnv* env, jclass, jlong handle, jboolean reset) {
+    GpuNet* net = reinterpret_cast<GpuNet*>(handle);
+    if (!net) return nullptr;
+    return net->stats.to_array(env, reset == JNI_TRUE);
+}
+
+// Batched predict: evaluates `count` positions packed back to back in `jencoded` and writes
+// policy/WDL/value in the same order. Requests larger than maxBatch run in maxBatch-sized chunks.
+// Returns the number of positions evaluated (count on success, 0 on failure).
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePredictBatch(
+        JNIEnv* env, jclass, jlong handle, jfloatArray jencoded, jint count,
+        jfloatArray joutPolicy, jfloatArray joutWdl, jfloatArray joutValue) {
+    GpuNet* net = reinterpret_cast<GpuNet*>(handle);
+    if (!net) return 0;
+    const GpuModel& model = *net->model;
+    if (!jencoded || !joutPolicy || !joutWdl || !joutValue) return 0;
+    if (count <= 0) return 0;
+
+    const size_t n = static_cast<size_t>(count);
+    const size_t encStride = static_cast<size_t>(model.inputC) * 64;
+    const size_t polStride = static_cast<size_t>(model.policySize);
+    if (static_cast<size_t>(env->GetArrayLength(jencoded)) < n * encStride) return 0;
+    if (static_cast<size_t>(env->GetArrayLength(joutPolicy)) < n * polStride) return 0;
+    if (static_cast<size_t>(env->GetArrayLength(joutWdl)) < n * 3) return 0;
+    if (static_cast<size_t>(env->GetArrayLength(joutValue)) < n) return 0;
+
+    std::vector<float> encoded(n * encStride);
+    env->GetFloatArrayRegion(jencoded, 0, static_cast<jsize>(encoded.size()), encoded.data());
+
+    std::vector<float> policy(n * polStride);
+    std::vector<float> wdl(n * 3);
+    std::vector<float> values(n);
+    for (size_t off = 0; off < n; off += static_cast<size_t>(net->maxBatch)) {
+        const int chunk = static_cast<int>(std::min(n - off, static_cast<size_t>(net->maxBatch)));
+        if (!eval_batch(net, encoded.data() + off * encStride, chunk,
+                        policy.data() + off * polStride, wdl.data() + off * 3, values.data() + off)) {
+            return 0;
+        }
+    }
+
+    env->SetFloatArrayRegion(joutPolicy, 0, static_cast<jsize>(policy.size()), policy.data());
+    env->SetFloatArrayRegion(joutWdl, 0, static_cast<jsize>(wdl.size()), wdl.data());
+    env->SetFloatArrayRegion(joutValue, 0, static_cast<jsize>(values.size()), values.data());
+    return count;
+}
+
+// Batched predict from packed positions ([count][inputC+1] longs); outputs and chunking as
+// nativePredictBatch. Returns the number of positions evaluated (count on success, 0 on failure).
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePredictPacked(
+        JNIEnv* env, jclass, jlong handle, jlongArray jpacked, jint count,
+        jfloatArray joutPolicy, jfloatArray joutWdl, jfloatArray joutValue) {
+    GpuNet* net = reinterpret_cast<GpuNet*>(handle);
+    if (!net) return 0;
+    const GpuModel& model = *net->model;
+    std::vector<float> values(static_cast<size_t>(net->maxBatch));
+    return packed_predict_batch(env, jpacked, count, model.inputC, net->maxBatch, model.policySize,
+            joutPolicy, joutWdl, joutValue,
+            [net, &values](const unsigned long long* packed, int chunk, float* policy, float* wdl) {
+                return eval_packed(net, packed, chunk, policy, wdl, values.data());
+            });
+}
+
+// Allocates the pinned input/output buffers on first use (see ../common/pinned_io_impl.inl).
+static bool alloc_pinned(GpuNet* net) {
+    const GpuModel& model = *net->model;
+    if (net->h_pinnedIn) return true;
+    if (!bind_device(net)) return false;
+    const size_t B = static_cast<size_t>(net->maxBatch);
+    if (cuda_alloc_host(&net->h_pinnedIn, B * model.inputC * 64)
+            && cuda_alloc_host(&net->h_pinnedPolicy, B * model.policySize)
+            && cuda_alloc_host(&net->h_pinnedWdl, B * 3)) {
+        net->h_pinnedValues.assign(B, 0.0f);
+        return true;
+    }
+    cuda_free_host(net->h_pinnedIn);
+    cuda_free_host(net->h_pinnedPolicy);
+    cuda_free_host(net->h_pinnedWdl);
+    net->h_pinnedIn = net->h_pinnedPolicy = net->h_pinnedWdl = nullptr;
+    return false;
+}
+
+extern "C" JNIEXPORT jobjectArray JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePinnedBuffers(JNIEnv* env, jclass, jlong handle) {
+    GpuNet* net = reinterpret_cast<GpuNet*>(handle);
+    if (!net || !alloc_pinned(net)) return nullptr;
+    const GpuModel& model = *net->model;
+    const size_t B = static_cast<size_t>(net->maxBatch);
+    return pinned_buffer_array(env, net->h_pinnedIn, B * model.inputC * 64, net->h_pinnedPolicy,
+                               B * model.policySize, net->h_pinnedWdl, B * 3);
+}
+
+// Evaluates the first `count` positions of the pinned input buffer straight into the pinned outputs.
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePredictPinned(JNIEnv*, jclass, jlong handle, jint count) {
+    GpuNet* net = reinterpret_cast<GpuNet*>(handle);
+    if (!net || !net->h_pinnedIn || count <= 0 || count > net->maxBatch) return 0;
+    return eval_batch(net, net->h_pinnedIn, count, net->h_pinnedPolicy, net->h_pinnedWdl,
+                      net->h_pinnedValues.data()) ? count : 0;
+}
+
+// Coalescing evaluation queue over this handle (see ../common/eval_queue_impl.inl). maxBatch <= 0,
+// or above the handle's own maxBatch, uses the handle's maxBatch; a negative deadline uses the default.
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeQueueCreate(
+        JNIEnv*, jclass, jlong handle, jint maxBatch, jlong deadlineMicros) {
+    GpuNet* net = reinterpret_cast<GpuNet*>(handle);
+    if (!net) return 0;
+    const GpuModel& model = *net->model;
+    const int batch = (maxBatch <= 0 || maxBatch > net->maxBatch) ? net->maxBatch : maxBatch;
+    try {
+        auto* queue = new EvalQueue(model.inputC * 64, model.policySize, batch, deadlineMicros,
+                [net, values = std::vector<float>(static_cast<size_t>(batch))](
+                        const float* encoded, int count, float* policy, float* wdl) mutable {
+                    return eval_batch(net, encoded, count, policy, wdl, values.data());
+                });
+        return reinterpret_cast<jlong>(queue);
+    } catch (...) {
+        return 0;
+    }
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeQueueSubmit(
+        JNIEnv* env, jclass, jlong queue, jfloatArray jencoded) {
+    return eval_queue_submit(env, queue, jencoded);
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeQueueTake(
+        JNIEnv* env, jclass, jlong queue, jfloatArray joutPolicy, jfloatArray joutWdl) {
+    return eval_queue_take(env, queue, joutPolicy, joutWdl);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeQueueClose(JNIEnv*, jclass, jlong queue) {
+    eval_queue_close(queue);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativeQueueDestroy(JNIEnv*, jclass, jlong queue) {
+    eval_queue_destroy(queue);
+}
+
+// ---- Replica pool over several devices (see ../common/replica_pool_impl.inl) ----
+
+using GpuNetPool = ReplicaPool<GpuNet>;
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePoolCreate(
+        JNIEnv* env, jclass, jstring jpath, jintArray jdevices) {
+    std::string path;
+    if (!jstring_to_path(env, jpath, path)) return 0;
+    return reinterpret_cast<jlong>(replica_pool_create<GpuNet>(env, jdevices, destroy_net,
+            [&path](int device) { return create_net(path, device); }));
+}
+
+extern "C" JNIEXPORT void JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePoolDestroy(JNIEnv*, jclass, jlong pool) {
+    delete reinterpret_cast<GpuNetPool*>(pool);
+}
+
+// nativeGetInfo of the first replica.
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePoolGetInfo(JNIEnv* env, jclass, jlong pool) {
+    GpuNetPool* replicas = reinterpret_cast<GpuNetPool*>(pool);
+    if (!replicas) return nullptr;
+    return Java_chess_nn_lc0_CudaBackend_nativeGetInfo(env, nullptr, reinterpret_cast<jlong>(&replicas->front()));
+}
+
+// nativePredictBatch across the pool; returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePoolPredictBatch(
+        JNIEnv* env, jclass, jlong pool, jfloatArray jencoded, jint count,
+        jfloatArray joutPolicy, jfloatArray joutWdl, jfloatArray joutValue) {
+    GpuNetPool* replicas = reinterpret_cast<GpuNetPool*>(pool);
+    if (!replicas) return 0;
+    const GpuNet& net = replicas->front();
+    const GpuModel& model = *net.model;
+    return replica_pool_predict_batch(env, *replicas, jencoded, count, model.inputC * 64, net.maxBatch,
+            model.policySize, joutPolicy, joutWdl, joutValue,
+            [](GpuNet& replica, const float* encoded, int chunk, float* policy, float* wdl) {
+                std::vector<float> values(static_cast<size_t>(chunk));
+                return eval_batch(&replica, encoded, chunk, policy, wdl, values.data());
+            });
+}
+
+// nativePredictPacked across the pool; returns count, or 0 on failure.
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePoolPredictPacked(
+        JNIEnv* env, jclass, jlong pool, jlongArray jpacked, jint count,
+        jfloatArray joutPolicy, jfloatArray joutWdl, jfloatArray joutValue) {
+    GpuNetPool* replicas = reinterpret_cast<GpuNetPool*>(pool);
+    if (!replicas || count <= 0) return 0;
+    const GpuNet& net = replicas->front();
+    const GpuModel& model = *net.model;
+    const size_t words = static_cast<size_t>(packed_words(model.inputC));
+    const size_t polStride = static_cast<size_t>(model.policySize);
+    return packed_predict_batch(env, jpacked, count, model.inputC, count, model.policySize,
+            joutPolicy, joutWdl, joutValue,
+            [&](const unsigned long long* packed, int n, float* policy, float* wdl) {
+                return replicas->run(static_cast<size_t>(n), net.maxBatch,
+                        [&](GpuNet& replica, size_t first, int chunk) {
+                            std::vector<float> values(static_cast<size_t>(chunk));
+                            return eval_packed(&replica, packed + first * words, chunk,
+                                    policy + first * polStride, wdl + first * 3, values.data());
+                        });
+            });
+}
+
+// {device, calls, positions} per replica.
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_lc0_cnn_cuda_Backend_nativePoolStats(JNIEnv* env, jclass, jlong pool) {
+    GpuNetPool* replicas = reinterpret_cast<GpuNetPool*>(pool);
+    if (!replicas) return nullptr;
+    return replica_pool_stats(env, *replicas);
+}
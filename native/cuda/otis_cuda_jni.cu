@@ -9,13 +9,48 @@
 #define OTIS_JNI_PREFIX Java_chess_nn_otis_cuda_
 #define BT4_GPU_MALLOC(ptr, bytes) cudaMalloc(reinterpret_cast<void**>(ptr), bytes)
 #define BT4_GPU_FREE(ptr) cudaFree(ptr)
+#define BT4_GPU_HOST_ALLOC(ptr, bytes) cudaMallocHost(reinterpret_cast<void**>(ptr), bytes)
+#define BT4_GPU_HOST_FREE(ptr) cudaFreeHost(ptr)
 #define BT4_GPU_MEMCPY(dst, src, bytes, kind) cudaMemcpy(dst, src, bytes, kind)
 #define BT4_GPU_MEMCPY_H2D cudaMemcpyHostToDevice
 #define BT4_GPU_MEMCPY_D2H cudaMemcpyDeviceToHost
 #define BT4_GPU_MEMSET(ptr, value, bytes) cudaMemset(ptr, value, bytes)
 #define BT4_GPU_DEVICE_SYNCHRONIZE() cudaDeviceSynchronize()
 #define BT4_GPU_GET_DEVICE_COUNT(ptr) cudaGetDeviceCount(ptr)
+#define BT4_GPU_GET_DEVICE(ptr) cudaGetDevice(ptr)
+#define BT4_GPU_SET_DEVICE(device) cudaSetDevice(device)
 #define BT4_GPU_LAST_ERROR() cudaGetLastError()
 #define BT4_GPU_SUCCESS cudaSuccess
+#define BT4_GPU_STREAM cudaStream_t
+#define BT4_GPU_STREAM_CREATE(ptr) cudaStreamCreateWithFlags(ptr, cudaStreamNonBlocking)
+#define BT4_GPU_STREAM_DESTROY(stream) cudaStreamDestroy(stream)
+#define BT4_GPU_STREAM_SYNCHRONIZE(stream) cudaStreamSynchronize(stream)
+#define BT4_GPU_MEMCPY_ASYNC(dst, src, bytes, kind, stream) cudaMemcpyAsync(dst, src, bytes, kind, stream)
+#define BT4_GPU_MEMSET_ASYNC(ptr, value, bytes, stream) cudaMemsetAsync(ptr, value, bytes, stream)
+#define BT4_GPU_GRAPH cudaGraph_t
+#define BT4_GPU_GRAPH_EXEC cudaGraphExec_t
+#define BT4_GPU_BEGIN_CAPTURE(stream) cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal)
+#define BT4_GPU_END_CAPTURE(stream, graph) cudaStreamEndCapture(stream, graph)
+#define BT4_GPU_GRAPH_INSTANTIATE(exec, graph) cudaGraphInstantiateWithFlags(exec, graph, 0)
+#define BT4_GPU_GRAPH_LAUNCH(exec, stream) cudaGraphLaunch(exec, stream)
+#define BT4_GPU_GRAPH_DESTROY(graph) cudaGraphDestroy(graph)
+#define BT4_GPU_GRAPH_EXEC_DESTROY(exec) cudaGraphExecDestroy(exec)
+// Event and stream types for ../common/gpu_stats_impl.inl.
+#define CRTK_GPU_STATS_SUCCESS cudaSuccess
+#define CRTK_GPU_STATS_STREAM cudaStream_t
+#define CRTK_GPU_STATS_EVENT cudaEvent_t
+#define CRTK_GPU_STATS_EVENT_CREATE(ptr) cudaEventCreate(ptr)
+#define CRTK_GPU_STATS_EVENT_DESTROY(event) cudaEventDestroy(event)
+#define CRTK_GPU_STATS_EVENT_RECORD(event, stream) cudaEventRecord(event, stream)
+#define CRTK_GPU_STATS_EVENT_ELAPSED(ms, start, stop) cudaEventElapsedTime(ms, start, stop)
+#ifdef CRTK_GPU_RANGES
+#include <nvtx3/nvToolsExt.h>
+#define CRTK_GPU_STATS_RANGE_PUSH(name) nvtxRangePushA(name)
+#define CRTK_GPU_STATS_RANGE_POP() nvtxRangePop()
+#endif
+#define OTIS_GRAPHS_ENV "CRTK_OTIS_CUDA_GRAPHS"
+#define OTIS_STATS_ENV "CRTK_OTIS_CUDA_STATS"
+#define OTIS_PROFILE_ENV "CRTK_OTIS_CUDA_PROFILE"
+#define OTIS_MAX_BATCH_ENV "CRTK_OTIS_CUDA_MAX_BATCH"
 
 #include "../common/otis_gpu_impl.inl"
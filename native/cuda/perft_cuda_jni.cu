@@ -16,7 +16,23 @@
 #define PERFT_GPU_MEMCPY(dst, src, bytes, kind) cudaMemcpy(dst, src, bytes, kind)
 #define PERFT_GPU_MEMCPY_H2D cudaMemcpyHostToDevice
 #define PERFT_GPU_MEMCPY_D2H cudaMemcpyDeviceToHost
+#define PERFT_GPU_MEMCPY_ASYNC(dst, src, bytes, kind, stream) cudaMemcpyAsync(dst, src, bytes, kind, stream)
+#define PERFT_GPU_MEMCPY_TO_SYMBOL(sym, src, bytes) cudaMemcpyToSymbol(sym, src, bytes)
+#define PERFT_GPU_HOST_ALLOC(ptr, bytes) cudaMallocHost(reinterpret_cast<void**>(ptr), bytes)
+#define PERFT_GPU_HOST_FREE(ptr) cudaFreeHost(ptr)
+#define PERFT_GPU_STREAM cudaStream_t
+#define PERFT_GPU_STREAM_CREATE(ptr) cudaStreamCreateWithFlags(ptr, cudaStreamNonBlocking)
+#define PERFT_GPU_STREAM_DESTROY(stream) cudaStreamDestroy(stream)
+#define PERFT_GPU_STREAM_SYNCHRONIZE(stream) cudaStreamSynchronize(stream)
+#define PERFT_GPU_GET_DEVICE(ptr) cudaGetDevice(ptr)
+#define PERFT_GPU_SET_DEVICE(device) cudaSetDevice(device)
 #define PERFT_GPU_MEMSET(ptr, value, bytes) cudaMemset(ptr, value, bytes)
+#define PERFT_GPU_MEMSET_ASYNC(ptr, value, bytes, stream) cudaMemsetAsync(ptr, value, bytes, stream)
+#define PERFT_ATOMIC_ADD(addr, value) atomicAdd(reinterpret_cast<unsigned long long*>(addr), (unsigned long long) (value))
+#define PERFT_KERNEL_ENV "CRTK_PERFT_CUDA_KERNEL"
+#define PERFT_ATOMIC_CAS(addr, expected, value) atomicCAS(reinterpret_cast<unsigned long long*>(addr), (unsigned long long) (expected), (unsigned long long) (value))
+#define PERFT_ATOMIC_EXCH(addr, value) atomicExch(reinterpret_cast<unsigned long long*>(addr), (unsigned long long) (value))
+#define PERFT_TT_ENV "CRTK_PERFT_CUDA_TT_MB"
 #define PERFT_GPU_DEVICE_SYNCHRONIZE() cudaDeviceSynchronize()
 #define PERFT_GPU_GET_DEVICE_COUNT(ptr) cudaGetDeviceCount(ptr)
 #define PERFT_GPU_LAST_ERROR() cudaGetLastError()
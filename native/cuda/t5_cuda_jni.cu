@@ -6,8 +6,19 @@
  * Exposes:
  *   - chess.nn.t5.cuda.Support.nativeDeviceCount() -> int
  *   - chess.nn.t5.cuda.Backend.nativeCreate(String) -> long
+ *   - chess.nn.t5.cuda.Backend.nativeCreateOnDevice(String, int) -> long (nativeCreate is device 0;
+ *     later calls on the handle select its device first, since the current device is per thread)
  *   - chess.nn.t5.cuda.Backend.nativeDestroy(long) -> void
  *   - chess.nn.t5.cuda.Backend.nativeGenerateIds(long, int[], int) -> int[]
+ *   - chess.nn.t5.cuda.Backend.nativeGenerateIdsBatch(long, int[], int[], int) -> int[]
+ *   - chess.nn.t5.cuda.Backend.nativeGetStatNames(long) -> String (comma-separated)
+ *   - chess.nn.t5.cuda.Backend.nativeGetStats(long, boolean) -> long[1 + 4 * stages]
+ *       [enabled, then per stage: calls, bytes, deviceNanos, hostNanos] (../common/gpu_stats_impl.inl)
+ *
+ * With CRTK_T5_CUDA_STATS=1 a handle times its stages with events on the default stream: uploads,
+ * the encoder, the cross-attention K/V projections, the decoder stack with its LM head, token
+ * selection (argmax, sampling or beam kernels), downloads, and the host-side slot scheduling of
+ * nativeGenerateIdsBatch. The totals are read with nativeGetStats.
  */
 
 #include <jni.h>
@@ -19,6 +30,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -29,6 +41,24 @@
 #include <unordered_map>
 #include <vector>
 
+// Event and stream types for ../common/gpu_stats_impl.inl.
+#define CRTK_GPU_STATS_SUCCESS cudaSuccess
+#define CRTK_GPU_STATS_STREAM cudaStream_t
+#define CRTK_GPU_STATS_EVENT cudaEvent_t
+#define CRTK_GPU_STATS_EVENT_CREATE(ptr) cudaEventCreate(ptr)
+#define CRTK_GPU_STATS_EVENT_DESTROY(event) cudaEventDestroy(event)
+#define CRTK_GPU_STATS_EVENT_RECORD(event, stream) cudaEventRecord(event, stream)
+#define CRTK_GPU_STATS_EVENT_ELAPSED(ms, start, stop) cudaEventElapsedTime(ms, start, stop)
+#ifdef CRTK_GPU_RANGES
+#include <nvtx3/nvToolsExt.h>
+#define CRTK_GPU_STATS_RANGE_PUSH(name) nvtxRangePushA(name)
+#define CRTK_GPU_STATS_RANGE_POP() nvtxRangePop()
+#endif
+#include "../common/flash_attention.h"
+#include "../common/gpu_stats_impl.inl"
+#include "../common/weight_cache_impl.inl"
+#include "../common/weight_image_impl.inl"
+
 static inline int device_count() {
     int count = 0;
     cudaError_t err = cudaGetDeviceCount(&count);
@@ -192,6 +222,17 @@ struct DeviceBufferI {
     }
 };
 
+// Weight-only int8 matrix (DType::I8): w is [k][stride] like the other storages
+// and column j dequantizes as w[.][j] * scale[j]. stride rounds cols up to a
+// multiple of 4 so every row can be read as char4; the padding columns hold
+// zero weights and zero scales.
+struct Int8Matrix {
+    int8_t* w = nullptr;
+    float* scale = nullptr;
+    int cols = 0;
+    int stride = 0;
+};
+
 struct AttentionWeights {
     float* wq = nullptr;
     float* wk = nullptr;
@@ -205,6 +246,10 @@ struct AttentionWeights {
     __nv_bfloat16* wkbf = nullptr;
     __nv_bfloat16* wvbf = nullptr;
     __nv_bfloat16* wobf = nullptr;
+    Int8Matrix wq8;
+    Int8Matrix wk8;
+    Int8Matrix wv8;
+    Int8Matrix wo8;
 };
 
 struct FfnWeights {
@@ -217,6 +262,9 @@ struct FfnWeights {
     __nv_bfloat16* wi0bf = nullptr;
     __nv_bfloat16* wi1bf = nullptr;
     __nv_bfloat16* wobf = nullptr;
+    Int8Matrix wi08;
+    Int8Matrix wi18;
+    Int8Matrix wo8;
 };
 
 struct EncoderLayer {
@@ -250,25 +298,86 @@ struct Workspace {
     DeviceBufferF reduceMax;
     DeviceBufferI reduceIdx;
     DeviceBufferI ids;
+    DeviceBufferI lens;
     DeviceBufferH halfA;
     DeviceBufferB bfA;
 };
 
-struct DecoderCache {
-    float* k = nullptr; // [maxLen * dAttn]
-    float* v = nullptr; // [maxLen * dAttn]
-    int capacity = 0;
+// Batched decoding keeps decoder self-attention K/V in fixed-size pages drawn
+// from a pool that lives as long as the model. A sequence takes pages as it
+// grows and returns them when it finishes, so the next queued sequence can
+// take over its slot mid-batch (continuous batching).
+static constexpr int KV_PAGE_TOKENS = 16;
+
+struct KvArena {
+    DeviceBufferF k;      // [layer][page][KV_PAGE_TOKENS][dAttn]
+    DeviceBufferF v;
+    DeviceBufferF crossK; // [layer][slot][encCap][dAttn]
+    DeviceBufferF crossV;
+    DeviceBufferI meta;   // per-step row tables (see run_decoder_step_batch)
+    int pages = 0;
+    int slots = 0;
+    int encCap = 0;
+    int pagesPerSeq = 0;
+    std::vector<int> freePages;
+};
+
+// Single-prompt decoding (nativeGenerateIds) keeps the whole token loop on the
+// device: greedy, top-k/top-p sampling and beam search all pick tokens in
+// kernels, and the host only polls a done flag every few steps
+// (CRTK_T5_CUDA_POLL_STEPS, default SEARCH_POLL_STEPS) and copies the
+// finished ids back once.
+static constexpr int MAX_BEAMS = 8;
+static constexpr int SAMPLE_MAX_K = 64;
+static constexpr int SEARCH_POLL_STEPS = 8;
+
+struct DecodeOptions {
+    int beams = 1;                // CRTK_T5_CUDA_BEAMS; > 1 selects beam search
+    float lengthPenalty = 1.0f;   // CRTK_T5_CUDA_LENGTH_PENALTY (score / length^penalty)
+    int topK = 0;                 // CRTK_T5_CUDA_TOP_K; > 0 selects sampling
+    float topP = 1.0f;            // CRTK_T5_CUDA_TOP_P; < 1 selects sampling
+    float temperature = 1.0f;     // CRTK_T5_CUDA_TEMPERATURE
+    unsigned long long seed = 0;  // CRTK_T5_CUDA_SEED
+    int pollSteps = SEARCH_POLL_STEPS; // CRTK_T5_CUDA_POLL_STEPS; 1 polls after every step
+};
+
+// Device-side search bookkeeping, one per model (searches run one at a time).
+struct SearchState {
+    int done;
+    int hypCount;
+    int parent[MAX_BEAMS];
+    float score[MAX_BEAMS];
+    float hypScore[MAX_BEAMS];
+    int hypLen[MAX_BEAMS];
+};
+
+struct SearchArena {
+    DeviceBufferF k[2];   // [layer][beam][cap][dAttn], ping-pong across beam reorders
+    DeviceBufferF v[2];
+    DeviceBufferF crossK; // [layer][encSeq][dAttn]
+    DeviceBufferF crossV;
+    DeviceBufferF candScore;
+    DeviceBufferI candToken;
+    DeviceBufferI meta;   // search row tables (see generate_search)
+    DeviceBufferI tokens; // [2][beam][stride] live rows, then [beam][stride] hypotheses
+    SearchState* state = nullptr;
 };
 
+// I8 keeps the decoder matrices (self/cross attention and FFN) and lm_head as
+// per-channel int8 and the encoder matrices as F16; decode steps are bound by
+// reading those weights once per token.
 enum class DType {
     F32,
     F16,
-    BF16
+    BF16,
+    I8
 };
 
-struct T5Gpu {
+// Immutable weights of one file on one device in one DType, shared by every
+// handle that opens it (see ../common/weight_cache_impl.inl).
+struct T5Model {
+    int device = 0;
     T5Config cfg;
-    cublasHandle_t handle = nullptr;
     DType dtype = DType::F32;
     float* d_shared = nullptr;
     float* d_encoderRelBias = nullptr;
@@ -280,23 +389,65 @@ struct T5Gpu {
     float* d_lmHead = nullptr;
     half* d_lmHead16 = nullptr;
     __nv_bfloat16* d_lmHeadBf = nullptr;
-    Workspace ws;
+    Int8Matrix d_lmHead8;
+    unsigned char* d_arena = nullptr; // set when loaded from a weight image; owns every tensor
 };
 
-struct EncoderState {
-    int seq = 0;
-    float* hidden = nullptr;
+// Timed stages, in nativeGetStats order. Every kernel runs on the default stream.
+enum T5Stage : int {
+    T5_STAGE_UPLOAD = 0,   // prompt lengths, step metadata and search state, host to device
+    T5_STAGE_ENCODER = 1,  // embedding and encoder stack of the admitted prompts
+    T5_STAGE_CROSS_KV = 2, // cross-attention K/V projections
+    T5_STAGE_DECODER = 3,  // one step of the decoder stack and LM head
+    T5_STAGE_SELECT = 4,   // argmax, sampling or beam kernels
+    T5_STAGE_DOWNLOAD = 5, // token ids and search state, device to host
+    T5_STAGE_SCHEDULE = 6, // host-side slot and page bookkeeping per batched step
+    T5_STAGES = 7
+};
+
+static const char* const T5_STAGE_NAMES[T5_STAGES] = {
+    "upload", "encoder", "cross_kv", "decoder", "select", "download", "schedule"
+};
+
+struct T5Gpu {
+    std::shared_ptr<const T5Model> model;
+    int device = 0;
+    cublasHandle_t handle = nullptr;
+    Workspace ws;
+    KvArena kv;
+    DecodeOptions decode;
+    unsigned long long sampleCalls = 0; // sampled generate_search calls, mixed into the draw key
+    SearchArena search;
+    GpuStats stats; // CRTK_T5_CUDA_STATS
 };
 
 static bool cublas_ok(cublasStatus_t status) {
     return status == CUBLAS_STATUS_SUCCESS;
 }
 
+// cudaMemcpy bracketed as `stage` of the handle's stats.
+static bool timed_copy(T5Gpu* gpu, int stage, void* dst, const void* src, size_t bytes, cudaMemcpyKind kind) {
+    gpu->stats.begin(stage, nullptr);
+    bool ok = cuda_ok(cudaMemcpy(dst, src, bytes, kind));
+    gpu->stats.end(stage, nullptr, static_cast<long long>(bytes));
+    return ok;
+}
+
+// Folds the brackets recorded so far into the totals once the default stream is idle.
+static void collect_stats(T5Gpu* gpu) {
+    if (!gpu->stats.enabled()) return;
+    (void) cudaStreamSynchronize(nullptr);
+    gpu->stats.collect();
+}
+
+// Asked of the current device, which nativeCreate has just selected.
 static bool supports_bf16() {
+    int device = 0;
     int major = 0;
     int minor = 0;
-    if (cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor, 0) != cudaSuccess) return false;
-    if (cudaDeviceGetAttribute(&minor, cudaDevAttrComputeCapabilityMinor, 0) != cudaSuccess) return false;
+    if (cudaGetDevice(&device) != cudaSuccess) return false;
+    if (cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor, device) != cudaSuccess) return false;
+    if (cudaDeviceGetAttribute(&minor, cudaDevAttrComputeCapabilityMinor, device) != cudaSuccess) return false;
     return major >= 8; // Ampere+ supports BF16
 }
 
@@ -313,9 +464,43 @@ static DType parse_dtype() {
     if (value == "bf16" || value == "bfloat16") {
         return supports_bf16() ? DType::BF16 : DType::F16;
     }
+    if (value == "int8" || value == "i8") {
+        return DType::I8;
+    }
     return DType::F32;
 }
 
+// Decoding options for nativeGenerateIds, read once per model. Sampling wins
+// over beam search when both are requested; out-of-range values fall back to
+// the defaults.
+static DecodeOptions parse_decode_options() {
+    DecodeOptions opt;
+    if (const char* env = std::getenv("CRTK_T5_CUDA_BEAMS")) {
+        opt.beams = std::min(std::max(std::atoi(env), 1), MAX_BEAMS);
+    }
+    if (const char* env = std::getenv("CRTK_T5_CUDA_LENGTH_PENALTY")) {
+        opt.lengthPenalty = static_cast<float>(std::atof(env));
+    }
+    if (const char* env = std::getenv("CRTK_T5_CUDA_TOP_K")) {
+        opt.topK = std::min(std::max(std::atoi(env), 0), SAMPLE_MAX_K);
+    }
+    if (const char* env = std::getenv("CRTK_T5_CUDA_TOP_P")) {
+        float value = static_cast<float>(std::atof(env));
+        if (value > 0.0f && value < 1.0f) opt.topP = value;
+    }
+    if (const char* env = std::getenv("CRTK_T5_CUDA_TEMPERATURE")) {
+        float value = static_cast<float>(std::atof(env));
+        if (value > 0.0f) opt.temperature = value;
+    }
+    if (const char* env = std::getenv("CRTK_T5_CUDA_SEED")) {
+        opt.seed = std::strtoull(env, nullptr, 10);
+    }
+    if (const char* env = std::getenv("CRTK_T5_CUDA_POLL_STEPS")) {
+        opt.pollSteps = std::min(std::max(std::atoi(env), 1), 64);
+    }
+    return opt;
+}
+
 static inline __host__ __device__ half to_half(float v) {
     return __float2half_rn(v);
 }
@@ -609,12 +794,61 @@ static bool upload_tensor_auto(const std::string& name,
     if (forceF32 || dtype == DType::F32) {
         return upload_tensor_f32(name, t, fOut);
     }
-    if (dtype == DType::F16) {
+    if (dtype == DType::F16 || dtype == DType::I8) {
         return upload_tensor_f16(name, t, hOut);
     }
     return upload_tensor_bf16(name, t, bOut);
 }
 
+// Quantizes a [n][k] weight to int8 with one symmetric scale per output
+// channel (max |w| / 127, no calibration data) and uploads it transposed,
+// padded to Int8Matrix::stride columns.
+static bool upload_tensor_int8(const std::string& name, const HostTensor& t, Int8Matrix& out) {
+    if (!should_transpose(name, t)) return false;
+    const int n = t.shape[0];
+    const int k = t.shape[1];
+    const int stride = (n + 3) & ~3;
+    std::vector<float> scale(static_cast<size_t>(stride), 0.0f);
+    for (int j = 0; j < n; j++) {
+        float maxAbs = 0.0f;
+        for (int i = 0; i < k; i++) {
+            maxAbs = std::max(maxAbs, std::fabs(t.data[static_cast<size_t>(j) * k + i]));
+        }
+        scale[static_cast<size_t>(j)] = maxAbs / 127.0f;
+    }
+    std::vector<int8_t> q(static_cast<size_t>(stride) * k, 0);
+    for (int j = 0; j < n; j++) {
+        const float s = scale[static_cast<size_t>(j)];
+        for (int i = 0; i < k; i++) {
+            float v = s > 0.0f ? std::nearbyint(t.data[static_cast<size_t>(j) * k + i] / s) : 0.0f;
+            v = std::min(127.0f, std::max(-127.0f, v));
+            q[static_cast<size_t>(i) * stride + j] = static_cast<int8_t>(v);
+        }
+    }
+    if (!cuda_ok(cudaMalloc(reinterpret_cast<void**>(&out.w), q.size()))) return false;
+    if (!cuda_ok(cudaMemcpy(out.w, q.data(), q.size(), cudaMemcpyHostToDevice))) return false;
+    if (!cuda_alloc(&out.scale, scale.size())) return false;
+    if (!cuda_copy_to_device(out.scale, scale)) return false;
+    out.cols = n;
+    out.stride = stride;
+    return true;
+}
+
+// Decoder matrices and lm_head go to int8 under DType::I8 and follow
+// upload_tensor_auto otherwise.
+static bool upload_decoder_matrix(const std::string& name,
+                                  const HostTensor& t,
+                                  DType dtype,
+                                  float** fOut,
+                                  half** hOut,
+                                  __nv_bfloat16** bOut,
+                                  Int8Matrix& qOut) {
+    if (dtype == DType::I8 && t.shape.size() == 2) {
+        return upload_tensor_int8(name, t, qOut);
+    }
+    return upload_tensor_auto(name, t, dtype, fOut, hOut, bOut, false);
+}
+
 static bool gemm_row_major_f32(cublasHandle_t handle,
                                bool transA,
                                bool transB,
@@ -668,7 +902,8 @@ static bool gemm_row_major(T5Gpu* gpu,
                            const half* Bh,
                            const __nv_bfloat16* Bb,
                            float* C) {
-    if (gpu->dtype == DType::F32) {
+    const T5Model& model = *gpu->model;
+    if (model.dtype == DType::F32) {
         return gemm_row_major_f32(gpu->handle, false, false, m, n, k, A, Bf, C);
     }
     if (m <= 0 || n <= 0 || k <= 0) return true;
@@ -680,7 +915,7 @@ static bool gemm_row_major(T5Gpu* gpu,
     cublasOperation_t opB = CUBLAS_OP_N;
     cublasOperation_t opA = CUBLAS_OP_N;
 
-    if (gpu->dtype == DType::F16) {
+    if (model.dtype == DType::F16 || model.dtype == DType::I8) {
         if (!gpu->ws.halfA.ensure(static_cast<size_t>(total))) return false;
         float_to_half_kernel<<<blocks, threads>>>(A, gpu->ws.halfA.ptr, total);
         if (!cuda_ok(cudaGetLastError())) return false;
@@ -729,12 +964,80 @@ static bool gemm_row_major(T5Gpu* gpu,
                                   CUBLAS_GEMM_DEFAULT_TENSOR_OP));
 }
 
+constexpr int W8_COLS = 128; // output columns per block: 32 lanes x 4
+constexpr int W8_WARPS = 8;  // warps per block, each taking every 8th k
+constexpr int W8_ROWS = 4;   // activation rows per block
+
+// C[m][n] = A[m][k] * (B[k][n] * scale[n]) for fp16 activations A and an int8
+// B with row stride ldb (n rounded up to 4, see Int8Matrix). Each lane streams 4
+// adjacent int8 columns per k and accumulates in fp32; the warps' partial sums
+// are added in a fixed order, so results do not depend on scheduling.
+// grid (ceil(n / W8_COLS), ceil(m / W8_ROWS)), block 32 * W8_WARPS.
+__global__ void gemm_w8_kernel(const half* __restrict__ A, const int8_t* __restrict__ B,
+                               const float* __restrict__ scale, float* __restrict__ C, int m, int n, int k,
+                               int ldb) {
+    __shared__ float partial[W8_WARPS][W8_ROWS][W8_COLS];
+    const int lane = threadIdx.x & 31;
+    const int warp = threadIdx.x >> 5;
+    const int col = blockIdx.x * W8_COLS + lane * 4;
+    const int row0 = blockIdx.y * W8_ROWS;
+    const int rows = m - row0 < W8_ROWS ? m - row0 : W8_ROWS;
+    float acc[W8_ROWS][4] = {};
+    if (col < n) {
+        for (int kk = warp; kk < k; kk += W8_WARPS) {
+            const char4 w = *reinterpret_cast<const char4*>(B + static_cast<size_t>(kk) * ldb + col);
+            for (int r = 0; r < rows; r++) {
+                const float a = __half2float(A[static_cast<size_t>(row0 + r) * k + kk]);
+                acc[r][0] += a * static_cast<float>(w.x);
+                acc[r][1] += a * static_cast<float>(w.y);
+                acc[r][2] += a * static_cast<float>(w.z);
+                acc[r][3] += a * static_cast<float>(w.w);
+            }
+        }
+    }
+    for (int r = 0; r < W8_ROWS; r++) {
+        for (int c = 0; c < 4; c++) partial[warp][r][lane * 4 + c] = acc[r][c];
+    }
+    __syncthreads();
+    for (int e = threadIdx.x; e < W8_ROWS * W8_COLS; e += blockDim.x) {
+        const int r = e / W8_COLS;
+        const int c = blockIdx.x * W8_COLS + e % W8_COLS;
+        if (r >= rows || c >= n) continue;
+        float sum = 0.0f;
+        for (int w = 0; w < W8_WARPS; w++) sum += partial[w][r][e % W8_COLS];
+        C[static_cast<size_t>(row0 + r) * n + c] = sum * scale[c];
+    }
+}
+
+// Decoder and lm_head GEMMs: the int8 kernel on fp16 activations when the
+// weight was quantized, otherwise the model's matrix dtype as above.
+static bool gemm_row_major(T5Gpu* gpu,
+                           int m,
+                           int n,
+                           int k,
+                           const float* A,
+                           const float* Bf,
+                           const half* Bh,
+                           const __nv_bfloat16* Bb,
+                           const Int8Matrix& Bq,
+                           float* C) {
+    if (!Bq.w) return gemm_row_major(gpu, m, n, k, A, Bf, Bh, Bb, C);
+    if (m <= 0 || n <= 0 || k <= 0) return true;
+    const int total = m * k;
+    if (!gpu->ws.halfA.ensure(static_cast<size_t>(total))) return false;
+    float_to_half_kernel<<<(total + 255) / 256, 256>>>(A, gpu->ws.halfA.ptr, total);
+    if (!cuda_ok(cudaGetLastError())) return false;
+    dim3 grid((n + W8_COLS - 1) / W8_COLS, (m + W8_ROWS - 1) / W8_ROWS);
+    gemm_w8_kernel<<<grid, 32 * W8_WARPS>>>(gpu->ws.halfA.ptr, Bq.w, Bq.scale, C, m, n, k, Bq.stride);
+    return cuda_ok(cudaGetLastError());
+}
+
 static inline const float* pick_f(const float* f, DType dtype) {
     return dtype == DType::F32 ? f : nullptr;
 }
 
 static inline const half* pick_h(const half* h, DType dtype) {
-    return dtype == DType::F16 ? h : nullptr;
+    return dtype == DType::F16 || dtype == DType::I8 ? h : nullptr;
 }
 
 static inline const __nv_bfloat16* pick_b(const __nv_bfloat16* b, DType dtype) {
@@ -817,20 +1120,40 @@ __device__ int rel_bucket(int relative, int buckets, int maxExact, int maxDistan
     return offset + bucket;
 }
 
-__global__ void attn_scores_kernel(const float* q, const float* k, float* attn,
+// T5 relative position bias as a flash_attention() score bias.
+struct T5RelBias {
+    const float* table = nullptr;
+    int heads = 0;
+    int buckets = 0;
+    int maxDistance = 0;
+    bool bidirectional = false;
+
+    __device__ float operator()(int h, int i, int j) const {
+        if (table == nullptr) return 0.0f;
+        int perDirection = bidirectional ? buckets / 2 : buckets;
+        return table[rel_bucket(j - i, perDirection, perDirection / 2, maxDistance, bidirectional) * heads + h];
+    }
+};
+
+// Unfused reference path, used when dKv exceeds FLASH_MAX_DEPTH.
+// blockIdx.z = b * heads + h over a padded batch of sequences laid out back to
+// back (qLen / kLen rows each); keys at or past lens[b] are masked out.
+__global__ void attn_scores_kernel(const float* q, const float* k, float* attn, const int* lens,
                                    int qLen, int kLen, int heads, int dKv, int dAttn,
                                    bool causal, const float* relBias, int relBuckets, int relMaxDistance,
                                    bool bidirectional) {
     int j = blockIdx.x * blockDim.x + threadIdx.x;
     int i = blockIdx.y * blockDim.y + threadIdx.y;
-    int h = blockIdx.z;
-    if (i >= qLen || j >= kLen || h >= heads) return;
-    if (causal && j > i) {
-        attn[(h * qLen + i) * kLen + j] = -1e9f;
+    int z = blockIdx.z;
+    int h = z % heads;
+    int b = z / heads;
+    if (i >= qLen || j >= kLen) return;
+    if ((causal && j > i) || (lens != nullptr && j >= lens[b])) {
+        attn[(z * qLen + i) * kLen + j] = -1e9f;
         return;
     }
-    int qBase = i * dAttn + h * dKv;
-    int kBase = j * dAttn + h * dKv;
+    int qBase = (b * qLen + i) * dAttn + h * dKv;
+    int kBase = (b * kLen + j) * dAttn + h * dKv;
     float sum = 0.0f;
     for (int d = 0; d < dKv; d++) {
         sum += q[qBase + d] * k[kBase + d];
@@ -841,7 +1164,7 @@ __global__ void attn_scores_kernel(const float* q, const float* k, float* attn,
         int bucket = rel_bucket(j - i, buckets, maxExact, relMaxDistance, bidirectional);
         sum += relBias[bucket * heads + h];
     }
-    attn[(h * qLen + i) * kLen + j] = sum;
+    attn[(z * qLen + i) * kLen + j] = sum;
 }
 
 __global__ void softmax_kernel(float* attn, int rows, int cols) {
@@ -885,28 +1208,73 @@ __global__ void softmax_kernel(float* attn, int rows, int cols) {
     }
 }
 
-__global__ void attn_scores_softmax_single_kernel(const float* q, const float* k, float* attn,
-                                                  int seq, int heads, int dKv, int dAttn,
-                                                  const float* relBias, int relBuckets, int relMaxDistance,
-                                                  int pos, bool bidirectional) {
+__global__ void attn_out_kernel(const float* attn, const float* v, float* out,
+                                int qLen, int kLen, int heads, int dKv, int dAttn) {
+    int d = blockIdx.x * blockDim.x + threadIdx.x;
+    int i = blockIdx.y * blockDim.y + threadIdx.y;
+    int z = blockIdx.z;
+    int h = z % heads;
+    int b = z / heads;
+    if (d >= dKv || i >= qLen) return;
+    float sum = 0.0f;
+    int attnBase = (z * qLen + i) * kLen;
+    int vBase = b * kLen * dAttn + h * dKv + d;
+    for (int j = 0; j < kLen; j++) {
+        sum += attn[attnBase + j] * v[j * dAttn + vBase];
+    }
+    out[(b * qLen + i) * dAttn + h * dKv + d] = sum;
+}
+
+// Row j of sequence `slot` in the batch K/V arena: through the slot's page
+// table for decoder self-attention, or in its contiguous encoder block.
+__device__ size_t kv_row(const int* pageTable, int pagesPerSeq, int slot, int slotStride, int j) {
+    if (pageTable != nullptr) {
+        int page = pageTable[slot * pagesPerSeq + j / KV_PAGE_TOKENS];
+        return static_cast<size_t>(page) * KV_PAGE_TOKENS + j % KV_PAGE_TOKENS;
+    }
+    return static_cast<size_t>(slot) * slotStride + j;
+}
+
+__global__ void kv_append_kernel(const float* k, const float* v, float* kPool, float* vPool,
+                                 const int* rowSlot, const int* rowPos, const int* pageTable, int pagesPerSeq,
+                                 int rows, int dAttn) {
+    int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if (idx >= rows * dAttn) return;
+    int r = idx / dAttn;
+    int d = idx % dAttn;
+    size_t dst = kv_row(pageTable, pagesPerSeq, rowSlot[r], 0, rowPos[r]) * dAttn + d;
+    kPool[dst] = k[idx];
+    vPool[dst] = v[idx];
+}
+
+// One block per (head, live row): scores, softmax and the weighted value sum
+// of a single decoder query. With a page table the keys are the row's own
+// cached positions 0..pos; without one they are its slot's encoder block.
+__global__ void attn_rows_kernel(const float* q, const float* k, const float* v, float* attn, float* out,
+                                 const int* rowSlot, const int* rowPos, const int* encLen,
+                                 const int* pageTable, int pagesPerSeq, int slotStride, int attnStride,
+                                 int heads, int dKv, int dAttn,
+                                 const float* relBias, int relBuckets, int relMaxDistance) {
     int h = blockIdx.x;
-    if (h >= heads) return;
+    int r = blockIdx.y;
+    int slot = rowSlot[r];
+    int pos = rowPos[r];
+    int kLen = pageTable != nullptr ? pos + 1 : encLen[slot];
+    float* scores = attn + (static_cast<size_t>(r) * heads + h) * attnStride;
+    const float* qRow = q + static_cast<size_t>(r) * dAttn + h * dKv;
 
     float localMax = -1e20f;
-    int qBase = h * dKv;
-    for (int j = threadIdx.x; j < seq; j += blockDim.x) {
-        int kBase = j * dAttn + h * dKv;
+    for (int j = threadIdx.x; j < kLen; j += blockDim.x) {
+        const float* kRow = k + kv_row(pageTable, pagesPerSeq, slot, slotStride, j) * dAttn + h * dKv;
         float sum = 0.0f;
         for (int d = 0; d < dKv; d++) {
-            sum += q[qBase + d] * k[kBase + d];
+            sum += qRow[d] * kRow[d];
         }
         if (relBias != nullptr) {
-            int buckets = bidirectional ? relBuckets / 2 : relBuckets;
-            int maxExact = buckets / 2;
-            int bucket = rel_bucket(j - pos, buckets, maxExact, relMaxDistance, bidirectional);
+            int bucket = rel_bucket(j - pos, relBuckets, relBuckets / 2, relMaxDistance, false);
             sum += relBias[bucket * heads + h];
         }
-        attn[h * seq + j] = sum;
+        scores[j] = sum;
         if (sum > localMax) {
             localMax = sum;
         }
@@ -926,9 +1294,9 @@ __global__ void attn_scores_softmax_single_kernel(const float* q, const float* k
     float maxVal = sharedMax[0];
 
     float localSum = 0.0f;
-    for (int j = threadIdx.x; j < seq; j += blockDim.x) {
-        float expv = expf(attn[h * seq + j] - maxVal);
-        attn[h * seq + j] = expv;
+    for (int j = threadIdx.x; j < kLen; j += blockDim.x) {
+        float expv = expf(scores[j] - maxVal);
+        scores[j] = expv;
         localSum += expv;
     }
 
@@ -942,74 +1310,301 @@ __global__ void attn_scores_softmax_single_kernel(const float* q, const float* k
         __syncthreads();
     }
     float inv = sharedSum[0] == 0.0f ? 0.0f : 1.0f / sharedSum[0];
+    for (int j = threadIdx.x; j < kLen; j += blockDim.x) {
+        scores[j] *= inv;
+    }
+    __syncthreads();
 
-    for (int j = threadIdx.x; j < seq; j += blockDim.x) {
-        attn[h * seq + j] *= inv;
+    for (int d = threadIdx.x; d < dKv; d += blockDim.x) {
+        float sum = 0.0f;
+        for (int j = 0; j < kLen; j++) {
+            sum += scores[j] * v[kv_row(pageTable, pagesPerSeq, slot, slotStride, j) * dAttn + h * dKv + d];
+        }
+        out[static_cast<size_t>(r) * dAttn + h * dKv + d] = sum;
     }
 }
 
-__global__ void attn_out_kernel(const float* attn, const float* v, float* out,
-                                int qLen, int kLen, int heads, int dKv, int dAttn) {
-    int d = blockIdx.x * blockDim.x + threadIdx.x;
-    int i = blockIdx.y * blockDim.y + threadIdx.y;
-    int h = blockIdx.z;
-    if (d >= dKv || i >= qLen || h >= heads) return;
-    float sum = 0.0f;
-    int attnBase = (h * qLen + i) * kLen;
-    int vBase = h * dKv + d;
-    for (int j = 0; j < kLen; j++) {
-        sum += attn[attnBase + j] * v[j * dAttn + vBase];
+// Block-wide argmax over row[0..n) for a 256-thread block; ties go to the
+// lower index. Every thread sees the result in smax[0] / sidx[0].
+__device__ void block_argmax(const float* row, int n, float* smax, int* sidx) {
+    float best = -1e20f;
+    int bestIdx = 0;
+    for (int c = threadIdx.x; c < n; c += blockDim.x) {
+        if (row[c] > best) {
+            best = row[c];
+            bestIdx = c;
+        }
+    }
+    smax[threadIdx.x] = best;
+    sidx[threadIdx.x] = bestIdx;
+    __syncthreads();
+    for (int stride = blockDim.x / 2; stride > 0; stride >>= 1) {
+        if (threadIdx.x < stride) {
+            float other = smax[threadIdx.x + stride];
+            int otherIdx = sidx[threadIdx.x + stride];
+            if (other > smax[threadIdx.x] || (other == smax[threadIdx.x] && otherIdx < sidx[threadIdx.x])) {
+                smax[threadIdx.x] = other;
+                sidx[threadIdx.x] = otherIdx;
+            }
+        }
+        __syncthreads();
     }
-    out[i * dAttn + vBase] = sum;
 }
 
-__global__ void argmax_block_kernel(const float* data, int n, float* blockMax, int* blockIdxOut) {
+// Per-row greedy pick over [rows x vocab] logits.
+__global__ void argmax_rows_kernel(const float* logits, int vocab, int* outIds) {
+    __shared__ float smax[256];
+    __shared__ int sidx[256];
+    block_argmax(logits + static_cast<size_t>(blockIdx.x) * vocab, vocab, smax, sidx);
+    if (threadIdx.x == 0) {
+        outIds[blockIdx.x] = sidx[0];
+    }
+}
+
+__global__ void embed_tokens_kernel(const int* tokens, int stride, int pos, int rows, int vocab, int dModel, int unkId,
+                                    const float* emb, float* out) {
     int idx = blockIdx.x * blockDim.x + threadIdx.x;
-    float v = (idx < n) ? data[idx] : -1e20f;
+    if (idx >= rows * dModel) return;
+    int row = idx / dModel;
+    int col = idx % dModel;
+    int id = tokens[row * stride + pos];
+    if (id < 0 || id >= vocab) id = unkId;
+    out[idx] = emb[id * dModel + col];
+}
+
+// One block per beam: log-softmax of the beam's logits and its 2 * beams best
+// continuations, scored as the beam's running log-probability plus the
+// token's. Beams that are not alive emit -INFINITY candidates. The logits
+// row is used as scratch.
+__global__ void beam_topk_kernel(float* logits, int vocab, const SearchState* state,
+                                 float* candScore, int* candToken, int beams) {
+    int b = blockIdx.x;
+    int perBeam = 2 * beams;
+    float* row = logits + static_cast<size_t>(b) * vocab;
+    float base = state->score[b];
+    if (state->done || base < -1e29f) {
+        for (int i = threadIdx.x; i < perBeam; i += blockDim.x) {
+            candScore[b * perBeam + i] = -INFINITY;
+            candToken[b * perBeam + i] = 0;
+        }
+        return;
+    }
+
     __shared__ float smax[256];
     __shared__ int sidx[256];
-    smax[threadIdx.x] = v;
-    sidx[threadIdx.x] = idx;
+    float localMax = -1e20f;
+    for (int c = threadIdx.x; c < vocab; c += blockDim.x) {
+        localMax = fmaxf(localMax, row[c]);
+    }
+    smax[threadIdx.x] = localMax;
     __syncthreads();
     for (int stride = blockDim.x / 2; stride > 0; stride >>= 1) {
         if (threadIdx.x < stride) {
-            float other = smax[threadIdx.x + stride];
-            if (other > smax[threadIdx.x]) {
-                smax[threadIdx.x] = other;
-                sidx[threadIdx.x] = sidx[threadIdx.x + stride];
-            }
+            smax[threadIdx.x] = fmaxf(smax[threadIdx.x], smax[threadIdx.x + stride]);
         }
         __syncthreads();
     }
-    if (threadIdx.x == 0) {
-        blockMax[blockIdx.x] = smax[0];
-        blockIdxOut[blockIdx.x] = sidx[0];
+    float maxVal = smax[0];
+    __syncthreads();
+    float localSum = 0.0f;
+    for (int c = threadIdx.x; c < vocab; c += blockDim.x) {
+        localSum += expf(row[c] - maxVal);
+    }
+    smax[threadIdx.x] = localSum;
+    __syncthreads();
+    for (int stride = blockDim.x / 2; stride > 0; stride >>= 1) {
+        if (threadIdx.x < stride) {
+            smax[threadIdx.x] += smax[threadIdx.x + stride];
+        }
+        __syncthreads();
+    }
+    float lse = maxVal + logf(smax[0]);
+    __syncthreads();
+
+    for (int i = 0; i < perBeam; i++) {
+        block_argmax(row, vocab, smax, sidx);
+        if (threadIdx.x == 0) {
+            int c = sidx[0];
+            bool valid = i < vocab;
+            candScore[b * perBeam + i] = valid ? base + row[c] - lse : -INFINITY;
+            candToken[b * perBeam + i] = c;
+            row[c] = -INFINITY;
+        }
+        __syncthreads();
     }
 }
 
-static bool argmax_device(Workspace& ws, const float* logits, int vocab, int& outIdx) {
-    const int threads = 256;
-    int blocks = (vocab + threads - 1) / threads;
-    if (!ws.reduceMax.ensure(static_cast<size_t>(blocks))) return false;
-    if (!ws.reduceIdx.ensure(static_cast<size_t>(blocks))) return false;
-    argmax_block_kernel<<<blocks, threads>>>(logits, vocab, ws.reduceMax.ptr, ws.reduceIdx.ptr);
-    if (!cuda_ok(cudaGetLastError())) return false;
+// Adds row[0..keep) as a finished hypothesis, scored sum / genLen^penalty,
+// replacing the worst one once all `beams` places are taken.
+__device__ void add_hypothesis(SearchState* state, int* hyp, int stride, int beams,
+                               const int* row, int keep, int genLen, float sum, float lengthPenalty) {
+    float norm = sum / powf(static_cast<float>(genLen), lengthPenalty);
+    int dst = state->hypCount;
+    if (dst >= beams) {
+        dst = 0;
+        for (int i = 1; i < beams; i++) {
+            if (state->hypScore[i] < state->hypScore[dst]) dst = i;
+        }
+        if (norm <= state->hypScore[dst]) return;
+    } else {
+        state->hypCount++;
+    }
+    for (int j = 0; j < keep; j++) {
+        hyp[dst * stride + j] = row[j];
+    }
+    state->hypScore[dst] = norm;
+    state->hypLen[dst] = keep;
+}
 
-    std::vector<float> hMax(blocks);
-    std::vector<int> hIdx(blocks);
-    if (!cuda_ok(cudaMemcpy(hMax.data(), ws.reduceMax.ptr, sizeof(float) * blocks, cudaMemcpyDeviceToHost))) return false;
-    if (!cuda_ok(cudaMemcpy(hIdx.data(), ws.reduceIdx.ptr, sizeof(int) * blocks, cudaMemcpyDeviceToHost))) return false;
+// Single-thread beam bookkeeping after beam_topk_kernel: ranks the
+// candidates, retires EOS continuations that rank inside the beam width as
+// hypotheses, and writes the surviving beams (parent row plus new token)
+// into `nxt`. The search is done once `beams` hypotheses are finished or the
+// token budget is spent, when the live beams are retired as they stand.
+__global__ void beam_select_kernel(SearchState* state, const float* candScore, const int* candToken,
+                                   const int* cur, int* nxt, int* hyp, int stride, int pos, int maxNew,
+                                   int beams, int eosId, float lengthPenalty) {
+    if (state->done) return;
+    int perBeam = 2 * beams;
+    int n = beams * perBeam;
+    int order[MAX_BEAMS * 2 * MAX_BEAMS];
+    for (int i = 0; i < n; i++) {
+        int c = i;
+        int j = i;
+        while (j > 0 && candScore[order[j - 1]] < candScore[c]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = c;
+    }
+
+    int alive = 0;
+    for (int rank = 0; rank < n && alive < beams; rank++) {
+        int c = order[rank];
+        float s = candScore[c];
+        if (s < -1e29f) break;
+        int parent = c / perBeam;
+        int token = candToken[c];
+        const int* src = cur + parent * stride;
+        if (token == eosId) {
+            if (rank < beams) {
+                add_hypothesis(state, hyp, stride, beams, src, pos + 1, pos + 1, s, lengthPenalty);
+            }
+            continue;
+        }
+        int* dst = nxt + alive * stride;
+        for (int j = 0; j <= pos; j++) {
+            dst[j] = src[j];
+        }
+        dst[pos + 1] = token;
+        state->parent[alive] = parent;
+        state->score[alive] = s;
+        alive++;
+    }
+    for (int b = alive; b < beams; b++) {
+        state->parent[b] = 0;
+        state->score[b] = -1e30f;
+    }
 
-    float best = -1e20f;
-    int bestIdx = 0;
-    for (int i = 0; i < blocks; i++) {
-        if (hMax[i] > best) {
-            best = hMax[i];
-            bestIdx = hIdx[i];
+    if (pos + 1 >= maxNew) {
+        for (int b = 0; b < alive; b++) {
+            add_hypothesis(state, hyp, stride, beams, nxt + b * stride, pos + 2, pos + 1, state->score[b], lengthPenalty);
         }
+        state->done = 1;
+    }
+    if (state->hypCount >= beams || alive == 0) {
+        state->done = 1;
     }
-    outIdx = bestIdx;
-    return true;
+}
+
+// Gathers every beam's cached self-attention K/V (positions 0..pos, all
+// layers) from its parent's rows in the source pool so the next step reads
+// the reordered beams from the destination pool.
+__global__ void kv_reorder_kernel(const float* kSrc, const float* vSrc, float* kDst, float* vDst,
+                                  const SearchState* state, int layers, int beams, int cap, int pos, int dAttn) {
+    if (state->done) return;
+    size_t idx = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    size_t perBeam = static_cast<size_t>(pos + 1) * dAttn;
+    if (idx >= static_cast<size_t>(layers) * beams * perBeam) return;
+    size_t within = idx % perBeam;
+    int b = static_cast<int>((idx / perBeam) % beams);
+    int layer = static_cast<int>(idx / perBeam / beams);
+    size_t dst = (static_cast<size_t>(layer) * beams + b) * cap * dAttn + within;
+    size_t src = (static_cast<size_t>(layer) * beams + state->parent[b]) * cap * dAttn + within;
+    kDst[dst] = kSrc[src];
+    vDst[dst] = vSrc[src];
+}
+
+static inline __host__ __device__ unsigned long long splitmix64(unsigned long long x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Picks the next token of a single live row: the argmax when topK is 1,
+// otherwise a draw from the temperature-scaled top-k tokens trimmed to the
+// smallest prefix holding topP of their mass. The draw is a pure function of
+// (key, rowIndex, pos), where the host derives key from the seed and a
+// per-handle call counter, so separate rows and separate calls draw
+// independently while a seeded run stays reproducible. The logits row is scratch.
+__global__ void sample_kernel(float* logits, int vocab, SearchState* state, int* row, int* hyp,
+                              int rowIndex, int pos, int maxNew, int eosId, int topK, float topP,
+                              float temperature, unsigned long long key) {
+    if (state->done) return;
+    __shared__ float smax[256];
+    __shared__ int sidx[256];
+    __shared__ float topVal[SAMPLE_MAX_K];
+    __shared__ int topIdx[SAMPLE_MAX_K];
+    int k = topK < vocab ? topK : vocab;
+    for (int i = 0; i < k; i++) {
+        block_argmax(logits, vocab, smax, sidx);
+        if (threadIdx.x == 0) {
+            topVal[i] = smax[0];
+            topIdx[i] = sidx[0];
+            logits[sidx[0]] = -INFINITY;
+        }
+        __syncthreads();
+    }
+    if (threadIdx.x != 0) return;
+
+    int token = topIdx[0];
+    if (k > 1) {
+        float probs[SAMPLE_MAX_K];
+        float total = 0.0f;
+        for (int i = 0; i < k; i++) {
+            probs[i] = expf((topVal[i] - topVal[0]) / temperature);
+            total += probs[i];
+        }
+        int keep = 0;
+        float kept = 0.0f;
+        while (keep < k && (keep == 0 || kept < topP * total)) {
+            kept += probs[keep++];
+        }
+        unsigned long long slot = (static_cast<unsigned long long>(rowIndex) << 32)
+                                  | static_cast<unsigned int>(pos);
+        unsigned long long bits = splitmix64(key ^ splitmix64(slot));
+        float u = static_cast<float>(bits >> 40) * (1.0f / 16777216.0f) * kept;
+        for (int i = 0; i < keep; i++) {
+            token = topIdx[i];
+            u -= probs[i];
+            if (u < 0.0f) break;
+        }
+    }
+
+    int keepLen = pos + 1;
+    if (token != eosId) {
+        row[pos + 1] = token;
+        keepLen = pos + 2;
+        if (pos + 1 < maxNew) return;
+    }
+    for (int j = 0; j < keepLen; j++) {
+        hyp[j] = row[j];
+    }
+    state->hypCount = 1;
+    state->hypScore[0] = 0.0f;
+    state->hypLen[0] = keepLen;
+    state->done = 1;
 }
 
 static bool run_layer_norm(const float* in, float* out, const float* weight, int rows, int cols, float eps) {
@@ -1032,47 +1627,47 @@ static bool run_attention(const T5Config& cfg,
                           float* v,
                           float* attn,
                           float* out,
+                          int batch,
+                          const int* lens,
                           int qLen,
                           int kLen,
                           bool causal,
                           const float* relBias,
                           bool bidirectional) {
-    dim3 block(16, 16);
-    dim3 grid((kLen + block.x - 1) / block.x, (qLen + block.y - 1) / block.y, cfg.numHeads);
     int dAttn = cfg.numHeads * cfg.dKv;
-    attn_scores_kernel<<<grid, block>>>(q, k, attn, qLen, kLen, cfg.numHeads, cfg.dKv, dAttn, causal, relBias,
+    if (cfg.dKv <= FLASH_MAX_DEPTH) {
+        FlashAttentionShape shape;
+        shape.qLen = qLen;
+        shape.kLen = kLen;
+        shape.heads = cfg.numHeads;
+        shape.depth = cfg.dKv;
+        shape.qStride = shape.kStride = shape.vStride = shape.outStride = dAttn;
+        shape.qBatchStride = shape.outBatchStride = static_cast<size_t>(qLen) * dAttn;
+        shape.kBatchStride = shape.vBatchStride = static_cast<size_t>(kLen) * dAttn;
+        shape.lens = lens;
+        shape.causal = causal;
+        T5RelBias bias;
+        bias.table = relBias;
+        bias.heads = cfg.numHeads;
+        bias.buckets = cfg.relBuckets;
+        bias.maxDistance = cfg.relMaxDistance;
+        bias.bidirectional = bidirectional;
+        flash_attention(q, k, v, out, shape, batch, bias, static_cast<cudaStream_t>(0));
+        return cuda_ok(cudaGetLastError());
+    }
+    if (attn == nullptr) return false;
+    dim3 block(16, 16);
+    dim3 grid((kLen + block.x - 1) / block.x, (qLen + block.y - 1) / block.y, cfg.numHeads * batch);
+    attn_scores_kernel<<<grid, block>>>(q, k, attn, lens, qLen, kLen, cfg.numHeads, cfg.dKv, dAttn, causal, relBias,
                                         cfg.relBuckets, cfg.relMaxDistance, bidirectional);
     if (!cuda_ok(cudaGetLastError())) return false;
-    if (!run_softmax(attn, cfg.numHeads * qLen, kLen)) return false;
+    if (!run_softmax(attn, batch * cfg.numHeads * qLen, kLen)) return false;
     dim3 blockOut(16, 8);
-    dim3 gridOut((cfg.dKv + blockOut.x - 1) / blockOut.x, (qLen + blockOut.y - 1) / blockOut.y, cfg.numHeads);
+    dim3 gridOut((cfg.dKv + blockOut.x - 1) / blockOut.x, (qLen + blockOut.y - 1) / blockOut.y, cfg.numHeads * batch);
     attn_out_kernel<<<gridOut, blockOut>>>(attn, v, out, qLen, kLen, cfg.numHeads, cfg.dKv, dAttn);
     return cuda_ok(cudaGetLastError());
 }
 
-static bool run_attention_single(const T5Config& cfg,
-                                 float* q,
-                                 float* k,
-                                 float* v,
-                                 float* attn,
-                                 float* out,
-                                 int kLen,
-                                 const float* relBias,
-                                 bool bidirectional,
-                                 int pos) {
-    if (kLen <= 0) return false;
-    dim3 block(256);
-    dim3 grid(cfg.numHeads);
-    int dAttn = cfg.numHeads * cfg.dKv;
-    attn_scores_softmax_single_kernel<<<grid, block>>>(q, k, attn, kLen, cfg.numHeads, cfg.dKv, dAttn,
-                                                       relBias, cfg.relBuckets, cfg.relMaxDistance, pos, bidirectional);
-    if (!cuda_ok(cudaGetLastError())) return false;
-    dim3 blockOut(128, 1);
-    dim3 gridOut((cfg.dKv + blockOut.x - 1) / blockOut.x, 1, cfg.numHeads);
-    attn_out_kernel<<<gridOut, blockOut>>>(attn, v, out, 1, kLen, cfg.numHeads, cfg.dKv, dAttn);
-    return cuda_ok(cudaGetLastError());
-}
-
 static bool run_embed(const T5Config& cfg, Workspace& ws, const std::vector<int>& ids, const float* shared, float* out) {
     if (!ws.ids.ensure(ids.size())) return false;
     if (!cuda_ok(cudaMemcpy(ws.ids.ptr, ids.data(), sizeof(int) * ids.size(), cudaMemcpyHostToDevice))) return false;
@@ -1083,17 +1678,24 @@ static bool run_embed(const T5Config& cfg, Workspace& ws, const std::vector<int>
     return cuda_ok(cudaGetLastError());
 }
 
-static void destroy_gpu(T5Gpu* gpu) {
-    if (!gpu) return;
-    cuda_free(gpu->d_shared);
-    cuda_free(gpu->d_encoderRelBias);
-    cuda_free(gpu->d_decoderRelBias);
-    cuda_free(gpu->d_encoderFinalLn);
-    cuda_free(gpu->d_decoderFinalLn);
-    cuda_free(gpu->d_lmHead);
-    cuda_free(gpu->d_lmHead16);
-    cuda_free(gpu->d_lmHeadBf);
-    for (auto& layer : gpu->encoder) {
+// Frees every buffer of `model` and the model itself; the caller has made its device current.
+static void release_model_buffers(T5Model* model) {
+    if (model->d_arena) {
+        cuda_free(model->d_arena);
+        delete model;
+        return;
+    }
+    cuda_free(model->d_shared);
+    cuda_free(model->d_encoderRelBias);
+    cuda_free(model->d_decoderRelBias);
+    cuda_free(model->d_encoderFinalLn);
+    cuda_free(model->d_decoderFinalLn);
+    cuda_free(model->d_lmHead);
+    cuda_free(model->d_lmHead16);
+    cuda_free(model->d_lmHeadBf);
+    cuda_free(model->d_lmHead8.w);
+    cuda_free(model->d_lmHead8.scale);
+    for (auto& layer : model->encoder) {
         cuda_free(layer.ln1);
         cuda_free(layer.attn.wq);
         cuda_free(layer.attn.wk);
@@ -1118,7 +1720,7 @@ static void destroy_gpu(T5Gpu* gpu) {
         cuda_free(layer.ffn.wi1bf);
         cuda_free(layer.ffn.wobf);
     }
-    for (auto& layer : gpu->decoder) {
+    for (auto& layer : model->decoder) {
         cuda_free(layer.ln1);
         cuda_free(layer.selfAttn.wq);
         cuda_free(layer.selfAttn.wk);
@@ -1155,7 +1757,31 @@ static void destroy_gpu(T5Gpu* gpu) {
         cuda_free(layer.ffn.wi0bf);
         cuda_free(layer.ffn.wi1bf);
         cuda_free(layer.ffn.wobf);
+        for (Int8Matrix* q : {&layer.selfAttn.wq8, &layer.selfAttn.wk8, &layer.selfAttn.wv8, &layer.selfAttn.wo8,
+                              &layer.crossAttn.wq8, &layer.crossAttn.wk8, &layer.crossAttn.wv8, &layer.crossAttn.wo8,
+                              &layer.ffn.wi08, &layer.ffn.wi18, &layer.ffn.wo8}) {
+            cuda_free(q->w);
+            cuda_free(q->scale);
+        }
     }
+    delete model;
+}
+
+// Releases `model` on the device it was uploaded to, then restores the calling thread's
+// current device so a handle destroyed from a Java thread does not rebind that thread.
+static void release_model(T5Model* model) {
+    if (!model) return;
+    int previous = 0;
+    const bool restore = cudaGetDevice(&previous) == cudaSuccess;
+    (void) cudaSetDevice(model->device);
+    release_model_buffers(model);
+    if (restore) (void) cudaSetDevice(previous);
+}
+
+// Frees the handle's workspace; the model goes when its last handle does.
+static void destroy_gpu(T5Gpu* gpu) {
+    if (!gpu) return;
+    (void) cudaSetDevice(gpu->device);
     gpu->ws.x.release();
     gpu->ws.norm.release();
     gpu->ws.q.release();
@@ -1170,8 +1796,25 @@ static void destroy_gpu(T5Gpu* gpu) {
     gpu->ws.reduceMax.release();
     gpu->ws.reduceIdx.release();
     gpu->ws.ids.release();
+    gpu->ws.lens.release();
     gpu->ws.halfA.release();
     gpu->ws.bfA.release();
+    gpu->kv.k.release();
+    gpu->kv.v.release();
+    gpu->kv.crossK.release();
+    gpu->kv.crossV.release();
+    gpu->kv.meta.release();
+    for (int p = 0; p < 2; p++) {
+        gpu->search.k[p].release();
+        gpu->search.v[p].release();
+    }
+    gpu->search.crossK.release();
+    gpu->search.crossV.release();
+    gpu->search.candScore.release();
+    gpu->search.candToken.release();
+    gpu->search.meta.release();
+    gpu->search.tokens.release();
+    cuda_free(gpu->search.state);
     if (gpu->handle) {
         cublasDestroy(gpu->handle);
         gpu->handle = nullptr;
@@ -1179,15 +1822,13 @@ static void destroy_gpu(T5Gpu* gpu) {
     delete gpu;
 }
 
-static bool build_gpu(const HostModel& host, T5Gpu*& out) {
-    auto* gpu = new T5Gpu();
-    gpu->cfg = host.cfg;
-    if (!cublas_ok(cublasCreate(&gpu->handle))) {
-        delete gpu;
-        return false;
-    }
-    cublasSetMathMode(gpu->handle, CUBLAS_TENSOR_OP_MATH);
-    gpu->dtype = parse_dtype();
+// Uploads `host` to `device`, which must be current, storing the matrices in
+// `dtype`.
+static bool build_model(const HostModel& host, int device, DType dtype, T5Model*& out) {
+    auto* model = new T5Model();
+    model->device = device;
+    model->cfg = host.cfg;
+    model->dtype = dtype;
 
     auto get = [&](const std::string& name) -> const HostTensor* {
         auto it = host.tensors.find(name);
@@ -1196,46 +1837,47 @@ static bool build_gpu(const HostModel& host, T5Gpu*& out) {
     };
 
     const HostTensor* shared = get("shared.weight");
-    if (!shared || !upload_tensor_auto("shared.weight", *shared, DType::F32, &gpu->d_shared, nullptr, nullptr, true)) {
-        destroy_gpu(gpu);
+    if (!shared || !upload_tensor_auto("shared.weight", *shared, DType::F32, &model->d_shared, nullptr, nullptr, true)) {
+        release_model(model);
         return false;
     }
 
     const HostTensor* encBias = get("encoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight");
     const HostTensor* decBias = get("decoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight");
     if (!encBias || !upload_tensor_auto("encoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight", *encBias,
-                                        DType::F32, &gpu->d_encoderRelBias, nullptr, nullptr, true)) {
-        destroy_gpu(gpu);
+                                        DType::F32, &model->d_encoderRelBias, nullptr, nullptr, true)) {
+        release_model(model);
         return false;
     }
     if (!decBias || !upload_tensor_auto("decoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight", *decBias,
-                                        DType::F32, &gpu->d_decoderRelBias, nullptr, nullptr, true)) {
-        destroy_gpu(gpu);
+                                        DType::F32, &model->d_decoderRelBias, nullptr, nullptr, true)) {
+        release_model(model);
         return false;
     }
 
     const HostTensor* encFinal = get("encoder.final_layer_norm.weight");
     const HostTensor* decFinal = get("decoder.final_layer_norm.weight");
     if (!encFinal || !upload_tensor_auto("encoder.final_layer_norm.weight", *encFinal, DType::F32,
-                                         &gpu->d_encoderFinalLn, nullptr, nullptr, true)) {
-        destroy_gpu(gpu);
+                                         &model->d_encoderFinalLn, nullptr, nullptr, true)) {
+        release_model(model);
         return false;
     }
     if (!decFinal || !upload_tensor_auto("decoder.final_layer_norm.weight", *decFinal, DType::F32,
-                                         &gpu->d_decoderFinalLn, nullptr, nullptr, true)) {
-        destroy_gpu(gpu);
+                                         &model->d_decoderFinalLn, nullptr, nullptr, true)) {
+        release_model(model);
         return false;
     }
 
     const HostTensor* lmHead = get("lm_head.weight");
-    if (!lmHead || !upload_tensor_auto("lm_head.weight", *lmHead, gpu->dtype,
-                                       &gpu->d_lmHead, &gpu->d_lmHead16, &gpu->d_lmHeadBf, false)) {
-        destroy_gpu(gpu);
+    if (!lmHead || !upload_decoder_matrix("lm_head.weight", *lmHead, model->dtype,
+                                          &model->d_lmHead, &model->d_lmHead16, &model->d_lmHeadBf,
+                                          model->d_lmHead8)) {
+        release_model(model);
         return false;
     }
 
-    gpu->encoder.resize(static_cast<size_t>(gpu->cfg.numLayers));
-    for (int i = 0; i < gpu->cfg.numLayers; i++) {
+    model->encoder.resize(static_cast<size_t>(model->cfg.numLayers));
+    for (int i = 0; i < model->cfg.numLayers; i++) {
         EncoderLayer layer;
         std::string prefix = "encoder.block." + std::to_string(i) + ".";
         auto ln1 = get(prefix + "layer.0.layer_norm.weight");
@@ -1248,35 +1890,35 @@ static bool build_gpu(const HostModel& host, T5Gpu*& out) {
         auto wi1 = get(prefix + "layer.1.DenseReluDense.wi_1.weight");
         auto wo2 = get(prefix + "layer.1.DenseReluDense.wo.weight");
         if (!ln1 || !wq || !wk || !wv || !wo || !ln2 || !wi0 || !wi1 || !wo2) {
-            destroy_gpu(gpu);
+            release_model(model);
             return false;
         }
         if (!upload_tensor_auto(prefix + "layer.0.layer_norm.weight", *ln1, DType::F32,
                                 &layer.ln1, nullptr, nullptr, true) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.q.weight", *wq, gpu->dtype,
+            !upload_tensor_auto(prefix + "layer.0.SelfAttention.q.weight", *wq, model->dtype,
                                 &layer.attn.wq, &layer.attn.wq16, &layer.attn.wqbf, false) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.k.weight", *wk, gpu->dtype,
+            !upload_tensor_auto(prefix + "layer.0.SelfAttention.k.weight", *wk, model->dtype,
                                 &layer.attn.wk, &layer.attn.wk16, &layer.attn.wkbf, false) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.v.weight", *wv, gpu->dtype,
+            !upload_tensor_auto(prefix + "layer.0.SelfAttention.v.weight", *wv, model->dtype,
                                 &layer.attn.wv, &layer.attn.wv16, &layer.attn.wvbf, false) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.o.weight", *wo, gpu->dtype,
+            !upload_tensor_auto(prefix + "layer.0.SelfAttention.o.weight", *wo, model->dtype,
                                 &layer.attn.wo, &layer.attn.wo16, &layer.attn.wobf, false) ||
             !upload_tensor_auto(prefix + "layer.1.layer_norm.weight", *ln2, DType::F32,
                                 &layer.ln2, nullptr, nullptr, true) ||
-            !upload_tensor_auto(prefix + "layer.1.DenseReluDense.wi_0.weight", *wi0, gpu->dtype,
+            !upload_tensor_auto(prefix + "layer.1.DenseReluDense.wi_0.weight", *wi0, model->dtype,
                                 &layer.ffn.wi0, &layer.ffn.wi016, &layer.ffn.wi0bf, false) ||
-            !upload_tensor_auto(prefix + "layer.1.DenseReluDense.wi_1.weight", *wi1, gpu->dtype,
+            !upload_tensor_auto(prefix + "layer.1.DenseReluDense.wi_1.weight", *wi1, model->dtype,
                                 &layer.ffn.wi1, &layer.ffn.wi116, &layer.ffn.wi1bf, false) ||
-            !upload_tensor_auto(prefix + "layer.1.DenseReluDense.wo.weight", *wo2, gpu->dtype,
+            !upload_tensor_auto(prefix + "layer.1.DenseReluDense.wo.weight", *wo2, model->dtype,
                                 &layer.ffn.wo, &layer.ffn.wo16, &layer.ffn.wobf, false)) {
-            destroy_gpu(gpu);
+            release_model(model);
             return false;
         }
-        gpu->encoder[static_cast<size_t>(i)] = layer;
+        model->encoder[static_cast<size_t>(i)] = layer;
     }
 
-    gpu->decoder.resize(static_cast<size_t>(gpu->cfg.numDecoderLayers));
-    for (int i = 0; i < gpu->cfg.numDecoderLayers; i++) {
+    model->decoder.resize(static_cast<size_t>(model->cfg.numDecoderLayers));
+    for (int i = 0; i < model->cfg.numDecoderLayers; i++) {
         DecoderLayer layer;
         std::string prefix = "decoder.block." + std::to_string(i) + ".";
         auto ln1 = get(prefix + "layer.0.layer_norm.weight");
@@ -1294,348 +1936,898 @@ static bool build_gpu(const HostModel& host, T5Gpu*& out) {
         auto wi1 = get(prefix + "layer.2.DenseReluDense.wi_1.weight");
         auto wo3 = get(prefix + "layer.2.DenseReluDense.wo.weight");
         if (!ln1 || !wq || !wk || !wv || !wo || !ln2 || !wq2 || !wk2 || !wv2 || !wo2 || !ln3 || !wi0 || !wi1 || !wo3) {
-            destroy_gpu(gpu);
+            release_model(model);
             return false;
         }
         if (!upload_tensor_auto(prefix + "layer.0.layer_norm.weight", *ln1, DType::F32,
                                 &layer.ln1, nullptr, nullptr, true) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.q.weight", *wq, gpu->dtype,
-                                &layer.selfAttn.wq, &layer.selfAttn.wq16, &layer.selfAttn.wqbf, false) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.k.weight", *wk, gpu->dtype,
-                                &layer.selfAttn.wk, &layer.selfAttn.wk16, &layer.selfAttn.wkbf, false) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.v.weight", *wv, gpu->dtype,
-                                &layer.selfAttn.wv, &layer.selfAttn.wv16, &layer.selfAttn.wvbf, false) ||
-            !upload_tensor_auto(prefix + "layer.0.SelfAttention.o.weight", *wo, gpu->dtype,
-                                &layer.selfAttn.wo, &layer.selfAttn.wo16, &layer.selfAttn.wobf, false) ||
+            !upload_decoder_matrix(prefix + "layer.0.SelfAttention.q.weight", *wq, model->dtype,
+                                &layer.selfAttn.wq, &layer.selfAttn.wq16, &layer.selfAttn.wqbf, layer.selfAttn.wq8) ||
+            !upload_decoder_matrix(prefix + "layer.0.SelfAttention.k.weight", *wk, model->dtype,
+                                &layer.selfAttn.wk, &layer.selfAttn.wk16, &layer.selfAttn.wkbf, layer.selfAttn.wk8) ||
+            !upload_decoder_matrix(prefix + "layer.0.SelfAttention.v.weight", *wv, model->dtype,
+                                &layer.selfAttn.wv, &layer.selfAttn.wv16, &layer.selfAttn.wvbf, layer.selfAttn.wv8) ||
+            !upload_decoder_matrix(prefix + "layer.0.SelfAttention.o.weight", *wo, model->dtype,
+                                &layer.selfAttn.wo, &layer.selfAttn.wo16, &layer.selfAttn.wobf, layer.selfAttn.wo8) ||
             !upload_tensor_auto(prefix + "layer.1.layer_norm.weight", *ln2, DType::F32,
                                 &layer.ln2, nullptr, nullptr, true) ||
-            !upload_tensor_auto(prefix + "layer.1.EncDecAttention.q.weight", *wq2, gpu->dtype,
-                                &layer.crossAttn.wq, &layer.crossAttn.wq16, &layer.crossAttn.wqbf, false) ||
-            !upload_tensor_auto(prefix + "layer.1.EncDecAttention.k.weight", *wk2, gpu->dtype,
-                                &layer.crossAttn.wk, &layer.crossAttn.wk16, &layer.crossAttn.wkbf, false) ||
-            !upload_tensor_auto(prefix + "layer.1.EncDecAttention.v.weight", *wv2, gpu->dtype,
-                                &layer.crossAttn.wv, &layer.crossAttn.wv16, &layer.crossAttn.wvbf, false) ||
-            !upload_tensor_auto(prefix + "layer.1.EncDecAttention.o.weight", *wo2, gpu->dtype,
-                                &layer.crossAttn.wo, &layer.crossAttn.wo16, &layer.crossAttn.wobf, false) ||
+            !upload_decoder_matrix(prefix + "layer.1.EncDecAttention.q.weight", *wq2, model->dtype,
+                                &layer.crossAttn.wq, &layer.crossAttn.wq16, &layer.crossAttn.wqbf, layer.crossAttn.wq8) ||
+            !upload_decoder_matrix(prefix + "layer.1.EncDecAttention.k.weight", *wk2, model->dtype,
+                                &layer.crossAttn.wk, &layer.crossAttn.wk16, &layer.crossAttn.wkbf, layer.crossAttn.wk8) ||
+            !upload_decoder_matrix(prefix + "layer.1.EncDecAttention.v.weight", *wv2, model->dtype,
+                                &layer.crossAttn.wv, &layer.crossAttn.wv16, &layer.crossAttn.wvbf, layer.crossAttn.wv8) ||
+            !upload_decoder_matrix(prefix + "layer.1.EncDecAttention.o.weight", *wo2, model->dtype,
+                                &layer.crossAttn.wo, &layer.crossAttn.wo16, &layer.crossAttn.wobf, layer.crossAttn.wo8) ||
             !upload_tensor_auto(prefix + "layer.2.layer_norm.weight", *ln3, DType::F32,
                                 &layer.ln3, nullptr, nullptr, true) ||
-            !upload_tensor_auto(prefix + "layer.2.DenseReluDense.wi_0.weight", *wi0, gpu->dtype,
-                                &layer.ffn.wi0, &layer.ffn.wi016, &layer.ffn.wi0bf, false) ||
-            !upload_tensor_auto(prefix + "layer.2.DenseReluDense.wi_1.weight", *wi1, gpu->dtype,
-                                &layer.ffn.wi1, &layer.ffn.wi116, &layer.ffn.wi1bf, false) ||
-            !upload_tensor_auto(prefix + "layer.2.DenseReluDense.wo.weight", *wo3, gpu->dtype,
-                                &layer.ffn.wo, &layer.ffn.wo16, &layer.ffn.wobf, false)) {
-            destroy_gpu(gpu);
+            !upload_decoder_matrix(prefix + "layer.2.DenseReluDense.wi_0.weight", *wi0, model->dtype,
+                                &layer.ffn.wi0, &layer.ffn.wi016, &layer.ffn.wi0bf, layer.ffn.wi08) ||
+            !upload_decoder_matrix(prefix + "layer.2.DenseReluDense.wi_1.weight", *wi1, model->dtype,
+                                &layer.ffn.wi1, &layer.ffn.wi116, &layer.ffn.wi1bf, layer.ffn.wi18) ||
+            !upload_decoder_matrix(prefix + "layer.2.DenseReluDense.wo.weight", *wo3, model->dtype,
+                                &layer.ffn.wo, &layer.ffn.wo16, &layer.ffn.wobf, layer.ffn.wo8)) {
+            release_model(model);
             return false;
         }
-        gpu->decoder[static_cast<size_t>(i)] = layer;
+        model->decoder[static_cast<size_t>(i)] = layer;
     }
 
-    out = gpu;
+    out = model;
     return true;
 }
 
-static bool run_encoder(T5Gpu* gpu, const std::vector<int>& ids, EncoderState& enc) {
-    int seq = static_cast<int>(ids.size());
-    int dModel = gpu->cfg.dModel;
-    int dAttn = gpu->cfg.numHeads * gpu->cfg.dKv;
-    int dFf = gpu->cfg.dFf;
-
-    if (!gpu->ws.x.ensure(static_cast<size_t>(seq) * dModel)) return false;
-    if (!gpu->ws.norm.ensure(static_cast<size_t>(seq) * dModel)) return false;
-    if (!gpu->ws.q.ensure(static_cast<size_t>(seq) * dAttn)) return false;
-    if (!gpu->ws.k.ensure(static_cast<size_t>(seq) * dAttn)) return false;
-    if (!gpu->ws.v.ensure(static_cast<size_t>(seq) * dAttn)) return false;
-    if (!gpu->ws.attn.ensure(static_cast<size_t>(gpu->cfg.numHeads) * seq * seq)) return false;
-    if (!gpu->ws.out.ensure(static_cast<size_t>(seq) * dAttn)) return false;
-    if (!gpu->ws.ff0.ensure(static_cast<size_t>(seq) * dFf)) return false;
-    if (!gpu->ws.ff1.ensure(static_cast<size_t>(seq) * dFf)) return false;
-    if (!gpu->ws.tmp.ensure(static_cast<size_t>(seq) * dModel)) return false;
-
-    if (!run_embed(gpu->cfg, gpu->ws, ids, gpu->d_shared, gpu->ws.x.ptr)) return false;
-
-    for (int layer = 0; layer < gpu->cfg.numLayers; layer++) {
-        EncoderLayer& l = gpu->encoder[static_cast<size_t>(layer)];
-        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln1, seq, dModel, gpu->cfg.layerNormEps)) return false;
-        if (!gemm_row_major(gpu, seq, dAttn, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.attn.wq, gpu->dtype),
-                            pick_h(l.attn.wq16, gpu->dtype),
-                            pick_b(l.attn.wqbf, gpu->dtype),
+// Encodes `batch` sequences padded to `seq` ids each (ids is [batch * seq],
+// lens the unpadded lengths) and leaves the final hidden states in ws.x.
+// Padded keys are masked, so every valid row matches an unpadded run.
+static bool run_encoder_batch(T5Gpu* gpu, const std::vector<int>& ids, const std::vector<int>& lens, int batch, int seq) {
+    const T5Model& model = *gpu->model;
+    int rows = batch * seq;
+    int dModel = model.cfg.dModel;
+    int dAttn = model.cfg.numHeads * model.cfg.dKv;
+    int dFf = model.cfg.dFf;
+
+    if (!gpu->ws.x.ensure(static_cast<size_t>(rows) * dModel)) return false;
+    if (!gpu->ws.norm.ensure(static_cast<size_t>(rows) * dModel)) return false;
+    if (!gpu->ws.q.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (!gpu->ws.k.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (!gpu->ws.v.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (model.cfg.dKv > FLASH_MAX_DEPTH &&
+        !gpu->ws.attn.ensure(static_cast<size_t>(model.cfg.numHeads) * batch * seq * seq)) return false;
+    if (!gpu->ws.out.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (!gpu->ws.ff0.ensure(static_cast<size_t>(rows) * dFf)) return false;
+    if (!gpu->ws.ff1.ensure(static_cast<size_t>(rows) * dFf)) return false;
+    if (!gpu->ws.tmp.ensure(static_cast<size_t>(rows) * dModel)) return false;
+    if (!gpu->ws.lens.ensure(static_cast<size_t>(batch))) return false;
+    if (!timed_copy(gpu, T5_STAGE_UPLOAD, gpu->ws.lens.ptr, lens.data(), sizeof(int) * batch, cudaMemcpyHostToDevice)) return false;
+
+    if (!run_embed(model.cfg, gpu->ws, ids, model.d_shared, gpu->ws.x.ptr)) return false;
+
+    for (int layer = 0; layer < model.cfg.numLayers; layer++) {
+        const EncoderLayer& l = model.encoder[static_cast<size_t>(layer)];
+        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln1, rows, dModel, model.cfg.layerNormEps)) return false;
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.attn.wq, model.dtype),
+                            pick_h(l.attn.wq16, model.dtype),
+                            pick_b(l.attn.wqbf, model.dtype),
                             gpu->ws.q.ptr)) return false;
-        if (!gemm_row_major(gpu, seq, dAttn, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.attn.wk, gpu->dtype),
-                            pick_h(l.attn.wk16, gpu->dtype),
-                            pick_b(l.attn.wkbf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.attn.wk, model.dtype),
+                            pick_h(l.attn.wk16, model.dtype),
+                            pick_b(l.attn.wkbf, model.dtype),
                             gpu->ws.k.ptr)) return false;
-        if (!gemm_row_major(gpu, seq, dAttn, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.attn.wv, gpu->dtype),
-                            pick_h(l.attn.wv16, gpu->dtype),
-                            pick_b(l.attn.wvbf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.attn.wv, model.dtype),
+                            pick_h(l.attn.wv16, model.dtype),
+                            pick_b(l.attn.wvbf, model.dtype),
                             gpu->ws.v.ptr)) return false;
-        if (!run_attention(gpu->cfg, gpu->ws.q.ptr, gpu->ws.k.ptr, gpu->ws.v.ptr, gpu->ws.attn.ptr, gpu->ws.out.ptr,
-                           seq, seq, false, gpu->d_encoderRelBias, true)) return false;
-        if (!gemm_row_major(gpu, seq, dModel, dAttn, gpu->ws.out.ptr,
-                            pick_f(l.attn.wo, gpu->dtype),
-                            pick_h(l.attn.wo16, gpu->dtype),
-                            pick_b(l.attn.wobf, gpu->dtype),
+        if (!run_attention(model.cfg, gpu->ws.q.ptr, gpu->ws.k.ptr, gpu->ws.v.ptr, gpu->ws.attn.ptr, gpu->ws.out.ptr,
+                           batch, gpu->ws.lens.ptr, seq, seq, false, model.d_encoderRelBias, true)) return false;
+        if (!gemm_row_major(gpu, rows, dModel, dAttn, gpu->ws.out.ptr,
+                            pick_f(l.attn.wo, model.dtype),
+                            pick_h(l.attn.wo16, model.dtype),
+                            pick_b(l.attn.wobf, model.dtype),
                             gpu->ws.tmp.ptr)) return false;
-        int total = seq * dModel;
+        int total = rows * dModel;
         int threads = 256;
         int blocks = (total + threads - 1) / threads;
         add_in_place_kernel<<<blocks, threads>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, total);
         if (!cuda_ok(cudaGetLastError())) return false;
 
-        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln2, seq, dModel, gpu->cfg.layerNormEps)) return false;
-        if (!gemm_row_major(gpu, seq, dFf, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.ffn.wi0, gpu->dtype),
-                            pick_h(l.ffn.wi016, gpu->dtype),
-                            pick_b(l.ffn.wi0bf, gpu->dtype),
+        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln2, rows, dModel, model.cfg.layerNormEps)) return false;
+        if (!gemm_row_major(gpu, rows, dFf, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.ffn.wi0, model.dtype),
+                            pick_h(l.ffn.wi016, model.dtype),
+                            pick_b(l.ffn.wi0bf, model.dtype),
                             gpu->ws.ff0.ptr)) return false;
-        if (!gemm_row_major(gpu, seq, dFf, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.ffn.wi1, gpu->dtype),
-                            pick_h(l.ffn.wi116, gpu->dtype),
-                            pick_b(l.ffn.wi1bf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dFf, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.ffn.wi1, model.dtype),
+                            pick_h(l.ffn.wi116, model.dtype),
+                            pick_b(l.ffn.wi1bf, model.dtype),
                             gpu->ws.ff1.ptr)) return false;
-        int ffTotal = seq * dFf;
+        int ffTotal = rows * dFf;
         int ffBlocks = (ffTotal + threads - 1) / threads;
         gelu_mul_kernel<<<ffBlocks, threads>>>(gpu->ws.ff0.ptr, gpu->ws.ff1.ptr, ffTotal);
         if (!cuda_ok(cudaGetLastError())) return false;
-        if (!gemm_row_major(gpu, seq, dModel, dFf, gpu->ws.ff0.ptr,
-                            pick_f(l.ffn.wo, gpu->dtype),
-                            pick_h(l.ffn.wo16, gpu->dtype),
-                            pick_b(l.ffn.wobf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dModel, dFf, gpu->ws.ff0.ptr,
+                            pick_f(l.ffn.wo, model.dtype),
+                            pick_h(l.ffn.wo16, model.dtype),
+                            pick_b(l.ffn.wobf, model.dtype),
                             gpu->ws.tmp.ptr)) return false;
         add_in_place_kernel<<<blocks, threads>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, total);
         if (!cuda_ok(cudaGetLastError())) return false;
     }
 
-    if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.x.ptr, gpu->d_encoderFinalLn, seq, dModel, gpu->cfg.layerNormEps)) return false;
-
-    enc.seq = seq;
-    if (!cuda_alloc(&enc.hidden, static_cast<size_t>(seq) * dModel)) return false;
-    if (!cuda_ok(cudaMemcpy(enc.hidden, gpu->ws.x.ptr, sizeof(float) * seq * dModel, cudaMemcpyDeviceToDevice))) return false;
-    return true;
+    return run_layer_norm(gpu->ws.x.ptr, gpu->ws.x.ptr, model.d_encoderFinalLn, rows, dModel, model.cfg.layerNormEps);
 }
 
-static bool precompute_encoder_kv(T5Gpu* gpu, const EncoderState& enc,
-                                  std::vector<float*>& outK,
-                                  std::vector<float*>& outV) {
-    int encSeq = enc.seq;
-    int dAttn = gpu->cfg.numHeads * gpu->cfg.dKv;
-    int dModel = gpu->cfg.dModel;
-    outK.resize(static_cast<size_t>(gpu->cfg.numDecoderLayers));
-    outV.resize(static_cast<size_t>(gpu->cfg.numDecoderLayers));
-    for (int layer = 0; layer < gpu->cfg.numDecoderLayers; layer++) {
-        DecoderLayer& l = gpu->decoder[static_cast<size_t>(layer)];
-        float* d_k = nullptr;
-        float* d_v = nullptr;
-        if (!cuda_alloc(&d_k, static_cast<size_t>(encSeq) * dAttn)) return false;
-        if (!cuda_alloc(&d_v, static_cast<size_t>(encSeq) * dAttn)) {
-            cuda_free(d_k);
-            return false;
-        }
-        if (!gemm_row_major(gpu, encSeq, dAttn, dModel, enc.hidden,
-                            pick_f(l.crossAttn.wk, gpu->dtype),
-                            pick_h(l.crossAttn.wk16, gpu->dtype),
-                            pick_b(l.crossAttn.wkbf, gpu->dtype),
-                            d_k)) {
-            cuda_free(d_k);
-            cuda_free(d_v);
-            return false;
-        }
-        if (!gemm_row_major(gpu, encSeq, dAttn, dModel, enc.hidden,
-                            pick_f(l.crossAttn.wv, gpu->dtype),
-                            pick_h(l.crossAttn.wv16, gpu->dtype),
-                            pick_b(l.crossAttn.wvbf, gpu->dtype),
-                            d_v)) {
-            cuda_free(d_k);
-            cuda_free(d_v);
-            return false;
-        }
-        outK[static_cast<size_t>(layer)] = d_k;
-        outV[static_cast<size_t>(layer)] = d_v;
-    }
-    return true;
+// Live sequences decoded together per step (CRTK_T5_CUDA_BATCH, default 32).
+static int batch_slots() {
+    const char* env = std::getenv("CRTK_T5_CUDA_BATCH");
+    int value = env ? std::atoi(env) : 0;
+    return value > 0 ? value : 32;
 }
 
-static void free_encoder_kv(std::vector<float*>& kv) {
-    for (float* p : kv) {
-        cuda_free(p);
+// Sizes the arena for `slots` concurrent sequences of up to `encCap` encoder
+// ids and `maxNewTokens` decoder positions. Buffers only grow, so a batch job
+// allocates once per model; the page free list restarts on every call.
+static bool ensure_kv_arena(T5Gpu* gpu, int slots, int encCap, int maxNewTokens) {
+    const T5Model& model = *gpu->model;
+    KvArena& kv = gpu->kv;
+    size_t layers = static_cast<size_t>(model.cfg.numDecoderLayers);
+    size_t dAttn = static_cast<size_t>(model.cfg.numHeads) * model.cfg.dKv;
+    kv.slots = slots;
+    kv.encCap = encCap;
+    kv.pagesPerSeq = (maxNewTokens + KV_PAGE_TOKENS - 1) / KV_PAGE_TOKENS;
+    kv.pages = slots * kv.pagesPerSeq;
+    size_t selfCount = layers * kv.pages * KV_PAGE_TOKENS * dAttn;
+    size_t crossCount = layers * slots * encCap * dAttn;
+    if (!kv.k.ensure(selfCount) || !kv.v.ensure(selfCount)) return false;
+    if (!kv.crossK.ensure(crossCount) || !kv.crossV.ensure(crossCount)) return false;
+    kv.freePages.clear();
+    for (int page = kv.pages - 1; page >= 0; page--) {
+        kv.freePages.push_back(page);
     }
-    kv.clear();
+    return true;
 }
 
-static void free_decoder_cache(std::vector<DecoderCache>& cache);
+struct BatchSlot {
+    int seq = -1; // request index, -1 while the slot is free
+    int encLen = 0;
+    std::vector<int> pages;
+};
 
-static bool alloc_decoder_cache(const T5Config& cfg, int maxLen, std::vector<DecoderCache>& out) {
-    if (maxLen <= 0) return false;
-    int dAttn = cfg.numHeads * cfg.dKv;
-    out.resize(static_cast<size_t>(cfg.numDecoderLayers));
-    for (int layer = 0; layer < cfg.numDecoderLayers; layer++) {
-        DecoderCache cache;
-        cache.capacity = maxLen;
-        size_t count = static_cast<size_t>(maxLen) * dAttn;
-        if (!cuda_alloc(&cache.k, count)) {
-            free_decoder_cache(out);
-            return false;
-        }
-        if (!cuda_alloc(&cache.v, count)) {
-            cuda_free(cache.k);
-            free_decoder_cache(out);
-            return false;
+// Encodes the queued requests `seqs` in one padded pass and copies their
+// cross-attention K/V into the arena blocks of `slotIds`.
+static bool admit_batch(T5Gpu* gpu, const std::vector<std::vector<int>>& inputs,
+                        const std::vector<int>& seqs, const std::vector<int>& slotIds) {
+    const T5Model& model = *gpu->model;
+    int batch = static_cast<int>(seqs.size());
+    int seq = 0;
+    for (int s : seqs) {
+        seq = std::max(seq, static_cast<int>(inputs[static_cast<size_t>(s)].size()));
+    }
+    std::vector<int> ids(static_cast<size_t>(batch) * seq, model.cfg.padId);
+    std::vector<int> lens(static_cast<size_t>(batch));
+    for (int b = 0; b < batch; b++) {
+        const std::vector<int>& in = inputs[static_cast<size_t>(seqs[b])];
+        std::copy(in.begin(), in.end(), ids.begin() + static_cast<size_t>(b) * seq);
+        lens[static_cast<size_t>(b)] = static_cast<int>(in.size());
+    }
+    gpu->stats.begin(T5_STAGE_ENCODER, nullptr);
+    if (!run_encoder_batch(gpu, ids, lens, batch, seq)) return false;
+    gpu->stats.end(T5_STAGE_ENCODER, nullptr);
+
+    KvArena& kv = gpu->kv;
+    int rows = batch * seq;
+    int dAttn = model.cfg.numHeads * model.cfg.dKv;
+    int dModel = model.cfg.dModel;
+    gpu->stats.begin(T5_STAGE_CROSS_KV, nullptr);
+    for (int layer = 0; layer < model.cfg.numDecoderLayers; layer++) {
+        const DecoderLayer& l = model.decoder[static_cast<size_t>(layer)];
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.x.ptr,
+                            pick_f(l.crossAttn.wk, model.dtype),
+                            pick_h(l.crossAttn.wk16, model.dtype),
+                            pick_b(l.crossAttn.wkbf, model.dtype),
+                            l.crossAttn.wk8,
+                            gpu->ws.k.ptr)) return false;
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.x.ptr,
+                            pick_f(l.crossAttn.wv, model.dtype),
+                            pick_h(l.crossAttn.wv16, model.dtype),
+                            pick_b(l.crossAttn.wvbf, model.dtype),
+                            l.crossAttn.wv8,
+                            gpu->ws.v.ptr)) return false;
+        for (int b = 0; b < batch; b++) {
+            size_t dst = (static_cast<size_t>(layer) * kv.slots + slotIds[static_cast<size_t>(b)]) * kv.encCap * dAttn;
+            size_t src = static_cast<size_t>(b) * seq * dAttn;
+            size_t bytes = sizeof(float) * lens[static_cast<size_t>(b)] * dAttn;
+            if (!cuda_ok(cudaMemcpy(kv.crossK.ptr + dst, gpu->ws.k.ptr + src, bytes, cudaMemcpyDeviceToDevice))) return false;
+            if (!cuda_ok(cudaMemcpy(kv.crossV.ptr + dst, gpu->ws.v.ptr + src, bytes, cudaMemcpyDeviceToDevice))) return false;
         }
-        out[static_cast<size_t>(layer)] = cache;
     }
+    gpu->stats.end(T5_STAGE_CROSS_KV, nullptr);
     return true;
 }
 
-static void free_decoder_cache(std::vector<DecoderCache>& cache) {
-    for (auto& c : cache) {
-        cuda_free(c.k);
-        cuda_free(c.v);
-        c.k = nullptr;
-        c.v = nullptr;
-        c.capacity = 0;
-    }
-    cache.clear();
-}
-
-static bool run_decoder_step_cached(T5Gpu* gpu,
-                                    const std::vector<int>& outIds,
-                                    const EncoderState& enc,
-                                    const std::vector<float*>& encK,
-                                    const std::vector<float*>& encV,
-                                    std::vector<DecoderCache>& cache,
-                                    int& nextId) {
-    int seq = static_cast<int>(outIds.size());
-    int pos = seq - 1;
-    int dModel = gpu->cfg.dModel;
-    int dAttn = gpu->cfg.numHeads * gpu->cfg.dKv;
-    int dFf = gpu->cfg.dFf;
-    int encSeq = enc.seq;
-
-    if (!gpu->ws.x.ensure(dModel)) return false;
-    if (!gpu->ws.norm.ensure(dModel)) return false;
-    if (!gpu->ws.q.ensure(dAttn)) return false;
-    if (!gpu->ws.k.ensure(dAttn)) return false;
-    if (!gpu->ws.v.ensure(dAttn)) return false;
-    if (!gpu->ws.attn.ensure(static_cast<size_t>(gpu->cfg.numHeads) * std::max(seq, encSeq))) return false;
-    if (!gpu->ws.out.ensure(dAttn)) return false;
-    if (!gpu->ws.ff0.ensure(dFf)) return false;
-    if (!gpu->ws.ff1.ensure(dFf)) return false;
-    if (!gpu->ws.tmp.ensure(dModel)) return false;
-
-    std::vector<int> lastId(1, outIds.back());
-    if (!run_embed(gpu->cfg, gpu->ws, lastId, gpu->d_shared, gpu->ws.x.ptr)) return false;
-
-    for (int layer = 0; layer < gpu->cfg.numDecoderLayers; layer++) {
-        DecoderLayer& l = gpu->decoder[static_cast<size_t>(layer)];
-        DecoderCache& c = cache[static_cast<size_t>(layer)];
-        if (pos >= c.capacity) return false;
-
-        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln1, 1, dModel, gpu->cfg.layerNormEps)) return false;
-        if (!gemm_row_major(gpu, 1, dAttn, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.selfAttn.wq, gpu->dtype),
-                            pick_h(l.selfAttn.wq16, gpu->dtype),
-                            pick_b(l.selfAttn.wqbf, gpu->dtype),
+// Where decode_rows finds each row's keys and values. Self-attention K/V are
+// per-layer pools of selfStride floats addressed through pageTable; cross
+// K/V are per-layer blocks of crossStride floats with slotStride rows for
+// each slot, selected by crossSlot (rowSlot for the batch path, 0 for every
+// beam of one search).
+struct RowKv {
+    const int* rowSlot = nullptr;
+    const int* crossSlot = nullptr;
+    const int* rowPos = nullptr;
+    const int* encLen = nullptr;
+    const int* pageTable = nullptr;
+    int pagesPerSeq = 0;
+    float* selfK = nullptr;
+    float* selfV = nullptr;
+    size_t selfStride = 0;
+    const float* crossK = nullptr;
+    const float* crossV = nullptr;
+    size_t crossStride = 0;
+    int slotStride = 0;
+    int attnStride = 0;
+};
+
+static bool ensure_decode_workspace(T5Gpu* gpu, int rows, int attnStride) {
+    const T5Model& model = *gpu->model;
+    int heads = model.cfg.numHeads;
+    int dModel = model.cfg.dModel;
+    int dAttn = heads * model.cfg.dKv;
+    int dFf = model.cfg.dFf;
+    if (!gpu->ws.x.ensure(static_cast<size_t>(rows) * dModel)) return false;
+    if (!gpu->ws.norm.ensure(static_cast<size_t>(rows) * dModel)) return false;
+    if (!gpu->ws.q.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (!gpu->ws.k.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (!gpu->ws.v.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (!gpu->ws.attn.ensure(static_cast<size_t>(rows) * heads * attnStride)) return false;
+    if (!gpu->ws.out.ensure(static_cast<size_t>(rows) * dAttn)) return false;
+    if (!gpu->ws.ff0.ensure(static_cast<size_t>(rows) * dFf)) return false;
+    if (!gpu->ws.ff1.ensure(static_cast<size_t>(rows) * dFf)) return false;
+    if (!gpu->ws.tmp.ensure(static_cast<size_t>(rows) * dModel)) return false;
+    if (!gpu->ws.logits.ensure(static_cast<size_t>(rows) * model.cfg.vocabSize)) return false;
+    return gpu->ws.reduceIdx.ensure(static_cast<size_t>(rows));
+}
+
+// Runs the decoder stack for `rows` embedded tokens in ws.x (one position per
+// row, appending each row's K/V) and leaves [rows x vocab] logits in ws.logits.
+// The workspace must be sized by ensure_decode_workspace.
+static bool decode_rows(T5Gpu* gpu, int rows, const RowKv& kv) {
+    const T5Model& model = *gpu->model;
+    int heads = model.cfg.numHeads;
+    int dModel = model.cfg.dModel;
+    int dAttn = heads * model.cfg.dKv;
+    int dFf = model.cfg.dFf;
+    int vocab = model.cfg.vocabSize;
+    int total = rows * dModel;
+    int blocks = (total + 255) / 256;
+    dim3 attnGrid(heads, rows);
+    for (int layer = 0; layer < model.cfg.numDecoderLayers; layer++) {
+        const DecoderLayer& l = model.decoder[static_cast<size_t>(layer)];
+        float* kPool = kv.selfK + layer * kv.selfStride;
+        float* vPool = kv.selfV + layer * kv.selfStride;
+
+        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln1, rows, dModel, model.cfg.layerNormEps)) return false;
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.selfAttn.wq, model.dtype),
+                            pick_h(l.selfAttn.wq16, model.dtype),
+                            pick_b(l.selfAttn.wqbf, model.dtype),
+                            l.selfAttn.wq8,
                             gpu->ws.q.ptr)) return false;
-        if (!gemm_row_major(gpu, 1, dAttn, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.selfAttn.wk, gpu->dtype),
-                            pick_h(l.selfAttn.wk16, gpu->dtype),
-                            pick_b(l.selfAttn.wkbf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.selfAttn.wk, model.dtype),
+                            pick_h(l.selfAttn.wk16, model.dtype),
+                            pick_b(l.selfAttn.wkbf, model.dtype),
+                            l.selfAttn.wk8,
                             gpu->ws.k.ptr)) return false;
-        if (!gemm_row_major(gpu, 1, dAttn, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.selfAttn.wv, gpu->dtype),
-                            pick_h(l.selfAttn.wv16, gpu->dtype),
-                            pick_b(l.selfAttn.wvbf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.selfAttn.wv, model.dtype),
+                            pick_h(l.selfAttn.wv16, model.dtype),
+                            pick_b(l.selfAttn.wvbf, model.dtype),
+                            l.selfAttn.wv8,
                             gpu->ws.v.ptr)) return false;
-
-        float* kDst = c.k + static_cast<size_t>(pos) * dAttn;
-        float* vDst = c.v + static_cast<size_t>(pos) * dAttn;
-        if (!cuda_ok(cudaMemcpy(kDst, gpu->ws.k.ptr, sizeof(float) * dAttn, cudaMemcpyDeviceToDevice))) return false;
-        if (!cuda_ok(cudaMemcpy(vDst, gpu->ws.v.ptr, sizeof(float) * dAttn, cudaMemcpyDeviceToDevice))) return false;
-
-        if (!run_attention_single(gpu->cfg, gpu->ws.q.ptr, c.k, c.v, gpu->ws.attn.ptr, gpu->ws.out.ptr,
-                                  seq, gpu->d_decoderRelBias, false, pos)) return false;
-        if (!gemm_row_major(gpu, 1, dModel, dAttn, gpu->ws.out.ptr,
-                            pick_f(l.selfAttn.wo, gpu->dtype),
-                            pick_h(l.selfAttn.wo16, gpu->dtype),
-                            pick_b(l.selfAttn.wobf, gpu->dtype),
+        kv_append_kernel<<<(rows * dAttn + 255) / 256, 256>>>(gpu->ws.k.ptr, gpu->ws.v.ptr, kPool, vPool,
+                                                             kv.rowSlot, kv.rowPos, kv.pageTable, kv.pagesPerSeq, rows, dAttn);
+        if (!cuda_ok(cudaGetLastError())) return false;
+        attn_rows_kernel<<<attnGrid, 256>>>(gpu->ws.q.ptr, kPool, vPool, gpu->ws.attn.ptr, gpu->ws.out.ptr,
+                                            kv.rowSlot, kv.rowPos, kv.encLen, kv.pageTable, kv.pagesPerSeq, 0, kv.attnStride,
+                                            heads, model.cfg.dKv, dAttn,
+                                            model.d_decoderRelBias, model.cfg.relBuckets, model.cfg.relMaxDistance);
+        if (!cuda_ok(cudaGetLastError())) return false;
+        if (!gemm_row_major(gpu, rows, dModel, dAttn, gpu->ws.out.ptr,
+                            pick_f(l.selfAttn.wo, model.dtype),
+                            pick_h(l.selfAttn.wo16, model.dtype),
+                            pick_b(l.selfAttn.wobf, model.dtype),
+                            l.selfAttn.wo8,
                             gpu->ws.tmp.ptr)) return false;
-        add_in_place_kernel<<<(dModel + 255) / 256, 256>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, dModel);
+        add_in_place_kernel<<<blocks, 256>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, total);
         if (!cuda_ok(cudaGetLastError())) return false;
 
-        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln2, 1, dModel, gpu->cfg.layerNormEps)) return false;
-        if (!gemm_row_major(gpu, 1, dAttn, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.crossAttn.wq, gpu->dtype),
-                            pick_h(l.crossAttn.wq16, gpu->dtype),
-                            pick_b(l.crossAttn.wqbf, gpu->dtype),
+        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln2, rows, dModel, model.cfg.layerNormEps)) return false;
+        if (!gemm_row_major(gpu, rows, dAttn, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.crossAttn.wq, model.dtype),
+                            pick_h(l.crossAttn.wq16, model.dtype),
+                            pick_b(l.crossAttn.wqbf, model.dtype),
+                            l.crossAttn.wq8,
                             gpu->ws.q.ptr)) return false;
-        if (!run_attention_single(gpu->cfg, gpu->ws.q.ptr, encK[static_cast<size_t>(layer)], encV[static_cast<size_t>(layer)],
-                                  gpu->ws.attn.ptr, gpu->ws.out.ptr, encSeq, nullptr, true, 0)) return false;
-        if (!gemm_row_major(gpu, 1, dModel, dAttn, gpu->ws.out.ptr,
-                            pick_f(l.crossAttn.wo, gpu->dtype),
-                            pick_h(l.crossAttn.wo16, gpu->dtype),
-                            pick_b(l.crossAttn.wobf, gpu->dtype),
+        attn_rows_kernel<<<attnGrid, 256>>>(gpu->ws.q.ptr, kv.crossK + layer * kv.crossStride,
+                                            kv.crossV + layer * kv.crossStride, gpu->ws.attn.ptr, gpu->ws.out.ptr,
+                                            kv.crossSlot, kv.rowPos, kv.encLen, nullptr, 0, kv.slotStride, kv.attnStride,
+                                            heads, model.cfg.dKv, dAttn, nullptr, 0, 0);
+        if (!cuda_ok(cudaGetLastError())) return false;
+        if (!gemm_row_major(gpu, rows, dModel, dAttn, gpu->ws.out.ptr,
+                            pick_f(l.crossAttn.wo, model.dtype),
+                            pick_h(l.crossAttn.wo16, model.dtype),
+                            pick_b(l.crossAttn.wobf, model.dtype),
+                            l.crossAttn.wo8,
                             gpu->ws.tmp.ptr)) return false;
-        add_in_place_kernel<<<(dModel + 255) / 256, 256>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, dModel);
+        add_in_place_kernel<<<blocks, 256>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, total);
         if (!cuda_ok(cudaGetLastError())) return false;
 
-        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln3, 1, dModel, gpu->cfg.layerNormEps)) return false;
-        if (!gemm_row_major(gpu, 1, dFf, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.ffn.wi0, gpu->dtype),
-                            pick_h(l.ffn.wi016, gpu->dtype),
-                            pick_b(l.ffn.wi0bf, gpu->dtype),
+        if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.norm.ptr, l.ln3, rows, dModel, model.cfg.layerNormEps)) return false;
+        if (!gemm_row_major(gpu, rows, dFf, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.ffn.wi0, model.dtype),
+                            pick_h(l.ffn.wi016, model.dtype),
+                            pick_b(l.ffn.wi0bf, model.dtype),
+                            l.ffn.wi08,
                             gpu->ws.ff0.ptr)) return false;
-        if (!gemm_row_major(gpu, 1, dFf, dModel, gpu->ws.norm.ptr,
-                            pick_f(l.ffn.wi1, gpu->dtype),
-                            pick_h(l.ffn.wi116, gpu->dtype),
-                            pick_b(l.ffn.wi1bf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dFf, dModel, gpu->ws.norm.ptr,
+                            pick_f(l.ffn.wi1, model.dtype),
+                            pick_h(l.ffn.wi116, model.dtype),
+                            pick_b(l.ffn.wi1bf, model.dtype),
+                            l.ffn.wi18,
                             gpu->ws.ff1.ptr)) return false;
-        int ffBlocks = (dFf + 255) / 256;
-        gelu_mul_kernel<<<ffBlocks, 256>>>(gpu->ws.ff0.ptr, gpu->ws.ff1.ptr, dFf);
+        int ffTotal = rows * dFf;
+        gelu_mul_kernel<<<(ffTotal + 255) / 256, 256>>>(gpu->ws.ff0.ptr, gpu->ws.ff1.ptr, ffTotal);
         if (!cuda_ok(cudaGetLastError())) return false;
-        if (!gemm_row_major(gpu, 1, dModel, dFf, gpu->ws.ff0.ptr,
-                            pick_f(l.ffn.wo, gpu->dtype),
-                            pick_h(l.ffn.wo16, gpu->dtype),
-                            pick_b(l.ffn.wobf, gpu->dtype),
+        if (!gemm_row_major(gpu, rows, dModel, dFf, gpu->ws.ff0.ptr,
+                            pick_f(l.ffn.wo, model.dtype),
+                            pick_h(l.ffn.wo16, model.dtype),
+                            pick_b(l.ffn.wobf, model.dtype),
+                            l.ffn.wo8,
                             gpu->ws.tmp.ptr)) return false;
-        add_in_place_kernel<<<(dModel + 255) / 256, 256>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, dModel);
+        add_in_place_kernel<<<blocks, 256>>>(gpu->ws.x.ptr, gpu->ws.tmp.ptr, total);
         if (!cuda_ok(cudaGetLastError())) return false;
     }
 
-    if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.x.ptr, gpu->d_decoderFinalLn, 1, dModel, gpu->cfg.layerNormEps)) return false;
-
-    if (!gpu->ws.logits.ensure(gpu->cfg.vocabSize)) return false;
-    if (!gemm_row_major(gpu, 1, gpu->cfg.vocabSize, dModel, gpu->ws.x.ptr,
-                        pick_f(gpu->d_lmHead, gpu->dtype),
-                        pick_h(gpu->d_lmHead16, gpu->dtype),
-                        pick_b(gpu->d_lmHeadBf, gpu->dtype),
+    if (!run_layer_norm(gpu->ws.x.ptr, gpu->ws.x.ptr, model.d_decoderFinalLn, rows, dModel, model.cfg.layerNormEps)) return false;
+    if (!gemm_row_major(gpu, rows, vocab, dModel, gpu->ws.x.ptr,
+                        pick_f(model.d_lmHead, model.dtype),
+                        pick_h(model.d_lmHead16, model.dtype),
+                        pick_b(model.d_lmHeadBf, model.dtype),
+                        model.d_lmHead8,
                         gpu->ws.logits.ptr)) return false;
+    return true;
+}
 
-    if (!argmax_device(gpu->ws, gpu->ws.logits.ptr, gpu->cfg.vocabSize, nextId)) return false;
+// One greedy step for every live row. ids holds each row's last token and
+// meta is [rowSlot | rowPos | encLen per slot | page table per slot].
+static bool run_decoder_step_batch(T5Gpu* gpu,
+                                   const std::vector<int>& ids,
+                                   const std::vector<int>& meta,
+                                   int maxPos,
+                                   std::vector<int>& nextIds) {
+    const T5Model& model = *gpu->model;
+    KvArena& kv = gpu->kv;
+    int rows = static_cast<int>(ids.size());
+    int dAttn = model.cfg.numHeads * model.cfg.dKv;
+    RowKv rk;
+    rk.attnStride = std::max(maxPos + 1, kv.encCap);
+    if (!ensure_decode_workspace(gpu, rows, rk.attnStride)) return false;
+    if (!kv.meta.ensure(meta.size())) return false;
+    if (!timed_copy(gpu, T5_STAGE_UPLOAD, kv.meta.ptr, meta.data(), sizeof(int) * meta.size(), cudaMemcpyHostToDevice)) return false;
+    rk.rowSlot = kv.meta.ptr;
+    rk.crossSlot = rk.rowSlot;
+    rk.rowPos = rk.rowSlot + rows;
+    rk.encLen = rk.rowPos + rows;
+    rk.pageTable = rk.encLen + kv.slots;
+    rk.pagesPerSeq = kv.pagesPerSeq;
+    rk.selfK = kv.k.ptr;
+    rk.selfV = kv.v.ptr;
+    rk.selfStride = static_cast<size_t>(kv.pages) * KV_PAGE_TOKENS * dAttn;
+    rk.crossK = kv.crossK.ptr;
+    rk.crossV = kv.crossV.ptr;
+    rk.crossStride = static_cast<size_t>(kv.slots) * kv.encCap * dAttn;
+    rk.slotStride = kv.encCap;
+
+    gpu->stats.begin(T5_STAGE_DECODER, nullptr);
+    if (!run_embed(model.cfg, gpu->ws, ids, model.d_shared, gpu->ws.x.ptr)) return false;
+    if (!decode_rows(gpu, rows, rk)) return false;
+    gpu->stats.end(T5_STAGE_DECODER, nullptr);
+    gpu->stats.begin(T5_STAGE_SELECT, nullptr);
+    argmax_rows_kernel<<<rows, 256>>>(gpu->ws.logits.ptr, model.cfg.vocabSize, gpu->ws.reduceIdx.ptr);
+    if (!cuda_ok(cudaGetLastError())) return false;
+    gpu->stats.end(T5_STAGE_SELECT, nullptr);
+    nextIds.resize(static_cast<size_t>(rows));
+    if (!timed_copy(gpu, T5_STAGE_DOWNLOAD, nextIds.data(), gpu->ws.reduceIdx.ptr, sizeof(int) * rows, cudaMemcpyDeviceToHost)) {
+        return false;
+    }
+    collect_stats(gpu);
     return true;
 }
 
-extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_t5_cuda_Backend_nativeCreate(JNIEnv* env, jclass, jstring path) {
-    if (path == nullptr) return 0;
+// Greedy decoding for a list of requests with at most batch_slots() of them
+// live at once: every step advances all live rows together, and a request
+// that hits EOS or the token limit hands its slot and pages to the next one
+// in the queue. outputs[i] starts with the decoder start id, as for
+// nativeGenerateIds.
+static bool generate_batch(T5Gpu* gpu, const std::vector<std::vector<int>>& inputs, int maxNewTokens,
+                           std::vector<std::vector<int>>& outputs) {
+    const T5Model& model = *gpu->model;
+    int count = static_cast<int>(inputs.size());
+    outputs.assign(static_cast<size_t>(count), std::vector<int>(1, model.cfg.decoderStartId));
+    if (count == 0 || maxNewTokens == 0) return true;
+
+    int encCap = 0;
+    for (const auto& in : inputs) {
+        encCap = std::max(encCap, static_cast<int>(in.size()));
+    }
+    int slots = std::min(batch_slots(), count);
+    if (!ensure_kv_arena(gpu, slots, encCap, maxNewTokens)) return false;
+    KvArena& kv = gpu->kv;
+
+    std::vector<BatchSlot> slot(static_cast<size_t>(slots));
+    std::vector<int> rowSlots;
+    std::vector<int> ids;
+    std::vector<int> meta;
+    std::vector<int> nextIds;
+    int next = 0;
+    for (;;) {
+        std::vector<int> seqs;
+        std::vector<int> slotIds;
+        for (int s = 0; s < slots && next < count; s++) {
+            if (slot[static_cast<size_t>(s)].seq < 0) {
+                slot[static_cast<size_t>(s)].seq = next;
+                slot[static_cast<size_t>(s)].encLen = static_cast<int>(inputs[static_cast<size_t>(next)].size());
+                seqs.push_back(next++);
+                slotIds.push_back(s);
+            }
+        }
+        if (!seqs.empty() && !admit_batch(gpu, inputs, seqs, slotIds)) return false;
+
+        GpuStats::Clock::time_point scheduled = gpu->stats.now();
+        rowSlots.clear();
+        ids.clear();
+        int maxPos = 0;
+        for (int s = 0; s < slots; s++) {
+            BatchSlot& bs = slot[static_cast<size_t>(s)];
+            if (bs.seq < 0) continue;
+            const std::vector<int>& out = outputs[static_cast<size_t>(bs.seq)];
+            int pos = static_cast<int>(out.size()) - 1;
+            if (pos / KV_PAGE_TOKENS >= static_cast<int>(bs.pages.size())) {
+                if (kv.freePages.empty()) return false;
+                bs.pages.push_back(kv.freePages.back());
+                kv.freePages.pop_back();
+            }
+            rowSlots.push_back(s);
+            ids.push_back(out.back());
+            maxPos = std::max(maxPos, pos);
+        }
+        if (rowSlots.empty()) {
+            collect_stats(gpu);
+            break;
+        }
+
+        int rows = static_cast<int>(rowSlots.size());
+        meta.assign(static_cast<size_t>(2 * rows + slots + slots * kv.pagesPerSeq), 0);
+        for (int r = 0; r < rows; r++) {
+            const BatchSlot& bs = slot[static_cast<size_t>(rowSlots[r])];
+            meta[static_cast<size_t>(r)] = rowSlots[r];
+            meta[static_cast<size_t>(rows + r)] = static_cast<int>(outputs[static_cast<size_t>(bs.seq)].size()) - 1;
+        }
+        for (int s = 0; s < slots; s++) {
+            const BatchSlot& bs = slot[static_cast<size_t>(s)];
+            meta[static_cast<size_t>(2 * rows + s)] = bs.encLen;
+            for (size_t p = 0; p < bs.pages.size(); p++) {
+                meta[static_cast<size_t>(2 * rows + slots + s * kv.pagesPerSeq) + p] = bs.pages[p];
+            }
+        }
+        gpu->stats.host(T5_STAGE_SCHEDULE, scheduled);
+        if (!run_decoder_step_batch(gpu, ids, meta, maxPos, nextIds)) return false;
+
+        for (int r = 0; r < rows; r++) {
+            BatchSlot& bs = slot[static_cast<size_t>(rowSlots[r])];
+            std::vector<int>& out = outputs[static_cast<size_t>(bs.seq)];
+            int nextId = nextIds[static_cast<size_t>(r)];
+            bool done = nextId == model.cfg.eosId;
+            if (!done) {
+                out.push_back(nextId);
+                done = static_cast<int>(out.size()) - 1 >= maxNewTokens;
+            }
+            if (done) {
+                kv.freePages.insert(kv.freePages.end(), bs.pages.begin(), bs.pages.end());
+                bs.pages.clear();
+                bs.seq = -1;
+                bs.encLen = 0;
+            }
+        }
+    }
+    return true;
+}
+
+// Decodes one prompt with the model's DecodeOptions: greedy by default,
+// top-k/top-p sampling, or beam search. Every token is chosen on the device;
+// the host polls the done flag every DecodeOptions::pollSteps steps and copies
+// the best finished hypothesis back once.
+static bool generate_search(T5Gpu* gpu, const std::vector<int>& inputIds, int maxNewTokens, std::vector<int>& outputIds) {
+    const T5Model& model = *gpu->model;
+    outputIds.assign(1, model.cfg.decoderStartId);
+    if (maxNewTokens == 0 || inputIds.empty()) return true;
+
+    const DecodeOptions& opt = gpu->decode;
+    bool sampling = opt.topK > 0 || opt.topP < 1.0f;
+    int beams = sampling ? 1 : opt.beams;
+    int topK = sampling ? (opt.topK > 0 ? opt.topK : SAMPLE_MAX_K) : 1;
+    unsigned long long sampleKey = sampling ? splitmix64(opt.seed ^ splitmix64(gpu->sampleCalls++)) : 0;
+    int layers = model.cfg.numDecoderLayers;
+    int dModel = model.cfg.dModel;
+    int dAttn = model.cfg.numHeads * model.cfg.dKv;
+    int encLen = static_cast<int>(inputIds.size());
+    SearchArena& sa = gpu->search;
+
+    std::vector<int> lens(1, encLen);
+    gpu->stats.begin(T5_STAGE_ENCODER, nullptr);
+    if (!run_encoder_batch(gpu, inputIds, lens, 1, encLen)) return false;
+    gpu->stats.end(T5_STAGE_ENCODER, nullptr);
+    size_t crossStride = static_cast<size_t>(encLen) * dAttn;
+    if (!sa.crossK.ensure(layers * crossStride) || !sa.crossV.ensure(layers * crossStride)) return false;
+    gpu->stats.begin(T5_STAGE_CROSS_KV, nullptr);
+    for (int layer = 0; layer < layers; layer++) {
+        const DecoderLayer& l = model.decoder[static_cast<size_t>(layer)];
+        if (!gemm_row_major(gpu, encLen, dAttn, dModel, gpu->ws.x.ptr,
+                            pick_f(l.crossAttn.wk, model.dtype),
+                            pick_h(l.crossAttn.wk16, model.dtype),
+                            pick_b(l.crossAttn.wkbf, model.dtype),
+                            l.crossAttn.wk8,
+                            sa.crossK.ptr + layer * crossStride)) return false;
+        if (!gemm_row_major(gpu, encLen, dAttn, dModel, gpu->ws.x.ptr,
+                            pick_f(l.crossAttn.wv, model.dtype),
+                            pick_h(l.crossAttn.wv16, model.dtype),
+                            pick_b(l.crossAttn.wvbf, model.dtype),
+                            l.crossAttn.wv8,
+                            sa.crossV.ptr + layer * crossStride)) return false;
+    }
+    gpu->stats.end(T5_STAGE_CROSS_KV, nullptr);
+
+    // Beam b owns pages b * pagesPerSeq.. of each pool, so its cache rows are
+    // contiguous and kv_reorder_kernel can gather them without a page table.
+    int pagesPerSeq = (maxNewTokens + KV_PAGE_TOKENS - 1) / KV_PAGE_TOKENS;
+    int cap = pagesPerSeq * KV_PAGE_TOKENS;
+    int stride = maxNewTokens + 1;
+    size_t selfStride = static_cast<size_t>(beams) * cap * dAttn;
+    int pools = beams > 1 ? 2 : 1;
+    for (int p = 0; p < pools; p++) {
+        if (!sa.k[p].ensure(layers * selfStride) || !sa.v[p].ensure(layers * selfStride)) return false;
+    }
+    if (!sa.candScore.ensure(static_cast<size_t>(beams) * 2 * beams)) return false;
+    if (!sa.candToken.ensure(static_cast<size_t>(beams) * 2 * beams)) return false;
+    if (!sa.tokens.ensure(static_cast<size_t>(3) * beams * stride)) return false;
+    if (!sa.state && !cuda_ok(cudaMalloc(reinterpret_cast<void**>(&sa.state), sizeof(SearchState)))) return false;
+
+    // meta is [rowSlot | crossSlot per beam | encLen | page table per beam | rowPos per step and beam].
+    std::vector<int> meta(static_cast<size_t>(2 * beams + 1 + beams * pagesPerSeq + maxNewTokens * beams), 0);
+    for (int b = 0; b < beams; b++) {
+        meta[static_cast<size_t>(b)] = b;
+        for (int p = 0; p < pagesPerSeq; p++) {
+            meta[static_cast<size_t>(2 * beams + 1 + b * pagesPerSeq + p)] = b * pagesPerSeq + p;
+        }
+    }
+    meta[static_cast<size_t>(2 * beams)] = encLen;
+    for (int step = 0; step < maxNewTokens; step++) {
+        for (int b = 0; b < beams; b++) {
+            meta[static_cast<size_t>(2 * beams + 1 + beams * pagesPerSeq + step * beams + b)] = step;
+        }
+    }
+    if (!sa.meta.ensure(meta.size())) return false;
+    if (!timed_copy(gpu, T5_STAGE_UPLOAD, sa.meta.ptr, meta.data(), sizeof(int) * meta.size(), cudaMemcpyHostToDevice)) return false;
+    const int* posTable = sa.meta.ptr + 2 * beams + 1 + beams * pagesPerSeq;
+
+    std::vector<int> tokens(static_cast<size_t>(3) * beams * stride, model.cfg.decoderStartId);
+    if (!timed_copy(gpu, T5_STAGE_UPLOAD, sa.tokens.ptr, tokens.data(), sizeof(int) * tokens.size(), cudaMemcpyHostToDevice)) return false;
+    SearchState init{};
+    for (int b = 0; b < MAX_BEAMS; b++) {
+        init.parent[b] = b;
+        init.score[b] = b == 0 ? 0.0f : -1e30f;
+    }
+    if (!timed_copy(gpu, T5_STAGE_UPLOAD, sa.state, &init, sizeof(SearchState), cudaMemcpyHostToDevice)) return false;
+
+    RowKv rk;
+    rk.rowSlot = sa.meta.ptr;
+    rk.crossSlot = rk.rowSlot + beams;
+    rk.encLen = rk.crossSlot + beams;
+    rk.pageTable = rk.encLen + 1;
+    rk.pagesPerSeq = pagesPerSeq;
+    rk.selfStride = selfStride;
+    rk.crossK = sa.crossK.ptr;
+    rk.crossV = sa.crossV.ptr;
+    rk.crossStride = crossStride;
+    rk.slotStride = encLen;
+    rk.attnStride = std::max(maxNewTokens, encLen);
+    if (!ensure_decode_workspace(gpu, beams, rk.attnStride)) return false;
+
+    int vocab = model.cfg.vocabSize;
+    int* hyp = sa.tokens.ptr + 2 * beams * stride;
+    for (int step = 0; step < maxNewTokens; step++) {
+        int parity = beams > 1 ? step & 1 : 0;
+        int* cur = sa.tokens.ptr + parity * beams * stride;
+        int* nxt = sa.tokens.ptr + (parity ^ 1) * beams * stride;
+        rk.selfK = sa.k[parity].ptr;
+        rk.selfV = sa.v[parity].ptr;
+        rk.rowPos = posTable + step * beams;
+
+        int total = beams * dModel;
+        gpu->stats.begin(T5_STAGE_DECODER, nullptr);
+        embed_tokens_kernel<<<(total + 255) / 256, 256>>>(cur, stride, step, beams, vocab, dModel, model.cfg.unkId,
+                                                          model.d_shared, gpu->ws.x.ptr);
+        if (!cuda_ok(cudaGetLastError())) return false;
+        if (!decode_rows(gpu, beams, rk)) return false;
+        gpu->stats.end(T5_STAGE_DECODER, nullptr);
+        gpu->stats.begin(T5_STAGE_SELECT, nullptr);
+        if (beams > 1) {
+            beam_topk_kernel<<<beams, 256>>>(gpu->ws.logits.ptr, vocab, sa.state, sa.candScore.ptr, sa.candToken.ptr, beams);
+            beam_select_kernel<<<1, 1>>>(sa.state, sa.candScore.ptr, sa.candToken.ptr, cur, nxt, hyp, stride, step,
+                                         maxNewTokens, beams, model.cfg.eosId, opt.lengthPenalty);
+            size_t count = static_cast<size_t>(layers) * beams * (step + 1) * dAttn;
+            kv_reorder_kernel<<<static_cast<unsigned int>((count + 255) / 256), 256>>>(
+                sa.k[parity].ptr, sa.v[parity].ptr, sa.k[parity ^ 1].ptr, sa.v[parity ^ 1].ptr,
+                sa.state, layers, beams, cap, step, dAttn);
+        } else {
+            sample_kernel<<<1, 256>>>(gpu->ws.logits.ptr, vocab, sa.state, cur, hyp, 0, step, maxNewTokens,
+                                      model.cfg.eosId, topK, opt.topP, opt.temperature, sampleKey);
+        }
+        if (!cuda_ok(cudaGetLastError())) return false;
+        gpu->stats.end(T5_STAGE_SELECT, nullptr);
+        if ((step + 1) % opt.pollSteps == 0) {
+            int done = 0;
+            if (!timed_copy(gpu, T5_STAGE_DOWNLOAD, &done, &sa.state->done, sizeof(int), cudaMemcpyDeviceToHost)) return false;
+            collect_stats(gpu);
+            if (done) break;
+        }
+    }
+
+    SearchState state;
+    if (!timed_copy(gpu, T5_STAGE_DOWNLOAD, &state, sa.state, sizeof(SearchState), cudaMemcpyDeviceToHost)) return false;
+    if (state.hypCount <= 0) return false;
+    int best = 0;
+    for (int i = 1; i < state.hypCount; i++) {
+        if (state.hypScore[i] > state.hypScore[best]) best = i;
+    }
+    outputIds.resize(static_cast<size_t>(state.hypLen[best]));
+    if (!timed_copy(gpu, T5_STAGE_DOWNLOAD, outputIds.data(), hyp + best * stride, sizeof(int) * outputIds.size(),
+                    cudaMemcpyDeviceToHost)) {
+        return false;
+    }
+    collect_stats(gpu);
+    return true;
+}
+
+// Models currently held by live handles, one per (path, device, dtype).
+static WeightCache<T5Model>& weight_cache() {
+    static WeightCache<T5Model> cache(release_model);
+    return cache;
+}
+
+// -------------------------
+// Weight images (see ../common/weight_image_impl.inl), enabled by
+// CRTK_T5_CUDA_WEIGHT_IMAGE. The image holds every tensor as build_model left
+// it: transposed, matrices in the model dtype, norms and biases in fp32.
+// -------------------------
+
+static const char* T5_IMAGE_TAG = "t5-cuda";
+
+static const char* dtype_name(DType dtype) {
+    if (dtype == DType::F16) return "fp16";
+    if (dtype == DType::BF16) return "bf16";
+    if (dtype == DType::I8) return "int8";
+    return "fp32";
+}
+
+// Element count of every tensor, in required_tensors() order; visit_model walks
+// the tensors in the same order.
+static std::vector<size_t> tensor_counts(const HostModel& host) {
+    std::vector<size_t> counts;
+    for (const auto& name : required_tensors(host.cfg)) counts.push_back(host.tensors.at(name).data.size());
+    return counts;
+}
+
+// `q` is the int8 storage of a decoder matrix or lm_head, null for every other matrix.
+template <typename V>
+static void visit_matrix(V& v, DType dtype, size_t count, float*& f, half*& h, __nv_bfloat16*& b, Int8Matrix* q) {
+    if (q && dtype == DType::I8) {
+        v.value(q->cols);
+        v.value(q->stride);
+        v.tensor(q->w, q->cols > 0 ? count / static_cast<size_t>(q->cols) * static_cast<size_t>(q->stride) : 0);
+        v.tensor(q->scale, static_cast<size_t>(q->stride));
+    }
+    if (dtype == DType::F16 || dtype == DType::I8) v.tensor(h, count);
+    else if (dtype == DType::BF16) v.tensor(b, count);
+    else v.tensor(f, count);
+}
+
+template <typename V, typename Next>
+static void visit_attention(V& v, DType dtype, Next& next, AttentionWeights& a, bool decoder) {
+    visit_matrix(v, dtype, next(), a.wq, a.wq16, a.wqbf, decoder ? &a.wq8 : nullptr);
+    visit_matrix(v, dtype, next(), a.wk, a.wk16, a.wkbf, decoder ? &a.wk8 : nullptr);
+    visit_matrix(v, dtype, next(), a.wv, a.wv16, a.wvbf, decoder ? &a.wv8 : nullptr);
+    visit_matrix(v, dtype, next(), a.wo, a.wo16, a.wobf, decoder ? &a.wo8 : nullptr);
+}
+
+template <typename V, typename Next>
+static void visit_ffn(V& v, DType dtype, Next& next, FfnWeights& f, bool decoder) {
+    visit_matrix(v, dtype, next(), f.wi0, f.wi016, f.wi0bf, decoder ? &f.wi08 : nullptr);
+    visit_matrix(v, dtype, next(), f.wi1, f.wi116, f.wi1bf, decoder ? &f.wi18 : nullptr);
+    visit_matrix(v, dtype, next(), f.wo, f.wo16, f.wobf, decoder ? &f.wo8 : nullptr);
+}
+
+// `counts` comes from tensor_counts() when writing an image and is empty when
+// reading one (the image records its own counts).
+template <typename V>
+static void visit_model(V& v, T5Model& model, const std::vector<size_t>& counts) {
+    size_t index = 0;
+    auto next = [&]() -> size_t { return index < counts.size() ? counts[index++] : 0; };
+    T5Config& cfg = model.cfg;
+    v.value(cfg.vocabSize);
+    v.value(cfg.dModel);
+    v.value(cfg.dKv);
+    v.value(cfg.dFf);
+    v.value(cfg.numLayers);
+    v.value(cfg.numDecoderLayers);
+    v.value(cfg.numHeads);
+    v.value(cfg.relBuckets);
+    v.value(cfg.relMaxDistance);
+    v.value(cfg.padId);
+    v.value(cfg.eosId);
+    v.value(cfg.decoderStartId);
+    v.value(cfg.unkId);
+    v.value(cfg.gatedGelu);
+    v.value(cfg.layerNormEps);
+    const DType dt = model.dtype;
+    v.tensor(model.d_shared, next());
+    v.tensor(model.d_encoderRelBias, next());
+    v.tensor(model.d_decoderRelBias, next());
+    v.tensor(model.d_encoderFinalLn, next());
+    v.tensor(model.d_decoderFinalLn, next());
+    visit_matrix(v, dt, next(), model.d_lmHead, model.d_lmHead16, model.d_lmHeadBf, &model.d_lmHead8);
+    v.size(model.encoder);
+    for (auto& layer : model.encoder) {
+        v.tensor(layer.ln1, next());
+        visit_attention(v, dt, next, layer.attn, false);
+        v.tensor(layer.ln2, next());
+        visit_ffn(v, dt, next, layer.ffn, false);
+    }
+    v.size(model.decoder);
+    for (auto& layer : model.decoder) {
+        v.tensor(layer.ln1, next());
+        visit_attention(v, dt, next, layer.selfAttn, true);
+        v.tensor(layer.ln2, next());
+        visit_attention(v, dt, next, layer.crossAttn, true);
+        v.tensor(layer.ln3, next());
+        visit_ffn(v, dt, next, layer.ffn, true);
+    }
+}
+
+// Loads the image written for this source file and dtype into `device`, which
+// must be current; null when there is none or it does not match the source.
+static T5Model* load_image(const std::string& path, int device, DType dtype, const MappedFile& source, uint64_t sourceHash) {
+    WeightImageReader image;
+    if (!image.open(weight_image_path(path, T5_IMAGE_TAG, dtype_name(dtype)), T5_IMAGE_TAG,
+                    static_cast<uint32_t>(dtype), source.size(), sourceHash) || image.payload_bytes() == 0) {
+        return nullptr;
+    }
+    auto* model = new T5Model();
+    model->device = device;
+    model->dtype = dtype;
+    if (!cuda_ok(cudaMalloc(reinterpret_cast<void**>(&model->d_arena), image.payload_bytes()))) {
+        model->d_arena = nullptr;
+        release_model(model);
+        return nullptr;
+    }
+    unsigned char* stage = nullptr;
+    if (!cuda_ok(cudaMallocHost(reinterpret_cast<void**>(&stage), std::min(image.payload_bytes(), WEIGHT_IMAGE_STAGE_BYTES)))) {
+        stage = nullptr; // copy from the pageable mapping instead
+    }
+    const bool uploaded = weight_image_upload(image, stage, [&](size_t offset, const void* src, size_t bytes) {
+        return cuda_ok(cudaMemcpy(model->d_arena + offset, src, bytes, cudaMemcpyHostToDevice));
+    });
+    if (stage) cudaFreeHost(stage);
+    bool ok = uploaded;
+    try {
+        WeightImageLoad load(image, model->d_arena);
+        if (ok) visit_model(load, *model, {});
+        ok = ok && load.ok()
+                && model->encoder.size() == static_cast<size_t>(model->cfg.numLayers)
+                && model->decoder.size() == static_cast<size_t>(model->cfg.numDecoderLayers);
+    } catch (...) {
+        ok = false;
+    }
+    if (!ok) {
+        release_model(model);
+        return nullptr;
+    }
+    return model;
+}
+
+// Writes the image for a freshly built model. Best effort: a failed write only
+// costs the next load its fast path.
+static void save_image(const std::string& path, const HostModel& host, T5Model& model, const MappedFile& source,
+                       uint64_t sourceHash) {
+    try {
+        WeightImageWriter writer;
+        auto fetch = [](void* dst, const void* src, size_t bytes) {
+            return cuda_ok(cudaMemcpy(dst, src, bytes, cudaMemcpyDeviceToHost));
+        };
+        WeightImageSave<decltype(fetch)> save(writer, fetch);
+        visit_model(save, model, tensor_counts(host));
+        if (save.ok()) {
+            (void) writer.write(weight_image_path(path, T5_IMAGE_TAG, dtype_name(model.dtype)), T5_IMAGE_TAG,
+                                static_cast<uint32_t>(model.dtype), source.size(), sourceHash);
+        }
+    } catch (...) {
+    }
+}
+
+// Parses `path` and uploads it to `device`, which must be current.
+static T5Model* load_model(const std::string& path, int device, DType dtype) {
+    MappedFile source;
+    uint64_t sourceHash = 0;
+    const bool imaged = weight_image_enabled("CRTK_T5_CUDA_WEIGHT_IMAGE") && source.open(path);
+    if (imaged) {
+        sourceHash = weight_image_hash(source);
+        if (T5Model* model = load_image(path, device, dtype, source, sourceHash)) return model;
+    }
+    HostModel host;
+    if (!load_t5_bin(path, host)) {
+        return nullptr;
+    }
+    T5Model* model = nullptr;
+    if (!build_model(host, device, dtype, model)) {
+        return nullptr;
+    }
+    if (imaged) save_image(path, host, *model, source, sourceHash);
+    return model;
+}
+
+// Opens a handle on one device ordinal, sharing the weights of any live handle
+// on the same file, device and dtype.
+static jlong create_on_device(JNIEnv* env, jstring path, int device) {
+    if (path == nullptr || device < 0 || device >= device_count()) return 0;
+    if (!cuda_ok(cudaSetDevice(device))) return 0;
     const char* cpath = env->GetStringUTFChars(path, nullptr);
     if (!cpath) return 0;
     std::string pathStr(cpath);
     env->ReleaseStringUTFChars(path, cpath);
 
-    HostModel host;
-    if (!load_t5_bin(pathStr, host)) {
+    const DType dtype = parse_dtype();
+    std::shared_ptr<const T5Model> model = weight_cache().acquire(pathStr, device, static_cast<int>(dtype),
+                                                                  [&] { return load_model(pathStr, device, dtype); });
+    if (!model) {
         return 0;
     }
 
-    T5Gpu* gpu = nullptr;
-    if (!build_gpu(host, gpu)) {
+    auto* gpu = new T5Gpu();
+    gpu->model = std::move(model);
+    gpu->device = device;
+    if (!cublas_ok(cublasCreate(&gpu->handle))) {
+        delete gpu;
         return 0;
     }
+    cublasSetMathMode(gpu->handle, CUBLAS_TENSOR_OP_MATH);
+    gpu->decode = parse_decode_options();
+    gpu->stats.configure(T5_STAGE_NAMES, T5_STAGES, gpu_stats_from_env("CRTK_T5_CUDA_STATS"));
     return reinterpret_cast<jlong>(gpu);
 }
 
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_t5_cuda_Backend_nativeCreate(JNIEnv* env, jclass, jstring path) {
+    return create_on_device(env, path, 0);
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_t5_cuda_Backend_nativeCreateOnDevice(
+    JNIEnv* env, jclass, jstring path, jint device) {
+    return create_on_device(env, path, device);
+}
+
 extern "C" JNIEXPORT void JNICALL Java_chess_nn_t5_cuda_Backend_nativeDestroy(JNIEnv*, jclass, jlong handle) {
     T5Gpu* gpu = reinterpret_cast<T5Gpu*>(handle);
     destroy_gpu(gpu);
@@ -1647,65 +2839,81 @@ extern "C" JNIEXPORT jintArray JNICALL Java_chess_nn_t5_cuda_Backend_nativeGener
     if (maxNewTokens < 0) maxNewTokens = 0;
 
     T5Gpu* gpu = reinterpret_cast<T5Gpu*>(handle);
+    const T5Model& model = *gpu->model;
+    if (!cuda_ok(cudaSetDevice(gpu->device))) return nullptr;
     jsize len = env->GetArrayLength(inputIdsArr);
     std::vector<int> inputIds(static_cast<size_t>(len));
     env->GetIntArrayRegion(inputIdsArr, 0, len, inputIds.data());
 
-    if (inputIds.empty() || inputIds.back() != gpu->cfg.eosId) {
-        inputIds.push_back(gpu->cfg.eosId);
+    if (inputIds.empty() || inputIds.back() != model.cfg.eosId) {
+        inputIds.push_back(model.cfg.eosId);
     }
 
-    EncoderState enc;
-    if (!run_encoder(gpu, inputIds, enc)) {
-        cuda_free(enc.hidden);
-        return nullptr;
-    }
-
-    std::vector<float*> encK;
-    std::vector<float*> encV;
-    if (!precompute_encoder_kv(gpu, enc, encK, encV)) {
-        cuda_free(enc.hidden);
-        free_encoder_kv(encK);
-        free_encoder_kv(encV);
-        return nullptr;
-    }
+    std::vector<int> outputIds;
+    if (!generate_search(gpu, inputIds, maxNewTokens, outputIds)) return nullptr;
 
-    std::vector<DecoderCache> cache;
-    int maxLen = maxNewTokens + 1;
-    if (!alloc_decoder_cache(gpu->cfg, maxLen, cache)) {
-        cuda_free(enc.hidden);
-        free_encoder_kv(encK);
-        free_encoder_kv(encV);
-        free_decoder_cache(cache);
-        return nullptr;
-    }
+    jintArray outArr = env->NewIntArray(static_cast<jsize>(outputIds.size()));
+    if (!outArr) return nullptr;
+    env->SetIntArrayRegion(outArr, 0, static_cast<jsize>(outputIds.size()), outputIds.data());
+    return outArr;
+}
 
-    std::vector<int> outputIds;
-    outputIds.reserve(static_cast<size_t>(maxNewTokens) + 1);
-    outputIds.push_back(gpu->cfg.decoderStartId);
+// Batched form of nativeGenerateIds. Request i is ids[offsets[i] .. offsets[i + 1]);
+// the result holds the count output lengths followed by the outputs back to back.
+extern "C" JNIEXPORT jintArray JNICALL Java_chess_nn_t5_cuda_Backend_nativeGenerateIdsBatch(
+    JNIEnv* env, jclass, jlong handle, jintArray idsArr, jintArray offsetsArr, jint maxNewTokens) {
+    if (handle == 0 || idsArr == nullptr || offsetsArr == nullptr) return nullptr;
+    if (maxNewTokens < 0) maxNewTokens = 0;
 
-    for (int step = 0; step < maxNewTokens; step++) {
-        int nextId = 0;
-        if (!run_decoder_step_cached(gpu, outputIds, enc, encK, encV, cache, nextId)) {
-            cuda_free(enc.hidden);
-            free_encoder_kv(encK);
-            free_encoder_kv(encV);
-            free_decoder_cache(cache);
-            return nullptr;
-        }
-        if (nextId == gpu->cfg.eosId) {
-            break;
+    T5Gpu* gpu = reinterpret_cast<T5Gpu*>(handle);
+    const T5Model& model = *gpu->model;
+    if (!cuda_ok(cudaSetDevice(gpu->device))) return nullptr;
+    jsize total = env->GetArrayLength(idsArr);
+    jsize bounds = env->GetArrayLength(offsetsArr);
+    if (bounds < 1) return nullptr;
+    std::vector<int> flat(static_cast<size_t>(total));
+    std::vector<int> offsets(static_cast<size_t>(bounds));
+    env->GetIntArrayRegion(idsArr, 0, total, flat.data());
+    env->GetIntArrayRegion(offsetsArr, 0, bounds, offsets.data());
+
+    int count = bounds - 1;
+    std::vector<std::vector<int>> inputs(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        int begin = offsets[static_cast<size_t>(i)];
+        int end = offsets[static_cast<size_t>(i) + 1];
+        if (begin < 0 || end < begin || end > total) return nullptr;
+        std::vector<int>& in = inputs[static_cast<size_t>(i)];
+        in.assign(flat.begin() + begin, flat.begin() + end);
+        if (in.empty() || in.back() != model.cfg.eosId) {
+            in.push_back(model.cfg.eosId);
         }
-        outputIds.push_back(nextId);
     }
 
-    cuda_free(enc.hidden);
-    free_encoder_kv(encK);
-    free_encoder_kv(encV);
-    free_decoder_cache(cache);
+    std::vector<std::vector<int>> outputs;
+    if (!generate_batch(gpu, inputs, maxNewTokens, outputs)) return nullptr;
 
-    jintArray outArr = env->NewIntArray(static_cast<jsize>(outputIds.size()));
+    std::vector<int> packed(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        const std::vector<int>& out = outputs[static_cast<size_t>(i)];
+        packed[static_cast<size_t>(i)] = static_cast<int>(out.size());
+        packed.insert(packed.end(), out.begin(), out.end());
+    }
+    jintArray outArr = env->NewIntArray(static_cast<jsize>(packed.size()));
     if (!outArr) return nullptr;
-    env->SetIntArrayRegion(outArr, 0, static_cast<jsize>(outputIds.size()), outputIds.data());
+    env->SetIntArrayRegion(outArr, 0, static_cast<jsize>(packed.size()), packed.data());
     return outArr;
 }
+
+extern "C" JNIEXPORT jstring JNICALL Java_chess_nn_t5_cuda_Backend_nativeGetStatNames(JNIEnv* env, jclass, jlong handle) {
+    T5Gpu* gpu = reinterpret_cast<T5Gpu*>(handle);
+    if (!gpu) return nullptr;
+    return gpu->stats.names_string(env);
+}
+
+// Per-stage counters (layout in ../common/gpu_stats_impl.inl), zeroed after reading when `reset` is set.
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_t5_cuda_Backend_nativeGetStats(
+    JNIEnv* env, jclass, jlong handle, jboolean reset) {
+    T5Gpu* gpu = reinterpret_cast<T5Gpu*>(handle);
+    if (!gpu) return nullptr;
+    return gpu->stats.to_array(env, reset == JNI_TRUE);
+}
@@ -0,0 +1,966 @@
+/*
+ * native/host/lc0_cnn_host_jni.cpp
+ *
+ * Host CPU backend for the Java LC0 evaluator (see src/chess/nn/lc0/cnn/host/Support.java and
+ * src/chess/nn/lc0/cnn/host/Backend.java), for machines without a supported GPU. It reads the same
+ * ChessRTK LC0 CNN ".bin" weights as the CUDA and ROCm backends (../common/lc0_cnn_loader_impl.inl)
+ * and runs the same forward pass, input planes -> trunk -> policy logits + value (WDL), on a pool
+ * of host threads.
+ *
+ * JNI surface
+ * -----------
+ *   - chess.nn.lc0.cnn.host.Support.nativeDeviceCount() -> int (worker threads)
+ *   - chess.nn.lc0.cnn.host.Backend.nativeCreate(String weightsPath) -> long (opaque handle)
+ *   - chess.nn.lc0.cnn.host.Backend.nativeDestroy(long handle) -> void
+ *   - chess.nn.lc0.cnn.host.Backend.nativeGetInfo(long handle) -> long[12]
+ *       [inputC, trunkC, blocks, policyC, valueC, policySize, paramCount, maxBatch, isa, threads,
+ *        evalCount, meanEvalNanos]
+ *       (isa: 0 = scalar, 1 = AVX2+FMA, 2 = AVX-512F; meanEvalNanos is wall time per eval_batch)
+ *   - chess.nn.lc0.cnn.host.Backend.nativePredict(long handle, float[] encoded, float[] policyOut, float[] wdlOut) -> float
+ *   - chess.nn.lc0.cnn.host.Backend.nativePredictBatch(long handle, float[] encoded, int count,
+ *       float[] policyOut, float[] wdlOut, float[] valueOut) -> int (positions evaluated)
+ * Input and output layouts are those of the GPU backends: float[count * inputC * 64] in,
+ * policy float[count * policySize], WDL float[count * 3] and value float[count] out.
+ *
+ * Internals
+ * ---------
+ * Activations of a batch are stored channel-major, [C][batch * 64], so each convolution is one
+ * GEMM over the whole batch:
+ *   out[outC][batch * 64] = W[outC][inC * k * k] * cols[inC * k * k][batch * 64]
+ * A 3x3 layer first expands its input into the zero-padded column matrix (im2col); a 1x1 layer
+ * only repacks it. Columns are packed into strips of NR, and W is packed once at load time into
+ * panels of MR = 6 rows, both k-major, so the micro-kernel streams one panel and one strip and
+ * keeps a 6 x NR output tile in registers for the whole reduction. Bias, ReLU and the residual
+ * add are applied as the tile is stored, like the epilogue of the CUDA implicit-GEMM engine.
+ *
+ * The micro-kernel has three builds, chosen per handle from the CPU: AVX-512F (NR = 64, one
+ * position per strip), AVX2+FMA (NR = 16) and a portable loop (NR = 16) for other CPUs and
+ * non-x86 hosts. CRTK_LC0_HOST_ISA=scalar|avx2|avx512 caps the choice. The SIMD builds use
+ * per-function target attributes, so the library itself needs no -m flags and loads anywhere.
+ *
+ * An SE block takes the raw conv2 output. Pooling and both FC layers run as one task per
+ * position, then a single pass applies the gates together with the conv bias, the residual and
+ * the ReLU.
+ *
+ * Work runs on a process-wide pool of CRTK_LC0_HOST_THREADS workers (default: every hardware
+ * thread); the calling thread takes part. Every output element is produced by one thread with
+ * its sums in a fixed order, so results do not depend on the thread count. They do depend on the
+ * ISA (FMA contraction, lane order of the dense dot products) at float rounding level, and are
+ * not bit-identical to the Java evaluator.
+ *
+ * Handles opened on the same file share the packed weights (../common/weight_cache_impl.inl) and
+ * own only their workspace, sized for CRTK_LC0_HOST_MAX_BATCH positions (default 16); larger
+ * requests run in chunks. Treat a handle as single-threaded like the GPU ones; calls on different
+ * handles take turns on the pool, which already uses every worker.
+ *
+ * Failures return 0/null and let Java fall back to the Java evaluator.
+ */
+
+#include <jni.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LC0_HOST_X86 1
+#include <immintrin.h>
+#endif
+
+#include "../common/lc0_cnn_loader_impl.inl"
+#include "../common/weight_cache_impl.inl"
+
+namespace {
+
+// Upper bound on CRTK_LC0_HOST_THREADS.
+constexpr int MAX_WORKERS = 1024;
+
+// Upper bound on CRTK_LC0_HOST_MAX_BATCH.
+constexpr int MAX_BATCH_LIMIT = 1024;
+
+// Rows per packed weight panel (micro-tile height).
+constexpr int MR = 6;
+
+enum Isa {
+    ISA_SCALAR = 0,
+    ISA_AVX2 = 1,
+    ISA_AVX512 = 2
+};
+
+// Applied while a GEMM tile is stored.
+enum Epilogue {
+    EPI_NONE = 0,              // raw conv output
+    EPI_BIAS = 1,              // + bias
+    EPI_BIAS_RELU = 2,         // relu(+ bias)
+    EPI_BIAS_RESIDUAL_RELU = 3 // relu(+ bias + residual)
+};
+
+// Worker count from CRTK_LC0_HOST_THREADS, defaulting to the hardware threads.
+int worker_count() {
+    const char* v = std::getenv("CRTK_LC0_HOST_THREADS");
+    long n = v != nullptr ? std::strtol(v, nullptr, 10) : 0;
+    if (n <= 0) {
+        n = static_cast<long>(std::thread::hardware_concurrency());
+    }
+    return static_cast<int>(std::max(1L, std::min<long>(n, MAX_WORKERS)));
+}
+
+int max_batch_from_env() {
+    const char* v = std::getenv("CRTK_LC0_HOST_MAX_BATCH");
+    long n = v != nullptr ? std::strtol(v, nullptr, 10) : 0;
+    if (n <= 0) {
+        n = 16;
+    }
+    return static_cast<int>(std::min<long>(n, MAX_BATCH_LIMIT));
+}
+
+int detected_isa() {
+#ifdef LC0_HOST_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return ISA_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return ISA_AVX2;
+#endif
+    return ISA_SCALAR;
+}
+
+// Best ISA of this CPU, capped by CRTK_LC0_HOST_ISA.
+int isa_from_env() {
+    const int best = detected_isa();
+    const char* v = std::getenv("CRTK_LC0_HOST_ISA");
+    if (v == nullptr) return best;
+    const std::string value(v);
+    if (value == "scalar") return ISA_SCALAR;
+    if (value == "avx2") return std::min(best, static_cast<int>(ISA_AVX2));
+    return best;
+}
+
+// ---- worker pool ----
+
+// Persistent workers that split one range at a time. run() hands out size() contiguous slices
+// and runs the first on the calling thread; concurrent run() calls are serialized.
+class WorkerPool {
+public:
+    using Job = std::function<void(int64_t, int64_t)>;
+
+    explicit WorkerPool(int workers) {
+        for (int i = 1; i < workers; ++i) {
+            try {
+                threads_.emplace_back(&WorkerPool::loop, this, i);
+            } catch (const std::system_error&) {
+                break; // fewer threads than asked for
+            }
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return static_cast<int>(threads_.size()) + 1; }
+
+    // Calls job(begin, end) over [0, count) and returns once every slice is done.
+    void run(int64_t count, const Job& job) {
+        if (count <= 0) return;
+        const int slices = static_cast<int>(std::min<int64_t>(size(), count));
+        if (slices == 1) {
+            job(0, count);
+            return;
+        }
+        std::lock_guard<std::mutex> serial(run_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            count_ = count;
+            slices_ = slices;
+            pending_ = slices - 1;
+            ++generation_;
+        }
+        wake_.notify_all();
+        job(0, count / slices);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return pending_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void loop(int index) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return generation_ != seen; });
+            seen = generation_;
+            if (index >= slices_) continue;
+            const Job* job = job_;
+            const int64_t count = count_;
+            const int slices = slices_;
+            lock.unlock();
+            (*job)(count * index / slices, count * (index + 1) / slices);
+            lock.lock();
+            if (--pending_ == 0) done_.notify_one();
+        }
+    }
+
+    std::mutex run_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const Job* job_ = nullptr;
+    int64_t count_ = 0;
+    int slices_ = 0;
+    int pending_ = 0;
+    uint64_t generation_ = 0;
+    std::vector<std::thread> threads_;
+};
+
+// Created on first use and never destroyed: the workers sleep on the pool's condition variable
+// until the process exits, so there is no join racing library unload or JVM shutdown.
+WorkerPool& pool() {
+    static WorkerPool* shared = new WorkerPool(worker_count());
+    return *shared;
+}
+
+// ---- storage ----
+
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+    static constexpr std::align_val_t ALIGN{64};
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), ALIGN)); }
+    void deallocate(T* p, size_t) { ::operator delete(p, ALIGN); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+// 64-byte aligned floats, so packed strips and activation rows start on cache lines.
+using Floats = std::vector<float, AlignedAllocator<float>>;
+
+// Conv weights packed into MR-row panels: ap[(panel * K + k) * MR + r] = W[panel * MR + r][k],
+// zero for the rows past outC in the last panel. K is inC * k * k.
+struct PackedConv {
+    int inC = 0;
+    int outC = 0;
+    int k = 0;
+    int K = 0;
+    int panels = 0;
+    Floats ap;
+    std::vector<float> bias;
+};
+
+struct HostBlock {
+    PackedConv conv1;
+    PackedConv conv2;
+    bool hasSe = false;
+    Lc0Se se;
+};
+
+// Immutable weights of one loaded net, shared by every handle opened on the same file.
+struct HostModel {
+    int inputC = 0;
+    int trunkC = 0;
+    int blocks = 0;
+    int policyC = 0;
+    int valueC = 0;
+    int valueHidden = 0;
+    int policySize = 0;
+    int seMaxHidden = 0;
+    int64_t paramCount = 0;
+    size_t maxK = 0;        // widest GEMM reduction, sizes the column buffer
+    int maxChannels = 0;    // widest activation
+
+    PackedConv input;
+    std::vector<HostBlock> tower;
+    PackedConv policyStem;
+    PackedConv policyOut;
+    PackedConv valueConv;
+    Lc0Dense valueFc1;
+    Lc0Dense valueFc2;
+    std::vector<int32_t> policyMap;
+};
+
+void pack_conv(const Lc0Conv& src, PackedConv& out) {
+    out.inC = src.inC;
+    out.outC = src.outC;
+    out.k = src.k;
+    out.K = src.inC * src.k * src.k;
+    out.panels = (src.outC + MR - 1) / MR;
+    out.ap.assign(static_cast<size_t>(out.panels) * out.K * MR, 0.0f);
+    for (int m = 0; m < src.outC; ++m) {
+        float* dst = out.ap.data() + static_cast<size_t>(m / MR) * out.K * MR + m % MR;
+        const float* row = src.w.data() + static_cast<size_t>(m) * out.K;
+        for (int kk = 0; kk < out.K; ++kk) dst[static_cast<size_t>(kk) * MR] = row[kk];
+    }
+    out.bias = src.b;
+}
+
+HostModel* load_model(const std::string& path) {
+    Lc0Net net;
+    if (!lc0_read_net(path, net)) return nullptr;
+    auto model = std::make_unique<HostModel>();
+    model->inputC = net.inputC;
+    model->trunkC = net.trunkC;
+    model->blocks = net.blocks;
+    model->policyC = net.policyC;
+    model->valueC = net.valueC;
+    model->valueHidden = net.valueHidden;
+    model->policySize = net.policySize;
+    model->seMaxHidden = net.seMaxHidden;
+    model->paramCount = net.paramCount;
+
+    pack_conv(net.input, model->input);
+    model->tower.resize(net.tower.size());
+    for (size_t i = 0; i < net.tower.size(); ++i) {
+        Lc0Block& src = net.tower[i];
+        HostBlock& b = model->tower[i];
+        pack_conv(src.conv1, b.conv1);
+        pack_conv(src.conv2, b.conv2);
+        b.hasSe = src.hasSe;
+        b.se = std::move(src.se);
+    }
+    pack_conv(net.policyStem, model->policyStem);
+    pack_conv(net.policyOut, model->policyOut);
+    pack_conv(net.valueConv, model->valueConv);
+    model->valueFc1 = std::move(net.valueFc1);
+    model->valueFc2 = std::move(net.valueFc2);
+    model->policyMap = std::move(net.policyMap);
+
+    auto widen = [&](const PackedConv& c) {
+        model->maxK = std::max(model->maxK, static_cast<size_t>(c.K));
+        model->maxChannels = std::max({model->maxChannels, c.inC, c.outC});
+    };
+    widen(model->input);
+    for (const HostBlock& b : model->tower) {
+        widen(b.conv1);
+        widen(b.conv2);
+    }
+    widen(model->policyStem);
+    widen(model->policyOut);
+    widen(model->valueConv);
+    return model.release();
+}
+
+void release_model(HostModel* model) {
+    delete model;
+}
+
+// Models currently held by live handles, one per path.
+WeightCache<HostModel>& weight_cache() {
+    static WeightCache<HostModel> cache(release_model);
+    return cache;
+}
+
+// ---- kernels ----
+
+// One MR x nr output tile over the full reduction: ap is a packed panel, bp a packed column strip
+// (bp[k * nr + j]), c the tile's top-left output with row stride ldc. Only the first `rows` rows
+// are stored; bias and residual are offset to the tile like c.
+using TileKernel = void (*)(const float* ap, const float* bp, int K, float* c, size_t ldc, int rows,
+                            const float* bias, const float* residual, int epi);
+
+// Dot product of n floats.
+using DotKernel = float (*)(const float* a, const float* b, int n);
+
+struct Kernels {
+    int isa = ISA_SCALAR;
+    int nr = 16;
+    TileKernel tile = nullptr;
+    DotKernel dot = nullptr;
+};
+
+inline float relu(float x) { return x > 0.0f ? x : 0.0f; }
+inline float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+inline float epilogue(float v, int epi, float bias, const float* residual, size_t i) {
+    if (epi == EPI_NONE) return v;
+    v += bias;
+    if (epi == EPI_BIAS_RESIDUAL_RELU) v += residual[i];
+    return epi == EPI_BIAS ? v : relu(v);
+}
+
+constexpr int SCALAR_NR = 16;
+
+void tile_scalar(const float* ap, const float* bp, int K, float* c, size_t ldc, int rows,
+                 const float* bias, const float* residual, int epi) {
+    float acc[MR][SCALAR_NR] = {};
+    for (int k = 0; k < K; ++k, ap += MR, bp += SCALAR_NR) {
+        for (int r = 0; r < MR; ++r) {
+            const float a = ap[r];
+            for (int j = 0; j < SCALAR_NR; ++j) acc[r][j] += a * bp[j];
+        }
+    }
+    for (int r = 0; r < rows; ++r) {
+        const float b = epi == EPI_NONE ? 0.0f : bias[r];
+        for (int j = 0; j < SCALAR_NR; ++j) {
+            const size_t i = r * ldc + j;
+            c[i] = epilogue(acc[r][j], epi, b, residual, i);
+        }
+    }
+}
+
+float dot_scalar(const float* a, const float* b, int n) {
+    float acc = 0.0f;
+    for (int i = 0; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+#ifdef LC0_HOST_X86
+
+__attribute__((target("avx2,fma"))) inline __m256 epilogue_avx2(__m256 v, int epi, __m256 bias, const float* residual) {
+    if (epi == EPI_NONE) return v;
+    v = _mm256_add_ps(v, bias);
+    if (epi == EPI_BIAS_RESIDUAL_RELU) v = _mm256_add_ps(v, _mm256_loadu_ps(residual));
+    return epi == EPI_BIAS ? v : _mm256_max_ps(v, _mm256_setzero_ps());
+}
+
+// 6 x 16 tile: 12 accumulators, two strip vectors and one broadcast out of 16 ymm registers.
+__attribute__((target("avx2,fma"))) void tile_avx2(const float* ap, const float* bp, int K, float* c, size_t ldc,
+                                                   int rows, const float* bias, const float* residual, int epi) {
+    __m256 acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+    for (int k = 0; k < K; ++k, ap += MR, bp += 16) {
+        const __m256 b0 = _mm256_load_ps(bp);
+        const __m256 b1 = _mm256_load_ps(bp + 8);
+        for (int r = 0; r < MR; ++r) {
+            const __m256 a = _mm256_broadcast_ss(ap + r);
+            acc[r][0] = _mm256_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a, b1, acc[r][1]);
+        }
+    }
+    for (int r = 0; r < rows; ++r) {
+        const __m256 b = _mm256_set1_ps(epi == EPI_NONE ? 0.0f : bias[r]);
+        const float* res = residual ? residual + r * ldc : nullptr;
+        _mm256_storeu_ps(c + r * ldc, epilogue_avx2(acc[r][0], epi, b, res));
+        _mm256_storeu_ps(c + r * ldc + 8, epilogue_avx2(acc[r][1], epi, b, res ? res + 8 : nullptr));
+    }
+}
+
+__attribute__((target("avx2,fma"))) float dot_avx2(const float* a, const float* b, int n) {
+    __m256 acc = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc);
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float sum = 0.0f;
+    for (float lane : lanes) sum += lane;
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+__attribute__((target("avx512f"))) inline __m512 epilogue_avx512(__m512 v, int epi, __m512 bias, const float* residual) {
+    if (epi == EPI_NONE) return v;
+    v = _mm512_add_ps(v, bias);
+    if (epi == EPI_BIAS_RESIDUAL_RELU) v = _mm512_add_ps(v, _mm512_loadu_ps(residual));
+    // Masked form with every lane set: GCC 12 reports the _mm512_undefined_ps() pass-through
+    // inside _mm512_max_ps as maybe-uninitialized and the two compile to the same vmaxps.
+    const __m512 zero = _mm512_setzero_ps();
+    return epi == EPI_BIAS ? v : _mm512_mask_max_ps(zero, static_cast<__mmask16>(0xFFFF), v, zero);
+}
+
+// 6 x 64 tile (one position): 24 accumulators, four strip vectors and one broadcast out of 32
+// zmm registers.
+__attribute__((target("avx512f"))) void tile_avx512(const float* ap, const float* bp, int K, float* c, size_t ldc,
+                                                    int rows, const float* bias, const float* residual, int epi) {
+    // Every one of the MR x 4 accumulators starts at zero, including the rows past `rows` that
+    // the packed zero padding of `ap` feeds and the store loop skips.
+    __m512 acc[MR][4];
+    for (int r = 0; r < MR; ++r) {
+        for (int j = 0; j < 4; ++j) acc[r][j] = _mm512_setzero_ps();
+    }
+    for (int k = 0; k < K; ++k, ap += MR, bp += 64) {
+        const __m512 b0 = _mm512_load_ps(bp);
+        const __m512 b1 = _mm512_load_ps(bp + 16);
+        const __m512 b2 = _mm512_load_ps(bp + 32);
+        const __m512 b3 = _mm512_load_ps(bp + 48);
+        for (int r = 0; r < MR; ++r) {
+            const __m512 a = _mm512_set1_ps(ap[r]);
+            acc[r][0] = _mm512_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(a, b1, acc[r][1]);
+            acc[r][2] = _mm512_fmadd_ps(a, b2, acc[r][2]);
+            acc[r][3] = _mm512_fmadd_ps(a, b3, acc[r][3]);
+        }
+    }
+    for (int r = 0; r < rows; ++r) {
+        const __m512 b = _mm512_set1_ps(epi == EPI_NONE ? 0.0f : bias[r]);
+        for (int j = 0; j < 4; ++j) {
+            const float* res = residual ? residual + r * ldc + 16 * j : nullptr;
+            _mm512_storeu_ps(c + r * ldc + 16 * j, epilogue_avx512(acc[r][j], epi, b, res));
+        }
+    }
+}
+
+__attribute__((target("avx512f"))) float dot_avx512(const float* a, const float* b, int n) {
+    __m512 acc = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc);
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, acc);
+    float sum = 0.0f;
+    for (float lane : lanes) sum += lane;
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+#endif // LC0_HOST_X86
+
+Kernels kernels_for(int isa) {
+    Kernels k;
+#ifdef LC0_HOST_X86
+    if (isa == ISA_AVX512) {
+        k.isa = ISA_AVX512;
+        k.nr = 64;
+        k.tile = tile_avx512;
+        k.dot = dot_avx512;
+        return k;
+    }
+    if (isa == ISA_AVX2) {
+        k.isa = ISA_AVX2;
+        k.nr = 16;
+        k.tile = tile_avx2;
+        k.dot = dot_avx2;
+        return k;
+    }
+#else
+    (void) isa;
+#endif
+    k.isa = ISA_SCALAR;
+    k.nr = SCALAR_NR;
+    k.tile = tile_scalar;
+    k.dot = dot_scalar;
+    return k;
+}
+
+// Source square of a 3x3 tap (ky * 3 + kx) for every output square, -1 off the board.
+struct TapTable {
+    int src[9][64];
+
+    TapTable() {
+        for (int ky = 0; ky < 3; ++ky) {
+            for (int kx = 0; kx < 3; ++kx) {
+                for (int s = 0; s < 64; ++s) {
+                    const int r = (s >> 3) + ky - 1;
+                    const int c = (s & 7) + kx - 1;
+                    src[ky * 3 + kx][s] = (r < 0 || r >= 8 || c < 0 || c >= 8) ? -1 : (r << 3) + c;
+                }
+            }
+        }
+    }
+};
+
+const TapTable& taps() {
+    static const TapTable table;
+    return table;
+}
+
+// ---- handle ----
+
+struct HostNet {
+    std::shared_ptr<const HostModel> model;
+    Kernels kernels;
+    int maxBatch = 16;
+    int threads = 1;
+
+    // Activations, [channels][maxBatch * 64].
+    Floats in;
+    Floats cur;
+    Floats next;
+    Floats tmp;
+    Floats scratch;
+    Floats policyHidden;
+    Floats policyPlanes;
+    Floats valueInput;
+    Floats cols; // packed column strips, [maxBatch * 64 / nr][maxK][nr]
+
+    // Per position.
+    std::vector<float> fcIn;   // [maxBatch][valueC * 64]
+    std::vector<float> fc1;    // [maxBatch][valueHidden]
+    std::vector<float> logits; // [maxBatch][3]
+    std::vector<float> seGates; // [maxBatch][2 * trunkC]
+    std::vector<float> seWork;  // [maxBatch][trunkC + seMaxHidden]
+
+    int64_t evalCount = 0;
+    int64_t evalNanos = 0;
+};
+
+HostNet* create_net(const std::string& path) {
+    std::shared_ptr<const HostModel> shared = weight_cache().acquire(path, 0, 0, [&] { return load_model(path); });
+    if (!shared) return nullptr;
+    const HostModel& model = *shared;
+    if (model.inputC != 112) return nullptr;
+
+    auto net = std::make_unique<HostNet>();
+    net->model = std::move(shared);
+    net->kernels = kernels_for(isa_from_env());
+    net->maxBatch = max_batch_from_env();
+    net->threads = pool().size();
+
+    const size_t n = static_cast<size_t>(net->maxBatch) * 64;
+    const size_t B = static_cast<size_t>(net->maxBatch);
+    net->in.assign(static_cast<size_t>(model.inputC) * n, 0.0f);
+    net->cur.assign(static_cast<size_t>(model.trunkC) * n, 0.0f);
+    net->next.assign(net->cur.size(), 0.0f);
+    net->tmp.assign(static_cast<size_t>(model.maxChannels) * n, 0.0f);
+    net->scratch.assign(net->cur.size(), 0.0f);
+    net->policyHidden.assign(static_cast<size_t>(model.policyStem.outC) * n, 0.0f);
+    net->policyPlanes.assign(static_cast<size_t>(model.policyC) * n, 0.0f);
+    net->valueInput.assign(static_cast<size_t>(model.valueC) * n, 0.0f);
+    net->cols.assign(model.maxK * n, 0.0f);
+    net->fcIn.assign(B * model.valueC * 64, 0.0f);
+    net->fc1.assign(B * model.valueHidden, 0.0f);
+    net->logits.assign(B * 3, 0.0f);
+    net->seGates.assign(B * 2 * model.trunkC, 0.0f);
+    net->seWork.assign(B * (model.trunkC + model.seMaxHidden), 0.0f);
+    return net.release();
+}
+
+void destroy_net(HostNet* net) {
+    delete net;
+}
+
+// Packs src [inC][positions * 64] into column strips for `conv`: strip s, row kk, lane j holds
+// the input feeding output column s * nr + j through kernel row kk.
+void pack_columns(HostNet& net, const PackedConv& conv, const float* src, int positions) {
+    const int nr = net.kernels.nr;
+    const size_t n = static_cast<size_t>(positions) * 64;
+    const size_t K = static_cast<size_t>(conv.K);
+    float* cols = net.cols.data();
+    const TapTable& table = taps();
+    pool().run(conv.inC, [&](int64_t begin, int64_t end) {
+        for (int64_t ic = begin; ic < end; ++ic) {
+            const float* plane = src + static_cast<size_t>(ic) * n;
+            if (conv.k == 1) {
+                for (size_t col = 0; col < n; ++col) {
+                    cols[((col / nr) * K + ic) * nr + col % nr] = plane[col];
+                }
+                continue;
+            }
+            for (int t = 0; t < 9; ++t) {
+                const size_t row = static_cast<size_t>(ic) * 9 + t;
+                const int* srcSquare = table.src[t];
+                for (int p = 0; p < positions; ++p) {
+                    const float* board = plane + static_cast<size_t>(p) * 64;
+                    for (int s = 0; s < 64; ++s) {
+                        const size_t col = static_cast<size_t>(p) * 64 + s;
+                        const int from = srcSquare[s];
+                        cols[((col / nr) * K + row) * nr + col % nr] = from < 0 ? 0.0f : board[from];
+                    }
+                }
+            }
+        }
+    });
+}
+
+// dst [outC][positions * 64] = epilogue(conv(src)), one tile per (panel, strip). Tiles are
+// ordered strip-major so a thread's consecutive tiles reuse the same column strip.
+void run_conv(HostNet& net, const PackedConv& conv, const float* src, float* dst, int positions, int epi,
+              const float* residual = nullptr) {
+    pack_columns(net, conv, src, positions);
+    const int nr = net.kernels.nr;
+    const size_t n = static_cast<size_t>(positions) * 64;
+    const size_t K = static_cast<size_t>(conv.K);
+    const int64_t strips = static_cast<int64_t>(n / nr);
+    const TileKernel tile = net.kernels.tile;
+    const float* cols = net.cols.data();
+    pool().run(strips * conv.panels, [&](int64_t begin, int64_t end) {
+        for (int64_t t = begin; t < end; ++t) {
+            const size_t strip = static_cast<size_t>(t / conv.panels);
+            const int panel = static_cast<int>(t % conv.panels);
+            const size_t offset = static_cast<size_t>(panel) * MR * n + strip * nr;
+            tile(conv.ap.data() + static_cast<size_t>(panel) * K * MR, cols + strip * K * nr, conv.K,
+                 dst + offset, n, std::min(MR, conv.outC - panel * MR), conv.bias.data() + panel * MR,
+                 residual ? residual + offset : nullptr, epi);
+        }
+    });
+}
+
+// SE block on the raw conv2 output: dst = relu(sigmoid(g) * (raw + bias) + residual + beta), with
+// the gate g and shift beta from the pooled (raw + bias) of each position.
+void run_se(HostNet& net, const Lc0Se& se, const PackedConv& conv2, const float* raw, const float* residual,
+            float* dst, int positions) {
+    const int channels = se.channels;
+    const size_t n = static_cast<size_t>(positions) * 64;
+    const DotKernel dot = net.kernels.dot;
+    const size_t work = static_cast<size_t>(channels) + net.model->seMaxHidden;
+    float* gates = net.seGates.data();
+    float* scratch = net.seWork.data();
+    pool().run(positions, [&](int64_t begin, int64_t end) {
+        for (int64_t p = begin; p < end; ++p) {
+            float* pooled = scratch + static_cast<size_t>(p) * work;
+            float* hidden = pooled + channels;
+            for (int c = 0; c < channels; ++c) {
+                const float* plane = raw + static_cast<size_t>(c) * n + static_cast<size_t>(p) * 64;
+                float sum = 0.0f;
+                for (int s = 0; s < 64; ++s) sum += plane[s];
+                pooled[c] = sum * (1.0f / 64.0f) + conv2.bias[c];
+            }
+            for (int h = 0; h < se.hidden; ++h) {
+                hidden[h] = relu(se.b1[h] + dot(se.w1.data() + static_cast<size_t>(h) * channels, pooled, channels));
+            }
+            float* g = gates + static_cast<size_t>(p) * 2 * channels;
+            for (int o = 0; o < 2 * channels; ++o) {
+                g[o] = se.b2[o] + dot(se.w2.data() + static_cast<size_t>(o) * se.hidden, hidden, se.hidden);
+            }
+        }
+    });
+    pool().run(static_cast<int64_t>(channels) * positions, [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+            const int c = static_cast<int>(row % channels);
+            const size_t p = static_cast<size_t>(row / channels);
+            const float* g = gates + p * 2 * channels;
+            const float gamma = sigmoid(g[c]);
+            const float beta = g[c + channels];
+            const float bias = conv2.bias[c];
+            const size_t base = static_cast<size_t>(c) * n + p * 64;
+            for (int s = 0; s < 64; ++s) {
+                dst[base + s] = relu(gamma * (raw[base + s] + bias) + residual[base + s] + beta);
+            }
+        }
+    });
+}
+
+// y[p][o] = act(b[o] + w[o] . x[p]) for every position, split over outputs.
+void run_dense(const HostNet& net, const Lc0Dense& layer, const float* x, float* y, int positions, bool reluAct) {
+    const DotKernel dot = net.kernels.dot;
+    pool().run(layer.outD, [&](int64_t begin, int64_t end) {
+        for (int64_t o = begin; o < end; ++o) {
+            const float* row = layer.w.data() + static_cast<size_t>(o) * layer.inD;
+            for (int p = 0; p < positions; ++p) {
+                const float v = layer.b[o] + dot(row, x + static_cast<size_t>(p) * layer.inD, layer.inD);
+                y[static_cast<size_t>(p) * layer.outD + o] = reluAct ? relu(v) : v;
+            }
+        }
+    });
+}
+
+// Evaluates up to net->maxBatch positions ([batch][inputC * 64]). Writes:
+// - outPolicy: [batch][policySize]
+// - outWdl: [batch][3]
+// - outValues: [batch] scalar value (W-L)
+bool eval_batch(HostNet* net, const float* encoded, int batch, float* outPolicy, float* outWdl, float* outValues) {
+    if (!net) return false;
+    const HostModel& model = *net->model;
+    if (batch <= 0 || batch > net->maxBatch) return false;
+    const auto started = std::chrono::steady_clock::now();
+    const size_t n = static_cast<size_t>(batch) * 64;
+
+    // [batch][inputC][64] -> [inputC][batch * 64]
+    float* in = net->in.data();
+    pool().run(model.inputC, [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; ++c) {
+            for (int p = 0; p < batch; ++p) {
+                std::memcpy(in + static_cast<size_t>(c) * n + static_cast<size_t>(p) * 64,
+                            encoded + (static_cast<size_t>(p) * model.inputC + c) * 64, sizeof(float) * 64);
+            }
+        }
+    });
+
+    float* cur = net->cur.data();
+    float* next = net->next.data();
+    run_conv(*net, model.input, in, cur, batch, EPI_BIAS_RELU);
+    for (const HostBlock& b : model.tower) {
+        run_conv(*net, b.conv1, cur, net->tmp.data(), batch, EPI_BIAS_RELU);
+        if (!b.hasSe) {
+            run_conv(*net, b.conv2, net->tmp.data(), next, batch, EPI_BIAS_RESIDUAL_RELU, cur);
+        } else {
+            // SE needs the pre-bias conv output: pooling and gating add the bias themselves.
+            run_conv(*net, b.conv2, net->tmp.data(), net->scratch.data(), batch, EPI_NONE);
+            run_se(*net, b.se, b.conv2, net->scratch.data(), cur, next, batch);
+        }
+        std::swap(cur, next);
+    }
+
+    // policy head
+    run_conv(*net, model.policyStem, cur, net->policyHidden.data(), batch, EPI_BIAS_RELU);
+    run_conv(*net, model.policyOut, net->policyHidden.data(), net->policyPlanes.data(), batch, EPI_BIAS);
+    const float* planes = net->policyPlanes.data();
+    const int planesLen = model.policyC * 64;
+    for (int p = 0; p < batch; ++p) {
+        float* policy = outPolicy + static_cast<size_t>(p) * model.policySize;
+        for (int i = 0; i < model.policySize; ++i) {
+            const int idx = model.policyMap[i];
+            policy[i] = (idx >= 0 && idx < planesLen)
+                    ? planes[static_cast<size_t>(idx >> 6) * n + static_cast<size_t>(p) * 64 + (idx & 63)]
+                    : 0.0f;
+        }
+    }
+
+    // value head: [valueC][batch * 64] -> [batch][valueC * 64] for the dense layers
+    run_conv(*net, model.valueConv, cur, net->valueInput.data(), batch, EPI_BIAS_RELU);
+    const float* value = net->valueInput.data();
+    float* fcIn = net->fcIn.data();
+    for (int p = 0; p < batch; ++p) {
+        for (int c = 0; c < model.valueC; ++c) {
+            std::memcpy(fcIn + (static_cast<size_t>(p) * model.valueC + c) * 64,
+                        value + static_cast<size_t>(c) * n + static_cast<size_t>(p) * 64, sizeof(float) * 64);
+        }
+    }
+    run_dense(*net, model.valueFc1, fcIn, net->fc1.data(), batch, true);
+    run_dense(*net, model.valueFc2, net->fc1.data(), net->logits.data(), batch, false);
+
+    for (int i = 0; i < batch; i++) {
+        const float* lg = net->logits.data() + i * 3;
+        float m = std::max(lg[0], std::max(lg[1], lg[2]));
+        float e0 = std::exp(lg[0] - m);
+        float e1 = std::exp(lg[1] - m);
+        float e2 = std::exp(lg[2] - m);
+        float s = e0 + e1 + e2;
+        float w = (s > 0.0f) ? (e0 / s) : 0.0f;
+        float d = (s > 0.0f) ? (e1 / s) : 0.0f;
+        float l = (s > 0.0f) ? (e2 / s) : 0.0f;
+        outWdl[i * 3 + 0] = w;
+        outWdl[i * 3 + 1] = d;
+        outWdl[i * 3 + 2] = l;
+        outValues[i] = w - l;
+    }
+    net->evalCount++;
+    net->evalNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count();
+    return true;
+}
+
+jlong backend_nativeCreate(JNIEnv* env, jstring jpath) {
+    if (!jpath) return 0;
+    const char* cpath = env->GetStringUTFChars(jpath, nullptr);
+    if (!cpath) return 0;
+    std::string path(cpath);
+    env->ReleaseStringUTFChars(jpath, cpath);
+    try {
+        return reinterpret_cast<jlong>(create_net(path));
+    } catch (const std::bad_alloc&) {
+        return 0;
+    }
+}
+
+} // namespace
+
+// ---- JNI ----
+
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_host_Support_nativeDeviceCount(JNIEnv*, jclass) {
+    return worker_count();
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_lc0_cnn_host_Backend_nativeCreate(JNIEnv* env, jclass, jstring jpath) {
+    return backend_nativeCreate(env, jpath);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_chess_nn_lc0_cnn_host_Backend_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+    destroy_net(reinterpret_cast<HostNet*>(handle));
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_lc0_cnn_host_Backend_nativeGetInfo(JNIEnv* env, jclass, jlong handle) {
+    HostNet* net = reinterpret_cast<HostNet*>(handle);
+    if (!net) return nullptr;
+    const HostModel& model = *net->model;
+    jlong vals[12];
+    vals[0] = model.inputC;
+    vals[1] = model.trunkC;
+    vals[2] = model.blocks;
+    vals[3] = model.policyC;
+    vals[4] = model.valueC;
+    vals[5] = model.policySize;
+    vals[6] = model.paramCount;
+    vals[7] = net->maxBatch;
+    vals[8] = net->kernels.isa;
+    vals[9] = net->threads;
+    vals[10] = net->evalCount;
+    vals[11] = net->evalCount > 0 ? net->evalNanos / net->evalCount : 0;
+    jlongArray arr = env->NewLongArray(12);
+    if (!arr) return nullptr;
+    env->SetLongArrayRegion(arr, 0, 12, vals);
+    return arr;
+}
+
+extern "C" JNIEXPORT jfloat JNICALL Java_chess_nn_lc0_cnn_host_Backend_nativePredict(
+        JNIEnv* env, jclass, jlong handle, jfloatArray jencoded, jfloatArray joutPolicy, jfloatArray joutWdl) {
+    HostNet* net = reinterpret_cast<HostNet*>(handle);
+    if (!net) return 0.0f;
+    const HostModel& model = *net->model;
+    if (!jencoded || !joutPolicy || !joutWdl) return 0.0f;
+
+    const jsize encLen = env->GetArrayLength(jencoded);
+    const jsize polLen = env->GetArrayLength(joutPolicy);
+    const jsize wdlLen = env->GetArrayLength(joutWdl);
+    if (encLen != model.inputC * 64) return 0.0f;
+    if (polLen != model.policySize) return 0.0f;
+    if (wdlLen != 3) return 0.0f;
+
+    std::vector<float> encoded(static_cast<size_t>(encLen));
+    env->GetFloatArrayRegion(jencoded, 0, encLen, encoded.data());
+
+    std::vector<float> policy(static_cast<size_t>(polLen));
+    float wdl[3] = {0, 0, 0};
+    float value = 0.0f;
+    if (!eval_batch(net, encoded.data(), 1, policy.data(), wdl, &value)) {
+        return 0.0f;
+    }
+
+    env->SetFloatArrayRegion(joutPolicy, 0, polLen, policy.data());
+    env->SetFloatArrayRegion(joutWdl, 0, 3, wdl);
+    return value;
+}
+
+// Batched predict: evaluates `count` positions packed back to back in `jencoded` and writes
+// policy/WDL/value in the same order. Requests larger than maxBatch run in maxBatch-sized chunks.
+// Returns the number of positions evaluated (count on success, 0 on failure).
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_lc0_cnn_host_Backend_nativePredictBatch(
+        JNIEnv* env, jclass, jlong handle, jfloatArray jencoded, jint count,
+        jfloatArray joutPolicy, jfloatArray joutWdl, jfloatArray joutValue) {
+    HostNet* net = reinterpret_cast<HostNet*>(handle);
+    if (!net) return 0;
+    const HostModel& model = *net->model;
+    if (!jencoded || !joutPolicy || !joutWdl || !joutValue) return 0;
+    if (count <= 0) return 0;
+
+    const size_t n = static_cast<size_t>(count);
+    const size_t encStride = static_cast<size_t>(model.inputC) * 64;
+    const size_t polStride = static_cast<size_t>(model.policySize);
+    if (static_cast<size_t>(env->GetArrayLength(jencoded)) < n * encStride) return 0;
+    if (static_cast<size_t>(env->GetArrayLength(joutPolicy)) < n * polStride) return 0;
+    if (static_cast<size_t>(env->GetArrayLength(joutWdl)) < n * 3) return 0;
+    if (static_cast<size_t>(env->GetArrayLength(joutValue)) < n) return 0;
+
+    std::vector<float> encoded;
+    std::vector<float> policy;
+    std::vector<float> wdl;
+    std::vector<float> values;
+    try {
+        encoded.resize(n * encStride);
+        policy.resize(n * polStride);
+        wdl.resize(n * 3);
+        values.resize(n);
+    } catch (const std::bad_alloc&) {
+        return 0;
+    }
+    env->GetFloatArrayRegion(jencoded, 0, static_cast<jsize>(encoded.size()), encoded.data());
+
+    for (size_t off = 0; off < n; off += static_cast<size_t>(net->maxBatch)) {
+        const int chunk = static_cast<int>(std::min(n - off, static_cast<size_t>(net->maxBatch)));
+        if (!eval_batch(net, encoded.data() + off * encStride, chunk,
+                        policy.data() + off * polStride, wdl.data() + off * 3, values.data() + off)) {
+            return 0;
+        }
+    }
+
+    env->SetFloatArrayRegion(joutPolicy, 0, static_cast<jsize>(policy.size()), policy.data());
+    env->SetFloatArrayRegion(joutWdl, 0, static_cast<jsize>(wdl.size()), wdl.data());
+    env->SetFloatArrayRegion(joutValue, 0, static_cast<jsize>(values.size()), values.data());
+    return count;
+}
@@ -0,0 +1,382 @@
+/*
+ * native/host/perft_host_jni.cpp
+ *
+ * CPU backend for split-depth bulk perft, for machines without a supported GPU.
+ *
+ * Like the oneAPI backend it uses the portable move generator in
+ * native/common/perft_core.h directly, here on a pool of host threads. The
+ * frontier is cut into tasks: one per position, or, when the frontier is too
+ * small to keep every worker busy, several lanes per position that share its
+ * legal root moves (perft_root_share), so the split runs by subtree. Each worker
+ * starts on a contiguous block of tasks and, once its block is empty, steals the
+ * back half of another worker's remaining block. Tasks write into fixed slots and
+ * lanes are summed in order afterwards, so counts are identical for every thread
+ * count and steal order.
+ *
+ * CRTK_PERFT_HOST_THREADS sets the worker count (default: every hardware
+ * thread). nativeDeviceCount reports it, and nativeSessionDeviceNodes reports
+ * per-worker node totals of the last session call, mirroring the per-device
+ * totals of the GPU sessions. nativeSessionFoldedPerft(Detailed) expands the
+ * frontier natively and counts each distinct position once (perft_frontier.h).
+ * Configure with -DCRTK_PERFT_HOST_BMI2=ON to
+ * compile perft_core.h with AVX2/BMI2, which switches sliders to PEXT lookups.
+ */
+
+#include <jni.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "../common/perft_core.h"
+#include "../common/perft_frontier.h"
+
+namespace {
+
+using namespace crtk_perft;
+
+constexpr int DETAIL_FIELDS = 7;
+
+// Aim for this many tasks per worker so stealing can rebalance uneven subtrees.
+constexpr int TASKS_PER_WORKER = 8;
+
+// Upper bound on lanes per frontier position in the root-split mode.
+constexpr int MAX_ROOT_LANES = 64;
+
+// Upper bound on CRTK_PERFT_HOST_THREADS.
+constexpr int MAX_WORKERS = 1024;
+
+// Worker count from CRTK_PERFT_HOST_THREADS, defaulting to the hardware threads.
+int worker_count() {
+    const char* v = std::getenv("CRTK_PERFT_HOST_THREADS");
+    long n = v != nullptr ? std::strtol(v, nullptr, 10) : 0;
+    if (n <= 0) {
+        n = static_cast<long>(std::thread::hardware_concurrency());
+    }
+    return static_cast<int>(std::max(1L, std::min<long>(n, MAX_WORKERS)));
+}
+
+// Remaining tasks [next, end) of one worker. The owner takes from the front;
+// thieves cut off the back half.
+struct TaskRange {
+    std::mutex lock;
+    int next = 0;
+    int end = 0;
+};
+
+struct PerftWork {
+    const Tables* tables = nullptr;
+    const jlong* packed = nullptr;
+    int depth = 0;
+    int lanes = 1;
+    bool detailed = false;
+    int fields = 1;
+    std::unique_ptr<TaskRange[]> ranges;
+    int workers = 0;
+    // fields counters per task, in task order.
+    std::vector<jlong> out;
+    // Nodes counted by each worker.
+    std::vector<jlong> workerNodes;
+};
+
+bool claim(TaskRange& r, int& task) {
+    std::lock_guard<std::mutex> guard(r.lock);
+    if (r.next >= r.end) {
+        return false;
+    }
+    task = r.next++;
+    return true;
+}
+
+// Moves the back half of the first non-empty victim range into `self` and
+// claims its first task. Returns false once every range is empty.
+bool steal(PerftWork& w, int self, int& task) {
+    for (int k = 1; k < w.workers; ++k) {
+        TaskRange& victim = w.ranges[(self + k) % w.workers];
+        int from;
+        int to;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            int remaining = victim.end - victim.next;
+            if (remaining <= 0) {
+                continue;
+            }
+            to = victim.end;
+            from = to - (remaining + 1) / 2;
+            victim.end = from;
+        }
+        TaskRange& own = w.ranges[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.next = from + 1;
+        own.end = to;
+        task = from;
+        return true;
+    }
+    return false;
+}
+
+void run_task(PerftWork& w, int task, jlong& nodes) {
+    const int index = task / w.lanes;
+    const int lane = task % w.lanes;
+    Position p;
+    unpack_position(reinterpret_cast<const uint64_t*>(w.packed) + static_cast<long>(index) * PACK_WORDS, p);
+    jlong* o = w.out.data() + static_cast<long>(task) * w.fields;
+    if (!w.detailed) {
+        o[0] = static_cast<jlong>(w.lanes == 1
+                ? perft_iter_frames<MAX_PERFT_DEPTH>(*w.tables, p, w.depth)
+                : perft_root_share<MAX_PERFT_DEPTH>(*w.tables, p, w.depth, lane, w.lanes));
+        nodes += o[0];
+        return;
+    }
+    PerftCounts c;
+    if (w.lanes == 1) {
+        perft_detailed_iter_frames<MAX_PERFT_DEPTH>(*w.tables, p, w.depth, c);
+    } else {
+        c.nodes = c.captures = c.enPassant = c.castles = c.promotions = c.checks = c.checkmates = 0;
+        perft_detailed_root_share<MAX_PERFT_DEPTH>(*w.tables, p, w.depth, lane, w.lanes, c);
+    }
+    o[0] = static_cast<jlong>(c.nodes);
+    o[1] = static_cast<jlong>(c.captures);
+    o[2] = static_cast<jlong>(c.enPassant);
+    o[3] = static_cast<jlong>(c.castles);
+    o[4] = static_cast<jlong>(c.promotions);
+    o[5] = static_cast<jlong>(c.checks);
+    o[6] = static_cast<jlong>(c.checkmates);
+    nodes += o[0];
+}
+
+void worker_loop(PerftWork& w, int self) {
+    jlong nodes = 0;
+    int task = 0;
+    while (claim(w.ranges[self], task) || steal(w, self, task)) {
+        run_task(w, task, nodes);
+    }
+    w.workerNodes[static_cast<size_t>(self)] = nodes;
+}
+
+// Counts every frontier position on `workers` threads and writes count * fields
+// counters to `result`; workerNodes receives one node total per worker.
+bool host_bulk(const jlong* packed, int count, int depth, bool detailed, int workers, std::vector<jlong>& result,
+               std::vector<jlong>& workerNodes) {
+    PerftWork w;
+    w.tables = &host_tables();
+    w.packed = packed;
+    w.depth = depth;
+    w.detailed = detailed;
+    w.fields = detailed ? DETAIL_FIELDS : 1;
+    // Too few positions to feed the pool: split each one by root move. Depth 1
+    // is a single move generation, not worth a task of its own.
+    const long wanted = static_cast<long>(workers) * TASKS_PER_WORKER;
+    if (depth >= 2 && count < wanted) {
+        w.lanes = static_cast<int>(std::min<long>(MAX_ROOT_LANES, (wanted + count - 1) / count));
+    }
+    const long tasks = static_cast<long>(count) * w.lanes;
+    w.workers = static_cast<int>(std::min<long>(workers, tasks));
+    w.out.assign(static_cast<size_t>(tasks) * w.fields, 0);
+    w.workerNodes.assign(static_cast<size_t>(w.workers), 0);
+    w.ranges.reset(new TaskRange[static_cast<size_t>(w.workers)]);
+    for (int i = 0; i < w.workers; ++i) {
+        w.ranges[i].next = static_cast<int>(tasks * i / w.workers);
+        w.ranges[i].end = static_cast<int>(tasks * (i + 1) / w.workers);
+    }
+
+    if (w.workers == 1) {
+        worker_loop(w, 0);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(static_cast<size_t>(w.workers) - 1);
+        try {
+            for (int i = 1; i < w.workers; ++i) {
+                threads.emplace_back(worker_loop, std::ref(w), i);
+            }
+        } catch (const std::system_error&) {
+            // Fewer threads than asked for: the ones running steal the rest.
+        }
+        worker_loop(w, 0);
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    }
+
+    workerNodes.assign(static_cast<size_t>(workers), 0);
+    std::copy(w.workerNodes.begin(), w.workerNodes.end(), workerNodes.begin());
+    if (w.lanes == 1) {
+        result.swap(w.out);
+        return true;
+    }
+    result.assign(static_cast<size_t>(count) * w.fields, 0);
+    for (long t = 0; t < tasks; ++t) {
+        jlong* dst = result.data() + (t / w.lanes) * w.fields;
+        const jlong* src = w.out.data() + t * w.fields;
+        for (int f = 0; f < w.fields; ++f) {
+            dst[f] += src[f];
+        }
+    }
+    return true;
+}
+
+// Persistent handle matching the GPU session API. The host has no device
+// buffers to keep, so a session only pins the worker count and keeps the
+// per-worker totals of its last call.
+struct PerftSession {
+    int workers = 1;
+    std::vector<jlong> workerNodes;
+};
+
+jlongArray bulk_call(JNIEnv* env, jlongArray packedArray, jint count, jint depth, bool detailed, int workers,
+                     std::vector<jlong>& workerNodes) {
+    if (packedArray == nullptr || count <= 0 || depth < 0 || depth > MAX_PERFT_DEPTH) {
+        return nullptr;
+    }
+    jsize words = env->GetArrayLength(packedArray);
+    if (static_cast<jlong>(words) < static_cast<jlong>(count) * PACK_WORDS) {
+        return nullptr;
+    }
+    const int fields = detailed ? DETAIL_FIELDS : 1;
+    if (static_cast<jlong>(count) * fields > 0x7fffffffL) {
+        return nullptr;
+    }
+    jlong* packed = env->GetLongArrayElements(packedArray, nullptr);
+    if (packed == nullptr) {
+        return nullptr;
+    }
+    std::vector<jlong> host;
+    bool ok = false;
+    try {
+        ok = host_bulk(packed, count, depth, detailed, workers, host, workerNodes);
+    } catch (const std::bad_alloc&) {
+        ok = false;
+    }
+    env->ReleaseLongArrayElements(packedArray, packed, JNI_ABORT);
+    if (!ok) {
+        return nullptr;
+    }
+    jlongArray result = env->NewLongArray(count * fields);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, count * fields, host.data());
+    }
+    return result;
+}
+
+jlongArray bulk_session(JNIEnv* env, jlong handle, jlongArray packedArray, jint count, jint depth,
+        bool detailed) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr) {
+        return nullptr;
+    }
+    return bulk_call(env, packedArray, count, depth, detailed, s->workers, s->workerNodes);
+}
+
+// Expands the split plies below one packed root natively, folds duplicate
+// frontier positions and counts each unique one once; returns the weighted
+// counters followed by {frontier positions, unique positions}.
+jlongArray folded_session(JNIEnv* env, jlong handle, jlongArray rootArray, jint depth, jint split, bool detailed) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr || rootArray == nullptr || depth < 0 || folded_remaining(depth, split) > MAX_PERFT_DEPTH
+            || env->GetArrayLength(rootArray) < PACK_WORDS) {
+        return nullptr;
+    }
+    jlong root[PACK_WORDS];
+    env->GetLongArrayRegion(rootArray, 0, PACK_WORDS, root);
+    const int fields = detailed ? DETAIL_FIELDS : 1;
+    jlong out[DETAIL_FIELDS + FOLD_STATS];
+    bool ok = false;
+    try {
+        ok = folded_perft(reinterpret_cast<const uint64_t*>(root), depth, split, fields,
+                [&](const uint64_t* packed, int count, int remaining, int64_t* counts) {
+                    std::vector<jlong> host;
+                    if (!host_bulk(reinterpret_cast<const jlong*>(packed), count, remaining, detailed, s->workers,
+                                host, s->workerNodes)) {
+                        return false;
+                    }
+                    std::copy(host.begin(), host.end(), counts);
+                    return true;
+                },
+                reinterpret_cast<int64_t*>(out));
+    } catch (const std::bad_alloc&) {
+        ok = false;
+    }
+    if (!ok) {
+        return nullptr;
+    }
+    jlongArray result = env->NewLongArray(fields + FOLD_STATS);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, fields + FOLD_STATS, out);
+    }
+    return result;
+}
+
+} // namespace
+
+extern "C" JNIEXPORT jint JNICALL Java_chess_nn_perft_host_Support_nativeDeviceCount(JNIEnv*, jclass) {
+    return static_cast<jint>(worker_count());
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_host_Backend_nativeBulkPerft(
+        JNIEnv* env, jclass, jlongArray packedArray, jint count, jint depth) {
+    std::vector<jlong> workerNodes;
+    return bulk_call(env, packedArray, count, depth, false, worker_count(), workerNodes);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_host_Backend_nativeBulkPerftDetailed(
+        JNIEnv* env, jclass, jlongArray packedArray, jint count, jint depth) {
+    std::vector<jlong> workerNodes;
+    return bulk_call(env, packedArray, count, depth, true, worker_count(), workerNodes);
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_perft_host_Backend_nativeCreateSession(
+        JNIEnv*, jclass, jint) {
+    PerftSession* s = new (std::nothrow) PerftSession;
+    if (s == nullptr) {
+        return 0;
+    }
+    s->workers = worker_count();
+    host_tables();
+    return reinterpret_cast<jlong>(s);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_host_Backend_nativeSessionBulkPerft(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedArray, jint count, jint depth) {
+    return bulk_session(env, handle, packedArray, count, depth, false);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_host_Backend_nativeSessionBulkPerftDetailed(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedArray, jint count, jint depth) {
+    return bulk_session(env, handle, packedArray, count, depth, true);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_host_Backend_nativeSessionDeviceNodes(
+        JNIEnv* env, jclass, jlong handle) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr) {
+        return nullptr;
+    }
+    jsize n = static_cast<jsize>(s->workerNodes.size());
+    jlongArray result = env->NewLongArray(n);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, n, s->workerNodes.data());
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_host_Backend_nativeSessionFoldedPerft(
+        JNIEnv* env, jclass, jlong handle, jlongArray rootArray, jint depth, jint splitDepth) {
+    return folded_session(env, handle, rootArray, depth, splitDepth, false);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_host_Backend_nativeSessionFoldedPerftDetailed(
+        JNIEnv* env, jclass, jlong handle, jlongArray rootArray, jint depth, jint splitDepth) {
+    return folded_session(env, handle, rootArray, depth, splitDepth, true);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_chess_nn_perft_host_Backend_nativeDestroySession(
+        JNIEnv*, jclass, jlong handle) {
+    delete reinterpret_cast<PerftSession*>(handle);
+}
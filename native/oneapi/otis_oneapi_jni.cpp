@@ -3,9 +3,10 @@
  *
  * Optional oneAPI/SYCL backend for OTIS policy/WDL inference.
  *
- * Mirrors the CUDA/ROCm implementation in native/common/otis_gpu_impl.inl: the
- * board is reconstructed from the encoded simple_18 planes so the typed tactical
- * relation masks can be rebuilt on the host and uploaded, and the OTIS forward
+ * Mirrors the CUDA/ROCm implementation in native/common/otis_gpu_impl.inl: only
+ * the encoded simple_18 planes are uploaded, a first kernel reconstructs the
+ * board and derives the typed tactical relation masks as bit-packed rows with
+ * the native/common/perft_core.h attack primitives, and the OTIS forward
  * pass (square tokens -> typed sheaf trunk -> readout -> policy/WDL heads) runs
  * in SYCL kernels. The per-legal-move policy refinement applied by the Java CPU
  * path is intentionally not reproduced (no legal-move generator), so the
@@ -27,6 +28,13 @@
 #include <string>
 #include <vector>
 
+// The relation masks need only a few slider queries per square, so this unit
+// uses the table-free hyperbola backend of the shared perft primitives.
+#ifndef PERFT_SLIDERS
+#define PERFT_SLIDERS PERFT_SLIDERS_HYPERBOLA
+#endif
+#include "../common/perft_core.h"
+
 namespace {
 
 constexpr int OTIS_MAGIC = 0x5349544F;
@@ -146,7 +154,8 @@ struct Net {
 
     float* dInput = nullptr;
     int* dBoard = nullptr;
-    float* dMasks = nullptr;
+    uint64_t* dMasks = nullptr;
+    crtk_perft::Tables* dTables = nullptr;
     float* tokens = nullptr;
     float* tokTmp = nullptr;
     float* salience = nullptr;
@@ -250,7 +259,7 @@ static void free_net(Net* net) {
             net->triadAW, net->triadTW, net->triadDW, net->triadNormW, net->triadNormB,
             net->readNormW, net->readNormB, net->readHidW, net->readHidB, net->policyW, net->policyB,
             net->wdlW, net->wdlB, net->squareAtlas, net->policyAtlas, net->valueAtlas,
-            net->dInput, net->dBoard, net->dMasks, net->tokens, net->tokTmp, net->salience, net->h,
+            net->dInput, net->dBoard, net->dMasks, net->dTables, net->tokens, net->tokTmp, net->salience, net->h,
             net->stalks, net->stalkDelta, net->update, net->degree, net->node, net->laplacian,
             net->energy, net->gates, net->density, net->srcPressure, net->dstPressure, net->scalars,
             net->trunk, net->hidden, net->policy, net->wdlLogits
@@ -272,7 +281,6 @@ static bool alloc_scratch(Net& net) {
     };
     bool ok =
         allocf(&net.dInput, static_cast<size_t>(INPUT_PLANES) * SQUARES)
-        && allocf(&net.dMasks, static_cast<size_t>(RELATION_COUNT) * SQUARES * SQUARES)
         && allocf(&net.tokens, static_cast<size_t>(SQUARES) * c)
         && allocf(&net.tokTmp, static_cast<size_t>(SQUARES) * c)
         && allocf(&net.salience, SQUARES)
@@ -296,7 +304,15 @@ static bool alloc_scratch(Net& net) {
     if (!ok) return false;
     try {
         net.dBoard = sycl::malloc_device<int>(SQUARES, *net.queue);
-        return net.dBoard != nullptr;
+        net.dMasks = sycl::malloc_device<uint64_t>(static_cast<size_t>(RELATION_COUNT) * SQUARES, *net.queue);
+        net.dTables = sycl::malloc_device<crtk_perft::Tables>(1, *net.queue);
+        if (net.dBoard == nullptr || net.dMasks == nullptr || net.dTables == nullptr) return false;
+        // Step and line-mask tables for the relation-mask kernel (a few KB; the
+        // hyperbola slider backend needs no attack array).
+        crtk_perft::Tables tables;
+        crtk_perft::build_tables(tables);
+        net.queue->memcpy(net.dTables, &tables, sizeof(tables)).wait_and_throw();
+        return true;
     } catch (const sycl::exception&) {
         return false;
     }
@@ -382,11 +398,11 @@ static Net* load_net(const std::string& path) {
     }
 }
 
-// ---- host board reconstruction + typed relation masks (mirror Model.java) ----
+// ---- SYCL device helpers (free functions usable inside kernels) ----
 
-static int piece_from_planes(const std::vector<float>& input, int sq) {
+static inline int dev_piece_from_planes(const float* input, int sq) {
     for (int plane = 0; plane < 12; ++plane) {
-        if (input[static_cast<size_t>(plane) * SQUARES + sq] > 0.5f) {
+        if (input[plane * SQUARES + sq] > 0.5f) {
             int type = plane % 6 + 1;
             return plane < 6 ? type : -type;
         }
@@ -394,259 +410,19 @@ static int piece_from_planes(const std::vector<float>& input, int sq) {
     return P_EMPTY;
 }
 
-static bool is_white(int piece) { return piece > 0; }
-
-static bool is_own(int piece, bool whiteToMove) {
-    return piece != P_EMPTY && is_white(piece) == whiteToMove;
-}
-
-static int square_of(int rank, int file) {
-    return rank >= 0 && rank < 8 && file >= 0 && file < 8 ? (rank << 3) + file : -1;
-}
-
-static int mask_index(int relation, int from, int to) {
-    return (relation * SQUARES + from) * SQUARES + to;
-}
-
-static void set_relation(std::vector<float>& masks, int relation, int from, int to) {
-    if (from != to && from >= 0 && from < SQUARES && to >= 0 && to < SQUARES) {
-        masks[static_cast<size_t>(mask_index(relation, from, to))] = 1.0f;
-    }
-}
-
-static int find_king(const int* board, bool white) {
-    int target = white ? P_KING : -P_KING;
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        if (board[sq] == target) return sq;
-    }
-    return -1;
-}
-
-static void king_zone(int kingSquare, bool* out) {
-    for (int sq = 0; sq < SQUARES; ++sq) out[sq] = false;
-    if (kingSquare < 0) return;
-    int kr = kingSquare >> 3;
-    int kf = kingSquare & 7;
-    for (int sq = 0; sq < SQUARES; ++sq) {
-        int r = sq >> 3;
-        int f = sq & 7;
-        out[sq] = sq != kingSquare && std::max(std::abs(r - kr), std::abs(f - kf)) <= 2;
-    }
-}
-
-static void ray_directions(bool diagonals, bool orthogonals, int dirs[8][2], int& count) {
-    count = 0;
-    if (diagonals && orthogonals) {
-        const int d[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
-        for (int i = 0; i < 8; ++i) { dirs[i][0] = d[i][0]; dirs[i][1] = d[i][1]; }
-        count = 8;
-    } else if (diagonals) {
-        const int d[4][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
-        for (int i = 0; i < 4; ++i) { dirs[i][0] = d[i][0]; dirs[i][1] = d[i][1]; }
-        count = 4;
-    } else {
-        const int d[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
-        for (int i = 0; i < 4; ++i) { dirs[i][0] = d[i][0]; dirs[i][1] = d[i][1]; }
-        count = 4;
-    }
-}
-
-static bool slider_matches(int piece, int dr, int df) {
-    int type = std::abs(piece);
-    bool diagonal = dr != 0 && df != 0;
-    return type == P_QUEEN || (diagonal && type == P_BISHOP) || (!diagonal && type == P_ROOK);
-}
-
-static void add_tactical_edge(std::vector<float>& masks, const int* board, bool own,
-        const bool* nearOwnKing, const bool* nearThemKing, int from, int to) {
-    int target = board[to];
-    if (own) {
-        if (target == P_EMPTY) {
-            if (nearThemKing[to]) set_relation(masks, 4, from, to);
-        } else if (is_white(target) == is_white(board[from])) {
-            set_relation(masks, 2, from, to);
-        } else {
-            set_relation(masks, 0, from, to);
-        }
-    } else {
-        if (target == P_EMPTY) {
-            if (nearOwnKing[to]) set_relation(masks, 5, from, to);
-        } else if (is_white(target) == is_white(board[from])) {
-            set_relation(masks, 3, from, to);
-        } else {
-            set_relation(masks, 1, from, to);
-        }
-    }
-}
-
-static void add_step_relations(std::vector<float>& masks, const int* board, const bool* nearOwnKing,
-        const bool* nearThemKing, int from, bool own, const int deltas[][2], int deltaCount,
-        bool knight, bool pawn) {
-    int rank = from >> 3;
-    int file = from & 7;
-    for (int i = 0; i < deltaCount; ++i) {
-        int to = square_of(rank + deltas[i][0], file + deltas[i][1]);
-        if (to < 0) continue;
-        add_tactical_edge(masks, board, own, nearOwnKing, nearThemKing, from, to);
-        if (knight) set_relation(masks, 9, from, to);
-        if (pawn) set_relation(masks, 10, from, to);
-    }
-}
-
-static void add_ray_relations(std::vector<float>& masks, const int* board, const bool* nearOwnKing,
-        const bool* nearThemKing, int from, bool own, bool diagonals, bool orthogonals) {
-    int dirs[8][2];
-    int count = 0;
-    ray_directions(diagonals, orthogonals, dirs, count);
-    int rank = from >> 3;
-    int file = from & 7;
-    for (int i = 0; i < count; ++i) {
-        int r = rank + dirs[i][0];
-        int f = file + dirs[i][1];
-        while (true) {
-            int to = square_of(r, f);
-            if (to < 0) break;
-            add_tactical_edge(masks, board, own, nearOwnKing, nearThemKing, from, to);
-            if (board[to] != P_EMPTY) break;
-            r += dirs[i][0];
-            f += dirs[i][1];
-        }
-    }
-}
-
-static void add_pawn_relations(std::vector<float>& masks, const int* board, const bool* nearOwnKing,
-        const bool* nearThemKing, int from, int piece, bool own) {
-    int direction = is_white(piece) ? 1 : -1;
-    int rank = from >> 3;
-    int file = from & 7;
-    const int offsets[2] = {-1, 1};
-    for (int o = 0; o < 2; ++o) {
-        int to = square_of(rank + direction, file + offsets[o]);
-        if (to >= 0) {
-            add_tactical_edge(masks, board, own, nearOwnKing, nearThemKing, from, to);
-            set_relation(masks, 10, from, to);
-        }
+// Squares within Chebyshev distance 2 of the king, excluding the king itself.
+static inline uint64_t dev_king_zone(const crtk_perft::Tables& t, int king) {
+    if (king < 0) return 0;
+    uint64_t ring = t.king[king];
+    uint64_t zone = ring;
+    while (ring) {
+        int sq = crtk_perft::ctz64(ring);
+        ring &= ring - 1;
+        zone |= t.king[sq];
     }
+    return zone & ~(1ULL << king);
 }
 
-static void add_visible_ray_mask(std::vector<float>& masks, const int* board, int from, int relation,
-        bool diagonals, bool orthogonals) {
-    int dirs[8][2];
-    int count = 0;
-    ray_directions(diagonals, orthogonals, dirs, count);
-    int rank = from >> 3;
-    int file = from & 7;
-    for (int i = 0; i < count; ++i) {
-        int r = rank + dirs[i][0];
-        int f = file + dirs[i][1];
-        while (true) {
-            int to = square_of(r, f);
-            if (to < 0) break;
-            set_relation(masks, relation, from, to);
-            if (board[to] != P_EMPTY) break;
-            r += dirs[i][0];
-            f += dirs[i][1];
-        }
-    }
-}
-
-static void add_slider_relation_masks(std::vector<float>& masks, const int* board, int from, int piece) {
-    int type = std::abs(piece);
-    if (type == P_BISHOP || type == P_QUEEN) {
-        add_visible_ray_mask(masks, board, from, type == P_BISHOP ? 6 : 8, true, false);
-    }
-    if (type == P_ROOK || type == P_QUEEN) {
-        add_visible_ray_mask(masks, board, from, type == P_ROOK ? 7 : 8, false, true);
-    }
-}
-
-static void add_pin_relations(std::vector<float>& masks, const int* board, bool whiteKing) {
-    int king = find_king(board, whiteKing);
-    if (king < 0) return;
-    int rank = king >> 3;
-    int file = king & 7;
-    int dirs[8][2];
-    int count = 0;
-    ray_directions(true, true, dirs, count);
-    for (int i = 0; i < count; ++i) {
-        int blocker = -1;
-        int r = rank + dirs[i][0];
-        int f = file + dirs[i][1];
-        while (true) {
-            int sq = square_of(r, f);
-            if (sq < 0) break;
-            int piece = board[sq];
-            if (piece != P_EMPTY) {
-                if (blocker < 0) {
-                    if (is_white(piece) == whiteKing) {
-                        blocker = sq;
-                    } else {
-                        break;
-                    }
-                } else {
-                    if (is_white(piece) != whiteKing && slider_matches(piece, dirs[i][0], dirs[i][1])) {
-                        set_relation(masks, 11, sq, blocker);
-                    }
-                    break;
-                }
-            }
-            r += dirs[i][0];
-            f += dirs[i][1];
-        }
-    }
-}
-
-static void add_piece_relations(std::vector<float>& masks, const int* board, bool whiteToMove,
-        const bool* nearOwnKing, const bool* nearThemKing, int from, int piece) {
-    int type = std::abs(piece);
-    bool own = is_own(piece, whiteToMove);
-    switch (type) {
-        case P_PAWN:
-            add_pawn_relations(masks, board, nearOwnKing, nearThemKing, from, piece, own);
-            break;
-        case P_KNIGHT: {
-            const int deltas[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
-            add_step_relations(masks, board, nearOwnKing, nearThemKing, from, own, deltas, 8, true, false);
-            break;
-        }
-        case P_BISHOP:
-            add_ray_relations(masks, board, nearOwnKing, nearThemKing, from, own, true, false);
-            break;
-        case P_ROOK:
-            add_ray_relations(masks, board, nearOwnKing, nearThemKing, from, own, false, true);
-            break;
-        case P_QUEEN:
-            add_ray_relations(masks, board, nearOwnKing, nearThemKing, from, own, true, true);
-            break;
-        case P_KING: {
-            const int deltas[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
-            add_step_relations(masks, board, nearOwnKing, nearThemKing, from, own, deltas, 8, false, false);
-            break;
-        }
-        default:
-            break;
-    }
-}
-
-static std::vector<float> build_relation_masks(const int* board, bool whiteToMove) {
-    std::vector<float> masks(static_cast<size_t>(RELATION_COUNT) * SQUARES * SQUARES, 0.0f);
-    bool nearOwnKing[SQUARES];
-    bool nearThemKing[SQUARES];
-    king_zone(find_king(board, whiteToMove), nearOwnKing);
-    king_zone(find_king(board, !whiteToMove), nearThemKing);
-    for (int from = 0; from < SQUARES; ++from) {
-        int piece = board[from];
-        if (piece == P_EMPTY) continue;
-        add_piece_relations(masks, board, whiteToMove, nearOwnKing, nearThemKing, from, piece);
-        add_slider_relation_masks(masks, board, from, piece);
-    }
-    add_pin_relations(masks, board, true);
-    add_pin_relations(masks, board, false);
-    return masks;
-}
-
-// ---- SYCL device helpers (free functions usable inside kernels) ----
-
 static inline float dev_gelu(float x) {
     return 0.5f * x * (1.0f + sycl::tanh(0.7978845608028654f * (x + 0.044715f * x * x * x)));
 }
@@ -684,10 +460,7 @@ static inline float dev_matrix_response(const float* matrix, const float* values
 
 static bool predict(Net& net, const std::vector<float>& encoded,
         std::vector<float>& policy, std::vector<float>& wdl) {
-    int board[SQUARES];
     bool whiteToMoveHost = encoded[12 * SQUARES] > 0.5f;
-    for (int sq = 0; sq < SQUARES; ++sq) board[sq] = piece_from_planes(encoded, sq);
-    std::vector<float> masks = build_relation_masks(board, whiteToMoveHost);
 
     sycl::queue& q = *net.queue;
     const int c = net.channels;
@@ -699,7 +472,8 @@ static bool predict(Net& net, const std::vector<float>& encoded,
     // Device pointers (captured by value in kernels).
     float* input = net.dInput;
     int* dBoard = net.dBoard;
-    float* dMasks = net.dMasks;
+    uint64_t* dMasks = net.dMasks;
+    const crtk_perft::Tables* dTables = net.dTables;
     float* tokens = net.tokens;
     float* tokTmp = net.tokTmp;
     float* salience = net.salience;
@@ -768,14 +542,94 @@ static bool predict(Net& net, const std::vector<float>& encoded,
 
     try {
         q.memcpy(input, encoded.data(), encoded.size() * sizeof(float)).wait_and_throw();
-        q.memcpy(dBoard, board, sizeof(board)).wait_and_throw();
-        q.memcpy(dMasks, masks.data(), masks.size() * sizeof(float)).wait_and_throw();
         q.memset(energy, 0, RELATION_COUNT * sizeof(float)).wait_and_throw();
         q.memset(gates, 0, RELATION_COUNT * sizeof(float)).wait_and_throw();
         q.memset(density, 0, RELATION_COUNT * sizeof(float)).wait_and_throw();
         q.memset(srcPressure, 0, RELATION_COUNT * SQUARES * sizeof(float)).wait_and_throw();
         q.memset(dstPressure, 0, RELATION_COUNT * SQUARES * sizeof(float)).wait_and_throw();
 
+        // Board + typed relation masks (mirror Model.java): one work-item per
+        // from-square. Row (relation, from) of dMasks is a bitboard of the `to`
+        // squares; OTIS squares use the perft_core order (a8 = 0), so the perft
+        // attack tables apply to the decoded board unchanged.
+        q.submit([&](sycl::handler& cgh) {
+            sycl::local_accessor<int, 1> board(sycl::range<1>(SQUARES), cgh);
+            sycl::local_accessor<uint64_t, 1> colour(sycl::range<1>(2), cgh); // white, black occupancy
+            sycl::local_accessor<int, 1> kings(sycl::range<1>(2), cgh);       // first white / black king
+            cgh.parallel_for(sycl::nd_range<1>(sycl::range<1>(SQUARES), sycl::range<1>(SQUARES)),
+                    [=](sycl::nd_item<1> item) {
+                int from = static_cast<int>(item.get_local_id(0));
+                int piece = dev_piece_from_planes(input, from);
+                board[from] = piece;
+                dBoard[from] = piece;
+                sycl::group_barrier(item.get_group());
+                if (from == 0) {
+                    uint64_t white = 0;
+                    uint64_t black = 0;
+                    kings[0] = -1;
+                    kings[1] = -1;
+                    for (int sq = 0; sq < SQUARES; ++sq) {
+                        int code = board[sq];
+                        if (code > 0) white |= 1ULL << sq;
+                        if (code < 0) black |= 1ULL << sq;
+                        if (code == P_KING && kings[0] < 0) kings[0] = sq;
+                        if (code == -P_KING && kings[1] < 0) kings[1] = sq;
+                    }
+                    colour[0] = white;
+                    colour[1] = black;
+                }
+                sycl::group_barrier(item.get_group());
+
+                uint64_t rows[RELATION_COUNT];
+                for (int r = 0; r < RELATION_COUNT; ++r) rows[r] = 0;
+                if (piece != P_EMPTY) {
+                    const crtk_perft::Tables& t = *dTables;
+                    bool white = piece > 0;
+                    int type = white ? piece : -piece;
+                    uint64_t same = colour[white ? 0 : 1];
+                    uint64_t enemy = colour[white ? 1 : 0];
+                    uint64_t occ = same | enemy;
+                    uint64_t diag = type == P_BISHOP || type == P_QUEEN ? crtk_perft::bishop_attacks(t, from, occ) : 0;
+                    uint64_t orth = type == P_ROOK || type == P_QUEEN ? crtk_perft::rook_attacks(t, from, occ) : 0;
+                    uint64_t reach = diag | orth;
+                    if (type == P_PAWN) {
+                        reach = white ? t.wPawn[from] : t.bPawn[from];
+                        rows[10] = reach;
+                    } else if (type == P_KNIGHT) {
+                        reach = t.knight[from];
+                        rows[9] = reach;
+                    } else if (type == P_KING) {
+                        reach = t.king[from];
+                    }
+                    rows[6] = type == P_BISHOP ? diag : 0;
+                    rows[7] = type == P_ROOK ? orth : 0;
+                    rows[8] = type == P_QUEEN ? reach : 0;
+
+                    // Both "near king" zones are the zone of the king opposite this piece.
+                    int king = kings[white ? 1 : 0];
+                    bool own = white == (whiteToMove != 0);
+                    rows[own ? 0 : 1] = reach & enemy;
+                    rows[own ? 2 : 3] = reach & same;
+                    rows[own ? 4 : 5] = reach & ~occ & dev_king_zone(t, king);
+
+                    // Pin: exactly one piece, of the king's colour, between the
+                    // opposing king and a slider that moves along that line.
+                    if (king >= 0 && type >= P_BISHOP && type <= P_QUEEN) {
+                        uint64_t bit = 1ULL << from;
+                        bool onOrth = (crtk_perft::rook_attacks(t, king, 0) & bit) != 0;
+                        bool onDiag = (crtk_perft::bishop_attacks(t, king, 0) & bit) != 0;
+                        if ((onOrth && type != P_BISHOP) || (onDiag && type != P_ROOK)) {
+                            uint64_t blockers = crtk_perft::squares_between(t, king, from) & occ;
+                            if (blockers != 0 && (blockers & (blockers - 1)) == 0 && (blockers & enemy) != 0) {
+                                rows[11] = blockers;
+                            }
+                        }
+                    }
+                }
+                for (int r = 0; r < RELATION_COUNT; ++r) dMasks[r * SQUARES + from] = rows[r];
+            });
+        }).wait_and_throw();
+
         // Square tokens.
         q.parallel_for(sycl::range<1>(SQUARES), [=](sycl::id<1> id) {
             int sq = static_cast<int>(id[0]);
@@ -900,13 +754,14 @@ static bool predict(Net& net, const std::vector<float>& encoded,
                     int edgeCount = 0;
                     float energySum = 0.0f;
                     for (int from = 0; from < SQUARES; ++from) {
-                        for (int to = 0; to < SQUARES; ++to) {
-                            float edge = dMasks[mask_index(relation, from, to)];
-                            if (edge <= 0.0f) continue;
+                        uint64_t row = dMasks[relation * SQUARES + from];
+                        while (row) {
+                            int to = crtk_perft::ctz64(row);
+                            row &= row - 1;
                             edgeCount++;
                             if (block == 0) {
-                                srcPressure[relation * SQUARES + from] += edge;
-                                dstPressure[relation * SQUARES + to] += edge;
+                                srcPressure[relation * SQUARES + from] += 1.0f;
+                                dstPressure[relation * SQUARES + to] += 1.0f;
                             }
                             const float* sStalk = stalks + static_cast<size_t>(from) * STALK_DIM;
                             const float* dStalk = stalks + static_cast<size_t>(to) * STALK_DIM;
@@ -926,7 +781,7 @@ static bool predict(Net& net, const std::vector<float>& encoded,
                                 residual[dim] = value;
                                 norm += value * value;
                             }
-                            energySum += edge * norm;
+                            energySum += norm;
                             for (int j = 0; j < STALK_DIM; ++j) {
                                 float sb = 0.0f;
                                 float db = 0.0f;
@@ -937,7 +792,7 @@ static bool predict(Net& net, const std::vector<float>& encoded,
                                 srcBack[j] = sb;
                                 dstBack[j] = db;
                             }
-                            float scaled = gate * edge;
+                            float scaled = gate;
                             for (int dim = 0; dim < STALK_DIM; ++dim) {
                                 update[from * STALK_DIM + dim] += scaled * sign * srcBack[dim];
                                 update[to * STALK_DIM + dim] -= scaled * dstBack[dim];
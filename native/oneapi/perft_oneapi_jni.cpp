@@ -9,18 +9,34 @@
  * sycl::parallel_for. perft_iter is recursion-free, which SYCL device code
  * requires. Each work-item unpacks one frontier position and counts
  * perft(remainingDepth); the host sums the results.
+ *
+ * nativeCreateSession mirrors the CUDA/ROCm session handle: it spans every
+ * Intel GPU, keeps the tables resident in each device's memory, and reuses two
+ * chunk slots per device (pinned host staging, device buffers and an in-order
+ * queue each). One host thread per device claims chunks from a shared counter
+ * and alternates its slots, so uploads overlap kernels and fast devices take
+ * more of the frontier. nativeSessionDeviceNodes reports per-device node
+ * totals of the last call. nativeSessionFoldedPerft(Detailed) expands the
+ * frontier from a packed root on the host and sends each distinct position
+ * once, weighted by how often it was reached (perft_frontier.h).
  */
 
 #include <jni.h>
 #include <sycl/sycl.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "../common/perft_core.h"
+#include "../common/perft_frontier.h"
 
 namespace {
 
@@ -56,6 +72,327 @@ std::vector<sycl::device> intel_gpus() {
     return out;
 }
 
+constexpr int DETAIL_FIELDS = 7;
+
+// Aim for this many chunks per device so dynamic assignment can rebalance.
+constexpr int CHUNKS_PER_DEVICE = 8;
+
+// Smallest chunk worth a launch when the frontier is split across devices.
+constexpr int MIN_CHUNK = 1024;
+
+// Copies `tables` to the queue's device and returns the device copy (null on
+// allocation failure). The slider attack array (PERFT_SLIDERS) goes into its
+// own device allocation, returned through `sliders` for the caller to free,
+// and the device Tables points at it.
+Tables* upload_tables(sycl::queue& q, const Tables& tables, uint64_t** sliders) {
+    *sliders = nullptr;
+    Tables installed = tables;
+    if (tables.sliderAttacks != nullptr) {
+        *sliders = sycl::malloc_device<uint64_t>(SLIDER_ATTACK_WORDS, q);
+        if (*sliders == nullptr) {
+            return nullptr;
+        }
+        q.memcpy(*sliders, tables.sliderAttacks, SLIDER_ATTACK_WORDS * sizeof(uint64_t)).wait_and_throw();
+        installed.sliderAttacks = *sliders;
+    }
+    Tables* dTables = sycl::malloc_device<Tables>(1, q);
+    if (dTables != nullptr) {
+        q.memcpy(dTables, &installed, sizeof(Tables)).wait_and_throw();
+    }
+    return dTables;
+}
+
+// Per-device session state: tables, two chunk slots (each with its own
+// in-order queue) and the node total of the last call.
+struct PerftDevice {
+    sycl::queue* queue[2] = {};
+    Tables* dTables = nullptr;
+    uint64_t* dSliders = nullptr;
+    uint64_t* hPacked[2] = {};
+    unsigned long long* hCounts[2] = {};
+    uint64_t* dPacked[2] = {};
+    unsigned long long* dCounts[2] = {};
+    sycl::event done[2];
+    unsigned long long nodes = 0;
+};
+
+// Persistent session spanning every Intel GPU; see the file header.
+struct PerftSession {
+    int capacity = 0;
+    std::vector<PerftDevice> devices;
+};
+
+void release_device(PerftDevice& d) {
+    try {
+        for (int b = 0; b < 2; ++b) {
+            sycl::queue* q = d.queue[b];
+            if (q == nullptr) {
+                continue;
+            }
+            q->wait();
+            if (d.hPacked[b] != nullptr) sycl::free(d.hPacked[b], *q);
+            if (d.hCounts[b] != nullptr) sycl::free(d.hCounts[b], *q);
+            if (d.dPacked[b] != nullptr) sycl::free(d.dPacked[b], *q);
+            if (d.dCounts[b] != nullptr) sycl::free(d.dCounts[b], *q);
+        }
+        if (d.dTables != nullptr && d.queue[0] != nullptr) {
+            sycl::free(d.dTables, *d.queue[0]);
+        }
+        if (d.dSliders != nullptr && d.queue[0] != nullptr) {
+            sycl::free(d.dSliders, *d.queue[0]);
+        }
+    } catch (const sycl::exception&) {
+        // Teardown is best effort.
+    }
+    delete d.queue[0];
+    delete d.queue[1];
+}
+
+void destroy_session(PerftSession* s) {
+    if (s == nullptr) {
+        return;
+    }
+    for (PerftDevice& d : s->devices) {
+        release_device(d);
+    }
+    delete s;
+}
+
+bool init_device(PerftDevice& d, const sycl::device& dev, const Tables& tables, int capacity) {
+    size_t packedCount = static_cast<size_t>(capacity) * PACK_WORDS;
+    size_t countCount = static_cast<size_t>(capacity) * DETAIL_FIELDS;
+    try {
+        sycl::context ctx(dev);
+        for (int b = 0; b < 2; ++b) {
+            d.queue[b] = new sycl::queue(ctx, dev, sycl::property::queue::in_order());
+        }
+        sycl::queue& q = *d.queue[0];
+        d.dTables = upload_tables(q, tables, &d.dSliders);
+        if (d.dTables == nullptr) {
+            return false;
+        }
+        for (int b = 0; b < 2; ++b) {
+            d.hPacked[b] = sycl::malloc_host<uint64_t>(packedCount, q);
+            d.hCounts[b] = sycl::malloc_host<unsigned long long>(countCount, q);
+            d.dPacked[b] = sycl::malloc_device<uint64_t>(packedCount, q);
+            d.dCounts[b] = sycl::malloc_device<unsigned long long>(countCount, q);
+            if (d.hPacked[b] == nullptr || d.hCounts[b] == nullptr
+                    || d.dPacked[b] == nullptr || d.dCounts[b] == nullptr) {
+                return false;
+            }
+        }
+    } catch (const sycl::exception&) {
+        return false;
+    }
+    return true;
+}
+
+PerftSession* create_session(int capacity) {
+    if (capacity <= 0) {
+        return nullptr;
+    }
+    auto devices = intel_gpus();
+    if (devices.empty()) {
+        return nullptr;
+    }
+    Tables tables;
+    build_tables(tables);
+    PerftSession* s = new PerftSession();
+    s->capacity = capacity;
+    s->devices.resize(devices.size());
+    for (size_t i = 0; i < devices.size(); ++i) {
+        if (!init_device(s->devices[i], devices[i], tables, capacity)) {
+            destroy_session(s);
+            return nullptr;
+        }
+    }
+    return s;
+}
+
+// Shared work queue for one session call; see perft_gpu_impl.inl.
+struct PerftWork {
+    const jlong* packed;
+    jlong* out;
+    int count;
+    int depth;
+    int chunk;
+    int chunks;
+    bool detailed;
+    std::atomic<int> next{0};
+    std::atomic<bool> failed{false};
+};
+
+// Double-buffered chunk loop for one device, same schedule as the CUDA/ROCm
+// path: a slot is drained into `out` before it is restaged for the next
+// claimed chunk.
+void device_bulk(PerftDevice& d, PerftWork& w) {
+    const int fields = w.detailed ? DETAIL_FIELDS : 1;
+    d.nodes = 0;
+    int first[2] = {0, 0};
+    int size[2] = {0, 0};
+    try {
+        auto drain = [&](int b) {
+            if (size[b] == 0) {
+                return;
+            }
+            d.done[b].wait_and_throw();
+            std::memcpy(w.out + static_cast<size_t>(first[b]) * fields, d.hCounts[b],
+                    static_cast<size_t>(size[b]) * fields * sizeof(unsigned long long));
+            for (int i = 0; i < size[b]; ++i) {
+                d.nodes += d.hCounts[b][static_cast<size_t>(i) * fields];
+            }
+            size[b] = 0;
+        };
+        for (int b = 0; !w.failed; b ^= 1) {
+            int k = w.next.fetch_add(1);
+            if (k >= w.chunks) {
+                break;
+            }
+            drain(b);
+            int start = k * w.chunk;
+            int n = std::min(w.chunk, w.count - start);
+            sycl::queue& q = *d.queue[b];
+            std::memcpy(d.hPacked[b], w.packed + static_cast<size_t>(start) * PACK_WORDS,
+                    static_cast<size_t>(n) * PACK_WORDS * sizeof(uint64_t));
+            q.memcpy(d.dPacked[b], d.hPacked[b], static_cast<size_t>(n) * PACK_WORDS * sizeof(uint64_t));
+            const uint64_t* dPacked = d.dPacked[b];
+            const Tables* dTables = d.dTables;
+            unsigned long long* dCounts = d.dCounts[b];
+            int remaining = w.depth;
+            if (w.detailed) {
+                q.parallel_for(sycl::range<1>(static_cast<size_t>(n)), [=](sycl::id<1> id) {
+                    int i = static_cast<int>(id[0]);
+                    Position p;
+                    unpack_position(dPacked + static_cast<long>(i) * PACK_WORDS, p);
+                    PerftCounts c;
+                    perft_detailed_iter(*dTables, p, remaining, c);
+                    unsigned long long* o = dCounts + static_cast<long>(i) * DETAIL_FIELDS;
+                    o[0] = c.nodes;
+                    o[1] = c.captures;
+                    o[2] = c.enPassant;
+                    o[3] = c.castles;
+                    o[4] = c.promotions;
+                    o[5] = c.checks;
+                    o[6] = c.checkmates;
+                });
+            } else {
+                q.parallel_for(sycl::range<1>(static_cast<size_t>(n)), [=](sycl::id<1> id) {
+                    int i = static_cast<int>(id[0]);
+                    Position p;
+                    unpack_position(dPacked + static_cast<long>(i) * PACK_WORDS, p);
+                    dCounts[i] = static_cast<unsigned long long>(perft_iter(*dTables, p, remaining));
+                });
+            }
+            d.done[b] = q.memcpy(d.hCounts[b], dCounts,
+                    static_cast<size_t>(n) * fields * sizeof(unsigned long long));
+            first[b] = start;
+            size[b] = n;
+        }
+        drain(0);
+        drain(1);
+    } catch (const sycl::exception&) {
+        w.failed = true;
+    }
+}
+
+// Spreads one frontier across every session device with one host thread per
+// device pulling chunks from a shared counter.
+bool session_bulk(PerftSession& s, const jlong* packed, int count, int depth, bool detailed, jlong* out) {
+    int devices = static_cast<int>(s.devices.size());
+    long perDevice = static_cast<long>(devices) * CHUNKS_PER_DEVICE;
+    long target = (static_cast<long>(count) + perDevice - 1) / perDevice;
+    int chunk = static_cast<int>(std::min<long>(s.capacity, std::max<long>(MIN_CHUNK, target)));
+    PerftWork w;
+    w.packed = packed;
+    w.out = out;
+    w.count = count;
+    w.depth = depth;
+    w.chunk = chunk;
+    w.chunks = (count + chunk - 1) / chunk;
+    w.detailed = detailed;
+
+    int active = std::min(devices, w.chunks);
+    for (int i = active; i < devices; ++i) {
+        s.devices[static_cast<size_t>(i)].nodes = 0;
+    }
+    if (active == 1) {
+        device_bulk(s.devices.front(), w);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<size_t>(active));
+        for (int i = 0; i < active; ++i) {
+            workers.emplace_back(device_bulk, std::ref(s.devices[static_cast<size_t>(i)]), std::ref(w));
+        }
+        for (std::thread& t : workers) {
+            t.join();
+        }
+    }
+    return !w.failed;
+}
+
+jlongArray bulk_session(JNIEnv* env, jlong handle, jlongArray packedArray, jint count, jint depth,
+        bool detailed) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr || packedArray == nullptr || count <= 0 || depth < 0) {
+        return nullptr;
+    }
+    jsize words = env->GetArrayLength(packedArray);
+    if (static_cast<jlong>(words) < static_cast<jlong>(count) * PACK_WORDS) {
+        return nullptr;
+    }
+    jlong* packed = env->GetLongArrayElements(packedArray, nullptr);
+    if (packed == nullptr) {
+        return nullptr;
+    }
+    const int fields = detailed ? DETAIL_FIELDS : 1;
+    std::vector<jlong> host(static_cast<size_t>(count) * fields);
+    bool ok = session_bulk(*s, packed, count, depth, detailed, host.data());
+    env->ReleaseLongArrayElements(packedArray, packed, JNI_ABORT);
+    if (!ok) {
+        return nullptr;
+    }
+    jlongArray result = env->NewLongArray(count * fields);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, count * fields, host.data());
+    }
+    return result;
+}
+
+// Expands the split plies below one packed root on the host, folds duplicate
+// frontier positions (perft_frontier.h) and counts each unique one once across
+// the session's devices; returns the weighted counters followed by
+// {frontier positions, unique positions}.
+jlongArray folded_session(JNIEnv* env, jlong handle, jlongArray rootArray, jint depth, jint split, bool detailed) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr || rootArray == nullptr || depth < 0 || folded_remaining(depth, split) > MAX_PERFT_DEPTH
+            || env->GetArrayLength(rootArray) < PACK_WORDS) {
+        return nullptr;
+    }
+    jlong root[PACK_WORDS];
+    env->GetLongArrayRegion(rootArray, 0, PACK_WORDS, root);
+    const int fields = detailed ? DETAIL_FIELDS : 1;
+    jlong out[DETAIL_FIELDS + FOLD_STATS];
+    bool ok = false;
+    try {
+        ok = folded_perft(reinterpret_cast<const uint64_t*>(root), depth, split, fields,
+                [&](const uint64_t* packed, int count, int remaining, int64_t* counts) {
+                    return session_bulk(*s, reinterpret_cast<const jlong*>(packed), count, remaining, detailed,
+                            reinterpret_cast<jlong*>(counts));
+                },
+                reinterpret_cast<int64_t*>(out));
+    } catch (const std::bad_alloc&) {
+        ok = false;
+    }
+    if (!ok) {
+        return nullptr;
+    }
+    jlongArray result = env->NewLongArray(fields + FOLD_STATS);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, fields + FOLD_STATS, out);
+    }
+    return result;
+}
+
 } // namespace
 
 extern "C" JNIEXPORT jint JNICALL Java_chess_nn_perft_oneapi_Support_nativeDeviceCount(JNIEnv*, jclass) {
@@ -91,11 +428,11 @@ extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativ
         sycl::queue q(devices.front());
         size_t packedCount = static_cast<size_t>(count) * PACK_WORDS;
         uint64_t* dPacked = sycl::malloc_device<uint64_t>(packedCount, q);
-        Tables* dTables = sycl::malloc_device<Tables>(1, q);
+        uint64_t* dSliders = nullptr;
+        Tables* dTables = upload_tables(q, tables, &dSliders);
         unsigned long long* dCounts = sycl::malloc_device<unsigned long long>(static_cast<size_t>(count), q);
         if (dPacked != nullptr && dTables != nullptr && dCounts != nullptr) {
             q.memcpy(dPacked, packed, packedCount * sizeof(uint64_t)).wait_and_throw();
-            q.memcpy(dTables, &tables, sizeof(Tables)).wait_and_throw();
             int remaining = depth;
             q.parallel_for(sycl::range<1>(static_cast<size_t>(count)), [=](sycl::id<1> id) {
                 int i = static_cast<int>(id[0]);
@@ -108,6 +445,7 @@ extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativ
         }
         if (dPacked != nullptr) sycl::free(dPacked, q);
         if (dTables != nullptr) sycl::free(dTables, q);
+        if (dSliders != nullptr) sycl::free(dSliders, q);
         if (dCounts != nullptr) sycl::free(dCounts, q);
     } catch (const sycl::exception&) {
         ok = false;
@@ -155,12 +493,12 @@ extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativ
         sycl::queue q(devices.front());
         size_t packedCount = static_cast<size_t>(count) * PACK_WORDS;
         uint64_t* dPacked = sycl::malloc_device<uint64_t>(packedCount, q);
-        Tables* dTables = sycl::malloc_device<Tables>(1, q);
+        uint64_t* dSliders = nullptr;
+        Tables* dTables = upload_tables(q, tables, &dSliders);
         unsigned long long* dCounts =
                 sycl::malloc_device<unsigned long long>(static_cast<size_t>(count) * fields, q);
         if (dPacked != nullptr && dTables != nullptr && dCounts != nullptr) {
             q.memcpy(dPacked, packed, packedCount * sizeof(uint64_t)).wait_and_throw();
-            q.memcpy(dTables, &tables, sizeof(Tables)).wait_and_throw();
             int remaining = depth;
             q.parallel_for(sycl::range<1>(static_cast<size_t>(count)), [=](sycl::id<1> id) {
                 int i = static_cast<int>(id[0]);
@@ -183,6 +521,7 @@ extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativ
         }
         if (dPacked != nullptr) sycl::free(dPacked, q);
         if (dTables != nullptr) sycl::free(dTables, q);
+        if (dSliders != nullptr) sycl::free(dSliders, q);
         if (dCounts != nullptr) sycl::free(dCounts, q);
     } catch (const sycl::exception&) {
         ok = false;
@@ -199,3 +538,50 @@ extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativ
     }
     return result;
 }
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_perft_oneapi_Backend_nativeCreateSession(
+        JNIEnv*, jclass, jint capacity) {
+    return reinterpret_cast<jlong>(create_session(static_cast<int>(capacity)));
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativeSessionBulkPerft(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedArray, jint count, jint depth) {
+    return bulk_session(env, handle, packedArray, count, depth, false);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativeSessionBulkPerftDetailed(
+        JNIEnv* env, jclass, jlong handle, jlongArray packedArray, jint count, jint depth) {
+    return bulk_session(env, handle, packedArray, count, depth, true);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativeSessionDeviceNodes(
+        JNIEnv* env, jclass, jlong handle) {
+    PerftSession* s = reinterpret_cast<PerftSession*>(handle);
+    if (s == nullptr) {
+        return nullptr;
+    }
+    std::vector<jlong> nodes;
+    for (const PerftDevice& d : s->devices) {
+        nodes.push_back(static_cast<jlong>(d.nodes));
+    }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(nodes.size()));
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, static_cast<jsize>(nodes.size()), nodes.data());
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativeSessionFoldedPerft(
+        JNIEnv* env, jclass, jlong handle, jlongArray rootArray, jint depth, jint splitDepth) {
+    return folded_session(env, handle, rootArray, depth, splitDepth, false);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL Java_chess_nn_perft_oneapi_Backend_nativeSessionFoldedPerftDetailed(
+        JNIEnv* env, jclass, jlong handle, jlongArray rootArray, jint depth, jint splitDepth) {
+    return folded_session(env, handle, rootArray, depth, splitDepth, true);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_chess_nn_perft_oneapi_Backend_nativeDestroySession(
+        JNIEnv*, jclass, jlong handle) {
+    destroy_session(reinterpret_cast<PerftSession*>(handle));
+}
@@ -3,24 +3,41 @@
  *
  * oneAPI backend for the T5 tag-to-text pipeline.
  *
+ * Weights stay resident on the device. Each request encodes its prompts in
+ * one padded pass, projects the cross-attention K/V once, then runs greedy
+ * decoder steps against a per-prompt self-attention K/V cache, so only the
+ * next token ids cross back to the host per step. Large requests are decoded in
+ * groups of CRTK_T5_ONEAPI_BATCH prompts (default 32) that reuse one
+ * workspace, which bounds the K/V cache. GEMMs use oneMKL when the
+ * build finds it (CRTK_T5_ONEAPI_MKL) and a tiled SYCL kernel otherwise.
+ *
  * Exposes:
  *   - chess.nn.t5.oneapi.Support.nativeDeviceCount() -> int
  *   - chess.nn.t5.oneapi.Kernels.nativeMatmul(...) -> boolean
  *   - chess.nn.t5.oneapi.Backend.nativeCreate(String) -> long
  *   - chess.nn.t5.oneapi.Backend.nativeDestroy(long) -> void
  *   - chess.nn.t5.oneapi.Backend.nativeGenerateIds(long, int[], int) -> int[]
+ *   - chess.nn.t5.oneapi.Backend.nativeGenerateIdsBatch(long, int[], int[], int) -> int[]
  */
 
 #include <jni.h>
 
 #include <sycl/sycl.hpp>
+#ifdef CRTK_T5_ONEAPI_MKL
+#include <oneapi/mkl/blas.hpp>
+#endif
 
 #include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 static std::string to_lower(std::string v) {
@@ -151,13 +168,1024 @@ extern "C" JNIEXPORT jboolean JNICALL Java_chess_nn_t5_oneapi_Kernels_nativeMatm
     return ok ? JNI_TRUE : JNI_FALSE;
 }
 
-extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_t5_oneapi_Backend_nativeCreate(JNIEnv*, jclass, jstring) {
-    return 0;
+
+// -------------------------
+// T5 oneAPI backend (native)
+// -------------------------
+
+struct T5Config {
+    int vocabSize = 0;
+    int dModel = 0;
+    int dKv = 0;
+    int dFf = 0;
+    int numLayers = 0;
+    int numDecoderLayers = 0;
+    int numHeads = 0;
+    int relBuckets = 0;
+    int relMaxDistance = 0;
+    int padId = 0;
+    int eosId = 0;
+    int decoderStartId = 0;
+    int unkId = 0;
+    bool gatedGelu = false;
+    float layerNormEps = 1e-6f;
+};
+
+struct HostTensor {
+    std::vector<float> data;
+    std::vector<int> shape;
+};
+
+struct HostModel {
+    T5Config cfg;
+    std::unordered_map<std::string, HostTensor> tensors;
+};
+
+// ---- file parsing helpers ----
+
+static bool read_bytes(std::ifstream& f, void* dst, size_t n) {
+    f.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n));
+    return bool(f);
+}
+
+static bool read_i32_be(std::ifstream& f, int32_t& out) {
+    uint8_t b[4];
+    if (!read_bytes(f, b, 4)) return false;
+    out = (static_cast<int32_t>(b[0]) << 24) | (static_cast<int32_t>(b[1]) << 16) |
+          (static_cast<int32_t>(b[2]) << 8) | static_cast<int32_t>(b[3]);
+    return true;
+}
+
+static bool read_f32_be(std::ifstream& f, float& out) {
+    int32_t i = 0;
+    if (!read_i32_be(f, i)) return false;
+    uint32_t u = static_cast<uint32_t>(i);
+    std::memcpy(&out, &u, sizeof(float));
+    return true;
+}
+
+static bool read_string_be(std::ifstream& f, std::string& out) {
+    int32_t len = 0;
+    if (!read_i32_be(f, len)) return false;
+    if (len < 0 || len > 10000000) return false;
+    out.resize(static_cast<size_t>(len));
+    if (len == 0) return true;
+    return read_bytes(f, out.data(), static_cast<size_t>(len));
+}
+
+static bool read_float_array_le(std::ifstream& f, size_t count, std::vector<float>& out) {
+    out.resize(count);
+    if (count == 0) return true;
+    std::vector<uint8_t> buf(count * 4);
+    if (!read_bytes(f, buf.data(), buf.size())) return false;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = static_cast<uint32_t>(buf[i * 4]) |
+                     (static_cast<uint32_t>(buf[i * 4 + 1]) << 8) |
+                     (static_cast<uint32_t>(buf[i * 4 + 2]) << 16) |
+                     (static_cast<uint32_t>(buf[i * 4 + 3]) << 24);
+        std::memcpy(&out[i], &v, sizeof(float));
+    }
+    return true;
+}
+
+static std::vector<std::string> required_tensors(const T5Config& cfg) {
+    std::vector<std::string> names;
+    names.reserve(32 + cfg.numLayers * 9 + cfg.numDecoderLayers * 13);
+    names.emplace_back("shared.weight");
+    names.emplace_back("encoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight");
+    names.emplace_back("decoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight");
+    names.emplace_back("encoder.final_layer_norm.weight");
+    names.emplace_back("decoder.final_layer_norm.weight");
+    names.emplace_back("lm_head.weight");
+
+    for (int i = 0; i < cfg.numLayers; i++) {
+        std::string prefix = "encoder.block." + std::to_string(i) + ".";
+        names.emplace_back(prefix + "layer.0.layer_norm.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.q.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.k.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.v.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.o.weight");
+        names.emplace_back(prefix + "layer.1.layer_norm.weight");
+        names.emplace_back(prefix + "layer.1.DenseReluDense.wi_0.weight");
+        names.emplace_back(prefix + "layer.1.DenseReluDense.wi_1.weight");
+        names.emplace_back(prefix + "layer.1.DenseReluDense.wo.weight");
+    }
+
+    for (int i = 0; i < cfg.numDecoderLayers; i++) {
+        std::string prefix = "decoder.block." + std::to_string(i) + ".";
+        names.emplace_back(prefix + "layer.0.layer_norm.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.q.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.k.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.v.weight");
+        names.emplace_back(prefix + "layer.0.SelfAttention.o.weight");
+        names.emplace_back(prefix + "layer.1.layer_norm.weight");
+        names.emplace_back(prefix + "layer.1.EncDecAttention.q.weight");
+        names.emplace_back(prefix + "layer.1.EncDecAttention.k.weight");
+        names.emplace_back(prefix + "layer.1.EncDecAttention.v.weight");
+        names.emplace_back(prefix + "layer.1.EncDecAttention.o.weight");
+        names.emplace_back(prefix + "layer.2.layer_norm.weight");
+        names.emplace_back(prefix + "layer.2.DenseReluDense.wi_0.weight");
+        names.emplace_back(prefix + "layer.2.DenseReluDense.wi_1.weight");
+        names.emplace_back(prefix + "layer.2.DenseReluDense.wo.weight");
+    }
+
+    return names;
+}
+
+static bool load_t5_bin(const std::string& path, HostModel& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    int32_t magic = 0;
+    if (!read_i32_be(f, magic)) return false;
+    if (magic != 0x4C545454) return false; // LTTT
+    int32_t version = 0;
+    if (!read_i32_be(f, version)) return false;
+    if (version != 1) return false;
+
+    std::string name;
+    if (!read_string_be(f, name)) return false;
+
+    T5Config cfg;
+    if (!read_i32_be(f, cfg.vocabSize)) return false;
+    if (!read_i32_be(f, cfg.dModel)) return false;
+    if (!read_i32_be(f, cfg.dKv)) return false;
+    if (!read_i32_be(f, cfg.dFf)) return false;
+    if (!read_i32_be(f, cfg.numLayers)) return false;
+    if (!read_i32_be(f, cfg.numDecoderLayers)) return false;
+    if (!read_i32_be(f, cfg.numHeads)) return false;
+    if (!read_i32_be(f, cfg.relBuckets)) return false;
+    if (!read_i32_be(f, cfg.relMaxDistance)) return false;
+    if (!read_i32_be(f, cfg.padId)) return false;
+    if (!read_i32_be(f, cfg.eosId)) return false;
+    if (!read_i32_be(f, cfg.decoderStartId)) return false;
+    if (!read_i32_be(f, cfg.unkId)) return false;
+    int32_t gated = 0;
+    if (!read_i32_be(f, gated)) return false;
+    cfg.gatedGelu = gated == 1;
+    int32_t fp16 = 0;
+    if (!read_i32_be(f, fp16)) return false;
+    if (!read_f32_be(f, cfg.layerNormEps)) return false;
+
+    int32_t spVocab = 0;
+    if (!read_i32_be(f, spVocab)) return false;
+    for (int i = 0; i < spVocab; i++) {
+        std::string piece;
+        if (!read_string_be(f, piece)) return false;
+    }
+    for (int i = 0; i < spVocab; i++) {
+        float score = 0.f;
+        if (!read_f32_be(f, score)) return false;
+    }
+
+    int32_t tensorCount = 0;
+    if (!read_i32_be(f, tensorCount)) return false;
+
+    std::vector<std::string> required = required_tensors(cfg);
+    std::unordered_map<std::string, bool> requiredMap;
+    requiredMap.reserve(required.size() * 2);
+    for (const auto& nameReq : required) {
+        requiredMap[nameReq] = false;
+    }
+
+    for (int t = 0; t < tensorCount; t++) {
+        std::string tensorName;
+        if (!read_string_be(f, tensorName)) return false;
+        int32_t dims = 0;
+        if (!read_i32_be(f, dims)) return false;
+        if (dims < 0 || dims > 8) return false;
+        std::vector<int> shape(static_cast<size_t>(dims));
+        int64_t total = 1;
+        for (int i = 0; i < dims; i++) {
+            int32_t dim = 0;
+            if (!read_i32_be(f, dim)) return false;
+            shape[i] = dim;
+            total *= dim;
+        }
+        int32_t count = 0;
+        if (!read_i32_be(f, count)) return false;
+        if (count != total) return false;
+
+        auto it = requiredMap.find(tensorName);
+        if (it != requiredMap.end()) {
+            HostTensor ht;
+            ht.shape = std::move(shape);
+            if (!read_float_array_le(f, static_cast<size_t>(count), ht.data)) return false;
+            out.tensors.emplace(tensorName, std::move(ht));
+            it->second = true;
+        } else {
+            if (count > 0) {
+                f.seekg(static_cast<std::streamoff>(count) * 4, std::ios::cur);
+                if (!f) return false;
+            }
+        }
+    }
+
+    for (const auto& entry : requiredMap) {
+        if (!entry.second) {
+            return false;
+        }
+    }
+
+    out.cfg = cfg;
+    return true;
 }
 
-extern "C" JNIEXPORT void JNICALL Java_chess_nn_t5_oneapi_Backend_nativeDestroy(JNIEnv*, jclass, jlong) {}
+static std::vector<float> transpose2d(const std::vector<float>& in, int rows, int cols) {
+    std::vector<float> out;
+    out.resize(static_cast<size_t>(rows) * static_cast<size_t>(cols));
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            out[static_cast<size_t>(c) * rows + r] = in[static_cast<size_t>(r) * cols + c];
+        }
+    }
+    return out;
+}
+
+static bool should_transpose(const std::string& name, const HostTensor& t) {
+    if (t.shape.size() != 2) return false;
+    if (name == "shared.weight") return false;
+    if (name.find("relative_attention_bias.weight") != std::string::npos) return false;
+    return true;
+}
+
+
+template <class T>
+struct DeviceBuffer {
+    T* ptr = nullptr;
+    size_t capacity = 0;
+
+    void ensure(sycl::queue& q, size_t count) {
+        if (count <= capacity) {
+            return;
+        }
+        release(q);
+        ptr = sycl::malloc_device<T>(count, q);
+        if (!ptr) {
+            throw std::runtime_error("device allocation failed");
+        }
+        capacity = count;
+    }
+
+    // sycl::free does not wait for queued kernels, so drain the queue first.
+    void release(sycl::queue& q) {
+        if (ptr) {
+            q.wait();
+            sycl::free(ptr, q);
+            ptr = nullptr;
+            capacity = 0;
+        }
+    }
+};
+
+struct AttentionWeights {
+    float* wq = nullptr;
+    float* wk = nullptr;
+    float* wv = nullptr;
+    float* wo = nullptr;
+};
+
+struct FfnWeights {
+    float* wi0 = nullptr;
+    float* wi1 = nullptr;
+    float* wo = nullptr;
+};
+
+struct EncoderLayer {
+    float* ln1 = nullptr;
+    AttentionWeights attn;
+    float* ln2 = nullptr;
+    FfnWeights ffn;
+};
+
+struct DecoderLayer {
+    float* ln1 = nullptr;
+    AttentionWeights selfAttn;
+    float* ln2 = nullptr;
+    AttentionWeights crossAttn;
+    float* ln3 = nullptr;
+    FfnWeights ffn;
+};
+
+// Activations for one batch of prompts. Encoder rows are padded to the
+// longest prompt (encLens masks the padding); the decoder keeps one
+// [maxSteps x dAttn] self-attention K/V slab per prompt and layer, and the
+// cross-attention K/V are projected once from the encoder output.
+struct Workspace {
+    DeviceBuffer<float> x;
+    DeviceBuffer<float> norm;
+    DeviceBuffer<float> q;
+    DeviceBuffer<float> k;
+    DeviceBuffer<float> v;
+    DeviceBuffer<float> out;
+    DeviceBuffer<float> ff0;
+    DeviceBuffer<float> ff1;
+    DeviceBuffer<float> tmp;
+    DeviceBuffer<float> scores;
+    DeviceBuffer<float> logits;
+    DeviceBuffer<int> ids;
+    DeviceBuffer<int> encLens;
+    DeviceBuffer<int> next;
+    std::vector<DeviceBuffer<float>> encK;
+    std::vector<DeviceBuffer<float>> encV;
+    std::vector<DeviceBuffer<float>> selfK;
+    std::vector<DeviceBuffer<float>> selfV;
+};
+
+struct T5Gpu {
+    T5Config cfg;
+    std::unique_ptr<sycl::queue> queue;
+    float* d_shared = nullptr;
+    float* d_encoderRelBias = nullptr;
+    float* d_decoderRelBias = nullptr;
+    float* d_encoderFinalLn = nullptr;
+    float* d_decoderFinalLn = nullptr;
+    float* d_lmHead = nullptr;
+    std::vector<EncoderLayer> encoder;
+    std::vector<DecoderLayer> decoder;
+    Workspace ws;
+};
+
+static void free_ptr(T5Gpu* gpu, void* ptr) {
+    if (gpu && gpu->queue && ptr) sycl::free(ptr, *gpu->queue);
+}
+
+static void free_attention(T5Gpu* gpu, AttentionWeights& w) {
+    free_ptr(gpu, w.wq);
+    free_ptr(gpu, w.wk);
+    free_ptr(gpu, w.wv);
+    free_ptr(gpu, w.wo);
+}
+
+static void free_ffn(T5Gpu* gpu, FfnWeights& w) {
+    free_ptr(gpu, w.wi0);
+    free_ptr(gpu, w.wi1);
+    free_ptr(gpu, w.wo);
+}
+
+static void release_buffers(sycl::queue& q, std::vector<DeviceBuffer<float>>& buffers) {
+    for (auto& buffer : buffers) buffer.release(q);
+}
+
+static void destroy_gpu(T5Gpu* gpu) {
+    if (!gpu) return;
+    if (gpu->queue) {
+        free_ptr(gpu, gpu->d_shared);
+        free_ptr(gpu, gpu->d_encoderRelBias);
+        free_ptr(gpu, gpu->d_decoderRelBias);
+        free_ptr(gpu, gpu->d_encoderFinalLn);
+        free_ptr(gpu, gpu->d_decoderFinalLn);
+        free_ptr(gpu, gpu->d_lmHead);
+        for (auto& layer : gpu->encoder) {
+            free_ptr(gpu, layer.ln1);
+            free_attention(gpu, layer.attn);
+            free_ptr(gpu, layer.ln2);
+            free_ffn(gpu, layer.ffn);
+        }
+        for (auto& layer : gpu->decoder) {
+            free_ptr(gpu, layer.ln1);
+            free_attention(gpu, layer.selfAttn);
+            free_ptr(gpu, layer.ln2);
+            free_attention(gpu, layer.crossAttn);
+            free_ptr(gpu, layer.ln3);
+            free_ffn(gpu, layer.ffn);
+        }
+        sycl::queue& q = *gpu->queue;
+        Workspace& ws = gpu->ws;
+        ws.x.release(q);
+        ws.norm.release(q);
+        ws.q.release(q);
+        ws.k.release(q);
+        ws.v.release(q);
+        ws.out.release(q);
+        ws.ff0.release(q);
+        ws.ff1.release(q);
+        ws.tmp.release(q);
+        ws.scores.release(q);
+        ws.logits.release(q);
+        ws.ids.release(q);
+        ws.encLens.release(q);
+        ws.next.release(q);
+        release_buffers(q, ws.encK);
+        release_buffers(q, ws.encV);
+        release_buffers(q, ws.selfK);
+        release_buffers(q, ws.selfV);
+    }
+    delete gpu;
+}
+
+static float* upload_tensor(T5Gpu& gpu, const std::string& name, const HostTensor& t) {
+    std::vector<float> data;
+    if (should_transpose(name, t)) {
+        data = transpose2d(t.data, t.shape[0], t.shape[1]);
+    } else {
+        data = t.data;
+    }
+    float* device = sycl::malloc_device<float>(data.size(), *gpu.queue);
+    if (!device) throw std::runtime_error("device allocation failed");
+    gpu.queue->memcpy(device, data.data(), sizeof(float) * data.size()).wait_and_throw();
+    return device;
+}
+
+static T5Gpu* build_gpu(const HostModel& host) {
+    sycl::device dev;
+    if (!select_intel_gpu(dev)) return nullptr;
+    auto* gpu = new T5Gpu();
+    try {
+        gpu->cfg = host.cfg;
+        gpu->queue = std::make_unique<sycl::queue>(dev, sycl::property::queue::in_order());
+        auto up = [&](const std::string& name) {
+            auto it = host.tensors.find(name);
+            if (it == host.tensors.end()) throw std::runtime_error("missing tensor");
+            return upload_tensor(*gpu, name, it->second);
+        };
+
+        gpu->d_shared = up("shared.weight");
+        gpu->d_encoderRelBias = up("encoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight");
+        gpu->d_decoderRelBias = up("decoder.block.0.layer.0.SelfAttention.relative_attention_bias.weight");
+        gpu->d_encoderFinalLn = up("encoder.final_layer_norm.weight");
+        gpu->d_decoderFinalLn = up("decoder.final_layer_norm.weight");
+        gpu->d_lmHead = up("lm_head.weight");
+
+        gpu->encoder.resize(static_cast<size_t>(gpu->cfg.numLayers));
+        for (int i = 0; i < gpu->cfg.numLayers; i++) {
+            EncoderLayer& layer = gpu->encoder[static_cast<size_t>(i)];
+            std::string prefix = "encoder.block." + std::to_string(i) + ".";
+            layer.ln1 = up(prefix + "layer.0.layer_norm.weight");
+            layer.attn.wq = up(prefix + "layer.0.SelfAttention.q.weight");
+            layer.attn.wk = up(prefix + "layer.0.SelfAttention.k.weight");
+            layer.attn.wv = up(prefix + "layer.0.SelfAttention.v.weight");
+            layer.attn.wo = up(prefix + "layer.0.SelfAttention.o.weight");
+            layer.ln2 = up(prefix + "layer.1.layer_norm.weight");
+            layer.ffn.wi0 = up(prefix + "layer.1.DenseReluDense.wi_0.weight");
+            layer.ffn.wi1 = up(prefix + "layer.1.DenseReluDense.wi_1.weight");
+            layer.ffn.wo = up(prefix + "layer.1.DenseReluDense.wo.weight");
+        }
+
+        gpu->decoder.resize(static_cast<size_t>(gpu->cfg.numDecoderLayers));
+        for (int i = 0; i < gpu->cfg.numDecoderLayers; i++) {
+            DecoderLayer& layer = gpu->decoder[static_cast<size_t>(i)];
+            std::string prefix = "decoder.block." + std::to_string(i) + ".";
+            layer.ln1 = up(prefix + "layer.0.layer_norm.weight");
+            layer.selfAttn.wq = up(prefix + "layer.0.SelfAttention.q.weight");
+            layer.selfAttn.wk = up(prefix + "layer.0.SelfAttention.k.weight");
+            layer.selfAttn.wv = up(prefix + "layer.0.SelfAttention.v.weight");
+            layer.selfAttn.wo = up(prefix + "layer.0.SelfAttention.o.weight");
+            layer.ln2 = up(prefix + "layer.1.layer_norm.weight");
+            layer.crossAttn.wq = up(prefix + "layer.1.EncDecAttention.q.weight");
+            layer.crossAttn.wk = up(prefix + "layer.1.EncDecAttention.k.weight");
+            layer.crossAttn.wv = up(prefix + "layer.1.EncDecAttention.v.weight");
+            layer.crossAttn.wo = up(prefix + "layer.1.EncDecAttention.o.weight");
+            layer.ln3 = up(prefix + "layer.2.layer_norm.weight");
+            layer.ffn.wi0 = up(prefix + "layer.2.DenseReluDense.wi_0.weight");
+            layer.ffn.wi1 = up(prefix + "layer.2.DenseReluDense.wi_1.weight");
+            layer.ffn.wo = up(prefix + "layer.2.DenseReluDense.wo.weight");
+        }
+        return gpu;
+    } catch (const std::exception&) {
+        destroy_gpu(gpu);
+        return nullptr;
+    }
+}
+
+// ---- device kernels ----
+// The queue is in-order, so launches chain without waits; the host only
+// blocks when it reads the next tokens back. Errors surface as exceptions and
+// are caught at the JNI boundary.
+
+constexpr int T5_ROW_GROUP = 256;
+constexpr int T5_ATTN_GROUP = 64;
+constexpr int T5_TILE = 16;
+constexpr float T5_MASKED = -1e30f;
+
+static inline size_t round_up(size_t n, size_t m) {
+    return (n + m - 1) / m * m;
+}
+
+static inline float gelu(float x) {
+    return 0.5f * x * (1.0f + sycl::tanh(sycl::sqrt(2.0f / 3.14159265358979323846f) * (x + 0.044715f * x * x * x)));
+}
+
+static inline int rel_bucket(int relative, int buckets, int maxExact, int maxDistance, bool bidirectional) {
+    int n = relative;
+    int offset = 0;
+    if (bidirectional) {
+        if (n > 0) {
+            offset = buckets;
+        }
+        n = n < 0 ? -n : n;
+    } else {
+        n = -n;
+        if (n < 0) n = 0;
+    }
+    int bucket = 0;
+    if (n < maxExact) {
+        bucket = n;
+    } else {
+        float logVal = sycl::log(static_cast<float>(n) / maxExact) / sycl::log(static_cast<float>(maxDistance) / maxExact);
+        int scaled = static_cast<int>(maxExact + (buckets - maxExact) * logVal);
+        if (scaled > buckets - 1) scaled = buckets - 1;
+        bucket = scaled;
+    }
+    return offset + bucket;
+}
+
+// C[m x n] = A[m x k] * B[k x n], all row-major (the weights are uploaded
+// transposed to [in x out]). oneMKL when the build found it, otherwise a
+// local-memory tiled kernel.
+static void gemm_row_major(T5Gpu& gpu, int m, int n, int k, const float* A, const float* B, float* C) {
+    if (m <= 0 || n <= 0 || k <= 0) return;
+#ifdef CRTK_T5_ONEAPI_MKL
+    oneapi::mkl::blas::row_major::gemm(*gpu.queue,
+                                       oneapi::mkl::transpose::nontrans,
+                                       oneapi::mkl::transpose::nontrans,
+                                       m, n, k,
+                                       1.0f, A, k, B, n,
+                                       0.0f, C, n);
+#else
+    sycl::range<2> global(round_up(static_cast<size_t>(m), T5_TILE), round_up(static_cast<size_t>(n), T5_TILE));
+    gpu.queue->submit([&](sycl::handler& h) {
+        sycl::local_accessor<float, 2> tileA(sycl::range<2>(T5_TILE, T5_TILE), h);
+        sycl::local_accessor<float, 2> tileB(sycl::range<2>(T5_TILE, T5_TILE), h);
+        h.parallel_for(sycl::nd_range<2>(global, sycl::range<2>(T5_TILE, T5_TILE)), [=](sycl::nd_item<2> item) {
+            int row = static_cast<int>(item.get_global_id(0));
+            int col = static_cast<int>(item.get_global_id(1));
+            int ly = static_cast<int>(item.get_local_id(0));
+            int lx = static_cast<int>(item.get_local_id(1));
+            float sum = 0.0f;
+            for (int k0 = 0; k0 < k; k0 += T5_TILE) {
+                tileA[ly][lx] = row < m && k0 + lx < k ? A[static_cast<size_t>(row) * k + k0 + lx] : 0.0f;
+                tileB[ly][lx] = k0 + ly < k && col < n ? B[static_cast<size_t>(k0 + ly) * n + col] : 0.0f;
+                sycl::group_barrier(item.get_group());
+                for (int p = 0; p < T5_TILE; p++) {
+                    sum += tileA[ly][p] * tileB[p][lx];
+                }
+                sycl::group_barrier(item.get_group());
+            }
+            if (row < m && col < n) {
+                C[static_cast<size_t>(row) * n + col] = sum;
+            }
+        });
+    });
+#endif
+}
+
+static void run_embed(T5Gpu& gpu, const int* ids, int rows, float* out) {
+    const float* emb = gpu.d_shared;
+    int vocab = gpu.cfg.vocabSize;
+    int dModel = gpu.cfg.dModel;
+    int unkId = gpu.cfg.unkId;
+    gpu.queue->parallel_for(sycl::range<1>(static_cast<size_t>(rows) * dModel), [=](sycl::id<1> idx) {
+        size_t i = idx[0];
+        int row = static_cast<int>(i / dModel);
+        int col = static_cast<int>(i % dModel);
+        int id = ids[row];
+        if (id < 0 || id >= vocab) id = unkId;
+        out[i] = emb[static_cast<size_t>(id) * dModel + col];
+    });
+}
+
+static void run_rms_norm(T5Gpu& gpu, const float* in, float* out, const float* weight, int rows) {
+    int cols = gpu.cfg.dModel;
+    float eps = gpu.cfg.layerNormEps;
+    sycl::nd_range<1> range(sycl::range<1>(static_cast<size_t>(rows) * T5_ROW_GROUP), sycl::range<1>(T5_ROW_GROUP));
+    gpu.queue->parallel_for(range, [=](sycl::nd_item<1> item) {
+        size_t base = item.get_group(0) * static_cast<size_t>(cols);
+        int lid = static_cast<int>(item.get_local_id(0));
+        float sum = 0.0f;
+        for (int c = lid; c < cols; c += T5_ROW_GROUP) {
+            float v = in[base + c];
+            sum += v * v;
+        }
+        sum = sycl::reduce_over_group(item.get_group(), sum, sycl::plus<float>());
+        float inv = sycl::rsqrt(sum / cols + eps);
+        for (int c = lid; c < cols; c += T5_ROW_GROUP) {
+            out[base + c] = in[base + c] * inv * weight[c];
+        }
+    });
+}
+
+static void run_add(T5Gpu& gpu, float* a, const float* b, size_t n) {
+    gpu.queue->parallel_for(sycl::range<1>(n), [=](sycl::id<1> idx) {
+        a[idx[0]] += b[idx[0]];
+    });
+}
+
+static void run_gelu_mul(T5Gpu& gpu, float* a, const float* b, size_t n) {
+    gpu.queue->parallel_for(sycl::range<1>(n), [=](sycl::id<1> idx) {
+        a[idx[0]] = gelu(a[idx[0]]) * b[idx[0]];
+    });
+}
+
+// Writes each prompt's new K or V row into slot `step` of its cache slab.
+static void run_cache_append(T5Gpu& gpu, const float* src, float* cache, int rows, int maxSteps, int step) {
+    int dAttn = gpu.cfg.numHeads * gpu.cfg.dKv;
+    gpu.queue->parallel_for(sycl::range<1>(static_cast<size_t>(rows) * dAttn), [=](sycl::id<1> idx) {
+        size_t i = idx[0];
+        size_t row = i / dAttn;
+        size_t col = i % dAttn;
+        cache[(row * maxSteps + step) * dAttn + col] = src[i];
+    });
+}
+
+struct AttentionShape {
+    int qLen = 0;             // query rows per prompt
+    int kLen = 0;             // keys per prompt when lens is null
+    const int* lens = nullptr;
+    int qOffset = 0;          // absolute position of query row 0 (decoder steps)
+    bool causal = false;
+    size_t qBatchStride = 0;  // q and out share it
+    size_t kBatchStride = 0;  // k and v share it
+    int scoreStride = 0;      // longest key run; sizes the score scratch
+    const float* relBias = nullptr;
+    bool bidirectional = false;
+};
+
+// One work-group per (query row, head, prompt). The group scores its keys into
+// the scratch row, reduces the max and the softmax denominator, then each
+// work-item produces output dims lid, lid + T5_ATTN_GROUP, ... Rows within a
+// prompt are numHeads * dKv floats apart for q, k, v and out alike.
+static void run_attention(T5Gpu& gpu, const float* q, const float* k, const float* v, float* out,
+                          const AttentionShape& s, int batch) {
+    int heads = gpu.cfg.numHeads;
+    int depth = gpu.cfg.dKv;
+    int dAttn = heads * depth;
+    int buckets = gpu.cfg.relBuckets;
+    int maxDistance = gpu.cfg.relMaxDistance;
+    size_t groups = static_cast<size_t>(batch) * heads * s.qLen;
+    gpu.ws.scores.ensure(*gpu.queue, groups * s.scoreStride);
+    float* scores = gpu.ws.scores.ptr;
+    AttentionShape shape = s;
+    sycl::nd_range<1> range(sycl::range<1>(groups * T5_ATTN_GROUP), sycl::range<1>(T5_ATTN_GROUP));
+    gpu.queue->parallel_for(range, [=](sycl::nd_item<1> item) {
+        size_t g = item.get_group(0);
+        int i = static_cast<int>(g % shape.qLen);
+        int h = static_cast<int>((g / shape.qLen) % heads);
+        int b = static_cast<int>(g / (static_cast<size_t>(shape.qLen) * heads));
+        int lid = static_cast<int>(item.get_local_id(0));
+        int qi = shape.qOffset + i;
+        int kLen = shape.lens != nullptr ? shape.lens[b] : shape.kLen;
+        int kEnd = shape.causal && qi + 1 < kLen ? qi + 1 : kLen;
+        const float* qRow = q + b * shape.qBatchStride + static_cast<size_t>(i) * dAttn + h * depth;
+        const float* kBase = k + b * shape.kBatchStride + h * depth;
+        const float* vBase = v + b * shape.kBatchStride + h * depth;
+        float* score = scores + g * shape.scoreStride;
+        int perDirection = shape.bidirectional ? buckets / 2 : buckets;
+
+        float localMax = T5_MASKED;
+        for (int j = lid; j < kEnd; j += T5_ATTN_GROUP) {
+            const float* kRow = kBase + static_cast<size_t>(j) * dAttn;
+            float dot = 0.0f;
+            for (int d = 0; d < depth; d++) {
+                dot += qRow[d] * kRow[d];
+            }
+            if (shape.relBias != nullptr) {
+                int bucket = rel_bucket(j - qi, perDirection, perDirection / 2, maxDistance, shape.bidirectional);
+                dot += shape.relBias[bucket * heads + h];
+            }
+            score[j] = dot;
+            localMax = sycl::fmax(localMax, dot);
+        }
+        float rowMax = sycl::reduce_over_group(item.get_group(), localMax, sycl::maximum<float>());
+        float localSum = 0.0f;
+        for (int j = lid; j < kEnd; j += T5_ATTN_GROUP) {
+            float e = sycl::exp(score[j] - rowMax);
+            score[j] = e;
+            localSum += e;
+        }
+        float rowSum = sycl::reduce_over_group(item.get_group(), localSum, sycl::plus<float>());
+        sycl::group_barrier(item.get_group());
+        float inv = rowSum > 0.0f ? 1.0f / rowSum : 0.0f;
+        float* outRow = out + b * shape.qBatchStride + static_cast<size_t>(i) * dAttn + h * depth;
+        for (int d = lid; d < depth; d += T5_ATTN_GROUP) {
+            float acc = 0.0f;
+            for (int j = 0; j < kEnd; j++) {
+                acc += score[j] * vBase[static_cast<size_t>(j) * dAttn + d];
+            }
+            outRow[d] = acc * inv;
+        }
+    });
+}
+
+// Greedy pick per logits row; ties go to the lowest token id.
+static void run_argmax_rows(T5Gpu& gpu, const float* logits, int rows, int* outIds) {
+    int vocab = gpu.cfg.vocabSize;
+    sycl::nd_range<1> range(sycl::range<1>(static_cast<size_t>(rows) * T5_ROW_GROUP), sycl::range<1>(T5_ROW_GROUP));
+    gpu.queue->parallel_for(range, [=](sycl::nd_item<1> item) {
+        size_t row = item.get_group(0);
+        int lid = static_cast<int>(item.get_local_id(0));
+        const float* data = logits + row * vocab;
+        float best = -3.402823466e+38F;
+        int bestIdx = vocab;
+        for (int c = lid; c < vocab; c += T5_ROW_GROUP) {
+            if (data[c] > best) {
+                best = data[c];
+                bestIdx = c;
+            }
+        }
+        float rowBest = sycl::reduce_over_group(item.get_group(), best, sycl::maximum<float>());
+        int idx = sycl::reduce_over_group(item.get_group(), best == rowBest ? bestIdx : vocab, sycl::minimum<int>());
+        if (lid == 0) {
+            outIds[row] = idx < vocab ? idx : 0;
+        }
+    });
+}
+
+// Pre-norm gated-GELU feed-forward block: x += wo(gelu(wi0 n) * wi1 n) with n = norm(x).
+static void run_ffn(T5Gpu& gpu, const FfnWeights& w, const float* ln, int rows) {
+    Workspace& ws = gpu.ws;
+    int dModel = gpu.cfg.dModel;
+    int dFf = gpu.cfg.dFf;
+    run_rms_norm(gpu, ws.x.ptr, ws.norm.ptr, ln, rows);
+    gemm_row_major(gpu, rows, dFf, dModel, ws.norm.ptr, w.wi0, ws.ff0.ptr);
+    gemm_row_major(gpu, rows, dFf, dModel, ws.norm.ptr, w.wi1, ws.ff1.ptr);
+    run_gelu_mul(gpu, ws.ff0.ptr, ws.ff1.ptr, static_cast<size_t>(rows) * dFf);
+    gemm_row_major(gpu, rows, dModel, dFf, ws.ff0.ptr, w.wo, ws.tmp.ptr);
+    run_add(gpu, ws.x.ptr, ws.tmp.ptr, static_cast<size_t>(rows) * dModel);
+}
+
+static void ensure_rows(T5Gpu& gpu, int rows) {
+    sycl::queue& q = *gpu.queue;
+    Workspace& ws = gpu.ws;
+    size_t dModel = static_cast<size_t>(gpu.cfg.dModel);
+    size_t dAttn = static_cast<size_t>(gpu.cfg.numHeads) * gpu.cfg.dKv;
+    size_t dFf = static_cast<size_t>(gpu.cfg.dFf);
+    ws.x.ensure(q, rows * dModel);
+    ws.norm.ensure(q, rows * dModel);
+    ws.tmp.ensure(q, rows * dModel);
+    ws.q.ensure(q, rows * dAttn);
+    ws.k.ensure(q, rows * dAttn);
+    ws.v.ensure(q, rows * dAttn);
+    ws.out.ensure(q, rows * dAttn);
+    ws.ff0.ensure(q, rows * dFf);
+    ws.ff1.ensure(q, rows * dFf);
+}
+
+// Encodes `batch` prompts in one padded pass, leaves the cross-attention K/V
+// per decoder layer in ws.encK / ws.encV, and returns the padded row count.
+static int run_encoder(T5Gpu& gpu, const std::vector<int>* inputs, int batch) {
+    sycl::queue& q = *gpu.queue;
+    Workspace& ws = gpu.ws;
+    const T5Config& cfg = gpu.cfg;
+    int encSeq = 1;
+    for (int b = 0; b < batch; b++) encSeq = std::max(encSeq, static_cast<int>(inputs[b].size()));
+    int rows = batch * encSeq;
+    int dModel = cfg.dModel;
+    int dAttn = cfg.numHeads * cfg.dKv;
+
+    std::vector<int> ids(static_cast<size_t>(rows), cfg.padId);
+    std::vector<int> lens(static_cast<size_t>(batch));
+    for (int b = 0; b < batch; b++) {
+        const std::vector<int>& in = inputs[b];
+        std::copy(in.begin(), in.end(), ids.begin() + static_cast<size_t>(b) * encSeq);
+        lens[static_cast<size_t>(b)] = static_cast<int>(in.size());
+    }
+    ensure_rows(gpu, rows);
+    ws.ids.ensure(q, static_cast<size_t>(rows));
+    ws.encLens.ensure(q, static_cast<size_t>(batch));
+    // ids and lens are freed on return, before the first host sync of the decode loop.
+    q.memcpy(ws.ids.ptr, ids.data(), sizeof(int) * ids.size()).wait();
+    q.memcpy(ws.encLens.ptr, lens.data(), sizeof(int) * lens.size()).wait();
+
+    AttentionShape self;
+    self.qLen = encSeq;
+    self.lens = ws.encLens.ptr;
+    self.qBatchStride = self.kBatchStride = static_cast<size_t>(encSeq) * dAttn;
+    self.scoreStride = encSeq;
+    self.relBias = gpu.d_encoderRelBias;
+    self.bidirectional = true;
+
+    run_embed(gpu, ws.ids.ptr, rows, ws.x.ptr);
+    for (const EncoderLayer& l : gpu.encoder) {
+        run_rms_norm(gpu, ws.x.ptr, ws.norm.ptr, l.ln1, rows);
+        gemm_row_major(gpu, rows, dAttn, dModel, ws.norm.ptr, l.attn.wq, ws.q.ptr);
+        gemm_row_major(gpu, rows, dAttn, dModel, ws.norm.ptr, l.attn.wk, ws.k.ptr);
+        gemm_row_major(gpu, rows, dAttn, dModel, ws.norm.ptr, l.attn.wv, ws.v.ptr);
+        run_attention(gpu, ws.q.ptr, ws.k.ptr, ws.v.ptr, ws.out.ptr, self, batch);
+        gemm_row_major(gpu, rows, dModel, dAttn, ws.out.ptr, l.attn.wo, ws.tmp.ptr);
+        run_add(gpu, ws.x.ptr, ws.tmp.ptr, static_cast<size_t>(rows) * dModel);
+        run_ffn(gpu, l.ffn, l.ln2, rows);
+    }
+    run_rms_norm(gpu, ws.x.ptr, ws.x.ptr, gpu.d_encoderFinalLn, rows);
+
+    ws.encK.resize(gpu.decoder.size());
+    ws.encV.resize(gpu.decoder.size());
+    for (size_t layer = 0; layer < gpu.decoder.size(); layer++) {
+        const DecoderLayer& l = gpu.decoder[layer];
+        ws.encK[layer].ensure(q, static_cast<size_t>(rows) * dAttn);
+        ws.encV[layer].ensure(q, static_cast<size_t>(rows) * dAttn);
+        gemm_row_major(gpu, rows, dAttn, dModel, ws.x.ptr, l.crossAttn.wk, ws.encK[layer].ptr);
+        gemm_row_major(gpu, rows, dAttn, dModel, ws.x.ptr, l.crossAttn.wv, ws.encV[layer].ptr);
+    }
+    return encSeq;
+}
+
+// One cached decoder step for every prompt: embeds ws.next, appends this
+// step's self-attention K/V to the caches and writes the greedy next ids back
+// into ws.next.
+static void run_decoder_step(T5Gpu& gpu, int batch, int encSeq, int maxSteps, int step) {
+    Workspace& ws = gpu.ws;
+    const T5Config& cfg = gpu.cfg;
+    int dModel = cfg.dModel;
+    int dAttn = cfg.numHeads * cfg.dKv;
+
+    AttentionShape self;
+    self.qLen = 1;
+    self.kLen = step + 1;
+    self.qOffset = step;
+    self.causal = true;
+    self.qBatchStride = static_cast<size_t>(dAttn);
+    self.kBatchStride = static_cast<size_t>(maxSteps) * dAttn;
+    self.scoreStride = maxSteps;
+    self.relBias = gpu.d_decoderRelBias;
+
+    AttentionShape cross;
+    cross.qLen = 1;
+    cross.lens = ws.encLens.ptr;
+    cross.qBatchStride = static_cast<size_t>(dAttn);
+    cross.kBatchStride = static_cast<size_t>(encSeq) * dAttn;
+    cross.scoreStride = encSeq;
+
+    run_embed(gpu, ws.next.ptr, batch, ws.x.ptr);
+    for (size_t layer = 0; layer < gpu.decoder.size(); layer++) {
+        const DecoderLayer& l = gpu.decoder[layer];
+        run_rms_norm(gpu, ws.x.ptr, ws.norm.ptr, l.ln1, batch);
+        gemm_row_major(gpu, batch, dAttn, dModel, ws.norm.ptr, l.selfAttn.wq, ws.q.ptr);
+        gemm_row_major(gpu, batch, dAttn, dModel, ws.norm.ptr, l.selfAttn.wk, ws.k.ptr);
+        gemm_row_major(gpu, batch, dAttn, dModel, ws.norm.ptr, l.selfAttn.wv, ws.v.ptr);
+        run_cache_append(gpu, ws.k.ptr, ws.selfK[layer].ptr, batch, maxSteps, step);
+        run_cache_append(gpu, ws.v.ptr, ws.selfV[layer].ptr, batch, maxSteps, step);
+        run_attention(gpu, ws.q.ptr, ws.selfK[layer].ptr, ws.selfV[layer].ptr, ws.out.ptr, self, batch);
+        gemm_row_major(gpu, batch, dModel, dAttn, ws.out.ptr, l.selfAttn.wo, ws.tmp.ptr);
+        run_add(gpu, ws.x.ptr, ws.tmp.ptr, static_cast<size_t>(batch) * dModel);
+
+        run_rms_norm(gpu, ws.x.ptr, ws.norm.ptr, l.ln2, batch);
+        gemm_row_major(gpu, batch, dAttn, dModel, ws.norm.ptr, l.crossAttn.wq, ws.q.ptr);
+        run_attention(gpu, ws.q.ptr, ws.encK[layer].ptr, ws.encV[layer].ptr, ws.out.ptr, cross, batch);
+        gemm_row_major(gpu, batch, dModel, dAttn, ws.out.ptr, l.crossAttn.wo, ws.tmp.ptr);
+        run_add(gpu, ws.x.ptr, ws.tmp.ptr, static_cast<size_t>(batch) * dModel);
+
+        run_ffn(gpu, l.ffn, l.ln3, batch);
+    }
+    run_rms_norm(gpu, ws.x.ptr, ws.x.ptr, gpu.d_decoderFinalLn, batch);
+    gemm_row_major(gpu, batch, cfg.vocabSize, dModel, ws.x.ptr, gpu.d_lmHead, ws.logits.ptr);
+    run_argmax_rows(gpu, ws.logits.ptr, batch, ws.next.ptr);
+}
+
+// Prompts decoded together per group (CRTK_T5_ONEAPI_BATCH, default 32). The
+// self-attention cache holds batch * maxNew * dAttn floats per layer for K and
+// for V, so larger requests run group by group on the same workspace.
+static int batch_slots() {
+    const char* env = std::getenv("CRTK_T5_ONEAPI_BATCH");
+    int value = env ? std::atoi(env) : 0;
+    return value > 0 ? value : 32;
+}
+
+// Greedy decoding for one group of `batch` prompts (each already ending in
+// EOS). All prompts step together until every one has emitted EOS or maxNew
+// tokens; finished prompts keep stepping on their EOS token and their outputs
+// are left alone. outputs[b] must already hold the decoder start id.
+static void generate_group(T5Gpu& gpu,
+                           const std::vector<int>* inputs,
+                           int batch,
+                           int maxNew,
+                           std::vector<int>* outputs) {
+    const T5Config& cfg = gpu.cfg;
+    sycl::queue& q = *gpu.queue;
+    Workspace& ws = gpu.ws;
+    int encSeq = run_encoder(gpu, inputs, batch);
+
+    size_t dAttn = static_cast<size_t>(cfg.numHeads) * cfg.dKv;
+    ws.selfK.resize(gpu.decoder.size());
+    ws.selfV.resize(gpu.decoder.size());
+    for (size_t layer = 0; layer < gpu.decoder.size(); layer++) {
+        ws.selfK[layer].ensure(q, static_cast<size_t>(batch) * maxNew * dAttn);
+        ws.selfV[layer].ensure(q, static_cast<size_t>(batch) * maxNew * dAttn);
+    }
+    ws.logits.ensure(q, static_cast<size_t>(batch) * cfg.vocabSize);
+    ws.next.ensure(q, static_cast<size_t>(batch));
+
+    std::vector<int> tokens(static_cast<size_t>(batch), cfg.decoderStartId);
+    std::vector<char> done(static_cast<size_t>(batch), 0);
+    q.memcpy(ws.next.ptr, tokens.data(), sizeof(int) * tokens.size());
+    for (int step = 0; step < maxNew; step++) {
+        run_decoder_step(gpu, batch, encSeq, maxNew, step);
+        q.memcpy(tokens.data(), ws.next.ptr, sizeof(int) * tokens.size()).wait_and_throw();
+        bool live = false;
+        for (int b = 0; b < batch; b++) {
+            if (done[static_cast<size_t>(b)]) continue;
+            if (tokens[static_cast<size_t>(b)] == cfg.eosId) {
+                done[static_cast<size_t>(b)] = 1;
+                continue;
+            }
+            outputs[b].push_back(tokens[static_cast<size_t>(b)]);
+            live = true;
+        }
+        if (!live) break;
+    }
+}
+
+// Greedy decoding for every prompt, in groups of at most batch_slots().
+static void generate_batch(T5Gpu& gpu,
+                           const std::vector<std::vector<int>>& inputs,
+                           int maxNew,
+                           std::vector<std::vector<int>>& outputs) {
+    outputs.assign(inputs.size(), std::vector<int>(1, gpu.cfg.decoderStartId));
+    if (inputs.empty() || maxNew <= 0) return;
+    const size_t slots = static_cast<size_t>(batch_slots());
+    for (size_t start = 0; start < inputs.size(); start += slots) {
+        int group = static_cast<int>(std::min(slots, inputs.size() - start));
+        generate_group(gpu, inputs.data() + start, group, maxNew, outputs.data() + start);
+    }
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_chess_nn_t5_oneapi_Backend_nativeCreate(JNIEnv* env, jclass, jstring path) {
+    if (path == nullptr) return 0;
+    const char* cpath = env->GetStringUTFChars(path, nullptr);
+    if (!cpath) return 0;
+    std::string pathStr(cpath);
+    env->ReleaseStringUTFChars(path, cpath);
+
+    HostModel host;
+    if (!load_t5_bin(pathStr, host)) {
+        return 0;
+    }
+    return reinterpret_cast<jlong>(build_gpu(host));
+}
+
+extern "C" JNIEXPORT void JNICALL Java_chess_nn_t5_oneapi_Backend_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+    destroy_gpu(reinterpret_cast<T5Gpu*>(handle));
+}
 
 extern "C" JNIEXPORT jintArray JNICALL Java_chess_nn_t5_oneapi_Backend_nativeGenerateIds(
-    JNIEnv*, jclass, jlong, jintArray, jint) {
-    return nullptr;
+    JNIEnv* env, jclass, jlong handle, jintArray inputIdsArr, jint maxNewTokens) {
+    if (handle == 0 || inputIdsArr == nullptr) return nullptr;
+    if (maxNewTokens < 0) maxNewTokens = 0;
+
+    T5Gpu* gpu = reinterpret_cast<T5Gpu*>(handle);
+    jsize len = env->GetArrayLength(inputIdsArr);
+    std::vector<std::vector<int>> inputs(1, std::vector<int>(static_cast<size_t>(len)));
+    env->GetIntArrayRegion(inputIdsArr, 0, len, inputs[0].data());
+    if (inputs[0].empty() || inputs[0].back() != gpu->cfg.eosId) {
+        inputs[0].push_back(gpu->cfg.eosId);
+    }
+
+    std::vector<std::vector<int>> outputs;
+    try {
+        generate_batch(*gpu, inputs, maxNewTokens, outputs);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+
+    const std::vector<int>& out = outputs[0];
+    jintArray outArr = env->NewIntArray(static_cast<jsize>(out.size()));
+    if (!outArr) return nullptr;
+    env->SetIntArrayRegion(outArr, 0, static_cast<jsize>(out.size()), out.data());
+    return outArr;
+}
+
+extern "C" JNIEXPORT jintArray JNICALL Java_chess_nn_t5_oneapi_Backend_nativeGenerateIdsBatch(
+    JNIEnv* env, jclass, jlong handle, jintArray idsArr, jintArray offsetsArr, jint maxNewTokens) {
+    if (handle == 0 || idsArr == nullptr || offsetsArr == nullptr) return nullptr;
+    if (maxNewTokens < 0) maxNewTokens = 0;
+
+    T5Gpu* gpu = reinterpret_cast<T5Gpu*>(handle);
+    jsize total = env->GetArrayLength(idsArr);
+    jsize bounds = env->GetArrayLength(offsetsArr);
+    if (bounds < 1) return nullptr;
+    std::vector<int> flat(static_cast<size_t>(total));
+    std::vector<int> offsets(static_cast<size_t>(bounds));
+    env->GetIntArrayRegion(idsArr, 0, total, flat.data());
+    env->GetIntArrayRegion(offsetsArr, 0, bounds, offsets.data());
+
+    int count = bounds - 1;
+    std::vector<std::vector<int>> inputs(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        int begin = offsets[static_cast<size_t>(i)];
+        int end = offsets[static_cast<size_t>(i) + 1];
+        if (begin < 0 || end < begin || end > total) return nullptr;
+        std::vector<int>& in = inputs[static_cast<size_t>(i)];
+        in.assign(flat.begin() + begin, flat.begin() + end);
+        if (in.empty() || in.back() != gpu->cfg.eosId) {
+            in.push_back(gpu->cfg.eosId);
+        }
+    }
+
+    std::vector<std::vector<int>> outputs;
+    try {
+        generate_batch(*gpu, inputs, maxNewTokens, outputs);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+
+    std::vector<int> packed(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        const std::vector<int>& out = outputs[static_cast<size_t>(i)];
+        packed[static_cast<size_t>(i)] = static_cast<int>(out.size());
+        packed.insert(packed.end(), out.begin(), out.end());
+    }
+    jintArray outArr = env->NewIntArray(static_cast<jsize>(packed.size()));
+    if (!outArr) return nullptr;
+    env->SetIntArrayRegion(outArr, 0, static_cast<jsize>(packed.size()), packed.data());
+    return outArr;
 }
@@ -24,8 +24,11 @@ static PerftHostDim3 threadIdx{0};
 static PerftHostDim3 blockDim{1};
 
 #define PERFT_GLOBAL
-#define PERFT_LAUNCH(kernel, grid, block, ...)                       \
+#define PERFT_CONSTANT
+#define PERFT_DEVICE
+#define PERFT_LAUNCH(kernel, grid, block, stream, ...)               \
     do {                                                             \
+        (void) (stream);                                             \
         blockDim.x = (block);                                        \
         for (int _b = 0; _b < (grid); ++_b) {                        \
             blockIdx.x = _b;                                         \
@@ -41,7 +44,23 @@ static PerftHostDim3 blockDim{1};
 #define PERFT_GPU_MEMCPY(d, s, n, kind) (std::memcpy((void*) (d), (const void*) (s), (n)), 0)
 #define PERFT_GPU_MEMCPY_H2D 0
 #define PERFT_GPU_MEMCPY_D2H 0
+#define PERFT_GPU_MEMCPY_ASYNC(d, s, n, kind, stream) PERFT_GPU_MEMCPY(d, s, n, kind)
+#define PERFT_GPU_MEMCPY_TO_SYMBOL(sym, s, n) (std::memcpy((void*) &(sym), (const void*) (s), (n)), 0)
+#define PERFT_GPU_HOST_ALLOC(ptr, bytes) PERFT_GPU_MALLOC(ptr, bytes)
+#define PERFT_GPU_HOST_FREE(p) PERFT_GPU_FREE(p)
+#define PERFT_GPU_STREAM void*
+#define PERFT_GPU_STREAM_CREATE(ptr) (*(ptr) = (void*) &blockDim, 0)
+#define PERFT_GPU_STREAM_DESTROY(stream) (0)
+#define PERFT_GPU_STREAM_SYNCHRONIZE(stream) (0)
+#define PERFT_GPU_GET_DEVICE(ptr) (*(ptr) = 0, 0)
+#define PERFT_GPU_SET_DEVICE(device) ((void) (device), 0)
 #define PERFT_GPU_MEMSET(p, v, n) (std::memset((void*) (p), (v), (n)), 0)
+#define PERFT_GPU_MEMSET_ASYNC(p, v, n, stream) PERFT_GPU_MEMSET(p, v, n)
+#define PERFT_ATOMIC_ADD(addr, value) (*(addr) += (value))
+#define PERFT_KERNEL_ENV "CRTK_PERFT_HOST_KERNEL"
+#define PERFT_ATOMIC_CAS(addr, expected, value) __sync_val_compare_and_swap((addr), (expected), (value))
+#define PERFT_ATOMIC_EXCH(addr, value) __sync_lock_test_and_set((addr), (value))
+#define PERFT_TT_ENV "CRTK_PERFT_HOST_TT_MB"
 #define PERFT_GPU_DEVICE_SYNCHRONIZE() ((void) 0)
 #define PERFT_GPU_GET_DEVICE_COUNT(ptr) (*(ptr) = 1, 0)
 #define PERFT_GPU_LAST_ERROR() 0
@@ -9,13 +9,19 @@
  *
  * Build:  g++ -O2 -std=c++17 native/test/perft_host_test.cpp -o /tmp/perft_host_test
  * Run:    /tmp/perft_host_test
+ *
+ * Add -mbmi2 (or -march=native) to run the perft checks on PEXT sliders, or
+ * -DPERFT_SLIDERS=PERFT_SLIDERS_HYPERBOLA for the table-free reference; the
+ * default is fancy magics. Every build cross-checks all three backends.
  */
 #include "../common/perft_core.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <vector>
 
 using namespace crtk_perft;
 
@@ -111,6 +117,82 @@ struct Case {
     uint64_t expected[7]; // expected[d] for d = 1..maxDepth
 };
 
+// Checks p.key against compute_key at every node below p.
+static bool key_walk(const Tables& t, Position& p, int depth) {
+    if (p.key != compute_key(t, p)) return false;
+    if (depth == 0) return true;
+    MoveList ml;
+    generate_pseudo_moves(t, p, ml);
+    bool ok = true;
+    for (int i = 0; i < ml.count && ok; ++i) {
+        Undo u;
+        uint64_t before = p.key;
+        make_move<true>(t, p, ml.moves[i], u);
+        ok = key_walk(t, p, depth - 1);
+        undo_move(p, ml.moves[i], u);
+        ok = ok && p.key == before;
+    }
+    return ok;
+}
+
+// Checks the legal generator against the reference (pseudo moves that do not
+// leave the mover's king attacked) at every node below p: same move set, same
+// bulk count, same has_legal_move answer.
+static bool legal_walk(const Tables& t, Position& p, int depth) {
+    MoveList pseudo;
+    MoveList legal;
+    generate_pseudo_moves(t, p, pseudo);
+    generate_legal_moves(t, p, legal);
+    bool white = p.whiteToMove;
+    std::vector<uint16_t> want;
+    for (int i = 0; i < pseudo.count; ++i) {
+        Undo u;
+        make_move(t, p, pseudo.moves[i], u);
+        if (!king_attacked(t, p, white)) want.push_back(pseudo.moves[i]);
+        undo_move(p, pseudo.moves[i], u);
+    }
+    std::vector<uint16_t> got(legal.moves, legal.moves + legal.count);
+    std::sort(want.begin(), want.end());
+    std::sort(got.begin(), got.end());
+    if (got != want) return false;
+    if (count_legal_moves(t, p) != want.size()) return false;
+    if (has_legal_move(t, p) != !want.empty()) return false;
+    if (depth == 0) return true;
+    bool ok = true;
+    for (int i = 0; i < legal.count && ok; ++i) {
+        Undo u;
+        make_move(t, p, legal.moves[i], u);
+        ok = legal_walk(t, p, depth - 1);
+        undo_move(p, legal.moves[i], u);
+    }
+    return ok;
+}
+
+// Single-threaded table with the same slot encoding and replacement policy as
+// the device table in perft_gpu_impl.inl.
+struct HostTT {
+    std::vector<PerftTTEntry> slots;
+    unsigned long long probes = 0;
+    unsigned long long hits = 0;
+
+    bool probe(uint64_t key, int depth, uint64_t& nodes) {
+        const PerftTTEntry& e = slots[key & (slots.size() - 1)];
+        ++probes;
+        if (!tt_match(e.check, e.data, key, depth)) return false;
+        ++hits;
+        nodes = tt_nodes(e.data);
+        return true;
+    }
+
+    void store(uint64_t key, int depth, uint64_t nodes) {
+        PerftTTEntry& e = slots[key & (slots.size() - 1)];
+        if (tt_replace(e.check, e.data, key, depth)) {
+            e.data = tt_pack(nodes, depth);
+            e.check = key ^ e.data;
+        }
+    }
+};
+
 int main() {
     Tables t;
     build_tables(t);
@@ -212,6 +294,129 @@ int main() {
         }
     }
 
+    // Root-split shares (the cooperative GPU kernel mode): summing every lane's
+    // share must reproduce the canonical counts for any lane count, and the
+    // shallow-frame stack must agree with the full-depth one.
+    const int laneCounts[] = {1, 3, 32};
+    for (const Case& c : cases) {
+        Position root;
+        parse_fen(c.fen, root);
+        int d = c.maxDepth < 4 ? c.maxDepth : 4;
+        for (int lanes : laneCounts) {
+            uint64_t sum = 0;
+            for (int lane = 0; lane < lanes; ++lane) {
+                Position p = root;
+                sum += perft_root_share<4>(t, p, d, lane, lanes);
+            }
+            bool ok = sum == c.expected[d];
+            std::printf("[%s] %-10s split d%d lanes=%d: %llu (expected %llu)\n", ok ? " OK " : "FAIL", c.name, d,
+                    lanes, (unsigned long long) sum, (unsigned long long) c.expected[d]);
+            if (!ok) ++failures;
+        }
+    }
+    for (const DetailedCase& c : detailed) {
+        Position root;
+        parse_fen(c.fen, root);
+        PerftCounts got = {};
+        for (int lane = 0; lane < 32; ++lane) {
+            Position p = root;
+            perft_detailed_root_share<4>(t, p, c.depth, lane, 32, got);
+        }
+        unsigned long long g[7] = {got.nodes, got.captures, got.enPassant, got.castles,
+                got.promotions, got.checks, got.checkmates};
+        bool ok = std::memcmp(g, c.expect, sizeof(g)) == 0;
+        std::printf("[%s] %-12s split detailed d%d\n", ok ? " OK " : "FAIL", c.name, c.depth);
+        if (!ok) ++failures;
+    }
+
+    // Slider backends: magic and PEXT lookups must reproduce the hyperbola
+    // reference for every relevant-occupancy subset plus random full boards
+    // (bits outside the mask must be ignored), whichever backend this build
+    // selected for the perft checks above.
+    {
+        Tables magic = t;
+        Tables pext = t;
+        build_slider_squares(magic);
+        pext = magic;
+        std::vector<uint64_t> magicAttacks(SLIDER_ATTACK_WORDS);
+        std::vector<uint64_t> pextAttacks(SLIDER_ATTACK_WORDS);
+        build_slider_attacks(magic, SliderKind::Magic, magicAttacks.data());
+        build_slider_attacks(pext, SliderKind::Pext, pextAttacks.data());
+        magic.sliderAttacks = magicAttacks.data();
+        pext.sliderAttacks = pextAttacks.data();
+        uint64_t seed = 12345;
+        long mismatches = 0;
+        auto check = [&](int sq, bool rook, uint64_t occ) {
+            uint64_t ref = rook ? hyperbola_rook(t, sq, occ) : hyperbola_bishop(t, sq, occ);
+            uint64_t m = rook ? rook_attacks_as<SliderKind::Magic>(magic, sq, occ)
+                    : bishop_attacks_as<SliderKind::Magic>(magic, sq, occ);
+            uint64_t x = rook ? rook_attacks_as<SliderKind::Pext>(pext, sq, occ)
+                    : bishop_attacks_as<SliderKind::Pext>(pext, sq, occ);
+            uint64_t d = rook ? rook_attacks(t, sq, occ) : bishop_attacks(t, sq, occ);
+            if (m != ref || x != ref || d != ref) ++mismatches;
+        };
+        for (int sq = 0; sq < 64; ++sq) {
+            for (int rook = 0; rook < 2; ++rook) {
+                uint64_t mask = rook ? magic.rookSlider[sq].mask : magic.bishopSlider[sq].mask;
+                uint64_t sub = 0;
+                do {
+                    check(sq, rook != 0, sub);
+                    sub = (sub - mask) & mask;
+                } while (sub != 0);
+                for (int i = 0; i < 64; ++i) {
+                    check(sq, rook != 0, splitmix64(seed) & splitmix64(seed));
+                }
+            }
+        }
+        bool ok = mismatches == 0;
+        std::printf("[%s] sliders (build uses %s): %ld mismatches\n", ok ? " OK " : "FAIL",
+                SLIDERS == SliderKind::Pext ? "pext" : SLIDERS == SliderKind::Magic ? "magic" : "hyperbola",
+                mismatches);
+        if (!ok) ++failures;
+    }
+
+    // Legal generation (pins, checks, evasions, en passant and castling edge
+    // cases) must agree move-for-move with the make/king_attacked/undo filter.
+    for (const Case& c : cases) {
+        Position root;
+        parse_fen(c.fen, root);
+        bool ok = legal_walk(t, root, 3);
+        std::printf("[%s] %-10s legal moves d3\n", ok ? " OK " : "FAIL", c.name);
+        if (!ok) ++failures;
+    }
+
+    // Zobrist keys: make_move<true> must track compute_key through every make
+    // and undo, and the transposition-table walker (deliberately undersized so
+    // slots are replaced) must reproduce the canonical counts.
+    for (const Case& c : cases) {
+        Position root;
+        parse_fen(c.fen, root);
+        root.key = compute_key(t, root);
+        bool ok = key_walk(t, root, 3);
+        std::printf("[%s] %-10s zobrist d3\n", ok ? " OK " : "FAIL", c.name);
+        if (!ok) ++failures;
+
+        HostTT tt;
+        tt.slots.assign(1u << 12, PerftTTEntry{0, 0});
+        for (int d = 1; d <= c.maxDepth; ++d) {
+            Position p = root;
+            uint64_t got = perft_tt_iter_frames<MAX_PERFT_DEPTH>(t, p, d, tt);
+            bool same = got == c.expected[d];
+            std::printf("[%s] %-10s tt d%d: %llu (expected %llu)\n", same ? " OK " : "FAIL", c.name, d,
+                    (unsigned long long) got, (unsigned long long) c.expected[d]);
+            if (!same) ++failures;
+        }
+        uint64_t split = 0;
+        for (int lane = 0; lane < 32; ++lane) {
+            Position p = root;
+            split += perft_tt_root_share<4>(t, p, c.maxDepth < 4 ? c.maxDepth : 4, lane, 32, tt);
+        }
+        bool same = split == c.expected[c.maxDepth < 4 ? c.maxDepth : 4];
+        std::printf("[%s] %-10s tt split: %llu, hits %llu/%llu\n", same ? " OK " : "FAIL", c.name,
+                (unsigned long long) split, tt.hits, tt.probes);
+        if (!same) ++failures;
+    }
+
     if (failures == 0) {
         std::printf("\nperft_host_test: all checks passed\n");
         return 0;
@@ -466,6 +466,7 @@ run_engine() {
     java:testing.ClassifierModelRegressionTest \
     java:testing.T5RegressionTest \
     java:testing.OtisBackendRegressionTest \
+    java:testing.Lc0BackendRegressionTest \
     java:testing.GpuPerftRegressionTest \
     java:testing.NNUERegressionTest \
     java:testing.UpstreamRegressionTest \
@@ -187,6 +187,9 @@ if [[ $REMOVE_BUILD -eq 1 ]]; then
   if [[ -d "$APP_HOME/native/oneapi/build" ]]; then
     build_targets+=("$APP_HOME/native/oneapi/build")
   fi
+  if [[ -d "$APP_HOME/native/host/build" ]]; then
+    build_targets+=("$APP_HOME/native/host/build")
+  fi
 
   if [[ ${#build_targets[@]} -gt 0 ]]; then
     step "Build artifacts found"
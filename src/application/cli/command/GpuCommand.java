@@ -62,6 +62,8 @@ public final class GpuCommand {
 						chess.nn.lc0.cnn.oneapi.Support.isAvailable(), chess.nn.lc0.cnn.oneapi.Support.deviceCount()),
 				backend("LC0 BT4 oneAPI", chess.nn.lc0.bt4.oneapi.Support.isLoaded(),
 						chess.nn.lc0.bt4.oneapi.Support.isAvailable(), chess.nn.lc0.bt4.oneapi.Support.deviceCount()),
+				backend("LC0 CNN host", chess.nn.lc0.cnn.host.Support.isLoaded(),
+						chess.nn.lc0.cnn.host.Support.isAvailable(), chess.nn.lc0.cnn.host.Support.deviceCount()),
 				backend("OTIS CUDA", chess.nn.otis.cuda.Support.isLoaded(),
 						chess.nn.otis.cuda.Support.isAvailable(), chess.nn.otis.cuda.Support.deviceCount()),
 				backend("OTIS ROCm", chess.nn.otis.rocm.Support.isLoaded(),
@@ -73,7 +75,9 @@ public final class GpuCommand {
 				backend("PERFT ROCm", chess.nn.perft.rocm.Support.isLoaded(),
 						chess.nn.perft.rocm.Support.isAvailable(), chess.nn.perft.rocm.Support.deviceCount()),
 				backend("PERFT oneAPI", chess.nn.perft.oneapi.Support.isLoaded(),
-						chess.nn.perft.oneapi.Support.isAvailable(), chess.nn.perft.oneapi.Support.deviceCount()));
+						chess.nn.perft.oneapi.Support.isAvailable(), chess.nn.perft.oneapi.Support.deviceCount()),
+				backend("PERFT host", chess.nn.perft.host.Support.isLoaded(),
+						chess.nn.perft.host.Support.isAvailable(), chess.nn.perft.host.Support.deviceCount()));
 	}
 
 	/**
@@ -212,6 +212,9 @@ public final class PerftCommand {
 		System.out.println("FEN: " + position);
 		printRootStatus(position);
 		int splitDepth = split == null ? GpuPerft.defaultSplitDepth(depth) : split;
+		GpuPerft.resetDeviceNodes();
+		GpuPerft.resetTableStats();
+		GpuPerft.resetFrontierStats();
 		long start = System.nanoTime();
 
 		if (detailed) {
@@ -231,6 +234,9 @@ public final class PerftCommand {
 			System.out.println(heading + " depth " + depth + " (" + mode + ")");
 			printStats(stats);
 			printTiming(nanos, nanos <= 0L ? 0.0 : stats.nodes() * 1_000_000_000.0 / nanos);
+			printDeviceNodes();
+			printTableStats();
+			printFrontierStats();
 			return;
 		}
 
@@ -247,6 +253,49 @@ public final class PerftCommand {
 		System.out.println(heading + " depth " + depth + " (" + mode + ")");
 		System.out.println("nodes: " + nodes);
 		printTiming(nanos, nanos <= 0L ? 0.0 : nodes * 1_000_000_000.0 / nanos);
+		printDeviceNodes();
+		printTableStats();
+		printFrontierStats();
+	}
+
+	/**
+	 * Prints per-device node totals when the native session spread the run
+	 * across more than one GPU, so load balance can be checked.
+	 */
+	private static void printDeviceNodes() {
+		long[] nodes = GpuPerft.deviceNodes();
+		if (nodes.length < 2) {
+			return;
+		}
+		for (int i = 0; i < nodes.length; i++) {
+			System.out.println("device-" + i + "-nodes: " + nodes[i]);
+		}
+	}
+
+	/**
+	 * Prints device transposition-table hit statistics when the native session
+	 * ran with a table.
+	 */
+	private static void printTableStats() {
+		long[] stats = GpuPerft.tableStats();
+		if (stats[0] <= 0L) {
+			return;
+		}
+		System.out.printf(Locale.ROOT, "tt: %d hits / %d probes (%.1f%%), %d stores, %d slots%n",
+				stats[1], stats[0], 100.0 * stats[1] / stats[0], stats[2], stats[3]);
+	}
+
+	/**
+	 * Prints how many split-depth frontier positions the native expansion
+	 * folded into unique ones, when the folded path ran.
+	 */
+	private static void printFrontierStats() {
+		long[] stats = GpuPerft.frontierStats();
+		if (stats[0] <= 0L) {
+			return;
+		}
+		System.out.printf(Locale.ROOT, "frontier: %d positions folded to %d unique (%.1f%%)%n",
+				stats[0], stats[1], 100.0 * stats[1] / stats[0]);
 	}
 
 	/**
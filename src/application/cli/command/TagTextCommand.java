@@ -54,6 +54,12 @@ public final class TagTextCommand {
      */
     private static final String COMMAND_LABEL = "fen text";
 
+    /**
+     * Prompts handed to the T5 runner per batched generation call when no
+     * engine analysis is needed (native backends decode them together).
+     */
+    private static final int GENERATE_BATCH = 256;
+
      /**
      * Creates a new tag text command instance.
      */
@@ -165,13 +171,16 @@ public final class TagTextCommand {
         try (Runner runner = new Runner(model)) {
             Bar bar = positionProgressBar(positions, COMMAND_LABEL);
             try {
-                for (Position pos : positions) {
-                    try {
-                        List<String> tags = Generator.tags(pos);
-                        String prompt = TagPrompt.buildPositionPrompt(tags);
-                        String summary = runner.generate(prompt, opts.maxNew);
-                        printSummary(opts.includeFen, pos, summary);
-                    } finally {
+                for (int start = 0; start < positions.size(); start += GENERATE_BATCH) {
+                    List<Position> chunk = positions.subList(start,
+                            Math.min(positions.size(), start + GENERATE_BATCH));
+                    List<String> prompts = new ArrayList<>(chunk.size());
+                    for (Position pos : chunk) {
+                        prompts.add(TagPrompt.buildPositionPrompt(Generator.tags(pos)));
+                    }
+                    List<String> summaries = runner.generateBatch(prompts, opts.maxNew);
+                    for (int i = 0; i < chunk.size(); i++) {
+                        printSummary(opts.includeFen, chunk.get(i), summaries.get(i));
                         CommandSupport.step(bar);
                     }
                 }
@@ -23,6 +23,14 @@ import chess.debug.SplitPerft;
  * </p>
  *
  * <p>
+ * When the native library supports it, the expansion moves into the library
+ * as well ({@link NativePerftBackend#foldedPerft(long[], int, int, boolean)}):
+ * only the packed root crosses JNI, and frontier positions reached by several
+ * move orders are counted once and weighted. Older libraries keep the
+ * Java-side expansion.
+ * </p>
+ *
+ * <p>
  * The result is identical to {@code MoveGenerator.perft} regardless of split
  * depth; the split depth only trades CPU expansion cost for device batch size.
  * </p>
@@ -70,7 +78,7 @@ public final class GpuPerft {
     }
 
     /**
-     * Returns the selected backend identifier (cuda/rocm/oneapi/none).
+     * Returns the selected backend identifier (cuda/rocm/oneapi/host/none).
      *
      * @return backend id
      */
@@ -78,6 +86,59 @@ public final class GpuPerft {
         return NativePerftBackend.name();
     }
 
+    /**
+     * Returns per-device node totals accumulated since
+     * {@link #resetDeviceNodes()}; a multi-GPU session spreads every frontier
+     * across all visible devices of the selected vendor.
+     *
+     * @return one node total per device; empty when no device call ran
+     */
+    public static long[] deviceNodes() {
+        return NativePerftBackend.deviceNodes();
+    }
+
+    /**
+     * Clears the per-device node totals reported by {@link #deviceNodes()}.
+     */
+    public static void resetDeviceNodes() {
+        NativePerftBackend.resetDeviceNodes();
+    }
+
+    /**
+     * Returns device transposition-table statistics accumulated since
+     * {@link #resetTableStats()}.
+     *
+     * @return {@code {probes, hits, stores, slots}}; all zero without a table
+     */
+    public static long[] tableStats() {
+        return NativePerftBackend.tableStats();
+    }
+
+    /**
+     * Clears the statistics reported by {@link #tableStats()}.
+     */
+    public static void resetTableStats() {
+        NativePerftBackend.resetTableStats();
+    }
+
+    /**
+     * Returns the frontier folding totals accumulated since
+     * {@link #resetFrontierStats()}.
+     *
+     * @return {@code {frontier positions reached, unique positions counted}};
+     *         all zero when no folded call ran
+     */
+    public static long[] frontierStats() {
+        return NativePerftBackend.frontierStats();
+    }
+
+    /**
+     * Clears the totals reported by {@link #frontierStats()}.
+     */
+    public static void resetFrontierStats() {
+        NativePerftBackend.resetFrontierStats();
+    }
+
     /**
      * Returns a {@link SplitPerft.BulkCounter} backed by the native device.
      *
@@ -85,11 +146,7 @@ public final class GpuPerft {
      */
     public static SplitPerft.BulkCounter bulkCounter() {
         return (frontier, remainingDepth) -> {
-            if (remainingDepth > MAX_REMAINING_DEPTH) {
-                throw new IllegalArgumentException("native perft remaining depth " + remainingDepth
-                        + " exceeds the device limit of " + MAX_REMAINING_DEPTH
-                        + "; raise the split depth so depth - split <= " + MAX_REMAINING_DEPTH);
-            }
+            checkRemainingDepth(remainingDepth);
             return NativePerftBackend.bulkPerft(PositionCodec.pack(frontier), frontier.length, remainingDepth);
         };
     }
@@ -103,6 +160,14 @@ public final class GpuPerft {
      * @return total legal leaf-node count
      */
     public static long perft(Position root, int depth, int splitDepth) {
+        if (depth > 0 && splitDepth >= 0) {
+            checkRemainingDepth(depth - Math.min(splitDepth, depth - 1));
+            long[] folded = NativePerftBackend.foldedPerft(
+                    PositionCodec.pack(new Position[] {root}), depth, splitDepth, false);
+            if (folded != null) {
+                return folded[0];
+            }
+        }
         return SplitPerft.perft(root, depth, splitDepth, bulkCounter());
     }
 
@@ -150,16 +215,17 @@ public final class GpuPerft {
         if (split < 0) {
             split = 0;
         }
+        int remaining = depth - split;
+        checkRemainingDepth(remaining);
+        long[] folded = NativePerftBackend.foldedPerft(
+                PositionCodec.pack(new Position[] {root}), depth, split, true);
+        if (folded != null) {
+            return new Perft.Stats(folded[0], folded[1], folded[2], folded[3], folded[4], folded[5], folded[6]);
+        }
         Position[] frontier = SplitPerft.expandFrontier(root, split);
         if (frontier.length == 0) {
             return new Perft.Stats(0L, 0L, 0L, 0L, 0L, 0L, 0L);
         }
-        int remaining = depth - split;
-        if (remaining > MAX_REMAINING_DEPTH) {
-            throw new IllegalArgumentException("native perft remaining depth " + remaining
-                    + " exceeds the device limit of " + MAX_REMAINING_DEPTH
-                    + "; raise the split depth so depth - split <= " + MAX_REMAINING_DEPTH);
-        }
         long[] flat = NativePerftBackend.bulkPerftDetailed(
                 PositionCodec.pack(frontier), frontier.length, remaining);
         long nodes = 0;
@@ -320,6 +386,21 @@ public final class GpuPerft {
                 checkmates);
     }
 
+    /**
+     * Rejects a per-frontier depth beyond the native kernel stack.
+     *
+     * @param remaining plies counted below each frontier position
+     * @throws IllegalArgumentException when {@code remaining} exceeds
+     *         {@link #MAX_REMAINING_DEPTH}
+     */
+    private static void checkRemainingDepth(int remaining) {
+        if (remaining > MAX_REMAINING_DEPTH) {
+            throw new IllegalArgumentException("native perft remaining depth " + remaining
+                    + " exceeds the device limit of " + MAX_REMAINING_DEPTH
+                    + "; raise the split depth so depth - split <= " + MAX_REMAINING_DEPTH);
+        }
+    }
+
     /**
      * Creates node-only stats.
      *
@@ -7,15 +7,34 @@ import chess.core.Setup;
 import chess.gpu.BackendNames;
 
 /**
- * Selects an available native perft backend (CUDA, ROCm, or oneAPI) and
- * dispatches bulk-perft calls to it.
+ * Selects an available native perft backend (CUDA, ROCm, oneAPI, or the
+ * multi-threaded host CPU library) and dispatches bulk-perft calls to it.
  *
  * <p>
  * Selection mirrors the OTIS model: the {@code crtk.perft.backend} system
- * property forces a specific vendor ({@code cuda}/{@code rocm}/{@code oneapi}),
- * while the default {@code auto} tries CUDA, then ROCm, then oneAPI. There is no
- * dynamic registry; the three vendor backends are enumerated by hand, matching
- * the rest of the codebase.
+ * property forces a specific vendor
+ * ({@code cuda}/{@code rocm}/{@code oneapi}/{@code host}), while the default
+ * {@code auto} tries CUDA, then ROCm, then oneAPI, then the host library, so
+ * CPU-only machines still count natively on every core. There is no dynamic
+ * registry; the vendor backends are enumerated by hand, matching the rest of
+ * the codebase.
+ * </p>
+ *
+ * <p>
+ * Bulk calls go through one persistent native session per process (attack
+ * tables resident on every device, pinned and device buffers reused, chunks
+ * double-buffered across two streams per device). The session spreads each
+ * frontier across all visible devices of the selected vendor, and
+ * {@link #deviceNodes()} reports how the nodes were split. Sessions serve
+ * one call at a time, so dispatch is serialized. Libraries that predate the
+ * session entry points fall back to the one-shot calls on the default device.
+ * </p>
+ *
+ * <p>
+ * {@link #foldedPerft(long[], int, int, boolean)} hands the session a packed
+ * root instead of a frontier: the library expands the split plies itself and
+ * counts each transposed frontier position once, weighted by how often it was
+ * reached. {@link #frontierStats()} reports how much the folding saved.
  * </p>
  *
  * @since 2026
@@ -38,11 +57,63 @@ public final class NativePerftBackend {
      */
     private static volatile Boolean detailedProbeAvailable;
 
+    /**
+     * Frontier positions per device chunk in the persistent session.
+     */
+    private static final int SESSION_CAPACITY = 1 << 15;
+
+    /**
+     * Vendor owning {@link #session}.
+     */
+    private static Vendor sessionVendor;
+
+    /**
+     * Native session handle for {@link #sessionVendor}, or {@code 0} when none.
+     */
+    private static long session;
+
+    /**
+     * Vendor whose library could not provide a session.
+     */
+    private static Vendor sessionUnavailable;
+
+    /**
+     * Per-device node totals accumulated since {@link #resetDeviceNodes()}.
+     */
+    private static long[] deviceNodes = new long[0];
+
+    /**
+     * Transposition-table probes, hits and stores accumulated since
+     * {@link #resetTableStats()}, followed by the latest table slot count.
+     */
+    private static long[] tableStats = new long[4];
+
+    /**
+     * Vendor whose library has no folded-frontier entry points.
+     */
+    private static Vendor foldUnavailable;
+
+    /**
+     * Frontier positions reached and unique positions counted by folded calls
+     * since {@link #resetFrontierStats()}.
+     */
+    private static long[] frontierStats = new long[2];
+
+    /**
+     * Whether the shutdown hook releasing {@link #session} is installed.
+     */
+    private static boolean shutdownHookInstalled;
+
     /**
      * System property selecting a specific native perft backend.
      */
     public static final String BACKEND_PROPERTY = "crtk.perft.backend";
 
+    /**
+     * Identifier reported by {@link #name()} for the host CPU backend.
+     */
+    private static final String HOST_NAME = "host";
+
     /**
      * Utility class; prevents instantiation.
      */
@@ -64,7 +135,11 @@ public final class NativePerftBackend {
         /**
          * Intel oneAPI/SYCL backend.
          */
-        ONEAPI
+        ONEAPI,
+        /**
+         * Multi-threaded host CPU backend.
+         */
+        HOST
     }
 
     /**
@@ -120,7 +195,7 @@ public final class NativePerftBackend {
     /**
      * Returns the selected backend identifier for diagnostics.
      *
-     * @return backend id (cuda/rocm/oneapi), or "none"
+     * @return backend id (cuda/rocm/oneapi/host), or "none"
      */
     public static String name() {
         Vendor vendor = select();
@@ -131,6 +206,7 @@ public final class NativePerftBackend {
             case CUDA -> BackendNames.CUDA;
             case ROCM -> BackendNames.ROCM;
             case ONEAPI -> BackendNames.ONEAPI;
+            case HOST -> HOST_NAME;
         };
     }
 
@@ -149,11 +225,7 @@ public final class NativePerftBackend {
         if (vendor == null) {
             throw new IllegalStateException("no native perft backend available");
         }
-        long[] counts = switch (vendor) {
-            case CUDA -> chess.nn.perft.cuda.Backend.bulkPerft(packed, count, remainingDepth);
-            case ROCM -> chess.nn.perft.rocm.Backend.bulkPerft(packed, count, remainingDepth);
-            case ONEAPI -> chess.nn.perft.oneapi.Backend.bulkPerft(packed, count, remainingDepth);
-        };
+        long[] counts = dispatch(vendor, packed, count, remainingDepth, false);
         if (counts == null) {
             throw new IllegalStateException("native perft backend (" + vendor + ") returned no result");
         }
@@ -175,13 +247,298 @@ public final class NativePerftBackend {
         if (vendor == null) {
             throw new IllegalStateException("no native perft backend available");
         }
-        long[] counts = bulkPerftDetailed(vendor, packed, count, remainingDepth);
+        long[] counts = dispatch(vendor, packed, count, remainingDepth, true);
         if (counts == null) {
             throw new IllegalStateException("native perft backend (" + vendor + ") returned no result");
         }
         return counts;
     }
 
+    /**
+     * Counts {@code perft(depth)} below one root through the selected vendor's
+     * session, with the first {@code splitDepth} plies expanded natively and
+     * duplicate frontier positions folded.
+     *
+     * @param packedRoot packed root position ({@code PositionCodec.WORDS} longs)
+     * @param depth total perft depth, positive
+     * @param splitDepth plies expanded before counting; clamped natively to
+     *        {@code [0, depth - 1]}
+     * @param detailed true for the 7-counter layout
+     * @return the counters (1 or 7) followed by frontier and unique position
+     *         counts, or {@code null} when the backend has no session or no
+     *         folded entry point, or the native call fails
+     */
+    public static synchronized long[] foldedPerft(long[] packedRoot, int depth, int splitDepth, boolean detailed) {
+        Vendor vendor = select();
+        if (vendor == null || vendor == foldUnavailable) {
+            return null;
+        }
+        long handle = session(vendor);
+        if (handle == 0L) {
+            return null;
+        }
+        long[] result;
+        try {
+            result = switch (vendor) {
+                case CUDA -> detailed
+                        ? chess.nn.perft.cuda.Backend.sessionFoldedPerftDetailed(handle, packedRoot, depth, splitDepth)
+                        : chess.nn.perft.cuda.Backend.sessionFoldedPerft(handle, packedRoot, depth, splitDepth);
+                case ROCM -> detailed
+                        ? chess.nn.perft.rocm.Backend.sessionFoldedPerftDetailed(handle, packedRoot, depth, splitDepth)
+                        : chess.nn.perft.rocm.Backend.sessionFoldedPerft(handle, packedRoot, depth, splitDepth);
+                case ONEAPI -> detailed
+                        ? chess.nn.perft.oneapi.Backend.sessionFoldedPerftDetailed(
+                                handle, packedRoot, depth, splitDepth)
+                        : chess.nn.perft.oneapi.Backend.sessionFoldedPerft(handle, packedRoot, depth, splitDepth);
+                case HOST -> detailed
+                        ? chess.nn.perft.host.Backend.sessionFoldedPerftDetailed(handle, packedRoot, depth, splitDepth)
+                        : chess.nn.perft.host.Backend.sessionFoldedPerft(handle, packedRoot, depth, splitDepth);
+            };
+        } catch (UnsatisfiedLinkError ex) {
+            foldUnavailable = vendor;
+            return null;
+        }
+        int fields = detailed ? DETAIL_FIELDS : 1;
+        if (result == null || result.length != fields + 2) {
+            return null;
+        }
+        accumulateDeviceNodes(vendor, handle);
+        accumulateTableStats(vendor, handle);
+        frontierStats[0] += result[fields];
+        frontierStats[1] += result[fields + 1];
+        return result;
+    }
+
+    /**
+     * Returns the frontier folding totals of folded calls since the last
+     * {@link #resetFrontierStats()}.
+     *
+     * @return {@code {frontier positions reached, unique positions counted}}
+     */
+    public static synchronized long[] frontierStats() {
+        return frontierStats.clone();
+    }
+
+    /**
+     * Clears the totals reported by {@link #frontierStats()}.
+     */
+    public static synchronized void resetFrontierStats() {
+        frontierStats = new long[2];
+    }
+
+    /**
+     * Returns the per-device node totals accumulated by session bulk calls since
+     * the last {@link #resetDeviceNodes()}, for load-balance diagnostics.
+     *
+     * @return one node total per device; empty when no session call ran
+     */
+    public static synchronized long[] deviceNodes() {
+        return deviceNodes.clone();
+    }
+
+    /**
+     * Clears the totals reported by {@link #deviceNodes()}.
+     */
+    public static synchronized void resetDeviceNodes() {
+        deviceNodes = new long[0];
+    }
+
+    /**
+     * Returns the device transposition-table statistics accumulated by session
+     * bulk calls since the last {@link #resetTableStats()}.
+     *
+     * <p>
+     * The table is enabled natively ({@code CRTK_PERFT_CUDA_TT_MB} /
+     * {@code CRTK_PERFT_ROCM_TT_MB}); without it every entry is zero.
+     * </p>
+     *
+     * @return {@code {probes, hits, stores, slots}}
+     */
+    public static synchronized long[] tableStats() {
+        return tableStats.clone();
+    }
+
+    /**
+     * Clears the totals reported by {@link #tableStats()}.
+     */
+    public static synchronized void resetTableStats() {
+        tableStats = new long[4];
+    }
+
+    /**
+     * Routes one bulk call through the vendor's persistent session, or through
+     * the one-shot entry points when no session is available.
+     *
+     * @param vendor selected backend vendor
+     * @param packed packed positions
+     * @param count number of packed positions
+     * @param remainingDepth depth below each packed position
+     * @param detailed true for the 7-counter layout
+     * @return flat counters, or null on native failure
+     */
+    private static synchronized long[] dispatch(
+            Vendor vendor, long[] packed, int count, int remainingDepth, boolean detailed) {
+        long handle = session(vendor);
+        if (handle == 0L) {
+            return detailed
+                    ? bulkPerftDetailed(vendor, packed, count, remainingDepth)
+                    : bulkPerftOnce(vendor, packed, count, remainingDepth);
+        }
+        long[] counts = switch (vendor) {
+            case CUDA -> detailed
+                    ? chess.nn.perft.cuda.Backend.sessionBulkPerftDetailed(handle, packed, count, remainingDepth)
+                    : chess.nn.perft.cuda.Backend.sessionBulkPerft(handle, packed, count, remainingDepth);
+            case ROCM -> detailed
+                    ? chess.nn.perft.rocm.Backend.sessionBulkPerftDetailed(handle, packed, count, remainingDepth)
+                    : chess.nn.perft.rocm.Backend.sessionBulkPerft(handle, packed, count, remainingDepth);
+            case ONEAPI -> detailed
+                    ? chess.nn.perft.oneapi.Backend.sessionBulkPerftDetailed(handle, packed, count, remainingDepth)
+                    : chess.nn.perft.oneapi.Backend.sessionBulkPerft(handle, packed, count, remainingDepth);
+            case HOST -> detailed
+                    ? chess.nn.perft.host.Backend.sessionBulkPerftDetailed(handle, packed, count, remainingDepth)
+                    : chess.nn.perft.host.Backend.sessionBulkPerft(handle, packed, count, remainingDepth);
+        };
+        if (counts != null) {
+            accumulateDeviceNodes(vendor, handle);
+            accumulateTableStats(vendor, handle);
+        }
+        return counts;
+    }
+
+    /**
+     * Adds the session's per-device totals for the call that just finished.
+     *
+     * @param vendor session vendor
+     * @param handle native session handle
+     */
+    private static void accumulateDeviceNodes(Vendor vendor, long handle) {
+        long[] last = switch (vendor) {
+            case CUDA -> chess.nn.perft.cuda.Backend.sessionDeviceNodes(handle);
+            case ROCM -> chess.nn.perft.rocm.Backend.sessionDeviceNodes(handle);
+            case ONEAPI -> chess.nn.perft.oneapi.Backend.sessionDeviceNodes(handle);
+            case HOST -> chess.nn.perft.host.Backend.sessionDeviceNodes(handle);
+        };
+        if (last == null) {
+            return;
+        }
+        if (deviceNodes.length != last.length) {
+            deviceNodes = new long[last.length];
+        }
+        for (int i = 0; i < last.length; i++) {
+            deviceNodes[i] += last[i];
+        }
+    }
+
+    /**
+     * Adds the session's transposition-table statistics for the call that just
+     * finished. The oneAPI and host backends and libraries built before the
+     * table have none.
+     *
+     * @param vendor session vendor
+     * @param handle native session handle
+     */
+    private static void accumulateTableStats(Vendor vendor, long handle) {
+        long[] last;
+        try {
+            last = switch (vendor) {
+                case CUDA -> chess.nn.perft.cuda.Backend.sessionTableStats(handle);
+                case ROCM -> chess.nn.perft.rocm.Backend.sessionTableStats(handle);
+                case ONEAPI, HOST -> null;
+            };
+        } catch (UnsatisfiedLinkError ex) {
+            last = null;
+        }
+        if (last == null || last.length < 4) {
+            return;
+        }
+        for (int i = 0; i < 3; i++) {
+            tableStats[i] += last[i];
+        }
+        tableStats[3] = last[3];
+    }
+
+    /**
+     * Returns the persistent session for a vendor, creating it on first use and
+     * releasing a session held for a different vendor.
+     *
+     * @param vendor selected backend vendor
+     * @return native session handle, or {@code 0} when the library has none
+     */
+    private static long session(Vendor vendor) {
+        if (session != 0L && vendor == sessionVendor) {
+            return session;
+        }
+        if (vendor == sessionUnavailable) {
+            return 0L;
+        }
+        closeSession();
+        long handle;
+        try {
+            handle = switch (vendor) {
+                case CUDA -> chess.nn.perft.cuda.Backend.createSession(SESSION_CAPACITY);
+                case ROCM -> chess.nn.perft.rocm.Backend.createSession(SESSION_CAPACITY);
+                case ONEAPI -> chess.nn.perft.oneapi.Backend.createSession(SESSION_CAPACITY);
+                case HOST -> chess.nn.perft.host.Backend.createSession(SESSION_CAPACITY);
+            };
+        } catch (UnsatisfiedLinkError ex) {
+            handle = 0L;
+        }
+        if (handle == 0L) {
+            sessionUnavailable = vendor;
+            return 0L;
+        }
+        session = handle;
+        sessionVendor = vendor;
+        if (!shutdownHookInstalled) {
+            Runtime.getRuntime().addShutdownHook(new Thread(NativePerftBackend::closeSessionSynchronized,
+                    "crtk-perft-session-close"));
+            shutdownHookInstalled = true;
+        }
+        return handle;
+    }
+
+    /**
+     * Releases the current session, if any. Caller holds the class lock.
+     */
+    private static void closeSession() {
+        if (session == 0L) {
+            return;
+        }
+        switch (sessionVendor) {
+            case CUDA -> chess.nn.perft.cuda.Backend.destroySession(session);
+            case ROCM -> chess.nn.perft.rocm.Backend.destroySession(session);
+            case ONEAPI -> chess.nn.perft.oneapi.Backend.destroySession(session);
+            case HOST -> chess.nn.perft.host.Backend.destroySession(session);
+        }
+        session = 0L;
+        sessionVendor = null;
+    }
+
+    /**
+     * Shutdown-hook entry point for {@link #closeSession()}.
+     */
+    private static synchronized void closeSessionSynchronized() {
+        closeSession();
+    }
+
+    /**
+     * Dispatches one-shot node-count bulk perft to an explicit vendor.
+     *
+     * @param vendor selected backend vendor
+     * @param packed packed positions
+     * @param count number of packed positions
+     * @param remainingDepth depth below each packed position
+     * @return per-position node counts, or null on native failure
+     */
+    private static long[] bulkPerftOnce(Vendor vendor, long[] packed, int count, int remainingDepth) {
+        return switch (vendor) {
+            case CUDA -> chess.nn.perft.cuda.Backend.bulkPerft(packed, count, remainingDepth);
+            case ROCM -> chess.nn.perft.rocm.Backend.bulkPerft(packed, count, remainingDepth);
+            case ONEAPI -> chess.nn.perft.oneapi.Backend.bulkPerft(packed, count, remainingDepth);
+            case HOST -> chess.nn.perft.host.Backend.bulkPerft(packed, count, remainingDepth);
+        };
+    }
+
     /**
      * Probes the detailed JNI entry point for a vendor.
      *
@@ -214,6 +571,7 @@ public final class NativePerftBackend {
             case CUDA -> chess.nn.perft.cuda.Backend.bulkPerftDetailed(packed, count, remainingDepth);
             case ROCM -> chess.nn.perft.rocm.Backend.bulkPerftDetailed(packed, count, remainingDepth);
             case ONEAPI -> chess.nn.perft.oneapi.Backend.bulkPerftDetailed(packed, count, remainingDepth);
+            case HOST -> chess.nn.perft.host.Backend.bulkPerftDetailed(packed, count, remainingDepth);
         };
     }
 
@@ -228,12 +586,14 @@ public final class NativePerftBackend {
             case "cuda" -> chess.nn.perft.cuda.Backend.isAvailable() ? Vendor.CUDA : null;
             case "rocm", "amd", "hip" -> chess.nn.perft.rocm.Backend.isAvailable() ? Vendor.ROCM : null;
             case "oneapi", "intel", "sycl" -> chess.nn.perft.oneapi.Backend.isAvailable() ? Vendor.ONEAPI : null;
+            case "host", "cpu" -> chess.nn.perft.host.Backend.isAvailable() ? Vendor.HOST : null;
             default -> auto();
         };
     }
 
     /**
-     * Auto-selects the first available backend (CUDA, then ROCm, then oneAPI).
+     * Auto-selects the first available backend (CUDA, then ROCm, then oneAPI,
+     * then the host CPU library).
      *
      * @return first available vendor, or null
      */
@@ -247,6 +607,9 @@ public final class NativePerftBackend {
         if (chess.nn.perft.oneapi.Backend.isAvailable()) {
             return Vendor.ONEAPI;
         }
+        if (chess.nn.perft.host.Backend.isAvailable()) {
+            return Vendor.HOST;
+        }
         return null;
     }
 }
@@ -25,6 +25,11 @@ public final class BackendNames {
      */
     public static final String ONEAPI = "oneapi";
 
+    /**
+     * Native CPU (host JNI) backend identifier.
+     */
+    public static final String HOST = "host";
+
      /**
      * Creates a new backend names instance.
      */
@@ -0,0 +1,234 @@
+package chess.gpu;
+
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.CompletableFuture;
+import java.util.function.LongConsumer;
+
+/**
+ * Coalescing evaluation queue over one native GPU backend handle.
+ *
+ * <p>Search threads call {@link #submit(float[])} with one encoded position and
+ * get a future back without blocking. A native dispatcher thread gathers
+ * pending positions into batches, bounded by the queue's maximum batch size or
+ * by a microsecond deadline after the oldest submission, and runs the backend's
+ * batched forward pass. One Java completion thread drains finished results and
+ * completes the matching futures.
+ *
+ * <p>The native dispatcher is the only thread that touches the backend handle
+ * while the queue is open, so callers must not run direct predicts on the same
+ * backend concurrently. Closing the queue evaluates everything already
+ * submitted before it returns.
+ *
+ * @param <P> per-position prediction type
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class EvalQueue<P> implements AutoCloseable {
+
+    /**
+     * Default deadline in microseconds after which a partial batch is run.
+     */
+    public static final long DEFAULT_DEADLINE_MICROS = 250L;
+
+    /**
+     * Native submit entry point.
+     */
+    @FunctionalInterface
+    public interface Submitter {
+        /**
+         * Copies one encoded position into the native queue.
+         *
+         * @param queue native queue handle
+         * @param encodedPlanes encoded input planes
+         * @return positive ticket, or zero if the queue is closed or the input is invalid
+         */
+        long submit(long queue, float[] encodedPlanes);
+    }
+
+    /**
+     * Native take entry point.
+     */
+    @FunctionalInterface
+    public interface Taker {
+        /**
+         * Blocks until one result is ready.
+         *
+         * @param queue native queue handle
+         * @param outPolicy policy output buffer
+         * @param outWdl WDL output buffer
+         * @return the ticket on success, the negated ticket on evaluation failure,
+         *         or zero once the queue is closed and drained
+         */
+        long take(long queue, float[] outPolicy, float[] outWdl);
+    }
+
+    /**
+     * Native queue entry points exported by one backend.
+     *
+     * @param submit copies one position into the queue
+     * @param take blocks until one result is ready
+     * @param close stops the dispatcher after evaluating pending positions
+     * @param destroy frees the native queue
+     */
+    public record Ops(Submitter submit, Taker take, LongConsumer close, LongConsumer destroy) {
+    }
+
+    /**
+     * Wraps native outputs into the backend's prediction type.
+     *
+     * @param <P> prediction type
+     */
+    @FunctionalInterface
+    public interface ResultFactory<P> {
+        /**
+         * Creates one prediction.
+         *
+         * @param policy policy output, owned by the prediction
+         * @param wdl WDL output, owned by the prediction
+         * @return wrapped prediction
+         */
+        P create(float[] policy, float[] wdl);
+    }
+
+    /**
+     * Native queue handle.
+     */
+    private final long queue;
+
+    /**
+     * Encoded floats per position.
+     */
+    private final int inputSize;
+
+    /**
+     * Policy floats per position.
+     */
+    private final int policySize;
+
+    /**
+     * Native entry points.
+     */
+    private final Ops ops;
+
+    /**
+     * Prediction wrapper.
+     */
+    private final ResultFactory<P> results;
+
+    /**
+     * Futures by native ticket; guarded by itself.
+     */
+    private final Map<Long, CompletableFuture<P>> futures = new HashMap<>();
+
+    /**
+     * Thread draining native results.
+     */
+    private final Thread completer;
+
+    /**
+     * Whether {@link #close()} already ran; guarded by {@link #futures}.
+     */
+    private boolean closed;
+
+    /**
+     * Wraps a native queue and starts its completion thread.
+     *
+     * @param queue native queue handle, non-zero
+     * @param inputSize encoded floats per position
+     * @param policySize policy floats per position
+     * @param ops native entry points
+     * @param results prediction wrapper
+     * @param name completion thread name
+     */
+    public EvalQueue(long queue, int inputSize, int policySize, Ops ops, ResultFactory<P> results, String name) {
+        if (queue == 0L) {
+            throw new IllegalStateException("Failed to create native evaluation queue.");
+        }
+        this.queue = queue;
+        this.inputSize = inputSize;
+        this.policySize = policySize;
+        this.ops = ops;
+        this.results = results;
+        this.completer = new Thread(this::drain, name);
+        this.completer.setDaemon(true);
+        this.completer.start();
+    }
+
+    /**
+     * Queues one encoded position for evaluation.
+     *
+     * @param encodedPlanes encoded input planes
+     * @return future completed with the prediction, or exceptionally if the
+     *         batch containing the position failed or the queue is closed
+     */
+    public CompletableFuture<P> submit(float[] encodedPlanes) {
+        if (encodedPlanes == null || encodedPlanes.length != inputSize) {
+            throw new IllegalArgumentException("Encoded input must be " + inputSize + " floats.");
+        }
+        CompletableFuture<P> future = new CompletableFuture<>();
+        synchronized (futures) {
+            long ticket = closed ? 0L : ops.submit().submit(queue, encodedPlanes);
+            if (ticket <= 0L) {
+                future.completeExceptionally(new IllegalStateException("Evaluation queue is closed."));
+            } else {
+                futures.put(ticket, future);
+            }
+        }
+        return future;
+    }
+
+    /**
+     * Completion loop: hands each native result to its future until the queue
+     * reports that it is closed and drained.
+     */
+    private void drain() {
+        for (;;) {
+            float[] policy = new float[policySize];
+            float[] wdl = new float[3];
+            long ticket = ops.take().take(queue, policy, wdl);
+            if (ticket == 0L) {
+                return;
+            }
+            CompletableFuture<P> future;
+            synchronized (futures) {
+                future = futures.remove(Math.abs(ticket));
+            }
+            if (future == null) {
+                continue;
+            }
+            if (ticket > 0L) {
+                future.complete(results.create(policy, wdl));
+            } else {
+                future.completeExceptionally(new IllegalStateException("Native batched prediction failed."));
+            }
+        }
+    }
+
+    /**
+     * Evaluates the positions still pending, completes their futures and
+     * releases the native queue.
+     */
+    @Override
+    public void close() {
+        synchronized (futures) {
+            if (closed) {
+                return;
+            }
+            closed = true;
+        }
+        ops.close().accept(queue);
+        boolean interrupted = false;
+        while (completer.isAlive()) {
+            try {
+                completer.join();
+            } catch (InterruptedException e) {
+                interrupted = true;
+            }
+        }
+        ops.destroy().accept(queue);
+        if (interrupted) {
+            Thread.currentThread().interrupt();
+        }
+    }
+}
@@ -0,0 +1,307 @@
+package chess.gpu;
+
+import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.function.LongConsumer;
+
+/**
+ * Java-side glue shared by the thin JNI-backed network backends.
+ *
+ * <p>The LC0 CNN, BT4 and OTIS backends on CUDA, ROCm, oneAPI and the host all
+ * expose the same native surface: create, get-info, batched predict from
+ * encoded or packed planes, and destroy. This class owns the creation flow
+ * and the batch flattening and splitting; each family's
+ * {@code NativeBackendOps} only maps the raw native metadata onto its own
+ * {@code Info} type and describes its tensor sizes with a {@link Layout}.
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class NativeOps {
+
+    /**
+     * Utility class, prevents instantiation.
+     */
+    private NativeOps() {
+    }
+
+    /**
+     * Common result of native backend creation.
+     *
+     * @param <I> family metadata type
+     * @param handle native backend handle
+     * @param info parsed network metadata
+     */
+    public record Created<I>(long handle, I info) {
+    }
+
+    /**
+     * Per-position tensor sizes of one loaded network.
+     *
+     * @param <P> per-position prediction type
+     * @param inputSize encoded floats per position
+     * @param planes input plane count, which sets the packed size (see {@link PackedPlanes})
+     * @param policySize policy floats per position
+     * @param results prediction wrapper
+     */
+    public record Layout<P>(int inputSize, int planes, int policySize, PredictionFactory<P> results) {
+    }
+
+    /**
+     * Functional interface for native evaluator creation.
+     */
+    @FunctionalInterface
+    public interface HandleCreator {
+        /**
+         * Creates a native evaluator for the given weights path.
+         *
+         * @param weightsPath absolute path to the weights file
+         * @return native handle, or zero on failure
+         */
+        long create(String weightsPath);
+    }
+
+    /**
+     * Functional interface for native metadata lookup.
+     */
+    @FunctionalInterface
+    public interface InfoReader {
+        /**
+         * Reads network metadata from the native backend.
+         *
+         * @param handle native backend handle
+         * @return raw metadata array, or {@code null} on failure
+         */
+        long[] read(long handle);
+    }
+
+    /**
+     * Maps raw native metadata onto a family's metadata type.
+     *
+     * @param <I> family metadata type
+     */
+    @FunctionalInterface
+    public interface InfoMapper<I> {
+        /**
+         * Builds the family metadata.
+         *
+         * @param handle native backend handle, for any further lookups
+         * @param meta raw metadata, at least as long as the family requires
+         * @return parsed metadata
+         */
+        I map(long handle, long[] meta);
+    }
+
+    /**
+     * Wraps native outputs into the backend's prediction type.
+     *
+     * @param <P> prediction type
+     */
+    @FunctionalInterface
+    public interface PredictionFactory<P> {
+        /**
+         * Creates one prediction.
+         *
+         * @param policy policy output, owned by the prediction
+         * @param wdl WDL output, owned by the prediction
+         * @param value scalar value output
+         * @return wrapped prediction
+         */
+        P create(float[] policy, float[] wdl, float value);
+    }
+
+    /**
+     * Functional interface for native batched prediction.
+     */
+    @FunctionalInterface
+    public interface BatchPredictor {
+        /**
+         * Runs prediction on {@code count} encoded positions stored back to back.
+         *
+         * @param handle native backend handle
+         * @param encodedBatch flat encoded planes, {@code count * inputSize} floats
+         * @param count number of positions
+         * @param outPolicy output policy buffer, {@code count * policySize} floats
+         * @param outWdl output WDL buffer, {@code count * 3} floats
+         * @param outValue output scalar values, {@code count} floats
+         * @return number of positions evaluated, or zero on failure
+         */
+        int predictBatch(long handle, float[] encodedBatch, int count, float[] outPolicy, float[] outWdl,
+                float[] outValue);
+    }
+
+    /**
+     * Functional interface for native batched prediction from packed planes.
+     */
+    @FunctionalInterface
+    public interface PackedBatchPredictor {
+        /**
+         * Runs prediction on {@code count} packed positions stored back to back.
+         *
+         * @param handle native backend handle
+         * @param packedBatch flat packed planes, {@code count * (planes + 1)} longs
+         *                    (see {@link PackedPlanes})
+         * @param count number of positions
+         * @param outPolicy output policy buffer, {@code count * policySize} floats
+         * @param outWdl output WDL buffer, {@code count * 3} floats
+         * @param outValue output scalar values, {@code count} floats
+         * @return number of positions evaluated, or zero on failure
+         */
+        int predictPacked(long handle, long[] packedBatch, int count, float[] outPolicy, float[] outWdl,
+                float[] outValue);
+    }
+
+    /**
+     * Runs the common backend creation flow.
+     *
+     * <p>The handle is destroyed again when the metadata is missing or shorter
+     * than {@code infoFields}.
+     *
+     * @param <I> family metadata type
+     * @param weightsBin path to the weights file
+     * @param creator native handle creator
+     * @param infoReader native metadata reader
+     * @param infoFields minimum metadata length
+     * @param mapper family metadata mapping
+     * @param destroyer native destroy function
+     * @param createFailure message used when creation fails
+     * @param infoFailure message used when metadata is invalid
+     * @return created native backend handle and metadata
+     * @throws IllegalStateException if creation fails or the metadata is invalid
+     */
+    public static <I> Created<I> create(
+            Path weightsBin,
+            HandleCreator creator,
+            InfoReader infoReader,
+            int infoFields,
+            InfoMapper<I> mapper,
+            LongConsumer destroyer,
+            String createFailure,
+            String infoFailure) {
+        long handle = creator.create(weightsBin.toAbsolutePath().toString());
+        if (handle == 0L) {
+            throw new IllegalStateException(createFailure);
+        }
+        long[] meta = infoReader.read(handle);
+        if (meta == null || meta.length < infoFields) {
+            destroyer.accept(handle);
+            throw new IllegalStateException(infoFailure);
+        }
+        return new Created<>(handle, mapper.map(handle, meta));
+    }
+
+    /**
+     * Runs the common Java-side batch validation, packs the batch into one flat
+     * array, and splits the native outputs back into per-position predictions.
+     *
+     * @param <P> prediction type
+     * @param handle native backend handle
+     * @param layout tensor sizes of the loaded network
+     * @param encodedBatch encoded input planes aligned by position
+     * @param predictor native batched predictor
+     * @return predictions aligned with {@code encodedBatch}
+     * @throws IllegalArgumentException if an input has the wrong length
+     * @throws IllegalStateException if the native batch call fails
+     */
+    public static <P> List<P> predictEncodedBatch(
+            long handle,
+            Layout<P> layout,
+            List<float[]> encodedBatch,
+            BatchPredictor predictor) {
+        int count = encodedBatch.size();
+        if (count == 0) {
+            return new ArrayList<>();
+        }
+        int stride = layout.inputSize();
+        float[] flat = new float[count * stride];
+        for (int i = 0; i < count; i++) {
+            float[] encodedPlanes = encodedBatch.get(i);
+            if (encodedPlanes == null || encodedPlanes.length != stride) {
+                throw new IllegalArgumentException("Encoded input must be " + stride + " floats.");
+            }
+            System.arraycopy(encodedPlanes, 0, flat, i * stride, stride);
+        }
+        float[] policy = new float[count * layout.policySize()];
+        float[] wdl = new float[count * 3];
+        float[] values = new float[count];
+        if (predictor.predictBatch(handle, flat, count, policy, wdl, values) != count) {
+            throw new IllegalStateException("Native batched prediction failed.");
+        }
+        return split(layout, count, policy, wdl, values);
+    }
+
+    /**
+     * Runs the common Java-side validation for a packed batch, flattens it, and
+     * splits the native outputs back into per-position predictions.
+     *
+     * @param <P> prediction type
+     * @param handle native backend handle
+     * @param layout tensor sizes of the loaded network
+     * @param packedBatch packed input planes aligned by position
+     * @param predictor native packed predictor
+     * @return predictions aligned with {@code packedBatch}
+     * @throws IllegalArgumentException if an input has the wrong length
+     * @throws IllegalStateException if the native batch call fails
+     */
+    public static <P> List<P> predictPackedBatch(
+            long handle,
+            Layout<P> layout,
+            List<long[]> packedBatch,
+            PackedBatchPredictor predictor) {
+        int count = packedBatch.size();
+        if (count == 0) {
+            return new ArrayList<>();
+        }
+        int stride = PackedPlanes.words(layout.planes());
+        long[] flat = new long[count * stride];
+        for (int i = 0; i < count; i++) {
+            long[] packed = packedBatch.get(i);
+            if (packed == null || packed.length != stride) {
+                throw new IllegalArgumentException("Packed input must be " + stride + " longs.");
+            }
+            System.arraycopy(packed, 0, flat, i * stride, stride);
+        }
+        float[] policy = new float[count * layout.policySize()];
+        float[] wdl = new float[count * 3];
+        float[] values = new float[count];
+        if (predictor.predictPacked(handle, flat, count, policy, wdl, values) != count) {
+            throw new IllegalStateException("Native packed prediction failed.");
+        }
+        return split(layout, count, policy, wdl, values);
+    }
+
+    /**
+     * Releases a native handle through the provided destroy function.
+     *
+     * @param handle native backend handle
+     * @param destroyer native destroy function
+     */
+    public static void destroy(long handle, LongConsumer destroyer) {
+        destroyer.accept(handle);
+    }
+
+    /**
+     * Splits flat batch outputs into per-position predictions.
+     *
+     * @param <P> prediction type
+     * @param layout tensor sizes of the loaded network
+     * @param count number of positions
+     * @param policy flat policy outputs
+     * @param wdl flat WDL outputs
+     * @param values scalar values
+     * @return predictions in batch order
+     */
+    private static <P> List<P> split(Layout<P> layout, int count, float[] policy, float[] wdl, float[] values) {
+        int policySize = layout.policySize();
+        List<P> out = new ArrayList<>(count);
+        for (int i = 0; i < count; i++) {
+            out.add(layout.results().create(
+                    Arrays.copyOfRange(policy, i * policySize, (i + 1) * policySize),
+                    Arrays.copyOfRange(wdl, i * 3, i * 3 + 3),
+                    values[i]));
+        }
+        return out;
+    }
+}
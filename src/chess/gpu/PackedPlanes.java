@@ -0,0 +1,133 @@
+package chess.gpu;
+
+/**
+ * Compact bitboard form of neural-network input planes, expanded to floats on
+ * the device.
+ *
+ * <p>Every plane of the LC0 112-plane and OTIS simple_18 encodings is either a
+ * set of squares holding {@code 1.0} or a constant fill (the LC0 rule-50
+ * counter). One position therefore packs into one 64-bit square mask per plane
+ * plus a trailing scalar word: {@code planes + 1} longs, 904 bytes for 112
+ * planes instead of 28 KiB of floats. The GPU backends' {@code nativePredictPacked}
+ * entry points upload this form and expand it into the input tensor in a
+ * kernel; {@link #expand(long[], int)} is the matching host expansion used by
+ * the Java encoders, so both paths see identical planes.
+ *
+ * <p>Layout of one position ({@code words(planes)} longs):
+ * <ul>
+ * <li>{@code words[c]} for {@code c < planes}: bit {@code s} set means element
+ * {@code c * 64 + s} is non-zero</li>
+ * <li>{@code words[planes]}: low 32 bits hold the float bits of the value
+ * written to the set squares of one scalar plane, high 32 bits that plane's
+ * index, or {@code 0xFFFFFFFF} when every set square is {@code 1.0}</li>
+ * </ul>
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class PackedPlanes {
+
+    /**
+     * Square mask with all 64 squares set.
+     */
+    public static final long ALL_SQUARES = -1L;
+
+    /**
+     * Scalar word of a position without a scalar plane.
+     */
+    private static final long NO_SCALAR = 0xFFFFFFFF00000000L;
+
+    /**
+     * Squares per plane.
+     */
+    private static final int SQUARES = 64;
+
+    /**
+     * Utility class; prevents instantiation.
+     */
+    private PackedPlanes() {
+    }
+
+    /**
+     * Returns the packed size of one position.
+     *
+     * @param planes input plane count
+     * @return longs per packed position
+     */
+    public static int words(int planes) {
+        return planes + 1;
+    }
+
+    /**
+     * Allocates one empty packed position.
+     *
+     * @param planes input plane count
+     * @return zeroed masks followed by an empty scalar word
+     */
+    public static long[] allocate(int planes) {
+        long[] packed = new long[words(planes)];
+        packed[planes] = NO_SCALAR;
+        return packed;
+    }
+
+    /**
+     * Fills one plane with a constant, as a float encoder's fill would.
+     *
+     * @param packed packed position
+     * @param planes input plane count
+     * @param plane plane index
+     * @param value constant written to all 64 squares
+     * @throws IllegalStateException if a different plane already holds the
+     *         position's non-unit constant
+     */
+    public static void fill(long[] packed, int planes, int plane, float value) {
+        packed[plane] = ALL_SQUARES;
+        if (value == 1.0f) {
+            return;
+        }
+        int current = (int) (packed[planes] >>> 32);
+        if (current != -1 && current != plane) {
+            throw new IllegalStateException("packed planes hold one scalar plane; " + current
+                    + " already set, cannot add " + plane);
+        }
+        packed[planes] = ((long) plane << 32) | (Float.floatToRawIntBits(value) & 0xFFFFFFFFL);
+    }
+
+    /**
+     * Expands one packed position into channel-major float planes.
+     *
+     * @param packed packed position, {@code words(planes)} longs
+     * @param planes input plane count
+     * @return {@code planes * 64} floats
+     */
+    public static float[] expand(long[] packed, int planes) {
+        float[] out = new float[planes * SQUARES];
+        expand(packed, 0, planes, out, 0);
+        return out;
+    }
+
+    /**
+     * Expands one packed position into channel-major float planes.
+     *
+     * @param packed packed positions
+     * @param offset first word of the position
+     * @param planes input plane count
+     * @param out zero-filled destination
+     * @param outOffset first destination float
+     */
+    public static void expand(long[] packed, int offset, int planes, float[] out, int outOffset) {
+        long scalar = packed[offset + planes];
+        int scalarPlane = (int) (scalar >>> 32);
+        float scalarValue = Float.intBitsToFloat((int) scalar);
+        for (int plane = 0; plane < planes; plane++) {
+            long bits = packed[offset + plane];
+            float value = plane == scalarPlane ? scalarValue : 1.0f;
+            int base = outOffset + plane * SQUARES;
+            while (bits != 0L) {
+                int sq = Long.numberOfTrailingZeros(bits);
+                out[base + sq] = value;
+                bits &= bits - 1L;
+            }
+        }
+    }
+}
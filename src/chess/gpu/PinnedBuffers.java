@@ -0,0 +1,188 @@
+package chess.gpu;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+
+/**
+ * Page-locked input/output buffers owned by one native GPU backend handle.
+ *
+ * <p>The native side allocates the memory once per handle with the vendor's
+ * pinned allocator and exposes it as direct buffers, so encoded planes are
+ * written and predictions read in place. {@link #predict(int)} copies straight
+ * between this memory and the device with async transfers: no JNI array copies
+ * and no per-call allocation on the native side.
+ *
+ * <p>Like the handle itself, one instance serves one predict at a time; the
+ * contents of the output views are overwritten by the next predict.
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class PinnedBuffers {
+
+    /**
+     * Native pinned-predict entry point.
+     */
+    @FunctionalInterface
+    public interface Runner {
+        /**
+         * Evaluates the first {@code count} positions of the pinned input.
+         *
+         * @param handle native backend handle
+         * @param count number of positions
+         * @return number of positions evaluated, or zero on failure
+         */
+        int run(long handle, int count);
+    }
+
+    /**
+     * Native backend handle.
+     */
+    private final long handle;
+
+    /**
+     * Encoded input planes, {@code [maxBatch][inputSize]}.
+     */
+    private final FloatBuffer input;
+
+    /**
+     * Policy output, {@code [maxBatch][policySize]}.
+     */
+    private final FloatBuffer policy;
+
+    /**
+     * WDL output, {@code [maxBatch][3]}.
+     */
+    private final FloatBuffer wdl;
+
+    /**
+     * Encoded floats per position.
+     */
+    private final int inputSize;
+
+    /**
+     * Policy floats per position.
+     */
+    private final int policySize;
+
+    /**
+     * Positions the buffers hold.
+     */
+    private final int maxBatch;
+
+    /**
+     * Native predict function.
+     */
+    private final Runner runner;
+
+    /**
+     * Wraps the native buffers.
+     *
+     * @param handle native backend handle
+     * @param buffers native {@code {input, policy, wdl}} direct buffers
+     * @param inputSize encoded floats per position
+     * @param policySize policy floats per position
+     * @param runner native predict function
+     */
+    private PinnedBuffers(long handle, ByteBuffer[] buffers, int inputSize, int policySize, Runner runner) {
+        this.handle = handle;
+        this.input = buffers[0].order(ByteOrder.nativeOrder()).asFloatBuffer();
+        this.policy = buffers[1].order(ByteOrder.nativeOrder()).asFloatBuffer();
+        this.wdl = buffers[2].order(ByteOrder.nativeOrder()).asFloatBuffer();
+        this.inputSize = inputSize;
+        this.policySize = policySize;
+        this.maxBatch = input.capacity() / inputSize;
+        this.runner = runner;
+    }
+
+    /**
+     * Wraps the pinned buffers returned by a backend's {@code nativePinnedBuffers}.
+     *
+     * @param handle native backend handle
+     * @param buffers native {@code {input, policy, wdl}} direct buffers, or {@code null}
+     * @param inputSize encoded floats per position
+     * @param policySize policy floats per position
+     * @param runner native predict function
+     * @return wrapped buffers
+     * @throws IllegalStateException if the native allocation failed
+     */
+    public static PinnedBuffers wrap(long handle, ByteBuffer[] buffers, int inputSize, int policySize,
+            Runner runner) {
+        if (buffers == null || buffers.length != 3 || buffers[0] == null
+                || buffers[0].capacity() < inputSize * Float.BYTES) {
+            throw new IllegalStateException("Failed to allocate pinned host buffers.");
+        }
+        return new PinnedBuffers(handle, buffers, inputSize, policySize, runner);
+    }
+
+    /**
+     * @return number of positions one {@link #predict(int)} can evaluate
+     */
+    public int maxBatch() {
+        return maxBatch;
+    }
+
+    /**
+     * Returns a writable view of one position's input planes.
+     *
+     * @param index position index, {@code [0, maxBatch)}
+     * @return view of {@code inputSize} floats
+     */
+    public FloatBuffer input(int index) {
+        checkIndex(index);
+        return input.slice(index * inputSize, inputSize);
+    }
+
+    /**
+     * Evaluates the first {@code count} positions of the input buffer.
+     *
+     * @param count number of positions, {@code [1, maxBatch]}
+     * @throws IllegalStateException if the native predict fails
+     */
+    public void predict(int count) {
+        if (count <= 0 || count > maxBatch) {
+            throw new IllegalArgumentException("count must be in [1, " + maxBatch + "]: " + count);
+        }
+        if (runner.run(handle, count) != count) {
+            throw new IllegalStateException("Native pinned prediction failed.");
+        }
+    }
+
+    /**
+     * Copies one position's policy output.
+     *
+     * @param index position index
+     * @return policy logits
+     */
+    public float[] policy(int index) {
+        checkIndex(index);
+        float[] out = new float[policySize];
+        policy.get(index * policySize, out);
+        return out;
+    }
+
+    /**
+     * Copies one position's WDL output.
+     *
+     * @param index position index
+     * @return WDL probabilities
+     */
+    public float[] wdl(int index) {
+        checkIndex(index);
+        float[] out = new float[3];
+        wdl.get(index * 3, out);
+        return out;
+    }
+
+    /**
+     * Validates a position index.
+     *
+     * @param index position index
+     */
+    private void checkIndex(int index) {
+        if (index < 0 || index >= maxBatch) {
+            throw new IndexOutOfBoundsException("index " + index + " outside [0, " + maxBatch + ")");
+        }
+    }
+}
@@ -0,0 +1,199 @@
+package chess.gpu;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Locale;
+
+/**
+ * Snapshot of the per-stage timing and counters of one native GPU backend handle.
+ *
+ * <p>The native side brackets each stage of a call (uploads, the kernel groups
+ * of a forward pass, downloads, host-side work) with timer events and adds up
+ * calls, bytes moved, device time and host time per stage. Counting is off
+ * unless the backend's {@code CRTK_<FAMILY>_<VENDOR>_STATS} environment
+ * variable was {@code 1} when the handle was created; a handle with counting
+ * off reports {@link #enabled()} {@code false} and empty totals.
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class StageStats {
+
+    /**
+     * Native stage-name entry point ({@code nativeGetStatNames}).
+     */
+    @FunctionalInterface
+    public interface NameReader {
+        /**
+         * Reads the stage names of a handle.
+         *
+         * @param handle native backend handle
+         * @return comma-separated stage names, or {@code null} on failure
+         */
+        String read(long handle);
+    }
+
+    /**
+     * Native counter entry point ({@code nativeGetStats}).
+     */
+    @FunctionalInterface
+    public interface CounterReader {
+        /**
+         * Reads the counters of a handle.
+         *
+         * @param handle native backend handle
+         * @param reset whether to zero the native totals after reading
+         * @return {@code [enabled, then per stage: calls, bytes, deviceNanos, hostNanos]},
+         *         or {@code null} on failure
+         */
+        long[] read(long handle, boolean reset);
+    }
+
+    /**
+     * Totals of one stage.
+     *
+     * @param name stage name
+     * @param calls completed brackets
+     * @param bytes bytes moved by the stage (transfers only)
+     * @param deviceNanos summed device time between the bracket's events
+     * @param hostNanos summed host wall time (host-side stages only)
+     */
+    public record Stage(String name, long calls, long bytes, long deviceNanos, long hostNanos) {
+
+        /**
+         * @return device plus host nanoseconds per call, or zero before the first call
+         */
+        public long meanNanos() {
+            return calls == 0 ? 0L : (deviceNanos + hostNanos) / calls;
+        }
+    }
+
+    /**
+     * Snapshot of a handle without native stats.
+     */
+    public static final StageStats EMPTY = new StageStats(false, List.of());
+
+    /**
+     * Values per stage in the native layout.
+     */
+    private static final int FIELDS = 4;
+
+    /**
+     * Whether the handle was created with counting on.
+     */
+    private final boolean enabled;
+
+    /**
+     * Stages in native order.
+     */
+    private final List<Stage> stages;
+
+    /**
+     * Creates a snapshot.
+     *
+     * @param enabled whether counting was on
+     * @param stages stages in native order
+     */
+    private StageStats(boolean enabled, List<Stage> stages) {
+        this.enabled = enabled;
+        this.stages = stages;
+    }
+
+    /**
+     * Reads the stats of a native handle.
+     *
+     * @param handle native backend handle
+     * @param names native stage-name function
+     * @param counters native counter function
+     * @param reset whether to zero the native totals after reading
+     * @return snapshot, {@link #EMPTY} when the native call fails
+     */
+    public static StageStats read(long handle, NameReader names, CounterReader counters, boolean reset) {
+        if (handle == 0L) {
+            return EMPTY;
+        }
+        return parse(names.read(handle), counters.read(handle, reset));
+    }
+
+    /**
+     * Decodes the native layout.
+     *
+     * @param names comma-separated stage names
+     * @param raw {@code [enabled, then per stage: calls, bytes, deviceNanos, hostNanos]}
+     * @return snapshot, {@link #EMPTY} when either argument is {@code null} or the lengths disagree
+     */
+    public static StageStats parse(String names, long[] raw) {
+        if (names == null || raw == null || raw.length == 0) {
+            return EMPTY;
+        }
+        String[] split = names.isEmpty() ? new String[0] : names.split(",", -1);
+        if (raw.length != 1 + FIELDS * split.length) {
+            return EMPTY;
+        }
+        List<Stage> stages = new ArrayList<>(split.length);
+        for (int i = 0; i < split.length; i++) {
+            int base = 1 + FIELDS * i;
+            stages.add(new Stage(split[i], raw[base], raw[base + 1], raw[base + 2], raw[base + 3]));
+        }
+        return new StageStats(raw[0] != 0L, Collections.unmodifiableList(stages));
+    }
+
+    /**
+     * @return {@code true} if the handle was created with counting on
+     */
+    public boolean enabled() {
+        return enabled;
+    }
+
+    /**
+     * @return stages in native order
+     */
+    public List<Stage> stages() {
+        return stages;
+    }
+
+    /**
+     * Looks up one stage by name.
+     *
+     * @param name stage name
+     * @return the stage, or {@code null} if the backend has no such stage
+     */
+    public Stage stage(String name) {
+        for (Stage stage : stages) {
+            if (stage.name().equals(name)) {
+                return stage;
+            }
+        }
+        return null;
+    }
+
+    /**
+     * @return summed device and host nanoseconds over all stages
+     */
+    public long totalNanos() {
+        long total = 0L;
+        for (Stage stage : stages) {
+            total += stage.deviceNanos() + stage.hostNanos();
+        }
+        return total;
+    }
+
+    /**
+     * Formats one line per stage with calls, bytes, and mean time per call.
+     *
+     * @return readable table
+     */
+    @Override
+    public String toString() {
+        if (!enabled) {
+            return "stage stats off";
+        }
+        StringBuilder sb = new StringBuilder();
+        for (Stage stage : stages) {
+            sb.append(String.format(Locale.ROOT, "%-10s calls=%d bytes=%d mean=%.3fus\n", stage.name(),
+                    stage.calls(), stage.bytes(), stage.meanNanos() / 1000.0));
+        }
+        return sb.toString();
+    }
+}
@@ -4,6 +4,7 @@ import java.util.List;
 
 import chess.core.Field;
 import chess.core.Position;
+import chess.gpu.PackedPlanes;
 
 /**
  * Encodes {@link Position} objects for LCZero BT4 attention-body networks.
@@ -14,6 +15,12 @@ import chess.core.Position;
  * token-major layout {@code [64][112]}, one token per board square.
  * </p>
  *
+ * <p>
+ * The {@code Packed} variants return the same planes as square masks
+ * ({@link PackedPlanes}) for the GPU backends' packed predict; the float
+ * encodings are their expansion.
+ * </p>
+ *
  * @since 2026
  * @author Lennart A. Conrad
  */
@@ -89,6 +96,27 @@ public final class Encoder {
         }
     }
 
+    /**
+     * Packed input plus the LC0 canonical transform applied to the board.
+     *
+     * @param words packed planes, {@code PackedPlanes.words(112)} longs
+     * @param transform canonical transform bit mask
+     */
+    public record PackedInput(long[] words, int transform) {
+
+        /**
+         * Defensive construction.
+         * @param words packed planes
+         * @param transform canonical transform bit mask
+         */
+        public PackedInput {
+            if (words == null || words.length != PackedPlanes.words(INPUT_CHANNELS)) {
+                throw new IllegalArgumentException("packed input must be "
+                        + PackedPlanes.words(INPUT_CHANNELS) + " longs");
+            }
+        }
+    }
+
     /**
      * Encodes one position using the default BT4 input format.
      *
@@ -123,6 +151,30 @@ public final class Encoder {
      * @return encoded input
      */
     public static EncodedInput encodeHistory(List<Position> historyOldestToNewest, InputFormat format) {
+        PackedInput packed = encodeHistoryPacked(historyOldestToNewest, format);
+        return new EncodedInput(PackedPlanes.expand(packed.words(), INPUT_CHANNELS), packed.transform());
+    }
+
+    /**
+     * Encodes one position as packed planes using a specific input format.
+     *
+     * @param position source position
+     * @param format input format
+     * @return packed input
+     */
+    public static PackedInput encodePacked(Position position, InputFormat format) {
+        return encodeHistoryPacked(List.of(position), format);
+    }
+
+    /**
+     * Encodes a position history as packed planes, with the same history rules
+     * as {@link #encodeHistory(List, InputFormat)}.
+     *
+     * @param historyOldestToNewest non-empty position history
+     * @param format input format
+     * @return packed input
+     */
+    public static PackedInput encodeHistoryPacked(List<Position> historyOldestToNewest, InputFormat format) {
         if (historyOldestToNewest == null || historyOldestToNewest.isEmpty()) {
             throw new IllegalArgumentException("history must contain at least one position");
         }
@@ -138,7 +190,7 @@ public final class Encoder {
         long[] currentPerspective = toSidePerspective(collectPlaneBits(current), weAreBlack);
         int transform = format.canonical() ? chooseCanonicalTransform(current, currentPerspective) : 0;
 
-        float[] planes = new float[INPUT_CHANNELS * TOKENS];
+        long[] planes = PackedPlanes.allocate(INPUT_CHANNELS);
         for (int slot = 0; slot < HISTORY; slot++) {
             int historyIndex = Math.max(0, historyOldestToNewest.size() - 1 - slot);
             Position historical = historyOldestToNewest.get(historyIndex);
@@ -149,7 +201,7 @@ public final class Encoder {
             writeHistorySlot(planes, slot, perspective, transform);
         }
         writeAuxPlanes(planes, current, format, weAreBlack, transform);
-        return new EncodedInput(planes, transform);
+        return new PackedInput(planes, transform);
     }
 
     /**
@@ -234,12 +286,12 @@ public final class Encoder {
     /**
      * Writes one history slot.
      *
-     * @param planes output planes
+     * @param planes packed output planes
      * @param slot history slot
      * @param perspectiveBits side-to-move perspective piece bitboards
      * @param transform canonical transform bit mask
      */
-    private static void writeHistorySlot(float[] planes, int slot, long[] perspectiveBits, int transform) {
+    private static void writeHistorySlot(long[] planes, int slot, long[] perspectiveBits, int transform) {
         int base = slot * PLANES_PER_BOARD;
         for (int piece = 0; piece < 12; piece++) {
             addBits(planes, base + piece, transformBits(perspectiveBits[piece], transform));
@@ -249,14 +301,14 @@ public final class Encoder {
     /**
      * Writes auxiliary planes.
      *
-     * @param planes output planes
+     * @param planes packed output planes
      * @param position current position
      * @param format input format
      * @param weAreBlack true when Black is side to move
      * @param transform canonical transform bit mask
      */
     private static void writeAuxPlanes(
-            float[] planes,
+            long[] planes,
             Position position,
             InputFormat format,
             boolean weAreBlack,
@@ -283,11 +335,11 @@ public final class Encoder {
     /**
      * Writes classical constant castling planes.
      *
-     * @param planes output planes
+     * @param planes packed output planes
      * @param position current position
      * @param weAreBlack true when Black is side to move
      */
-    private static void writeClassicalCastlingPlanes(float[] planes, Position position, boolean weAreBlack) {
+    private static void writeClassicalCastlingPlanes(long[] planes, Position position, boolean weAreBlack) {
         boolean whiteCastleK = position.activeCastlingMoveTarget(Position.WHITE_KINGSIDE) != Field.NO_SQUARE;
         boolean whiteCastleQ = position.activeCastlingMoveTarget(Position.WHITE_QUEENSIDE) != Field.NO_SQUARE;
         boolean blackCastleK = position.activeCastlingMoveTarget(Position.BLACK_KINGSIDE) != Field.NO_SQUARE;
@@ -315,7 +367,7 @@ public final class Encoder {
     /**
      * Writes one modern castling rook-location plane.
      *
-     * @param planes output planes
+     * @param planes packed output planes
      * @param channel output channel
      * @param position current position
      * @param weAreBlack true when Black is side to move
@@ -323,7 +375,7 @@ public final class Encoder {
      * @param transform canonical transform bit mask
      */
     private static void writeCastlingRookPlane(
-            float[] planes,
+            long[] planes,
             int channel,
             Position position,
             boolean weAreBlack,
@@ -458,31 +510,23 @@ public final class Encoder {
     /**
      * Writes set bits into a channel.
      *
-     * @param planes output planes
+     * @param planes packed output planes
      * @param channel channel index
      * @param bits plane-indexed bitboard
      */
-    private static void addBits(float[] planes, int channel, long bits) {
-        int base = channel * TOKENS;
-        while (bits != 0L) {
-            int sq = Long.numberOfTrailingZeros(bits);
-            planes[base + sq] = 1.0f;
-            bits &= bits - 1L;
-        }
+    private static void addBits(long[] planes, int channel, long bits) {
+        planes[channel] |= bits;
     }
 
     /**
      * Fills one channel with a constant.
      *
-     * @param planes output planes
+     * @param planes packed output planes
      * @param channel channel index
      * @param value value to write
      */
-    private static void fillConstant(float[] planes, int channel, float value) {
-        int base = channel * TOKENS;
-        for (int i = 0; i < TOKENS; i++) {
-            planes[base + i] = value;
-        }
+    private static void fillConstant(long[] planes, int channel, float value) {
+        PackedPlanes.fill(planes, INPUT_CHANNELS, channel, value);
     }
 
     /**
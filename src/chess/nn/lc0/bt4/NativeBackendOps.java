@@ -3,41 +3,29 @@ package chess.nn.lc0.bt4;
 import java.nio.file.Path;
 import java.util.function.LongConsumer;
 
+import chess.gpu.NativeOps;
+
 /**
  * Shared helpers for thin JNI-backed BT4 backends.
  *
+ * <p>The family-independent creation and batch plumbing lives in
+ * {@link NativeOps}; this class maps the native metadata onto
+ * {@link Network.Info} and the network's tensor sizes.
+ *
  * @since 2026
  * @author Lennart A. Conrad
  */
 public final class NativeBackendOps {
 
     /**
-     * Utility class, prevents instantiation.
+     * Number of metadata longs returned by {@code nativeGetInfo}.
      */
-    private NativeBackendOps() {
-    }
-
-    /**
-     * Common result of native backend creation.
-     *
-     * @param handle native backend handle
-     * @param info parsed network metadata
-     */
-    public record Created(long handle, Network.Info info) {
-    }
+    private static final int INFO_FIELDS = 7;
 
     /**
-     * Functional interface for native evaluator creation.
+     * Utility class, prevents instantiation.
      */
-    @FunctionalInterface
-    public interface HandleCreator {
-        /**
-         * Creates a native evaluator for the given weights path.
-         *
-         * @param weightsPath absolute path to the weights file
-         * @return native handle, or zero on failure
-         */
-        long create(String weightsPath);
+    private NativeBackendOps() {
     }
 
     /**
@@ -54,20 +42,6 @@ public final class NativeBackendOps {
         String read(long handle);
     }
 
-    /**
-     * Functional interface for native metadata lookup.
-     */
-    @FunctionalInterface
-    public interface InfoReader {
-        /**
-         * Reads network metadata from the native backend.
-         *
-         * @param handle native backend handle
-         * @return raw metadata array, or {@code null} on failure
-         */
-        long[] read(long handle);
-    }
-
     /**
      * Functional interface for native prediction.
      */
@@ -97,36 +71,40 @@ public final class NativeBackendOps {
      * @param infoFailure message used when metadata is invalid
      * @return created native backend handle and metadata
      */
-    public static Created create(
+    public static NativeOps.Created<Network.Info> create(
             Path weightsBin,
-            HandleCreator creator,
+            NativeOps.HandleCreator creator,
             NameReader nameReader,
-            InfoReader infoReader,
+            NativeOps.InfoReader infoReader,
             LongConsumer destroyer,
             String createFailure,
             String infoFailure) {
-        long handle = creator.create(weightsBin.toAbsolutePath().toString());
-        if (handle == 0L) {
-            throw new IllegalStateException(createFailure);
-        }
-        String name = nameReader.read(handle);
-        long[] meta = infoReader.read(handle);
-        if (meta == null || meta.length < 7) {
-            destroyer.accept(handle);
-            throw new IllegalStateException(infoFailure);
-        }
-        if (name == null || name.isBlank()) {
-            name = "lc0-bt4-native";
-        }
-        return new Created(handle, new Network.Info(
-                name,
-                (int) meta[0],
-                (int) meta[1],
-                (int) meta[2],
-                (int) meta[3],
-                (int) meta[4],
-                (int) meta[5],
-                meta[6]));
+        return NativeOps.create(weightsBin, creator, infoReader, INFO_FIELDS, (handle, meta) -> {
+            String name = nameReader.read(handle);
+            if (name == null || name.isBlank()) {
+                name = "lc0-bt4-native";
+            }
+            return new Network.Info(
+                    name,
+                    (int) meta[0],
+                    (int) meta[1],
+                    (int) meta[2],
+                    (int) meta[3],
+                    (int) meta[4],
+                    (int) meta[5],
+                    meta[6]);
+        }, destroyer, createFailure, infoFailure);
+    }
+
+    /**
+     * Returns the per-position tensor sizes used by the {@link NativeOps} batch helpers.
+     *
+     * @param info loaded network metadata
+     * @return layout of one encoded position and its outputs
+     */
+    public static NativeOps.Layout<Network.Prediction> layout(Network.Info info) {
+        return new NativeOps.Layout<>(info.inputChannels() * info.tokens(), info.inputChannels(), info.policySize(),
+                Network.Prediction::new);
     }
 
     /**
@@ -152,14 +130,4 @@ public final class NativeBackendOps {
         float value = predictor.predict(handle, encodedPlanes, policy, wdl);
         return new Network.Prediction(policy, wdl, value);
     }
-
-    /**
-     * Releases a native handle through the provided destroy function.
-     *
-     * @param handle native backend handle
-     * @param destroyer native destroy function
-     */
-    public static void destroy(long handle, LongConsumer destroyer) {
-        destroyer.accept(handle);
-    }
 }
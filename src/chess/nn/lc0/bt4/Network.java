@@ -8,6 +8,7 @@ import java.util.List;
 
 import chess.core.Position;
 import chess.gpu.BackendNames;
+import chess.gpu.PackedPlanes;
 
 /**
  * LCZero BT4-style attention-body network evaluator.
@@ -324,12 +325,12 @@ public final class Network implements AutoCloseable {
         if (positions == null) {
             throw new IllegalArgumentException("positions == null");
         }
-        List<float[]> encoded = new ArrayList<>(positions.size());
+        List<long[]> packed = new ArrayList<>(positions.size());
         InputFormat inputFormat = architecture.inputFormat();
         for (Position position : positions) {
-            encoded.add(Encoder.encode(position, inputFormat).planes());
+            packed.add(Encoder.encodePacked(position, inputFormat).words());
         }
-        return predictEncodedBatch(encoded);
+        return predictPackedBatch(packed);
     }
 
     /**
@@ -343,15 +344,15 @@ public final class Network implements AutoCloseable {
         if (positions == null) {
             throw new IllegalArgumentException("positions == null");
         }
-        List<float[]> encodedBatch = new ArrayList<>(positions.size());
+        List<long[]> packedBatch = new ArrayList<>(positions.size());
         int[] transforms = new int[positions.size()];
         InputFormat inputFormat = architecture.inputFormat();
         for (int i = 0; i < positions.size(); i++) {
-            Encoder.EncodedInput encoded = Encoder.encode(positions.get(i), inputFormat);
-            encodedBatch.add(encoded.planes());
-            transforms[i] = encoded.transform();
+            Encoder.PackedInput packed = Encoder.encodePacked(positions.get(i), inputFormat);
+            packedBatch.add(packed.words());
+            transforms[i] = packed.transform();
         }
-        List<Prediction> predictions = predictEncodedBatch(encodedBatch);
+        List<Prediction> predictions = predictPackedBatch(packedBatch);
         List<TransformedPrediction> out = new ArrayList<>(predictions.size());
         for (int i = 0; i < predictions.size(); i++) {
             out.add(new TransformedPrediction(predictions.get(i), transforms[i]));
@@ -387,6 +388,9 @@ public final class Network implements AutoCloseable {
     /**
      * Evaluates already encoded LC0 planes as a batch.
      *
+     * <p>The CUDA and ROCm backends evaluate the batch in one native call; the
+     * oneAPI and CPU paths evaluate position by position.
+     *
      * @param encodedBatch encoded plane arrays
      * @return predictions aligned with {@code encodedBatch}
      */
@@ -394,6 +398,12 @@ public final class Network implements AutoCloseable {
         if (encodedBatch == null) {
             throw new IllegalArgumentException("encodedBatch == null");
         }
+        if (cuda != null) {
+            return cuda.predictEncodedBatch(encodedBatch);
+        }
+        if (rocm != null) {
+            return rocm.predictEncodedBatch(encodedBatch);
+        }
         List<Prediction> out = new ArrayList<>(encodedBatch.size());
         for (float[] encodedPlanes : encodedBatch) {
             out.add(predictEncoded(encodedPlanes));
@@ -401,6 +411,36 @@ public final class Network implements AutoCloseable {
         return out;
     }
 
+    /**
+     * Evaluates packed LC0 planes ({@link PackedPlanes}) as a batch.
+     *
+     * <p>The CUDA and ROCm backends upload the packed words and expand them on
+     * the device; the oneAPI and CPU paths expand them on the host.
+     *
+     * @param packedBatch packed plane arrays, {@code PackedPlanes.words(112)} longs each
+     * @return predictions aligned with {@code packedBatch}
+     */
+    public List<Prediction> predictPackedBatch(List<long[]> packedBatch) {
+        if (packedBatch == null) {
+            throw new IllegalArgumentException("packedBatch == null");
+        }
+        if (cuda != null) {
+            return cuda.predictPackedBatch(packedBatch);
+        }
+        if (rocm != null) {
+            return rocm.predictPackedBatch(packedBatch);
+        }
+        List<Prediction> out = new ArrayList<>(packedBatch.size());
+        for (long[] packed : packedBatch) {
+            if (packed == null || packed.length != PackedPlanes.words(Encoder.INPUT_CHANNELS)) {
+                throw new IllegalArgumentException("Packed input must be "
+                        + PackedPlanes.words(Encoder.INPUT_CHANNELS) + " longs.");
+            }
+            out.add(predictEncoded(PackedPlanes.expand(packed, Encoder.INPUT_CHANNELS)));
+        }
+        return out;
+    }
+
     /**
      * Evaluates already encoded LC0 planes and optionally captures
      * intermediate activations into the supplied sink.
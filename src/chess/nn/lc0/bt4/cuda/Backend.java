@@ -1,7 +1,15 @@
 package chess.nn.lc0.bt4.cuda;
 
+import java.nio.ByteBuffer;
 import java.nio.file.Path;
+import java.util.Arrays;
+import java.util.List;
 
+import chess.gpu.EvalQueue;
+import chess.gpu.NativeOps;
+import chess.gpu.PackedPlanes;
+import chess.gpu.PinnedBuffers;
+import chess.gpu.StageStats;
 import chess.nn.lc0.bt4.NativeBackendOps;
 import chess.nn.lc0.bt4.Network;
 
@@ -23,6 +31,11 @@ public final class Backend implements AutoCloseable {
      */
     private final Network.Info info;
 
+    /**
+     * Pinned host buffers, created by the first {@link #pinnedBuffers()} call.
+     */
+    private PinnedBuffers pinned;
+
     /**
      * Creates a wrapper around a native evaluator.
      *
@@ -48,7 +61,7 @@ public final class Backend implements AutoCloseable {
      * @return backend instance
      */
     public static Backend create(Path weightsBin) {
-        NativeBackendOps.Created created = NativeBackendOps.create(
+        NativeOps.Created<Network.Info> created = NativeBackendOps.create(
                 weightsBin,
                 Backend::nativeCreate,
                 Backend::nativeGetName,
@@ -59,6 +72,30 @@ public final class Backend implements AutoCloseable {
         return new Backend(created.handle(), created.info());
     }
 
+    /**
+     * Creates a CUDA evaluator on one device.
+     *
+     * <p>{@link #create(Path)} is this method with device {@code 0}. Every native call on the
+     * returned handle binds its device first, so handles on different devices can be used from
+     * any thread.
+     *
+     * @param weightsBin BT4 weights file
+     * @param device CUDA device ordinal
+     * @return evaluator instance owning resources on {@code device}
+     * @throws IllegalStateException if the ordinal is out of range or initialization fails
+     */
+    public static Backend create(Path weightsBin, int device) {
+        NativeOps.Created<Network.Info> created = NativeBackendOps.create(
+                weightsBin,
+                path -> nativeCreateOnDevice(path, device),
+                Backend::nativeGetName,
+                Backend::nativeGetInfo,
+                Backend::nativeDestroy,
+                "Failed to create BT4 CUDA evaluator on device " + device + ".",
+                "BT4 CUDA evaluator returned invalid info.");
+        return new Backend(created.handle(), created.info());
+    }
+
     /**
      * @return loaded network metadata
      */
@@ -76,12 +113,265 @@ public final class Backend implements AutoCloseable {
         return NativeBackendOps.predictEncoded(handle, info, encodedPlanes, Backend::nativePredict);
     }
 
+    /**
+     * Runs batched forward passes on already-encoded BT4 input planes.
+     *
+     * <p>The whole batch crosses JNI in one call; the native side evaluates it in
+     * device-sized chunks (see {@code CRTK_BT4_CUDA_MAX_BATCH}).
+     *
+     * @param encodedBatch channel-major input planes aligned by position
+     * @return predictions aligned with {@code encodedBatch}
+     */
+    public List<Network.Prediction> predictEncodedBatch(List<float[]> encodedBatch) {
+        return NativeOps.predictEncodedBatch(handle, NativeBackendOps.layout(info), encodedBatch,
+                Backend::nativePredictBatch);
+    }
+
+    /**
+     * Runs batched forward passes on packed BT4 inputs.
+     *
+     * <p>Each position crosses JNI and the bus as {@code inputChannels + 1} longs
+     * ({@link PackedPlanes}); the native side expands them into input planes on
+     * the device and evaluates in device-sized chunks (see {@code CRTK_BT4_CUDA_MAX_BATCH}).
+     *
+     * @param packedBatch packed input planes aligned by position
+     * @return predictions aligned with {@code packedBatch}
+     */
+    public List<Network.Prediction> predictPackedBatch(List<long[]> packedBatch) {
+        return NativeOps.predictPackedBatch(handle, NativeBackendOps.layout(info), packedBatch,
+                Backend::nativePredictPacked);
+    }
+
+    /**
+     * Opens a coalescing evaluation queue over this backend with the native
+     * batch size and the default deadline.
+     *
+     * @return open queue; close it before closing this backend
+     */
+    public EvalQueue<Network.Prediction> openQueue() {
+        return openQueue(0, EvalQueue.DEFAULT_DEADLINE_MICROS);
+    }
+
+    /**
+     * Opens a coalescing evaluation queue over this backend.
+     *
+     * <p>Concurrent callers submit single positions; a native dispatcher runs them
+     * in batches of up to {@code maxBatch} positions, or sooner once the oldest
+     * one has waited {@code deadlineMicros}. While the queue is open, predict only
+     * through it.
+     *
+     * @param maxBatch largest coalesced batch; zero or anything above
+     *                 {@code CRTK_BT4_CUDA_MAX_BATCH} uses that limit
+     * @param deadlineMicros longest wait for a partial batch, in microseconds
+     * @return open queue; close it before closing this backend
+     */
+    public EvalQueue<Network.Prediction> openQueue(int maxBatch, long deadlineMicros) {
+        return new EvalQueue<>(
+                nativeQueueCreate(handle, maxBatch, deadlineMicros),
+                info.inputChannels() * info.tokens(),
+                info.policySize(),
+                new EvalQueue.Ops(Backend::nativeQueueSubmit, Backend::nativeQueueTake,
+                        Backend::nativeQueueClose, Backend::nativeQueueDestroy),
+                (policy, wdl) -> new Network.Prediction(policy, wdl, wdl[0] - wdl[2]),
+                "crtk-bt4-cuda-queue");
+    }
+
+    /**
+     * Returns this handle's pinned input/output buffers, allocating them on first use.
+     *
+     * <p>Write encoded planes into {@link PinnedBuffers#input(int)} and call
+     * {@link PinnedBuffers#predict(int)}; transfers go straight between the
+     * page-locked buffers and the device.
+     *
+     * @return pinned buffers sized for the native batch limit
+     */
+    public synchronized PinnedBuffers pinnedBuffers() {
+        if (pinned == null) {
+            pinned = PinnedBuffers.wrap(handle, nativePinnedBuffers(handle),
+                    info.inputChannels() * info.tokens(), info.policySize(), Backend::nativePredictPinned);
+        }
+        return pinned;
+    }
+
+    /**
+     * One BT4 replica per CUDA device behind a single handle.
+     *
+     * <p>A call that fits in one native batch goes to the least-loaded replica, so
+     * concurrent callers spread over the devices; a larger call is split into whole
+     * native batches that the replicas evaluate in parallel. Results do not depend on
+     * the split. A pool is safe to share across threads.
+     */
+    public static final class Pool implements AutoCloseable {
+
+        /**
+         * Native pool handle.
+         */
+        private final long handle;
+
+        /**
+         * Metadata of the loaded weights, shared by every replica.
+         */
+        private final Network.Info info;
+
+        /**
+         * Device ordinals in replica order.
+         */
+        private final int[] devices;
+
+        /**
+         * Creates a wrapper around a native pool.
+         *
+         * @param handle native pool handle
+         * @param info metadata of the loaded weights
+         * @param devices device ordinals in replica order
+         */
+        private Pool(long handle, Network.Info info, int[] devices) {
+            this.handle = handle;
+            this.info = info;
+            this.devices = devices;
+        }
+
+        /**
+         * Creates a pool with one replica on every visible CUDA device.
+         *
+         * @param weightsBin BT4 weights file
+         * @return pool instance owning resources on every device
+         * @throws IllegalStateException if no device is visible or initialization fails
+         */
+        public static Pool create(Path weightsBin) {
+            int count = Support.deviceCount();
+            if (count <= 0) {
+                throw new IllegalStateException("No CUDA device available.");
+            }
+            int[] all = new int[count];
+            for (int i = 0; i < count; i++) {
+                all[i] = i;
+            }
+            return create(weightsBin, all);
+        }
+
+        /**
+         * Creates a pool with one replica per listed CUDA device.
+         *
+         * @param weightsBin BT4 weights file
+         * @param devices distinct device ordinals
+         * @return pool instance owning resources on every listed device
+         * @throws IllegalArgumentException if {@code devices} is empty
+         * @throws IllegalStateException if an ordinal is repeated or out of range, or initialization fails
+         */
+        public static Pool create(Path weightsBin, int... devices) {
+            if (devices == null || devices.length == 0) {
+                throw new IllegalArgumentException("devices must not be empty");
+            }
+            int[] ordinals = devices.clone();
+            NativeOps.Created<Network.Info> created = NativeBackendOps.create(
+                    weightsBin,
+                    path -> nativePoolCreate(path, ordinals),
+                    Backend::nativePoolGetName,
+                    Backend::nativePoolGetInfo,
+                    Backend::nativePoolDestroy,
+                    "Failed to create BT4 CUDA evaluator pool on devices " + Arrays.toString(ordinals) + ".",
+                    "BT4 CUDA evaluator pool returned invalid info.");
+            return new Pool(created.handle(), created.info(), ordinals);
+        }
+
+        /**
+         * @return device ordinals in replica order
+         */
+        public int[] devices() {
+            return devices.clone();
+        }
+
+        /**
+         * @return metadata of the loaded weights
+         */
+        public Network.Info info() {
+            return info;
+        }
+
+        /**
+         * Runs batched forward passes on already-encoded input planes across the pool.
+         *
+         * @param encodedBatch channel-major input planes aligned by position
+         * @return predictions aligned with {@code encodedBatch}
+         */
+        public List<Network.Prediction> predictEncodedBatch(List<float[]> encodedBatch) {
+            return NativeOps.predictEncodedBatch(handle, NativeBackendOps.layout(info), encodedBatch,
+                    Backend::nativePoolPredictBatch);
+        }
+
+        /**
+         * Runs batched forward passes on packed inputs ({@link PackedPlanes}) across the pool.
+         *
+         * @param packedBatch packed input planes aligned by position
+         * @return predictions aligned with {@code packedBatch}
+         */
+        public List<Network.Prediction> predictPackedBatch(List<long[]> packedBatch) {
+            return NativeOps.predictPackedBatch(handle, NativeBackendOps.layout(info), packedBatch,
+                    Backend::nativePoolPredictPacked);
+        }
+
+        /**
+         * @return completed predict calls per replica, aligned with {@link #devices()}
+         */
+        public long[] replicaCalls() {
+            return stat(1);
+        }
+
+        /**
+         * @return positions evaluated per replica, aligned with {@link #devices()}
+         */
+        public long[] replicaPositions() {
+            return stat(2);
+        }
+
+        /**
+         * Releases every replica.
+         */
+        @Override
+        public void close() {
+            NativeOps.destroy(handle, Backend::nativePoolDestroy);
+        }
+
+        /**
+         * Reads one column of the native per-replica counters.
+         *
+         * @param column {@code 1} for calls, {@code 2} for positions
+         * @return column values aligned with {@link #devices()}
+         */
+        private long[] stat(int column) {
+            long[] raw = nativePoolStats(handle);
+            long[] out = new long[devices.length];
+            if (raw == null) {
+                return out;
+            }
+            for (int i = 0; i < out.length && i * 3 + column < raw.length; i++) {
+                out[i] = raw[i * 3 + column];
+            }
+            return out;
+        }
+    }
+
+    /**
+     * Returns this handle's per-stage timing and counters.
+     *
+     * <p>Counting is on only when {@code CRTK_BT4_CUDA_STATS=1} was set when the
+     * handle was created; otherwise the snapshot reports {@link StageStats#enabled()}
+     * {@code false}.
+     *
+     * @param reset whether to zero the native totals after reading them
+     * @return stage totals since the handle was created or last reset
+     */
+    public StageStats stats(boolean reset) {
+        return StageStats.read(handle, Backend::nativeGetStatNames, Backend::nativeGetStats, reset);
+    }
+
     /**
      * Releases native resources.
      */
     @Override
     public void close() {
-        NativeBackendOps.destroy(handle, Backend::nativeDestroy);
+        NativeOps.destroy(handle, Backend::nativeDestroy);
     }
 
     /**
@@ -105,7 +395,7 @@ public final class Backend implements AutoCloseable {
     private static native String nativeGetName(long handle);
 
     /**
-     * @return {@code [inputC, tokens, embedding, encoders, heads, policySize, paramCount]}
+     * @return {@code [inputC, tokens, embedding, encoders, heads, policySize, paramCount, dtype, graphs, evalCount, meanEvalNanos, maxBatch]}
      * @param handle native backend handle
      */
     private static native long[] nativeGetInfo(long handle);
@@ -119,4 +409,169 @@ public final class Backend implements AutoCloseable {
      * @return predicted value score
      */
     private static native float nativePredict(long handle, float[] encodedPlanes, float[] outPolicy, float[] outWdl);
+
+    /**
+     * Runs a native batched prediction over {@code count} positions stored back to back.
+     * @param handle native backend handle
+     * @param encodedBatch encoded input planes for all positions
+     * @param count number of positions
+     * @param outPolicy policy output buffer, {@code count * policySize} floats
+     * @param outWdl WDL output buffer, {@code count * 3} floats
+     * @param outValue value output buffer, {@code count} floats
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePredictBatch(long handle, float[] encodedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * Runs a native batched prediction over {@code count} packed positions stored back to back.
+     * @param handle native backend handle
+     * @param packedBatch packed input planes for all positions
+     * @param count number of positions
+     * @param outPolicy policy output buffer, {@code count * policySize} floats
+     * @param outWdl WDL output buffer, {@code count * 3} floats
+     * @param outValue value output buffer, {@code count} floats
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePredictPacked(long handle, long[] packedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * Returns the pinned host buffers of a native backend instance, allocating them on first use.
+     * @param handle native backend handle
+     * @return {@code {input, policy, wdl}} direct buffers, or {@code null} on failure
+     */
+    private static native ByteBuffer[] nativePinnedBuffers(long handle);
+
+    /**
+     * Evaluates the first {@code count} positions of the pinned input buffer.
+     * @param handle native backend handle
+     * @param count number of positions
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePredictPinned(long handle, int count);
+
+    /**
+     * Creates a coalescing evaluation queue over a native backend instance.
+     * @param handle native backend handle
+     * @param maxBatch largest coalesced batch, or zero for the handle's limit
+     * @param deadlineMicros longest wait for a partial batch, negative for the default
+     * @return native queue handle, or zero on failure
+     */
+    private static native long nativeQueueCreate(long handle, int maxBatch, long deadlineMicros);
+
+    /**
+     * Copies one position into a native queue.
+     * @param queue native queue handle
+     * @param encodedPlanes encoded input planes
+     * @return positive ticket, or zero if the queue is closed
+     */
+    private static native long nativeQueueSubmit(long queue, float[] encodedPlanes);
+
+    /**
+     * Blocks until one queued result is ready.
+     * @param queue native queue handle
+     * @param outPolicy policy output buffer
+     * @param outWdl WDL output buffer
+     * @return ticket, negated ticket on failure, or zero once closed and drained
+     */
+    private static native long nativeQueueTake(long queue, float[] outPolicy, float[] outWdl);
+
+    /**
+     * Stops a native queue after evaluating its pending positions.
+     * @param queue native queue handle
+     */
+    private static native void nativeQueueClose(long queue);
+
+    /**
+     * Frees a closed native queue.
+     * @param queue native queue handle
+     */
+    private static native void nativeQueueDestroy(long queue);
+
+    /**
+     * Creates a native backend instance on one device.
+     * @param weightsPath path to the weights file
+     * @param device device ordinal
+     * @return native backend handle, or zero on failure
+     */
+    private static native long nativeCreateOnDevice(String weightsPath, int device);
+
+    /**
+     * Creates a native replica pool with one backend instance per device.
+     * @param weightsPath path to the weights file
+     * @param devices distinct device ordinals
+     * @return native pool handle, or zero on failure
+     */
+    private static native long nativePoolCreate(String weightsPath, int[] devices);
+
+    /**
+     * Destroys a native replica pool and all of its instances.
+     * @param pool native pool handle
+     */
+    private static native void nativePoolDestroy(long pool);
+
+    /**
+     * Returns the native backend name of a pool's weights.
+     * @param pool native pool handle
+     * @return native backend name
+     */
+    private static native String nativePoolGetName(long pool);
+
+    /**
+     * Returns the metadata of a pool's weights, in the {@link #nativeGetInfo(long)} layout.
+     * @param pool native pool handle
+     * @return metadata array
+     */
+    private static native long[] nativePoolGetInfo(long pool);
+
+    /**
+     * Runs a native batched prediction across a pool.
+     * @param pool native pool handle
+     * @param encodedBatch encoded input planes for all positions
+     * @param count number of positions
+     * @param outPolicy policy output buffer, {@code count * policySize} floats
+     * @param outWdl WDL output buffer, {@code count * 3} floats
+     * @param outValue value output buffer, {@code count} floats
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePoolPredictBatch(long pool, float[] encodedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * Runs a native batched prediction over packed positions across a pool.
+     * @param pool native pool handle
+     * @param packedBatch packed input planes for all positions
+     * @param count number of positions
+     * @param outPolicy policy output buffer, {@code count * policySize} floats
+     * @param outWdl WDL output buffer, {@code count * 3} floats
+     * @param outValue value output buffer, {@code count} floats
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePoolPredictPacked(long pool, long[] packedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * Returns the per-replica counters of a pool.
+     * @param pool native pool handle
+     * @return {@code [device, calls, positions]} per replica, or {@code null} on failure
+     */
+    private static native long[] nativePoolStats(long pool);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/lc0_bt4_cuda_jni.cu}.
+     *
+     * @param handle native handle
+     * @return comma-separated stage names in {@link #nativeGetStats(long, boolean)} order
+     */
+    private static native String nativeGetStatNames(long handle);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/lc0_bt4_cuda_jni.cu}.
+     *
+     * @param handle native handle
+     * @param reset whether to zero the totals after reading them
+     * @return {@code [enabled, then per stage: calls, bytes, deviceNanos, hostNanos]}, or {@code null} on failure
+     */
+    private static native long[] nativeGetStats(long handle, boolean reset);
 }
@@ -2,6 +2,7 @@ package chess.nn.lc0.bt4.oneapi;
 
 import java.nio.file.Path;
 
+import chess.gpu.NativeOps;
 import chess.nn.lc0.bt4.NativeBackendOps;
 import chess.nn.lc0.bt4.Network;
 
@@ -47,7 +48,7 @@ public final class Backend implements AutoCloseable {
      * @return created instance
      */
     public static Backend create(Path weightsBin) {
-        NativeBackendOps.Created created = NativeBackendOps.create(
+        NativeOps.Created<Network.Info> created = NativeBackendOps.create(
                 weightsBin,
                 Backend::nativeCreate,
                 Backend::nativeGetName,
@@ -80,7 +81,7 @@ public final class Backend implements AutoCloseable {
      */
     @Override
     public void close() {
-        NativeBackendOps.destroy(handle, Backend::nativeDestroy);
+        NativeOps.destroy(handle, Backend::nativeDestroy);
     }
 
     /**
@@ -2,6 +2,7 @@ package chess.nn.lc0.cnn;
 
 import chess.core.Field;
 import chess.core.Position;
+import chess.gpu.PackedPlanes;
 
 /**
  * Encodes a {@link Position} into LCZero "classical" 112-plane input
@@ -38,6 +39,9 @@ import chess.core.Position;
  * <p>Limitation: {@link Position} does not provide full move history; the
  * current board is repeated for all eight history slots.
  *
+ * <p>{@link #encodePacked(Position)} returns the same planes as square masks
+ * ({@link PackedPlanes}); {@link #encode(Position)} is its float expansion.
+ *
  * @since 2025
  * @author Lennart A. Conrad
  */
@@ -75,11 +79,22 @@ public final class Encoder {
      * @return encoded planes (length {@code 112 * 64})
      */
     public static float[] encode(Position position) {
+        return PackedPlanes.expand(encodePacked(position), TOTAL_CHANNELS);
+    }
+
+    /**
+     * Encodes a {@link Position} into packed LC0 112-plane input, one square
+     * mask per plane, for the GPU backends' packed predict.
+     *
+     * @param position current position
+     * @return packed planes (length {@code PackedPlanes.words(112)})
+     */
+    public static long[] encodePacked(Position position) {
         boolean weAreBlack = !position.isWhiteToMove();
         long[] pieceBitboards = collectPieceBitboards(position);
         long[] perspective = toSideToMovePerspective(pieceBitboards, weAreBlack);
 
-        float[] planes = new float[TOTAL_CHANNELS * 64];
+        long[] planes = PackedPlanes.allocate(TOTAL_CHANNELS);
         writeRepeatedHistory(planes, perspective);
         writeAuxPlanes(planes, position, weAreBlack);
         return planes;
@@ -141,10 +156,10 @@ public final class Encoder {
     /**
      * Writes eight repeated history blocks (Position has no move history).
      *
-     * @param planes output tensor
+     * @param planes packed output planes
      * @param perspectiveBits per-piece bitboards to repeat
      */
-    private static void writeRepeatedHistory(float[] planes, long[] perspectiveBits) {
+    private static void writeRepeatedHistory(long[] planes, long[] perspectiveBits) {
         for (int h = 0; h < HISTORY; h++) {
             int base = h * PLANES_PER_BOARD;
             for (int p = 0; p < 12; p++) {
@@ -157,11 +172,11 @@ public final class Encoder {
     /**
      * Writes castling, stm, rule50 and edge planes.
      *
-     * @param planes output tensor
+     * @param planes packed output planes
      * @param position current position
      * @param weAreBlack {@code true} when encoding from black's perspective
      */
-    private static void writeAuxPlanes(float[] planes, Position position, boolean weAreBlack) {
+    private static void writeAuxPlanes(long[] planes, Position position, boolean weAreBlack) {
         boolean whiteCastleK = position.activeCastlingMoveTarget(Position.WHITE_KINGSIDE) != Field.NO_SQUARE;
         boolean whiteCastleQ = position.activeCastlingMoveTarget(Position.WHITE_QUEENSIDE) != Field.NO_SQUARE;
         boolean blackCastleK = position.activeCastlingMoveTarget(Position.BLACK_KINGSIDE) != Field.NO_SQUARE;
@@ -208,40 +223,32 @@ public final class Encoder {
     /**
      * Writes a bitboard's set bits into a single plane.
      *
-     * @param planes  output tensor
+     * @param planes  packed output planes
      * @param channel plane index (0..111)
      * @param bits    bitboard with {@code 0=a1..63=h8}
      */
-    private static void addBits(float[] planes, int channel, long bits) {
-        int base = channel * 64;
-        while (bits != 0) {
-            int sq = Long.numberOfTrailingZeros(bits);
-            planes[base + sq] = 1f;
-            bits &= bits - 1;
-        }
+    private static void addBits(long[] planes, int channel, long bits) {
+        planes[channel] |= bits;
     }
 
     /**
      * Fills an entire plane with ones.
      *
-     * @param planes  output tensor
+     * @param planes  packed output planes
      * @param channel plane index (0..111)
      */
-    private static void fillOnes(float[] planes, int channel) {
+    private static void fillOnes(long[] planes, int channel) {
         fillConstant(planes, channel, 1f);
     }
 
     /**
      * Fills an entire plane with a constant value.
      *
-     * @param planes  output tensor
+     * @param planes  packed output planes
      * @param channel plane index (0..111)
      * @param value   constant value to write to all 64 squares
      */
-    private static void fillConstant(float[] planes, int channel, float value) {
-        int base = channel * 64;
-        for (int i = 0; i < 64; i++) {
-            planes[base + i] = value;
-        }
+    private static void fillConstant(long[] planes, int channel, float value) {
+        PackedPlanes.fill(planes, TOTAL_CHANNELS, channel, value);
     }
 }
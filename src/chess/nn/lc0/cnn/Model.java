@@ -1,6 +1,7 @@
 package chess.nn.lc0.cnn;
 
 import chess.core.Position;
+import chess.gpu.PackedPlanes;
 
 import java.io.IOException;
 import java.nio.file.Path;
@@ -15,7 +16,7 @@ import java.util.List;
  *
  * <p>Backend selection is controlled by JVM system properties:
  * <ul>
- *   <li>{@code -Dcrtk.lc0.backend=auto|cpu|cuda|rocm|amd|hip|oneapi|intel}</li>
+ *   <li>{@code -Dcrtk.lc0.backend=auto|cpu|cuda|rocm|amd|hip|oneapi|intel|host}</li>
  *   <li>{@code -Dcrtk.lc0.threads=N} (CPU only)</li>
  *   <li>{@code -Djava.library.path=...} (required to load the CUDA JNI library)</li>
  *   <li>Only the current backend property names are accepted.</li>
@@ -84,6 +85,9 @@ public final class Model implements AutoCloseable {
     /**
      * Encodes and evaluates a batch of positions.
      *
+     * <p>Positions are encoded as packed planes; the CUDA and ROCm backends
+     * expand them on the device (see {@link Network#predictPackedBatch(List)}).
+     *
      * @param positions positions to evaluate
      * @return predictions aligned with {@code positions}
      */
@@ -91,16 +95,16 @@ public final class Model implements AutoCloseable {
         if (positions == null) {
             throw new IllegalArgumentException("positions == null");
         }
-        int expected = network.info().inputChannels() * 64;
-        List<float[]> encoded = new ArrayList<>(positions.size());
+        int expected = PackedPlanes.words(network.info().inputChannels());
+        List<long[]> packed = new ArrayList<>(positions.size());
         for (Position position : positions) {
-            float[] planes = Encoder.encode(position);
-            if (planes.length != expected) {
-                throw new IllegalStateException("Encoder produced " + planes.length + " floats, expected " + expected);
+            long[] words = Encoder.encodePacked(position);
+            if (words.length != expected) {
+                throw new IllegalStateException("Encoder produced " + words.length + " longs, expected " + expected);
             }
-            encoded.add(planes);
+            packed.add(words);
         }
-        return network.predictEncodedBatch(encoded);
+        return network.predictPackedBatch(packed);
     }
 
     /**
@@ -3,62 +3,29 @@ package chess.nn.lc0.cnn;
 import java.nio.file.Path;
 import java.util.function.LongConsumer;
 
+import chess.gpu.NativeOps;
+
 /**
  * Shared helpers for thin JNI-backed LC0 backends.
  *
+ * <p>The family-independent creation and batch plumbing lives in
+ * {@link NativeOps}; this class maps the native metadata onto
+ * {@link Network.Info} and the network's tensor sizes.
+ *
  * @since 2026
  * @author Lennart A. Conrad
  */
 public final class NativeBackendOps {
 
-     /**
-     * Creates a new native backend ops instance.
-     */
-     private NativeBackendOps() {}
-
     /**
-     * Common result of native backend creation.
-     *
-     * @param handle native backend handle
-     * @param info parsed network metadata
+     * Number of metadata longs returned by {@code nativeGetInfo}.
      */
-    public record Created(
-        /**
-         * Stores the handle.
-         */
-        long handle,
-        /**
-         * Stores the info.
-         */
-        Network.Info info
-    ) {}
+    private static final int INFO_FIELDS = 7;
 
     /**
-     * Functional interface for native evaluator creation.
+     * Utility class, prevents instantiation.
      */
-    @FunctionalInterface
-    public interface HandleCreator {
-        /**
-         * Creates a native evaluator for the given weights path.
-         *
-         * @param weightsPath absolute path to the weights file
-         * @return native handle, or zero on failure
-         */
-        long create(String weightsPath);
-    }
-
-    /**
-     * Functional interface for native metadata lookup.
-     */
-    @FunctionalInterface
-    public interface InfoReader {
-        /**
-         * Reads network metadata from the native backend.
-         *
-         * @param handle native backend handle
-         * @return raw metadata array, or {@code null} on failure
-         */
-        long[] read(long handle);
+    private NativeBackendOps() {
     }
 
     /**
@@ -89,30 +56,34 @@ public final class NativeBackendOps {
      * @param infoFailure message used when metadata is invalid
      * @return created native backend handle and metadata
      */
-    public static Created create(
+    public static NativeOps.Created<Network.Info> create(
             Path weightsBin,
-            HandleCreator creator,
-            InfoReader infoReader,
+            NativeOps.HandleCreator creator,
+            NativeOps.InfoReader infoReader,
             LongConsumer destroyer,
             String createFailure,
             String infoFailure) {
-        long handle = creator.create(weightsBin.toAbsolutePath().toString());
-        if (handle == 0L) {
-            throw new IllegalStateException(createFailure);
-        }
-        long[] meta = infoReader.read(handle);
-        if (meta == null || meta.length < 7) {
-            destroyer.accept(handle);
-            throw new IllegalStateException(infoFailure);
-        }
-        return new Created(handle, new Network.Info(
-                (int) meta[0],
-                (int) meta[1],
-                (int) meta[2],
-                (int) meta[3],
-                (int) meta[4],
-                (int) meta[5],
-                meta[6]));
+        return NativeOps.create(weightsBin, creator, infoReader, INFO_FIELDS,
+                (handle, meta) -> new Network.Info(
+                        (int) meta[0],
+                        (int) meta[1],
+                        (int) meta[2],
+                        (int) meta[3],
+                        (int) meta[4],
+                        (int) meta[5],
+                        meta[6]),
+                destroyer, createFailure, infoFailure);
+    }
+
+    /**
+     * Returns the per-position tensor sizes used by the {@link NativeOps} batch helpers.
+     *
+     * @param info loaded network metadata
+     * @return layout of one encoded position and its outputs
+     */
+    public static NativeOps.Layout<Network.Prediction> layout(Network.Info info) {
+        return new NativeOps.Layout<>(info.inputChannels() * 64, info.inputChannels(), info.policySize(),
+                Network.Prediction::new);
     }
 
     /**
@@ -137,14 +108,4 @@ public final class NativeBackendOps {
         float value = predictor.predict(handle, encodedPlanes, policy, wdl);
         return new Network.Prediction(policy, wdl, value);
     }
-
-    /**
-     * Releases a native handle through the provided destroy function.
-     *
-     * @param handle native backend handle
-     * @param destroyer native destroy function
-     */
-    public static void destroy(long handle, LongConsumer destroyer) {
-        destroyer.accept(handle);
-    }
 }
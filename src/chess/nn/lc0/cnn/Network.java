@@ -7,6 +7,7 @@ import java.util.Arrays;
 import java.util.List;
 
 import chess.gpu.BackendNames;
+import chess.gpu.PackedPlanes;
 import chess.nn.lc0.cnn.cuda.Backend;
 
 /**
@@ -24,18 +25,22 @@ import chess.nn.lc0.cnn.cuda.Backend;
  * <ul>
  * <li>a pure-Java CPU backend</li>
  * <li>optional GPU backends via JNI (CUDA/ROCm/oneAPI)</li>
+ * <li>an optional native CPU backend via JNI ({@code native/host}, SIMD
+ * GEMM convolutions on host threads)</li>
  * </ul>
  *
  * <h2>Backend selection</h2>
  * <ul>
  * <li>{@code -Dcrtk.lc0.backend=auto} (default): use the first available GPU
  * backend
- * (CUDA, then ROCm, then oneAPI) that initializes successfully, else CPU</li>
+ * (CUDA, then ROCm, then oneAPI) that initializes successfully, then the
+ * native host backend, else CPU</li>
  * <li>{@code -Dcrtk.lc0.backend=cpu}: force CPU</li>
  * <li>{@code -Dcrtk.lc0.backend=cuda}: force CUDA (throws if init
  * fails/unavailable)</li>
  * <li>{@code -Dcrtk.lc0.backend=rocm|amd|hip}: force ROCm (AMD)</li>
  * <li>{@code -Dcrtk.lc0.backend=oneapi|intel}: force oneAPI (Intel)</li>
+ * <li>{@code -Dcrtk.lc0.backend=host}: force the native CPU backend</li>
  * </ul>
  *
  *
@@ -86,7 +91,12 @@ public final class Network implements AutoCloseable {
     public static final String BACKEND_ONEAPI = BackendNames.ONEAPI;
 
     /**
-     * CPU backend weights (null when a GPU backend is active).
+     * Native CPU backend identifier.
+     */
+    public static final String BACKEND_HOST = BackendNames.HOST;
+
+    /**
+     * CPU backend weights (null when a native backend is active).
      */
     private final Weights weights; // CPU backend (when non-null)
 
@@ -105,26 +115,34 @@ public final class Network implements AutoCloseable {
      */
     private final chess.nn.lc0.cnn.oneapi.Backend oneapi; // oneAPI backend (when non-null)
 
+    /**
+     * Native CPU backend instance (null when inactive).
+     */
+    private final chess.nn.lc0.cnn.host.Backend host; // host backend (when non-null)
+
     /**
      * Internal constructor selecting the active backend.
      * @param weights network weights
      * @param cuda CUDA backend metadata
      * @param rocm ROCm backend metadata
      * @param oneapi oneAPI backend metadata
+     * @param host native CPU backend metadata
      */
-    private Network(Weights weights, Backend cuda, chess.nn.lc0.cnn.rocm.Backend rocm, chess.nn.lc0.cnn.oneapi.Backend oneapi) {
+    private Network(Weights weights, Backend cuda, chess.nn.lc0.cnn.rocm.Backend rocm, chess.nn.lc0.cnn.oneapi.Backend oneapi,
+            chess.nn.lc0.cnn.host.Backend host) {
         this.weights = weights;
         this.cuda = cuda;
         this.rocm = rocm;
         this.oneapi = oneapi;
+        this.host = host;
     }
 
     /**
      * Loads a ChessRTK LC0 CNN {@code .bin} weights file.
      *
      * <p>
-     * Depending on {@code -Dcrtk.lc0.backend} and GPU availability, this will load
-     * either the CPU or a GPU backend.
+     * Depending on {@code -Dcrtk.lc0.backend} and native library availability, this
+     * will load either the CPU, a GPU, or the native host backend.
      *
      * @param path path to a ChessRTK LC0 CNN binary weights file
      * @return network evaluator
@@ -148,11 +166,11 @@ public final class Network implements AutoCloseable {
      * @throws IOException if the weights cannot be read or parsed
      */
     public static Network loadCpu(Path path) throws IOException {
-        return new Network(Weights.load(path), null, null, null);
+        return new Network(Weights.load(path), null, null, null, null);
     }
 
     /**
-     * Attempts requested GPU backends in priority order.
+     * Attempts requested native backends in priority order (GPUs first, then host).
      *
      * @param path path to the weights file
      * @param request requested backend preferences
@@ -172,8 +190,13 @@ public final class Network implements AutoCloseable {
         if (network != null) {
             return network;
         }
-        return tryLoadBackend(path, request.preferOneapi(), availability.oneapi(), request.forceOneapi(), "oneAPI",
+        network = tryLoadBackend(path, request.preferOneapi(), availability.oneapi(), request.forceOneapi(), "oneAPI",
                 Network::loadOneapi);
+        if (network != null) {
+            return network;
+        }
+        return tryLoadBackend(path, request.preferHost(), availability.host(), request.forceHost(), "Host",
+                Network::loadHost);
     }
 
     /**
@@ -234,6 +257,10 @@ public final class Network implements AutoCloseable {
          * Stores the prefer oneapi.
          */
         boolean preferOneapi,
+        /**
+         * Stores the prefer host.
+         */
+        boolean preferHost,
         /**
          * Stores the force cuda.
          */
@@ -245,7 +272,11 @@ public final class Network implements AutoCloseable {
         /**
          * Stores the force oneapi.
          */
-        boolean forceOneapi
+        boolean forceOneapi,
+        /**
+         * Stores the force host.
+         */
+        boolean forceHost
     ) {
 
         /**
@@ -263,7 +294,8 @@ public final class Network implements AutoCloseable {
             boolean cuda = backend.equals(BACKEND_CUDA);
             boolean rocm = backend.equals(BACKEND_ROCM) || backend.equals("amd") || backend.equals("hip");
             boolean oneapi = backend.equals(BACKEND_ONEAPI) || backend.equals("intel");
-            return new BackendRequest(auto || cuda, auto || rocm, auto || oneapi, cuda, rocm, oneapi);
+            boolean host = backend.equals(BACKEND_HOST);
+            return new BackendRequest(auto || cuda, auto || rocm, auto || oneapi, auto || host, cuda, rocm, oneapi, host);
         }
 
         /**
@@ -279,6 +311,8 @@ public final class Network implements AutoCloseable {
                     "ROCm backend requested but unavailable (JNI library not loaded and/or no ROCm device).");
             requireBackendAvailable(forceOneapi, availability.oneapi(),
                     "oneAPI backend requested but unavailable (JNI library not loaded and/or no Intel GPU device).");
+            requireBackendAvailable(forceHost, availability.host(),
+                    "Host backend requested but unavailable (JNI library not loaded).");
         }
     }
 
@@ -297,7 +331,11 @@ public final class Network implements AutoCloseable {
         /**
          * Stores the oneapi.
          */
-        boolean oneapi
+        boolean oneapi,
+        /**
+         * Stores the host.
+         */
+        boolean host
     ) {
 
         /**
@@ -309,7 +347,8 @@ public final class Network implements AutoCloseable {
             return new BackendAvailability(
                     Backend.isAvailable(),
                     chess.nn.lc0.cnn.rocm.Backend.isAvailable(),
-                    chess.nn.lc0.cnn.oneapi.Backend.isAvailable());
+                    chess.nn.lc0.cnn.oneapi.Backend.isAvailable(),
+                    chess.nn.lc0.cnn.host.Backend.isAvailable());
         }
     }
 
@@ -353,7 +392,7 @@ public final class Network implements AutoCloseable {
      */
     private static Network loadCuda(Path path) {
         try (CudaBackendHolder holder = new CudaBackendHolder(Backend.create(path))) {
-            Network network = new Network(null, holder.backend, null, null);
+            Network network = new Network(null, holder.backend, null, null, null);
             holder.detach();
             return network;
         }
@@ -368,7 +407,7 @@ public final class Network implements AutoCloseable {
      */
     private static Network loadRocm(Path path) {
         try (RocmBackendHolder holder = new RocmBackendHolder(chess.nn.lc0.cnn.rocm.Backend.create(path))) {
-            Network network = new Network(null, null, holder.backend, null);
+            Network network = new Network(null, null, holder.backend, null, null);
             holder.detach();
             return network;
         }
@@ -383,7 +422,22 @@ public final class Network implements AutoCloseable {
      */
     private static Network loadOneapi(Path path) {
         try (OneapiBackendHolder holder = new OneapiBackendHolder(chess.nn.lc0.cnn.oneapi.Backend.create(path))) {
-            Network network = new Network(null, null, null, holder.backend);
+            Network network = new Network(null, null, null, holder.backend, null);
+            holder.detach();
+            return network;
+        }
+    }
+
+    /**
+     * Loads a network using the native CPU backend.
+     * Returns an initialized instance when the host library sets up successfully.
+     *
+     * @param path path to the weights file
+     * @return host-backed network instance
+     */
+    private static Network loadHost(Path path) {
+        try (HostBackendHolder holder = new HostBackendHolder(chess.nn.lc0.cnn.host.Backend.create(path))) {
+            Network network = new Network(null, null, null, null, holder.backend);
             holder.detach();
             return network;
         }
@@ -502,10 +556,46 @@ public final class Network implements AutoCloseable {
         }
     }
 
+    /**
+     * Helper that owns a native CPU backend until detached or closed.
+     * Ensures the backend is closed on error paths.
+     */
+    private static final class HostBackendHolder implements AutoCloseable {
+         /**
+         * Stores the backend.
+         */
+         private chess.nn.lc0.cnn.host.Backend backend;
+
+         /**
+         * Creates a new host backend holder instance.
+         * @param backend engine or network backend
+         */
+         private HostBackendHolder(chess.nn.lc0.cnn.host.Backend backend) {
+            this.backend = backend;
+        }
+
+         /**
+         * Handles detach.
+         */
+         private void detach() {
+            backend = null;
+        }
+
+         /**
+         * Handles close.
+         */
+         @Override
+        public void close() {
+            if (backend != null) {
+                backend.close();
+            }
+        }
+    }
+
     /**
      * Returns the active backend for this instance.
      *
-     * @return {@code "cpu"}, {@code "cuda"}, {@code "rocm"}, or {@code "oneapi"}
+     * @return {@code "cpu"}, {@code "cuda"}, {@code "rocm"}, {@code "oneapi"}, or {@code "host"}
      */
     public String backend() {
         if (cuda != null) {
@@ -517,6 +607,9 @@ public final class Network implements AutoCloseable {
         if (oneapi != null) {
             return BACKEND_ONEAPI;
         }
+        if (host != null) {
+            return BACKEND_HOST;
+        }
         return BACKEND_CPU;
     }
 
@@ -535,6 +628,9 @@ public final class Network implements AutoCloseable {
         if (oneapi != null) {
             return oneapi.info();
         }
+        if (host != null) {
+            return host.info();
+        }
         return new Info(
                 weights.inputChannels,
                 weights.trunkChannels,
@@ -579,6 +675,9 @@ public final class Network implements AutoCloseable {
         if (oneapi != null) {
             return oneapi.predictEncoded(encodedPlanes);
         }
+        if (host != null) {
+            return host.predictEncoded(encodedPlanes);
+        }
         if (encodedPlanes.length != weights.inputChannels * 64) {
             throw new IllegalArgumentException("Encoded input must be " + (weights.inputChannels * 64) + " floats.");
         }
@@ -596,14 +695,17 @@ public final class Network implements AutoCloseable {
             throw new IllegalArgumentException("encodedBatch == null");
         }
         if (cuda != null) {
-            return predictEncodedBatchSequential(encodedBatch);
+            return cuda.predictEncodedBatch(encodedBatch);
         }
         if (rocm != null) {
-            return predictEncodedBatchSequential(encodedBatch);
+            return rocm.predictEncodedBatch(encodedBatch);
         }
         if (oneapi != null) {
             return predictEncodedBatchSequential(encodedBatch);
         }
+        if (host != null) {
+            return host.predictEncodedBatch(encodedBatch);
+        }
         int expected = weights.inputChannels * 64;
         for (float[] encodedPlanes : encodedBatch) {
             if (encodedPlanes == null || encodedPlanes.length != expected) {
@@ -613,6 +715,37 @@ public final class Network implements AutoCloseable {
         return Evaluator.evaluateBatch(weights, encodedBatch);
     }
 
+    /**
+     * Runs forward passes for packed LC0 plane batches ({@link PackedPlanes}).
+     *
+     * <p>The CUDA and ROCm backends upload the packed words and expand them on
+     * the device; the other backends expand them on the host and run
+     * {@link #predictEncodedBatch(List)}.
+     *
+     * @param packedBatch packed planes aligned by position
+     * @return predictions aligned with {@code packedBatch}
+     */
+    public List<Prediction> predictPackedBatch(List<long[]> packedBatch) {
+        if (packedBatch == null) {
+            throw new IllegalArgumentException("packedBatch == null");
+        }
+        if (cuda != null) {
+            return cuda.predictPackedBatch(packedBatch);
+        }
+        if (rocm != null) {
+            return rocm.predictPackedBatch(packedBatch);
+        }
+        int channels = info().inputChannels();
+        List<float[]> encoded = new ArrayList<>(packedBatch.size());
+        for (long[] packed : packedBatch) {
+            if (packed == null || packed.length != PackedPlanes.words(channels)) {
+                throw new IllegalArgumentException("Packed input must be " + PackedPlanes.words(channels) + " longs.");
+            }
+            encoded.add(PackedPlanes.expand(packed, channels));
+        }
+        return predictEncodedBatch(encoded);
+    }
+
     /**
      * Runs batch prediction through single-position backend calls.
      * @param encodedBatch source encoded batch
@@ -631,7 +764,7 @@ public final class Network implements AutoCloseable {
      *
      * <p>
      * CPU backend has no native resources. GPU backends must be closed to free
-     * device memory.
+     * device memory; the host backend frees its workspace and packed weights.
      */
     @Override
     public void close() {
@@ -644,7 +777,10 @@ public final class Network implements AutoCloseable {
         if (oneapi != null) {
             oneapi.close();
         }
-        if (cuda == null && rocm == null && oneapi == null) {
+        if (host != null) {
+            host.close();
+        }
+        if (cuda == null && rocm == null && oneapi == null && host == null) {
             Evaluator.clearThreadLocal();
         }
     }
@@ -0,0 +1,170 @@
+package chess.nn.lc0.cnn.host;
+
+import java.nio.file.Path;
+import java.util.List;
+
+import chess.gpu.NativeOps;
+import chess.nn.lc0.cnn.NativeBackendOps;
+import chess.nn.lc0.cnn.Network;
+
+/**
+ * Optional native CPU backend (JNI) for LC0 policy+value inference.
+ *
+ * <p>This uses a native shared library ({@code lc0_host}) and will only be used when
+ * the library is loadable (see {@link Support}). It needs no GPU: convolutions run as
+ * blocked GEMMs with AVX-512, AVX2 or portable kernels on a pool of host threads
+ * ({@code CRTK_LC0_HOST_THREADS}).
+ *
+ * <p>{@link Network#load(Path)} selects this backend automatically when {@code -Dcrtk.lc0.backend=auto},
+ * no GPU backend initializes and the library is available (current system properties only).
+ *
+ * <p>This class is a thin wrapper around native code. It owns native resources and must be closed.
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class Backend implements AutoCloseable {
+
+    /**
+     * Native handle to the host evaluator instance (opaque pointer stored as a {@code long}).
+     */
+    private final long handle;
+
+    /**
+     * Metadata for the loaded network.
+     */
+    private final Network.Info info;
+
+    /**
+     * Constructor used internally after a successful native creation.
+     *
+     * @param handle native JNI handle
+     * @param info parsed network metadata
+     */
+    private Backend(long handle, Network.Info info) {
+        this.handle = handle;
+        this.info = info;
+    }
+
+    /**
+     * Returns {@code true} if the JNI library loaded.
+     *
+     * @return {@code true} when native CPU inference is available
+     */
+    public static boolean isAvailable() {
+        return Support.isAvailable();
+    }
+
+    /**
+     * Creates a native CPU evaluator from a ChessRTK LC0 CNN {@code .bin} weights file.
+     *
+     * @param weightsBin path to ChessRTK LC0 CNN binary weights
+     * @return evaluator instance owning native resources
+     * @throws IllegalStateException if initialization fails
+     */
+    public static Backend create(Path weightsBin) {
+        NativeOps.Created<Network.Info> created = NativeBackendOps.create(
+                weightsBin,
+                Backend::nativeCreate,
+                Backend::nativeGetInfo,
+                Backend::nativeDestroy,
+                "Failed to create host evaluator (library / weights init failed).",
+                "Host evaluator returned invalid info.");
+        return new Backend(created.handle(), created.info());
+    }
+
+    /**
+     * Returns basic network metadata.
+     *
+     * @return parsed network information
+     */
+    public Network.Info info() {
+        return info;
+    }
+
+    /**
+     * Runs one forward pass on an already-encoded LC0 112-plane input.
+     *
+     * @param encodedPlanes input planes, shape {@code [inputChannels * 64]}
+     * @return policy logits, WDL probabilities, and scalar {@code W-L} value
+     */
+    public Network.Prediction predictEncoded(float[] encodedPlanes) {
+        return NativeBackendOps.predictEncoded(handle, info, encodedPlanes, Backend::nativePredict);
+    }
+
+    /**
+     * Runs batched forward passes on already-encoded LC0 112-plane inputs.
+     *
+     * <p>The whole batch crosses JNI in one call; the native side evaluates it in
+     * chunks of {@code CRTK_LC0_HOST_MAX_BATCH} positions.
+     *
+     * @param encodedBatch input planes aligned by position, each {@code [inputChannels * 64]}
+     * @return predictions aligned with {@code encodedBatch}
+     */
+    public List<Network.Prediction> predictEncodedBatch(List<float[]> encodedBatch) {
+        return NativeOps.predictEncodedBatch(handle, NativeBackendOps.layout(info), encodedBatch,
+                Backend::nativePredictBatch);
+    }
+
+    /**
+     * Releases native resources (workspace and, with the last handle, the packed weights).
+     */
+    @Override
+    public void close() {
+        NativeOps.destroy(handle, Backend::nativeDestroy);
+    }
+
+    /**
+     * JNI entry point implemented in {@code native/host/lc0_cnn_host_jni.cpp}.
+     *
+     * @param weightsPath absolute path to the LC0 CNN weights file
+     * @return native handle or zero on failure
+     */
+    private static native long nativeCreate(String weightsPath);
+
+    /**
+     * JNI entry point implemented in {@code native/host/lc0_cnn_host_jni.cpp}.
+     *
+     * @param handle native handle to destroy
+     */
+    private static native void nativeDestroy(long handle);
+
+    /**
+     * JNI entry point implemented in {@code native/host/lc0_cnn_host_jni.cpp}.
+     *
+     * @param handle native handle to inspect
+     * @return {@code [inputC, trunkC, blocks, policyC, valueC, policySize, paramCount, maxBatch, isa, threads, evalCount, meanEvalNanos]}
+     */
+    private static native long[] nativeGetInfo(long handle);
+
+    /**
+     * JNI entry point implemented in {@code native/host/lc0_cnn_host_jni.cpp}.
+     *
+     * <p>Writes {@code outPolicy} (length {@code policySize}) and {@code outWdl} (length 3).
+     *
+     * @param handle native handle
+     * @param encodedPlanes LC0 input planes
+     * @param outPolicy array to receive policy logits
+     * @param outWdl array to receive raw WDL
+     * @return scalar {@code W-L} value
+     */
+    private static native float nativePredict(long handle, float[] encodedPlanes, float[] outPolicy, float[] outWdl);
+
+    /**
+     * JNI entry point implemented in {@code native/host/lc0_cnn_host_jni.cpp}.
+     *
+     * <p>Reads {@code count} positions from {@code encodedBatch} and writes
+     * {@code count * policySize} policy logits, {@code count * 3} WDL values, and
+     * {@code count} scalar values.
+     *
+     * @param handle native handle
+     * @param encodedBatch LC0 input planes for all positions, back to back
+     * @param count number of positions
+     * @param outPolicy array to receive policy logits
+     * @param outWdl array to receive WDL probabilities
+     * @param outValue array to receive scalar {@code W-L} values
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePredictBatch(long handle, float[] encodedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+}
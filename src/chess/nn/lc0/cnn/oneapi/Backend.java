@@ -2,6 +2,7 @@ package chess.nn.lc0.cnn.oneapi;
 
 import java.nio.file.Path;
 
+import chess.gpu.NativeOps;
 import chess.nn.lc0.cnn.NativeBackendOps;
 import chess.nn.lc0.cnn.Network;
 
@@ -62,7 +63,7 @@ public final class Backend implements AutoCloseable {
      * @throws IllegalStateException if initialization fails
      */
     public static Backend create(Path weightsBin) {
-        NativeBackendOps.Created created = NativeBackendOps.create(
+        NativeOps.Created<Network.Info> created = NativeBackendOps.create(
                 weightsBin,
                 Backend::nativeCreate,
                 Backend::nativeGetInfo,
@@ -96,7 +97,7 @@ public final class Backend implements AutoCloseable {
      */
     @Override
     public void close() {
-        NativeBackendOps.destroy(handle, Backend::nativeDestroy);
+        NativeOps.destroy(handle, Backend::nativeDestroy);
     }
 
     /**
@@ -5,6 +5,8 @@ import chess.core.MoveList;
 import chess.core.Piece;
 import chess.core.Position;
 import chess.gpu.BackendNames;
+import chess.gpu.EvalQueue;
+import chess.gpu.PackedPlanes;
 import chess.nn.ActivationSink;
 import chess.nn.lc0.bt4.PolicyEncoder;
 import java.io.IOException;
@@ -14,6 +16,9 @@ import java.nio.ByteOrder;
 import java.nio.charset.StandardCharsets;
 import java.nio.file.Files;
 import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CompletableFuture;
 
 /**
  * Lightweight OTIS policy/WDL model used by the workbench while trained
@@ -197,6 +202,12 @@ public final class Model implements AutoCloseable {
      */
     private final chess.nn.otis.oneapi.Backend oneapi;
 
+    /**
+     * Coalescing queue over the CUDA/ROCm backend, opened by the first
+     * {@link #predictAsync(Position)}; guarded by {@code this}.
+     */
+    private EvalQueue<Prediction> queue;
+
     /**
      * Creates a model bound to a single active backend.
      *
@@ -818,6 +829,72 @@ public final class Model implements AutoCloseable {
         return new Prediction(policy, wdl, scalar);
     }
 
+    /**
+     * Evaluates a batch of positions.
+     *
+     * <p>The CUDA and ROCm backends take the batch as packed planes
+     * ({@link PackedPlanes}) in one call and expand them on the device; the
+     * oneAPI and CPU paths evaluate position by position.
+     *
+     * @param positions source positions
+     * @return predictions aligned with {@code positions}
+     */
+    public List<Prediction> predictBatch(List<Position> positions) {
+        if (positions == null) {
+            throw new IllegalArgumentException("positions == null");
+        }
+        if (cuda != null || rocm != null) {
+            List<long[]> packed = new ArrayList<>(positions.size());
+            for (Position position : positions) {
+                if (position == null) {
+                    throw new IllegalArgumentException("position == null");
+                }
+                packed.add(encodePackedInput(position));
+            }
+            return cuda != null ? cuda.predictPackedBatch(packed) : rocm.predictPackedBatch(packed);
+        }
+        List<Prediction> out = new ArrayList<>(positions.size());
+        for (Position position : positions) {
+            out.add(predict(position));
+        }
+        return out;
+    }
+
+    /**
+     * Queues one position for evaluation.
+     *
+     * <p>On CUDA and ROCm, concurrent callers share one native queue that
+     * coalesces their positions into batched forward passes. Other backends
+     * evaluate synchronously and return a completed future. Do not mix this with
+     * {@link #predict(Position)} or {@link #predictBatch(List)} from other
+     * threads while a GPU backend is active.
+     *
+     * @param position source position
+     * @return future prediction
+     */
+    public CompletableFuture<Prediction> predictAsync(Position position) {
+        if (position == null) {
+            throw new IllegalArgumentException("position == null");
+        }
+        EvalQueue<Prediction> active = queue();
+        if (active == null) {
+            return CompletableFuture.completedFuture(predict(position));
+        }
+        return active.submit(encodeInput(position));
+    }
+
+    /**
+     * Returns the native evaluation queue, opening it on first use.
+     *
+     * @return queue, or null when no CUDA/ROCm backend is active
+     */
+    private synchronized EvalQueue<Prediction> queue() {
+        if (queue == null && (cuda != null || rocm != null)) {
+            queue = cuda != null ? cuda.openQueue() : rocm.openQueue();
+        }
+        return queue;
+    }
+
     /**
      * Runs one prediction through an active native backend.
      *
@@ -844,6 +921,12 @@ public final class Model implements AutoCloseable {
      */
     @Override
     public void close() {
+        synchronized (this) {
+            if (queue != null) {
+                queue.close();
+                queue = null;
+            }
+        }
         if (cuda != null) {
             cuda.close();
         }
@@ -1060,24 +1143,32 @@ public final class Model implements AutoCloseable {
      * @return flat plane-major input tensor
      */
     private static float[] encodeInput(Position position) {
-        float[] input = new float[INPUT_PLANES * SQUARES];
-        boolean whiteToMove = position.isWhiteToMove();
+        return PackedPlanes.expand(encodePackedInput(position), INPUT_PLANES);
+    }
+
+    /**
+     * Encodes current-position planes as square masks ({@link PackedPlanes}).
+     *
+     * @param position source position
+     * @return {@code PackedPlanes.words(INPUT_PLANES)} longs
+     */
+    private static long[] encodePackedInput(Position position) {
+        long[] input = PackedPlanes.allocate(INPUT_PLANES);
         byte[] board = position.getBoard();
         for (int sq = 0; sq < board.length; sq++) {
-            byte piece = board[sq];
-            int plane = piecePlane(piece);
+            int plane = piecePlane(board[sq]);
             if (plane >= 0) {
-                input[plane * SQUARES + sq] = 1.0f;
+                input[plane] |= 1L << sq;
             }
         }
-        fillPlane(input, 12, whiteToMove ? 1.0f : 0.0f);
-        fillPlane(input, 13, position.canCastle(Position.WHITE_KINGSIDE) ? 1.0f : 0.0f);
-        fillPlane(input, 14, position.canCastle(Position.WHITE_QUEENSIDE) ? 1.0f : 0.0f);
-        fillPlane(input, 15, position.canCastle(Position.BLACK_KINGSIDE) ? 1.0f : 0.0f);
-        fillPlane(input, 16, position.canCastle(Position.BLACK_QUEENSIDE) ? 1.0f : 0.0f);
+        input[12] = position.isWhiteToMove() ? PackedPlanes.ALL_SQUARES : 0L;
+        input[13] = position.canCastle(Position.WHITE_KINGSIDE) ? PackedPlanes.ALL_SQUARES : 0L;
+        input[14] = position.canCastle(Position.WHITE_QUEENSIDE) ? PackedPlanes.ALL_SQUARES : 0L;
+        input[15] = position.canCastle(Position.BLACK_KINGSIDE) ? PackedPlanes.ALL_SQUARES : 0L;
+        input[16] = position.canCastle(Position.BLACK_QUEENSIDE) ? PackedPlanes.ALL_SQUARES : 0L;
         byte ep = position.enPassantSquare();
         if (ep >= 0 && ep < SQUARES) {
-            input[17 * SQUARES + ep] = 1.0f;
+            input[17] |= 1L << ep;
         }
         return input;
     }
@@ -1100,20 +1191,6 @@ public final class Model implements AutoCloseable {
         return Piece.isWhitePiece(piece) ? type : 6 + type;
     }
 
-    /**
-     * Fills one input plane with a scalar.
-     *
-     * @param input tensor
-     * @param plane plane index
-     * @param value candidate value
-     */
-    private static void fillPlane(float[] input, int plane, float value) {
-        int offset = plane * SQUARES;
-        for (int i = 0; i < SQUARES; i++) {
-            input[offset + i] = value;
-        }
-    }
-
     /**
      * Returns the readout feature width for a trunk size.
      *
@@ -3,13 +3,17 @@ package chess.nn.otis;
 import java.nio.file.Path;
 import java.util.function.LongConsumer;
 
+import chess.gpu.NativeOps;
+
 /**
  * Shared helpers for thin JNI-backed OTIS policy/WDL backends.
  *
  * <p>The optional CUDA/ROCm/oneAPI OTIS backends are tiny wrappers around native
  * code that all expose the same JNI surface (create, get-info, get-name,
- * predict, destroy). This class centralizes the Java-side glue so each backend
- * only declares its {@code native} entry points.
+ * predict, destroy). {@link NativeOps} holds the family-independent creation
+ * and batch plumbing; this class maps the native metadata onto
+ * {@link Model.Info} and the model's tensor sizes, so each backend only
+ * declares its {@code native} entry points.
  *
  * @since 2026
  * @author Lennart A. Conrad
@@ -32,54 +36,6 @@ public final class NativeBackendOps {
     private NativeBackendOps() {
     }
 
-    /**
-     * Common result of native backend creation.
-     *
-     * @param handle native backend handle
-     * @param info parsed model metadata
-     */
-    public record Created(
-        /**
-         * Stores the handle.
-         */
-        long handle,
-        /**
-         * Stores the info.
-         */
-        Model.Info info
-    ) {
-    }
-
-    /**
-     * Functional interface for native evaluator creation.
-     */
-    @FunctionalInterface
-    public interface HandleCreator {
-
-        /**
-         * Creates a native evaluator for the given weights path.
-         *
-         * @param weightsPath absolute path to the weights file
-         * @return native handle, or zero on failure
-         */
-        long create(String weightsPath);
-    }
-
-    /**
-     * Functional interface for native metadata lookup.
-     */
-    @FunctionalInterface
-    public interface InfoReader {
-
-        /**
-         * Reads model metadata from the native backend.
-         *
-         * @param handle native backend handle
-         * @return raw metadata array, or {@code null} on failure
-         */
-        long[] read(long handle);
-    }
-
     /**
      * Functional interface for native model-name lookup.
      */
@@ -125,31 +81,35 @@ public final class NativeBackendOps {
      * @param infoFailure message used when metadata is invalid
      * @return created native backend handle and metadata
      */
-    public static Created create(
+    public static NativeOps.Created<Model.Info> create(
             Path weightsBin,
-            HandleCreator creator,
-            InfoReader infoReader,
+            NativeOps.HandleCreator creator,
+            NativeOps.InfoReader infoReader,
             NameReader nameReader,
             LongConsumer destroyer,
             String createFailure,
             String infoFailure) {
-        long handle = creator.create(weightsBin.toAbsolutePath().toString());
-        if (handle == 0L) {
-            throw new IllegalStateException(createFailure);
-        }
-        long[] meta = infoReader.read(handle);
-        if (meta == null || meta.length < INFO_FIELDS) {
-            destroyer.accept(handle);
-            throw new IllegalStateException(infoFailure);
-        }
-        String name = nameReader.read(handle);
-        return new Created(handle, new Model.Info(
-                name == null || name.isBlank() ? "otis" : name,
-                (int) meta[0],
-                (int) meta[1],
-                (int) meta[2],
-                (int) meta[3],
-                (int) meta[4]));
+        return NativeOps.create(weightsBin, creator, infoReader, INFO_FIELDS, (handle, meta) -> {
+            String name = nameReader.read(handle);
+            return new Model.Info(
+                    name == null || name.isBlank() ? "otis" : name,
+                    (int) meta[0],
+                    (int) meta[1],
+                    (int) meta[2],
+                    (int) meta[3],
+                    (int) meta[4]);
+        }, destroyer, createFailure, infoFailure);
+    }
+
+    /**
+     * Returns the per-position tensor sizes used by the {@link NativeOps} batch helpers.
+     *
+     * @param info loaded model metadata
+     * @return layout of one encoded position and its outputs
+     */
+    public static NativeOps.Layout<Model.Prediction> layout(Model.Info info) {
+        return new NativeOps.Layout<>(info.inputPlanes() * SQUARES, info.inputPlanes(), info.policySize(),
+                Model.Prediction::new);
     }
 
     /**
@@ -175,14 +135,4 @@ public final class NativeBackendOps {
         float value = predictor.predict(handle, encodedPlanes, policy, wdl);
         return new Model.Prediction(policy, wdl, value);
     }
-
-    /**
-     * Releases a native handle through the provided destroy function.
-     *
-     * @param handle native backend handle
-     * @param destroyer native destroy function
-     */
-    public static void destroy(long handle, LongConsumer destroyer) {
-        destroyer.accept(handle);
-    }
 }
@@ -1,7 +1,15 @@
 package chess.nn.otis.cuda;
 
+import java.nio.ByteBuffer;
 import java.nio.file.Path;
+import java.util.Arrays;
+import java.util.List;
 
+import chess.gpu.EvalQueue;
+import chess.gpu.NativeOps;
+import chess.gpu.PackedPlanes;
+import chess.gpu.PinnedBuffers;
+import chess.gpu.StageStats;
 import chess.nn.otis.Model;
 import chess.nn.otis.NativeBackendOps;
 
@@ -40,6 +48,11 @@ public final class Backend implements AutoCloseable {
      */
     private final Model.Info info;
 
+    /**
+     * Pinned host buffers, created by the first {@link #pinnedBuffers()} call.
+     */
+    private PinnedBuffers pinned;
+
     /**
      * Constructor used internally after a successful native creation.
      *
@@ -68,7 +81,7 @@ public final class Backend implements AutoCloseable {
      * @throws IllegalStateException if initialization fails
      */
     public static Backend create(Path weightsBin) {
-        NativeBackendOps.Created created = NativeBackendOps.create(
+        NativeOps.Created<Model.Info> created = NativeBackendOps.create(
                 weightsBin,
                 Backend::nativeCreate,
                 Backend::nativeGetInfo,
@@ -79,6 +92,30 @@ public final class Backend implements AutoCloseable {
         return new Backend(created.handle(), created.info());
     }
 
+    /**
+     * Creates a CUDA evaluator on one device.
+     *
+     * <p>{@link #create(Path)} is this method with device {@code 0}. Every native call on the
+     * returned handle binds its device first, so handles on different devices can be used from
+     * any thread.
+     *
+     * @param weightsBin OTIS weights file
+     * @param device CUDA device ordinal
+     * @return evaluator instance owning resources on {@code device}
+     * @throws IllegalStateException if the ordinal is out of range or initialization fails
+     */
+    public static Backend create(Path weightsBin, int device) {
+        NativeOps.Created<Model.Info> created = NativeBackendOps.create(
+                weightsBin,
+                path -> nativeCreateOnDevice(path, device),
+                Backend::nativeGetInfo,
+                Backend::nativeGetName,
+                Backend::nativeDestroy,
+                "Failed to create CUDA OTIS evaluator on device " + device + ".",
+                "CUDA OTIS evaluator returned invalid info.");
+        return new Backend(created.handle(), created.info());
+    }
+
     /**
      * Returns basic model metadata.
      *
@@ -98,12 +135,265 @@ public final class Backend implements AutoCloseable {
         return NativeBackendOps.predictEncoded(handle, info, encodedPlanes, Backend::nativePredict);
     }
 
+    /**
+     * Runs batched forward passes on already-encoded OTIS inputs.
+     *
+     * <p>The whole batch crosses JNI in one call; the native side evaluates it in
+     * device-sized chunks (see {@code CRTK_OTIS_CUDA_MAX_BATCH}).
+     *
+     * @param encodedBatch input planes aligned by position, each {@code [inputPlanes * 64]}
+     * @return predictions aligned with {@code encodedBatch}
+     */
+    public List<Model.Prediction> predictEncodedBatch(List<float[]> encodedBatch) {
+        return NativeOps.predictEncodedBatch(handle, NativeBackendOps.layout(info), encodedBatch,
+                Backend::nativePredictBatch);
+    }
+
+    /**
+     * Runs batched forward passes on packed OTIS inputs.
+     *
+     * <p>Each position crosses JNI and the bus as {@code inputPlanes + 1} longs
+     * ({@link PackedPlanes}); the native side expands them into input planes on
+     * the device and evaluates in device-sized chunks (see {@code CRTK_OTIS_CUDA_MAX_BATCH}).
+     *
+     * @param packedBatch packed input planes aligned by position
+     * @return predictions aligned with {@code packedBatch}
+     */
+    public List<Model.Prediction> predictPackedBatch(List<long[]> packedBatch) {
+        return NativeOps.predictPackedBatch(handle, NativeBackendOps.layout(info), packedBatch,
+                Backend::nativePredictPacked);
+    }
+
+    /**
+     * Opens a coalescing evaluation queue over this backend with the native
+     * batch size and the default deadline.
+     *
+     * @return open queue; close it before closing this backend
+     */
+    public EvalQueue<Model.Prediction> openQueue() {
+        return openQueue(0, EvalQueue.DEFAULT_DEADLINE_MICROS);
+    }
+
+    /**
+     * Opens a coalescing evaluation queue over this backend.
+     *
+     * <p>Concurrent callers submit single positions; a native dispatcher runs them
+     * in batches of up to {@code maxBatch} positions, or sooner once the oldest
+     * one has waited {@code deadlineMicros}. While the queue is open, predict only
+     * through it.
+     *
+     * @param maxBatch largest coalesced batch; zero or anything above
+     *                 {@code CRTK_OTIS_CUDA_MAX_BATCH} uses that limit
+     * @param deadlineMicros longest wait for a partial batch, in microseconds
+     * @return open queue; close it before closing this backend
+     */
+    public EvalQueue<Model.Prediction> openQueue(int maxBatch, long deadlineMicros) {
+        return new EvalQueue<>(
+                nativeQueueCreate(handle, maxBatch, deadlineMicros),
+                info.inputPlanes() * 64,
+                info.policySize(),
+                new EvalQueue.Ops(Backend::nativeQueueSubmit, Backend::nativeQueueTake,
+                        Backend::nativeQueueClose, Backend::nativeQueueDestroy),
+                (policy, wdl) -> new Model.Prediction(policy, wdl, wdl[0] - wdl[2]),
+                "crtk-otis-cuda-queue");
+    }
+
+    /**
+     * Returns this handle's pinned input/output buffers, allocating them on first use.
+     *
+     * <p>Write encoded planes into {@link PinnedBuffers#input(int)} and call
+     * {@link PinnedBuffers#predict(int)}; transfers go straight between the
+     * page-locked buffers and the device.
+     *
+     * @return pinned buffers sized for the native batch limit
+     */
+    public synchronized PinnedBuffers pinnedBuffers() {
+        if (pinned == null) {
+            pinned = PinnedBuffers.wrap(handle, nativePinnedBuffers(handle),
+                    info.inputPlanes() * 64, info.policySize(), Backend::nativePredictPinned);
+        }
+        return pinned;
+    }
+
+    /**
+     * One OTIS replica per CUDA device behind a single handle.
+     *
+     * <p>A call that fits in one native batch goes to the least-loaded replica, so
+     * concurrent callers spread over the devices; a larger call is split into whole
+     * native batches that the replicas evaluate in parallel. Results do not depend on
+     * the split. A pool is safe to share across threads.
+     */
+    public static final class Pool implements AutoCloseable {
+
+        /**
+         * Native pool handle.
+         */
+        private final long handle;
+
+        /**
+         * Metadata of the loaded weights, shared by every replica.
+         */
+        private final Model.Info info;
+
+        /**
+         * Device ordinals in replica order.
+         */
+        private final int[] devices;
+
+        /**
+         * Creates a wrapper around a native pool.
+         *
+         * @param handle native pool handle
+         * @param info metadata of the loaded weights
+         * @param devices device ordinals in replica order
+         */
+        private Pool(long handle, Model.Info info, int[] devices) {
+            this.handle = handle;
+            this.info = info;
+            this.devices = devices;
+        }
+
+        /**
+         * Creates a pool with one replica on every visible CUDA device.
+         *
+         * @param weightsBin OTIS weights file
+         * @return pool instance owning resources on every device
+         * @throws IllegalStateException if no device is visible or initialization fails
+         */
+        public static Pool create(Path weightsBin) {
+            int count = Support.deviceCount();
+            if (count <= 0) {
+                throw new IllegalStateException("No CUDA device available.");
+            }
+            int[] all = new int[count];
+            for (int i = 0; i < count; i++) {
+                all[i] = i;
+            }
+            return create(weightsBin, all);
+        }
+
+        /**
+         * Creates a pool with one replica per listed CUDA device.
+         *
+         * @param weightsBin OTIS weights file
+         * @param devices distinct device ordinals
+         * @return pool instance owning resources on every listed device
+         * @throws IllegalArgumentException if {@code devices} is empty
+         * @throws IllegalStateException if an ordinal is repeated or out of range, or initialization fails
+         */
+        public static Pool create(Path weightsBin, int... devices) {
+            if (devices == null || devices.length == 0) {
+                throw new IllegalArgumentException("devices must not be empty");
+            }
+            int[] ordinals = devices.clone();
+            NativeOps.Created<Model.Info> created = NativeBackendOps.create(
+                    weightsBin,
+                    path -> nativePoolCreate(path, ordinals),
+                    Backend::nativePoolGetInfo,
+                    Backend::nativePoolGetName,
+                    Backend::nativePoolDestroy,
+                    "Failed to create CUDA OTIS evaluator pool on devices " + Arrays.toString(ordinals) + ".",
+                    "CUDA OTIS evaluator pool returned invalid info.");
+            return new Pool(created.handle(), created.info(), ordinals);
+        }
+
+        /**
+         * @return device ordinals in replica order
+         */
+        public int[] devices() {
+            return devices.clone();
+        }
+
+        /**
+         * @return metadata of the loaded weights
+         */
+        public Model.Info info() {
+            return info;
+        }
+
+        /**
+         * Runs batched forward passes on already-encoded input planes across the pool.
+         *
+         * @param encodedBatch channel-major input planes aligned by position
+         * @return predictions aligned with {@code encodedBatch}
+         */
+        public List<Model.Prediction> predictEncodedBatch(List<float[]> encodedBatch) {
+            return NativeOps.predictEncodedBatch(handle, NativeBackendOps.layout(info), encodedBatch,
+                    Backend::nativePoolPredictBatch);
+        }
+
+        /**
+         * Runs batched forward passes on packed inputs ({@link PackedPlanes}) across the pool.
+         *
+         * @param packedBatch packed input planes aligned by position
+         * @return predictions aligned with {@code packedBatch}
+         */
+        public List<Model.Prediction> predictPackedBatch(List<long[]> packedBatch) {
+            return NativeOps.predictPackedBatch(handle, NativeBackendOps.layout(info), packedBatch,
+                    Backend::nativePoolPredictPacked);
+        }
+
+        /**
+         * @return completed predict calls per replica, aligned with {@link #devices()}
+         */
+        public long[] replicaCalls() {
+            return stat(1);
+        }
+
+        /**
+         * @return positions evaluated per replica, aligned with {@link #devices()}
+         */
+        public long[] replicaPositions() {
+            return stat(2);
+        }
+
+        /**
+         * Releases every replica.
+         */
+        @Override
+        public void close() {
+            NativeOps.destroy(handle, Backend::nativePoolDestroy);
+        }
+
+        /**
+         * Reads one column of the native per-replica counters.
+         *
+         * @param column {@code 1} for calls, {@code 2} for positions
+         * @return column values aligned with {@link #devices()}
+         */
+        private long[] stat(int column) {
+            long[] raw = nativePoolStats(handle);
+            long[] out = new long[devices.length];
+            if (raw == null) {
+                return out;
+            }
+            for (int i = 0; i < out.length && i * 3 + column < raw.length; i++) {
+                out[i] = raw[i * 3 + column];
+            }
+            return out;
+        }
+    }
+
+    /**
+     * Returns this handle's per-stage timing and counters.
+     *
+     * <p>Counting is on only when {@code CRTK_OTIS_CUDA_STATS=1} was set when the
+     * handle was created; otherwise the snapshot reports {@link StageStats#enabled()}
+     * {@code false}.
+     *
+     * @param reset whether to zero the native totals after reading them
+     * @return stage totals since the handle was created or last reset
+     */
+    public StageStats stats(boolean reset) {
+        return StageStats.read(handle, Backend::nativeGetStatNames, Backend::nativeGetStats, reset);
+    }
+
     /**
      * Releases native resources (device memory).
      */
     @Override
     public void close() {
-        NativeBackendOps.destroy(handle, Backend::nativeDestroy);
+        NativeOps.destroy(handle, Backend::nativeDestroy);
     }
 
     /**
@@ -125,7 +415,8 @@ public final class Backend implements AutoCloseable {
      * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
      *
      * @param handle native handle to inspect
-     * @return {@code [inputPlanes, trunkChannels, blocks, policySize, paramCount]}
+     * @return {@code [inputPlanes, trunkChannels, blocks, policySize, paramCount, graphs, evalCount, meanEvalNanos,
+     *         embedNanos, sheafNanos, finalizeNanos, readoutNanos, headsNanos, maxBatch]}
      */
     private static native long[] nativeGetInfo(long handle);
 
@@ -149,4 +440,195 @@ public final class Backend implements AutoCloseable {
      * @return scalar {@code W-L} value
      */
     private static native float nativePredict(long handle, float[] encodedPlanes, float[] outPolicy, float[] outWdl);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * <p>Reads {@code count} positions from {@code encodedBatch} and writes
+     * {@code count * policySize} policy logits, {@code count * 3} WDL values, and
+     * {@code count} scalar values.
+     *
+     * @param handle native handle
+     * @param encodedBatch OTIS input planes for all positions, back to back
+     * @param count number of positions
+     * @param outPolicy array to receive policy logits
+     * @param outWdl array to receive WDL probabilities
+     * @param outValue array to receive scalar {@code W-L} values
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePredictBatch(long handle, float[] encodedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * <p>Reads {@code count} packed positions from {@code packedBatch} and writes
+     * the same outputs as {@link #nativePredictBatch}.
+     *
+     * @param handle native handle
+     * @param packedBatch packed input planes for all positions, back to back
+     * @param count number of positions
+     * @param outPolicy array to receive policy logits
+     * @param outWdl array to receive WDL probabilities
+     * @param outValue array to receive scalar {@code W-L} values
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePredictPacked(long handle, long[] packedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param handle native handle
+     * @return {@code {input, policy, wdl}} direct buffers over pinned memory, or {@code null} on failure
+     */
+    private static native ByteBuffer[] nativePinnedBuffers(long handle);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param handle native handle
+     * @param count number of positions at the start of the pinned input buffer
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePredictPinned(long handle, int count);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param handle native handle
+     * @param maxBatch largest coalesced batch, or zero for the handle's limit
+     * @param deadlineMicros longest wait for a partial batch, negative for the default
+     * @return native queue handle, or zero on failure
+     */
+    private static native long nativeQueueCreate(long handle, int maxBatch, long deadlineMicros);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param queue native queue handle
+     * @param encodedPlanes OTIS input planes
+     * @return positive ticket, or zero if the queue is closed
+     */
+    private static native long nativeQueueSubmit(long queue, float[] encodedPlanes);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * <p>Blocks until one queued result is ready.
+     *
+     * @param queue native queue handle
+     * @param outPolicy array to receive policy logits
+     * @param outWdl array to receive WDL probabilities
+     * @return ticket, negated ticket on failure, or zero once closed and drained
+     */
+    private static native long nativeQueueTake(long queue, float[] outPolicy, float[] outWdl);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param queue native queue handle
+     */
+    private static native void nativeQueueClose(long queue);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param queue native queue handle
+     */
+    private static native void nativeQueueDestroy(long queue);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param weightsPath absolute path to the OTIS weights file
+     * @param device CUDA device ordinal
+     * @return native handle or zero on failure
+     */
+    private static native long nativeCreateOnDevice(String weightsPath, int device);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param weightsPath absolute path to the OTIS weights file
+     * @param devices distinct CUDA device ordinals, one replica each
+     * @return native pool handle or zero on failure
+     */
+    private static native long nativePoolCreate(String weightsPath, int[] devices);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param pool native pool handle
+     */
+    private static native void nativePoolDestroy(long pool);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param pool native pool handle
+     * @return model name of the pool's weights
+     */
+    private static native String nativePoolGetName(long pool);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param pool native pool handle
+     * @return metadata of the pool's weights, in the {@link #nativeGetInfo(long)} layout
+     */
+    private static native long[] nativePoolGetInfo(long pool);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param pool native pool handle
+     * @param encodedBatch encoded planes, {@code count} positions back to back
+     * @param count number of positions
+     * @param outPolicy policy logits, {@code count * policySize} floats
+     * @param outWdl WDL probabilities, {@code count * 3} floats
+     * @param outValue {@code W-L} values, {@code count} floats
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePoolPredictBatch(long pool, float[] encodedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param pool native pool handle
+     * @param packedBatch packed planes, {@code count} positions back to back
+     * @param count number of positions
+     * @param outPolicy policy logits, {@code count * policySize} floats
+     * @param outWdl WDL probabilities, {@code count * 3} floats
+     * @param outValue {@code W-L} values, {@code count} floats
+     * @return number of positions evaluated, or zero on failure
+     */
+    private static native int nativePoolPredictPacked(long pool, long[] packedBatch, int count, float[] outPolicy,
+            float[] outWdl, float[] outValue);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param pool native pool handle
+     * @return {@code [device, calls, positions]} per replica, or {@code null} on failure
+     */
+    private static native long[] nativePoolStats(long pool);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param handle native handle
+     * @return comma-separated stage names in {@link #nativeGetStats(long, boolean)} order
+     */
+    private static native String nativeGetStatNames(long handle);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/otis_cuda_jni.cu}.
+     *
+     * @param handle native handle
+     * @param reset whether to zero the totals after reading them
+     * @return {@code [enabled, then per stage: calls, bytes, deviceNanos, hostNanos]}, or {@code null} on failure
+     */
+    private static native long[] nativeGetStats(long handle, boolean reset);
 }
@@ -2,6 +2,7 @@ package chess.nn.otis.oneapi;
 
 import java.nio.file.Path;
 
+import chess.gpu.NativeOps;
 import chess.nn.otis.Model;
 import chess.nn.otis.NativeBackendOps;
 
@@ -68,7 +69,7 @@ public final class Backend implements AutoCloseable {
      * @throws IllegalStateException if initialization fails
      */
     public static Backend create(Path weightsBin) {
-        NativeBackendOps.Created created = NativeBackendOps.create(
+        NativeOps.Created<Model.Info> created = NativeBackendOps.create(
                 weightsBin,
                 Backend::nativeCreate,
                 Backend::nativeGetInfo,
@@ -103,7 +104,7 @@ public final class Backend implements AutoCloseable {
      */
     @Override
     public void close() {
-        NativeBackendOps.destroy(handle, Backend::nativeDestroy);
+        NativeOps.destroy(handle, Backend::nativeDestroy);
     }
 
     /**
@@ -53,6 +53,133 @@ public final class Backend {
         return nativeBulkPerftDetailed(packed, count, remainingDepth);
     }
 
+    /**
+     * Creates a persistent native perft session.
+     *
+     * <p>
+     * A session keeps the attack tables resident on the device and reuses two
+     * chunk-sized sets of pinned host and device buffers across calls, so
+     * repeated bulk calls skip per-call allocation and overlap the upload of one
+     * chunk with the kernel for the previous one. A session serves one call at a
+     * time and must be released with {@link #destroySession(long)}.
+     * </p>
+     *
+     * @param capacity frontier positions per device chunk
+     * @return native session handle, or {@code 0} on failure
+     */
+    public static long createSession(int capacity) {
+        return nativeCreateSession(capacity);
+    }
+
+    /**
+     * Counts {@code perft(remainingDepth)} for each packed frontier position
+     * through a session created by {@link #createSession(int)}.
+     *
+     * @param session native session handle
+     * @param packed packed positions, {@code count * PositionCodec.WORDS} longs
+     * @param count number of frontier positions (any size; chunked natively)
+     * @param remainingDepth non-negative depth below each frontier position
+     * @return per-position leaf-node counts, or {@code null} on native failure
+     */
+    public static long[] sessionBulkPerft(long session, long[] packed, int count, int remainingDepth) {
+        return nativeSessionBulkPerft(session, packed, count, remainingDepth);
+    }
+
+    /**
+     * Counts detailed perft (7 counters) for each packed frontier position
+     * through a session created by {@link #createSession(int)}.
+     *
+     * @param session native session handle
+     * @param packed packed positions, {@code count * PositionCodec.WORDS} longs
+     * @param count number of frontier positions (any size; chunked natively)
+     * @param remainingDepth non-negative depth below each frontier position
+     * @return {@code count * 7} counters, or {@code null} on native failure
+     */
+    public static long[] sessionBulkPerftDetailed(long session, long[] packed, int count, int remainingDepth) {
+        return nativeSessionBulkPerftDetailed(session, packed, count, remainingDepth);
+    }
+
+    /**
+     * Counts {@code perft(depth)} below one packed root through a session,
+     * expanding the first {@code splitDepth} plies natively.
+     *
+     * <p>
+     * Frontier positions that transpositions reach more than once are folded
+     * into one entry with a multiplicity, so each unique position is counted
+     * once and its count weighted. The split is clamped to
+     * {@code [0, depth - 1]}.
+     * </p>
+     *
+     * @param session native session handle
+     * @param root packed root position, {@code PositionCodec.WORDS} longs
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return {@code {nodes, frontier positions, unique positions}}, or
+     *         {@code null} on native failure
+     */
+    public static long[] sessionFoldedPerft(long session, long[] root, int depth, int splitDepth) {
+        return nativeSessionFoldedPerft(session, root, depth, splitDepth);
+    }
+
+    /**
+     * Counts detailed perft (7 counters) below one packed root through a
+     * session, folding duplicate frontier positions like
+     * {@link #sessionFoldedPerft(long, long[], int, int)}.
+     *
+     * @param session native session handle
+     * @param root packed root position, {@code PositionCodec.WORDS} longs
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return the 7 counters followed by frontier and unique position counts,
+     *         or {@code null} on native failure
+     */
+    public static long[] sessionFoldedPerftDetailed(long session, long[] root, int depth, int splitDepth) {
+        return nativeSessionFoldedPerftDetailed(session, root, depth, splitDepth);
+    }
+
+    /**
+     * Returns the per-device node totals of the session's last bulk call.
+     *
+     * <p>
+     * A session spreads each frontier across every visible device, with devices
+     * claiming chunks dynamically; these totals show how the work was balanced.
+     * </p>
+     *
+     * @param session native session handle
+     * @return one node total per device, or {@code null} on native failure
+     */
+    public static long[] sessionDeviceNodes(long session) {
+        return nativeSessionDeviceNodes(session);
+    }
+
+    /**
+     * Returns the transposition-table statistics of the session's last bulk call.
+     *
+     * <p>
+     * Setting {@code CRTK_PERFT_CUDA_TT_MB} (MiB) before the session is created gives every
+     * device a Zobrist-keyed table shared by all threads of its node-count
+     * launches; detailed calls bypass it.
+     * </p>
+     *
+     * @param session native session handle
+     * @return {@code {probes, hits, stores, slots}} summed over devices (all
+     *         zero without a table), or {@code null} on native failure
+     */
+    public static long[] sessionTableStats(long session) {
+        return nativeSessionTableStats(session);
+    }
+
+    /**
+     * Releases a session created by {@link #createSession(int)}.
+     *
+     * @param session native session handle; {@code 0} is ignored
+     */
+    public static void destroySession(long session) {
+        if (session != 0L) {
+            nativeDestroySession(session);
+        }
+    }
+
     /**
      * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
      *
@@ -72,4 +199,81 @@ public final class Backend {
      * @return per-position detailed counters ({@code count * 7})
      */
     private static native long[] nativeBulkPerftDetailed(long[] packed, int count, int remainingDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param capacity frontier positions per device chunk
+     * @return native session handle, or {@code 0} on failure
+     */
+    private static native long nativeCreateSession(int capacity);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param session native session handle
+     * @param packed packed frontier positions
+     * @param count number of frontier positions
+     * @param remainingDepth depth below each frontier position
+     * @return per-position leaf-node counts
+     */
+    private static native long[] nativeSessionBulkPerft(long session, long[] packed, int count, int remainingDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param session native session handle
+     * @param packed packed frontier positions
+     * @param count number of frontier positions
+     * @param remainingDepth depth below each frontier position
+     * @return per-position detailed counters ({@code count * 7})
+     */
+    private static native long[] nativeSessionBulkPerftDetailed(
+            long session, long[] packed, int count, int remainingDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param session native session handle
+     * @param root packed root position
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return node count followed by frontier and unique position counts
+     */
+    private static native long[] nativeSessionFoldedPerft(long session, long[] root, int depth, int splitDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param session native session handle
+     * @param root packed root position
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return detailed counters followed by frontier and unique position counts
+     */
+    private static native long[] nativeSessionFoldedPerftDetailed(
+            long session, long[] root, int depth, int splitDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param session native session handle
+     * @return per-device node totals of the last call
+     */
+    private static native long[] nativeSessionDeviceNodes(long session);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param session native session handle
+     * @return table probes, hits, stores and slots of the last call
+     */
+    private static native long[] nativeSessionTableStats(long session);
+
+    /**
+     * JNI entry point implemented in {@code native/cuda/perft_cuda_jni.cu}.
+     *
+     * @param session native session handle
+     */
+    private static native void nativeDestroySession(long session);
 }
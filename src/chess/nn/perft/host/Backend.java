@@ -0,0 +1,254 @@
+package chess.nn.perft.host;
+
+/**
+ * Optional multi-threaded CPU backend (JNI) for split-depth bulk perft.
+ *
+ * <p>
+ * Each call computes {@code perft(remainingDepth)} for a batch of frontier
+ * positions packed by {@code chess.debug.gpu.PositionCodec}, spread over a
+ * work-stealing pool of native threads. Small frontiers are split further by
+ * root move, so even a single position keeps every core busy. The library is
+ * loaded lazily by {@link Support}; callers must check {@link #isAvailable()}
+ * before invoking {@link #bulkPerft(long[], int, int)}.
+ * </p>
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class Backend {
+
+    /**
+     * Utility class; prevents instantiation.
+     */
+    private Backend() {
+    }
+
+    /**
+     * @return {@code true} when the host perft backend is loaded
+     */
+    public static boolean isAvailable() {
+        return Support.isAvailable();
+    }
+
+    /**
+     * Counts {@code perft(remainingDepth)} for each packed frontier position.
+     *
+     * @param packed packed positions, {@code count * PositionCodec.WORDS} longs
+     * @param count number of frontier positions
+     * @param remainingDepth non-negative depth below each frontier position
+     * @return per-position leaf-node counts, or {@code null} on native failure
+     */
+    public static long[] bulkPerft(long[] packed, int count, int remainingDepth) {
+        return nativeBulkPerft(packed, count, remainingDepth);
+    }
+
+    /**
+     * Counts detailed perft (7 counters) for each packed frontier position.
+     *
+     * @param packed packed positions, {@code count * PositionCodec.WORDS} longs
+     * @param count number of frontier positions
+     * @param remainingDepth non-negative depth below each frontier position
+     * @return {@code count * 7} counters per position, or {@code null} on failure
+     */
+    public static long[] bulkPerftDetailed(long[] packed, int count, int remainingDepth) {
+        return nativeBulkPerftDetailed(packed, count, remainingDepth);
+    }
+
+    /**
+     * Creates a persistent native perft session.
+     *
+     * <p>
+     * The host has no device buffers to keep: a session fixes the worker count
+     * and records per-worker node totals, matching the GPU session API. A
+     * session serves one call at a time and must be released with
+     * {@link #destroySession(long)}.
+     * </p>
+     *
+     * @param capacity ignored; the frontier is not chunked on the host
+     * @return native session handle, or {@code 0} on failure
+     */
+    public static long createSession(int capacity) {
+        return nativeCreateSession(capacity);
+    }
+
+    /**
+     * Counts {@code perft(remainingDepth)} for each packed frontier position
+     * through a session created by {@link #createSession(int)}.
+     *
+     * @param session native session handle
+     * @param packed packed positions, {@code count * PositionCodec.WORDS} longs
+     * @param count number of frontier positions
+     * @param remainingDepth non-negative depth below each frontier position
+     * @return per-position leaf-node counts, or {@code null} on native failure
+     */
+    public static long[] sessionBulkPerft(long session, long[] packed, int count, int remainingDepth) {
+        return nativeSessionBulkPerft(session, packed, count, remainingDepth);
+    }
+
+    /**
+     * Counts detailed perft (7 counters) for each packed frontier position
+     * through a session created by {@link #createSession(int)}.
+     *
+     * @param session native session handle
+     * @param packed packed positions, {@code count * PositionCodec.WORDS} longs
+     * @param count number of frontier positions
+     * @param remainingDepth non-negative depth below each frontier position
+     * @return {@code count * 7} counters, or {@code null} on native failure
+     */
+    public static long[] sessionBulkPerftDetailed(long session, long[] packed, int count, int remainingDepth) {
+        return nativeSessionBulkPerftDetailed(session, packed, count, remainingDepth);
+    }
+
+    /**
+     * Counts {@code perft(depth)} below one packed root through a session,
+     * expanding the first {@code splitDepth} plies natively.
+     *
+     * <p>
+     * Frontier positions that transpositions reach more than once are folded
+     * into one entry with a multiplicity, so each unique position is counted
+     * once and its count weighted. The split is clamped to
+     * {@code [0, depth - 1]}.
+     * </p>
+     *
+     * @param session native session handle
+     * @param root packed root position, {@code PositionCodec.WORDS} longs
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return {@code {nodes, frontier positions, unique positions}}, or
+     *         {@code null} on native failure
+     */
+    public static long[] sessionFoldedPerft(long session, long[] root, int depth, int splitDepth) {
+        return nativeSessionFoldedPerft(session, root, depth, splitDepth);
+    }
+
+    /**
+     * Counts detailed perft (7 counters) below one packed root through a
+     * session, folding duplicate frontier positions like
+     * {@link #sessionFoldedPerft(long, long[], int, int)}.
+     *
+     * @param session native session handle
+     * @param root packed root position, {@code PositionCodec.WORDS} longs
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return the 7 counters followed by frontier and unique position counts,
+     *         or {@code null} on native failure
+     */
+    public static long[] sessionFoldedPerftDetailed(long session, long[] root, int depth, int splitDepth) {
+        return nativeSessionFoldedPerftDetailed(session, root, depth, splitDepth);
+    }
+
+    /**
+     * Returns the per-worker node totals of the session's last bulk call.
+     *
+     * <p>
+     * Workers steal tasks from each other once their own share runs out; these
+     * totals show how the work was balanced.
+     * </p>
+     *
+     * @param session native session handle
+     * @return one node total per worker thread, or {@code null} on native failure
+     */
+    public static long[] sessionDeviceNodes(long session) {
+        return nativeSessionDeviceNodes(session);
+    }
+
+    /**
+     * Releases a session created by {@link #createSession(int)}.
+     *
+     * @param session native session handle; {@code 0} is ignored
+     */
+    public static void destroySession(long session) {
+        if (session != 0L) {
+            nativeDestroySession(session);
+        }
+    }
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param packed packed frontier positions
+     * @param count number of frontier positions
+     * @param remainingDepth depth below each frontier position
+     * @return per-position leaf-node counts
+     */
+    private static native long[] nativeBulkPerft(long[] packed, int count, int remainingDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param packed packed frontier positions
+     * @param count number of frontier positions
+     * @param remainingDepth depth below each frontier position
+     * @return per-position detailed counters ({@code count * 7})
+     */
+    private static native long[] nativeBulkPerftDetailed(long[] packed, int count, int remainingDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param capacity ignored
+     * @return native session handle, or {@code 0} on failure
+     */
+    private static native long nativeCreateSession(int capacity);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param session native session handle
+     * @param packed packed frontier positions
+     * @param count number of frontier positions
+     * @param remainingDepth depth below each frontier position
+     * @return per-position leaf-node counts
+     */
+    private static native long[] nativeSessionBulkPerft(long session, long[] packed, int count, int remainingDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param session native session handle
+     * @param packed packed frontier positions
+     * @param count number of frontier positions
+     * @param remainingDepth depth below each frontier position
+     * @return per-position detailed counters ({@code count * 7})
+     */
+    private static native long[] nativeSessionBulkPerftDetailed(
+            long session, long[] packed, int count, int remainingDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param session native session handle
+     * @param root packed root position
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return node count followed by frontier and unique position counts
+     */
+    private static native long[] nativeSessionFoldedPerft(long session, long[] root, int depth, int splitDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param session native session handle
+     * @param root packed root position
+     * @param depth total perft depth
+     * @param splitDepth plies expanded before counting
+     * @return detailed counters followed by frontier and unique position counts
+     */
+    private static native long[] nativeSessionFoldedPerftDetailed(
+            long session, long[] root, int depth, int splitDepth);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param session native session handle
+     * @return per-worker node totals of the last call
+     */
+    private static native long[] nativeSessionDeviceNodes(long session);
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @param session native session handle
+     */
+    private static native void nativeDestroySession(long session);
+}
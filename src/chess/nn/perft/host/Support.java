@@ -0,0 +1,77 @@
+package chess.nn.perft.host;
+
+import chess.gpu.SharedLibrarySupport;
+
+/**
+ * Optional multi-threaded CPU support for native bulk perft via a tiny JNI
+ * shared library.
+ *
+ * <p>
+ * Loads {@code libperft_host.so} and exposes capability checks; callers fall
+ * back to the pure-Java perft path when the library is absent. The library
+ * needs no GPU, so it serves CPU-only machines. Point
+ * {@code CRTK_PERFT_HOST_LIB} at an explicit library file to override
+ * discovery.
+ * </p>
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class Support {
+
+    /**
+     * Base library name used by {@link System#loadLibrary(String)}.
+     */
+    private static final String LIB_BASE_NAME = "perft_host";
+
+    /**
+     * Environment variable pointing to an explicit host perft library path.
+     */
+    private static final String ENV_PERFT_HOST_LIB = "CRTK_PERFT_HOST_LIB";
+
+    /**
+     * Repository directory containing the optional host JNI sources/build outputs.
+     */
+    private static final String DIR_NATIVE_HOST = "native/host";
+
+    /**
+     * Shared JNI load state.
+     */
+    private static final SharedLibrarySupport.State STATE =
+            SharedLibrarySupport.load(LIB_BASE_NAME, ENV_PERFT_HOST_LIB, DIR_NATIVE_HOST, Support::nativeDeviceCount);
+
+    /**
+     * Utility class; prevents instantiation.
+     */
+    private Support() {
+    }
+
+    /**
+     * @return {@code true} if the JNI library loaded
+     */
+    public static boolean isAvailable() {
+        return STATE.deviceCount() > 0;
+    }
+
+    /**
+     * @return {@code true} if the native library loaded
+     */
+    public static boolean isLoaded() {
+        return STATE.loaded();
+    }
+
+    /**
+     * @return number of native worker threads (0 when unavailable)
+     */
+    public static int deviceCount() {
+        return STATE.deviceCount();
+    }
+
+    /**
+     * JNI entry point implemented in {@code native/host/perft_host_jni.cpp}.
+     *
+     * @return number of worker threads ({@code CRTK_PERFT_HOST_THREADS}, default
+     *         every hardware thread)
+     */
+    private static native int nativeDeviceCount();
+}
@@ -1,5 +1,6 @@
 package chess.nn.t5;
 
+import java.util.Arrays;
 import java.util.function.BooleanSupplier;
 import java.util.function.LongConsumer;
 
@@ -46,6 +47,23 @@ public final class NativeBackendOps {
     int[] generate(long handle, int[] inputIds, int maxNewTokens);
   }
 
+  /**
+   * Functional interface for native batched id generation over flattened prompts.
+   */
+  @FunctionalInterface
+  public interface BatchIdGenerator {
+    /**
+     * Generates token ids for several prompts using the native backend.
+     *
+     * @param handle native backend handle
+     * @param ids all encoder input ids back to back
+     * @param offsets prompt {@code i} is {@code ids[offsets[i] .. offsets[i + 1])}
+     * @param maxNewTokens maximum new tokens to generate per prompt
+     * @return the output lengths followed by the outputs back to back, or {@code null} on failure
+     */
+    int[] generate(long handle, int[] ids, int[] offsets, int maxNewTokens);
+  }
+
   /**
    * Runs the common T5 backend creation checks and returns a handle.
    *
@@ -80,6 +98,49 @@ public final class NativeBackendOps {
     return generator.generate(handle, inputIds, maxNewTokens);
   }
 
+  /**
+   * Runs a native batched generation call: flattens the prompts for the JNI
+   * boundary and splits the packed result back into one array per prompt.
+   *
+   * @param handle native backend handle
+   * @param inputIds encoder input ids, one array per prompt
+   * @param maxNewTokens maximum new tokens to generate per prompt
+   * @param generator native batch generator
+   * @return generated ids per prompt, or {@code null} on invalid input / backend failure
+   */
+  public static int[][] generateIdsBatch(long handle, int[][] inputIds, int maxNewTokens,
+      BatchIdGenerator generator) {
+    if (inputIds == null) {
+      return null;
+    }
+    int[] offsets = new int[inputIds.length + 1];
+    for (int i = 0; i < inputIds.length; i++) {
+      if (inputIds[i] == null) {
+        return null;
+      }
+      offsets[i + 1] = offsets[i] + inputIds[i].length;
+    }
+    int[] ids = new int[offsets[inputIds.length]];
+    for (int i = 0; i < inputIds.length; i++) {
+      System.arraycopy(inputIds[i], 0, ids, offsets[i], inputIds[i].length);
+    }
+    int[] packed = generator.generate(handle, ids, offsets, maxNewTokens);
+    if (packed == null || packed.length < inputIds.length) {
+      return null;
+    }
+    int[][] out = new int[inputIds.length][];
+    int pos = inputIds.length;
+    for (int i = 0; i < inputIds.length; i++) {
+      int len = packed[i];
+      if (len < 0 || pos + len > packed.length) {
+        return null;
+      }
+      out[i] = Arrays.copyOfRange(packed, pos, pos + len);
+      pos += len;
+    }
+    return out;
+  }
+
   /**
    * Releases a native handle through the provided destroy function.
    *
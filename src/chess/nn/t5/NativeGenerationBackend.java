@@ -17,6 +17,23 @@ public interface NativeGenerationBackend extends AutoCloseable {
    */
   int[] generateIds(int[] inputIds, int maxNewTokens);
 
+  /**
+   * Runs greedy decoding for several prompts. Backends without a native batch
+   * path decode them one at a time.
+   *
+   * @param inputIds encoder input ids, one array per prompt
+   * @param maxNewTokens maximum new tokens to generate per prompt
+   * @return generated token ids per prompt (an entry is empty when that prompt failed),
+   *         or {@code null} when the whole batch failed
+   */
+  default int[][] generateIdsBatch(int[][] inputIds, int maxNewTokens) {
+    int[][] out = new int[inputIds.length][];
+    for (int i = 0; i < inputIds.length; i++) {
+      out[i] = generateIds(inputIds[i], maxNewTokens);
+    }
+    return out;
+  }
+
   /**
    * Releases any native resources held by the backend.
    */
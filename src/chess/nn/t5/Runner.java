@@ -87,6 +87,74 @@ public final class Runner implements AutoCloseable {
     return generateCpu(prompt, maxNewTokens);
   }
 
+  /**
+   * Generates text for several prompts using greedy decoding. The prompts go to
+   * the first native backend that accepts the batch in one call; any prompt it
+   * could not decode falls back to the CPU path on its own.
+   *
+   * @param prompts input prompts
+   * @param maxNewTokens maximum generated tokens per prompt
+   * @return decoded output text per prompt, in input order
+   */
+  public List<String> generateBatch(List<String> prompts, int maxNewTokens) {
+    int[][] inputs = new int[prompts.size()][];
+    for (int i = 0; i < inputs.length; i++) {
+      List<Integer> ids = model.tokenizer.encode(prompts.get(i));
+      ensureEncoderEos(ids);
+      inputs[i] = toIntArray(ids);
+    }
+    int[][] outputs = generateIdsBatchWithBackends(inputs, maxNewTokens);
+    List<String> out = new ArrayList<>(inputs.length);
+    for (int i = 0; i < inputs.length; i++) {
+      int[] ids = outputs == null ? null : outputs[i];
+      if (ids == null || ids.length == 0) {
+        out.add(generateCpu(prompts.get(i), maxNewTokens));
+      } else {
+        out.add(model.tokenizer.decode(toList(ids, 1)));
+      }
+    }
+    return out;
+  }
+
+  /**
+   * Tries all configured native backends for batched id generation.
+   *
+   * @param inputs encoder input ids per prompt
+   * @param maxNewTokens maximum generated token count per prompt
+   * @return generated ids per prompt, or {@code null} when all backends fall back
+   */
+  private int[][] generateIdsBatchWithBackends(int[][] inputs, int maxNewTokens) {
+    int[][] output = tryGenerateIdsBatch(cudaBackend, inputs, maxNewTokens);
+    if (output != null) {
+      return output;
+    }
+    output = tryGenerateIdsBatch(rocmBackend, inputs, maxNewTokens);
+    if (output != null) {
+      return output;
+    }
+    return tryGenerateIdsBatch(oneapiBackend, inputs, maxNewTokens);
+  }
+
+  /**
+   * Attempts batched id generation through a native backend and falls back on any backend error.
+   *
+   * @param backend backend to invoke
+   * @param inputs encoder input ids per prompt
+   * @param maxNewTokens maximum generated token count per prompt
+   * @return generated ids per prompt, or {@code null} when unavailable or failing
+   */
+  private static int[][] tryGenerateIdsBatch(NativeGenerationBackend backend, int[][] inputs, int maxNewTokens) {
+    if (backend == null) {
+      return null;
+    }
+    try {
+      int[][] output = backend.generateIdsBatch(inputs, maxNewTokens);
+      return output != null && output.length == inputs.length ? output : null;
+    } catch (UnsatisfiedLinkError | RuntimeException ignore) {
+      return null;
+    }
+  }
+
   /**
    * Tries all configured native backends in priority order.
    *
@@ -1,5 +1,6 @@
 package chess.nn.t5.cuda;
 
+import chess.gpu.StageStats;
 import chess.nn.t5.Model;
 import chess.nn.t5.NativeBackendOps;
 import chess.nn.t5.NativeGenerationBackend;
@@ -7,8 +8,11 @@ import chess.nn.t5.NativeGenerationBackend;
 /**
  * Optional CUDA backend for end-to-end T5 inference.
  *
- * <p>This loads the native {@code t5_cuda} library and runs greedy decoding on the GPU.
- * If initialization fails, callers should fall back to the CPU path.
+ * <p>This loads the native {@code t5_cuda} library and runs decoding on the GPU.
+ * If initialization fails, callers should fall back to the CPU path. Single prompts
+ * decode greedily unless the {@code CRTK_T5_CUDA_BEAMS} or sampling environment
+ * variables select beam search or top-k/top-p sampling. Batches decode all live
+ * prompts greedily together against a paged decoder cache that persists with the handle.
  *
  * @since 2026
  * @author Lennart A. Conrad
@@ -43,7 +47,26 @@ public final class Backend implements NativeGenerationBackend {
   }
 
   /**
-   * Runs greedy decoding and returns generated token ids (including decoder start).
+   * Attempts to create a CUDA backend for the given model on one device.
+   *
+   * <p>{@link #tryCreate(Model)} is this method with device {@code 0}.
+   *
+   * @param model loaded T5 model (must have a source path)
+   * @param device CUDA device ordinal
+   * @return backend instance or {@code null} if unavailable or the ordinal is out of range
+   */
+  public static Backend tryCreate(Model model, int device) {
+    long handle = NativeBackendOps.tryCreateHandle(model, Support::isAvailable,
+        path -> nativeCreateOnDevice(path, device));
+    if (handle == 0L) {
+      return null;
+    }
+    return new Backend(handle);
+  }
+
+  /**
+   * Runs greedy, beam or sampled decoding (per the native decode options) and returns
+   * generated token ids (including decoder start).
    *
    * @param inputIds encoder input ids
    * @param maxNewTokens maximum new tokens to generate
@@ -53,6 +76,32 @@ public final class Backend implements NativeGenerationBackend {
     return NativeBackendOps.generateIds(handle, inputIds, maxNewTokens, Backend::nativeGenerateIds);
   }
 
+  /**
+   * Runs greedy decoding for several prompts in one native call.
+   *
+   * @param inputIds encoder input ids, one array per prompt
+   * @param maxNewTokens maximum new tokens to generate per prompt
+   * @return generated token ids per prompt, or {@code null} if the backend failed
+   */
+  @Override
+  public int[][] generateIdsBatch(int[][] inputIds, int maxNewTokens) {
+    return NativeBackendOps.generateIdsBatch(handle, inputIds, maxNewTokens, Backend::nativeGenerateIdsBatch);
+  }
+
+  /**
+   * Returns this handle's per-stage timing and counters.
+   *
+   * <p>Counting is on only when {@code CRTK_T5_CUDA_STATS=1} was set when the
+   * handle was created; otherwise the snapshot reports {@link StageStats#enabled()}
+   * {@code false}.
+   *
+   * @param reset whether to zero the native totals after reading them
+   * @return stage totals since the handle was created or last reset
+   */
+  public StageStats stats(boolean reset) {
+    return StageStats.read(handle, Backend::nativeGetStatNames, Backend::nativeGetStats, reset);
+  }
+
   /**
    * Releases native resources.
    */
@@ -69,6 +118,15 @@ public final class Backend implements NativeGenerationBackend {
    */
   private static native long nativeCreate(String weightsPath);
 
+  /**
+   * JNI entry point implemented in {@code native/cuda/t5_cuda_jni.cu}.
+   *
+   * @param weightsPath absolute path to the T5 weights file
+   * @param device CUDA device ordinal
+   * @return native handle or zero on failure
+   */
+  private static native long nativeCreateOnDevice(String weightsPath, int device);
+
   /**
    * JNI entry point implemented in {@code native/cuda/t5_cuda_jni.cu}.
    *
@@ -85,4 +143,32 @@ public final class Backend implements NativeGenerationBackend {
    * @return generated token ids, or {@code null} on failure
    */
   private static native int[] nativeGenerateIds(long handle, int[] inputIds, int maxNewTokens);
+
+  /**
+   * JNI entry point implemented in {@code native/cuda/t5_cuda_jni.cu}.
+   *
+   * @param handle native handle
+   * @param ids all encoder input ids back to back
+   * @param offsets prompt boundaries into {@code ids} (prompt count + 1 entries)
+   * @param maxNewTokens maximum new tokens to generate per prompt
+   * @return output lengths followed by the outputs, or {@code null} on failure
+   */
+  private static native int[] nativeGenerateIdsBatch(long handle, int[] ids, int[] offsets, int maxNewTokens);
+
+  /**
+   * JNI entry point implemented in {@code native/cuda/t5_cuda_jni.cu}.
+   *
+   * @param handle native handle
+   * @return comma-separated stage names in {@link #nativeGetStats(long, boolean)} order
+   */
+  private static native String nativeGetStatNames(long handle);
+
+  /**
+   * JNI entry point implemented in {@code native/cuda/t5_cuda_jni.cu}.
+   *
+   * @param handle native handle
+   * @param reset whether to zero the totals after reading them
+   * @return {@code [enabled, then per stage: calls, bytes, deviceNanos, hostNanos]}, or {@code null} on failure
+   */
+  private static native long[] nativeGetStats(long handle, boolean reset);
 }
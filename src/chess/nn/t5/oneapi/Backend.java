@@ -7,8 +7,10 @@ import chess.nn.t5.NativeGenerationBackend;
 /**
  * Optional oneAPI backend for end-to-end T5 inference.
  *
- * <p>This loads the native {@code t5_oneapi} library and runs greedy decoding on the GPU.
- * If initialization fails, callers should fall back to the CPU path.
+ * <p>This loads the native {@code t5_oneapi} library and runs greedy decoding on the GPU
+ * with the weights resident on the device and a per-prompt decoder cache. Batches
+ * encode and decode all prompts together in one native call. If initialization fails,
+ * callers should fall back to the CPU path.
  *
  * @since 2026
  * @author Lennart A. Conrad
@@ -53,6 +55,18 @@ public final class Backend implements NativeGenerationBackend {
     return NativeBackendOps.generateIds(handle, inputIds, maxNewTokens, Backend::nativeGenerateIds);
   }
 
+  /**
+   * Runs greedy decoding for several prompts in one native call.
+   *
+   * @param inputIds encoder input ids, one array per prompt
+   * @param maxNewTokens maximum new tokens to generate per prompt
+   * @return generated token ids per prompt, or {@code null} if the backend failed
+   */
+  @Override
+  public int[][] generateIdsBatch(int[][] inputIds, int maxNewTokens) {
+    return NativeBackendOps.generateIdsBatch(handle, inputIds, maxNewTokens, Backend::nativeGenerateIdsBatch);
+  }
+
   /**
    * Releases native resources.
    */
@@ -85,4 +99,15 @@ public final class Backend implements NativeGenerationBackend {
    * @return generated token ids, or {@code null} on failure
    */
   private static native int[] nativeGenerateIds(long handle, int[] inputIds, int maxNewTokens);
+
+  /**
+   * JNI entry point implemented in {@code native/oneapi/t5_oneapi_jni.cpp}.
+   *
+   * @param handle native handle
+   * @param ids all encoder input ids back to back
+   * @param offsets prompt boundaries into {@code ids} (prompt count + 1 entries)
+   * @param maxNewTokens maximum new tokens to generate per prompt
+   * @return output lengths followed by the outputs, or {@code null} on failure
+   */
+  private static native int[] nativeGenerateIdsBatch(long handle, int[] ids, int[] offsets, int maxNewTokens);
 }
@@ -1,5 +1,6 @@
 package chess.nn.t5.rocm;
 
+import chess.gpu.StageStats;
 import chess.nn.t5.Model;
 import chess.nn.t5.NativeBackendOps;
 import chess.nn.t5.NativeGenerationBackend;
@@ -42,6 +43,24 @@ public final class Backend implements NativeGenerationBackend {
     return new Backend(handle);
   }
 
+  /**
+   * Attempts to create a ROCm backend for the given model on one device.
+   *
+   * <p>{@link #tryCreate(Model)} is this method with device {@code 0}.
+   *
+   * @param model loaded T5 model (must have a source path)
+   * @param device ROCm device ordinal
+   * @return backend instance or {@code null} if unavailable or the ordinal is out of range
+   */
+  public static Backend tryCreate(Model model, int device) {
+    long handle = NativeBackendOps.tryCreateHandle(model, Support::isAvailable,
+        path -> nativeCreateOnDevice(path, device));
+    if (handle == 0L) {
+      return null;
+    }
+    return new Backend(handle);
+  }
+
   /**
    * Runs greedy decoding and returns generated token ids (including decoder start).
    *
@@ -53,6 +72,20 @@ public final class Backend implements NativeGenerationBackend {
     return NativeBackendOps.generateIds(handle, inputIds, maxNewTokens, Backend::nativeGenerateIds);
   }
 
+  /**
+   * Returns this handle's per-stage timing and counters.
+   *
+   * <p>Counting is on only when {@code CRTK_T5_ROCM_STATS=1} was set when the
+   * handle was created; otherwise the snapshot reports {@link StageStats#enabled()}
+   * {@code false}.
+   *
+   * @param reset whether to zero the native totals after reading them
+   * @return stage totals since the handle was created or last reset
+   */
+  public StageStats stats(boolean reset) {
+    return StageStats.read(handle, Backend::nativeGetStatNames, Backend::nativeGetStats, reset);
+  }
+
   /**
    * Releases native resources.
    */
@@ -69,6 +102,15 @@ public final class Backend implements NativeGenerationBackend {
    */
   private static native long nativeCreate(String weightsPath);
 
+  /**
+   * JNI entry point implemented in {@code native/rocm/t5_rocm_jni.hip}.
+   *
+   * @param weightsPath absolute path to the T5 weights file
+   * @param device ROCm device ordinal
+   * @return native handle or zero on failure
+   */
+  private static native long nativeCreateOnDevice(String weightsPath, int device);
+
   /**
    * JNI entry point implemented in {@code native/rocm/t5_rocm_jni.hip}.
    *
@@ -85,4 +127,21 @@ public final class Backend implements NativeGenerationBackend {
    * @return generated token ids, or {@code null} on failure
    */
   private static native int[] nativeGenerateIds(long handle, int[] inputIds, int maxNewTokens);
+
+  /**
+   * JNI entry point implemented in {@code native/rocm/t5_rocm_jni.hip}.
+   *
+   * @param handle native handle
+   * @return comma-separated stage names in {@link #nativeGetStats(long, boolean)} order
+   */
+  private static native String nativeGetStatNames(long handle);
+
+  /**
+   * JNI entry point implemented in {@code native/rocm/t5_rocm_jni.hip}.
+   *
+   * @param handle native handle
+   * @param reset whether to zero the totals after reading them
+   * @return {@code [enabled, then per stage: calls, bytes, deviceNanos, hostNanos]}, or {@code null} on failure
+   */
+  private static native long[] nativeGetStats(long handle, boolean reset);
 }
@@ -9,10 +9,13 @@ import java.nio.charset.StandardCharsets;
 import java.nio.file.Files;
 import java.nio.file.Path;
 import java.util.List;
+import java.util.Locale;
 
 import chess.core.Move;
 import chess.core.Position;
 import chess.gpu.BackendNames;
+import chess.gpu.PackedPlanes;
+import chess.gpu.StageStats;
 import chess.nn.lc0.bt4.Architecture;
 import chess.nn.lc0.bt4.BinLoader;
 import chess.nn.lc0.bt4.Encoder;
@@ -63,6 +66,8 @@ public final class BT4RegressionTest {
         testCapabilityProbesAreGraceful();
         testEncoderClassicalPlanes();
         testEncoderModernAuxPlanes();
+        testEncoderPackedPlanes();
+        testStageStatsLayout();
         testAttentionPolicyMap();
         testModelLoadAndForward();
         testAutoBackendSelectsFirstLoadableGpu();
@@ -126,6 +131,56 @@ public final class BT4RegressionTest {
         assertClose(1.0f, epPlanes[(Encoder.AUX_BASE + 4) * 64 + 44], "en-passant e6 plane");
     }
 
+    /**
+     * Verifies packed planes expand to the float encoding, including the
+     * rule-50 scalar plane and a canonical transform.
+     */
+    private static void testEncoderPackedPlanes() {
+        String[] fens = {
+            START_FEN,
+            "k7/8/8/3Pp3/8/8/8/7K w - e6 37 60",
+            "4k3/8/8/8/8/8/2q5/4K3 b - - 12 70"
+        };
+        for (String fen : fens) {
+            Position position = new Position(fen);
+            for (InputFormat format : new InputFormat[] { InputFormat.CLASSICAL_112, InputFormat.BT4_CANONICAL_112 }) {
+                Encoder.EncodedInput encoded = Encoder.encode(position, format);
+                Encoder.PackedInput packed = Encoder.encodePacked(position, format);
+                String label = "packed " + format + " " + fen;
+                assertEquals(PackedPlanes.words(Encoder.INPUT_CHANNELS), packed.words().length, label + " length");
+                assertEquals(encoded.transform(), packed.transform(), label + " transform");
+                float[] expanded = PackedPlanes.expand(packed.words(), Encoder.INPUT_CHANNELS);
+                for (int i = 0; i < expanded.length; i++) {
+                    assertClose(encoded.planes()[i], expanded[i], label + " element " + i);
+                }
+            }
+        }
+        float[] rule50 = Encoder.encode(new Position(fens[1]), InputFormat.CLASSICAL_112).planes();
+        assertTrue(rule50[(Encoder.AUX_BASE + 5) * 64] > 0.0f, "rule-50 plane set");
+    }
+
+    /**
+     * Verifies the native {@code nativeGetStats} layout decodes per stage and
+     * that malformed results fall back to the empty snapshot.
+     */
+    private static void testStageStatsLayout() {
+        long[] raw = {1L, 2L, 4096L, 3000L, 0L, 4L, 0L, 0L, 1200L};
+        StageStats stats = StageStats.parse("upload,wdl", raw);
+        assertTrue(stats.enabled(), "stage stats enabled");
+        assertEquals(2, stats.stages().size(), "stage count");
+        assertEquals("upload", stats.stages().get(0).name(), "first stage name");
+        assertEquals(4096L, stats.stage("upload").bytes(), "upload bytes");
+        assertEquals(1500L, stats.stage("upload").meanNanos(), "upload mean nanos");
+        assertEquals(300L, stats.stage("wdl").meanNanos(), "host stage mean nanos");
+        assertEquals(4200L, stats.totalNanos(), "total nanos");
+        assertTrue(stats.stage("tower") == null, "unknown stage");
+        assertFalse(StageStats.parse("upload", raw).enabled(), "length mismatch is empty");
+        assertFalse(StageStats.parse(null, raw).enabled(), "missing names is empty");
+        assertFalse(StageStats.parse("upload,wdl", null).enabled(), "missing counters is empty");
+        assertEquals(0, StageStats.read(0L, h -> "upload", (h, reset) -> raw, false).stages().size(),
+                "null handle is empty");
+    }
+
     /**
      * Verifies generated LC0 attention-policy mapping.
      */
@@ -351,7 +406,11 @@ public final class BT4RegressionTest {
             withBt4Backend(backend, () -> {
                 try (Network network = Network.load(path)) {
                     assertEquals(backend, network.backend(), "BT4 native backend " + backend);
-                    assertPredictionClose(expected, network.predict(position), "BT4 native " + backend + " parity");
+                    assertPredictionClose(expected, network.predict(position), nativeTolerance(backend),
+                            "BT4 native " + backend + " parity");
+                    List<Network.Prediction> batch = network.predictBatch(List.of(position, position));
+                    assertPredictionClose(expected, batch.get(1), nativeTolerance(backend),
+                            "BT4 native " + backend + " packed batch parity");
                 }
             });
         } catch (IOException e) {
@@ -528,6 +587,48 @@ public final class BT4RegressionTest {
         assertClose(expected.value(), actual.value(), label + " value");
     }
 
+    /**
+     * Compares predictions with an explicit absolute tolerance.
+     *
+     * @param expected expected prediction
+     * @param actual actual prediction
+     * @param tolerance accepted absolute difference
+     * @param label assertion label
+     */
+    private static void assertPredictionClose(
+            Network.Prediction expected, Network.Prediction actual, double tolerance, String label) {
+        assertEquals(expected.policy().length, actual.policy().length, label + " policy length");
+        assertEquals(expected.wdl().length, actual.wdl().length, label + " WDL length");
+        for (int i = 0; i < expected.policy().length; i++) {
+            assertNear(expected.policy()[i], actual.policy()[i], tolerance, label + " policy " + i);
+        }
+        for (int i = 0; i < expected.wdl().length; i++) {
+            assertNear(expected.wdl()[i], actual.wdl()[i], tolerance, label + " WDL " + i);
+        }
+        assertNear(expected.value(), actual.value(), tolerance, label + " value");
+    }
+
+    /**
+     * Returns the native parity tolerance for a backend. Reduced-precision weight
+     * storage ({@code CRTK_BT4_<VENDOR>_DTYPE=fp16|bf16}) rounds every dense weight,
+     * so parity is only approximate in that mode.
+     *
+     * @param backend backend name
+     * @return accepted absolute difference
+     */
+    private static double nativeTolerance(String backend) {
+        String vendor = Network.BACKEND_CUDA.equals(backend) ? "CUDA"
+                : Network.BACKEND_ROCM.equals(backend) ? "ROCM" : null;
+        String dtype = vendor == null ? null : System.getenv("CRTK_BT4_" + vendor + "_DTYPE");
+        if (dtype == null) {
+            return 1.0e-5;
+        }
+        return switch (dtype.trim().toLowerCase(Locale.ROOT)) {
+            case "fp16", "f16", "half", "bf16", "bfloat16" -> 2.0e-2;
+            default -> 1.0e-5;
+        };
+    }
+
     /**
      * Runs an action with a temporary BT4 backend property.
      *
@@ -54,7 +54,8 @@ public final class GpuPerftRegressionTest {
     public static void main(String[] args) {
         if (!NativePerftBackend.isAvailable()) {
             System.out.println("GpuPerftRegressionTest: skipped (no native perft backend; "
-                    + "set CRTK_PERFT_CUDA_LIB to a libperft_*.so to enable)");
+                    + "set CRTK_PERFT_CUDA_LIB to a libperft_*.so, or CRTK_PERFT_HOST_LIB to "
+                    + "native/host's libperft_host.so, to enable)");
             return;
         }
         System.out.println("GpuPerftRegressionTest: backend=" + NativePerftBackend.name());
@@ -62,6 +63,8 @@ public final class GpuPerftRegressionTest {
         testChess960Castling();
         testDetailedMatchesCpu();
         testDivideMatchesCpu();
+        testMultiChunkFrontier();
+        testFoldedFrontier();
         testPackLength();
         System.out.println("GpuPerftRegressionTest: all checks passed");
     }
@@ -178,6 +181,51 @@ public final class GpuPerftRegressionTest {
         assertEquals(expected.checkmates(), actual.checkmates(), tag + " checkmates");
     }
 
+    /**
+     * Verifies a frontier spanning several native session chunks (startpos split
+     * 4 has 197281 positions) sums to the canonical perft(5) counters, so the
+     * double-buffered chunk loop neither drops nor reorders results.
+     */
+    private static void testMultiChunkFrontier() {
+        Position position = Setup.getStandardStartPosition();
+        assertEquals(4_865_609L, GpuPerft.perft(position.copy(), 5, 4), "startpos multi-chunk nodes");
+        Perft.Stats stats = GpuPerft.perftDetailed(position.copy(), 5, 4);
+        assertStatsEquals(new Perft.Stats(4_865_609L, 82_719L, 258L, 0L, 0L, 27_351L, 347L), stats,
+                "startpos multi-chunk detailed");
+    }
+
+    /**
+     * Verifies native frontier folding: the folded driver matches CPU perft at
+     * every split, and the startpos ply-3 frontier (8902 positions) folds to its
+     * 5362 distinct positions. Skipped for libraries without the folded entry
+     * points.
+     */
+    private static void testFoldedFrontier() {
+        Position start = Setup.getStandardStartPosition();
+        long[] root = PositionCodec.pack(new Position[] {start});
+        long[] folded = NativePerftBackend.foldedPerft(root, 5, 3, false);
+        if (folded == null) {
+            System.out.println("GpuPerftRegressionTest: folded frontier skipped (library has no folded entry points)");
+            return;
+        }
+        assertEquals(4_865_609L, folded[0], "startpos folded nodes");
+        assertEquals(8_902L, folded[1], "startpos folded frontier");
+        assertEquals(5_362L, folded[2], "startpos folded unique");
+        long[] detailed = NativePerftBackend.foldedPerft(root, 5, 3, true);
+        assertStatsEquals(new Perft.Stats(4_865_609L, 82_719L, 258L, 0L, 0L, 27_351L, 347L),
+                new Perft.Stats(detailed[0], detailed[1], detailed[2], detailed[3], detailed[4], detailed[5],
+                        detailed[6]),
+                "startpos folded detailed");
+        for (PerftCase testCase : CASES) {
+            Position position = new Position(testCase.fen());
+            long expected = SplitPerft.perft(position.copy(), testCase.depth(), 0, SplitPerft.CPU);
+            for (int split = 0; split <= testCase.depth(); split++) {
+                assertEquals(expected, GpuPerft.perft(position.copy(), testCase.depth(), split),
+                        testCase.name() + " folded split=" + split);
+            }
+        }
+    }
+
     /**
      * Verifies the pack codec produces the expected flat length.
      */
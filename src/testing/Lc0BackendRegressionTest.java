@@ -0,0 +1,348 @@
+package testing;
+
+import static testing.TestSupport.*;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+import chess.core.Position;
+import chess.gpu.BackendNames;
+import chess.nn.lc0.cnn.Encoder;
+import chess.nn.lc0.cnn.Model;
+import chess.nn.lc0.cnn.Network;
+
+/**
+ * Regression checks for the LC0 CNN evaluator backend selection (CPU plus the
+ * optional CUDA/ROCm/oneAPI GPU backends and the native host CPU backend).
+ *
+ * <p>The host backend needs no device, so whenever {@code liblc0_host} is on
+ * the library path it is compared against the Java evaluator on a small
+ * synthetic net, with or without the default weights. The GPU backends are
+ * only exercised when their JNI library, a matching device and the default
+ * weights are present.
+ */
+public final class Lc0BackendRegressionTest {
+
+    /**
+     * Standard start position used for prediction smoke checks.
+     */
+    private static final String START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    /**
+     * Position after 1. e4, mixed into batches so side to move varies per position.
+     */
+    private static final String AFTER_E4_FEN = "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1";
+
+    /**
+     * Backend selection system property read by {@link Network}.
+     */
+    private static final String BACKEND_PROPERTY = "crtk.lc0.backend";
+
+    /**
+     * Largest accepted difference between a native backend and the Java evaluator.
+     */
+    private static final float TOLERANCE = 1.0e-3f;
+
+    /**
+     * Prevents instantiation.
+     */
+    private Lc0BackendRegressionTest() {
+        // utility
+    }
+
+    /**
+     * Runs LC0 CNN backend regression checks.
+     *
+     * @param args unused command-line arguments
+     * @throws IOException if weights cannot be written or read
+     */
+    public static void main(String[] args) throws IOException {
+        testBackendIdentifiers();
+        testCapabilityProbesAreGraceful();
+        testHostMatchesCpuOnSyntheticNet();
+        if (!Files.exists(Model.DEFAULT_WEIGHTS)) {
+            System.out.println("Lc0BackendRegressionTest: weights missing, skipped model checks");
+            return;
+        }
+        testForcedUnavailableBackendThrows();
+        testNativeBackendsMatchCpuWhenAvailable();
+        System.out.println("Lc0BackendRegressionTest: all checks passed");
+    }
+
+    /**
+     * Verifies the public backend identifiers match the shared backend names.
+     */
+    private static void testBackendIdentifiers() {
+        assertEquals(BackendNames.CPU, Network.BACKEND_CPU, "LC0 CPU backend id");
+        assertEquals(BackendNames.CUDA, Network.BACKEND_CUDA, "LC0 CUDA backend id");
+        assertEquals(BackendNames.ROCM, Network.BACKEND_ROCM, "LC0 ROCm backend id");
+        assertEquals(BackendNames.ONEAPI, Network.BACKEND_ONEAPI, "LC0 oneAPI backend id");
+        assertEquals(BackendNames.HOST, Network.BACKEND_HOST, "LC0 host backend id");
+    }
+
+    /**
+     * Verifies native capability probes never throw and report sane counts.
+     */
+    private static void testCapabilityProbesAreGraceful() {
+        assertTrue(chess.nn.lc0.cnn.cuda.Support.deviceCount() >= 0, "LC0 CUDA device count non-negative");
+        assertTrue(chess.nn.lc0.cnn.rocm.Support.deviceCount() >= 0, "LC0 ROCm device count non-negative");
+        assertTrue(chess.nn.lc0.cnn.oneapi.Support.deviceCount() >= 0, "LC0 oneAPI device count non-negative");
+        assertTrue(chess.nn.lc0.cnn.host.Support.deviceCount() >= 0, "LC0 host thread count non-negative");
+        assertEquals(chess.nn.lc0.cnn.host.Support.isAvailable(),
+                chess.nn.lc0.cnn.host.Support.deviceCount() > 0, "LC0 host availability matches thread count");
+        assertEquals(chess.nn.lc0.cnn.host.Support.isLoaded(), chess.nn.lc0.cnn.host.Support.isAvailable(),
+                "LC0 host library is available whenever it loads");
+    }
+
+    /**
+     * Verifies the host backend agrees with the Java evaluator on a synthetic
+     * net with 3x3 and 1x1 layers and one SE block, and that forcing it fails
+     * loudly when the library is absent.
+     *
+     * @throws IOException if the synthetic net cannot be written or loaded
+     */
+    private static void testHostMatchesCpuOnSyntheticNet() throws IOException {
+        Path weights = Files.createTempFile("crtk-lc0-synthetic", ".bin");
+        try {
+            writeSyntheticNet(weights);
+            if (!chess.nn.lc0.cnn.host.Backend.isAvailable()) {
+                assertForcedFailure(Network.BACKEND_HOST, weights);
+                return;
+            }
+            List<float[]> inputs = List.of(
+                    Encoder.encode(new Position(START_FEN)),
+                    Encoder.encode(new Position(AFTER_E4_FEN)),
+                    Encoder.encode(new Position(START_FEN)));
+            List<Network.Prediction> expected;
+            try (Network cpu = Network.loadCpu(weights)) {
+                expected = cpu.predictEncodedBatch(inputs);
+            }
+            String previous = System.getProperty(BACKEND_PROPERTY);
+            System.setProperty(BACKEND_PROPERTY, Network.BACKEND_HOST);
+            try (Network host = Network.load(weights)) {
+                assertEquals(Network.BACKEND_HOST, host.backend(), "forced host backend label");
+                try (Network cpu = Network.loadCpu(weights)) {
+                    assertEquals(cpu.info(), host.info(), "host backend reports the Java metadata");
+                }
+                assertClose(expected.get(1), host.predictEncoded(inputs.get(1)), "host single predict");
+                List<Network.Prediction> batch = host.predictEncodedBatch(inputs);
+                assertEquals(inputs.size(), batch.size(), "host batch size");
+                for (int i = 0; i < inputs.size(); i++) {
+                    assertClose(expected.get(i), batch.get(i), "host batch position " + i);
+                }
+            } finally {
+                restoreProperty(previous);
+            }
+        } finally {
+            Files.deleteIfExists(weights);
+        }
+    }
+
+    /**
+     * Verifies that forcing an unavailable native backend fails loudly instead
+     * of silently falling back.
+     *
+     * @throws IOException if an unexpected error occurs
+     */
+    private static void testForcedUnavailableBackendThrows() throws IOException {
+        if (!chess.nn.lc0.cnn.cuda.Backend.isAvailable()) {
+            assertForcedFailure(Network.BACKEND_CUDA, Model.DEFAULT_WEIGHTS);
+        }
+        if (!chess.nn.lc0.cnn.rocm.Backend.isAvailable()) {
+            assertForcedFailure(Network.BACKEND_ROCM, Model.DEFAULT_WEIGHTS);
+        }
+        if (!chess.nn.lc0.cnn.oneapi.Backend.isAvailable()) {
+            assertForcedFailure(Network.BACKEND_ONEAPI, Model.DEFAULT_WEIGHTS);
+        }
+        if (!chess.nn.lc0.cnn.host.Backend.isAvailable()) {
+            assertForcedFailure(Network.BACKEND_HOST, Model.DEFAULT_WEIGHTS);
+        }
+    }
+
+    /**
+     * Verifies a single forced-but-unavailable backend throws on load.
+     *
+     * @param backend backend identifier to force
+     * @param weights weights file to load
+     * @throws IOException if a load unexpectedly succeeds
+     */
+    private static void assertForcedFailure(String backend, Path weights) throws IOException {
+        String previous = System.getProperty(BACKEND_PROPERTY);
+        System.setProperty(BACKEND_PROPERTY, backend);
+        try (Network network = Network.load(weights)) {
+            throw new AssertionError("forced unavailable " + backend + " backend should fail, got " + network.backend());
+        } catch (IOException expected) {
+            assertTrue(expected.getMessage() != null && expected.getMessage().contains("unavailable"),
+                    "forced " + backend + " backend reports an unavailable error");
+        } finally {
+            restoreProperty(previous);
+        }
+    }
+
+    /**
+     * Verifies native backends agree with the Java evaluator on the default
+     * weights when available.
+     *
+     * @throws IOException if a backend load fails
+     */
+    private static void testNativeBackendsMatchCpuWhenAvailable() throws IOException {
+        float[] input = Encoder.encode(new Position(START_FEN));
+        Network.Prediction expected;
+        try (Network cpu = Network.loadCpu(Model.DEFAULT_WEIGHTS)) {
+            expected = cpu.predictEncoded(input);
+        }
+        assertNativeParity(Network.BACKEND_CUDA, chess.nn.lc0.cnn.cuda.Backend.isAvailable(), input, expected);
+        assertNativeParity(Network.BACKEND_ROCM, chess.nn.lc0.cnn.rocm.Backend.isAvailable(), input, expected);
+        assertNativeParity(Network.BACKEND_ONEAPI, chess.nn.lc0.cnn.oneapi.Backend.isAvailable(), input, expected);
+        assertNativeParity(Network.BACKEND_HOST, chess.nn.lc0.cnn.host.Backend.isAvailable(), input, expected);
+    }
+
+    /**
+     * Verifies one native backend's output is close to the Java evaluator.
+     *
+     * @param backend backend identifier to force
+     * @param available whether the backend is available
+     * @param input encoded input planes
+     * @param expected Java evaluator prediction for {@code input}
+     * @throws IOException if a backend load fails
+     */
+    private static void assertNativeParity(String backend, boolean available, float[] input,
+            Network.Prediction expected) throws IOException {
+        if (!available) {
+            return;
+        }
+        String previous = System.getProperty(BACKEND_PROPERTY);
+        System.setProperty(BACKEND_PROPERTY, backend);
+        try (Network network = Network.load(Model.DEFAULT_WEIGHTS)) {
+            assertEquals(backend, network.backend(), "native backend " + backend);
+            assertClose(expected, network.predictEncoded(input), "native " + backend);
+        } catch (IOException e) {
+            if (e.getMessage() != null && e.getMessage().contains("failed to initialize")) {
+                return;
+            }
+            throw e;
+        } finally {
+            restoreProperty(previous);
+        }
+    }
+
+    /**
+     * Verifies two predictions agree within {@link #TOLERANCE}.
+     *
+     * @param expected Java evaluator prediction
+     * @param actual native prediction
+     * @param label assertion label prefix
+     */
+    private static void assertClose(Network.Prediction expected, Network.Prediction actual, String label) {
+        assertEquals(expected.policy().length, actual.policy().length, label + " policy length");
+        float policyDiff = 0.0f;
+        for (int i = 0; i < expected.policy().length; i++) {
+            policyDiff = Math.max(policyDiff, Math.abs(expected.policy()[i] - actual.policy()[i]));
+        }
+        assertTrue(policyDiff < TOLERANCE, label + " policy matches CPU (max diff " + policyDiff + ")");
+        for (int i = 0; i < 3; i++) {
+            assertTrue(Math.abs(expected.wdl()[i] - actual.wdl()[i]) < TOLERANCE, label + " WDL[" + i + "] matches CPU");
+        }
+        assertTrue(Math.abs(expected.value() - actual.value()) < TOLERANCE, label + " value matches CPU");
+    }
+
+    /**
+     * Writes a small deterministic LC0 CNN net: 16 trunk channels, two blocks
+     * (the second with an SE unit), a 3x3 policy stem, 1x1 policy and value
+     * convolutions and a 96-entry policy map.
+     *
+     * @param path destination file
+     * @throws IOException if the file cannot be written
+     */
+    private static void writeSyntheticNet(Path path) throws IOException {
+        int input = 112;
+        int trunk = 16;
+        int blocks = 2;
+        int policy = 8;
+        int value = 4;
+        int hidden = 16;
+        int mapLength = 96;
+        Random random = new Random(20260514L);
+        ByteBuffer buf = ByteBuffer.allocate(1 << 20).order(ByteOrder.LITTLE_ENDIAN);
+        buf.put(new byte[] { 'L', 'C', '0', 'J' }).putInt(1);
+        buf.putInt(input).putInt(trunk).putInt(blocks).putInt(policy).putInt(value).putInt(hidden).putInt(mapLength)
+                .putInt(3);
+        putConv(buf, random, trunk, input, 3);
+        for (int b = 0; b < blocks; b++) {
+            putConv(buf, random, trunk, trunk, 3);
+            putConv(buf, random, trunk, trunk, 3);
+            boolean se = b == 1;
+            buf.put((byte) (se ? 1 : 0));
+            if (se) {
+                int seHidden = 4;
+                buf.putInt(seHidden).putInt(trunk);
+                putFloats(buf, random, seHidden * trunk);
+                putFloats(buf, random, seHidden);
+                putFloats(buf, random, 2 * trunk * seHidden);
+                putFloats(buf, random, 2 * trunk);
+            }
+        }
+        putConv(buf, random, trunk, trunk, 3);
+        putConv(buf, random, policy, trunk, 1);
+        putConv(buf, random, value, trunk, 1);
+        buf.putInt(hidden).putInt(value * 64);
+        putFloats(buf, random, hidden * value * 64);
+        putFloats(buf, random, hidden);
+        buf.putInt(3).putInt(hidden);
+        putFloats(buf, random, 3 * hidden);
+        putFloats(buf, random, 3);
+        buf.putInt(mapLength);
+        for (int i = 0; i < mapLength; i++) {
+            buf.putInt((i * 37) % (policy * 64));
+        }
+        Files.write(path, Arrays.copyOf(buf.array(), buf.position()));
+    }
+
+    /**
+     * Appends one convolution layer with random weights.
+     *
+     * @param buf destination buffer
+     * @param random weight source
+     * @param out output channels
+     * @param in input channels
+     * @param kernel kernel size (1 or 3)
+     */
+    private static void putConv(ByteBuffer buf, Random random, int out, int in, int kernel) {
+        buf.putInt(out).putInt(in).putInt(kernel);
+        putFloats(buf, random, out * in * kernel * kernel);
+        putFloats(buf, random, out);
+    }
+
+    /**
+     * Appends a length-prefixed array of small random floats.
+     *
+     * @param buf destination buffer
+     * @param random value source
+     * @param count number of floats
+     */
+    private static void putFloats(ByteBuffer buf, Random random, int count) {
+        buf.putInt(count);
+        for (int i = 0; i < count; i++) {
+            buf.putFloat((random.nextFloat() - 0.5f) * 0.2f);
+        }
+    }
+
+    /**
+     * Restores a previously captured system property value.
+     *
+     * @param previous prior value, or null to clear
+     */
+    private static void restoreProperty(String previous) {
+        if (previous == null) {
+            System.clearProperty(BACKEND_PROPERTY);
+        } else {
+            System.setProperty(BACKEND_PROPERTY, previous);
+        }
+    }
+}
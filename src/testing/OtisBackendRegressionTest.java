@@ -4,6 +4,7 @@ import static testing.TestSupport.*;
 
 import java.io.IOException;
 import java.nio.file.Files;
+import java.util.List;
 
 import chess.core.Position;
 import chess.gpu.BackendNames;
@@ -24,6 +25,11 @@ public final class OtisBackendRegressionTest {
      */
     private static final String START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
+    /**
+     * Position after 1. e4, mixed into batches so side to move varies per position.
+     */
+    private static final String AFTER_E4_FEN = "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1";
+
     /**
      * Backend selection system property read by {@link Model}.
      */
@@ -170,6 +176,21 @@ public final class OtisBackendRegressionTest {
                 assertTrue(Math.abs(wdl[i] - cpuWdl[i]) < 1.0e-3f,
                         "native " + backend + " WDL[" + i + "] matches CPU");
             }
+            List<Model.Prediction> batch = model.predictBatch(
+                    List.of(new Position(START_FEN), new Position(AFTER_E4_FEN), new Position(START_FEN)));
+            assertEquals(3, batch.size(), "native " + backend + " batch size");
+            for (int i = 0; i < 3; i++) {
+                assertTrue(Math.abs(batch.get(0).wdl()[i] - wdl[i]) < 1.0e-5f
+                        && Math.abs(batch.get(2).wdl()[i] - wdl[i]) < 1.0e-5f,
+                        "native " + backend + " batched WDL[" + i + "] matches single predict");
+            }
+            Model.Prediction queued = model.predictAsync(new Position(AFTER_E4_FEN)).join();
+            Model.Prediction queuedStart = model.predictAsync(new Position(START_FEN)).join();
+            for (int i = 0; i < 3; i++) {
+                assertTrue(Math.abs(queued.wdl()[i] - batch.get(1).wdl()[i]) < 1.0e-5f
+                        && Math.abs(queuedStart.wdl()[i] - wdl[i]) < 1.0e-5f,
+                        "native " + backend + " queued WDL[" + i + "] matches direct predict");
+            }
         } catch (IOException e) {
             if (e.getMessage() != null && e.getMessage().contains("failed to initialize")) {
                 return;
@@ -0,0 +1,148 @@
+package testing;
+
+import java.io.BufferedWriter;
+import java.io.IOException;
+import java.io.OutputStreamWriter;
+import java.io.Writer;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.DirectoryStream;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.Comparator;
+import java.util.List;
+
+import chess.core.Position;
+import chess.nn.t5.BinLoader;
+import chess.nn.t5.Model;
+import chess.nn.t5.TagPrompt;
+import chess.tag.Generator;
+
+/**
+ * Writes the T5 prompts of the tag fixtures as token ids, one prompt per line,
+ * for {@code crtk_bench_<vendor> --t5-prompts}.
+ *
+ * <p>
+ * Each fixture position goes through the same path as {@code tag-text}:
+ * {@link Generator#tags(Position)}, {@link TagPrompt#buildPositionPrompt(List)},
+ * then the model's tokenizer. The native bench decodes the file once per
+ * precision and compares every precision against fp32, so int8 and fp16 are
+ * judged on real tagging prompts rather than synthetic ids.
+ * </p>
+ *
+ * @since 2026
+ * @author Lennart A. Conrad
+ */
+public final class T5PromptIdsTool {
+
+    /**
+     * Default fixture directory, as read by {@link TagFixtureRegressionTest}.
+     */
+    private static final Path FIXTURE_DIR = Paths.get("testdata", "tags");
+
+    /**
+     * Utility class, prevents instantiation.
+     */
+    private T5PromptIdsTool() {
+    }
+
+    /**
+     * Runs the tool.
+     *
+     * @param args {@code <model.bin> [--out ids.txt] [fixtures.tsv ...]}
+     * @throws IOException if the model or a fixture cannot be read, or the
+     *                     output cannot be written
+     */
+    public static void main(String[] args) throws IOException {
+        if (args.length == 0) {
+            usage();
+        }
+        Path out = null;
+        List<Path> fixtures = new ArrayList<>();
+        for (int i = 1; i < args.length; i++) {
+            if ("--out".equals(args[i])) {
+                if (++i >= args.length) {
+                    usage();
+                }
+                out = Path.of(args[i]);
+            } else {
+                fixtures.add(Path.of(args[i]));
+            }
+        }
+        if (fixtures.isEmpty()) {
+            fixtures = fixtureFiles();
+        }
+        Model model = BinLoader.load(args[0]);
+        int prompts = 0;
+        try (Writer writer = out == null
+                ? new BufferedWriter(new OutputStreamWriter(System.out, StandardCharsets.UTF_8))
+                : Files.newBufferedWriter(out, StandardCharsets.UTF_8)) {
+            for (Path file : fixtures) {
+                prompts += write(writer, file, model);
+            }
+        }
+        System.err.println("wrote " + prompts + " prompts" + (out == null ? "" : " to " + out));
+    }
+
+    /**
+     * Prints usage and exits.
+     */
+    private static void usage() {
+        System.err.println("Usage: java -cp out testing.T5PromptIdsTool <model.bin> "
+                + "[--out ids.txt] [fixtures.tsv ...]");
+        System.exit(2);
+    }
+
+    /**
+     * Lists the default fixture files.
+     *
+     * @return fixture files in path order
+     * @throws IOException if the directory cannot be read
+     */
+    private static List<Path> fixtureFiles() throws IOException {
+        List<Path> files = new ArrayList<>();
+        try (DirectoryStream<Path> stream = Files.newDirectoryStream(FIXTURE_DIR, "*.tsv")) {
+            for (Path path : stream) {
+                files.add(path);
+            }
+        }
+        files.sort(Comparator.comparing(Path::toString));
+        return files;
+    }
+
+    /**
+     * Writes one fixture file's prompts, each preceded by a comment naming the
+     * fixture.
+     *
+     * @param writer output
+     * @param file fixture TSV ({@code id, fen, must_contain, must_not})
+     * @param model T5 model whose tokenizer encodes the prompts
+     * @return number of prompts written
+     * @throws IOException if the file cannot be read or the output written
+     */
+    private static int write(Writer writer, Path file, Model model) throws IOException {
+        int count = 0;
+        for (String line : Files.readAllLines(file)) {
+            if (line.isBlank() || line.startsWith("#")) {
+                continue;
+            }
+            String[] cols = line.split("\t", -1);
+            if (cols.length < 2) {
+                throw new IOException(file + ": expected id and fen columns: " + line);
+            }
+            String prompt = TagPrompt.buildPositionPrompt(Generator.tags(new Position(cols[1])));
+            StringBuilder ids = new StringBuilder();
+            for (int id : model.tokenizer.encode(prompt)) {
+                if (ids.length() > 0) {
+                    ids.append(' ');
+                }
+                ids.append(id);
+            }
+            writer.write("# " + file.getFileName() + " " + cols[0] + "\n");
+            writer.write(ids + "\n");
+            count++;
+        }
+        return count;
+    }
+}
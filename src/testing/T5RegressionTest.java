@@ -7,8 +7,10 @@ import java.io.IOException;
 import java.nio.charset.StandardCharsets;
 import java.nio.file.Files;
 import java.nio.file.Path;
+import java.util.Arrays;
 
 import chess.nn.t5.BinLoader;
+import chess.nn.t5.NativeBackendOps;
 
 /**
  * Regression checks for the lightweight T5 model loader.
@@ -35,6 +37,7 @@ public final class T5RegressionTest {
     public static void main(String[] args) throws IOException {
         testNegativeSentencepieceVocabularyFailsAsIOException();
         testNegativeTensorCountFailsAsIOException();
+        testBatchIdsRoundTripThroughPackedJniLayout();
         System.out.println("T5RegressionTest: all checks passed");
     }
 
@@ -115,6 +118,37 @@ public final class T5RegressionTest {
         return file;
     }
 
+    /**
+     * Verifies batched generation flattens prompts and splits the packed native
+     * result (lengths first, then outputs) back per prompt.
+     */
+    private static void testBatchIdsRoundTripThroughPackedJniLayout() {
+        int[][] inputs = { { 5, 6, 1 }, {}, { 7, 1 } };
+        int[][] out = NativeBackendOps.generateIdsBatch(42L, inputs, 3, (handle, ids, offsets, maxNew) -> {
+            assertTrue(handle == 42L && maxNew == 3, "batch passes handle and token limit");
+            assertTrue(ids.length == 5 && offsets.length == 4 && offsets[1] == 3 && offsets[2] == 3
+                    && offsets[3] == 5, "batch flattens prompts with offsets");
+            int[] packed = new int[3 + 6];
+            int pos = 3;
+            for (int i = 0; i < 3; i++) {
+                // echo decoder start plus the prompt's first id, or just the start id
+                int len = offsets[i + 1] > offsets[i] ? 2 : 1;
+                packed[i] = len;
+                packed[pos++] = 0;
+                if (len == 2) {
+                    packed[pos++] = ids[offsets[i]];
+                }
+            }
+            return Arrays.copyOf(packed, pos);
+        });
+        assertTrue(out != null && out.length == 3, "batch returns one output per prompt");
+        assertTrue(out[0].length == 2 && out[0][1] == 5, "first prompt output unpacked");
+        assertTrue(out[1].length == 1 && out[1][0] == 0, "empty prompt output unpacked");
+        assertTrue(out[2].length == 2 && out[2][1] == 7, "last prompt output unpacked");
+        assertTrue(NativeBackendOps.generateIdsBatch(42L, inputs, 3, (h, ids, offsets, n) -> new int[] { 9 }) == null,
+                "truncated native result is rejected");
+    }
+
     /**
      * Writes one length-prefixed UTF-8 string.
      *